@@ -715,6 +715,7 @@ void	zbx_queue_ptr_create(zbx_queue_ptr_t *queue);
 void	zbx_queue_ptr_destroy(zbx_queue_ptr_t *queue);
 void	zbx_queue_ptr_push(zbx_queue_ptr_t *queue, void *value);
 void	*zbx_queue_ptr_pop(zbx_queue_ptr_t *queue);
+void	*zbx_queue_ptr_peek(zbx_queue_ptr_t *queue, int index);
 void	zbx_queue_ptr_remove_value(zbx_queue_ptr_t *queue, const void *value);
 
 /* list item data */
@@ -49,6 +49,9 @@ typedef struct
 	zbx_uint64_t	index_total;
 	zbx_uint64_t	trend_free;
 	zbx_uint64_t	trend_total;
+	int		sync_batch_size;	/* the last history sync batch size limit */
+	int		sync_batch_values;	/* the number of values synced in the last batch */
+	double		sync_batch_time;	/* the time spent syncing the last batch */
 }
 zbx_wcache_info_t;
 
@@ -62,7 +65,7 @@ typedef void (*zbx_history_sync_f)(int *values_num, int *triggers_num, const zbx
 
 int	zbx_init_database_cache(zbx_get_program_type_f get_program_type, zbx_history_sync_f sync_history,
 		zbx_uint64_t history_cache_size, zbx_uint64_t history_index_cache_size,zbx_uint64_t *trends_cache_size,
-		char **error);
+		int history_sync_batch_min, int history_sync_batch_max, char **error);
 
 void	zbx_free_database_cache(int sync, const zbx_events_funcs_t *events_cbs);
 
@@ -91,6 +94,9 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 #define ZBX_STATS_HISTORY_INDEX_PUSED	20
 #define ZBX_STATS_HISTORY_INDEX_PFREE	21
 #define ZBX_STATS_HISTORY_BIN_COUNTER	22
+#define ZBX_STATS_SYNC_BATCH_SIZE	23
+#define ZBX_STATS_SYNC_BATCH_VALUES	24
+#define ZBX_STATS_SYNC_BATCH_TIME	25
 
 /* 'zbx_pp_value_opt_t' element 'flags' values */
 #define ZBX_PP_VALUE_OPT_NONE		0x0000	/* 'zbx_pp_value_opt_t' has no data */
@@ -121,6 +127,7 @@ zbx_uint64_t	zbx_dc_get_nextid(const char *table_name, int num);
 void	zbx_dc_update_interfaces_availability(void);
 
 void	zbx_hc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num);
+void	zbx_hc_get_trigger_function_stats(zbx_uint64_t *functions_num, zbx_uint64_t *functions_unique);
 void	zbx_hc_get_mem_stats(zbx_shmem_stats_t *data, zbx_shmem_stats_t *index);
 void	zbx_hc_get_items(zbx_vector_uint64_pair_t *items);
 
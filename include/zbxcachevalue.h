@@ -50,6 +50,9 @@
  *   either zbx_history_record_vector_destroy() function (free the zbx_vc_get_values()
  *   call output) or zbx_history_record_clear() function (free the zbx_vc_get_value() call output).
  *
+ *   History data can be also aggregated directly in cache with zbx_vc_aggregate()
+ *   function, which avoids copying values out of cache.
+ *
  * Locking
  *
  *   The cache ensures synchronization between processes by using automatic locks whenever
@@ -61,6 +64,17 @@
 #define ZBX_VC_MODE_NORMAL	0
 #define ZBX_VC_MODE_LOWMEM	1
 
+/* the value aggregation operations, see zbx_vc_aggregate() */
+#define ZBX_VC_AGGREGATE_SUM		0
+#define ZBX_VC_AGGREGATE_AVG		1
+#define ZBX_VC_AGGREGATE_MIN		2
+#define ZBX_VC_AGGREGATE_MAX		3
+#define ZBX_VC_AGGREGATE_COUNT		4
+#define ZBX_VC_AGGREGATE_FIRST		5
+#define ZBX_VC_AGGREGATE_LAST		6
+#define ZBX_VC_AGGREGATE_CHANGE		7
+#define ZBX_VC_AGGREGATE_PERCENTILE	8
+
 /* indicates that all values from database are cached */
 #define ZBX_ITEM_STATUS_CACHED_ALL	1
 
@@ -108,6 +122,9 @@ int	zbx_vc_get_values(zbx_uint64_t itemid, unsigned char value_type, zbx_vector_
 int	zbx_vc_get_value(zbx_uint64_t itemid, unsigned char value_type, const zbx_timespec_t *ts,
 		zbx_history_record_t *value);
 
+int	zbx_vc_aggregate(zbx_uint64_t itemid, unsigned char value_type, int op, double param, int seconds, int count,
+		const zbx_timespec_t *ts, zbx_history_record_t *result, int *values_num);
+
 int	zbx_vc_add_values(zbx_vector_ptr_t *history, int *ret_flush);
 
 int	zbx_vc_get_statistics(zbx_vc_stats_t *stats);
@@ -121,4 +138,7 @@ void	zbx_vc_flush_stats(void);
 
 void	zbx_vc_add_new_items(const zbx_vector_uint64_pair_t *items);
 
+int	zbx_vc_dump(const char *filename, const char *node_name, char **error);
+int	zbx_vc_load(const char *filename, const char *node_name, int time_min, char **error);
+
 #endif
@@ -24,6 +24,7 @@
 #include "zbxjson.h"
 #include "zbxalgo.h"
 #include "zbxshmem.h"
+#include "zbxipcservice.h"
 
 #define ZBX_DIAG_PREPROC_INFO	0x00000001
 #define ZBX_DIAG_PREPROC_SIMPLE	(ZBX_DIAG_PREPROC_INFO)
@@ -67,6 +68,7 @@ void	zbx_diag_map_free(zbx_diag_map_t *map);
 int	zbx_diag_parse_request(const struct zbx_json_parse *jp, const zbx_diag_map_t *field_map, zbx_uint64_t
 		*field_mask, zbx_vector_ptr_t *top_views, char **error);
 void	zbx_diag_add_mem_stats(struct zbx_json *json, const char *name, const zbx_shmem_stats_t *stats);
+void	zbx_diag_add_ipc_stats(struct zbx_json *json, const char *name, const zbx_ipc_stats_t *stats);
 int	zbx_diag_add_historycache_info(const struct zbx_json_parse *jp, struct zbx_json *json, char **error);
 void	zbx_diag_add_locks_info(struct zbx_json *json);
 int	zbx_diag_add_connector_info(const struct zbx_json_parse *jp, struct zbx_json *json, char **error);
@@ -41,6 +41,17 @@ typedef struct
 }
 zbx_dservice_t;
 
+/* discovery rule check throughput statistics */
+typedef struct
+{
+	zbx_uint64_t	druleid;
+	zbx_uint64_t	checks_num;	/* number of checks completed by asynchronous engine */
+	double		time;		/* time spent by workers performing the asynchronous checks */
+}
+zbx_discovery_rule_stats_t;
+
+ZBX_VECTOR_DECL(discovery_rule_stats, zbx_discovery_rule_stats_t)
+
 void	zbx_discoverer_init(void);
 
 void	*zbx_discovery_open(void);
@@ -55,7 +66,9 @@ void	zbx_discovery_dcheck_free(zbx_dc_dcheck_t *dcheck);
 void	zbx_discovery_drule_free(zbx_dc_drule_t *drule);
 int	zbx_discovery_get_usage_stats(zbx_vector_dbl_t *usage, int *count, char **error);
 int	zbx_discovery_get_queue_size(zbx_uint64_t *size, char **error);
-zbx_uint32_t	zbx_discovery_pack_usage_stats(unsigned char **data, const zbx_vector_dbl_t *usage, int count);
+int	zbx_discovery_get_rule_stats(zbx_vector_discovery_rule_stats_t *rule_stats, char **error);
+zbx_uint32_t	zbx_discovery_pack_usage_stats(unsigned char **data, const zbx_vector_dbl_t *usage, int count,
+		const zbx_vector_discovery_rule_stats_t *rule_stats);
 void	zbx_discovery_stats_ext_get(struct zbx_json *json, const void *arg);
 void	zbx_discovery_get_worker_info(zbx_process_info_t *info);
 #endif
@@ -21,18 +21,13 @@
 #define ZABBIX_EXPORT_H
 
 #include "zbxtypes.h"
+#include "zbxthreads.h"
 
 #define ZBX_FLAG_EXPTYPE_EVENTS		1
 #define ZBX_FLAG_EXPTYPE_HISTORY	2
 #define ZBX_FLAG_EXPTYPE_TRENDS		4
 
-typedef struct
-{
-	char	*name;
-	FILE	*file;
-	int	missing;
-}
-zbx_export_file_t;
+typedef struct zbx_export_file	zbx_export_file_t;
 
 typedef zbx_export_file_t	*(*zbx_get_export_file_f)(void);
 
@@ -41,6 +36,9 @@ typedef struct
 	char		*dir;
 	char		*type;
 	zbx_uint64_t	file_size;
+	char		*compression;
+	int		file_rotate_period;	/* in seconds, 0 - rotate only by file size */
+	int		writers_num;		/* number of export writers, 0 - processes write export directly */
 } zbx_config_export_t;
 
 int	zbx_init_library_export(zbx_config_export_t *zbx_config_export, char **error);
@@ -66,4 +64,6 @@ zbx_export_file_t	*zbx_trends_export_init(zbx_get_export_file_f get_export_file_
 void	zbx_trends_export_write(const char *buf, size_t count);
 void	zbx_trends_export_flush(void);
 
+ZBX_THREAD_ENTRY(zbx_export_writer_thread, args);
+
 #endif
@@ -31,6 +31,11 @@
 
 #define ZBX_IPC_WAIT_FOREVER	-1
 
+/* messages are written to socket as soon as possible */
+#define ZBX_IPC_SEND_IMMEDIATE	0
+/* messages are queued and written together when the event loop is processed */
+#define ZBX_IPC_SEND_BATCH	1
+
 typedef struct
 {
 	/* the message code */
@@ -60,6 +65,19 @@ zbx_ipc_socket_t;
 
 typedef struct zbx_ipc_client zbx_ipc_client_t;
 
+/* IPC message exchange statistics */
+typedef struct
+{
+	/* the number of received messages and socket reads */
+	zbx_uint64_t	rx_messages;
+	zbx_uint64_t	rx_reads;
+
+	/* the number of sent messages and socket writes */
+	zbx_uint64_t	tx_messages;
+	zbx_uint64_t	tx_writes;
+}
+zbx_ipc_stats_t;
+
 /* IPC service */
 typedef struct
 {
@@ -79,6 +97,12 @@ typedef struct
 
 	/* the clients with messages */
 	zbx_queue_ptr_t		clients_recv;
+
+	/* the send mode of new clients, see ZBX_IPC_SEND_* defines */
+	unsigned char		send_mode;
+
+	/* the statistics of disconnected clients */
+	zbx_ipc_stats_t		stats;
 }
 zbx_ipc_service_t;
 
@@ -100,6 +124,8 @@ int	zbx_ipc_service_recv(zbx_ipc_service_t *service, const zbx_timespec_t *timeo
 		zbx_ipc_message_t **message);
 void	zbx_ipc_service_alert(zbx_ipc_service_t *service);
 void	zbx_ipc_service_close(zbx_ipc_service_t *service);
+void	zbx_ipc_service_set_send_mode(zbx_ipc_service_t *service, unsigned char send_mode);
+void	zbx_ipc_service_get_stats(const zbx_ipc_service_t *service, zbx_ipc_stats_t *stats);
 
 int	zbx_ipc_client_send(zbx_ipc_client_t *client, zbx_uint32_t code, const unsigned char *data, zbx_uint32_t size);
 void	zbx_ipc_client_close(zbx_ipc_client_t *client);
@@ -128,6 +154,8 @@ int	zbx_ipc_async_socket_recv(zbx_ipc_async_socket_t *asocket, int timeout, zbx_
 int	zbx_ipc_async_socket_flush(zbx_ipc_async_socket_t *asocket, int timeout);
 int	zbx_ipc_async_socket_check_unsent(zbx_ipc_async_socket_t *asocket);
 int	zbx_ipc_async_socket_connected(zbx_ipc_async_socket_t *asocket);
+void	zbx_ipc_async_socket_set_send_mode(zbx_ipc_async_socket_t *asocket, unsigned char send_mode);
+void	zbx_ipc_async_socket_get_stats(const zbx_ipc_async_socket_t *asocket, zbx_ipc_stats_t *stats);
 int	zbx_ipc_async_exchange(const char *service_name, zbx_uint32_t code, int timeout, const unsigned char *data,
 		zbx_uint32_t size, unsigned char **out, char **error);
 
@@ -332,6 +332,14 @@ void		zbx_json_escape(char **string);
 int		zbx_json_open_path(const struct zbx_json_parse *jp, const char *path, struct zbx_json_parse *out);
 zbx_json_type_t	zbx_json_valuetype(const char *p);
 
+/* minimum size of json data worth indexing before walking it */
+#define ZBX_JSON_INDEX_MIN_SIZE	(64 * ZBX_KIBIBYTE)
+
+typedef struct zbx_json_index zbx_json_index_t;
+
+zbx_json_index_t	*zbx_json_index_create(const struct zbx_json_parse *jp);
+void			zbx_json_index_free(zbx_json_index_t *index);
+
 /* jsonpath support */
 
 typedef struct zbx_jsonpath_segment zbx_jsonpath_segment_t;
@@ -349,15 +357,32 @@ typedef struct
 zbx_jsonpath_t;
 
 typedef struct zbx_jsonobj zbx_jsonobj_t;
+typedef struct zbx_jsonobj_el zbx_jsonobj_el_t;
+typedef struct zbx_jsonobj_doc zbx_jsonobj_doc_t;
+
+typedef struct
+{
+	zbx_jsonobj_t	*values;
+	int		values_num;
+}
+zbx_jsonobj_array_t;
+
+typedef struct
+{
+	zbx_jsonobj_el_t	*values;
+	int			values_num;
 
-ZBX_PTR_VECTOR_DECL(jsonobj_ptr, zbx_jsonobj_t *)
+	/* element index by name, created during parsing for larger objects */
+	zbx_hashset_t		*index;
+}
+zbx_jsonobj_object_t;
 
 typedef union
 {
-	char				*string;
-	double				number;
-	zbx_hashset_t			object;
-	zbx_vector_jsonobj_ptr_t	array;
+	char			*string;
+	double			number;
+	zbx_jsonobj_object_t	object;
+	zbx_jsonobj_array_t	array;
 }
 zbx_jsonobj_data_t;
 
@@ -365,28 +390,36 @@ struct zbx_jsonobj
 {
 	zbx_json_type_t		type;
 	zbx_jsonobj_data_t	data;
+
+	/* the parsed document the object belongs to, NULL for standalone objects */
+	zbx_jsonobj_doc_t	*doc;
 };
 
-typedef struct
+struct zbx_jsonobj_el
 {
 	char		*name;
 	zbx_jsonobj_t	value;
-}
-zbx_jsonobj_el_t;
+};
 
 typedef struct zbx_jsonpath_index zbx_jsonpath_index_t;
 
 int	zbx_jsonpath_compile(const char *path, zbx_jsonpath_t *jsonpath);
 int	zbx_jsonpath_query(const struct zbx_json_parse *jp, const char *path, char **output);
 int	zbx_jsonobj_query_ext(zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, const char *path, char **output);
+int	zbx_jsonobj_query_compiled(zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, const zbx_jsonpath_t *jsonpath,
+		char **output);
 void	zbx_jsonpath_clear(zbx_jsonpath_t *jsonpath);
 
 zbx_jsonpath_index_t	*zbx_jsonpath_index_create(char **error);
 void	zbx_jsonpath_index_free(zbx_jsonpath_index_t *index);
 
 int	zbx_jsonobj_open(const char *data, zbx_jsonobj_t *obj);
+int	zbx_jsonobj_open_len(const char *data, size_t len, zbx_jsonobj_t *obj);
 void	zbx_jsonobj_clear(zbx_jsonobj_t *obj);
 int	zbx_jsonobj_query(zbx_jsonobj_t *obj, const char *path, char **output);
 int	zbx_jsonobj_to_string(char **str, size_t *str_alloc, size_t *str_offset, zbx_jsonobj_t *obj);
 
+zbx_jsonobj_el_t	*zbx_jsonobj_get_el(zbx_jsonobj_t *obj, const char *name);
+zbx_jsonobj_el_t	*zbx_jsonobj_next_el(zbx_jsonobj_t *obj, zbx_jsonobj_el_t *el);
+
 #endif /* ZABBIX_ZJSON_H */
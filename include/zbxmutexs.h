@@ -35,6 +35,12 @@ typedef HANDLE zbx_mutex_t;
 #	define zbx_mutex_lock(mutex)		__zbx_mutex_lock(__FILE__, __LINE__, mutex)
 #	define zbx_mutex_unlock(mutex)		__zbx_mutex_unlock(__FILE__, __LINE__, mutex)
 #else	/* not _WINDOWS */
+/* number of additional history cache shard locks, the first shard uses ZBX_MUTEX_CACHE */
+#define ZBX_MUTEX_CACHE_SHARDS_NUM	7
+
+/* number of additional value cache shard locks, the first shard uses ZBX_RWLOCK_VALUECACHE */
+#define ZBX_RWLOCK_VALUECACHE_SHARDS_NUM	7
+
 typedef enum
 {
 	ZBX_MUTEX_LOG = 0,
@@ -57,6 +63,8 @@ typedef enum
 	ZBX_MUTEX_REMOTE_COMMANDS,
 	ZBX_MUTEX_PROXY_BUFFER,
 	ZBX_MUTEX_VPS_MONITOR,
+	ZBX_MUTEX_CACHE_SHARD,
+	ZBX_MUTEX_CACHE_SHARD_LAST = ZBX_MUTEX_CACHE_SHARD + ZBX_MUTEX_CACHE_SHARDS_NUM - 1,
 	/* NOTE: Do not forget to sync changes here with mutex names in diag_add_locks_info()! */
 	ZBX_MUTEX_COUNT
 }
@@ -67,6 +75,8 @@ typedef enum
 	ZBX_RWLOCK_CONFIG = 0,
 	ZBX_RWLOCK_CONFIG_HISTORY,
 	ZBX_RWLOCK_VALUECACHE,
+	ZBX_RWLOCK_VALUECACHE_SHARD,
+	ZBX_RWLOCK_VALUECACHE_SHARD_LAST = ZBX_RWLOCK_VALUECACHE_SHARD + ZBX_RWLOCK_VALUECACHE_SHARDS_NUM - 1,
 	ZBX_RWLOCK_COUNT,
 }
 zbx_rwlock_name_t;
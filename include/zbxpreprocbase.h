@@ -23,6 +23,7 @@
 #include "zbxalgo.h"
 #include "zbxvariant.h"
 #include "zbxtime.h"
+#include "zbxjson.h"
 
 /* one preprocessing step history */
 typedef struct
@@ -59,13 +60,16 @@ zbx_pp_process_mode_t;
 
 typedef struct
 {
-	int	type;
-	int	error_handler;
-	char	*params;
-	char	*error_handler_params;
+	int		type;
+	int		error_handler;
+	char		*params;
+	char		*error_handler_params;
+
+	zbx_jsonpath_t	*jsonpath;	/* compiled JSONPath of JSONPath step, NULL if not compiled */
 }
 zbx_pp_step_t;
 
+void	zbx_pp_step_compile(zbx_pp_step_t *step);
 void	zbx_pp_step_free(zbx_pp_step_t *step);
 
 ZBX_PTR_VECTOR_DECL(pp_step_ptr, zbx_pp_step_t *)
@@ -43,6 +43,14 @@ zbx_expression_t;
 
 ZBX_PTR_VECTOR_DECL(expression, zbx_expression_t *)
 
+typedef struct
+{
+	zbx_uint64_t	hits;
+	zbx_uint64_t	misses;
+	zbx_uint64_t	evictions;
+}
+zbx_regexp_cache_stats_t;
+
 /* regular expressions */
 int	zbx_regexp_compile(const char *pattern, zbx_regexp_t **regexp, char **err_msg);
 int	zbx_regexp_compile_ext(const char *pattern, zbx_regexp_t **regexp, int flags, char **err_msg);
@@ -75,4 +83,7 @@ int	zbx_wildcard_match(const char *value, const char *wildcard);
 
 void	zbx_init_regexp_env(void);
 
+void	zbx_regexp_cache_get_stats(zbx_regexp_cache_stats_t *stats);
+void	zbx_regexp_cache_clear(void);
+
 #endif /* ZABBIX_ZBXREGEXP_H */
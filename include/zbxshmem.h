@@ -47,6 +47,9 @@ typedef struct
 
 	const char	*mem_descr;
 	const char	*mem_param;
+
+	/* slab allocator data for small allocations, NULL when slab mode is disabled */
+	void		*slab;
 }
 zbx_shmem_info_t;
 
@@ -60,6 +63,13 @@ typedef struct
 	unsigned int	chunks_num[ZBX_SHMEM_BUCKET_COUNT];
 	unsigned int	free_chunks;
 	unsigned int	used_chunks;
+
+	/* slab allocator statistics, zero if slab mode is disabled */
+	unsigned int	slab_pages;		/* the number of slab pages */
+	unsigned int	slab_used_objects;	/* the number of allocated slab objects */
+	unsigned int	slab_free_objects;	/* the number of free slab objects */
+	zbx_uint64_t	slab_free_size;		/* the size of free slab objects */
+	zbx_uint64_t	slab_overhead;		/* the size of slab page headers, object tags and page tails */
 }
 zbx_shmem_stats_t;
 
@@ -68,6 +78,7 @@ int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *des
 int	zbx_shmem_create_min(zbx_shmem_info_t **info, zbx_uint64_t size, const char *descr, const char *param,
 		int allow_oom, char **error);
 void	zbx_shmem_destroy(zbx_shmem_info_t *info);
+void	zbx_shmem_enable_slab(zbx_shmem_info_t *info);
 
 #define	zbx_shmem_malloc(info, old, size) __zbx_shmem_malloc(__FILE__, __LINE__, info, old, size)
 #define	zbx_shmem_realloc(info, old, size) __zbx_shmem_realloc(__FILE__, __LINE__, info, old, size)
@@ -87,6 +98,7 @@ void	__zbx_shmem_free(const char *file, int line, zbx_shmem_info_t *info, void *
 void	zbx_shmem_clear(zbx_shmem_info_t *info);
 
 void	zbx_shmem_get_stats(const zbx_shmem_info_t *info, zbx_shmem_stats_t *stats);
+void	zbx_shmem_add_stats(zbx_shmem_stats_t *total, const zbx_shmem_stats_t *stats);
 void	zbx_shmem_dump_stats(int level, zbx_shmem_info_t *info);
 
 size_t		zbx_shmem_required_size(int chunks_num, const char *descr, const char *param);
@@ -36,6 +36,10 @@ void	zbx_xml_escape_xpath(char **data);
 int	zbx_query_xpath(zbx_variant_t *value, const char *params, char **errmsg);
 int	zbx_query_xpath_contents(zbx_variant_t *value, const char *params, int *is_empty, char **errmsg);
 
+int	zbx_xml_doc_open(const char *data, void **doc, char **errmsg);
+void	zbx_xml_doc_free(void *doc);
+int	zbx_query_xpath_doc(void *doc, zbx_variant_t *value, const char *params, char **errmsg);
+
 #ifdef HAVE_LIBXML2
 int	zbx_open_xml(char *data, int options, int maxerrlen, void **xml_doc, void **root_node, char **errmsg);
 int	zbx_check_xml_memory(char *mem, int maxerrlen, char **errmsg);
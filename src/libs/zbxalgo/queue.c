@@ -164,6 +164,30 @@ void	*zbx_queue_ptr_pop(zbx_queue_ptr_t *queue)
 	return value;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets value from the queue without removing it                     *
+ *                                                                            *
+ * Parameters: queue - [IN]                                                   *
+ *             index - [IN] the value index, 0 being the first queue element  *
+ *                                                                            *
+ * Return value: The queue element at the specified index or NULL if the      *
+ *               queue has less elements.                                     *
+ *                                                                            *
+ ******************************************************************************/
+void	*zbx_queue_ptr_peek(zbx_queue_ptr_t *queue, int index)
+{
+	int	pos;
+
+	if (0 > index || index >= zbx_queue_ptr_values_num(queue))
+		return NULL;
+
+	if ((pos = queue->tail_pos + index) >= queue->alloc_num)
+		pos -= queue->alloc_num;
+
+	return queue->values[pos];
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: removes specified value from queue                                *
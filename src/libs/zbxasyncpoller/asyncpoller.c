@@ -80,6 +80,14 @@ static void	async_event(evutil_socket_t fd, short what, void *arg)
 
 	ret = task->process_cb(what, task->data, &fd, task->ip, task->error);
 
+	/* task that continues after timeout gets full timeout for the next request */
+	if (0 != (what & EV_TIMEOUT) && ZBX_ASYNC_TASK_STOP != ret)
+	{
+		struct timeval	tv = {task->timeout, 0};
+
+		evtimer_add(task->timeout_event, &tv);
+	}
+
 	switch (ret)
 	{
 		case ZBX_ASYNC_TASK_STOP:
@@ -113,6 +113,9 @@ void     zbx_proxy_counter_ptr_free(zbx_proxy_counter_t *proxy_counter)
 static zbx_get_program_type_f	get_program_type_cb = NULL;
 static zbx_get_config_forks_f	get_config_forks_cb = NULL;
 
+/* poll regular and dynamic index SNMP OIDs by asynchronous SNMP pollers */
+static int	config_snmp_async_get = 1;
+
 /******************************************************************************
  *                                                                            *
  * Purpose: validate macro value when expanding user macros                   *
@@ -360,7 +363,10 @@ static unsigned char	poller_by_item(unsigned char type, const char *key, unsigne
 
 			return ZBX_POLLER_TYPE_AGENT;
 		case ITEM_TYPE_SNMP:
-			if (ZBX_SNMP_OID_TYPE_WALK == snmp_oid_type || ZBX_SNMP_OID_TYPE_GET == snmp_oid_type)
+			/* OIDs with macros can only be resolved by synchronous pollers, regular and */
+			/* dynamic index OIDs are polled by synchronous pollers unless enabled       */
+			if (ZBX_SNMP_OID_TYPE_WALK == snmp_oid_type || ZBX_SNMP_OID_TYPE_GET == snmp_oid_type ||
+					(0 != config_snmp_async_get && ZBX_SNMP_OID_TYPE_MACRO != snmp_oid_type))
 			{
 				if (0 == get_config_forks_cb(ZBX_PROCESS_TYPE_SNMP_POLLER))
 					break;
@@ -617,6 +623,13 @@ static void	DCitem_poller_type_update(ZBX_DC_ITEM *dc_item, const ZBX_DC_HOST *d
 
 		if (NULL != (snmpitem = (ZBX_DC_SNMPITEM *)zbx_hashset_search(&config->snmpitems, &dc_item->itemid)))
 			snmp_oid_type = snmpitem->snmp_oid_type;
+
+		/* discovery rules with regular OIDs are walked by synchronous pollers */
+		if (0 != (ZBX_FLAG_DISCOVERY_RULE & dc_item->flags) && (ZBX_SNMP_OID_TYPE_NORMAL == snmp_oid_type ||
+				ZBX_SNMP_OID_TYPE_DYNAMIC == snmp_oid_type))
+		{
+			snmp_oid_type = ZBX_SNMP_OID_TYPE_MACRO;
+		}
 	}
 
 	poller_type = poller_by_item(dc_item->type, dc_item->key, snmp_oid_type);
@@ -3003,6 +3016,8 @@ static void	DCsync_items(zbx_dbsync_t *sync, zbx_uint64_t revision, int flags, z
 		if (SUCCEED == dc_strpool_replace(found, &item->key, row[5]))
 			flags |= ZBX_ITEM_KEY_CHANGED;
 
+		dc_strpool_replace(found, &item->name, row[49]);
+
 		if (0 == found)
 		{
 			item->triggers = NULL;
@@ -3352,7 +3367,7 @@ static void	DCsync_items(zbx_dbsync_t *sync, zbx_uint64_t revision, int flags, z
 			if (1 == found && NULL != calcitem->formula_bin)
 				__config_shmem_free_func((void *)calcitem->formula_bin);
 
-			calcitem->formula_bin = config_decode_serialized_expression(row[49]);
+			calcitem->formula_bin = config_decode_serialized_expression(row[50]);
 		}
 		else if (NULL != (calcitem = (ZBX_DC_CALCITEM *)zbx_hashset_search(&config->calcitems, &itemid)))
 		{
@@ -3797,6 +3812,7 @@ static void	DCsync_items(zbx_dbsync_t *sync, zbx_uint64_t revision, int flags, z
 			zbx_binary_heap_remove_direct(&config->queues[item->poller_type], item->itemid);
 
 		dc_strpool_release(item->key);
+		dc_strpool_release(item->name);
 		dc_strpool_release(item->error);
 		dc_strpool_release(item->delay);
 		dc_strpool_release(item->history_period);
@@ -5993,14 +6009,15 @@ static void	DCsync_itemscript_param(zbx_dbsync_t *sync, zbx_uint64_t revision)
  ******************************************************************************/
 static void	DCsync_hostgroup_hosts(zbx_dbsync_t *sync)
 {
-	char			**row;
-	zbx_uint64_t		rowid;
-	unsigned char		tag;
+	char				**row;
+	zbx_uint64_t			rowid;
+	unsigned char			tag;
 
-	zbx_dc_hostgroup_t	*group = NULL;
+	zbx_dc_hostgroup_t		*group = NULL;
+	zbx_dc_host_group_index_t	*host_group_index;
 
-	int			ret;
-	zbx_uint64_t		last_groupid = 0, groupid, hostid;
+	int				ret, found;
+	zbx_uint64_t			last_groupid = 0, groupid, hostid;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -6025,17 +6042,53 @@ static void	DCsync_hostgroup_hosts(zbx_dbsync_t *sync)
 
 		ZBX_STR2UINT64(hostid, row[1]);
 		zbx_hashset_insert(&group->hostids, &hostid, sizeof(hostid));
+
+		/* update host_groups_index */
+		host_group_index = (zbx_dc_host_group_index_t *)DCfind_id(&config->host_groups_index, hostid,
+				sizeof(zbx_dc_host_group_index_t), &found);
+
+		if (0 == found)
+		{
+			zbx_vector_uint64_create_ext(&host_group_index->groupids, __config_shmem_malloc_func,
+					__config_shmem_realloc_func, __config_shmem_free_func);
+		}
+
+		if (FAIL == zbx_vector_uint64_search(&host_group_index->groupids, groupid,
+				ZBX_DEFAULT_UINT64_COMPARE_FUNC))
+		{
+			zbx_vector_uint64_append(&host_group_index->groupids, groupid);
+		}
 	}
 
 	/* remove deleted group hostids from cache */
 	for (; SUCCEED == ret; ret = zbx_dbsync_next(sync, &rowid, &row, &tag))
 	{
 		ZBX_STR2UINT64(groupid, row[0]);
+		ZBX_STR2UINT64(hostid, row[1]);
+
+		/* update host_groups_index, groups might be already removed from cache at this point */
+		if (NULL != (host_group_index = (zbx_dc_host_group_index_t *)zbx_hashset_search(
+				&config->host_groups_index, &hostid)))
+		{
+			int	index;
+
+			if (FAIL != (index = zbx_vector_uint64_search(&host_group_index->groupids, groupid,
+					ZBX_DEFAULT_UINT64_COMPARE_FUNC)))
+			{
+				zbx_vector_uint64_remove_noorder(&host_group_index->groupids, index);
+			}
+
+			/* remove index entry if it's empty */
+			if (0 == host_group_index->groupids.values_num)
+			{
+				zbx_vector_uint64_destroy(&host_group_index->groupids);
+				zbx_hashset_remove_direct(&config->host_groups_index, host_group_index);
+			}
+		}
 
 		if (NULL == (group = (zbx_dc_hostgroup_t *)zbx_hashset_search(&config->hostgroups, &groupid)))
 			continue;
 
-		ZBX_STR2UINT64(hostid, row[1]);
 		zbx_hashset_remove(&group->hostids, &hostid);
 	}
 
@@ -8827,7 +8880,7 @@ size_t	zbx_maintenance_update_flags_num(void)
  *                                                                            *
  ******************************************************************************/
 int	zbx_init_configuration_cache(zbx_get_program_type_f get_program_type, zbx_get_config_forks_f get_config_forks,
-		zbx_uint64_t conf_cache_size, char **error)
+		zbx_uint64_t conf_cache_size, int snmp_async_get, char **error)
 {
 	int	i, ret;
 
@@ -8835,6 +8888,7 @@ int	zbx_init_configuration_cache(zbx_get_program_type_f get_program_type, zbx_ge
 
 	get_program_type_cb = get_program_type;
 	get_config_forks_cb = get_config_forks;
+	config_snmp_async_get = snmp_async_get;
 
 	if (SUCCEED != (ret = zbx_rwlock_create(&config_lock, ZBX_RWLOCK_CONFIG, error)))
 		goto out;
@@ -8908,6 +8962,7 @@ int	zbx_init_configuration_cache(zbx_get_program_type_f get_program_type, zbx_ge
 	CREATE_HASHSET(config->corr_conditions, 0);
 	CREATE_HASHSET(config->corr_operations, 0);
 	CREATE_HASHSET(config->hostgroups, 0);
+	CREATE_HASHSET(config->host_groups_index, 0);
 	zbx_vector_ptr_create_ext(&config->hostgroups_name, __config_shmem_malloc_func, __config_shmem_realloc_func,
 			__config_shmem_free_func);
 
@@ -10126,6 +10181,58 @@ void	zbx_dc_config_get_items_by_itemids(zbx_dc_item_t *items, const zbx_uint64_t
 	UNLOCK_CACHE;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets template item identifiers of the specified items             *
+ *                                                                            *
+ * Parameters: itemids     - [IN] array of item IDs                           *
+ *             templateids - [OUT] template item IDs, 0 if item is not found  *
+ *                                 or is not linked to a template             *
+ *             num         - [IN] number of elements                          *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dc_config_get_item_templateids(const zbx_uint64_t *itemids, zbx_uint64_t *templateids, int num)
+{
+	int			i;
+	const ZBX_DC_ITEM	*dc_item;
+
+	RDLOCK_CACHE;
+
+	for (i = 0; i < num; i++)
+	{
+		if (NULL == (dc_item = (ZBX_DC_ITEM *)zbx_hashset_search(&config->items, &itemids[i])))
+			templateids[i] = 0;
+		else
+			templateids[i] = dc_item->templateid;
+	}
+
+	UNLOCK_CACHE;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets the latest revision of user macros resolved for the host     *
+ *                                                                            *
+ * Parameters: hostid - [IN] host identifier                                  *
+ *                                                                            *
+ * Return value: The latest revision of global, host and linked template      *
+ *               user macros                                                  *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint64_t	zbx_dc_get_host_macro_revision(zbx_uint64_t hostid)
+{
+	zbx_uint64_t	revision = 0;
+
+	RDLOCK_CACHE;
+
+	um_cache_get_host_revision(config->um_cache, ZBX_UM_CACHE_GLOBAL_MACRO_HOSTID, &revision);
+	um_cache_get_host_revision(config->um_cache, hostid, &revision);
+
+	UNLOCK_CACHE;
+
+	return revision;
+}
+
 int	zbx_dc_config_get_active_items_count_by_hostid(zbx_uint64_t hostid)
 {
 	const ZBX_DC_HOST	*dc_host;
@@ -10205,6 +10312,8 @@ static void	dc_preproc_sync_preprocitem(zbx_pp_item_preproc_t *preproc, const ZB
 
 		preproc->steps[i].params =  zbx_strdup(NULL, op->params);
 		preproc->steps[i].error_handler_params = zbx_strdup(NULL, op->error_handler_params);
+
+		zbx_pp_step_compile(&preproc->steps[i]);
 	}
 
 	preproc->steps_num = preprocitem->preproc_ops.values_num;
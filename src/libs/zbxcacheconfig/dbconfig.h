@@ -125,6 +125,7 @@ typedef struct
 	zbx_uint64_t		lastlogsize;
 	zbx_uint64_t		valuemapid;
 	const char		*key;
+	const char		*name;
 	const char		*port;
 	const char		*error;
 	const char		*delay;
@@ -783,6 +784,13 @@ typedef struct
 }
 zbx_dc_hostgroup_t;
 
+typedef struct
+{
+	zbx_uint64_t		hostid;
+	zbx_vector_uint64_t	groupids;
+}
+zbx_dc_host_group_index_t;
+
 typedef struct
 {
 	zbx_uint64_t	item_preprocid;
@@ -973,6 +981,7 @@ typedef struct
 	zbx_hashset_t		corr_conditions;
 	zbx_hashset_t		corr_operations;
 	zbx_hashset_t		hostgroups;
+	zbx_hashset_t		host_groups_index;	/* host group index by hostid */
 	zbx_vector_ptr_t	hostgroups_name;	/* host groups sorted by name */
 	zbx_vector_ptr_t	kvs_paths;
 	zbx_hashset_t		gmacro_kv;
@@ -332,6 +332,101 @@ void	zbx_dc_config_history_sync_get_item_tags_by_functionids(const zbx_uint64_t
 	UNLOCK_CACHE_CONFIG_HISTORY;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get item names and tags for history and trends export             *
+ *                                                                            *
+ * Parameters: itemids     - [IN] item identifiers                            *
+ *             itemids_num - [IN] number of items                             *
+ *             names       - [OUT] item names, not set for items missing in   *
+ *                                 configuration cache                        *
+ *             tags        - [OUT] item tags, vectors must be created by      *
+ *                                 caller                                     *
+ *                                                                            *
+ * Comments: Only item own tags are returned without the ones inherited from  *
+ *           host or templates, as stored in item_tag table.                  *
+ *           Data is retrieved using history read lock that must be write     *
+ *           locked only when configuration sync occurs to avoid processes    *
+ *           blocking each other.                                             *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dc_config_history_sync_get_items_export_info(const zbx_uint64_t *itemids, int itemids_num, char **names,
+		zbx_vector_tags_t *tags)
+{
+	const ZBX_DC_ITEM	*dc_item;
+
+	RDLOCK_CACHE_CONFIG_HISTORY;
+
+	for (int i = 0; i < itemids_num; i++)
+	{
+		if (NULL == (dc_item = (const ZBX_DC_ITEM *)zbx_hashset_search(&config->items, &itemids[i])))
+			continue;
+
+		names[i] = zbx_strdup(names[i], dc_item->name);
+
+		for (int j = 0; j < dc_item->tags.values_num; j++)
+		{
+			const zbx_dc_item_tag_t	*dc_tag = (const zbx_dc_item_tag_t *)dc_item->tags.values[j];
+			zbx_tag_t		*tag;
+
+			tag = (zbx_tag_t *)zbx_malloc(NULL, sizeof(zbx_tag_t));
+			tag->tag = zbx_strdup(NULL, dc_tag->tag);
+			tag->value = zbx_strdup(NULL, dc_tag->value);
+			zbx_vector_tags_append(&tags[i], tag);
+		}
+	}
+
+	UNLOCK_CACHE_CONFIG_HISTORY;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get host group names for history and trends export                *
+ *                                                                            *
+ * Parameters: hostids     - [IN] host identifiers                            *
+ *             hostids_num - [IN] number of hosts                             *
+ *             groups      - [OUT] host group names, vectors must be created  *
+ *                                 by caller                                  *
+ *                                                                            *
+ * Comments: Data is retrieved using history read lock that must be write     *
+ *           locked only when configuration sync occurs to avoid processes    *
+ *           blocking each other.                                             *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dc_config_history_sync_get_hosts_groups(const zbx_uint64_t *hostids, int hostids_num,
+		zbx_vector_str_t *groups)
+{
+	const zbx_dc_host_group_index_t	*host_group_index;
+	const zbx_dc_hostgroup_t	*group;
+
+	RDLOCK_CACHE_CONFIG_HISTORY;
+
+	for (int i = 0; i < hostids_num; i++)
+	{
+		if (NULL == (host_group_index = (const zbx_dc_host_group_index_t *)zbx_hashset_search(
+				&config->host_groups_index, &hostids[i])))
+		{
+			continue;
+		}
+
+		for (int j = 0; j < host_group_index->groupids.values_num; j++)
+		{
+			if (NULL == (group = (const zbx_dc_hostgroup_t *)zbx_hashset_search(&config->hostgroups,
+					&host_group_index->groupids.values[j])))
+			{
+				continue;
+			}
+
+			zbx_vector_str_append(&groups[i], zbx_strdup(NULL, group->name));
+		}
+	}
+
+	UNLOCK_CACHE_CONFIG_HISTORY;
+
+	for (int i = 0; i < hostids_num; i++)
+		zbx_vector_str_sort(&groups[i], ZBX_DEFAULT_STR_COMPARE_FUNC);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: get enabled triggers for specified items                          *
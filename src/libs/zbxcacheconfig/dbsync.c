@@ -1719,8 +1719,10 @@ static char	**dbsync_item_preproc_row(char **row)
 			zbx_eval_set_exception(&ctx, zbx_dsprintf(NULL, "Cannot parse formula: %s", error));
 			zbx_free(error);
 		}
+		else
+			zbx_eval_compile(&ctx);
 
-		row[49] = encode_expression(&ctx);
+		row[50] = encode_expression(&ctx);
 		zbx_eval_clear(&ctx);
 	}
 
@@ -1750,11 +1752,11 @@ int	zbx_dbsync_compare_items(zbx_dbsync_t *sync)
 				"i.master_itemid,i.timeout,i.url,i.query_fields,i.posts,i.status_codes,"
 				"i.follow_redirects,i.post_type,i.http_proxy,i.headers,i.retrieve_mode,"
 				"i.request_method,i.output_format,i.ssl_cert_file,i.ssl_key_file,i.ssl_key_password,"
-				"i.verify_peer,i.verify_host,i.allow_traps,i.templateid,null"
+				"i.verify_peer,i.verify_host,i.allow_traps,i.templateid,i.name,null"
 			" from items i"
 			" join item_rtdata ir on i.itemid=ir.itemid");
 
-	dbsync_prepare(sync, 50, dbsync_item_preproc_row);
+	dbsync_prepare(sync, 51, dbsync_item_preproc_row);
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
@@ -1994,6 +1996,8 @@ static char	**dbsync_trigger_preproc_row(char **row)
 	{
 		if (SUCCEED == zbx_eval_check_timer_functions(&ctx))
 			timer |= ZBX_TRIGGER_TIMER_EXPRESSION;
+
+		zbx_eval_compile(&ctx);
 	}
 
 	ZBX_STR2UCHAR(mode, row[10]);
@@ -2010,6 +2014,8 @@ static char	**dbsync_trigger_preproc_row(char **row)
 		{
 			if (SUCCEED == zbx_eval_check_timer_functions(&ctx_r))
 				timer |= ZBX_TRIGGER_TIMER_RECOVERY_EXPRESSION;
+
+			zbx_eval_compile(&ctx_r);
 		}
 	}
 
@@ -38,12 +38,24 @@
 #include "zbxcrypto.h"
 #include "zbxeval.h"
 
-static zbx_shmem_info_t	*hc_index_mem = NULL;
-static zbx_shmem_info_t	*hc_mem = NULL;
+/* The history cache is partitioned into shards by itemid. Each shard has its own */
+/* lock, index and data memory, so that processes working with items of different */
+/* shards do not contend. The first shard lock is the main cache lock, which also */
+/* protects global cache data.                                                     */
+#define ZBX_HC_SHARDS_MAX	(ZBX_MUTEX_CACHE_SHARDS_NUM + 1)
+
+/* minimum shard data and index memory sizes, used to calculate the number of shards */
+#define ZBX_HC_SHARD_DATA_MIN	(2 * ZBX_MEBIBYTE)
+#define ZBX_HC_SHARD_INDEX_MIN	(256 * ZBX_KIBIBYTE)
+
+static zbx_shmem_info_t	*hc_index_mem[ZBX_HC_SHARDS_MAX];
+static zbx_shmem_info_t	*hc_mem[ZBX_HC_SHARDS_MAX];
 static zbx_shmem_info_t	*trend_mem = NULL;
 
 #define	LOCK_CACHE	zbx_mutex_lock(cache_lock)
 #define	UNLOCK_CACHE	zbx_mutex_unlock(cache_lock)
+#define	LOCK_SHARD(shard)	zbx_mutex_lock(hc_shard_lock[(shard)->index])
+#define	UNLOCK_SHARD(shard)	zbx_mutex_unlock(hc_shard_lock[(shard)->index])
 #define	LOCK_TRENDS	zbx_mutex_lock(trends_lock)
 #define	UNLOCK_TRENDS	zbx_mutex_unlock(trends_lock)
 #define	LOCK_CACHE_IDS		zbx_mutex_lock(cache_ids_lock)
@@ -52,6 +64,7 @@ static zbx_shmem_info_t	*trend_mem = NULL;
 static zbx_mutex_t	cache_lock = ZBX_MUTEX_NULL;
 static zbx_mutex_t	trends_lock = ZBX_MUTEX_NULL;
 static zbx_mutex_t	cache_ids_lock = ZBX_MUTEX_NULL;
+static zbx_mutex_t	hc_shard_lock[ZBX_HC_SHARDS_MAX];
 
 static char		*sql = NULL;
 static size_t		sql_alloc = 4 * ZBX_KIBIBYTE;
@@ -104,13 +117,33 @@ zbx_hc_proxyqueue_t;
 
 typedef struct
 {
-	zbx_hashset_t		trends;
+	int			index;
+
 	zbx_dc_stats_t		stats;
 
 	zbx_hashset_t		history_items;
 	zbx_binary_heap_t	history_queue;
 
 	int			history_num;
+}
+zbx_hc_shard_t;
+
+typedef struct
+{
+	zbx_hashset_t		trends;
+
+	zbx_hc_shard_t		*shards[ZBX_HC_SHARDS_MAX];
+	int			shards_num;
+
+	int			sync_batch_min;
+	int			sync_batch_max;
+	int			sync_batch_size;
+	int			sync_batch_values;
+	double			sync_batch_time;
+
+	zbx_uint64_t		trigger_functions_num;
+	zbx_uint64_t		trigger_functions_unique;
+
 	int			trends_num;
 	int			trends_last_cleanup_hour;
 	int			history_num_total;
@@ -167,8 +200,11 @@ static size_t		string_values_alloc = 0, string_values_offset = 0;
 static dc_item_value_t	*item_values = NULL;
 static size_t		item_values_alloc = 0, item_values_num = 0;
 
-static void	hc_add_item_values(dc_item_value_t *values, int values_num);
-static void	hc_queue_item(zbx_hc_item_t *item);
+/* the current history sync batch size of history syncer process */
+static int		sync_batch_size = 0;
+
+static void	hc_add_item_values(zbx_hc_shard_t *shard, dc_item_value_t *values, int values_num);
+static void	hc_queue_item(zbx_hc_shard_t *shard, zbx_hc_item_t *item);
 static int	hc_queue_elem_compare_func(const void *d1, const void *d2);
 static int	hc_get_history_compression_age(void);
 
@@ -178,6 +214,73 @@ void	zbx_pp_value_opt_clear(zbx_pp_value_opt_t *opt)
 		zbx_free(opt->source);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns history cache shard of the specified item                 *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_hc_shard_t	*hc_get_shard(zbx_uint64_t itemid)
+{
+	return cache->shards[ZBX_DEFAULT_UINT64_HASH_FUNC(&itemid) % (zbx_hash_t)cache->shards_num];
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns number of values in history cache                         *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_get_history_num(void)
+{
+	int	history_num = 0;
+
+	for (int i = 0; i < cache->shards_num; i++)
+	{
+		zbx_hc_shard_t	*shard = cache->shards[i];
+
+		LOCK_SHARD(shard);
+		history_num += shard->history_num;
+		UNLOCK_SHARD(shard);
+	}
+
+	return history_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: retrieves history cache statistics summed over all shards         *
+ *                                                                            *
+ * Parameters: wcache_info - [OUT] write cache metrics, trend cache fields    *
+ *                                 are not set                                *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_get_shards_stats(zbx_wcache_info_t *wcache_info)
+{
+	memset(wcache_info, 0, sizeof(zbx_wcache_info_t));
+
+	for (int i = 0; i < cache->shards_num; i++)
+	{
+		zbx_hc_shard_t	*shard = cache->shards[i];
+
+		LOCK_SHARD(shard);
+
+		wcache_info->stats.history_counter += shard->stats.history_counter;
+		wcache_info->stats.history_float_counter += shard->stats.history_float_counter;
+		wcache_info->stats.history_uint_counter += shard->stats.history_uint_counter;
+		wcache_info->stats.history_str_counter += shard->stats.history_str_counter;
+		wcache_info->stats.history_log_counter += shard->stats.history_log_counter;
+		wcache_info->stats.history_text_counter += shard->stats.history_text_counter;
+		wcache_info->stats.history_bin_counter += shard->stats.history_bin_counter;
+		wcache_info->stats.notsupported_counter += shard->stats.notsupported_counter;
+
+		wcache_info->history_free += hc_mem[i]->free_size;
+		wcache_info->history_total += hc_mem[i]->total_size;
+		wcache_info->index_free += hc_index_mem[i]->free_size;
+		wcache_info->index_total += hc_index_mem[i]->total_size;
+
+		UNLOCK_SHARD(shard);
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: retrieves all internal metrics of the database cache              *
@@ -187,13 +290,9 @@ void	zbx_pp_value_opt_clear(zbx_pp_value_opt_t *opt)
  ******************************************************************************/
 void	zbx_dc_get_stats_all(zbx_wcache_info_t *wcache_info)
 {
-	LOCK_CACHE;
+	hc_get_shards_stats(wcache_info);
 
-	wcache_info->stats = cache->stats;
-	wcache_info->history_free = hc_mem->free_size;
-	wcache_info->history_total = hc_mem->total_size;
-	wcache_info->index_free = hc_index_mem->free_size;
-	wcache_info->index_total = hc_index_mem->total_size;
+	LOCK_CACHE;
 
 	if (0 != (get_program_type_cb() & ZBX_PROGRAM_TYPE_SERVER))
 	{
@@ -201,6 +300,10 @@ void	zbx_dc_get_stats_all(zbx_wcache_info_t *wcache_info)
 		wcache_info->trend_total = trend_mem->orig_size;
 	}
 
+	wcache_info->sync_batch_size = cache->sync_batch_size;
+	wcache_info->sync_batch_values = cache->sync_batch_values;
+	wcache_info->sync_batch_time = cache->sync_batch_time;
+
 	UNLOCK_CACHE;
 }
 
@@ -214,57 +317,60 @@ void	*zbx_dc_get_stats(int request)
 	static zbx_uint64_t	value_uint;
 	static double		value_double;
 	void			*ret;
+	zbx_wcache_info_t	info;
+
+	hc_get_shards_stats(&info);
 
 	LOCK_CACHE;
 
 	switch (request)
 	{
 		case ZBX_STATS_HISTORY_COUNTER:
-			value_uint = cache->stats.history_counter;
+			value_uint = info.stats.history_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_FLOAT_COUNTER:
-			value_uint = cache->stats.history_float_counter;
+			value_uint = info.stats.history_float_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_UINT_COUNTER:
-			value_uint = cache->stats.history_uint_counter;
+			value_uint = info.stats.history_uint_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_STR_COUNTER:
-			value_uint = cache->stats.history_str_counter;
+			value_uint = info.stats.history_str_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_LOG_COUNTER:
-			value_uint = cache->stats.history_log_counter;
+			value_uint = info.stats.history_log_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_TEXT_COUNTER:
-			value_uint = cache->stats.history_text_counter;
+			value_uint = info.stats.history_text_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_NOTSUPPORTED_COUNTER:
-			value_uint = cache->stats.notsupported_counter;
+			value_uint = info.stats.notsupported_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_TOTAL:
-			value_uint = hc_mem->total_size;
+			value_uint = info.history_total;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_USED:
-			value_uint = hc_mem->total_size - hc_mem->free_size;
+			value_uint = info.history_total - info.history_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_FREE:
-			value_uint = hc_mem->free_size;
+			value_uint = info.history_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_PUSED:
-			value_double = 100 * (double)(hc_mem->total_size - hc_mem->free_size) / hc_mem->total_size;
+			value_double = 100 * (double)(info.history_total - info.history_free) / info.history_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_HISTORY_PFREE:
-			value_double = 100 * (double)hc_mem->free_size / hc_mem->total_size;
+			value_double = 100 * (double)info.history_free / info.history_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_TREND_TOTAL:
@@ -289,28 +395,39 @@ void	*zbx_dc_get_stats(int request)
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_TOTAL:
-			value_uint = hc_index_mem->total_size;
+			value_uint = info.index_total;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_USED:
-			value_uint = hc_index_mem->total_size - hc_index_mem->free_size;
+			value_uint = info.index_total - info.index_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_FREE:
-			value_uint = hc_index_mem->free_size;
+			value_uint = info.index_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_PUSED:
-			value_double = 100 * (double)(hc_index_mem->total_size - hc_index_mem->free_size) /
-					hc_index_mem->total_size;
+			value_double = 100 * (double)(info.index_total - info.index_free) / info.index_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_PFREE:
-			value_double = 100 * (double)hc_index_mem->free_size / hc_index_mem->total_size;
+			value_double = 100 * (double)info.index_free / info.index_total;
+			ret = (void *)&value_double;
+			break;
+		case ZBX_STATS_SYNC_BATCH_SIZE:
+			value_uint = (zbx_uint64_t)cache->sync_batch_size;
+			ret = (void *)&value_uint;
+			break;
+		case ZBX_STATS_SYNC_BATCH_VALUES:
+			value_uint = (zbx_uint64_t)cache->sync_batch_values;
+			ret = (void *)&value_uint;
+			break;
+		case ZBX_STATS_SYNC_BATCH_TIME:
+			value_double = cache->sync_batch_time;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_HISTORY_BIN_COUNTER:
-			value_uint = cache->stats.history_bin_counter;
+			value_uint = info.stats.history_bin_counter;
 			ret = (void *)&value_uint;
 			break;
 		default:
@@ -991,7 +1108,7 @@ static void	DBmass_update_trends(const ZBX_DC_TREND *trends, int trends_num,
 typedef struct
 {
 	zbx_uint64_t		hostid;
-	zbx_vector_ptr_t	groups;
+	zbx_vector_str_t	groups;
 }
 zbx_host_info_t;
 
@@ -1004,59 +1121,38 @@ zbx_host_info_t;
  ******************************************************************************/
 static void	zbx_host_info_clean(zbx_host_info_t *host_info)
 {
-	zbx_vector_ptr_clear_ext(&host_info->groups, zbx_ptr_free);
-	zbx_vector_ptr_destroy(&host_info->groups);
+	zbx_vector_str_clear_ext(&host_info->groups, zbx_str_free);
+	zbx_vector_str_destroy(&host_info->groups);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: get hosts groups names                                            *
+ * Purpose: get hosts groups names from configuration cache                   *
  *                                                                            *
  * Parameters: hosts_info - [IN/OUT] output names of host groups for a host   *
  *             hostids    - [IN] hosts identifiers                            *
  *                                                                            *
  ******************************************************************************/
-static void	db_get_hosts_info_by_hostid(zbx_hashset_t *hosts_info, const zbx_vector_uint64_t *hostids)
+static void	dc_get_hosts_info_by_hostid(zbx_hashset_t *hosts_info, const zbx_vector_uint64_t *hostids)
 {
-	int		i;
-	size_t		sql_offset = 0;
-	zbx_db_result_t	result;
-	zbx_db_row_t	row;
-
-	for (i = 0; i < hostids->values_num; i++)
-	{
-		zbx_host_info_t	host_info = {.hostid = hostids->values[i]};
+	int			i;
+	zbx_vector_str_t	*groups;
 
-		zbx_vector_ptr_create(&host_info.groups);
-		zbx_hashset_insert(hosts_info, &host_info, sizeof(host_info));
-	}
+	groups = (zbx_vector_str_t *)zbx_malloc(NULL, sizeof(zbx_vector_str_t) * (size_t)hostids->values_num);
 
-	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
-				"select distinct hg.hostid,g.name"
-				" from hstgrp g,hosts_groups hg"
-				" where g.groupid=hg.groupid"
-					" and");
-
-	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "hg.hostid", hostids->values, hostids->values_num);
+	for (i = 0; i < hostids->values_num; i++)
+		zbx_vector_str_create(&groups[i]);
 
-	result = zbx_db_select("%s", sql);
+	zbx_dc_config_history_sync_get_hosts_groups(hostids->values, hostids->values_num, groups);
 
-	while (NULL != (row = zbx_db_fetch(result)))
+	for (i = 0; i < hostids->values_num; i++)
 	{
-		zbx_uint64_t	hostid;
-		zbx_host_info_t	*host_info;
-
-		ZBX_DBROW2UINT64(hostid, row[0]);
+		zbx_host_info_t	host_info = {.hostid = hostids->values[i], .groups = groups[i]};
 
-		if (NULL == (host_info = (zbx_host_info_t *)zbx_hashset_search(hosts_info, &hostid)))
-		{
-			THIS_SHOULD_NEVER_HAPPEN;
-			continue;
-		}
-
-		zbx_vector_ptr_append(&host_info->groups, zbx_strdup(NULL, row[1]));
+		zbx_hashset_insert(hosts_info, &host_info, sizeof(host_info));
 	}
-	zbx_db_free_result(result);
+
+	zbx_free(groups);
 }
 
 typedef struct
@@ -1070,109 +1166,47 @@ zbx_item_info_t;
 
 /******************************************************************************
  *                                                                            *
- * Purpose: get item names                                                    *
+ * Purpose: get item names and item tags from configuration cache             *
  *                                                                            *
- * Parameters: items_info - [IN/OUT] output item names                        *
+ * Parameters: items_info - [IN/OUT] output item name and item tags           *
  *             itemids    - [IN] the item identifiers                         *
  *                                                                            *
  ******************************************************************************/
-static void	db_get_item_names_by_itemid(zbx_hashset_t *items_info, const zbx_vector_uint64_t *itemids)
+static void	dc_get_items_info_by_itemid(zbx_hashset_t *items_info, const zbx_vector_uint64_t *itemids)
 {
-	size_t		sql_offset = 0;
-	zbx_db_result_t	result;
-	zbx_db_row_t	row;
+	int			i;
+	char			**names;
+	zbx_vector_tags_t	*tags;
 
-	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "select itemid,name from items where");
-	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "itemid", itemids->values, itemids->values_num);
+	names = (char **)zbx_calloc(NULL, (size_t)itemids->values_num, sizeof(char *));
+	tags = (zbx_vector_tags_t *)zbx_malloc(NULL, sizeof(zbx_vector_tags_t) * (size_t)itemids->values_num);
 
-	result = zbx_db_select("%s", sql);
+	for (i = 0; i < itemids->values_num; i++)
+		zbx_vector_tags_create(&tags[i]);
 
-	while (NULL != (row = zbx_db_fetch(result)))
+	zbx_dc_config_history_sync_get_items_export_info(itemids->values, itemids->values_num, names, tags);
+
+	for (i = 0; i < itemids->values_num; i++)
 	{
-		zbx_uint64_t	itemid;
 		zbx_item_info_t	*item_info;
 
-		ZBX_DBROW2UINT64(itemid, row[0]);
-
-		if (NULL == (item_info = (zbx_item_info_t *)zbx_hashset_search(items_info, &itemid)))
+		if (NULL == (item_info = (zbx_item_info_t *)zbx_hashset_search(items_info, &itemids->values[i])))
 		{
 			THIS_SHOULD_NEVER_HAPPEN;
+			zbx_free(names[i]);
+			zbx_vector_tags_destroy(&tags[i]);
 			continue;
 		}
 
-		item_info->name = zbx_strdup(item_info->name, row[1]);
-	}
-
-	zbx_db_free_result(result);
-}
-
-/******************************************************************************
- *                                                                            *
- * Purpose: get item tags                                                     *
- *                                                                            *
- * Parameters: items_info - [IN/OUT] output item tags                         *
- *             itemids    - [IN] the item identifiers                         *
- *                                                                            *
- ******************************************************************************/
-static void	db_get_item_tags_by_itemid(zbx_hashset_t *items_info, const zbx_vector_uint64_t *itemids)
-{
-	size_t		sql_offset = 0;
-	zbx_db_result_t	result;
-	zbx_db_row_t	row;
-	zbx_item_info_t	*item_info = NULL;
-
-	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "select itemid,tag,value from item_tag where");
-	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "itemid", itemids->values, itemids->values_num);
-	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " order by itemid");
-
-	result = zbx_db_select("%s", sql);
-
-	while (NULL != (row = zbx_db_fetch(result)))
-	{
-		zbx_uint64_t	itemid;
-		zbx_tag_t	*item_tag;
-
-		ZBX_DBROW2UINT64(itemid, row[0]);
-
-		if (NULL == item_info || item_info->itemid != itemid)
-		{
-			if (NULL != item_info)
-			{
-				zbx_vector_tags_sort(&item_info->item_tags, zbx_compare_tags);
-			}
-			if (NULL == (item_info = (zbx_item_info_t *)zbx_hashset_search(items_info, &itemid)))
-			{
-				THIS_SHOULD_NEVER_HAPPEN;
-				continue;
-			}
-		}
-
-		item_tag = (zbx_tag_t *)zbx_malloc(NULL, sizeof(*item_tag));
-		item_tag->tag = zbx_strdup(NULL, row[1]);
-		item_tag->value = zbx_strdup(NULL, row[2]);
-		zbx_vector_tags_append(&item_info->item_tags, item_tag);
-	}
+		zbx_vector_tags_sort(&tags[i], zbx_compare_tags);
 
-	if (NULL != item_info)
-	{
-		zbx_vector_tags_sort(&item_info->item_tags, zbx_compare_tags);
+		zbx_vector_tags_destroy(&item_info->item_tags);
+		item_info->item_tags = tags[i];
+		item_info->name = names[i];
 	}
 
-	zbx_db_free_result(result);
-}
-
-/******************************************************************************
- *                                                                            *
- * Purpose: get item names and item tags                                      *
- *                                                                            *
- * Parameters: items_info - [IN/OUT] output item name and item tags           *
- *             itemids    - [IN] the item identifiers                         *
- *                                                                            *
- ******************************************************************************/
-static void	db_get_items_info_by_itemid(zbx_hashset_t *items_info, const zbx_vector_uint64_t *itemids)
-{
-	db_get_item_names_by_itemid(items_info, itemids);
-	db_get_item_tags_by_itemid(items_info, itemids);
+	zbx_free(tags);
+	zbx_free(names);
 }
 
 /******************************************************************************
@@ -1557,9 +1591,8 @@ static void	DCexport_history_and_trends(const zbx_dc_history_t *history, int his
 			ZBX_DEFAULT_UINT64_COMPARE_FUNC, (zbx_clean_func_t)zbx_host_info_clean,
 			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
 
-	db_get_hosts_info_by_hostid(&hosts_info, &hostids);
-
-	db_get_items_info_by_itemid(&items_info, &item_info_ids);
+	dc_get_hosts_info_by_hostid(&hosts_info, &hostids);
+	dc_get_items_info_by_itemid(&items_info, &item_info_ids);
 
 	if (0 != history_num)
 	{
@@ -1874,6 +1907,24 @@ out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates trigger function deduplication statistics                 *
+ *                                                                            *
+ * Parameters: functions_num    - [IN] number of trigger functions            *
+ *             functions_unique - [IN] number of evaluated unique functions   *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_update_trigger_function_stats(int functions_num, int functions_unique)
+{
+	LOCK_CACHE;
+
+	cache->trigger_functions_num += (zbx_uint64_t)functions_num;
+	cache->trigger_functions_unique += (zbx_uint64_t)functions_unique;
+
+	UNLOCK_CACHE;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: re-calculate and update values of triggers related to the items   *
@@ -1900,7 +1951,7 @@ static void	recalculate_triggers(const zbx_dc_history_t *history, int history_nu
 		zbx_vector_ptr_t *trigger_diff, zbx_uint64_t *itemids, zbx_timespec_t *timespecs,
 		zbx_hashset_t *trigger_info, zbx_vector_dc_trigger_t *trigger_order)
 {
-	int			i, item_num = 0, timers_num = 0;
+	int			i, item_num = 0, timers_num = 0, functions_num, functions_unique;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -1958,9 +2009,13 @@ static void	recalculate_triggers(const zbx_dc_history_t *history, int history_nu
 	}
 
 	zbx_vector_dc_trigger_sort(trigger_order, ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC);
-	zbx_evaluate_expressions(trigger_order, history_itemids, history_items, history_errcodes);
+	zbx_evaluate_expressions(trigger_order, history_itemids, history_items, history_errcodes, &functions_num,
+			&functions_unique);
 	process_triggers(trigger_order, add_event_cb, trigger_diff);
 
+	if (0 != functions_num)
+		hc_update_trigger_function_stats(functions_num, functions_unique);
+
 	zbx_dc_free_triggers(trigger_order);
 
 	zbx_hashset_clear(trigger_info);
@@ -2952,18 +3007,18 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 	static ZBX_HISTORY_TEXT		*history_text;
 	static ZBX_HISTORY_LOG		*history_log;
 	static int			module_enabled = FAIL;
-	int				i, history_num, history_float_num, history_integer_num, history_string_num,
-					history_text_num, history_log_num, txn_error, compression_age,
-					connectors_retrieved = FAIL;
+	static zbx_dc_history_t		*history;
+	static zbx_uint64_t		*trigger_itemids;
+	static zbx_timespec_t		*trigger_timespecs;
+	int				i, history_num, batch_max, batch_items_num, queue_size, history_float_num,
+					history_integer_num, history_string_num, history_text_num, history_log_num,
+					txn_error, compression_age, connectors_retrieved = FAIL;
 	unsigned int			item_retrieve_mode;
 	time_t				sync_start;
 	zbx_vector_uint64_t		triggerids ;
 	zbx_vector_ptr_t		history_items, trigger_diff, item_diff, inventory_values, trigger_timers;
 	zbx_vector_dc_trigger_t		trigger_order;
 	zbx_vector_uint64_pair_t	trends_diff, proxy_subscriptions;
-	zbx_dc_history_t		history[ZBX_HC_SYNC_MAX];
-	zbx_uint64_t			trigger_itemids[ZBX_HC_SYNC_MAX];
-	zbx_timespec_t			trigger_timespecs[ZBX_HC_SYNC_MAX];
 	zbx_history_sync_item_t		*items = NULL;
 	int				*errcodes = NULL;
 	zbx_vector_uint64_t		itemids;
@@ -2972,39 +3027,48 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 	size_t				data_alloc = 0, data_offset;
 	zbx_vector_connector_filter_t	connector_filters_history, connector_filters_events;
 
+	batch_max = hc_get_sync_batch_max();
+
+	if (NULL == history)
+	{
+		history = (zbx_dc_history_t *)zbx_malloc(NULL, (size_t)batch_max * sizeof(zbx_dc_history_t));
+		trigger_itemids = (zbx_uint64_t *)zbx_malloc(NULL, (size_t)batch_max * sizeof(zbx_uint64_t));
+		trigger_timespecs = (zbx_timespec_t *)zbx_malloc(NULL, (size_t)batch_max * sizeof(zbx_timespec_t));
+	}
+
 	if (NULL == history_float && NULL != history_float_cbs)
 	{
 		module_enabled = SUCCEED;
 		history_float = (ZBX_HISTORY_FLOAT *)zbx_malloc(history_float,
-				ZBX_HC_SYNC_MAX * sizeof(ZBX_HISTORY_FLOAT));
+				(size_t)batch_max * sizeof(ZBX_HISTORY_FLOAT));
 	}
 
 	if (NULL == history_integer && NULL != history_integer_cbs)
 	{
 		module_enabled = SUCCEED;
 		history_integer = (ZBX_HISTORY_INTEGER *)zbx_malloc(history_integer,
-				ZBX_HC_SYNC_MAX * sizeof(ZBX_HISTORY_INTEGER));
+				(size_t)batch_max * sizeof(ZBX_HISTORY_INTEGER));
 	}
 
 	if (NULL == history_string && NULL != history_string_cbs)
 	{
 		module_enabled = SUCCEED;
 		history_string = (ZBX_HISTORY_STRING *)zbx_malloc(history_string,
-				ZBX_HC_SYNC_MAX * sizeof(ZBX_HISTORY_STRING));
+				(size_t)batch_max * sizeof(ZBX_HISTORY_STRING));
 	}
 
 	if (NULL == history_text && NULL != history_text_cbs)
 	{
 		module_enabled = SUCCEED;
 		history_text = (ZBX_HISTORY_TEXT *)zbx_malloc(history_text,
-				ZBX_HC_SYNC_MAX * sizeof(ZBX_HISTORY_TEXT));
+				(size_t)batch_max * sizeof(ZBX_HISTORY_TEXT));
 	}
 
 	if (NULL == history_log && NULL != history_log_cbs)
 	{
 		module_enabled = SUCCEED;
 		history_log = (ZBX_HISTORY_LOG *)zbx_malloc(history_log,
-				ZBX_HC_SYNC_MAX * sizeof(ZBX_HISTORY_LOG));
+				(size_t)batch_max * sizeof(ZBX_HISTORY_LOG));
 	}
 
 	compression_age = hc_get_history_compression_age();
@@ -3018,13 +3082,13 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 	zbx_vector_uint64_pair_create(&proxy_subscriptions);
 
 	zbx_vector_uint64_create(&triggerids);
-	zbx_vector_uint64_reserve(&triggerids, ZBX_HC_SYNC_MAX);
+	zbx_vector_uint64_reserve(&triggerids, (size_t)batch_max);
 
 	zbx_vector_ptr_create(&trigger_timers);
 	zbx_vector_ptr_reserve(&trigger_timers, ZBX_HC_TIMER_MAX);
 
 	zbx_vector_ptr_create(&history_items);
-	zbx_vector_ptr_reserve(&history_items, ZBX_HC_SYNC_MAX);
+	zbx_vector_ptr_reserve(&history_items, (size_t)batch_max);
 
 	zbx_vector_dc_trigger_create(&trigger_order);
 	zbx_hashset_create(&trigger_info, 100, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
@@ -3039,20 +3103,20 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 	{
 		int			trends_num = 0, timers_num = 0, ret = SUCCEED;
 		ZBX_DC_TREND		*trends = NULL;
+		double			batch_start;
 
 		*more = ZBX_SYNC_DONE;
+		batch_start = zbx_time();
 
-		LOCK_CACHE;
-		hc_pop_items(&history_items);		/* select and take items out of history cache */
-		UNLOCK_CACHE;
+		hc_pop_items(&history_items, hc_get_sync_batch_size());	/* select and take items out of history cache */
+		batch_items_num = history_items.values_num;
+		queue_size = 0;
 
 		if (0 != history_items.values_num)
 		{
 			if (0 == (history_num = zbx_dc_config_lock_triggers_by_history_items(&history_items, &triggerids)))
 			{
-				LOCK_CACHE;
 				hc_push_items(&history_items);
-				UNLOCK_CACHE;
 				zbx_vector_ptr_clear(&history_items);
 			}
 		}
@@ -3080,11 +3144,11 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 			if (NULL == items)
 			{
 				items = (zbx_history_sync_item_t *)zbx_malloc(NULL, sizeof(zbx_history_sync_item_t) *
-						(size_t)ZBX_HC_SYNC_MAX);
+						(size_t)batch_max);
 			}
 
 			if (NULL == errcodes)
-				errcodes = (int *)zbx_malloc(NULL, sizeof(int) * (size_t)ZBX_HC_SYNC_MAX);
+				errcodes = (int *)zbx_malloc(NULL, sizeof(int) * (size_t)batch_max);
 
 			zbx_vector_uint64_reserve(&itemids, history_num);
 
@@ -3230,11 +3294,9 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 
 		if (0 != history_num)
 		{
-			LOCK_CACHE;
 			hc_push_items(&history_items);	/* return items to history cache */
-			cache->history_num -= history_num;
 
-			if (0 != hc_queue_get_size())
+			if (0 != (queue_size = hc_queue_get_size()))
 			{
 				/* Continue sync if enough of sync candidates were processed       */
 				/* (meaning most of sync candidates are not locked by triggers).   */
@@ -3245,8 +3307,6 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 					*more = ZBX_SYNC_MORE;
 			}
 
-			UNLOCK_CACHE;
-
 			*values_num += history_num;
 		}
 
@@ -3346,6 +3406,8 @@ void	zbx_sync_server_history(int *values_num, int *triggers_num, const zbx_event
 
 			zbx_vector_ptr_clear(&history_items);
 			hc_free_item_values(history, history_num);
+
+			hc_update_sync_batch_size(batch_items_num, history_num, queue_size, zbx_time() - batch_start);
 		}
 
 		zbx_vector_uint64_clear(&itemids);
@@ -3393,9 +3455,9 @@ static void	sync_history_cache_full(const zbx_events_funcs_t *events_cbs)
 	int			values_num = 0, triggers_num = 0, more;
 	zbx_hashset_iter_t	iter;
 	zbx_hc_item_t		*item;
-	zbx_binary_heap_t	tmp_history_queue;
+	zbx_binary_heap_t	tmp_history_queue[ZBX_HC_SHARDS_MAX];
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __func__, cache->history_num);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __func__, hc_get_history_num());
 
 	/* History index cache might be full without any space left for queueing items from history index to  */
 	/* history queue. The solution: replace the shared-memory history queue with heap-allocated one. Add  */
@@ -3414,18 +3476,24 @@ static void	sync_history_cache_full(const zbx_events_funcs_t *events_cbs)
 		zbx_dc_config_unlock_all_triggers();
 	}
 
-	tmp_history_queue = cache->history_queue;
+	for (int i = 0; i < cache->shards_num; i++)
+	{
+		zbx_hc_shard_t	*shard = cache->shards[i];
 
-	zbx_binary_heap_create(&cache->history_queue, hc_queue_elem_compare_func, ZBX_BINARY_HEAP_OPTION_EMPTY);
-	zbx_hashset_iter_reset(&cache->history_items, &iter);
+		tmp_history_queue[i] = shard->history_queue;
 
-	/* add all items from history index to the new history queue */
-	while (NULL != (item = (zbx_hc_item_t *)zbx_hashset_iter_next(&iter)))
-	{
-		if (NULL != item->tail)
+		zbx_binary_heap_create(&shard->history_queue, hc_queue_elem_compare_func,
+				ZBX_BINARY_HEAP_OPTION_EMPTY);
+		zbx_hashset_iter_reset(&shard->history_items, &iter);
+
+		/* add all items from history index to the new history queue */
+		while (NULL != (item = (zbx_hc_item_t *)zbx_hashset_iter_next(&iter)))
 		{
-			item->status = ZBX_HC_ITEM_STATUS_NORMAL;
-			hc_queue_item(item);
+			if (NULL != item->tail)
+			{
+				item->status = ZBX_HC_ITEM_STATUS_NORMAL;
+				hc_queue_item(shard, item);
+			}
 		}
 	}
 
@@ -3438,15 +3506,20 @@ static void	sync_history_cache_full(const zbx_events_funcs_t *events_cbs)
 			sync_history_cb(&values_num, &triggers_num, events_cbs, &more);
 
 			zabbix_log(LOG_LEVEL_WARNING, "syncing history data... " ZBX_FS_DBL "%%",
-					(double)values_num / (cache->history_num + values_num) * 100);
+					(double)values_num / (hc_get_history_num() + values_num) * 100);
 		}
 		while (0 != hc_queue_get_size());
 
 		zabbix_log(LOG_LEVEL_WARNING, "syncing history data done");
 	}
 
-	zbx_binary_heap_destroy(&cache->history_queue);
-	cache->history_queue = tmp_history_queue;
+	for (int i = 0; i < cache->shards_num; i++)
+	{
+		zbx_hc_shard_t	*shard = cache->shards[i];
+
+		zbx_binary_heap_destroy(&shard->history_queue);
+		shard->history_queue = tmp_history_queue[i];
+	}
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
@@ -3459,7 +3532,10 @@ static void	sync_history_cache_full(const zbx_events_funcs_t *events_cbs)
 void	zbx_log_sync_history_cache_progress(void)
 {
 	double		pcnt = -1.0;
-	int		ts_last, ts_next, sec;
+	int		ts_last, ts_next, sec, history_num;
+
+	/* the first shard lock is the cache lock, so the values must be counted before locking cache */
+	history_num = hc_get_history_num();
 
 	LOCK_CACHE;
 
@@ -3474,16 +3550,16 @@ void	zbx_log_sync_history_cache_progress(void)
 
 	if (0 == cache->history_progress_ts)
 	{
-		cache->history_num_total = cache->history_num;
+		cache->history_num_total = history_num;
 		cache->history_progress_ts = sec;
 	}
 
-	if (ZBX_HC_SYNC_TIME_MAX <= sec - cache->history_progress_ts || 0 == cache->history_num)
+	if (ZBX_HC_SYNC_TIME_MAX <= sec - cache->history_progress_ts || 0 == history_num)
 	{
 		if (0 != cache->history_num_total)
-			pcnt = 100 * (double)(cache->history_num_total - cache->history_num) / cache->history_num_total;
+			pcnt = 100 * (double)(cache->history_num_total - history_num) / cache->history_num_total;
 
-		cache->history_progress_ts = (0 == cache->history_num ? INT_MAX : sec);
+		cache->history_progress_ts = (0 == history_num ? INT_MAX : sec);
 	}
 
 	ts_next = cache->history_progress_ts;
@@ -3515,7 +3591,7 @@ void	zbx_log_sync_history_cache_progress(void)
  ******************************************************************************/
 void	zbx_sync_history_cache(const zbx_events_funcs_t *events_cbs, int *values_num, int *triggers_num, int *more)
 {
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __func__, cache->history_num);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	*values_num = 0;
 	*triggers_num = 0;
@@ -4029,17 +4105,67 @@ void	zbx_dc_add_history_variant(zbx_uint64_t itemid, unsigned char value_type, u
 
 void	zbx_dc_flush_history(void)
 {
+	static dc_item_value_t	*shard_values = NULL;
+	static size_t		shard_values_alloc = 0;
+	int			offsets[ZBX_HC_SHARDS_MAX + 1];
+	unsigned char		*shard_index;
+	size_t			i;
+
 	if (0 == item_values_num)
 		return;
 
-	LOCK_CACHE;
+	if (1 == cache->shards_num)
+	{
+		zbx_hc_shard_t	*shard = cache->shards[0];
 
-	hc_add_item_values(item_values, item_values_num);
+		LOCK_SHARD(shard);
+		hc_add_item_values(shard, item_values, (int)item_values_num);
+		shard->history_num += (int)item_values_num;
+		UNLOCK_SHARD(shard);
 
-	cache->history_num += item_values_num;
+		goto out;
+	}
 
-	UNLOCK_CACHE;
+	/* group values by shards, preserving order of values of the same item */
 
+	if (shard_values_alloc < item_values_alloc)
+	{
+		shard_values_alloc = item_values_alloc;
+		shard_values = (dc_item_value_t *)zbx_realloc(shard_values, sizeof(dc_item_value_t) * shard_values_alloc);
+	}
+
+	shard_index = (unsigned char *)zbx_malloc(NULL, item_values_num);
+	memset(offsets, 0, sizeof(offsets));
+
+	for (i = 0; i < item_values_num; i++)
+	{
+		shard_index[i] = (unsigned char)hc_get_shard(item_values[i].itemid)->index;
+		offsets[shard_index[i] + 1]++;
+	}
+
+	for (int j = 0; j < cache->shards_num; j++)
+		offsets[j + 1] += offsets[j];
+
+	for (i = 0; i < item_values_num; i++)
+		shard_values[offsets[shard_index[i]]++] = item_values[i];
+
+	zbx_free(shard_index);
+
+	/* after placing values the offsets point at the end of each shard values */
+	for (int j = 0, start = 0; j < cache->shards_num; start = offsets[j++])
+	{
+		zbx_hc_shard_t	*shard = cache->shards[j];
+		int		values_num = offsets[j] - start;
+
+		if (0 == values_num)
+			continue;
+
+		LOCK_SHARD(shard);
+		hc_add_item_values(shard, shard_values + start, values_num);
+		shard->history_num += values_num;
+		UNLOCK_SHARD(shard);
+	}
+out:
 	zbx_vps_monitor_add_collected((zbx_uint64_t)item_values_num);
 
 	item_values_num = 0;
@@ -4051,8 +4177,40 @@ void	zbx_dc_flush_history(void)
  * history cache storage                                                      *
  *                                                                            *
  ******************************************************************************/
-ZBX_SHMEM_FUNC_IMPL(__hc_index, hc_index_mem)
-ZBX_SHMEM_FUNC_IMPL(__hc, hc_mem)
+ZBX_SHMEM_FUNC_IMPL(__hc_index0, hc_index_mem[0])
+ZBX_SHMEM_FUNC_IMPL(__hc_index1, hc_index_mem[1])
+ZBX_SHMEM_FUNC_IMPL(__hc_index2, hc_index_mem[2])
+ZBX_SHMEM_FUNC_IMPL(__hc_index3, hc_index_mem[3])
+ZBX_SHMEM_FUNC_IMPL(__hc_index4, hc_index_mem[4])
+ZBX_SHMEM_FUNC_IMPL(__hc_index5, hc_index_mem[5])
+ZBX_SHMEM_FUNC_IMPL(__hc_index6, hc_index_mem[6])
+ZBX_SHMEM_FUNC_IMPL(__hc_index7, hc_index_mem[7])
+
+typedef struct
+{
+	zbx_mem_malloc_func_t	mem_malloc_func;
+	zbx_mem_realloc_func_t	mem_realloc_func;
+	zbx_mem_free_func_t	mem_free_func;
+}
+zbx_hc_index_mem_funcs_t;
+
+#define ZBX_HC_INDEX_MEM_FUNCS(__prefix)	\
+	{__prefix ## _shmem_malloc_func, __prefix ## _shmem_realloc_func, __prefix ## _shmem_free_func}
+
+#if 8 != ZBX_HC_SHARDS_MAX
+#	error "history cache shard index memory allocators must match ZBX_HC_SHARDS_MAX"
+#endif
+
+static const zbx_hc_index_mem_funcs_t	hc_index_mem_funcs[ZBX_HC_SHARDS_MAX] = {
+	ZBX_HC_INDEX_MEM_FUNCS(__hc_index0),
+	ZBX_HC_INDEX_MEM_FUNCS(__hc_index1),
+	ZBX_HC_INDEX_MEM_FUNCS(__hc_index2),
+	ZBX_HC_INDEX_MEM_FUNCS(__hc_index3),
+	ZBX_HC_INDEX_MEM_FUNCS(__hc_index4),
+	ZBX_HC_INDEX_MEM_FUNCS(__hc_index5),
+	ZBX_HC_INDEX_MEM_FUNCS(__hc_index6),
+	ZBX_HC_INDEX_MEM_FUNCS(__hc_index7)
+};
 
 /******************************************************************************
  *                                                                            *
@@ -4075,14 +4233,17 @@ static int	hc_queue_elem_compare_func(const void *d1, const void *d2)
  *                                                                            *
  * Purpose: free history item data allocated in history cache                 *
  *                                                                            *
- * Parameters: data - [IN] history item data                                  *
+ * Parameters: shard - [IN] history cache shard                               *
+ *             data  - [IN] history item data                                 *
  *                                                                            *
  ******************************************************************************/
-static void	hc_free_data(zbx_hc_data_t *data)
+static void	hc_free_data(zbx_hc_shard_t *shard, zbx_hc_data_t *data)
 {
+	zbx_shmem_info_t	*mem = hc_mem[shard->index];
+
 	if (ITEM_STATE_NOTSUPPORTED == data->state)
 	{
-		__hc_shmem_free_func(data->value.str);
+		zbx_shmem_free(mem, data->value.str);
 	}
 	else
 	{
@@ -4093,15 +4254,15 @@ static void	hc_free_data(zbx_hc_data_t *data)
 				case ITEM_VALUE_TYPE_STR:
 				case ITEM_VALUE_TYPE_TEXT:
 				case ITEM_VALUE_TYPE_BIN:
-					__hc_shmem_free_func(data->value.str);
+					zbx_shmem_free(mem, data->value.str);
 					break;
 				case ITEM_VALUE_TYPE_LOG:
-					__hc_shmem_free_func(data->value.log->value);
+					zbx_shmem_free(mem, data->value.log->value);
 
 					if (NULL != data->value.log->source)
-						__hc_shmem_free_func(data->value.log->source);
+						zbx_shmem_free(mem, data->value.log->source);
 
-					__hc_shmem_free_func(data->value.log);
+					zbx_shmem_free(mem, data->value.log);
 					break;
 				case ITEM_VALUE_TYPE_UINT64:
 				case ITEM_VALUE_TYPE_FLOAT:
@@ -4114,69 +4275,73 @@ static void	hc_free_data(zbx_hc_data_t *data)
 		}
 	}
 
-	__hc_shmem_free_func(data);
+	zbx_shmem_free(mem, data);
 }
 
 /******************************************************************************
  *                                                                            *
  * Purpose: put back item into history queue                                  *
  *                                                                            *
- * Parameters: data - [IN] history item data                                  *
+ * Parameters: shard - [IN] history cache shard                               *
+ *             item  - [IN] history item                                      *
  *                                                                            *
  ******************************************************************************/
-static void	hc_queue_item(zbx_hc_item_t *item)
+static void	hc_queue_item(zbx_hc_shard_t *shard, zbx_hc_item_t *item)
 {
 	zbx_binary_heap_elem_t	elem = {item->itemid, (void *)item};
 
-	zbx_binary_heap_insert(&cache->history_queue, &elem);
+	zbx_binary_heap_insert(&shard->history_queue, &elem);
 }
 
 /******************************************************************************
  *                                                                            *
  * Purpose: returns history item by itemid                                    *
  *                                                                            *
- * Parameters: itemid - [IN] the item id                                      *
+ * Parameters: shard  - [IN] history cache shard                              *
+ *             itemid - [IN] the item id                                      *
  *                                                                            *
  * Return value: the history item or NULL if the requested item is not in     *
  *               history cache                                                *
  *                                                                            *
  ******************************************************************************/
-static zbx_hc_item_t	*hc_get_item(zbx_uint64_t itemid)
+static zbx_hc_item_t	*hc_get_item(zbx_hc_shard_t *shard, zbx_uint64_t itemid)
 {
-	return (zbx_hc_item_t *)zbx_hashset_search(&cache->history_items, &itemid);
+	return (zbx_hc_item_t *)zbx_hashset_search(&shard->history_items, &itemid);
 }
 
 /******************************************************************************
  *                                                                            *
  * Purpose: adds a new item to history cache                                  *
  *                                                                            *
- * Parameters: itemid - [IN] the item id                                      *
- *                      [IN] the item data                                    *
+ * Parameters: shard  - [IN] history cache shard                              *
+ *             itemid - [IN] the item id                                      *
+ *             data   - [IN] the item data                                    *
  *                                                                            *
  * Return value: the added history item                                       *
  *                                                                            *
  ******************************************************************************/
-static zbx_hc_item_t	*hc_add_item(zbx_uint64_t itemid, zbx_hc_data_t *data)
+static zbx_hc_item_t	*hc_add_item(zbx_hc_shard_t *shard, zbx_uint64_t itemid, zbx_hc_data_t *data)
 {
 	zbx_hc_item_t	item_local = {itemid, ZBX_HC_ITEM_STATUS_NORMAL, 0, data, data};
 
-	return (zbx_hc_item_t *)zbx_hashset_insert(&cache->history_items, &item_local, sizeof(item_local));
+	return (zbx_hc_item_t *)zbx_hashset_insert(&shard->history_items, &item_local, sizeof(item_local));
 }
 
 /******************************************************************************
  *                                                                            *
  * Purpose: copies string value to history cache                              *
  *                                                                            *
- * Parameters: str - [IN] the string value                                    *
+ * Parameters: shard - [IN] history cache shard                               *
+ *             str   - [IN] the string value                                  *
  *                                                                            *
  * Return value: the copied string or NULL if there was not enough memory     *
  *                                                                            *
  ******************************************************************************/
-static char	*hc_mem_value_str_dup(const dc_value_str_t *str)
+static char	*hc_mem_value_str_dup(zbx_hc_shard_t *shard, const dc_value_str_t *str)
 {
 	char	*ptr;
 
-	if (NULL == (ptr = (char *)__hc_shmem_malloc_func(NULL, str->len)))
+	if (NULL == (ptr = (char *)zbx_shmem_malloc(hc_mem[shard->index], NULL, str->len)))
 		return NULL;
 
 	memcpy(ptr, &string_values[str->pvalue], str->len - 1);
@@ -4189,8 +4354,9 @@ static char	*hc_mem_value_str_dup(const dc_value_str_t *str)
  *                                                                            *
  * Purpose: clones string value into history data memory                      *
  *                                                                            *
- * Parameters: dst - [IN/OUT] a reference to the cloned value                 *
- *             str - [IN] the string value to clone                           *
+ * Parameters: shard - [IN] history cache shard                               *
+ *             dst   - [IN/OUT] a reference to the cloned value               *
+ *             str   - [IN] the string value to clone                         *
  *                                                                            *
  * Return value: SUCCESS - either there was no need to clone the string       *
  *                         (it was empty or already cloned) or the string was *
@@ -4201,7 +4367,7 @@ static char	*hc_mem_value_str_dup(const dc_value_str_t *str)
  *           until it finishes cloning string value.                          *
  *                                                                            *
  ******************************************************************************/
-static int	hc_clone_history_str_data(char **dst, const dc_value_str_t *str)
+static int	hc_clone_history_str_data(zbx_hc_shard_t *shard, char **dst, const dc_value_str_t *str)
 {
 	if (0 == str->len)
 		return SUCCEED;
@@ -4209,7 +4375,7 @@ static int	hc_clone_history_str_data(char **dst, const dc_value_str_t *str)
 	if (NULL != *dst)
 		return SUCCEED;
 
-	if (NULL != (*dst = hc_mem_value_str_dup(str)))
+	if (NULL != (*dst = hc_mem_value_str_dup(shard, str)))
 		return SUCCEED;
 
 	return FAIL;
@@ -4219,7 +4385,8 @@ static int	hc_clone_history_str_data(char **dst, const dc_value_str_t *str)
  *                                                                            *
  * Purpose: clones log value into history data memory                         *
  *                                                                            *
- * Parameters: dst        - [IN/OUT] a reference to the cloned value          *
+ * Parameters: shard      - [IN] history cache shard                         *
+ *             dst        - [IN/OUT] a reference to the cloned value          *
  *             item_value - [IN] the log value to clone                       *
  *                                                                            *
  * Return value: SUCCESS - the log value was cloned successfully              *
@@ -4229,21 +4396,22 @@ static int	hc_clone_history_str_data(char **dst, const dc_value_str_t *str)
  *           until it finishes cloning log value.                             *
  *                                                                            *
  ******************************************************************************/
-static int	hc_clone_history_log_data(zbx_log_value_t **dst, const dc_item_value_t *item_value)
+static int	hc_clone_history_log_data(zbx_hc_shard_t *shard, zbx_log_value_t **dst,
+		const dc_item_value_t *item_value)
 {
 	if (NULL == *dst)
 	{
-		/* using realloc instead of malloc just to suppress 'not used' warning for realloc */
-		if (NULL == (*dst = (zbx_log_value_t *)__hc_shmem_realloc_func(NULL, sizeof(zbx_log_value_t))))
+		if (NULL == (*dst = (zbx_log_value_t *)zbx_shmem_malloc(hc_mem[shard->index], NULL,
+				sizeof(zbx_log_value_t))))
 			return FAIL;
 
 		memset(*dst, 0, sizeof(zbx_log_value_t));
 	}
 
-	if (SUCCEED != hc_clone_history_str_data(&(*dst)->value, &item_value->value.value_str))
+	if (SUCCEED != hc_clone_history_str_data(shard, &(*dst)->value, &item_value->value.value_str))
 		return FAIL;
 
-	if (SUCCEED != hc_clone_history_str_data(&(*dst)->source, &item_value->source))
+	if (SUCCEED != hc_clone_history_str_data(shard, &(*dst)->source, &item_value->source))
 		return FAIL;
 
 	(*dst)->logeventid = item_value->logeventid;
@@ -4257,7 +4425,8 @@ static int	hc_clone_history_log_data(zbx_log_value_t **dst, const dc_item_value_
  *                                                                            *
  * Purpose: clones item value from local cache into history cache             *
  *                                                                            *
- * Parameters: data       - [IN/OUT] a reference to the cloned value          *
+ * Parameters: shard      - [IN] history cache shard                         *
+ *             data       - [IN/OUT] a reference to the cloned value          *
  *             item_value - [IN] the item value                               *
  *                                                                            *
  * Return value: SUCCESS - the item value was cloned successfully             *
@@ -4267,11 +4436,13 @@ static int	hc_clone_history_log_data(zbx_log_value_t **dst, const dc_item_value_
  *           until it finishes cloning item value.                            *
  *                                                                            *
  ******************************************************************************/
-static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *item_value)
+static int	hc_clone_history_data(zbx_hc_shard_t *shard, zbx_hc_data_t **data,
+		const dc_item_value_t *item_value)
 {
 	if (NULL == *data)
 	{
-		if (NULL == (*data = (zbx_hc_data_t *)__hc_shmem_malloc_func(NULL, sizeof(zbx_hc_data_t))))
+		if (NULL == (*data = (zbx_hc_data_t *)zbx_shmem_malloc(hc_mem[shard->index], NULL,
+				sizeof(zbx_hc_data_t))))
 			return FAIL;
 
 		memset(*data, 0, sizeof(zbx_hc_data_t));
@@ -4289,24 +4460,24 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
 
 	if (ITEM_STATE_NOTSUPPORTED == item_value->state)
 	{
-		if (NULL == ((*data)->value.str = hc_mem_value_str_dup(&item_value->value.value_str)))
+		if (NULL == ((*data)->value.str = hc_mem_value_str_dup(shard, &item_value->value.value_str)))
 			return FAIL;
 
 		(*data)->value_type = item_value->value_type;
-		cache->stats.notsupported_counter++;
+		shard->stats.notsupported_counter++;
 
 		return SUCCEED;
 	}
 
 	if (0 != (ZBX_DC_FLAG_LLD & item_value->flags))
 	{
-		if (NULL == ((*data)->value.str = hc_mem_value_str_dup(&item_value->value.value_str)))
+		if (NULL == ((*data)->value.str = hc_mem_value_str_dup(shard, &item_value->value.value_str)))
 			return FAIL;
 
 		(*data)->value_type = ITEM_VALUE_TYPE_TEXT;
 
-		cache->stats.history_text_counter++;
-		cache->stats.history_counter++;
+		shard->stats.history_text_counter++;
+		shard->stats.history_counter++;
 
 		return SUCCEED;
 	}
@@ -4324,14 +4495,14 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
 			case ITEM_VALUE_TYPE_STR:
 			case ITEM_VALUE_TYPE_TEXT:
 			case ITEM_VALUE_TYPE_BIN:
-				if (SUCCEED != hc_clone_history_str_data(&(*data)->value.str,
+				if (SUCCEED != hc_clone_history_str_data(shard, &(*data)->value.str,
 						&item_value->value.value_str))
 				{
 					return FAIL;
 				}
 				break;
 			case ITEM_VALUE_TYPE_LOG:
-				if (SUCCEED != hc_clone_history_log_data(&(*data)->value.log, item_value))
+				if (SUCCEED != hc_clone_history_log_data(shard, &(*data)->value.log, item_value))
 					return FAIL;
 				break;
 			case ITEM_VALUE_TYPE_NONE:
@@ -4343,22 +4514,22 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
 		switch (item_value->item_value_type)
 		{
 			case ITEM_VALUE_TYPE_FLOAT:
-				cache->stats.history_float_counter++;
+				shard->stats.history_float_counter++;
 				break;
 			case ITEM_VALUE_TYPE_UINT64:
-				cache->stats.history_uint_counter++;
+				shard->stats.history_uint_counter++;
 				break;
 			case ITEM_VALUE_TYPE_STR:
-				cache->stats.history_str_counter++;
+				shard->stats.history_str_counter++;
 				break;
 			case ITEM_VALUE_TYPE_TEXT:
-				cache->stats.history_text_counter++;
+				shard->stats.history_text_counter++;
 				break;
 			case ITEM_VALUE_TYPE_LOG:
-				cache->stats.history_log_counter++;
+				shard->stats.history_log_counter++;
 				break;
 			case ITEM_VALUE_TYPE_BIN:
-				cache->stats.history_bin_counter++;
+				shard->stats.history_bin_counter++;
 				break;
 			case ITEM_VALUE_TYPE_NONE:
 			default:
@@ -4366,7 +4537,7 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
 				exit(EXIT_FAILURE);
 		}
 
-		cache->stats.history_counter++;
+		shard->stats.history_counter++;
 	}
 
 	(*data)->value_type = item_value->value_type;
@@ -4378,7 +4549,8 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
  *                                                                            *
  * Purpose: adds item values to the history cache                             *
  *                                                                            *
- * Parameters: values     - [IN] the item values to add                       *
+ * Parameters: shard      - [IN] history cache shard, must be locked          *
+ *             values     - [IN] the item values to add                       *
  *             values_num - [IN] the number of item values to add             *
  *                                                                            *
  * Comments: If the history cache is full this function will wait until       *
@@ -4386,7 +4558,7 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
  *           the new value.                                                   *
  *                                                                            *
  ******************************************************************************/
-static void	hc_add_item_values(dc_item_value_t *values, int values_num)
+static void	hc_add_item_values(zbx_hc_shard_t *shard, dc_item_value_t *values, int values_num)
 {
 	dc_item_value_t	*item_value;
 	int		i;
@@ -4400,7 +4572,8 @@ static void	hc_add_item_values(dc_item_value_t *values, int values_num)
 
 		/* a record with metadata and no value can be dropped if  */
 		/* the metadata update is copied to the last queued value */
-		if (NULL != (item = hc_get_item(item_value->itemid)) && 0 != (item_value->flags & ZBX_DC_FLAG_NOVALUE))
+		if (NULL != (item = hc_get_item(shard, item_value->itemid)) &&
+				0 != (item_value->flags & ZBX_DC_FLAG_NOVALUE))
 		{
 			/* skip metadata updates when only one value is queued, */
 			/* because the item might be already being processed    */
@@ -4417,26 +4590,26 @@ static void	hc_add_item_values(dc_item_value_t *values, int values_num)
 			}
 		}
 
-		if (SUCCEED != hc_clone_history_data(&data, item_value))
+		if (SUCCEED != hc_clone_history_data(shard, &data, item_value))
 		{
 			do
 			{
-				UNLOCK_CACHE;
+				UNLOCK_SHARD(shard);
 
 				zabbix_log(LOG_LEVEL_DEBUG, "History cache is full. Sleeping for 1 second.");
 				sleep(1);
 
-				LOCK_CACHE;
+				LOCK_SHARD(shard);
 			}
-			while (SUCCEED != hc_clone_history_data(&data, item_value));
+			while (SUCCEED != hc_clone_history_data(shard, &data, item_value));
 
-			item = hc_get_item(item_value->itemid);
+			item = hc_get_item(shard, item_value->itemid);
 		}
 
 		if (NULL == item)
 		{
-			item = hc_add_item(item_value->itemid, data);
-			hc_queue_item(item);
+			item = hc_add_item(shard, item_value->itemid, data);
+			hc_queue_item(shard, item);
 		}
 		else
 		{
@@ -4514,28 +4687,121 @@ static void	hc_copy_history_data(zbx_dc_history_t *history, zbx_uint64_t itemid,
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns the maximum history sync batch size, used to allocate     *
+ *          batch buffers                                                     *
+ *                                                                            *
+ ******************************************************************************/
+int	hc_get_sync_batch_max(void)
+{
+	return cache->sync_batch_max;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns the current history sync batch size of this process       *
+ *                                                                            *
+ ******************************************************************************/
+int	hc_get_sync_batch_size(void)
+{
+	if (0 == sync_batch_size)
+		sync_batch_size = cache->sync_batch_max;
+
+	return sync_batch_size;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adapts history sync batch size of this process to the history     *
+ *          cache backlog and time spent syncing the last batch               *
+ *                                                                            *
+ * Parameters: items_num  - [IN] the number of items popped for the batch     *
+ *             values_num - [IN] the number of synced values                  *
+ *             queue_size - [IN] the history queue size after the batch       *
+ *             time_spent - [IN] the time spent syncing the batch             *
+ *                                                                            *
+ * Comments: The batch grows while there is backlog and batches are synced    *
+ *           fast enough, shrinks when batches take longer than the target    *
+ *           time and slowly returns to the minimum size when the cache is    *
+ *           drained, so that triggers of new values are processed sooner.    *
+ *                                                                            *
+ ******************************************************************************/
+void	hc_update_sync_batch_size(int items_num, int values_num, int queue_size, double time_spent)
+{
+	int	size = hc_get_sync_batch_size();
+
+	if (ZBX_HC_SYNC_BATCH_TIME < time_spent)
+	{
+		/* reduce proportionally to the overtime, but not more than by half at once */
+		size = MAX(size / 2, (int)(size * ZBX_HC_SYNC_BATCH_TIME / time_spent));
+	}
+	else if (items_num >= size && queue_size >= size)
+	{
+		if (ZBX_HC_SYNC_BATCH_TIME / 2 > time_spent)
+			size += size / 4 + 1;
+	}
+	else if (0 == queue_size)
+		size -= (size - cache->sync_batch_min) / 4;
+
+	if (size < cache->sync_batch_min)
+		size = cache->sync_batch_min;
+	else if (size > cache->sync_batch_max)
+		size = cache->sync_batch_max;
+
+	sync_batch_size = size;
+
+	LOCK_CACHE;
+
+	cache->sync_batch_size = size;
+	cache->sync_batch_values = values_num;
+	cache->sync_batch_time = time_spent;
+
+	UNLOCK_CACHE;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: pops the next batch of history items from cache for processing    *
  *                                                                            *
  * Parameters: history_items - [OUT] the locked history items                 *
+ *             max_num       - [IN] the maximum number of items to pop        *
  *                                                                            *
  * Comments: The history_items must be returned back to history cache with    *
  *           hc_push_items() function after they have been processed.         *
  *                                                                            *
+ *           Shards are visited starting with a different shard on each call, *
+ *           so that history syncers are spread over shards and do not wait   *
+ *           for the same shard lock.                                         *
+ *                                                                            *
  ******************************************************************************/
-void	hc_pop_items(zbx_vector_ptr_t *history_items)
+void	hc_pop_items(zbx_vector_ptr_t *history_items, int max_num)
 {
+	static int		shard_start = -1;
 	zbx_binary_heap_elem_t	*elem;
 	zbx_hc_item_t		*item;
 
-	while (ZBX_HC_SYNC_MAX > history_items->values_num && FAIL == zbx_binary_heap_empty(&cache->history_queue))
+	if (-1 == shard_start)
+		shard_start = (int)getpid();
+
+	shard_start = (shard_start + 1) % cache->shards_num;
+
+	for (int i = 0; i < cache->shards_num && max_num > history_items->values_num; i++)
 	{
-		elem = zbx_binary_heap_find_min(&cache->history_queue);
-		item = (zbx_hc_item_t *)elem->data;
-		zbx_vector_ptr_append(history_items, item);
+		zbx_hc_shard_t	*shard = cache->shards[(shard_start + i) % cache->shards_num];
+
+		LOCK_SHARD(shard);
 
-		zbx_binary_heap_remove_min(&cache->history_queue);
+		while (max_num > history_items->values_num && FAIL == zbx_binary_heap_empty(&shard->history_queue))
+		{
+			elem = zbx_binary_heap_find_min(&shard->history_queue);
+			item = (zbx_hc_item_t *)elem->data;
+			zbx_vector_ptr_append(history_items, item);
+
+			zbx_binary_heap_remove_min(&shard->history_queue);
+		}
+
+		UNLOCK_SHARD(shard);
 	}
 }
 
@@ -4579,33 +4845,66 @@ void	hc_get_item_values(zbx_dc_history_t *history, zbx_vector_ptr_t *history_ite
  ******************************************************************************/
 void	hc_push_items(zbx_vector_ptr_t *history_items)
 {
-	int		i;
+	int		i, shards_num = cache->shards_num;
 	zbx_hc_item_t	*item;
 	zbx_hc_data_t	*data_free;
+	unsigned char	shard_index[ZBX_HC_SYNC_MAX], *pindex = shard_index;
+
+	if (ZBX_HC_SYNC_MAX < history_items->values_num)
+		pindex = (unsigned char *)zbx_malloc(NULL, (size_t)history_items->values_num);
 
 	for (i = 0; i < history_items->values_num; i++)
 	{
 		item = (zbx_hc_item_t *)history_items->values[i];
+		pindex[i] = (unsigned char)hc_get_shard(item->itemid)->index;
+	}
+
+	/* return items shard by shard to lock each shard only once */
+	for (int j = 0; j < shards_num; j++)
+	{
+		zbx_hc_shard_t	*shard = cache->shards[j];
+		int		locked = 0;
 
-		switch (item->status)
+		for (i = 0; i < history_items->values_num; i++)
 		{
-			case ZBX_HC_ITEM_STATUS_BUSY:
-				/* reset item status before returning it to queue */
-				item->status = ZBX_HC_ITEM_STATUS_NORMAL;
-				hc_queue_item(item);
-				break;
-			case ZBX_HC_ITEM_STATUS_NORMAL:
-				item->values_num--;
-				data_free = item->tail;
-				item->tail = item->tail->next;
-				hc_free_data(data_free);
-				if (NULL == item->tail)
-					zbx_hashset_remove(&cache->history_items, item);
-				else
-					hc_queue_item(item);
-				break;
+			if (j != pindex[i])
+				continue;
+
+			if (0 == locked)
+			{
+				LOCK_SHARD(shard);
+				locked = 1;
+			}
+
+			item = (zbx_hc_item_t *)history_items->values[i];
+
+			switch (item->status)
+			{
+				case ZBX_HC_ITEM_STATUS_BUSY:
+					/* reset item status before returning it to queue */
+					item->status = ZBX_HC_ITEM_STATUS_NORMAL;
+					hc_queue_item(shard, item);
+					break;
+				case ZBX_HC_ITEM_STATUS_NORMAL:
+					item->values_num--;
+					data_free = item->tail;
+					item->tail = item->tail->next;
+					hc_free_data(shard, data_free);
+					if (NULL == item->tail)
+						zbx_hashset_remove(&shard->history_items, item);
+					else
+						hc_queue_item(shard, item);
+					shard->history_num--;
+					break;
+			}
 		}
+
+		if (0 != locked)
+			UNLOCK_SHARD(shard);
 	}
+
+	if (shard_index != pindex)
+		zbx_free(pindex);
 }
 
 /******************************************************************************
@@ -4615,7 +4914,18 @@ void	hc_push_items(zbx_vector_ptr_t *history_items)
  ******************************************************************************/
 int	hc_queue_get_size(void)
 {
-	return cache->history_queue.elems_num;
+	int	size = 0;
+
+	for (int i = 0; i < cache->shards_num; i++)
+	{
+		zbx_hc_shard_t	*shard = cache->shards[i];
+
+		LOCK_SHARD(shard);
+		size += shard->history_queue.elems_num;
+		UNLOCK_SHARD(shard);
+	}
+
+	return size;
 }
 
 int	hc_get_history_compression_age(void)
@@ -4693,9 +5003,9 @@ out:
  ******************************************************************************/
 int	zbx_init_database_cache(zbx_get_program_type_f get_program_type, zbx_history_sync_f sync_history,
 		zbx_uint64_t history_cache_size, zbx_uint64_t history_index_cache_size,zbx_uint64_t *trends_cache_size,
-		char **error)
+		int history_sync_batch_min, int history_sync_batch_max, char **error)
 {
-	int	ret;
+	int	ret, shards_num;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -4714,39 +5024,82 @@ int	zbx_init_database_cache(zbx_get_program_type_f get_program_type, zbx_history
 	if (SUCCEED != (ret = zbx_mutex_create(&cache_ids_lock, ZBX_MUTEX_CACHE_IDS, error)))
 		goto out;
 
-	if (SUCCEED != (ret = zbx_shmem_create(&hc_mem, history_cache_size, "history cache",
-			"HistoryCacheSize", 1, error)))
-	{
-		goto out;
-	}
+	/* split history cache into shards only if each shard gets reasonable amount of memory */
+	shards_num = (int)MIN(history_cache_size / ZBX_HC_SHARD_DATA_MIN,
+			history_index_cache_size / ZBX_HC_SHARD_INDEX_MIN);
+
+	if (1 > shards_num)
+		shards_num = 1;
+	else if (ZBX_HC_SHARDS_MAX < shards_num)
+		shards_num = ZBX_HC_SHARDS_MAX;
 
-	if (SUCCEED != (ret = zbx_shmem_create(&hc_index_mem, history_index_cache_size, "history index cache",
-			"HistoryIndexCacheSize", 0, error)))
+	for (int i = 0; i < shards_num; i++)
 	{
-		goto out;
+		if (0 == i)
+			hc_shard_lock[i] = cache_lock;
+		else if (SUCCEED != (ret = zbx_mutex_create(&hc_shard_lock[i], ZBX_MUTEX_CACHE_SHARD + i - 1, error)))
+			goto out;
+
+		if (SUCCEED != (ret = zbx_shmem_create(&hc_mem[i], history_cache_size / (zbx_uint64_t)shards_num,
+				"history cache", "HistoryCacheSize", 1, error)))
+		{
+			goto out;
+		}
+
+		if (SUCCEED != (ret = zbx_shmem_create(&hc_index_mem[i],
+				history_index_cache_size / (zbx_uint64_t)shards_num, "history index cache",
+				"HistoryIndexCacheSize", 0, error)))
+		{
+			goto out;
+		}
+
+		/* history values, strings and index entries are small and frequently allocated/freed */
+		zbx_shmem_enable_slab(hc_mem[i]);
+		zbx_shmem_enable_slab(hc_index_mem[i]);
 	}
 
-	cache = (ZBX_DC_CACHE *)__hc_index_shmem_malloc_func(NULL, sizeof(ZBX_DC_CACHE));
+	cache = (ZBX_DC_CACHE *)hc_index_mem_funcs[0].mem_malloc_func(NULL, sizeof(ZBX_DC_CACHE));
 	memset(cache, 0, sizeof(ZBX_DC_CACHE));
 
-	ids = (ZBX_DC_IDS *)__hc_index_shmem_malloc_func(NULL, sizeof(ZBX_DC_IDS));
+	ids = (ZBX_DC_IDS *)hc_index_mem_funcs[0].mem_malloc_func(NULL, sizeof(ZBX_DC_IDS));
 	memset(ids, 0, sizeof(ZBX_DC_IDS));
 
-	zbx_hashset_create_ext(&cache->history_items, ZBX_HC_ITEMS_INIT_SIZE,
-			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
-			__hc_index_shmem_malloc_func, __hc_index_shmem_realloc_func, __hc_index_shmem_free_func);
+	cache->shards_num = shards_num;
+	cache->sync_batch_min = history_sync_batch_min;
+	cache->sync_batch_max = history_sync_batch_max;
+	cache->sync_batch_size = history_sync_batch_max;
+
+	for (int i = 0; i < shards_num; i++)
+	{
+		const zbx_hc_index_mem_funcs_t	*funcs = &hc_index_mem_funcs[i];
+		zbx_hc_shard_t			*shard;
 
-	zbx_binary_heap_create_ext(&cache->history_queue, hc_queue_elem_compare_func, ZBX_BINARY_HEAP_OPTION_EMPTY,
-			__hc_index_shmem_malloc_func, __hc_index_shmem_realloc_func, __hc_index_shmem_free_func);
+		shard = (zbx_hc_shard_t *)funcs->mem_malloc_func(NULL, sizeof(zbx_hc_shard_t));
+		memset(shard, 0, sizeof(zbx_hc_shard_t));
+		shard->index = i;
+
+		zbx_hashset_create_ext(&shard->history_items, ZBX_HC_ITEMS_INIT_SIZE / (size_t)shards_num,
+				ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
+				funcs->mem_malloc_func, funcs->mem_realloc_func, funcs->mem_free_func);
+
+		zbx_binary_heap_create_ext(&shard->history_queue, hc_queue_elem_compare_func,
+				ZBX_BINARY_HEAP_OPTION_EMPTY, funcs->mem_malloc_func, funcs->mem_realloc_func,
+				funcs->mem_free_func);
+
+		cache->shards[i] = shard;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() history cache shards:%d", __func__, shards_num);
 
 	if (0 != (get_program_type_cb() & ZBX_PROGRAM_TYPE_SERVER))
 	{
 		zbx_hashset_create_ext(&(cache->proxyqueue.index), ZBX_HC_SYNC_MAX,
 			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
-			__hc_index_shmem_malloc_func, __hc_index_shmem_realloc_func, __hc_index_shmem_free_func);
+			hc_index_mem_funcs[0].mem_malloc_func, hc_index_mem_funcs[0].mem_realloc_func,
+			hc_index_mem_funcs[0].mem_free_func);
 
-		zbx_list_create_ext(&(cache->proxyqueue.list), __hc_index_shmem_malloc_func,
-				__hc_index_shmem_free_func);
+		zbx_list_create_ext(&(cache->proxyqueue.list), hc_index_mem_funcs[0].mem_malloc_func,
+				hc_index_mem_funcs[0].mem_free_func);
 
 		cache->proxyqueue.state = ZBX_HC_PROXYQUEUE_STATE_NORMAL;
 
@@ -4756,6 +5109,8 @@ int	zbx_init_database_cache(zbx_get_program_type_f get_program_type, zbx_history
 
 	cache->history_num_total = 0;
 	cache->history_progress_ts = 0;
+	cache->trigger_functions_num = 0;
+	cache->trigger_functions_unique = 0;
 
 	cache->db_trigger_queue_lock = 1;
 
@@ -4791,17 +5146,26 @@ static void	DCsync_all(const zbx_events_funcs_t *events_cbs)
  ******************************************************************************/
 void	zbx_free_database_cache(int sync, const zbx_events_funcs_t *events_cbs)
 {
+	int	shards_num;
+
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	if (ZBX_SYNC_ALL == sync)
 		DCsync_all(events_cbs);
 
+	shards_num = cache->shards_num;
 	cache = NULL;
 
-	zbx_shmem_destroy(hc_mem);
-	hc_mem = NULL;
-	zbx_shmem_destroy(hc_index_mem);
-	hc_index_mem = NULL;
+	for (int i = 0; i < shards_num; i++)
+	{
+		zbx_shmem_destroy(hc_mem[i]);
+		hc_mem[i] = NULL;
+		zbx_shmem_destroy(hc_index_mem[i]);
+		hc_index_mem[i] = NULL;
+
+		if (0 != i)
+			zbx_mutex_destroy(&hc_shard_lock[i]);
+	}
 
 	zbx_mutex_destroy(&cache_lock);
 	zbx_mutex_destroy(&cache_ids_lock);
@@ -4923,11 +5287,39 @@ out:
  *                                                                            *
  ******************************************************************************/
 void	zbx_hc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num)
+{
+	*values_num = 0;
+	*items_num = 0;
+
+	for (int i = 0; i < cache->shards_num; i++)
+	{
+		zbx_hc_shard_t	*shard = cache->shards[i];
+
+		LOCK_SHARD(shard);
+
+		*values_num += (zbx_uint64_t)shard->history_num;
+		*items_num += (zbx_uint64_t)shard->history_items.num_data;
+
+		UNLOCK_SHARD(shard);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get trigger function deduplication statistics                     *
+ *                                                                            *
+ * Parameters: functions_num    - [OUT] total number of trigger functions     *
+ *                                      processed by history syncers          *
+ *             functions_unique - [OUT] total number of evaluated unique      *
+ *                                      functions                             *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_hc_get_trigger_function_stats(zbx_uint64_t *functions_num, zbx_uint64_t *functions_unique)
 {
 	LOCK_CACHE;
 
-	*values_num = cache->history_num;
-	*items_num = cache->history_items.num_data;
+	*functions_num = cache->trigger_functions_num;
+	*functions_unique = cache->trigger_functions_unique;
 
 	UNLOCK_CACHE;
 }
@@ -4939,15 +5331,34 @@ void	zbx_hc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num)
  ******************************************************************************/
 void	zbx_hc_get_mem_stats(zbx_shmem_stats_t *data, zbx_shmem_stats_t *index)
 {
-	LOCK_CACHE;
+	zbx_shmem_stats_t	stats;
 
 	if (NULL != data)
-		zbx_shmem_get_stats(hc_mem, data);
+		memset(data, 0, sizeof(zbx_shmem_stats_t));
 
 	if (NULL != index)
-		zbx_shmem_get_stats(hc_index_mem, index);
+		memset(index, 0, sizeof(zbx_shmem_stats_t));
 
-	UNLOCK_CACHE;
+	for (int i = 0; i < cache->shards_num; i++)
+	{
+		zbx_hc_shard_t	*shard = cache->shards[i];
+
+		LOCK_SHARD(shard);
+
+		if (NULL != data)
+		{
+			zbx_shmem_get_stats(hc_mem[i], &stats);
+			zbx_shmem_add_stats(data, &stats);
+		}
+
+		if (NULL != index)
+		{
+			zbx_shmem_get_stats(hc_index_mem[i], &stats);
+			zbx_shmem_add_stats(index, &stats);
+		}
+
+		UNLOCK_SHARD(shard);
+	}
 }
 
 /******************************************************************************
@@ -4960,18 +5371,23 @@ void	zbx_hc_get_items(zbx_vector_uint64_pair_t *items)
 	zbx_hashset_iter_t	iter;
 	zbx_hc_item_t		*item;
 
-	LOCK_CACHE;
+	for (int i = 0; i < cache->shards_num; i++)
+	{
+		zbx_hc_shard_t	*shard = cache->shards[i];
 
-	zbx_vector_uint64_pair_reserve(items, cache->history_items.num_data);
+		LOCK_SHARD(shard);
 
-	zbx_hashset_iter_reset(&cache->history_items, &iter);
-	while (NULL != (item = (zbx_hc_item_t *)zbx_hashset_iter_next(&iter)))
-	{
-		zbx_uint64_pair_t	pair = {item->itemid, item->values_num};
-		zbx_vector_uint64_pair_append_ptr(items, &pair);
-	}
+		zbx_vector_uint64_pair_reserve(items, (size_t)items->values_num + shard->history_items.num_data);
 
-	UNLOCK_CACHE;
+		zbx_hashset_iter_reset(&shard->history_items, &iter);
+		while (NULL != (item = (zbx_hc_item_t *)zbx_hashset_iter_next(&iter)))
+		{
+			zbx_uint64_pair_t	pair = {item->itemid, item->values_num};
+			zbx_vector_uint64_pair_append_ptr(items, &pair);
+		}
+
+		UNLOCK_SHARD(shard);
+	}
 }
 
 /******************************************************************************
@@ -5084,14 +5500,25 @@ static void	zbx_hc_proxyqueue_clear(void)
  ******************************************************************************/
 int	zbx_hc_check_proxy(zbx_uint64_t proxyid)
 {
-	double	hc_pused;
+	double	hc_pused = 0;
 	int	ret;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() proxyid:"ZBX_FS_UI64, __func__, proxyid);
 
-	LOCK_CACHE;
+	/* values are added to shards independently, so throttle proxies by the fullest shard */
+	for (int i = 0; i < cache->shards_num; i++)
+	{
+		zbx_hc_shard_t	*shard = cache->shards[i];
+		double		pused;
+
+		LOCK_SHARD(shard);
+		pused = 100 * (double)(hc_mem[i]->total_size - hc_mem[i]->free_size) / hc_mem[i]->total_size;
+		UNLOCK_SHARD(shard);
 
-	hc_pused = 100 * (double)(hc_mem->total_size - hc_mem->free_size) / hc_mem->total_size;
+		hc_pused = MAX(hc_pused, pused);
+	}
+
+	LOCK_CACHE;
 
 	if (20 >= hc_pused)
 	{
@@ -5143,22 +5570,3 @@ out:
 	return ret;
 }
 
-void	dbcache_lock(void)
-{
-	LOCK_CACHE;
-}
-
-void	dbcache_unlock(void)
-{
-	UNLOCK_CACHE;
-}
-
-void	dbcache_set_history_num(int num)
-{
-	cache->history_num = num;
-}
-
-int	dbcache_get_history_num(void)
-{
-	return cache->history_num;
-}
@@ -26,15 +26,19 @@
 /* the maximum time spent synchronizing history */
 #define ZBX_HC_SYNC_TIME_MAX	10
 
-/* the maximum number of items in one synchronization batch */
+/* the default number of items in one synchronization batch */
 #define ZBX_HC_SYNC_MAX		1000
 #define ZBX_HC_TIMER_MAX	(ZBX_HC_SYNC_MAX / 2)
 #define ZBX_HC_TIMER_SOFT_MAX	(ZBX_HC_TIMER_MAX - 10)
 
-void	dbcache_lock(void);
-void	dbcache_unlock(void);
+/* the target time of one synchronization batch, used to adapt batch size */
+#define ZBX_HC_SYNC_BATCH_TIME	1.0
 
-void	hc_pop_items(zbx_vector_ptr_t *history_items);
+int	hc_get_sync_batch_max(void);
+int	hc_get_sync_batch_size(void);
+void	hc_update_sync_batch_size(int items_num, int values_num, int queue_size, double time_spent);
+
+void	hc_pop_items(zbx_vector_ptr_t *history_items, int max_num);
 void	hc_push_items(zbx_vector_ptr_t *history_items);
 void	hc_get_item_values(zbx_dc_history_t *history, zbx_vector_ptr_t *history_items);
 int	hc_queue_get_size(void);
@@ -42,7 +46,4 @@ void	hc_free_item_values(zbx_dc_history_t *history, int history_num);
 
 void	dc_history_clean_value(zbx_dc_history_t *history);
 
-void	dbcache_set_history_num(int num);
-int	dbcache_get_history_num(void);
-
 #endif
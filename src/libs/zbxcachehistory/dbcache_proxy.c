@@ -364,29 +364,33 @@ void	zbx_sync_proxy_history(int *values_num, int *triggers_num, const zbx_events
 	ZBX_UNUSED(triggers_num);
 	ZBX_UNUSED(events_cbs);
 
-	int			history_num, txn_rc;
+	static zbx_dc_history_t	*history;
+	int			history_num, txn_rc, batch_max, queue_size;
 	time_t			sync_start;
 	zbx_vector_ptr_t	history_items;
 	zbx_vector_ptr_t	item_diff;
-	zbx_dc_history_t	history[ZBX_HC_SYNC_MAX];
+
+	batch_max = hc_get_sync_batch_max();
+
+	if (NULL == history)
+		history = (zbx_dc_history_t *)zbx_malloc(NULL, (size_t)batch_max * sizeof(zbx_dc_history_t));
 
 	zbx_vector_ptr_create(&history_items);
-	zbx_vector_ptr_reserve(&history_items, ZBX_HC_SYNC_MAX);
+	zbx_vector_ptr_reserve(&history_items, (size_t)batch_max);
 	zbx_vector_ptr_create(&item_diff);
 
 	sync_start = time(NULL);
 
 	do
 	{
-		*more = ZBX_SYNC_DONE;
+		double	batch_start;
 
-		dbcache_lock();
+		*more = ZBX_SYNC_DONE;
+		batch_start = zbx_time();
 
-		hc_pop_items(&history_items);		/* select and take items out of history cache */
+		hc_pop_items(&history_items, hc_get_sync_batch_size());	/* select and take items out of history cache */
 		history_num = history_items.values_num;
 
-		dbcache_unlock();
-
 		if (0 == history_num)
 			break;
 
@@ -405,31 +409,26 @@ void	zbx_sync_proxy_history(int *values_num, int *triggers_num, const zbx_events
 			while (ZBX_DB_DOWN == (txn_rc = zbx_db_commit()));
 		}
 
-		dbcache_lock();
+		/* apply item changes before returning items to history cache, so the changes */
+		/* are already visible when the next values of the same items are processed   */
+		if (ZBX_DB_FAIL != txn_rc && 0 != item_diff.values_num)
+			zbx_dc_config_items_apply_changes(&item_diff);
 
 		hc_push_items(&history_items);	/* return items to history cache */
 
 		if (ZBX_DB_FAIL != txn_rc)
 		{
-			if (0 != item_diff.values_num)
-				zbx_dc_config_items_apply_changes(&item_diff);
-
-			dbcache_set_history_num(dbcache_get_history_num() - history_num);
-
-			if (0 != hc_queue_get_size())
+			if (0 != (queue_size = hc_queue_get_size()))
 				*more = ZBX_SYNC_MORE;
 
-			dbcache_unlock();
-
 			*values_num += history_num;
 
 			hc_free_item_values(history, history_num);
+
+			hc_update_sync_batch_size(history_num, history_num, queue_size, zbx_time() - batch_start);
 		}
 		else
-		{
 			*more = ZBX_SYNC_MORE;
-			dbcache_unlock();
-		}
 
 		zbx_vector_ptr_clear(&history_items);
 		zbx_vector_ptr_clear_ext(&item_diff, zbx_default_mem_free_func);
@@ -22,9 +22,15 @@
 #include "zbxmutexs.h"
 #include "zbxtime.h"
 #include "zbxvariant.h"
+#include "zbxserialize.h"
+#include "zbxstr.h"
+#include "version.h"
+
+#include <sys/mman.h>
 
 /*
- * The cache (zbx_vc_cache_t) is organized as a hashset of item records (zbx_vc_item_t).
+ * The cache (zbx_vc_cache_t) is organized as a set of shards (zbx_vc_shard_t), each
+ * holding a hashset of item records (zbx_vc_item_t).
  *
  * Each record holds item data (itemid, value_type), statistics (hits, last access time,...)
  * and the historical data (timestamp,value pairs in ascending order).
@@ -47,6 +53,10 @@
  *
  * The low memory mode can't be turned off - it will persist until server is rebooted.
  * In low memory mode a warning message is written into log every 5 minutes.
+ *
+ * Larger caches are split into shards by itemid. Each shard has its own shared memory
+ * segment, item hashset, string pool and read-write lock, so requests for items in
+ * different shards do not block each other. The low memory mode is tracked per shard.
  */
 
 /* the period of low memory warning messages */
@@ -57,9 +67,15 @@
 
 #define ZBX_VC_LOW_MEMORY_ITEM_PRINT_LIMIT	25
 
-static zbx_shmem_info_t	*vc_mem = NULL;
+/* the maximum number of value cache shards */
+#define ZBX_VC_SHARDS_MAX	(ZBX_RWLOCK_VALUECACHE_SHARDS_NUM + 1)
+
+/* the minimum size of value cache shard */
+#define ZBX_VC_SHARD_SIZE_MIN	(8 * ZBX_MEBIBYTE)
+
+static zbx_shmem_info_t	*vc_mem[ZBX_VC_SHARDS_MAX];
 
-zbx_rwlock_t	vc_lock = ZBX_RWLOCK_NULL;
+static zbx_rwlock_t	vc_shard_lock[ZBX_VC_SHARDS_MAX];
 
 /* value cache enable/disable flags */
 #define ZBX_VC_DISABLED		0
@@ -68,7 +84,40 @@ zbx_rwlock_t	vc_lock = ZBX_RWLOCK_NULL;
 /* value cache state, after initialization value cache is always disabled */
 static int	vc_state = ZBX_VC_DISABLED;
 
-ZBX_SHMEM_FUNC_IMPL(__vc, vc_mem)
+ZBX_SHMEM_FUNC_IMPL(__vc0, vc_mem[0])
+ZBX_SHMEM_FUNC_IMPL(__vc1, vc_mem[1])
+ZBX_SHMEM_FUNC_IMPL(__vc2, vc_mem[2])
+ZBX_SHMEM_FUNC_IMPL(__vc3, vc_mem[3])
+ZBX_SHMEM_FUNC_IMPL(__vc4, vc_mem[4])
+ZBX_SHMEM_FUNC_IMPL(__vc5, vc_mem[5])
+ZBX_SHMEM_FUNC_IMPL(__vc6, vc_mem[6])
+ZBX_SHMEM_FUNC_IMPL(__vc7, vc_mem[7])
+
+typedef struct
+{
+	zbx_mem_malloc_func_t	mem_malloc_func;
+	zbx_mem_realloc_func_t	mem_realloc_func;
+	zbx_mem_free_func_t	mem_free_func;
+}
+zbx_vc_mem_funcs_t;
+
+#define ZBX_VC_MEM_FUNCS(__prefix)	\
+	{__prefix ## _shmem_malloc_func, __prefix ## _shmem_realloc_func, __prefix ## _shmem_free_func}
+
+#if 8 != ZBX_VC_SHARDS_MAX
+#	error "value cache shard memory allocators must match ZBX_VC_SHARDS_MAX"
+#endif
+
+static const zbx_vc_mem_funcs_t	vc_mem_funcs[ZBX_VC_SHARDS_MAX] = {
+	ZBX_VC_MEM_FUNCS(__vc0),
+	ZBX_VC_MEM_FUNCS(__vc1),
+	ZBX_VC_MEM_FUNCS(__vc2),
+	ZBX_VC_MEM_FUNCS(__vc3),
+	ZBX_VC_MEM_FUNCS(__vc4),
+	ZBX_VC_MEM_FUNCS(__vc5),
+	ZBX_VC_MEM_FUNCS(__vc6),
+	ZBX_VC_MEM_FUNCS(__vc7)
+};
 
 #define VC_STRPOOL_INIT_SIZE	(1000)
 #define VC_ITEMS_INIT_SIZE	(1000)
@@ -100,18 +149,24 @@ typedef struct zbx_vc_chunk
 	/* the number of item value slots in chunk */
 	int			slots_num;
 
-	/* the item value data */
-	zbx_history_record_t	slots[1];
+	/* the item values, stored in a separate array from timestamps so that */
+	/* numeric values are laid out contiguously for in-place aggregation   */
+	zbx_history_value_t	*values;
+
+	/* the item value timestamps */
+	zbx_timespec_t		*timestamps;
 }
 zbx_vc_chunk_t;
 
+/* the size of a single value slot in chunk */
+#define ZBX_VC_CHUNK_SLOT_SIZE	(sizeof(zbx_history_value_t) + sizeof(zbx_timespec_t))
+
 /* min/max number of item history values to store in chunk */
 
 #define ZBX_VC_MIN_CHUNK_RECORDS	2
 
 /* the maximum number is calculated so that the chunk size does not exceed 64KB */
-#define ZBX_VC_MAX_CHUNK_RECORDS	((64 * ZBX_KIBIBYTE - sizeof(zbx_vc_chunk_t)) / \
-		sizeof(zbx_history_record_t) + 1)
+#define ZBX_VC_MAX_CHUNK_RECORDS	((64 * ZBX_KIBIBYTE - sizeof(zbx_vc_chunk_t)) / ZBX_VC_CHUNK_SLOT_SIZE)
 
 /* the value cache item data */
 typedef struct
@@ -178,9 +233,12 @@ typedef struct
 }
 zbx_vc_item_t;
 
-/* the value cache data  */
+/* the value cache shard data */
 typedef struct
 {
+	/* the shard index, also used to select shard memory and lock */
+	int		index;
+
 	/* the number of cache hits, used for statistics */
 	zbx_uint64_t	hits;
 
@@ -205,6 +263,16 @@ typedef struct
 	/* the string pool for str, text and log item values */
 	zbx_hashset_t	strpool;
 }
+zbx_vc_shard_t;
+
+/* the value cache data */
+typedef struct
+{
+	/* the cache shards, items are distributed between shards by itemid */
+	zbx_vc_shard_t	*shards[ZBX_VC_SHARDS_MAX];
+
+	int		shards_num;
+}
 zbx_vc_cache_t;
 
 /* the item weight data, used to determine if item can be removed from cache */
@@ -221,6 +289,31 @@ zbx_vc_item_weight_t;
 ZBX_VECTOR_DECL(vc_itemweight, zbx_vc_item_weight_t)
 ZBX_VECTOR_IMPL(vc_itemweight, zbx_vc_item_weight_t)
 
+/* the callback to process item value range [first, last] in chunk */
+typedef void	(*zbx_vc_walk_func_t)(const zbx_vc_item_t *item, const zbx_vc_chunk_t *chunk, int first, int last,
+		void *data);
+
+/* the in-place value aggregation data */
+typedef struct
+{
+	/* the aggregation operation - see ZBX_VC_AGGREGATE_* defines */
+	int			op;
+
+	/* the aggregated value type */
+	unsigned char		value_type;
+
+	/* the number of aggregated values */
+	int			values_num;
+
+	/* the aggregation result */
+	zbx_history_record_t	result;
+
+	/* the values collected for percentile calculation */
+	zbx_history_value_t	*values;
+	int			values_alloc;
+}
+zbx_vc_aggregate_t;
+
 typedef enum
 {
 	ZBX_VC_UPDATE_STATS,
@@ -270,9 +363,9 @@ static void	vc_cache_item_update(zbx_uint64_t itemid, zbx_vc_item_update_type_t
 /* the value cache */
 static zbx_vc_cache_t	*vc_cache = NULL;
 
-#define	RDLOCK_CACHE	zbx_rwlock_rdlock(vc_lock)
-#define	WRLOCK_CACHE	zbx_rwlock_wrlock(vc_lock)
-#define	UNLOCK_CACHE	zbx_rwlock_unlock(vc_lock)
+#define	RDLOCK_SHARD(shard)	zbx_rwlock_rdlock(vc_shard_lock[(shard)->index])
+#define	WRLOCK_SHARD(shard)	zbx_rwlock_wrlock(vc_shard_lock[(shard)->index])
+#define	UNLOCK_SHARD(shard)	zbx_rwlock_unlock(vc_shard_lock[(shard)->index])
 
 /* function prototypes */
 static void	vc_history_record_copy(zbx_history_record_t *dst, const zbx_history_record_t *src, int value_type);
@@ -283,6 +376,16 @@ static size_t	vch_item_free_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk);
 static int	vch_item_add_values_at_tail(zbx_vc_item_t *item, const zbx_history_record_t *values, int values_num);
 static void	vch_item_clean_cache(zbx_vc_item_t *item, int timestamp);
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns value cache shard of the specified item                   *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_vc_shard_t	*vc_get_shard(zbx_uint64_t itemid)
+{
+	return vc_cache->shards[ZBX_DEFAULT_UINT64_HASH_FUNC(&itemid) % (zbx_hash_t)vc_cache->shards_num];
+}
+
 /*********************************************************************************
  *                                                                               *
  * Purpose: reads item history data from database                                *
@@ -640,7 +743,8 @@ static void	vc_history_record_vector_clean(zbx_vector_history_record_t *vector,
  *                                                                            *
  * Purpose: updates cache and item statistics                                 *
  *                                                                            *
- * Parameters: item    - [IN] the item (optional)                             *
+ * Parameters: shard   - [IN] the value cache shard                           *
+ *             item    - [IN] the item (optional)                             *
  *             hits    - [IN] the number of hits to add                       *
  *             misses  - [IN] the number of misses to add                     *
  *                                                                            *
@@ -648,7 +752,7 @@ static void	vc_history_record_vector_clean(zbx_vector_history_record_t *vector,
  *           added to both - item and cache statistics.                       *
  *                                                                            *
  ******************************************************************************/
-static void	vc_update_statistics(zbx_vc_item_t *item, int hits, int misses, int now)
+static void	vc_update_statistics(zbx_vc_shard_t *shard, zbx_vc_item_t *item, int hits, int misses, int now)
 {
 	if (NULL != item)
 	{
@@ -671,8 +775,8 @@ static void	vc_update_statistics(zbx_vc_item_t *item, int hits, int misses, int
 
 	if (ZBX_VC_ENABLED == vc_state)
 	{
-		vc_cache->hits += (zbx_uint64_t)hits;
-		vc_cache->misses += (zbx_uint64_t)misses;
+		shard->hits += (zbx_uint64_t)hits;
+		shard->misses += (zbx_uint64_t)misses;
 	}
 }
 
@@ -695,19 +799,21 @@ static int	vc_compare_items_by_total_values(const void *d1, const void *d2)
  *                                                                            *
  * Purpose: find out items responsible for low memory                         *
  *                                                                            *
+ * Parameters: shard - [IN] the value cache shard                             *
+ *                                                                            *
  ******************************************************************************/
-static void	vc_dump_items_statistics(void)
+static void	vc_dump_items_statistics(zbx_vc_shard_t *shard)
 {
 	zbx_vc_item_t		*item;
 	zbx_hashset_iter_t	iter;
 	int			i, total = 0, limit;
 	zbx_vector_ptr_t	items;
 
-	zabbix_log(LOG_LEVEL_WARNING, "=== most used items statistics for value cache ===");
+	zabbix_log(LOG_LEVEL_WARNING, "=== most used items statistics for value cache shard %d ===", shard->index);
 
 	zbx_vector_ptr_create(&items);
 
-	zbx_hashset_iter_reset(&vc_cache->items, &iter);
+	zbx_hashset_iter_reset(&shard->items, &iter);
 
 	while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
 	{
@@ -735,28 +841,31 @@ static void	vc_dump_items_statistics(void)
  *                                                                            *
  * Purpose: logs low memory warning                                           *
  *                                                                            *
+ * Parameters: shard - [IN] the value cache shard                             *
+ *                                                                            *
  * Comments: The low memory warning is written to log every 5 minutes when    *
- *           cache is working in the low memory mode.                         *
+ *           cache shard is working in the low memory mode.                   *
  *                                                                            *
  ******************************************************************************/
-static void	vc_warn_low_memory(void)
+static void	vc_warn_low_memory(zbx_vc_shard_t *shard)
 {
 	int	now;
 
 	now = (int)time(NULL);
 
-	if (now - vc_cache->mode_time > ZBX_VC_LOW_MEMORY_RESET_PERIOD)
+	if (now - shard->mode_time > ZBX_VC_LOW_MEMORY_RESET_PERIOD)
 	{
-		vc_cache->mode = ZBX_VC_MODE_NORMAL;
-		vc_cache->mode_time = now;
+		shard->mode = ZBX_VC_MODE_NORMAL;
+		shard->mode_time = now;
 
-		zabbix_log(LOG_LEVEL_WARNING, "value cache has been switched from low memory to normal operation mode");
+		zabbix_log(LOG_LEVEL_WARNING, "value cache shard %d has been switched from low memory to normal"
+				" operation mode", shard->index);
 	}
-	else if (now - vc_cache->last_warning_time > ZBX_VC_LOW_MEMORY_WARNING_PERIOD)
+	else if (now - shard->last_warning_time > ZBX_VC_LOW_MEMORY_WARNING_PERIOD)
 	{
-		vc_cache->last_warning_time = now;
-		vc_dump_items_statistics();
-		zbx_shmem_dump_stats(LOG_LEVEL_WARNING, vc_mem);
+		shard->last_warning_time = now;
+		vc_dump_items_statistics(shard);
+		zbx_shmem_dump_stats(LOG_LEVEL_WARNING, vc_mem[shard->index]);
 
 		zabbix_log(LOG_LEVEL_WARNING, "value cache is fully used: please increase ValueCacheSize"
 				" configuration parameter");
@@ -768,25 +877,23 @@ static void	vc_warn_low_memory(void)
  * Purpose: frees space in cache by dropping items not accessed for more than *
  *          24 hours                                                          *
  *                                                                            *
- * Parameters: source_item - [IN] the item requesting more space to store its *
+ * Parameters: shard       - [IN] the value cache shard                       *
+ *             source_item - [IN] the item requesting more space to store its *
  *                                data                                        *
  *                                                                            *
  * Return value:  number of bytes freed                                       *
  *                                                                            *
  ******************************************************************************/
-static size_t	vc_release_unused_items(const zbx_vc_item_t *source_item)
+static size_t	vc_release_unused_items(zbx_vc_shard_t *shard, const zbx_vc_item_t *source_item)
 {
 	int			timestamp;
 	zbx_hashset_iter_t	iter;
 	zbx_vc_item_t		*item;
 	size_t			freed = 0;
 
-	if (NULL == vc_cache)
-		return freed;
-
 	timestamp = (int)time(NULL) - ZBX_VC_ITEM_EXPIRE_PERIOD;
 
-	zbx_hashset_iter_reset(&vc_cache->items, &iter);
+	zbx_hashset_iter_reset(&shard->items, &iter);
 
 	while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
 	{
@@ -808,7 +915,9 @@ static size_t	vc_release_unused_items(const zbx_vc_item_t *source_item)
  * Parameters: item  - [IN] the item requesting more space to store its data  *
  *             space - [IN] the number of bytes to free                       *
  *                                                                            *
- * Comments: The caller item must not be removed from cache to avoid          *
+ * Comments: Only items from the cache shard of the caller item are dropped,  *
+ *           other shards are not affected.                                   *
+ *           The caller item must not be removed from cache to avoid          *
  *           complications (ie - checking if item still is in cache every     *
  *           time after calling vc_free_space() function).                    *
  *           vc_free_space() attempts to free at least min_free_request       *
@@ -822,25 +931,26 @@ static void	vc_release_space(zbx_vc_item_t *source_item, size_t space)
 	int				i;
 	size_t				freed;
 	zbx_vector_vc_itemweight_t	items;
+	zbx_vc_shard_t			*shard = vc_get_shard(source_item->itemid);
 
 	/* reserve at least min_free_request bytes to avoid spamming with free space requests */
-	if (space < vc_cache->min_free_request)
-		space = vc_cache->min_free_request;
+	if (space < shard->min_free_request)
+		space = shard->min_free_request;
 
 	/* first remove items with the last accessed time older than a day */
-	if ((freed = vc_release_unused_items(source_item)) >= space)
+	if ((freed = vc_release_unused_items(shard, source_item)) >= space)
 		return;
 
 	/* failed to free enough space by removing old items, entering low memory mode */
-	vc_cache->mode = ZBX_VC_MODE_LOWMEM;
-	vc_cache->mode_time = (int)time(NULL);
+	shard->mode = ZBX_VC_MODE_LOWMEM;
+	shard->mode_time = (int)time(NULL);
 
-	vc_warn_low_memory();
+	vc_warn_low_memory(shard);
 
 	/* remove items with least hits/size ratio */
 	zbx_vector_vc_itemweight_create(&items);
 
-	zbx_hashset_iter_reset(&vc_cache->items, &iter);
+	zbx_hashset_iter_reset(&shard->items, &iter);
 
 	while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
 	{
@@ -864,7 +974,7 @@ static void	vc_release_space(zbx_vc_item_t *source_item, size_t space)
 		item = items.values[i].item;
 
 		freed += vch_item_free_cache(item) + sizeof(zbx_vc_item_t);
-		zbx_hashset_remove_direct(&vc_cache->items, item);
+		zbx_hashset_remove_direct(&shard->items, item);
 	}
 	zbx_vector_vc_itemweight_destroy(&items);
 }
@@ -920,6 +1030,358 @@ static void	vc_history_record_vector_append(zbx_vector_history_record_t *vector,
 	zbx_vector_history_record_append_ptr(vector, &record);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: appends the specified chunk slot value to value vector            *
+ *                                                                            *
+ * Parameters: vector     - [IN/OUT] the value vector                         *
+ *             value_type - [IN] the type of value to append                  *
+ *             chunk      - [IN] the chunk containing the value               *
+ *             index      - [IN] the value slot index in chunk                *
+ *                                                                            *
+ * Comments: Additional memory is allocated to store string, text and log     *
+ *           value contents. This memory must be freed by the caller.         *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_history_record_vector_append_slot(zbx_vector_history_record_t *vector, int value_type,
+		const zbx_vc_chunk_t *chunk, int index)
+{
+	zbx_history_record_t	record;
+
+	record.timestamp = chunk->timestamps[index];
+	record.value = chunk->values[index];
+
+	vc_history_record_vector_append(vector, value_type, &record);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initializes value aggregation data                                *
+ *                                                                            *
+ * Parameters: agg        - [OUT] the aggregation data                        *
+ *             value_type - [IN] the value type                               *
+ *             op         - [IN] the aggregation operation                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_aggregate_init(zbx_vc_aggregate_t *agg, unsigned char value_type, int op)
+{
+	memset(agg, 0, sizeof(zbx_vc_aggregate_t));
+	agg->op = op;
+	agg->value_type = value_type;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees resources allocated by value aggregation                    *
+ *                                                                            *
+ * Parameters: agg - [IN] the aggregation data                                *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_aggregate_clear(zbx_vc_aggregate_t *agg)
+{
+	zbx_free(agg->values);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates change between two values                              *
+ *                                                                            *
+ * Parameters: value_type - [IN] the value type                               *
+ *             newer      - [IN] the newer value                              *
+ *             older      - [IN] the older value                              *
+ *                                                                            *
+ * Return value: the difference between numeric values or 0/1 depending on   *
+ *               whether string values are equal                             *
+ *                                                                            *
+ ******************************************************************************/
+static double	vc_value_change(unsigned char value_type, const zbx_history_value_t *newer,
+		const zbx_history_value_t *older)
+{
+	switch (value_type)
+	{
+		case ITEM_VALUE_TYPE_FLOAT:
+			return newer->dbl - older->dbl;
+		case ITEM_VALUE_TYPE_UINT64:
+			/* to avoid overflow */
+			if (newer->ui64 >= older->ui64)
+				return newer->ui64 - older->ui64;
+			return -(double)(older->ui64 - newer->ui64);
+		case ITEM_VALUE_TYPE_LOG:
+			return 0 == strcmp(newer->log->value, older->log->value) ? 0 : 1;
+		default:
+			return 0 == strcmp(newer->str, older->str) ? 0 : 1;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: aggregates numeric values                                         *
+ *                                                                            *
+ * Parameters: agg    - [IN/OUT] the aggregation data                         *
+ *             values - [IN] the value array                                  *
+ *             first  - [IN] the first (oldest) value index                   *
+ *             last   - [IN] the last (newest) value index                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_aggregate_numeric(zbx_vc_aggregate_t *agg, const zbx_history_value_t *values, int first, int last)
+{
+	int	i, n = agg->values_num;
+
+	if (ITEM_VALUE_TYPE_FLOAT == agg->value_type)
+	{
+		double	result = agg->result.value.dbl;
+
+		switch (agg->op)
+		{
+			case ZBX_VC_AGGREGATE_SUM:
+				for (i = last; i >= first; i--)
+					result += values[i].dbl;
+				break;
+			case ZBX_VC_AGGREGATE_AVG:
+				for (i = last; i >= first; i--)
+				{
+					n++;
+					result += values[i].dbl / n - result / n;
+				}
+				break;
+			case ZBX_VC_AGGREGATE_MIN:
+				for (i = last; i >= first; i--)
+				{
+					if (values[i].dbl < result)
+						result = values[i].dbl;
+				}
+				break;
+			case ZBX_VC_AGGREGATE_MAX:
+				for (i = last; i >= first; i--)
+				{
+					if (values[i].dbl > result)
+						result = values[i].dbl;
+				}
+				break;
+		}
+
+		agg->result.value.dbl = result;
+	}
+	else
+	{
+		zbx_uint64_t	result = agg->result.value.ui64;
+		double		sum;
+
+		switch (agg->op)
+		{
+			case ZBX_VC_AGGREGATE_SUM:
+				for (i = last; i >= first; i--)
+					result += values[i].ui64;
+				break;
+			case ZBX_VC_AGGREGATE_AVG:
+				/* the sum is divided by the number of values when finishing aggregation */
+				for (sum = agg->result.value.dbl, i = last; i >= first; i--)
+					sum += (double)values[i].ui64;
+
+				agg->result.value.dbl = sum;
+				return;
+			case ZBX_VC_AGGREGATE_MIN:
+				for (i = last; i >= first; i--)
+				{
+					if (values[i].ui64 < result)
+						result = values[i].ui64;
+				}
+				break;
+			case ZBX_VC_AGGREGATE_MAX:
+				for (i = last; i >= first; i--)
+				{
+					if (values[i].ui64 > result)
+						result = values[i].ui64;
+				}
+				break;
+		}
+
+		agg->result.value.ui64 = result;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: aggregates values in place                                        *
+ *                                                                            *
+ * Parameters: agg        - [IN/OUT] the aggregation data                     *
+ *             values     - [IN] the value array                              *
+ *             timestamps - [IN] the value timestamp array                    *
+ *             first      - [IN] the first (oldest) value index               *
+ *             last       - [IN] the last (newest) value index                *
+ *                                                                            *
+ * Comments: Values are processed from newest to oldest, keeping the same     *
+ *           order as when aggregating values returned by zbx_vc_get_values() *
+ *                                                                            *
+ *           String, text and log values are referenced without copying, so   *
+ *           the aggregation must be finished with vc_aggregate_finish()      *
+ *           while the values are still available.                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_aggregate_values(zbx_vc_aggregate_t *agg, const zbx_history_value_t *values,
+		const zbx_timespec_t *timestamps, int first, int last)
+{
+	switch (agg->op)
+	{
+		case ZBX_VC_AGGREGATE_MIN:
+		case ZBX_VC_AGGREGATE_MAX:
+			/* initialize min/max result with the first aggregated value */
+			if (0 == agg->values_num)
+				agg->result.value = values[last];
+			ZBX_FALLTHROUGH;
+		case ZBX_VC_AGGREGATE_SUM:
+		case ZBX_VC_AGGREGATE_AVG:
+			vc_aggregate_numeric(agg, values, first, last);
+			break;
+		case ZBX_VC_AGGREGATE_FIRST:
+			agg->result.value = values[first];
+			agg->result.timestamp = timestamps[first];
+			break;
+		case ZBX_VC_AGGREGATE_LAST:
+			if (0 == agg->values_num)
+			{
+				agg->result.value = values[last];
+				agg->result.timestamp = timestamps[last];
+			}
+			break;
+		case ZBX_VC_AGGREGATE_CHANGE:
+			/* only the two newest values are used - remember the newest value and */
+			/* calculate the change when the preceding value is found              */
+			if (0 == agg->values_num)
+			{
+				agg->result.value = values[last];
+				agg->result.timestamp = timestamps[last];
+
+				if (last > first)
+				{
+					agg->result.value.dbl = vc_value_change(agg->value_type, &values[last],
+							&values[last - 1]);
+				}
+			}
+			else if (1 == agg->values_num)
+			{
+				agg->result.value.dbl = vc_value_change(agg->value_type, &agg->result.value,
+						&values[last]);
+			}
+			break;
+		case ZBX_VC_AGGREGATE_PERCENTILE:
+			if (agg->values_alloc < agg->values_num + last - first + 1)
+			{
+				if (0 == agg->values_alloc)
+					agg->values_alloc = 16;
+
+				while (agg->values_alloc < agg->values_num + last - first + 1)
+					agg->values_alloc *= 2;
+
+				agg->values = (zbx_history_value_t *)zbx_realloc(agg->values,
+						sizeof(zbx_history_value_t) * (size_t)agg->values_alloc);
+			}
+
+			memcpy(agg->values + agg->values_num, values + first,
+					sizeof(zbx_history_value_t) * (size_t)(last - first + 1));
+			break;
+	}
+
+	agg->values_num += last - first + 1;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finishes value aggregation                                        *
+ *                                                                            *
+ * Parameters: agg - [IN/OUT] the aggregation data                            *
+ *                                                                            *
+ * Comments: This function must be called while the aggregated values are     *
+ *           still available, as the first/last string, text and log values   *
+ *           are copied here.                                                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_aggregate_finish(zbx_vc_aggregate_t *agg)
+{
+	zbx_history_record_t	record;
+
+	switch (agg->op)
+	{
+		case ZBX_VC_AGGREGATE_AVG:
+			if (ITEM_VALUE_TYPE_UINT64 == agg->value_type && 0 != agg->values_num)
+				agg->result.value.dbl /= agg->values_num;
+			break;
+		case ZBX_VC_AGGREGATE_FIRST:
+		case ZBX_VC_AGGREGATE_LAST:
+			if (0 != agg->values_num)
+			{
+				record = agg->result;
+				vc_history_record_copy(&agg->result, &record, agg->value_type);
+			}
+			break;
+		case ZBX_VC_AGGREGATE_CHANGE:
+			/* drop the reference to the newest value if there was no preceding value */
+			if (2 > agg->values_num)
+				memset(&agg->result, 0, sizeof(agg->result));
+			break;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares two float history values                                 *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_history_value_dbl_compare(const void *d1, const void *d2)
+{
+	const zbx_history_value_t	*v1 = (const zbx_history_value_t *)d1;
+	const zbx_history_value_t	*v2 = (const zbx_history_value_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(v1->dbl, v2->dbl);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares two unsigned integer history values                      *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_history_value_ui64_compare(const void *d1, const void *d2)
+{
+	const zbx_history_value_t	*v1 = (const zbx_history_value_t *)d1;
+	const zbx_history_value_t	*v2 = (const zbx_history_value_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(v1->ui64, v2->ui64);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates percentile of the collected values                     *
+ *                                                                            *
+ * Parameters: agg        - [IN/OUT] the aggregation data                     *
+ *             percentage - [IN] the percentage (0-100)                       *
+ *                                                                            *
+ * Comments: The values are sorted outside cache lock, as they were already   *
+ *           copied from cache during aggregation.                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_aggregate_percentile(zbx_vc_aggregate_t *agg, double percentage)
+{
+	int	index;
+
+	if (0 == agg->values_num)
+		return;
+
+	qsort(agg->values, (size_t)agg->values_num, sizeof(zbx_history_value_t),
+			ITEM_VALUE_TYPE_FLOAT == agg->value_type ? vc_history_value_dbl_compare :
+			vc_history_value_ui64_compare);
+
+	if (0 == percentage)
+		index = 1;
+	else
+		index = (int)ceil(agg->values_num * (percentage / 100));
+
+	agg->result.value = agg->values[index - 1];
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: allocate cache memory to store item's resources                   *
@@ -937,20 +1399,34 @@ static void	vc_history_record_vector_append(zbx_vector_history_record_t *vector,
  ******************************************************************************/
 static void	*vc_item_malloc(zbx_vc_item_t *item, size_t size)
 {
-	char	*ptr;
+	char			*ptr;
+	zbx_mem_malloc_func_t	mem_malloc_func = vc_mem_funcs[vc_get_shard(item->itemid)->index].mem_malloc_func;
 
-	if (NULL == (ptr = (char *)__vc_shmem_malloc_func(NULL, size)))
+	if (NULL == (ptr = (char *)mem_malloc_func(NULL, size)))
 	{
 		/* If failed to allocate required memory, try to free space in      */
 		/* cache and allocate again. If there still is not enough space -   */
 		/* return NULL as failure.                                          */
 		vc_release_space(item, size);
-		ptr = (char *)__vc_shmem_malloc_func(NULL, size);
+		ptr = (char *)mem_malloc_func(NULL, size);
 	}
 
 	return ptr;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees memory allocated with vc_item_malloc() function             *
+ *                                                                            *
+ * Parameters: item - [IN] the item                                           *
+ *             ptr  - [IN] the memory to free                                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_item_free(const zbx_vc_item_t *item, void *ptr)
+{
+	vc_mem_funcs[vc_get_shard(item->itemid)->index].mem_free_func(ptr);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: copies string to the cache memory                                 *
@@ -972,9 +1448,10 @@ static void	*vc_item_malloc(zbx_vc_item_t *item, size_t size)
  ******************************************************************************/
 static char	*vc_item_strdup(zbx_vc_item_t *item, const char *str)
 {
-	void	*ptr;
+	void		*ptr;
+	zbx_vc_shard_t	*shard = vc_get_shard(item->itemid);
 
-	ptr = zbx_hashset_search(&vc_cache->strpool, str - REFCOUNT_FIELD_SIZE);
+	ptr = zbx_hashset_search(&shard->strpool, str - REFCOUNT_FIELD_SIZE);
 
 	if (NULL == ptr)
 	{
@@ -983,7 +1460,7 @@ static char	*vc_item_strdup(zbx_vc_item_t *item, const char *str)
 
 		len = strlen(str) + 1;
 
-		while (NULL == (ptr = zbx_hashset_insert_ext(&vc_cache->strpool, str - REFCOUNT_FIELD_SIZE,
+		while (NULL == (ptr = zbx_hashset_insert_ext(&shard->strpool, str - REFCOUNT_FIELD_SIZE,
 				REFCOUNT_FIELD_SIZE + len, REFCOUNT_FIELD_SIZE)))
 		{
 			/* If there is not enough space - free enough to store string + hashset entry overhead */
@@ -1006,7 +1483,8 @@ static char	*vc_item_strdup(zbx_vc_item_t *item, const char *str)
  *                                                                            *
  * Purpose: removes string from cache string pool                             *
  *                                                                            *
- * Parameters: str   - [IN] the string to remove                              *
+ * Parameters: item  - [IN] the item                                          *
+ *             str   - [IN] the string to remove                              *
  *                                                                            *
  * Return value: the number of bytes freed                                    *
  *                                                                            *
@@ -1017,7 +1495,7 @@ static char	*vc_item_strdup(zbx_vc_item_t *item, const char *str)
  *           be freed with vc_item_strfree().                                 *
  *                                                                            *
  ******************************************************************************/
-static size_t	vc_item_strfree(char *str)
+static size_t	vc_item_strfree(const zbx_vc_item_t *item, char *str)
 {
 	size_t	freed = 0;
 
@@ -1028,7 +1506,7 @@ static size_t	vc_item_strfree(char *str)
 		if (0 == --(*(zbx_uint32_t *)ptr))
 		{
 			freed = strlen(str) + REFCOUNT_FIELD_SIZE + 1;
-			zbx_hashset_remove_direct(&vc_cache->strpool, ptr);
+			zbx_hashset_remove_direct(&vc_get_shard(item->itemid)->strpool, ptr);
 		}
 	}
 
@@ -1075,9 +1553,9 @@ static zbx_log_value_t	*vc_item_logdup(zbx_vc_item_t *item, const zbx_log_value_
 
 	return plog;
 fail:
-	vc_item_strfree(plog->source);
+	vc_item_strfree(item, plog->source);
 
-	__vc_shmem_free_func(plog);
+	vc_item_free(item, plog);
 
 	return NULL;
 }
@@ -1086,7 +1564,8 @@ fail:
  *                                                                            *
  * Purpose: removes log resource from cache memory                            *
  *                                                                            *
- * Parameters: str   - [IN] the log to remove                                 *
+ * Parameters: item  - [IN] the item                                          *
+ *             log   - [IN] the log to remove                                 *
  *                                                                            *
  * Return value: the number of bytes freed                                    *
  *                                                                            *
@@ -1094,16 +1573,16 @@ fail:
  *           be freed with vc_item_logfree().                                 *
  *                                                                            *
  ******************************************************************************/
-static size_t	vc_item_logfree(zbx_log_value_t *log)
+static size_t	vc_item_logfree(const zbx_vc_item_t *item, zbx_log_value_t *log)
 {
 	size_t	freed = 0;
 
 	if (NULL != log)
 	{
-		freed += vc_item_strfree(log->source);
-		freed += vc_item_strfree(log->value);
+		freed += vc_item_strfree(item, log->source);
+		freed += vc_item_strfree(item, log->value);
 
-		__vc_shmem_free_func(log);
+		vc_item_free(item, log);
 		freed += sizeof(zbx_log_value_t);
 	}
 
@@ -1122,7 +1601,7 @@ static size_t	vc_item_logfree(zbx_log_value_t *log)
  * Return value: the number of bytes freed                                    *
  *                                                                            *
  ******************************************************************************/
-static size_t	vc_item_free_values(zbx_vc_item_t *item, zbx_history_record_t *values, int first, int last)
+static size_t	vc_item_free_values(zbx_vc_item_t *item, zbx_history_value_t *values, int first, int last)
 {
 	size_t	freed = 0;
 	int 	i;
@@ -1132,11 +1611,11 @@ static size_t	vc_item_free_values(zbx_vc_item_t *item, zbx_history_record_t *val
 		case ITEM_VALUE_TYPE_STR:
 		case ITEM_VALUE_TYPE_TEXT:
 			for (i = first; i <= last; i++)
-				freed += vc_item_strfree(values[i].value.str);
+				freed += vc_item_strfree(item, values[i].str);
 			break;
 		case ITEM_VALUE_TYPE_LOG:
 			for (i = first; i <= last; i++)
-				freed += vc_item_logfree(values[i].value.log);
+				freed += vc_item_logfree(item, values[i].log);
 			break;
 		case ITEM_VALUE_TYPE_UINT64:
 		case ITEM_VALUE_TYPE_FLOAT:
@@ -1163,25 +1642,26 @@ static size_t	vc_item_free_values(zbx_vc_item_t *item, zbx_history_record_t *val
 static void	vc_remove_item(zbx_vc_item_t *item)
 {
 	vch_item_free_cache(item);
-	zbx_hashset_remove_direct(&vc_cache->items, item);
+	zbx_hashset_remove_direct(&vc_get_shard(item->itemid)->items, item);
 }
 
 /******************************************************************************
  *                                                                            *
  * Purpose: removes item from cache and frees resources allocated for it      *
  *                                                                            *
- * Parameters: itemid - [IN] the item identifier                              *
+ * Parameters: shard  - [IN] the value cache shard containing the item       *
+ *             itemid - [IN] the item identifier                              *
  *                                                                            *
  ******************************************************************************/
-static void	vc_remove_item_by_id(zbx_uint64_t itemid)
+static void	vc_remove_item_by_id(zbx_vc_shard_t *shard, zbx_uint64_t itemid)
 {
 	zbx_vc_item_t	*item;
 
-	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
+	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&shard->items, &itemid)))
 		return;
 
 	vch_item_free_cache(item);
-	zbx_hashset_remove_direct(&vc_cache->items, item);
+	zbx_hashset_remove_direct(&shard->items, item);
 }
 
 /******************************************************************************
@@ -1197,20 +1677,26 @@ static void	vc_remove_item_by_id(zbx_uint64_t itemid)
  ******************************************************************************/
 void	zbx_vc_remove_items_by_ids(zbx_vector_uint64_t *itemids)
 {
-	int	i;
-
 	if (ZBX_VC_DISABLED == vc_state)
 		return;
 
 	if (0 == itemids->values_num)
 		return;
 
-	WRLOCK_CACHE;
+	for (int i = 0; i < vc_cache->shards_num; i++)
+	{
+		zbx_vc_shard_t	*shard = vc_cache->shards[i];
+
+		WRLOCK_SHARD(shard);
 
-	for (i = 0; i < itemids->values_num; i++)
-		vc_remove_item_by_id(itemids->values[i]);
+		for (int j = 0; j < itemids->values_num; j++)
+		{
+			if (shard == vc_get_shard(itemids->values[j]))
+				vc_remove_item_by_id(shard, itemids->values[j]);
+		}
 
-	UNLOCK_CACHE;
+		UNLOCK_SHARD(shard);
+	}
 }
 
 /******************************************************************************
@@ -1239,7 +1725,7 @@ static void	vc_item_update_db_cached_from(zbx_vc_item_t *item, int timestamp)
  * as illustrated in the following diagram:
  *
  *  .----------------.
- *  | zbx_vc_cache_t |
+ *  | zbx_vc_shard_t |
  *  |----------------|      .---------------.
  *  | items          |----->| zbx_vc_item_t |-.
  *  '----------------'      |---------------| |-.
@@ -1295,7 +1781,7 @@ static void	vch_item_update_range(zbx_vc_item_t *item, int range, int now)
 		diff += 0xff;
 
 	if (NULL != item->head)
-		last_value_timestamp = item->head->slots[item->head->last_value].timestamp.sec;
+		last_value_timestamp = item->head->timestamps[item->head->last_value].sec;
 	else
 		last_value_timestamp = now;
 
@@ -1363,7 +1849,7 @@ static int	vch_item_add_chunk(zbx_vc_item_t *item, int nslots, zbx_vc_chunk_t *i
 	zbx_vc_chunk_t	*chunk;
 	size_t		chunk_size;
 
-	chunk_size =sizeof(zbx_vc_chunk_t) + sizeof(zbx_history_record_t) * (size_t)(nslots - 1);
+	chunk_size = sizeof(zbx_vc_chunk_t) + ZBX_VC_CHUNK_SLOT_SIZE * (size_t)nslots;
 
 	if (NULL == (chunk = (zbx_vc_chunk_t *)vc_item_malloc(item, chunk_size)))
 		return FAIL;
@@ -1371,6 +1857,10 @@ static int	vch_item_add_chunk(zbx_vc_item_t *item, int nslots, zbx_vc_chunk_t *i
 	memset(chunk, 0, sizeof(zbx_vc_chunk_t));
 	chunk->slots_num = nslots;
 
+	/* value and timestamp arrays are stored in the same memory block right after the chunk header */
+	chunk->values = (zbx_history_value_t *)(chunk + 1);
+	chunk->timestamps = (zbx_timespec_t *)(chunk->values + nslots);
+
 	chunk->next = insert_before;
 
 	if (NULL == insert_before)
@@ -1417,7 +1907,7 @@ static int	vch_chunk_find_last_value_before(const zbx_vc_chunk_t *chunk, const z
 	int	start = chunk->first_value, end = chunk->last_value, middle;
 
 	/* check if the last value timestamp is already greater or equal to the specified timestamp */
-	if (0 >= zbx_timespec_compare(&chunk->slots[end].timestamp, ts))
+	if (0 >= zbx_timespec_compare(&chunk->timestamps[end], ts))
 		return end;
 
 	/* chunk contains only one value, which did not pass the above check, return failure */
@@ -1429,13 +1919,13 @@ static int	vch_chunk_find_last_value_before(const zbx_vc_chunk_t *chunk, const z
 	{
 		middle = start + (end - start) / 2;
 
-		if (0 < zbx_timespec_compare(&chunk->slots[middle].timestamp, ts))
+		if (0 < zbx_timespec_compare(&chunk->timestamps[middle], ts))
 		{
 			end = middle;
 			continue;
 		}
 
-		if (0 >= zbx_timespec_compare(&chunk->slots[middle + 1].timestamp, ts))
+		if (0 >= zbx_timespec_compare(&chunk->timestamps[middle + 1], ts))
 		{
 			start = middle;
 			continue;
@@ -1477,9 +1967,9 @@ static int	vch_item_get_last_value(const zbx_vc_item_t *item, const zbx_timespec
 
 	index = chunk->last_value;
 
-	if (0 < zbx_timespec_compare(&chunk->slots[index].timestamp, ts))
+	if (0 < zbx_timespec_compare(&chunk->timestamps[index], ts))
 	{
-		while (0 < zbx_timespec_compare(&chunk->slots[chunk->first_value].timestamp, ts))
+		while (0 < zbx_timespec_compare(&chunk->timestamps[chunk->first_value], ts))
 		{
 			chunk = chunk->prev;
 			/* there are no values for requested range, return failure */
@@ -1514,26 +2004,26 @@ static int	vch_item_get_last_value(const zbx_vc_item_t *item, const zbx_timespec
 static int	vch_item_copy_value(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk, int index,
 		const zbx_history_record_t *source_value)
 {
-	zbx_history_record_t	*value;
+	zbx_history_value_t	*value;
 	int			ret = FAIL;
 
-	value = &chunk->slots[index];
+	value = &chunk->values[index];
 
 	switch (item->value_type)
 	{
 		case ITEM_VALUE_TYPE_STR:
 		case ITEM_VALUE_TYPE_TEXT:
-			if (NULL == (value->value.str = vc_item_strdup(item, source_value->value.str)))
+			if (NULL == (value->str = vc_item_strdup(item, source_value->value.str)))
 				goto out;
 			break;
 		case ITEM_VALUE_TYPE_LOG:
-			if (NULL == (value->value.log = vc_item_logdup(item, source_value->value.log)))
+			if (NULL == (value->log = vc_item_logdup(item, source_value->value.log)))
 				goto out;
 			break;
 		default:
-			value->value = source_value->value;
+			*value = source_value->value;
 	}
-	value->timestamp = source_value->timestamp;
+	chunk->timestamps[index] = source_value->timestamp;
 
 	ret = SUCCEED;
 out:
@@ -1566,12 +2056,12 @@ static int	vch_item_copy_values_at_tail(zbx_vc_item_t *item, const zbx_history_r
 		case ITEM_VALUE_TYPE_TEXT:
 			for (i = values_num - 1; i >= 0; i--)
 			{
-				zbx_history_record_t	*value = &item->tail->slots[item->tail->first_value - 1];
+				int	index = item->tail->first_value - 1;
 
-				if (NULL == (value->value.str = vc_item_strdup(item, values[i].value.str)))
+				if (NULL == (item->tail->values[index].str = vc_item_strdup(item, values[i].value.str)))
 					goto out;
 
-				value->timestamp = values[i].timestamp;
+				item->tail->timestamps[index] = values[i].timestamp;
 				item->tail->first_value--;
 			}
 			ret = SUCCEED;
@@ -1580,20 +2070,25 @@ static int	vch_item_copy_values_at_tail(zbx_vc_item_t *item, const zbx_history_r
 		case ITEM_VALUE_TYPE_LOG:
 			for (i = values_num - 1; i >= 0; i--)
 			{
-				zbx_history_record_t	*value = &item->tail->slots[item->tail->first_value - 1];
+				int	index = item->tail->first_value - 1;
 
-				if (NULL == (value->value.log = vc_item_logdup(item, values[i].value.log)))
+				if (NULL == (item->tail->values[index].log = vc_item_logdup(item, values[i].value.log)))
 					goto out;
 
-				value->timestamp = values[i].timestamp;
+				item->tail->timestamps[index] = values[i].timestamp;
 				item->tail->first_value--;
 			}
 			ret = SUCCEED;
 
 			break;
 		default:
-			memcpy(&item->tail->slots[item->tail->first_value - values_num], values,
-					(size_t)values_num * sizeof(zbx_history_record_t));
+			for (i = values_num - 1; i >= 0; i--)
+			{
+				int	index = item->tail->first_value - values_num + i;
+
+				item->tail->values[index] = values[i].value;
+				item->tail->timestamps[index] = values[i].timestamp;
+			}
 			item->tail->first_value -= values_num;
 			ret = SUCCEED;
 	}
@@ -1617,10 +2112,10 @@ static size_t	vch_item_free_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
 {
 	size_t	freed;
 
-	freed = sizeof(zbx_vc_chunk_t) + (size_t)(chunk->slots_num - 1) * sizeof(zbx_history_record_t);
-	freed += vc_item_free_values(item, chunk->slots, chunk->first_value, chunk->last_value);
+	freed = sizeof(zbx_vc_chunk_t) + (size_t)chunk->slots_num * ZBX_VC_CHUNK_SLOT_SIZE;
+	freed += vc_item_free_values(item, chunk->values, chunk->first_value, chunk->last_value);
 
-	__vc_shmem_free_func(chunk);
+	vc_item_free(item, chunk);
 
 	return freed;
 }
@@ -1673,9 +2168,9 @@ static void	vch_item_clean_cache(zbx_vc_item_t *item, int timestamp)
 		/* Try to remove chunks with all history values older than maximum request range, maximum */
 		/* request range should be calculated from last received value with which active range    */
 		/* was calculated to avoid dropping of chunks that might be still used in count request.  */
-		while (NULL != chunk && chunk->slots[chunk->last_value].timestamp.sec < timestamp &&
-				chunk->slots[chunk->last_value].timestamp.sec !=
-						item->head->slots[item->head->last_value].timestamp.sec)
+		while (NULL != chunk && chunk->timestamps[chunk->last_value].sec < timestamp &&
+				chunk->timestamps[chunk->last_value].sec !=
+						item->head->timestamps[item->head->last_value].sec)
 		{
 			/* don't remove the head chunk */
 			if (NULL == (next = chunk->next))
@@ -1689,18 +2184,18 @@ static void	vch_item_clean_cache(zbx_vc_item_t *item, int timestamp)
 			/* In this case increase the first value index of the next chunk until the first  */
 			/* value timestamp is greater.                                                    */
 
-			if (next->slots[next->first_value].timestamp.sec != next->slots[next->last_value].timestamp.sec)
+			if (next->timestamps[next->first_value].sec != next->timestamps[next->last_value].sec)
 			{
-				while (next->slots[next->first_value].timestamp.sec ==
-						chunk->slots[chunk->last_value].timestamp.sec)
+				while (next->timestamps[next->first_value].sec ==
+						chunk->timestamps[chunk->last_value].sec)
 				{
-					vc_item_free_values(item, next->slots, next->first_value, next->first_value);
+					vc_item_free_values(item, next->values, next->first_value, next->first_value);
 					next->first_value++;
 				}
 			}
 
 			/* set the database cached from timestamp to the last (oldest) removed value timestamp + 1 */
-			item->db_cached_from = chunk->slots[chunk->last_value].timestamp.sec + 1;
+			item->db_cached_from = chunk->timestamps[chunk->last_value].sec + 1;
 
 			vch_item_remove_chunk(item, chunk);
 
@@ -1731,18 +2226,18 @@ static void	vch_item_remove_values(zbx_vc_item_t *item, int timestamp)
 		item->status = 0;
 
 	/* try to remove chunks with all history values older than the timestamp */
-	while (NULL != chunk && chunk->slots[chunk->first_value].timestamp.sec < timestamp)
+	while (NULL != chunk && chunk->timestamps[chunk->first_value].sec < timestamp)
 	{
 		zbx_vc_chunk_t	*next;
 
 		/* If chunk contains values with timestamp greater or equal - remove */
 		/* only the values with less timestamp. Otherwise remove the while   */
 		/* chunk and check next one.                                         */
-		if (chunk->slots[chunk->last_value].timestamp.sec >= timestamp)
+		if (chunk->timestamps[chunk->last_value].sec >= timestamp)
 		{
-			while (chunk->slots[chunk->first_value].timestamp.sec < timestamp)
+			while (chunk->timestamps[chunk->first_value].sec < timestamp)
 			{
-				vc_item_free_values(item, chunk->slots, chunk->first_value, chunk->first_value);
+				vc_item_free_values(item, chunk->values, chunk->first_value, chunk->first_value);
 				chunk->first_value++;
 			}
 
@@ -1776,9 +2271,9 @@ static int	vch_item_add_value_at_head(zbx_vc_item_t *item, const zbx_history_rec
 	zbx_vc_chunk_t	*chunk, *schunk;
 
 	if (NULL != item->head &&
-			0 < zbx_history_record_compare_asc_func(&item->head->slots[item->head->last_value], value))
+			0 < zbx_timespec_compare(&item->head->timestamps[item->head->last_value], &value->timestamp))
 	{
-		if (0 < zbx_history_record_compare_asc_func(&item->tail->slots[item->tail->first_value], value))
+		if (0 < zbx_timespec_compare(&item->tail->timestamps[item->tail->first_value], &value->timestamp))
 		{
 			/* If the added value has the same or older timestamp as the first value in cache */
 			/* we can't add it to keep cache consistency. Additionally we must make sure no   */
@@ -1817,7 +2312,8 @@ static int	vch_item_add_value_at_head(zbx_vc_item_t *item, const zbx_history_rec
 
 		do
 		{
-			chunk->slots[index] = schunk->slots[sindex];
+			chunk->values[index] = schunk->values[sindex];
+			chunk->timestamps[index] = schunk->timestamps[sindex];
 
 			chunk = schunk;
 			index = sindex;
@@ -1826,7 +2322,8 @@ static int	vch_item_add_value_at_head(zbx_vc_item_t *item, const zbx_history_rec
 			{
 				if (NULL == (schunk = schunk->prev))
 				{
-					memset(&chunk->slots[index], 0, sizeof(zbx_vc_chunk_t));
+					memset(&chunk->values[index], 0, sizeof(zbx_history_value_t));
+					memset(&chunk->timestamps[index], 0, sizeof(zbx_timespec_t));
 					THIS_SHOULD_NEVER_HAPPEN;
 
 					goto out;
@@ -1835,7 +2332,7 @@ static int	vch_item_add_value_at_head(zbx_vc_item_t *item, const zbx_history_rec
 				sindex = schunk->last_value;
 			}
 		}
-		while (0 < zbx_timespec_compare(&schunk->slots[sindex].timestamp, &value->timestamp));
+		while (0 < zbx_timespec_compare(&schunk->timestamps[sindex], &value->timestamp));
 	}
 	else
 	{
@@ -1888,7 +2385,7 @@ static int	vch_item_add_values_at_tail(zbx_vc_item_t *item, const zbx_history_re
 	/* skip values already added to the item cache by another process */
 	if (NULL != item->tail)
 	{
-		int	sec = item->tail->slots[item->tail->first_value].timestamp.sec;
+		int	sec = item->tail->timestamps[item->tail->first_value].sec;
 
 		while (--count >= 0 && values[count].timestamp.sec >= sec)
 			;
@@ -1947,6 +2444,7 @@ static int	vch_item_cache_values_by_time(zbx_vc_item_t **item, int range_start)
 	zbx_vector_history_record_t	records;
 	zbx_uint64_t			itemid;
 	unsigned char			value_type;
+	zbx_vc_shard_t			*shard;
 
 	if (ZBX_ITEM_STATUS_CACHED_ALL == (*item)->status)
 		return SUCCEED;
@@ -1959,7 +2457,7 @@ static int	vch_item_cache_values_by_time(zbx_vc_item_t **item, int range_start)
 	if (NULL != (*item)->tail)
 	{
 		/* we need to get item values before the first cached value, but not including it */
-		range_end = (*item)->tail->slots[(*item)->tail->first_value].timestamp.sec - 1;
+		range_end = (*item)->tail->timestamps[(*item)->tail->first_value].sec - 1;
 	}
 	else
 		range_end = ZBX_JAN_2038;
@@ -1971,8 +2469,9 @@ static int	vch_item_cache_values_by_time(zbx_vc_item_t **item, int range_start)
 	zbx_vector_history_record_create(&records);
 	itemid = (*item)->itemid;
 	value_type = (*item)->value_type;
+	shard = vc_get_shard(itemid);
 
-	UNLOCK_CACHE;
+	UNLOCK_SHARD(shard);
 
 	if (SUCCEED == (ret = vc_db_read_values_by_time(itemid, value_type, &records, range_start, range_end)))
 	{
@@ -1980,16 +2479,16 @@ static int	vch_item_cache_values_by_time(zbx_vc_item_t **item, int range_start)
 				(zbx_compare_func_t)zbx_history_record_compare_asc_func);
 	}
 
-	WRLOCK_CACHE;
+	WRLOCK_SHARD(shard);
 
 	if (SUCCEED != ret)
 		goto out;
 
-	if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
+	if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_search(&shard->items, &itemid)))
 	{
 		zbx_vc_item_t	new_item = {.itemid = itemid, .value_type = value_type};
 
-		if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_insert(&vc_cache->items, &new_item,
+		if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_insert(&shard->items, &new_item,
 				sizeof(new_item))))
 		{
 			ret = FAIL;
@@ -2039,6 +2538,7 @@ static int	vch_item_cache_values_by_time_and_count(zbx_vc_item_t **item, int ran
 	zbx_vector_history_record_t	records;
 	zbx_uint64_t			itemid;
 	unsigned char			value_type;
+	zbx_vc_shard_t			*shard;
 
 	if (ZBX_ITEM_STATUS_CACHED_ALL == (*item)->status)
 		return SUCCEED;
@@ -2068,13 +2568,14 @@ static int	vch_item_cache_values_by_time_and_count(zbx_vc_item_t **item, int ran
 
 	/* get the end timestamp to which (including) the values should be cached */
 	if (NULL != (*item)->head)
-		range_end = (*item)->tail->slots[(*item)->tail->first_value].timestamp.sec - 1;
+		range_end = (*item)->tail->timestamps[(*item)->tail->first_value].sec - 1;
 	else
 		range_end = ZBX_JAN_2038;
 
 	itemid = (*item)->itemid;
 	value_type = (*item)->value_type;
-	UNLOCK_CACHE;
+	shard = vc_get_shard(itemid);
+	UNLOCK_SHARD(shard);
 
 	zbx_vector_history_record_create(&records);
 
@@ -2093,16 +2594,16 @@ static int	vch_item_cache_values_by_time_and_count(zbx_vc_item_t **item, int ran
 				(zbx_compare_func_t)zbx_history_record_compare_asc_func);
 	}
 
-	WRLOCK_CACHE;
+	WRLOCK_SHARD(shard);
 
 	if (SUCCEED != ret)
 		goto out;
 
-	if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
+	if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_search(&shard->items, &itemid)))
 	{
 		zbx_vc_item_t	new_item = {.itemid = itemid, .value_type = value_type};
 
-		if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_insert(&vc_cache->items, &new_item, sizeof(new_item))))
+		if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_insert(&shard->items, &new_item, sizeof(new_item))))
 		{
 			ret = FAIL;
 			goto out;
@@ -2127,7 +2628,7 @@ static int	vch_item_cache_values_by_time_and_count(zbx_vc_item_t **item, int ran
 	if ((count <= records.values_num || 0 == range_start) && 0 != records.values_num)
 	{
 		vc_item_update_db_cached_from(*item,
-				(*item)->tail->slots[(*item)->tail->first_value].timestamp.sec);
+				(*item)->tail->timestamps[(*item)->tail->first_value].sec);
 	}
 	else if (0 != range_start)
 		vc_item_update_db_cached_from(*item, range_start);
@@ -2140,71 +2641,129 @@ out:
 
 /******************************************************************************
  *                                                                            *
- * Purpose: retrieves item history data from cache                            *
+ * Purpose: appends chunk values to value vector                              *
  *                                                                            *
- * Parameters: item      - [IN] the item                                      *
- *             values    - [OUT] the item history data stored time/value      *
- *                         pairs in undefined order                           *
- *             seconds   - [IN] the time period to retrieve data for          *
- *             ts        - [IN] the requested period end timestamp            *
+ * Parameters: item  - [IN] the item                                          *
+ *             chunk - [IN] the chunk containing values                       *
+ *             first - [IN] the first (oldest) value index                    *
+ *             last  - [IN] the last (newest) value index                     *
+ *             data  - [IN/OUT] the value vector                              *
+ *                                                                            *
+ * Comments: The values are appended in descending order (newest first).      *
  *                                                                            *
  ******************************************************************************/
-static void	vch_item_get_values_by_time(const zbx_vc_item_t *item, zbx_vector_history_record_t *values, int seconds,
-		const zbx_timespec_t *ts)
+static void	vc_walk_append_values(const zbx_vc_item_t *item, const zbx_vc_chunk_t *chunk, int first, int last,
+		void *data)
 {
-	int		index, now;
-	zbx_timespec_t	start = {ts->sec - seconds, ts->ns};
-	zbx_vc_chunk_t	*chunk;
+	zbx_vector_history_record_t	*values = (zbx_vector_history_record_t *)data;
+	int				i;
 
-	/* Check if maximum request range is not set and all data are cached.  */
-	/* Because that indicates there was a count based request with unknown */
-	/* range which might be greater than the current request range.        */
-	if (0 != item->active_range || ZBX_ITEM_STATUS_CACHED_ALL != item->status)
-	{
-		now = (int)time(NULL);
-		/* add another second to include nanosecond shifts */
-		vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_RANGE, seconds + now - ts->sec + 1, now);
-	}
+	for (i = last; i >= first; i--)
+		vc_history_record_vector_append_slot(values, item->value_type, chunk, i);
+}
 
-	if (FAIL == vch_item_get_last_value(item, ts, &chunk, &index))
-	{
-		/* Cache does not contain records for the specified timeshift & seconds range. */
-		/* Return empty vector with success.                                           */
-		return;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: aggregates chunk values in place                                  *
+ *                                                                            *
+ * Parameters: item  - [IN] the item                                          *
+ *             chunk - [IN] the chunk containing values                       *
+ *             first - [IN] the first (oldest) value index                    *
+ *             last  - [IN] the last (newest) value index                     *
+ *             data  - [IN/OUT] the aggregation context                       *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_walk_aggregate_values(const zbx_vc_item_t *item, const zbx_vc_chunk_t *chunk, int first, int last,
+		void *data)
+{
+	ZBX_UNUSED(item);
+
+	vc_aggregate_values((zbx_vc_aggregate_t *)data, chunk->values, chunk->timestamps, first, last);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: walks item history data in cache                                  *
+ *                                                                            *
+ * Parameters: item      - [IN] the item                                      *
+ *             seconds   - [IN] the time period to walk data for              *
+ *             ts        - [IN] the requested period end timestamp            *
+ *             walk_func - [IN] the callback to process value ranges          *
+ *             walk_data - [IN/OUT] the callback data                         *
+ *                                                                            *
+ * Return value: the number of processed values                               *
+ *                                                                            *
+ * Comments: The values are passed to callback as chunk index ranges from the *
+ *           newest chunk to the oldest one.                                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_walk_values_by_time(const zbx_vc_item_t *item, int seconds, const zbx_timespec_t *ts,
+		zbx_vc_walk_func_t walk_func, void *walk_data)
+{
+	int		index, last, now, values_num = 0;
+	zbx_timespec_t	start = {ts->sec - seconds, ts->ns};
+	zbx_vc_chunk_t	*chunk;
+
+	/* Check if maximum request range is not set and all data are cached.  */
+	/* Because that indicates there was a count based request with unknown */
+	/* range which might be greater than the current request range.        */
+	if (0 != item->active_range || ZBX_ITEM_STATUS_CACHED_ALL != item->status)
+	{
+		now = (int)time(NULL);
+		/* add another second to include nanosecond shifts */
+		vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_RANGE, seconds + now - ts->sec + 1, now);
+	}
+
+	if (FAIL == vch_item_get_last_value(item, ts, &chunk, &index))
+	{
+		/* Cache does not contain records for the specified timeshift & seconds range. */
+		/* Return empty result with success.                                           */
+		return 0;
 	}
 
-	/* fill the values vector with item history values until the start timestamp is reached */
-	while (0 < zbx_timespec_compare(&chunk->slots[chunk->last_value].timestamp, &start))
+	/* walk item history values until the start timestamp is reached */
+	while (0 < zbx_timespec_compare(&chunk->timestamps[chunk->last_value], &start))
 	{
-		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&chunk->slots[index].timestamp, &start))
-			vc_history_record_vector_append(values, item->value_type, &chunk->slots[index--]);
+		for (last = index; index >= chunk->first_value &&
+				0 < zbx_timespec_compare(&chunk->timestamps[index], &start); index--)
+			;
+
+		if (index < last)
+		{
+			walk_func(item, chunk, index + 1, last, walk_data);
+			values_num += last - index;
+		}
 
 		if (NULL == (chunk = chunk->prev))
 			break;
 
 		index = chunk->last_value;
 	}
+
+	return values_num;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: retrieves item history data from cache                            *
+ * Purpose: walks item history data in cache                                  *
  *                                                                            *
  * Parameters: item      - [IN] the item                                      *
- *             values    - [OUT] the item history data stored time/value      *
- *                         pairs in undefined order, optional                 *
- *                         If null then cache is updated if necessary, but no *
- *                         values are returned. Used to ensure that cache     *
- *                         contains a value of the specified timestamp.       *
  *             seconds   - [IN] the time period                               *
- *             count     - [IN] the number of history values to retrieve      *
+ *             count     - [IN] the number of history values to walk          *
  *             timestamp - [IN] the target timestamp                          *
+ *             walk_func - [IN] the callback to process value ranges          *
+ *             walk_data - [IN/OUT] the callback data                         *
+ *                                                                            *
+ * Return value: the number of processed values                               *
+ *                                                                            *
+ * Comments: The values are passed to callback as chunk index ranges from the *
+ *           newest chunk to the oldest one.                                  *
  *                                                                            *
  ******************************************************************************/
-static void	vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, zbx_vector_history_record_t *values,
-		int seconds, int count, const zbx_timespec_t *ts)
+static int	vch_item_walk_values_by_time_and_count(zbx_vc_item_t *item, int seconds, int count,
+		const zbx_timespec_t *ts, zbx_vc_walk_func_t walk_func, void *walk_data)
 {
-	int		index, now, range_timestamp;
+	int		index, last, now, range_timestamp, values_num = 0;
 	zbx_vc_chunk_t	*chunk;
 	zbx_timespec_t	start;
 
@@ -2222,21 +2781,28 @@ static void	vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, zbx_vecto
 
 	if (FAIL == vch_item_get_last_value(item, ts, &chunk, &index))
 	{
-		/* return empty vector with success */
+		/* return empty result with success */
 		goto out;
 	}
 
-	/* fill the values vector with item history values until the <count> values are read    */
-	/* or no more values within specified time period                                       */
-	/* fill the values vector with item history values until the start timestamp is reached */
-	while (0 < zbx_timespec_compare(&chunk->slots[chunk->last_value].timestamp, &start))
+	/* walk item history values until the <count> values are read or no more values */
+	/* within specified time period                                                  */
+	while (0 < zbx_timespec_compare(&chunk->timestamps[chunk->last_value], &start))
 	{
-		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&chunk->slots[index].timestamp, &start))
+		for (last = index; index >= chunk->first_value && values_num < count &&
+				0 < zbx_timespec_compare(&chunk->timestamps[index], &start); index--)
 		{
-			vc_history_record_vector_append(values, item->value_type, &chunk->slots[index--]);
+			values_num++;
+		}
 
-			if (values->values_num == count)
-				goto out;
+		if (index < last)
+			walk_func(item, chunk, index + 1, last, walk_data);
+
+		if (values_num == count)
+		{
+			/* the requested number of values was retrieved, set the range to the oldest value timestamp */
+			range_timestamp = chunk->timestamps[index + 1].sec - 1;
+			goto update;
 		}
 
 		if (NULL == (chunk = chunk->prev))
@@ -2245,57 +2811,46 @@ static void	vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, zbx_vecto
 		index = chunk->last_value;
 	}
 out:
-	if (count > values->values_num)
-	{
-		if (0 == seconds)
-			return;
-
-		/* not enough data in the requested period, set the range equal to the period plus */
-		/* one second to include nanosecond shifts                                         */
-		range_timestamp = ts->sec - seconds;
-	}
-	else
-	{
-		/* the requested number of values was retrieved, set the range to the oldest value timestamp */
-		range_timestamp = values->values[values->values_num - 1].timestamp.sec - 1;
-	}
+	if (0 == seconds)
+		return values_num;
 
+	/* not enough data in the requested period, set the range equal to the period plus */
+	/* one second to include nanosecond shifts                                         */
+	range_timestamp = ts->sec - seconds;
+update:
 	now = (int)time(NULL);
 	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_RANGE, now - range_timestamp, now);
+
+	return values_num;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: get item values for the specified range                           *
+ * Purpose: walks item values for the specified range                         *
  *                                                                            *
  * Parameters: item      - [IN] the item                                      *
- *             values    - [OUT] the item history data stored time/value      *
- *                         pairs in undefined order, optional                 *
- *                         If null then cache is updated if necessary, but no *
- *                         values are returned. Used to ensure that cache     *
- *                         contains a value of the specified timestamp.       *
- *             seconds   - [IN] the time period to retrieve data for          *
- *             count     - [IN] the number of history values to retrieve      *
+ *             seconds   - [IN] the time period to walk data for              *
+ *             count     - [IN] the number of history values to walk          *
  *             ts        - [IN] the target timestamp                          *
+ *             walk_func - [IN] the callback to process value ranges          *
+ *             walk_data - [IN/OUT] the callback data                         *
  *                                                                            *
- * Return value:  SUCCEED - the item history data was retrieved successfully  *
- *                FAIL    - the item history data was not retrieved           *
+ * Return value:  SUCCEED - the item history data was walked successfully     *
+ *                FAIL    - the item history data was not walked              *
  *                                                                            *
- * Comments: This function returns data from cache if necessary updating it   *
- *           from DB. If cache update was required and failed (not enough     *
- *           memory to cache DB values), then this function also fails.       *
+ * Comments: This function walks data in cache if necessary updating it from  *
+ *           DB. If cache update was required and failed (not enough memory   *
+ *           to cache DB values), then this function also fails.              *
  *                                                                            *
  *           If <count> is set then value range is defined as <count> values  *
  *           before <timestamp>. Otherwise the range is defined as <seconds>  *
  *           seconds before <timestamp>.                                      *
  *                                                                            *
  ******************************************************************************/
-static int	vch_item_get_values(zbx_vc_item_t *item, zbx_vector_history_record_t *values, int seconds,
-		int count, const zbx_timespec_t *ts)
+static int	vch_item_walk_values(zbx_vc_item_t *item, int seconds, int count, const zbx_timespec_t *ts,
+		zbx_vc_walk_func_t walk_func, void *walk_data)
 {
-	int	ret, records_read, hits, misses, range_start;
-
-	zbx_vector_history_record_clear(values);
+	int	ret, records_read, values_num, hits, misses, range_start;
 
 	if (0 == count)
 	{
@@ -2307,10 +2862,7 @@ static int	vch_item_get_values(zbx_vc_item_t *item, zbx_vector_history_record_t
 
 		records_read = ret;
 
-		vch_item_get_values_by_time(item, values, seconds, ts);
-
-		if (records_read > values->values_num)
-			records_read = values->values_num;
+		values_num = vch_item_walk_values_by_time(item, seconds, ts, walk_func, walk_data);
 	}
 	else
 	{
@@ -2321,13 +2873,13 @@ static int	vch_item_get_values(zbx_vc_item_t *item, zbx_vector_history_record_t
 
 		records_read = ret;
 
-		vch_item_get_values_by_time_and_count(item, values, seconds, count, ts);
-
-		if (records_read > values->values_num)
-			records_read = values->values_num;
+		values_num = vch_item_walk_values_by_time_and_count(item, seconds, count, ts, walk_func, walk_data);
 	}
 
-	hits = values->values_num - records_read;
+	if (records_read > values_num)
+		records_read = values_num;
+
+	hits = values_num - records_read;
 	misses = records_read;
 
 	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_STATS, hits, misses);
@@ -2337,6 +2889,29 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get item values for the specified range                           *
+ *                                                                            *
+ * Parameters: item      - [IN] the item                                      *
+ *             values    - [OUT] the item history data stored time/value      *
+ *                         pairs in descending order                          *
+ *             seconds   - [IN] the time period to retrieve data for          *
+ *             count     - [IN] the number of history values to retrieve      *
+ *             ts        - [IN] the target timestamp                          *
+ *                                                                            *
+ * Return value:  SUCCEED - the item history data was retrieved successfully  *
+ *                FAIL    - the item history data was not retrieved           *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_get_values(zbx_vc_item_t *item, zbx_vector_history_record_t *values, int seconds,
+		int count, const zbx_timespec_t *ts)
+{
+	zbx_vector_history_record_clear(values);
+
+	return vch_item_walk_values(item, seconds, count, ts, vc_walk_append_values, values);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: frees resources allocated for item history data                   *
@@ -2379,60 +2954,88 @@ static size_t	vch_item_free_cache(zbx_vc_item_t *item)
  ******************************************************************************/
 int	zbx_vc_init(zbx_uint64_t value_cache_size, char **error)
 {
-	zbx_uint64_t	size_reserved;
-	int		ret = FAIL;
+	zbx_uint64_t	size_reserved, shard_size;
+	int		ret = FAIL, shards_num;
+	zbx_vc_shard_t	*shards[ZBX_VC_SHARDS_MAX];
 
 	if (0 == value_cache_size)
 		return SUCCEED;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	if (SUCCEED != (ret = zbx_rwlock_create(&vc_lock, ZBX_RWLOCK_VALUECACHE, error)))
-		goto out;
+	/* split value cache into shards only if each shard gets reasonable amount of memory */
+	if (1 > (shards_num = (int)(value_cache_size / ZBX_VC_SHARD_SIZE_MIN)))
+		shards_num = 1;
+	else if (ZBX_VC_SHARDS_MAX < shards_num)
+		shards_num = ZBX_VC_SHARDS_MAX;
 
+	shard_size = value_cache_size / (zbx_uint64_t)shards_num;
 	size_reserved = zbx_shmem_required_size(1, "value cache size", "ValueCacheSize");
 
-	if (SUCCEED != zbx_shmem_create(&vc_mem, value_cache_size, "value cache size", "ValueCacheSize", 1,
-			error))
+	for (int i = 0; i < shards_num; i++)
 	{
-		goto out;
-	}
+		zbx_rwlock_name_t	lock_name;
+
+		lock_name = (0 == i ? ZBX_RWLOCK_VALUECACHE : ZBX_RWLOCK_VALUECACHE_SHARD + i - 1);
 
-	value_cache_size -= size_reserved;
+		if (SUCCEED != zbx_rwlock_create(&vc_shard_lock[i], lock_name, error))
+			goto out;
 
-	vc_cache = (zbx_vc_cache_t *)__vc_shmem_malloc_func(vc_cache, sizeof(zbx_vc_cache_t));
+		if (SUCCEED != zbx_shmem_create(&vc_mem[i], shard_size, "value cache size", "ValueCacheSize", 1,
+				error))
+		{
+			goto out;
+		}
 
-	if (NULL == vc_cache)
-	{
-		*error = zbx_strdup(*error, "cannot allocate value cache header");
-		goto out;
-	}
-	memset(vc_cache, 0, sizeof(zbx_vc_cache_t));
+		zbx_shmem_enable_slab(vc_mem[i]);
 
-	zbx_hashset_create_ext(&vc_cache->items, VC_ITEMS_INIT_SIZE,
-			ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
-			__vc_shmem_malloc_func, __vc_shmem_realloc_func, __vc_shmem_free_func);
+		if (NULL == (shards[i] = (zbx_vc_shard_t *)vc_mem_funcs[i].mem_malloc_func(NULL,
+				sizeof(zbx_vc_shard_t))))
+		{
+			*error = zbx_strdup(*error, "cannot allocate value cache shard");
+			goto out;
+		}
 
-	if (NULL == vc_cache->items.slots)
-	{
-		*error = zbx_strdup(*error, "cannot allocate value cache data storage");
-		goto out;
-	}
+		memset(shards[i], 0, sizeof(zbx_vc_shard_t));
+		shards[i]->index = i;
 
-	zbx_hashset_create_ext(&vc_cache->strpool, VC_STRPOOL_INIT_SIZE,
-			vc_strpool_hash_func, vc_strpool_compare_func, NULL,
-			__vc_shmem_malloc_func, __vc_shmem_realloc_func, __vc_shmem_free_func);
+		zbx_hashset_create_ext(&shards[i]->items, VC_ITEMS_INIT_SIZE,
+				ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
+				vc_mem_funcs[i].mem_malloc_func, vc_mem_funcs[i].mem_realloc_func,
+				vc_mem_funcs[i].mem_free_func);
 
-	if (NULL == vc_cache->strpool.slots)
+		if (NULL == shards[i]->items.slots)
+		{
+			*error = zbx_strdup(*error, "cannot allocate value cache data storage");
+			goto out;
+		}
+
+		zbx_hashset_create_ext(&shards[i]->strpool, VC_STRPOOL_INIT_SIZE,
+				vc_strpool_hash_func, vc_strpool_compare_func, NULL,
+				vc_mem_funcs[i].mem_malloc_func, vc_mem_funcs[i].mem_realloc_func,
+				vc_mem_funcs[i].mem_free_func);
+
+		if (NULL == shards[i]->strpool.slots)
+		{
+			*error = zbx_strdup(*error, "cannot allocate string pool for value cache data storage");
+			goto out;
+		}
+
+		/* the free space request should be 5% of shard size, but no more than 128KB */
+		shards[i]->min_free_request = ((shard_size - size_reserved) / 100) * 5;
+		if (shards[i]->min_free_request > 128 * ZBX_KIBIBYTE)
+			shards[i]->min_free_request = 128 * ZBX_KIBIBYTE;
+	}
+
+	if (NULL == (vc_cache = (zbx_vc_cache_t *)vc_mem_funcs[0].mem_malloc_func(NULL, sizeof(zbx_vc_cache_t))))
 	{
-		*error = zbx_strdup(*error, "cannot allocate string pool for value cache data storage");
+		*error = zbx_strdup(*error, "cannot allocate value cache header");
 		goto out;
 	}
 
-	/* the free space request should be 5% of cache size, but no more than 128KB */
-	vc_cache->min_free_request = (value_cache_size / 100) * 5;
-	if (vc_cache->min_free_request > 128 * ZBX_KIBIBYTE)
-		vc_cache->min_free_request = 128 * ZBX_KIBIBYTE;
+	memset(vc_cache, 0, sizeof(zbx_vc_cache_t));
+	memcpy(vc_cache->shards, shards, sizeof(zbx_vc_shard_t *) * (size_t)shards_num);
+	vc_cache->shards_num = shards_num;
 
 	zbx_vector_vc_itemupdate_create(&vc_itemupdates);
 	zbx_vector_vc_itemupdate_reserve(&vc_itemupdates, 256);
@@ -2441,7 +3044,7 @@ int	zbx_vc_init(zbx_uint64_t value_cache_size, char **error)
 out:
 	zbx_vc_disable();
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() shards:%d", __func__, shards_num);
 
 	return ret;
 }
@@ -2457,17 +3060,29 @@ void	zbx_vc_destroy(void)
 
 	if (NULL != vc_cache)
 	{
+		int	shards_num = vc_cache->shards_num;
+
 		zbx_vector_vc_itemupdate_destroy(&vc_itemupdates);
 
-		zbx_hashset_destroy(&vc_cache->items);
-		zbx_hashset_destroy(&vc_cache->strpool);
+		for (int i = 0; i < shards_num; i++)
+		{
+			zbx_vc_shard_t	*shard = vc_cache->shards[i];
+
+			zbx_hashset_destroy(&shard->items);
+			zbx_hashset_destroy(&shard->strpool);
+
+			vc_mem_funcs[i].mem_free_func(shard);
+		}
 
-		__vc_shmem_free_func(vc_cache);
+		vc_mem_funcs[0].mem_free_func(vc_cache);
 		vc_cache = NULL;
 
-		zbx_shmem_destroy(vc_mem);
-		vc_mem = NULL;
-		zbx_rwlock_destroy(&vc_lock);
+		for (int i = 0; i < shards_num; i++)
+		{
+			zbx_shmem_destroy(vc_mem[i]);
+			vc_mem[i] = NULL;
+			zbx_rwlock_destroy(&vc_shard_lock[i]);
+		}
 	}
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
@@ -2487,31 +3102,91 @@ void	zbx_vc_reset(void)
 
 	if (NULL != vc_cache)
 	{
-		zbx_vc_item_t		*item;
-		zbx_hashset_iter_t	iter;
+		for (int i = 0; i < vc_cache->shards_num; i++)
+		{
+			zbx_vc_item_t		*item;
+			zbx_hashset_iter_t	iter;
+			zbx_vc_shard_t		*shard = vc_cache->shards[i];
 
-		WRLOCK_CACHE;
+			WRLOCK_SHARD(shard);
 
-		zbx_hashset_iter_reset(&vc_cache->items, &iter);
-		while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
-		{
-			vch_item_free_cache(item);
-			zbx_hashset_iter_remove(&iter);
-		}
+			zbx_hashset_iter_reset(&shard->items, &iter);
+			while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
+			{
+				vch_item_free_cache(item);
+				zbx_hashset_iter_remove(&iter);
+			}
 
-		vc_cache->hits = 0;
-		vc_cache->misses = 0;
-		vc_cache->min_free_request = 0;
-		vc_cache->mode = ZBX_VC_MODE_NORMAL;
-		vc_cache->mode_time = 0;
-		vc_cache->last_warning_time = 0;
+			shard->hits = 0;
+			shard->misses = 0;
+			shard->min_free_request = 0;
+			shard->mode = ZBX_VC_MODE_NORMAL;
+			shard->mode_time = 0;
+			shard->last_warning_time = 0;
 
-		UNLOCK_CACHE;
+			UNLOCK_SHARD(shard);
+		}
 	}
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds item value to the value cache shard                          *
+ *                                                                            *
+ * Parameters: shard - [IN] the value cache shard of the item                 *
+ *             h     - [IN] the item history value                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_shard_add_value(zbx_vc_shard_t *shard, const zbx_dc_history_t *h)
+{
+	zbx_vc_item_t	*item;
+
+	item = (zbx_vc_item_t *)zbx_hashset_search(&shard->items, &h->itemid);
+
+	if (NULL == item && 0 != (h->flags & ZBX_DC_FLAG_HASTRIGGER) && ZBX_VC_MODE_NORMAL == shard->mode)
+	{
+		zbx_vc_item_t	item_local = {
+				.itemid = h->itemid,
+				.value_type = h->value_type,
+				.last_accessed = (int)time(NULL)
+
+		};
+
+		item = (zbx_vc_item_t *)zbx_hashset_insert(&shard->items, &item_local, sizeof(item_local));
+	}
+
+	/* cache new values only after the item history database status is known */
+	if (NULL != item && (ZBX_ITEM_STATUS_CACHED_ALL == item->status || 0 != item->db_cached_from))
+	{
+		zbx_history_record_t	record = {h->ts, h->value};
+		zbx_vc_chunk_t		*head = item->head;
+		int			last_value_timestamp;
+
+		if (NULL != head)
+			last_value_timestamp = head->timestamps[head->last_value].sec;
+		else
+			last_value_timestamp = (int)time(NULL);
+
+		/* If the new value type does not match the item's type in cache remove it, */
+		/* so it's cached with the correct type from correct tables when accessed   */
+		/* next time.                                                               */
+		/* Also remove item if the value adding failed. In this case we             */
+		/* won't have the latest data in cache - so the requests must go directly   */
+		/* to the database.                                                         */
+		if (item->value_type != h->value_type || FAIL == vch_item_add_value_at_head(item, &record))
+		{
+			vc_remove_item(item);
+			return;
+		}
+
+		/* try to remove old (unused) chunks if a new chunk was added */
+		if (head != item->head)
+			vch_item_clean_cache(item, last_value_timestamp);
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: adds item values to the history and value cache                   *
@@ -2521,71 +3196,35 @@ void	zbx_vc_reset(void)
  * Return value: SUCCEED - the values were added successfully                 *
  *               FAIL    - otherwise                                          *
  *                                                                            *
+ * Comments: Each cache shard is locked only while adding values of the items *
+ *           belonging to it.                                                 *
+ *                                                                            *
  ******************************************************************************/
 int	zbx_vc_add_values(zbx_vector_ptr_t *history, int *ret_flush)
 {
-	zbx_vc_item_t		*item;
-	int			i;
-	zbx_dc_history_t	*h;
-
 	if (SUCCEED != zbx_history_add_values(history, ret_flush))
 		return FAIL;
 
 	if (ZBX_VC_DISABLED == vc_state)
 		return SUCCEED;
 
-	WRLOCK_CACHE;
-
-	for (i = 0; i < history->values_num; i++)
+	for (int i = 0; i < vc_cache->shards_num; i++)
 	{
-		h = (zbx_dc_history_t *)history->values[i];
+		zbx_vc_shard_t	*shard = vc_cache->shards[i];
 
-		item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &h->itemid);
+		WRLOCK_SHARD(shard);
 
-		if (NULL == item && 0 != (h->flags & ZBX_DC_FLAG_HASTRIGGER) && ZBX_VC_MODE_NORMAL == vc_cache->mode)
+		for (int j = 0; j < history->values_num; j++)
 		{
-			zbx_vc_item_t	item_local = {
-					.itemid = h->itemid,
-					.value_type = h->value_type,
-					.last_accessed = (int)time(NULL)
+			const zbx_dc_history_t	*h = (const zbx_dc_history_t *)history->values[j];
 
-			};
-
-			item = (zbx_vc_item_t *)zbx_hashset_insert(&vc_cache->items, &item_local, sizeof(item_local));
+			if (shard == vc_get_shard(h->itemid))
+				vc_shard_add_value(shard, h);
 		}
 
-		/* cache new values only after the item history database status is known */
-		if (NULL != item && (ZBX_ITEM_STATUS_CACHED_ALL == item->status || 0 != item->db_cached_from))
-		{
-			zbx_history_record_t	record = {h->ts, h->value};
-			zbx_vc_chunk_t		*head = item->head;
-			int			last_value_timestamp;
-
-			if (NULL != head)
-				last_value_timestamp = head->slots[head->last_value].timestamp.sec;
-			else
-				last_value_timestamp = (int)time(NULL);
-
-			/* If the new value type does not match the item's type in cache remove it, */
-			/* so it's cached with the correct type from correct tables when accessed   */
-			/* next time.                                                               */
-			/* Also remove item if the value adding failed. In this case we             */
-			/* won't have the latest data in cache - so the requests must go directly   */
-			/* to the database.                                                         */
-			if (item->value_type != h->value_type || FAIL == vch_item_add_value_at_head(item, &record))
-			{
-				vc_remove_item(item);
-				continue;
-			}
-
-			/* try to remove old (unused) chunks if a new chunk was added */
-			if (head != item->head)
-				vch_item_clean_cache(item, last_value_timestamp);
-		}
+		UNLOCK_SHARD(shard);
 	}
 
-	UNLOCK_CACHE;
-
 	return SUCCEED;
 }
 
@@ -2616,23 +3255,30 @@ int	zbx_vc_get_values(zbx_uint64_t itemid, unsigned char value_type, zbx_vector_
 		int seconds, int count, const zbx_timespec_t *ts)
 {
 	zbx_vc_item_t	*item, new_item;
+	zbx_vc_shard_t	*shard;
 	int 		ret = FAIL, cache_used = 1;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64 " value_type:%d count:%d period:%d end_timestamp"
 			" '%s'", __func__, itemid, value_type, count, seconds, zbx_timespec_str(ts));
 
-	RDLOCK_CACHE;
-
 	if (ZBX_VC_DISABLED == vc_state)
+	{
+		cache_used = 0;
+		ret = vc_db_get_values(itemid, value_type, values, seconds, count, ts);
 		goto out;
+	}
+
+	shard = vc_get_shard(itemid);
+
+	RDLOCK_SHARD(shard);
 
-	if (ZBX_VC_MODE_LOWMEM == vc_cache->mode)
-		vc_warn_low_memory();
+	if (ZBX_VC_MODE_LOWMEM == shard->mode)
+		vc_warn_low_memory(shard);
 
-	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
+	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&shard->items, &itemid)))
 	{
-		if (ZBX_VC_MODE_NORMAL != vc_cache->mode)
-			goto out;
+		if (ZBX_VC_MODE_NORMAL != shard->mode)
+			goto read_db;
 
 		memset(&new_item, 0, sizeof(new_item));
 		new_item.itemid = itemid;
@@ -2640,27 +3286,26 @@ int	zbx_vc_get_values(zbx_uint64_t itemid, unsigned char value_type, zbx_vector_
 		item = &new_item;
 	}
 	else if (item->value_type != value_type)
-		goto out;
+		goto read_db;
 
 	ret = vch_item_get_values(item, values, seconds, count, ts);
-out:
+read_db:
 	if (FAIL == ret)
 	{
 		cache_used = 0;
 
-		UNLOCK_CACHE;
+		UNLOCK_SHARD(shard);
 		ret = vc_db_get_values(itemid, value_type, values, seconds, count, ts);
-		WRLOCK_CACHE;
+		WRLOCK_SHARD(shard);
 
-		if (ZBX_VC_DISABLED != vc_state)
-			vc_remove_item_by_id(itemid);
+		vc_remove_item_by_id(shard, itemid);
 
 		if (SUCCEED == ret)
-			vc_update_statistics(NULL, 0, values->values_num, (int)time(NULL));
+			vc_update_statistics(shard, NULL, 0, values->values_num, (int)time(NULL));
 	}
 
-	UNLOCK_CACHE;
-
+	UNLOCK_SHARD(shard);
+out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s count:%d cached:%d",
 			__func__, zbx_result_string(ret), values->values_num, cache_used);
 
@@ -2688,106 +3333,286 @@ out:
 int	zbx_vc_get_value(zbx_uint64_t itemid, unsigned char value_type, const zbx_timespec_t *ts,
 		zbx_history_record_t *value)
 {
-	zbx_vector_history_record_t	values;
-	int				ret = FAIL;
-
-	zbx_history_record_vector_create(&values);
-
-	if (SUCCEED != zbx_vc_get_values(itemid, value_type, &values, ts->sec, 1, ts) || 0 == values.values_num)
-		goto out;
-
-	*value = values.values[0];
+	int	values_num;
 
-	/* reset values vector size so the returned value is not cleared when destroying the vector */
-	values.values_num = 0;
-
-	ret = SUCCEED;
-out:
-	zbx_history_record_vector_destroy(&values, value_type);
+	if (SUCCEED != zbx_vc_aggregate(itemid, value_type, ZBX_VC_AGGREGATE_LAST, 0, ts->sec, 1, ts, value,
+			&values_num) || 0 == values_num)
+	{
+		return FAIL;
+	}
 
-	return ret;
+	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: retrieves usage cache statistics                                  *
+ * Purpose: aggregate item history data read from database                    *
  *                                                                            *
- * Parameters: stats     - [OUT] the cache usage statistics                   *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             agg        - [IN/OUT] the aggregation data                     *
+ *             seconds    - [IN] the time period to aggregate data for        *
+ *             count      - [IN] the number of history values to aggregate    *
+ *             ts         - [IN] the period end timestamp                     *
  *                                                                            *
- * Return value:  SUCCEED - the cache statistics were retrieved successfully  *
- *                FAIL    - failed to retrieve cache statistics               *
- *                          (cache was not initialized)                       *
+ * Return value:  SUCCEED - the item history data was aggregated successfully *
+ *                FAIL    - the item history data was not aggregated          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_vc_get_statistics(zbx_vc_stats_t *stats)
+static int	vc_db_aggregate_values(zbx_uint64_t itemid, unsigned char value_type, zbx_vc_aggregate_t *agg,
+		int seconds, int count, const zbx_timespec_t *ts)
 {
-	if (ZBX_VC_DISABLED == vc_state)
-		return FAIL;
+	zbx_vector_history_record_t	values;
+	int				ret;
 
-	RDLOCK_CACHE;
+	zbx_history_record_vector_create(&values);
 
-	stats->hits = vc_cache->hits;
-	stats->misses = vc_cache->misses;
-	stats->mode = vc_cache->mode;
+	if (SUCCEED == (ret = vc_db_get_values(itemid, value_type, &values, seconds, count, ts)))
+	{
+		for (int i = 0; i < values.values_num; i++)
+			vc_aggregate_values(agg, &values.values[i].value, &values.values[i].timestamp, 0, 0);
 
-	stats->total_size = vc_mem->total_size;
-	stats->free_size = vc_mem->free_size;
+		vc_aggregate_finish(agg);
+	}
 
-	UNLOCK_CACHE;
+	zbx_history_record_vector_destroy(&values, value_type);
 
-	return SUCCEED;
+	return ret;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: enables value caching for current process                         *
+ * Purpose: aggregate item history data for the specified time period         *
  *                                                                            *
- ******************************************************************************/
-void	zbx_vc_enable(void)
-{
-	if (NULL != vc_cache)
-		vc_state = ZBX_VC_ENABLED;
-}
-
-/******************************************************************************
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             op         - [IN] the aggregation operation, see               *
+ *                               ZBX_VC_AGGREGATE_* defines                   *
+ *             param      - [IN] the operation parameter - percentage for     *
+ *                               ZBX_VC_AGGREGATE_PERCENTILE, ignored by      *
+ *                               other operations                             *
+ *             seconds    - [IN] the time period to aggregate data for        *
+ *             count      - [IN] the number of history values to aggregate    *
+ *             ts         - [IN] the period end timestamp                     *
+ *             result     - [OUT] the aggregation result, see Comments        *
+ *             values_num - [OUT] the number of aggregated values             *
+ *                                                                            *
+ * Return value:  SUCCEED - the item history data was aggregated successfully *
+ *                FAIL    - the item history data was not aggregated          *
+ *                                                                            *
+ * Comments: The values are aggregated directly in cache under cache lock     *
+ *           without copying them out. If the data is not in cache, it's read *
+ *           from DB.                                                         *
+ *                                                                            *
+ *           The result depends on the operation:                             *
+ *             COUNT      - no result value, only values_num is set           *
+ *             SUM, MIN,  - value of the item value type, only float and      *
+ *             MAX,         unsigned integer items are supported              *
+ *             PERCENTILE                                                     *
+ *             AVG        - double value, only float and unsigned integer     *
+ *                          items are supported                               *
+ *             FIRST,     - the oldest/newest value in range together with    *
+ *             LAST         its timestamp. The str, text and log values must  *
+ *                          be freed by caller with zbx_history_record_clear()*
+ *             CHANGE     - double value, the difference between the two     *
+ *                          newest values in range, or 0/1 for str, text and  *
+ *                          log items depending on whether values are equal  *
  *                                                                            *
- * Purpose: disables value caching for current process                        *
+ *           If <count> is set then value range is defined as <count> values  *
+ *           before <timestamp>. Otherwise the range is defined as <seconds>  *
+ *           seconds before <timestamp>.                                      *
  *                                                                            *
  ******************************************************************************/
-void	zbx_vc_disable(void)
+int	zbx_vc_aggregate(zbx_uint64_t itemid, unsigned char value_type, int op, double param, int seconds, int count,
+		const zbx_timespec_t *ts, zbx_history_record_t *result, int *values_num)
 {
-	vc_state = ZBX_VC_DISABLED;
-}
+	zbx_vc_item_t		*item, new_item;
+	zbx_vc_aggregate_t	agg;
+	zbx_vc_shard_t		*shard;
+	int 			ret = FAIL, cache_used = 1;
 
-/******************************************************************************
- *                                                                            *
- * Purpose: get value cache diagnostic statistics                             *
- *                                                                            *
- ******************************************************************************/
-void	zbx_vc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num, int *mode)
-{
-	zbx_hashset_iter_t	iter;
-	zbx_vc_item_t		*item;
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64 " value_type:%d op:%d count:%d period:%d"
+			" end_timestamp '%s'", __func__, itemid, value_type, op, count, seconds, zbx_timespec_str(ts));
+
+	switch (op)
+	{
+		case ZBX_VC_AGGREGATE_COUNT:
+		case ZBX_VC_AGGREGATE_FIRST:
+		case ZBX_VC_AGGREGATE_LAST:
+		case ZBX_VC_AGGREGATE_CHANGE:
+			break;
+		default:
+			if (ITEM_VALUE_TYPE_FLOAT != value_type && ITEM_VALUE_TYPE_UINT64 != value_type)
+			{
+				THIS_SHOULD_NEVER_HAPPEN;
+				return FAIL;
+			}
+	}
+
+	vc_aggregate_init(&agg, value_type, op);
+
+	if (ZBX_VC_DISABLED == vc_state)
+	{
+		cache_used = 0;
+		ret = vc_db_aggregate_values(itemid, value_type, &agg, seconds, count, ts);
+		goto out;
+	}
+
+	shard = vc_get_shard(itemid);
+
+	RDLOCK_SHARD(shard);
+
+	if (ZBX_VC_MODE_LOWMEM == shard->mode)
+		vc_warn_low_memory(shard);
+
+	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&shard->items, &itemid)))
+	{
+		if (ZBX_VC_MODE_NORMAL != shard->mode)
+			goto read_db;
+
+		memset(&new_item, 0, sizeof(new_item));
+		new_item.itemid = itemid;
+		new_item.value_type = value_type;
+		item = &new_item;
+	}
+	else if (item->value_type != value_type)
+		goto read_db;
+
+	if (SUCCEED == (ret = vch_item_walk_values(item, seconds, count, ts, vc_walk_aggregate_values, &agg)))
+		vc_aggregate_finish(&agg);
+read_db:
+	if (FAIL == ret)
+	{
+		cache_used = 0;
+		vc_aggregate_clear(&agg);
+		vc_aggregate_init(&agg, value_type, op);
+
+		UNLOCK_SHARD(shard);
+		ret = vc_db_aggregate_values(itemid, value_type, &agg, seconds, count, ts);
+		WRLOCK_SHARD(shard);
+
+		vc_remove_item_by_id(shard, itemid);
+
+		if (SUCCEED == ret)
+			vc_update_statistics(shard, NULL, 0, agg.values_num, (int)time(NULL));
+	}
+
+	UNLOCK_SHARD(shard);
+out:
+	if (ZBX_VC_AGGREGATE_PERCENTILE == op)
+		vc_aggregate_percentile(&agg, param);
+
+	*result = agg.result;
+	*values_num = agg.values_num;
+
+	vc_aggregate_clear(&agg);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s count:%d cached:%d",
+			__func__, zbx_result_string(ret), agg.values_num, cache_used);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: retrieves usage cache statistics                                  *
+ *                                                                            *
+ * Parameters: stats     - [OUT] the cache usage statistics                   *
+ *                                                                            *
+ * Return value:  SUCCEED - the cache statistics were retrieved successfully  *
+ *                FAIL    - failed to retrieve cache statistics               *
+ *                          (cache was not initialized)                       *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_get_statistics(zbx_vc_stats_t *stats)
+{
+	if (ZBX_VC_DISABLED == vc_state)
+		return FAIL;
+
+	memset(stats, 0, sizeof(zbx_vc_stats_t));
+	stats->mode = ZBX_VC_MODE_NORMAL;
+
+	for (int i = 0; i < vc_cache->shards_num; i++)
+	{
+		zbx_vc_shard_t	*shard = vc_cache->shards[i];
+
+		RDLOCK_SHARD(shard);
+
+		stats->hits += shard->hits;
+		stats->misses += shard->misses;
+
+		/* report low memory mode if any of shards is running out of memory */
+		if (ZBX_VC_MODE_LOWMEM == shard->mode)
+			stats->mode = ZBX_VC_MODE_LOWMEM;
+
+		stats->total_size += vc_mem[i]->total_size;
+		stats->free_size += vc_mem[i]->free_size;
+
+		UNLOCK_SHARD(shard);
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: enables value caching for current process                         *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_vc_enable(void)
+{
+	if (NULL != vc_cache)
+		vc_state = ZBX_VC_ENABLED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: disables value caching for current process                        *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_vc_disable(void)
+{
+	vc_state = ZBX_VC_DISABLED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get value cache diagnostic statistics                             *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_vc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num, int *mode)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_vc_item_t		*item;
 
 	*values_num = 0;
+	*items_num = 0;
 
 	if (ZBX_VC_DISABLED == vc_state)
 	{
-		*items_num = 0;
 		*mode = -1;
 		return;
 	}
 
-	RDLOCK_CACHE;
+	*mode = ZBX_VC_MODE_NORMAL;
+
+	for (int i = 0; i < vc_cache->shards_num; i++)
+	{
+		zbx_vc_shard_t	*shard = vc_cache->shards[i];
 
-	*items_num = (zbx_uint64_t)vc_cache->items.num_data;
-	*mode = vc_cache->mode;
+		RDLOCK_SHARD(shard);
 
-	zbx_hashset_iter_reset(&vc_cache->items, &iter);
-	while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
-		*values_num += (zbx_uint64_t)item->values_total;
+		*items_num += (zbx_uint64_t)shard->items.num_data;
+
+		if (ZBX_VC_MODE_LOWMEM == shard->mode)
+			*mode = ZBX_VC_MODE_LOWMEM;
 
-	UNLOCK_CACHE;
+		zbx_hashset_iter_reset(&shard->items, &iter);
+		while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
+			*values_num += (zbx_uint64_t)item->values_total;
+
+		UNLOCK_SHARD(shard);
+	}
 }
 
 /******************************************************************************
@@ -2797,15 +3622,23 @@ void	zbx_vc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num, in
  ******************************************************************************/
 void	zbx_vc_get_mem_stats(zbx_shmem_stats_t *mem)
 {
+	zbx_shmem_stats_t	stats;
+
+	memset(mem, 0, sizeof(zbx_shmem_stats_t));
+
 	if (ZBX_VC_DISABLED == vc_state)
-	{
-		memset(mem, 0, sizeof(zbx_shmem_stats_t));
 		return;
-	}
 
-	RDLOCK_CACHE;
-	zbx_shmem_get_stats(vc_mem, mem);
-	UNLOCK_CACHE;
+	for (int i = 0; i < vc_cache->shards_num; i++)
+	{
+		zbx_vc_shard_t	*shard = vc_cache->shards[i];
+
+		RDLOCK_SHARD(shard);
+		zbx_shmem_get_stats(vc_mem[i], &stats);
+		UNLOCK_SHARD(shard);
+
+		zbx_shmem_add_stats(mem, &stats);
+	}
 }
 
 /******************************************************************************
@@ -2822,21 +3655,26 @@ void	zbx_vc_get_item_stats(zbx_vector_ptr_t *stats)
 	if (ZBX_VC_DISABLED == vc_state)
 		return;
 
-	RDLOCK_CACHE;
+	for (int i = 0; i < vc_cache->shards_num; i++)
+	{
+		zbx_vc_shard_t	*shard = vc_cache->shards[i];
 
-	zbx_vector_ptr_reserve(stats, (size_t)vc_cache->items.num_data);
+		RDLOCK_SHARD(shard);
 
-	zbx_hashset_iter_reset(&vc_cache->items, &iter);
-	while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
-	{
-		item_stats = (zbx_vc_item_stats_t *)zbx_malloc(NULL, sizeof(zbx_vc_item_stats_t));
-		item_stats->itemid = item->itemid;
-		item_stats->values_num = item->values_total;
-		item_stats->hourly_num = item->last_hourly_num;
-		zbx_vector_ptr_append(stats, item_stats);
-	}
+		zbx_vector_ptr_reserve(stats, (size_t)(stats->values_num + shard->items.num_data));
 
-	UNLOCK_CACHE;
+		zbx_hashset_iter_reset(&shard->items, &iter);
+		while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
+		{
+			item_stats = (zbx_vc_item_stats_t *)zbx_malloc(NULL, sizeof(zbx_vc_item_stats_t));
+			item_stats->itemid = item->itemid;
+			item_stats->values_num = item->values_total;
+			item_stats->hourly_num = item->last_hourly_num;
+			zbx_vector_ptr_append(stats, item_stats);
+		}
+
+		UNLOCK_SHARD(shard);
+	}
 }
 
 /******************************************************************************
@@ -2846,9 +3684,7 @@ void	zbx_vc_get_item_stats(zbx_vector_ptr_t *stats)
  ******************************************************************************/
 void	zbx_vc_flush_stats(void)
 {
-	int		i, now;
-	zbx_vc_item_t	*item = NULL;
-	zbx_uint64_t	itemid = 0;
+	int	i, now;
 
 	if (ZBX_VC_DISABLED == vc_state || 0 == vc_itemupdates.values_num)
 		return;
@@ -2857,75 +3693,766 @@ void	zbx_vc_flush_stats(void)
 
 	now = (int)time(NULL);
 
-	WRLOCK_CACHE;
+	for (int j = 0; j < vc_cache->shards_num; j++)
+	{
+		zbx_vc_shard_t	*shard = vc_cache->shards[j];
+		zbx_vc_item_t	*item = NULL;
+		zbx_uint64_t	itemid = 0;
+
+		WRLOCK_SHARD(shard);
+
+		for (i = 0; i < vc_itemupdates.values_num; i++)
+		{
+			zbx_vc_item_update_t	*update = &vc_itemupdates.values[i];
+
+			if (itemid != update->itemid)
+			{
+				itemid = update->itemid;
+
+				if (shard == vc_get_shard(itemid))
+					item = (zbx_vc_item_t *)zbx_hashset_search(&shard->items, &itemid);
+				else
+					item = NULL;
+			}
+
+			if (NULL == item)
+				continue;
+
+			switch (update->type)
+			{
+				case ZBX_VC_UPDATE_RANGE:
+					vch_item_update_range(item, update->data[ZBX_VC_UPDATE_RANGE_SECONDS],
+							update->data[ZBX_VC_UPDATE_RANGE_NOW]);
+					break;
+				case ZBX_VC_UPDATE_STATS:
+					vc_update_statistics(shard, item, update->data[ZBX_VC_UPDATE_STATS_HITS],
+							update->data[ZBX_VC_UPDATE_STATS_MISSES], now);
+					break;
+			}
+		}
 
-	for (i = 0; i < vc_itemupdates.values_num; i++)
+		UNLOCK_SHARD(shard);
+	}
+
+	zbx_vector_vc_itemupdate_clear(&vc_itemupdates);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: add newly created items with triggers to value cachel              *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_vc_add_new_items(const zbx_vector_uint64_pair_t *items)
+{
+	if (ZBX_VC_DISABLED == vc_state)
+		return;
+
+	for (int i = 0; i < vc_cache->shards_num; i++)
 	{
-		zbx_vc_item_update_t	*update = &vc_itemupdates.values[i];
+		zbx_vc_shard_t	*shard = vc_cache->shards[i];
+
+		WRLOCK_SHARD(shard);
 
-		if (itemid != update->itemid)
+		if (ZBX_VC_MODE_NORMAL == shard->mode)
 		{
-			itemid = update->itemid;
-			item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid);
+			for (int j = 0; j < items->values_num; j++)
+			{
+				if (shard != vc_get_shard(items->values[j].first))
+					continue;
+
+				if (NULL != zbx_hashset_search(&shard->items, &items->values[j]))
+					continue;
+
+				zbx_vc_item_t	item_local = {
+						.itemid = items->values[j].first,
+						.value_type = (unsigned char)items->values[j].second,
+						.status = ZBX_ITEM_STATUS_CACHED_ALL,
+						.last_accessed = (int)time(NULL)
+
+				};
+
+				if (NULL == zbx_hashset_insert(&shard->items, &item_local, sizeof(item_local)))
+				{
+					/* out of memory - shard switches to low memory mode on next caching request */
+					break;
+				}
+			}
 		}
 
-		if (NULL == item)
-			continue;
+		UNLOCK_SHARD(shard);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Value cache snapshot                                                       *
+ *                                                                            *
+ * The snapshot file consists of header followed by serialized item records.  *
+ * Each item record starts with the record size, followed by item properties  *
+ * and item values in ascending order:                                        *
+ *                                                                            *
+ *   <size><itemid><value_type><status><range_sync_hour><values_num>          *
+ *   <active_range><daily_range><db_cached_from><last_accessed>               *
+ *   <last_hourly_num><hourly_num><hour><hits>                                *
+ *   (<sec><ns><value>)*                                                      *
+ *                                                                            *
+ * Strings are stored with terminating zero, so they can be referenced        *
+ * directly from the memory mapped file when loading snapshot.                *
+ *                                                                            *
+ * The header records the HA node name of the server that created the         *
+ * snapshot, so the snapshot is not loaded by other cluster nodes.            *
+ *                                                                            *
+ ******************************************************************************/
+
+#define ZBX_VC_SNAPSHOT_MAGIC		"ZBXVCSNP"
+#define ZBX_VC_SNAPSHOT_FORMAT		2
+#define ZBX_VC_SNAPSHOT_VERSION		ZABBIX_VERSION " (revision " ZABBIX_REVISION ")"
+
+/* the maximum snapshot age to consider the cached data up to date */
+#define ZBX_VC_SNAPSHOT_MAX_AGE		SEC_PER_HOUR
+
+typedef struct
+{
+	char		magic[8];
+	zbx_uint32_t	format;
+	zbx_uint32_t	items_num;
+	char		version[64];
+	char		node_name[256];
+	zbx_uint64_t	values_num;
+	zbx_uint64_t	data_size;
+	int		timestamp;
+	zbx_hash_t	checksum;
+}
+zbx_vc_snapshot_header_t;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: serializes value cache item with its values                       *
+ *                                                                            *
+ * Parameters: item       - [IN] the item to serialize                        *
+ *             data       - [IN/OUT] the serialization buffer                 *
+ *             data_alloc - [IN/OUT] the serialization buffer size            *
+ *                                                                            *
+ * Return value: the size of serialized data                                  *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint32_t	vc_snapshot_serialize_item(const zbx_vc_item_t *item, unsigned char **data,
+		zbx_uint32_t *data_alloc)
+{
+	zbx_uint32_t		data_len = 0, len;
+	unsigned char		*ptr;
+	const zbx_vc_chunk_t	*chunk;
+	int			i;
+
+	zbx_serialize_prepare_value(data_len, data_len);
+	zbx_serialize_prepare_value(data_len, item->itemid);
+	zbx_serialize_prepare_value(data_len, item->value_type);
+	zbx_serialize_prepare_value(data_len, item->status);
+	zbx_serialize_prepare_value(data_len, item->range_sync_hour);
+	zbx_serialize_prepare_value(data_len, item->values_total);
+	zbx_serialize_prepare_value(data_len, item->active_range);
+	zbx_serialize_prepare_value(data_len, item->daily_range);
+	zbx_serialize_prepare_value(data_len, item->db_cached_from);
+	zbx_serialize_prepare_value(data_len, item->last_accessed);
+	zbx_serialize_prepare_value(data_len, item->last_hourly_num);
+	zbx_serialize_prepare_value(data_len, item->hourly_num);
+	zbx_serialize_prepare_value(data_len, item->hour);
+	zbx_serialize_prepare_value(data_len, item->hits);
+
+	for (chunk = item->tail; NULL != chunk; chunk = chunk->next)
+	{
+		for (i = chunk->first_value; i <= chunk->last_value; i++)
+		{
+			const zbx_timespec_t		*ts = &chunk->timestamps[i];
+			const zbx_history_value_t	*value = &chunk->values[i];
+
+			zbx_serialize_prepare_value(data_len, ts->sec);
+			zbx_serialize_prepare_value(data_len, ts->ns);
+
+			switch (item->value_type)
+			{
+				case ITEM_VALUE_TYPE_FLOAT:
+					zbx_serialize_prepare_value(data_len, value->dbl);
+					break;
+				case ITEM_VALUE_TYPE_UINT64:
+					zbx_serialize_prepare_value(data_len, value->ui64);
+					break;
+				case ITEM_VALUE_TYPE_STR:
+				case ITEM_VALUE_TYPE_TEXT:
+					zbx_serialize_prepare_str_len(data_len, value->str, len);
+					break;
+				case ITEM_VALUE_TYPE_LOG:
+					zbx_serialize_prepare_value(data_len, value->log->timestamp);
+					zbx_serialize_prepare_value(data_len, value->log->logeventid);
+					zbx_serialize_prepare_value(data_len, value->log->severity);
+					zbx_serialize_prepare_str_len(data_len, value->log->source, len);
+					zbx_serialize_prepare_str_len(data_len, value->log->value, len);
+					break;
+			}
+		}
+	}
+
+	if (*data_alloc < data_len)
+	{
+		while (*data_alloc < data_len)
+			*data_alloc *= 2;
+
+		*data = (unsigned char *)zbx_realloc(*data, *data_alloc);
+	}
+
+	ptr = *data;
+	ptr += zbx_serialize_value(ptr, data_len);
+	ptr += zbx_serialize_value(ptr, item->itemid);
+	ptr += zbx_serialize_value(ptr, item->value_type);
+	ptr += zbx_serialize_value(ptr, item->status);
+	ptr += zbx_serialize_value(ptr, item->range_sync_hour);
+	ptr += zbx_serialize_value(ptr, item->values_total);
+	ptr += zbx_serialize_value(ptr, item->active_range);
+	ptr += zbx_serialize_value(ptr, item->daily_range);
+	ptr += zbx_serialize_value(ptr, item->db_cached_from);
+	ptr += zbx_serialize_value(ptr, item->last_accessed);
+	ptr += zbx_serialize_value(ptr, item->last_hourly_num);
+	ptr += zbx_serialize_value(ptr, item->hourly_num);
+	ptr += zbx_serialize_value(ptr, item->hour);
+	ptr += zbx_serialize_value(ptr, item->hits);
+
+	for (chunk = item->tail; NULL != chunk; chunk = chunk->next)
+	{
+		for (i = chunk->first_value; i <= chunk->last_value; i++)
+		{
+			const zbx_timespec_t		*ts = &chunk->timestamps[i];
+			const zbx_history_value_t	*value = &chunk->values[i];
+
+			ptr += zbx_serialize_value(ptr, ts->sec);
+			ptr += zbx_serialize_value(ptr, ts->ns);
+
+			switch (item->value_type)
+			{
+				case ITEM_VALUE_TYPE_FLOAT:
+					ptr += zbx_serialize_value(ptr, value->dbl);
+					break;
+				case ITEM_VALUE_TYPE_UINT64:
+					ptr += zbx_serialize_value(ptr, value->ui64);
+					break;
+				case ITEM_VALUE_TYPE_STR:
+				case ITEM_VALUE_TYPE_TEXT:
+					len = (zbx_uint32_t)strlen(value->str) + 1;
+					ptr += zbx_serialize_str(ptr, value->str, len);
+					break;
+				case ITEM_VALUE_TYPE_LOG:
+					ptr += zbx_serialize_value(ptr, value->log->timestamp);
+					ptr += zbx_serialize_value(ptr, value->log->logeventid);
+					ptr += zbx_serialize_value(ptr, value->log->severity);
+					len = (NULL != value->log->source ?
+							(zbx_uint32_t)strlen(value->log->source) + 1 : 0);
+					ptr += zbx_serialize_str(ptr, value->log->source, len);
+					len = (zbx_uint32_t)strlen(value->log->value) + 1;
+					ptr += zbx_serialize_str(ptr, value->log->value, len);
+					break;
+			}
+		}
+	}
 
-		switch (update->type)
+	return data_len;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: dumps value cache contents into snapshot file                     *
+ *                                                                            *
+ * Parameters: filename  - [IN] the snapshot file name                        *
+ *             node_name - [IN] the HA node name, can be NULL                 *
+ *             error     - [OUT] the error message                            *
+ *                                                                            *
+ * Return value: SUCCEED - the snapshot was written successfully              *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The snapshot must be dumped after history cache is flushed,      *
+ *           so the cached data matches the data stored in database.          *
+ *           The snapshot is written into temporary file, which is renamed    *
+ *           to the target file name once all data are written.               *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_dump(const char *filename, const char *node_name, char **error)
+{
+	zbx_vc_snapshot_header_t	header;
+	zbx_hashset_iter_t		iter;
+	zbx_vc_item_t			*item = NULL;
+	FILE				*file;
+	char				*filename_tmp;
+	unsigned char			*data;
+	zbx_uint32_t			data_alloc = ZBX_KIBIBYTE * 64, data_len;
+	int				ret = FAIL;
+
+	if (NULL == vc_cache)
+		return SUCCEED;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() filename:'%s'", __func__, filename);
+
+	filename_tmp = zbx_dsprintf(NULL, "%s.tmp", filename);
+
+	if (NULL == (file = fopen(filename_tmp, "wb")))
+	{
+		*error = zbx_dsprintf(*error, "cannot open file \"%s\": %s", filename_tmp, zbx_strerror(errno));
+		goto out;
+	}
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, ZBX_VC_SNAPSHOT_MAGIC, sizeof(header.magic));
+	header.format = ZBX_VC_SNAPSHOT_FORMAT;
+	zbx_strlcpy(header.version, ZBX_VC_SNAPSHOT_VERSION, sizeof(header.version));
+
+	if (NULL != node_name)
+		zbx_strlcpy(header.node_name, node_name, sizeof(header.node_name));
+
+	/* reserve space for header, it will be written after all items are dumped */
+	if (1 != fwrite(&header, sizeof(header), 1, file))
+		goto write_error;
+
+	data = (unsigned char *)zbx_malloc(NULL, data_alloc);
+
+	for (int i = 0; i < vc_cache->shards_num && NULL == item; i++)
+	{
+		zbx_vc_shard_t	*shard = vc_cache->shards[i];
+
+		RDLOCK_SHARD(shard);
+
+		zbx_hashset_iter_reset(&shard->items, &iter);
+		while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
 		{
-			case ZBX_VC_UPDATE_RANGE:
-				vch_item_update_range(item, update->data[ZBX_VC_UPDATE_RANGE_SECONDS],
-						update->data[ZBX_VC_UPDATE_RANGE_NOW]);
+			data_len = vc_snapshot_serialize_item(item, &data, &data_alloc);
+
+			if (1 != fwrite(data, data_len, 1, file))
 				break;
-			case ZBX_VC_UPDATE_STATS:
-				vc_update_statistics(item, update->data[ZBX_VC_UPDATE_STATS_HITS],
-						update->data[ZBX_VC_UPDATE_STATS_MISSES], now);
+
+			header.checksum = ZBX_DEFAULT_HASH_ALGO(data, data_len, header.checksum);
+			header.data_size += data_len;
+			header.values_num += (zbx_uint64_t)item->values_total;
+			header.items_num++;
+		}
+
+		UNLOCK_SHARD(shard);
+	}
+
+	zbx_free(data);
+
+	if (NULL != item)
+		goto write_error;
+
+	header.timestamp = (int)time(NULL);
+
+	if (0 != fseek(file, 0, SEEK_SET) || 1 != fwrite(&header, sizeof(header), 1, file))
+		goto write_error;
+
+	if (0 != fclose(file))
+	{
+		file = NULL;
+		goto write_error;
+	}
+
+	file = NULL;
+
+	if (0 != rename(filename_tmp, filename))
+	{
+		*error = zbx_dsprintf(*error, "cannot rename file \"%s\" to \"%s\": %s", filename_tmp, filename,
+				zbx_strerror(errno));
+		goto out;
+	}
+
+	zabbix_log(LOG_LEVEL_INFORMATION, "value cache snapshot saved: %u items, " ZBX_FS_UI64 " values",
+			header.items_num, header.values_num);
+
+	ret = SUCCEED;
+	goto out;
+write_error:
+	*error = zbx_dsprintf(*error, "cannot write file \"%s\": %s", filename_tmp, zbx_strerror(errno));
+out:
+	if (NULL != file)
+		fclose(file);
+
+	if (SUCCEED != ret)
+		unlink(filename_tmp);
+
+	zbx_free(filename_tmp);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads fixed size value from snapshot data                         *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_snapshot_read_value(const unsigned char **ptr, const unsigned char *end, void *value, size_t size)
+{
+	if ((size_t)(end - *ptr) < size)
+		return FAIL;
+
+	memcpy(value, *ptr, size);
+	*ptr += size;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: references string in snapshot data without copying it             *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_snapshot_read_str(const unsigned char **ptr, const unsigned char *end, char **str)
+{
+	zbx_uint32_t	len;
+
+	if (SUCCEED != vc_snapshot_read_value(ptr, end, &len, sizeof(len)))
+		return FAIL;
+
+	if (0 == len)
+	{
+		*str = NULL;
+		return SUCCEED;
+	}
+
+	if ((size_t)(end - *ptr) < len || '\0' != (*ptr)[len - 1])
+		return FAIL;
+
+	*str = (char *)*ptr;
+	*ptr += len;
+
+	return SUCCEED;
+}
+
+#define VC_SNAPSHOT_READ(ptr, end, value)							\
+	if (SUCCEED != vc_snapshot_read_value(&ptr, end, &(value), sizeof(value)))		\
+		return FAIL
+
+#define VC_SNAPSHOT_READ_STR(ptr, end, value)							\
+	if (SUCCEED != vc_snapshot_read_str(&ptr, end, &(value)))				\
+		return FAIL
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: deserializes value cache item record from snapshot                *
+ *                                                                            *
+ * Parameters: data       - [IN] the item record                              *
+ *             data_len   - [IN] the item record size                         *
+ *             item       - [OUT] the item properties                         *
+ *             values     - [OUT] the item values, string values reference    *
+ *                                snapshot data                               *
+ *             logs       - [IN/OUT] the log value buffer                     *
+ *             logs_alloc - [IN/OUT] the log value buffer size                *
+ *                                                                            *
+ * Return value: SUCCEED - the item record was deserialized successfully      *
+ *               FAIL    - the item record is malformed                       *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_snapshot_deserialize_item(const unsigned char *data, zbx_uint32_t data_len, zbx_vc_item_t *item,
+		zbx_vector_history_record_t *values, zbx_log_value_t **logs, int *logs_alloc)
+{
+	const unsigned char	*ptr = data + sizeof(zbx_uint32_t), *end = data + data_len;
+	int			i, values_num;
+	zbx_history_record_t	record;
+
+	memset(item, 0, sizeof(zbx_vc_item_t));
+
+	VC_SNAPSHOT_READ(ptr, end, item->itemid);
+	VC_SNAPSHOT_READ(ptr, end, item->value_type);
+	VC_SNAPSHOT_READ(ptr, end, item->status);
+	VC_SNAPSHOT_READ(ptr, end, item->range_sync_hour);
+	VC_SNAPSHOT_READ(ptr, end, values_num);
+	VC_SNAPSHOT_READ(ptr, end, item->active_range);
+	VC_SNAPSHOT_READ(ptr, end, item->daily_range);
+	VC_SNAPSHOT_READ(ptr, end, item->db_cached_from);
+	VC_SNAPSHOT_READ(ptr, end, item->last_accessed);
+	VC_SNAPSHOT_READ(ptr, end, item->last_hourly_num);
+	VC_SNAPSHOT_READ(ptr, end, item->hourly_num);
+	VC_SNAPSHOT_READ(ptr, end, item->hour);
+	VC_SNAPSHOT_READ(ptr, end, item->hits);
+
+	if (0 > values_num || (zbx_uint32_t)values_num > data_len)
+		return FAIL;
+
+	if (ITEM_VALUE_TYPE_LOG == item->value_type && *logs_alloc < values_num)
+	{
+		*logs_alloc = values_num;
+		*logs = (zbx_log_value_t *)zbx_realloc(*logs, sizeof(zbx_log_value_t) * (size_t)values_num);
+	}
+
+	zbx_vector_history_record_clear(values);
+	zbx_vector_history_record_reserve(values, (size_t)values_num);
+
+	for (i = 0; i < values_num; i++)
+	{
+		VC_SNAPSHOT_READ(ptr, end, record.timestamp.sec);
+		VC_SNAPSHOT_READ(ptr, end, record.timestamp.ns);
+
+		switch (item->value_type)
+		{
+			case ITEM_VALUE_TYPE_FLOAT:
+				VC_SNAPSHOT_READ(ptr, end, record.value.dbl);
+				break;
+			case ITEM_VALUE_TYPE_UINT64:
+				VC_SNAPSHOT_READ(ptr, end, record.value.ui64);
+				break;
+			case ITEM_VALUE_TYPE_STR:
+			case ITEM_VALUE_TYPE_TEXT:
+				VC_SNAPSHOT_READ_STR(ptr, end, record.value.str);
+
+				if (NULL == record.value.str)
+					return FAIL;
+				break;
+			case ITEM_VALUE_TYPE_LOG:
+				record.value.log = &(*logs)[i];
+				VC_SNAPSHOT_READ(ptr, end, record.value.log->timestamp);
+				VC_SNAPSHOT_READ(ptr, end, record.value.log->logeventid);
+				VC_SNAPSHOT_READ(ptr, end, record.value.log->severity);
+				VC_SNAPSHOT_READ_STR(ptr, end, record.value.log->source);
+				VC_SNAPSHOT_READ_STR(ptr, end, record.value.log->value);
+
+				if (NULL == record.value.log->value)
+					return FAIL;
 				break;
+			default:
+				return FAIL;
 		}
+
+		zbx_vector_history_record_append_ptr(values, &record);
 	}
 
-	UNLOCK_CACHE;
+	return ptr == end ? SUCCEED : FAIL;
+}
 
-	zbx_vector_vc_itemupdate_clear(&vc_itemupdates);
+#undef VC_SNAPSHOT_READ
+#undef VC_SNAPSHOT_READ_STR
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: validates snapshot data                                           *
+ *                                                                            *
+ * Parameters: header    - [IN] the snapshot header                           *
+ *             data      - [IN] the snapshot data                             *
+ *             node_name - [IN] the HA node name, can be NULL                 *
+ *             time_min  - [IN] the minimum snapshot creation time            *
+ *             error     - [OUT] the error message                            *
+ *                                                                            *
+ * Return value: SUCCEED - the snapshot is valid                              *
+ *               FAIL    - the snapshot is stale or corrupted                 *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_snapshot_validate(const zbx_vc_snapshot_header_t *header, const unsigned char *data,
+		const char *node_name, int time_min, char **error)
+{
+	const unsigned char	*ptr = data, *end = data + header->data_size;
+	zbx_uint32_t		data_len, items_num = 0;
+	zbx_hash_t		checksum = 0;
+	int			now;
+
+	if (0 != memcmp(header->magic, ZBX_VC_SNAPSHOT_MAGIC, sizeof(header->magic)) ||
+			ZBX_VC_SNAPSHOT_FORMAT != header->format)
+	{
+		*error = zbx_strdup(*error, "unknown file format");
+		return FAIL;
+	}
+
+	if (0 != strncmp(header->version, ZBX_VC_SNAPSHOT_VERSION, sizeof(header->version)))
+	{
+		*error = zbx_dsprintf(*error, "snapshot was created by different server version %.*s",
+				(int)sizeof(header->version), header->version);
+		return FAIL;
+	}
+
+	if (0 != strncmp(header->node_name, ZBX_NULL2EMPTY_STR(node_name), sizeof(header->node_name)))
+	{
+		*error = zbx_dsprintf(*error, "snapshot was created by different HA node \"%.*s\"",
+				(int)sizeof(header->node_name), header->node_name);
+		return FAIL;
+	}
+
+	now = (int)time(NULL);
+
+	if (header->timestamp > now || now - header->timestamp > ZBX_VC_SNAPSHOT_MAX_AGE ||
+			header->timestamp < time_min)
+	{
+		*error = zbx_dsprintf(*error, "snapshot is stale, created at %s %s",
+				zbx_date2str(header->timestamp, NULL), zbx_time2str(header->timestamp, NULL));
+		return FAIL;
+	}
+
+	while (ptr < end)
+	{
+		if ((size_t)(end - ptr) < sizeof(data_len))
+			break;
+
+		memcpy(&data_len, ptr, sizeof(data_len));
+
+		if ((size_t)(end - ptr) < data_len || sizeof(data_len) > data_len)
+			break;
+
+		checksum = ZBX_DEFAULT_HASH_ALGO(ptr, data_len, checksum);
+		ptr += data_len;
+		items_num++;
+	}
+
+	if (ptr != end || items_num != header->items_num || checksum != header->checksum)
+	{
+		*error = zbx_strdup(*error, "snapshot data is corrupted");
+		return FAIL;
+	}
+
+	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: add newly created items with triggers to value cachel              *
+ * Purpose: loads value cache contents from snapshot file                     *
+ *                                                                            *
+ * Parameters: filename  - [IN] the snapshot file name                        *
+ *             node_name - [IN] the HA node name, can be NULL                 *
+ *             time_min  - [IN] the minimum snapshot creation time, older     *
+ *                              snapshots are rejected as stale               *
+ *             error     - [OUT] the error message                            *
+ *                                                                            *
+ * Return value: SUCCEED - the snapshot was loaded or did not exist           *
+ *               FAIL    - the snapshot could not be loaded                   *
+ *                                                                            *
+ * Comments: The snapshot file is removed after reading, so it is never       *
+ *           loaded twice - after unclean shutdown the cache starts empty.    *
+ *           Items already in cache are not overwritten. Items are skipped    *
+ *           when their cache shard free space drops to the minimum free      *
+ *           request size, so the loaded data does not switch cache to low    *
+ *           memory mode.                                                     *
+ *           In HA cluster time_min must be set to the last activity time     *
+ *           of other nodes, because they could have written history since    *
+ *           the snapshot was created.                                        *
  *                                                                            *
  ******************************************************************************/
-void	zbx_vc_add_new_items(const zbx_vector_uint64_pair_t *items)
+int	zbx_vc_load(const char *filename, const char *node_name, int time_min, char **error)
 {
-	if (ZBX_VC_DISABLED == vc_state)
-		return;
+	int				fd, ret = FAIL, logs_alloc = 0;
+	zbx_stat_t			st;
+	void				*map;
+	const unsigned char		*ptr, *end;
+	zbx_vc_snapshot_header_t	header;
+	zbx_vector_history_record_t	values;
+	zbx_log_value_t			*logs = NULL;
+	zbx_uint32_t			items_num = 0, data_len;
+	zbx_uint64_t			values_num = 0;
+
+	if (NULL == vc_cache)
+		return SUCCEED;
 
-	WRLOCK_CACHE;
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() filename:'%s' time_min:%d", __func__, filename, time_min);
 
-	if (ZBX_VC_MODE_NORMAL == vc_cache->mode)
+	if (-1 == (fd = open(filename, O_RDONLY)))
 	{
-		int	i;
+		if (ENOENT == errno)
+		{
+			ret = SUCCEED;
+			goto out;
+		}
 
-		for (i = 0; i < items->values_num; i++)
+		*error = zbx_dsprintf(*error, "cannot open file \"%s\": %s", filename, zbx_strerror(errno));
+		goto out;
+	}
+
+	if (0 != zbx_fstat(fd, &st))
+	{
+		*error = zbx_dsprintf(*error, "cannot obtain information about file \"%s\": %s", filename,
+				zbx_strerror(errno));
+		close(fd);
+		goto remove;
+	}
+
+	if ((zbx_uint64_t)st.st_size < sizeof(header))
+	{
+		*error = zbx_strdup(*error, "file is too small");
+		close(fd);
+		goto remove;
+	}
+
+	map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (MAP_FAILED == map)
+	{
+		*error = zbx_dsprintf(*error, "cannot map file \"%s\": %s", filename, zbx_strerror(errno));
+		goto remove;
+	}
+
+	memcpy(&header, map, sizeof(header));
+
+	if (header.data_size != (zbx_uint64_t)st.st_size - sizeof(header))
+	{
+		*error = zbx_strdup(*error, "snapshot data size does not match file size");
+		goto unmap;
+	}
+
+	ptr = (const unsigned char *)map + sizeof(header);
+	end = ptr + header.data_size;
+
+	if (SUCCEED != vc_snapshot_validate(&header, ptr, node_name, time_min, error))
+		goto unmap;
+
+	zbx_vector_history_record_create(&values);
+
+	/* record size is copied into local variable as records are not aligned in snapshot file */
+	for (; ptr < end; ptr += data_len)
+	{
+		zbx_vc_item_t	item_local, *item;
+		zbx_vc_shard_t	*shard;
+
+		memcpy(&data_len, ptr, sizeof(data_len));
+
+		if (SUCCEED != vc_snapshot_deserialize_item(ptr, data_len, &item_local, &values, &logs,
+				&logs_alloc))
 		{
-			if (NULL != zbx_hashset_search(&vc_cache->items, &items->values[i]))
-				continue;
+			zabbix_log(LOG_LEVEL_WARNING, "cannot load value cache snapshot item: malformed data");
+			break;
+		}
+
+		shard = vc_get_shard(item_local.itemid);
 
-			zbx_vc_item_t	item_local = {
-					.itemid = items->values[i].first,
-					.value_type = (unsigned char)items->values[i].second,
-					.status = ZBX_ITEM_STATUS_CACHED_ALL,
-					.last_accessed = (int)time(NULL)
+		WRLOCK_SHARD(shard);
 
-			};
+		/* other shards might still have free space, so skip only items of the full shard */
+		if (vc_mem[shard->index]->free_size < shard->min_free_request ||
+				NULL != zbx_hashset_search(&shard->items, &item_local.itemid))
+		{
+			UNLOCK_SHARD(shard);
+			continue;
+		}
 
-			if (NULL == zbx_hashset_insert(&vc_cache->items, &item_local, sizeof(item_local)))
+		if (NULL != (item = (zbx_vc_item_t *)zbx_hashset_insert(&shard->items, &item_local,
+				sizeof(item_local))))
+		{
+			if (0 == values.values_num || SUCCEED == vch_item_add_values_at_tail(item, values.values,
+					values.values_num))
 			{
-				/* out of memory - cache will switch to low memory mode on next caching request */
-				break;
+				values_num += (zbx_uint64_t)values.values_num;
+				items_num++;
 			}
+			else
+				vc_remove_item(item);
 		}
+
+		UNLOCK_SHARD(shard);
 	}
 
-	UNLOCK_CACHE;
+	zbx_vector_history_record_destroy(&values);
+	zbx_free(logs);
+
+	zabbix_log(LOG_LEVEL_INFORMATION, "value cache snapshot loaded: %u of %u items, " ZBX_FS_UI64 " values",
+			items_num, header.items_num, values_num);
+
+	ret = SUCCEED;
+unmap:
+	munmap(map, (size_t)st.st_size);
+remove:
+	if (0 != unlink(filename))
+		zabbix_log(LOG_LEVEL_WARNING, "cannot remove file \"%s\": %s", filename, zbx_strerror(errno));
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+
+	return ret;
 }
@@ -127,6 +127,8 @@ const char	*get_process_type_string(unsigned char proc_type)
 			return "internal poller";
 		case ZBX_PROCESS_TYPE_DBCONFIGWORKER:
 			return "configuration syncer worker";
+		case ZBX_PROCESS_TYPE_EXPORTWRITER:
+			return "export writer";
 	}
 
 	THIS_SHOULD_NEVER_HAPPEN;
@@ -48,6 +48,9 @@
 /* the maximum number of values processed in one batch */
 #define ZBX_HISTORY_VALUES_MAX		256
 
+/* the cap of value data size parsed in one batch, large values close the batch earlier */
+#define ZBX_HISTORY_VALUES_SIZE_MAX	(ZBX_MEBIBYTE * 4)
+
 typedef struct
 {
 	zbx_uint64_t		druleid;
@@ -963,6 +966,24 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns size of the dynamically allocated agent value data        *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	agent_value_size(const zbx_agent_value_t *av)
+{
+	size_t	size = 0;
+
+	if (NULL != av->value)
+		size += strlen(av->value) + 1;
+
+	if (NULL != av->source)
+		size += strlen(av->source) + 1;
+
+	return size;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: parses item identifier from history data json row                 *
@@ -1023,6 +1044,7 @@ static int	parse_history_data_row_hostkey(const struct zbx_json_parse *jp_row, z
  *                                                                            *
  * Purpose: parses up to ZBX_HISTORY_VALUES_MAX item values and host,key      *
  *          pairs from history data json                                      *
+ *          (or less if ZBX_HISTORY_VALUES_SIZE_MAX value data is reached)    *
  *                                                                            *
  * Parameters: jp_data      - [IN] JSON with history data array               *
  *             pnext        - [IN/OUT] the pointer to the next item in json,  *
@@ -1044,6 +1066,7 @@ static int	parse_history_data(struct zbx_json_parse *jp_data, const char **pnext
 {
 	struct zbx_json_parse	jp_row;
 	int			ret = FAIL;
+	size_t			values_size = 0;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -1076,14 +1099,15 @@ static int	parse_history_data(struct zbx_json_parse *jp_data, const char **pnext
 		if (SUCCEED != parse_history_data_row_value(&jp_row, unique_shift, &values[*values_num]))
 			continue;
 
-		(*values_num)++;
+		values_size += agent_value_size(&values[(*values_num)++]);
 	}
-	while (NULL != (*pnext = zbx_json_next(jp_data, *pnext)) && *values_num < ZBX_HISTORY_VALUES_MAX);
+	while (NULL != (*pnext = zbx_json_next(jp_data, *pnext)) && *values_num < ZBX_HISTORY_VALUES_MAX &&
+			values_size < ZBX_HISTORY_VALUES_SIZE_MAX);
 
 	ret = SUCCEED;
 out:
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s processed:%d/%d", __func__, zbx_result_string(ret),
-			*values_num, *parsed_num);
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s processed:%d/%d size:" ZBX_FS_SIZE_T, __func__,
+			zbx_result_string(ret), *values_num, *parsed_num, (zbx_fs_size_t)values_size);
 
 	return ret;
 }
@@ -1092,6 +1116,7 @@ out:
  *                                                                            *
  * Purpose: parses up to ZBX_HISTORY_VALUES_MAX item values and item          *
  *          identifiers from history data json                                *
+ *          (or less if ZBX_HISTORY_VALUES_SIZE_MAX value data is reached)    *
  *                                                                            *
  * Parameters: jp_data      - [IN] JSON with history data array               *
  *             pnext        - [IN/OUT] the pointer to the next item in        *
@@ -1119,6 +1144,7 @@ static int	parse_history_data_by_itemids(struct zbx_json_parse *jp_data, const c
 {
 	struct zbx_json_parse	jp_row;
 	int			ret = FAIL;
+	size_t			values_size = 0;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -1151,14 +1177,15 @@ static int	parse_history_data_by_itemids(struct zbx_json_parse *jp_data, const c
 		if (SUCCEED != parse_history_data_row_value(&jp_row, unique_shift, &values[*values_num]))
 			continue;
 
-		(*values_num)++;
+		values_size += agent_value_size(&values[(*values_num)++]);
 	}
-	while (NULL != (*pnext = zbx_json_next(jp_data, *pnext)) && *values_num < ZBX_HISTORY_VALUES_MAX);
+	while (NULL != (*pnext = zbx_json_next(jp_data, *pnext)) && *values_num < ZBX_HISTORY_VALUES_MAX &&
+			values_size < ZBX_HISTORY_VALUES_SIZE_MAX);
 
 	ret = SUCCEED;
 out:
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s processed:%d/%d", __func__, zbx_result_string(ret),
-			*values_num, *parsed_num);
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s processed:%d/%d size:" ZBX_FS_SIZE_T, __func__,
+			zbx_result_string(ret), *values_num, *parsed_num, (zbx_fs_size_t)values_size);
 
 	return ret;
 }
@@ -1216,6 +1243,10 @@ static int	proxy_item_validator(zbx_history_recv_item_t *item, zbx_socket_t *soc
  *                                                                            *
  * Comments: This function is used to parse the new proxy history data        *
  *           protocol introduced in Zabbix v3.3.                              *
+ *           The history data is received and parsed as a whole, only the     *
+ *           parsed values are added to history cache in batches capped by    *
+ *           ZBX_HISTORY_VALUES_MAX count and ZBX_HISTORY_VALUES_SIZE_MAX     *
+ *           size.                                                            *
  *                                                                            *
  ******************************************************************************/
 static int	process_history_data_by_itemids(zbx_socket_t *sock, zbx_client_item_validator_t validator_func,
@@ -2324,9 +2355,14 @@ int	zbx_process_proxy_data(const zbx_dc_proxy_t *proxy, const struct zbx_json_pa
 	char			*error_step = NULL, value[MAX_STRING_LEN];
 	size_t			error_alloc = 0, error_offset = 0;
 	zbx_proxy_diff_t	proxy_diff;
+	zbx_json_index_t	*index = NULL;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
+	/* proxy data is looked up by tag names, index large payloads to avoid rescanning them */
+	if (ZBX_JSON_INDEX_MIN_SIZE <= jp->end - jp->start)
+		index = zbx_json_index_create(jp);
+
 	proxy_diff.flags = ZBX_FLAGS_PROXY_DIFF_UNSET;
 	proxy_diff.hostid = proxy->proxyid;
 
@@ -2512,6 +2548,7 @@ int	zbx_process_proxy_data(const zbx_dc_proxy_t *proxy, const struct zbx_json_pa
 	}
 
 out:
+	zbx_json_index_free(index);
 	zbx_free(error_step);
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
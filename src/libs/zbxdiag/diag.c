@@ -36,6 +36,7 @@
 #define ZBX_DIAG_HISTORYCACHE_VALUES		0x00000002
 #define ZBX_DIAG_HISTORYCACHE_MEMORY_DATA	0x00000004
 #define ZBX_DIAG_HISTORYCACHE_MEMORY_INDEX	0x00000008
+#define ZBX_DIAG_HISTORYCACHE_FUNCTIONS		0x00000010
 
 #define ZBX_DIAG_HISTORYCACHE_SIMPLE	(ZBX_DIAG_HISTORYCACHE_ITEMS | \
 					ZBX_DIAG_HISTORYCACHE_VALUES)
@@ -199,6 +200,44 @@ void	zbx_diag_add_mem_stats(struct zbx_json *json, const char *name, const zbx_s
 
 	zbx_json_close(json);
 	zbx_json_close(json);
+
+	if (0 != stats->slab_pages)
+	{
+		zbx_json_addobject(json, "slabs");
+		zbx_json_adduint64(json, "pages", stats->slab_pages);
+		zbx_json_adduint64(json, "used", stats->slab_used_objects);
+		zbx_json_adduint64(json, "free", stats->slab_free_objects);
+		zbx_json_adduint64(json, "free_size", stats->slab_free_size);
+		zbx_json_adduint64(json, "overhead", stats->slab_overhead);
+		zbx_json_close(json);
+	}
+
+	zbx_json_close(json);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: add IPC message exchange statistics to the json data              *
+ *                                                                            *
+ * Parameters: json  - [IN/OUT] the json to update                            *
+ *             name  - [IN] the statistics object name                        *
+ *             stats - [IN] the IPC statistics                                *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_diag_add_ipc_stats(struct zbx_json *json, const char *name, const zbx_ipc_stats_t *stats)
+{
+	zbx_json_addobject(json, name);
+
+	zbx_json_addobject(json, "received");
+	zbx_json_adduint64(json, "messages", stats->rx_messages);
+	zbx_json_adduint64(json, "reads", stats->rx_reads);
+	zbx_json_close(json);
+
+	zbx_json_addobject(json, "sent");
+	zbx_json_adduint64(json, "messages", stats->tx_messages);
+	zbx_json_adduint64(json, "writes", stats->tx_writes);
+	zbx_json_close(json);
+
 	zbx_json_close(json);
 }
 
@@ -261,12 +300,14 @@ int	zbx_diag_add_historycache_info(const struct zbx_json_parse *jp, struct zbx_j
 	double			time1, time2, time_total = 0;
 	zbx_uint64_t		fields;
 	zbx_diag_map_t		field_map[] = {
-					{"", ZBX_DIAG_HISTORYCACHE_SIMPLE | ZBX_DIAG_HISTORYCACHE_MEMORY},
+					{"", ZBX_DIAG_HISTORYCACHE_SIMPLE | ZBX_DIAG_HISTORYCACHE_MEMORY |
+							ZBX_DIAG_HISTORYCACHE_FUNCTIONS},
 					{"items", ZBX_DIAG_HISTORYCACHE_ITEMS},
 					{"values", ZBX_DIAG_HISTORYCACHE_VALUES},
 					{"memory", ZBX_DIAG_HISTORYCACHE_MEMORY},
 					{"memory.data", ZBX_DIAG_HISTORYCACHE_MEMORY_DATA},
 					{"memory.index", ZBX_DIAG_HISTORYCACHE_MEMORY_INDEX},
+					{"functions", ZBX_DIAG_HISTORYCACHE_FUNCTIONS},
 					{NULL, 0}
 					};
 
@@ -311,6 +352,25 @@ int	zbx_diag_add_historycache_info(const struct zbx_json_parse *jp, struct zbx_j
 			zbx_json_close(json);
 		}
 
+		if (0 != (fields & ZBX_DIAG_HISTORYCACHE_FUNCTIONS))
+		{
+			zbx_uint64_t	functions_num, functions_unique;
+
+			time1 = zbx_time();
+			zbx_hc_get_trigger_function_stats(&functions_num, &functions_unique);
+			time2 = zbx_time();
+			time_total += time2 - time1;
+
+			/* trigger functions are deduplicated within history sync batches, */
+			/* the hit ratio is the share of functions that were not evaluated */
+			zbx_json_addobject(json, "functions");
+			zbx_json_adduint64(json, "total", functions_num);
+			zbx_json_adduint64(json, "unique", functions_unique);
+			zbx_json_addfloat(json, "hit ratio", 0 == functions_num ? 0 :
+					(double)(functions_num - functions_unique) / (double)functions_num);
+			zbx_json_close(json);
+		}
+
 		if (0 != tops.values_num)
 		{
 			zbx_json_addobject(json, "top");
@@ -417,14 +477,18 @@ void	zbx_diag_add_locks_info(struct zbx_json *json)
 				"ZBX_MUTEX_VALUECACHE", "ZBX_MUTEX_VMWARE", "ZBX_MUTEX_SQLITE3",
 				"ZBX_MUTEX_PROCSTAT", "ZBX_MUTEX_PROXY_HISTORY", "ZBX_MUTEX_KSTAT", "ZBX_MUTEX_MODBUS",
 				"ZBX_MUTEX_TREND_FUNC", "ZBX_MUTEX_REMOTE_COMMANDS", "ZBX_MUTEX_PROXY_BUFFER",
-				"ZBX_MUTEX_VPS_MONITOR"};
+				"ZBX_MUTEX_VPS_MONITOR", "ZBX_MUTEX_CACHE_SHARD_1", "ZBX_MUTEX_CACHE_SHARD_2",
+				"ZBX_MUTEX_CACHE_SHARD_3", "ZBX_MUTEX_CACHE_SHARD_4", "ZBX_MUTEX_CACHE_SHARD_5",
+				"ZBX_MUTEX_CACHE_SHARD_6", "ZBX_MUTEX_CACHE_SHARD_7"};
 #else
 	const char	*names[ZBX_MUTEX_COUNT] = {"ZBX_MUTEX_LOG", "ZBX_MUTEX_CACHE", "ZBX_MUTEX_TRENDS",
 				"ZBX_MUTEX_CACHE_IDS", "ZBX_MUTEX_SELFMON", "ZBX_MUTEX_CPUSTATS", "ZBX_MUTEX_DISKSTATS",
 				"ZBX_MUTEX_VALUECACHE", "ZBX_MUTEX_VMWARE", "ZBX_MUTEX_SQLITE3",
 				"ZBX_MUTEX_PROCSTAT", "ZBX_MUTEX_PROXY_HISTORY", "ZBX_MUTEX_MODBUS",
 				"ZBX_MUTEX_TREND_FUNC", "ZBX_MUTEX_REMOTE_COMMANDS", "ZBX_MUTEX_PROXY_BUFFER",
-				"ZBX_MUTEX_VPS_MONITOR"};
+				"ZBX_MUTEX_VPS_MONITOR", "ZBX_MUTEX_CACHE_SHARD_1", "ZBX_MUTEX_CACHE_SHARD_2",
+				"ZBX_MUTEX_CACHE_SHARD_3", "ZBX_MUTEX_CACHE_SHARD_4", "ZBX_MUTEX_CACHE_SHARD_5",
+				"ZBX_MUTEX_CACHE_SHARD_6", "ZBX_MUTEX_CACHE_SHARD_7"};
 #endif
 	zbx_json_addarray(json, ZBX_DIAG_LOCKS);
 
@@ -447,6 +511,17 @@ void	zbx_diag_add_locks_info(struct zbx_json *json)
 	zbx_json_addhex(json, "ZBX_RWLOCK_VALUECACHE", (zbx_uint64_t)zbx_rwlock_addr_get(ZBX_RWLOCK_VALUECACHE));
 	zbx_json_close(json);
 
+	for (i = 0; i < ZBX_RWLOCK_VALUECACHE_SHARDS_NUM; i++)
+	{
+		char	name[ZBX_DIAG_FIELD_MAX + 1];
+
+		zbx_snprintf(name, sizeof(name), "ZBX_RWLOCK_VALUECACHE_SHARD_%d", i + 1);
+
+		zbx_json_addobject(json, NULL);
+		zbx_json_addhex(json, name, (zbx_uint64_t)zbx_rwlock_addr_get(ZBX_RWLOCK_VALUECACHE_SHARD + i));
+		zbx_json_close(json);
+	}
+
 	zbx_json_close(json);
 }
 
@@ -603,7 +678,7 @@ static void	diag_get_simple_values(const struct zbx_json_parse *jp, char **msg)
 static void	diag_log_memory_info(struct zbx_json_parse *jp, const char *field, const char *path, char **out,
 		size_t *out_alloc, size_t *out_offset)
 {
-	struct zbx_json_parse	jp_memory, jp_size, jp_chunks;
+	struct zbx_json_parse	jp_memory, jp_size, jp_chunks, jp_slabs;
 	char			*msg = NULL;
 
 	if (FAIL == zbx_json_open_path(jp, path, &jp_memory))
@@ -643,6 +718,13 @@ static void	diag_log_memory_info(struct zbx_json_parse *jp, const char *field, c
 			}
 		}
 	}
+
+	if (SUCCEED == zbx_json_brackets_by_name(&jp_memory, "slabs", &jp_slabs))
+	{
+		diag_get_simple_values(&jp_slabs, &msg);
+		zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "  slabs: %s", msg);
+		zbx_free(msg);
+	}
 }
 
 /******************************************************************************
@@ -691,7 +773,8 @@ static void	diag_log_top_view(struct zbx_json_parse *jp, const char *field, cons
  ******************************************************************************/
 static void	diag_log_history_cache(struct zbx_json_parse *jp, char **out, size_t *out_alloc, size_t *out_offset)
 {
-	char	*msg = NULL;
+	char			*msg = NULL;
+	struct zbx_json_parse	jp_functions;
 
 	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "== history cache diagnostic information ==");
 
@@ -702,6 +785,13 @@ static void	diag_log_history_cache(struct zbx_json_parse *jp, char **out, size_t
 	diag_log_memory_info(jp, "memory.data", "$.memory.data", out, out_alloc, out_offset);
 	diag_log_memory_info(jp, "memory.index", "$.memory.index", out, out_alloc, out_offset);
 
+	if (SUCCEED == zbx_json_open_path(jp, "$.functions", &jp_functions))
+	{
+		diag_get_simple_values(&jp_functions, &msg);
+		zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "functions: %s", msg);
+		zbx_free(msg);
+	}
+
 	diag_log_top_view(jp, "top.values", "$.top.values", out, out_alloc, out_offset);
 
 	zbx_strlog_alloc(LOG_LEVEL_INFORMATION, out, out_alloc, out_offset, "==");
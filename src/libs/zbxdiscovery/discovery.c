@@ -36,6 +36,8 @@ DB_DSERVICE;
 
 static int	discoverer_initialized = 0;
 
+ZBX_VECTOR_IMPL(discovery_rule_stats, zbx_discovery_rule_stats_t)
+
 void	zbx_discoverer_init(void)
 {
 	discoverer_initialized = DISCOVERER_INITIALIZED_YES;
@@ -156,28 +158,53 @@ int	zbx_discovery_get_queue_size(zbx_uint64_t *size, char **error)
  *                                                                            *
  * Purpose: unpack worker usage statistics                                    *
  *                                                                            *
- * Parameters: usage - [OUT] the worker usage statistics                      *
- *             count - [OUT]                                                  *
- *             data  - [IN] the input data                                    *
+ * Parameters: usage      - [OUT] the worker usage statistics (optional)      *
+ *             count      - [OUT] (optional)                                  *
+ *             rule_stats - [OUT] the rule check statistics (optional)        *
+ *             data       - [IN] the input data                               *
  *                                                                            *
  ******************************************************************************/
-static void	discovery_unpack_usage_stats(zbx_vector_dbl_t *usage, int *count, const unsigned char *data)
+static void	discovery_unpack_usage_stats(zbx_vector_dbl_t *usage, int *count,
+		zbx_vector_discovery_rule_stats_t *rule_stats, const unsigned char *data)
 {
 	const unsigned char	*offset = data;
-	int			usage_num, i;
+	int			usage_num, rules_num, count_local, i;
 
 	offset += zbx_deserialize_value(offset, &usage_num);
-	zbx_vector_dbl_reserve(usage, (size_t)usage_num);
+
+	if (NULL != usage)
+		zbx_vector_dbl_reserve(usage, (size_t)usage_num);
 
 	for (i = 0; i < usage_num; i++)
 	{
 		double	busy;
 
 		offset += zbx_deserialize_value(offset, &busy);
-		zbx_vector_dbl_append(usage, busy);
+
+		if (NULL != usage)
+			zbx_vector_dbl_append(usage, busy);
 	}
 
-	(void)zbx_deserialize_value(offset, count);
+	offset += zbx_deserialize_value(offset, &count_local);
+
+	if (NULL != count)
+		*count = count_local;
+
+	if (NULL == rule_stats)
+		return;
+
+	offset += zbx_deserialize_value(offset, &rules_num);
+	zbx_vector_discovery_rule_stats_reserve(rule_stats, (size_t)rules_num);
+
+	for (i = 0; i < rules_num; i++)
+	{
+		zbx_discovery_rule_stats_t	stats;
+
+		offset += zbx_deserialize_value(offset, &stats.druleid);
+		offset += zbx_deserialize_value(offset, &stats.checks_num);
+		offset += zbx_deserialize_value(offset, &stats.time);
+		zbx_vector_discovery_rule_stats_append(rule_stats, stats);
+	}
 }
 
 /******************************************************************************
@@ -203,7 +230,39 @@ int	zbx_discovery_get_usage_stats(zbx_vector_dbl_t *usage, int *count, char **er
 		return FAIL;
 	}
 
-	discovery_unpack_usage_stats(usage, count, result);
+	discovery_unpack_usage_stats(usage, count, NULL, result);
+	zbx_free(result);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get discovery rule check throughput statistics                    *
+ *                                                                            *
+ * Parameters: rule_stats - [OUT] the rule check statistics                   *
+ *             error      - [OUT]                                             *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_discovery_get_rule_stats(zbx_vector_discovery_rule_stats_t *rule_stats, char **error)
+{
+	unsigned char	*result;
+
+	if (DISCOVERER_INITIALIZED_YES != discoverer_initialized)
+	{
+		*error = zbx_strdup(NULL, "discoverer is not initialized: please check \"StartDiscoverers\""
+				" configuration parameter");
+
+		return FAIL;
+	}
+
+	if (SUCCEED != zbx_ipc_async_exchange(ZBX_IPC_SERVICE_DISCOVERER, ZBX_IPC_DISCOVERER_USAGE_STATS,
+			SEC_PER_MIN, NULL, 0, &result, error))
+	{
+		return FAIL;
+	}
+
+	discovery_unpack_usage_stats(NULL, NULL, rule_stats, result);
 	zbx_free(result);
 
 	return SUCCEED;
@@ -213,18 +272,22 @@ int	zbx_discovery_get_usage_stats(zbx_vector_dbl_t *usage, int *count, char **er
  *                                                                            *
  * Purpose: pack diagnostic statistics data into a single buffer that can be  *
  *          used in IPC                                                       *
- * Parameters: data    - [OUT] memory buffer for packed data                  *
- *             usage   - [IN] the worker usage statistics                     *
- *             count   - [IN]                                                 *
+ * Parameters: data       - [OUT] memory buffer for packed data               *
+ *             usage      - [IN] the worker usage statistics                  *
+ *             count      - [IN]                                              *
+ *             rule_stats - [IN] the rule check statistics                    *
  *                                                                            *
  ******************************************************************************/
-zbx_uint32_t	zbx_discovery_pack_usage_stats(unsigned char **data, const zbx_vector_dbl_t *usage, int count)
+zbx_uint32_t	zbx_discovery_pack_usage_stats(unsigned char **data, const zbx_vector_dbl_t *usage, int count,
+		const zbx_vector_discovery_rule_stats_t *rule_stats)
 {
 	unsigned char	*ptr;
 	zbx_uint32_t	data_len;
 	int		i;
 
-	data_len = (zbx_uint32_t)((unsigned int)usage->values_num * sizeof(double) + sizeof(int) + sizeof(int));
+	data_len = (zbx_uint32_t)((unsigned int)usage->values_num * sizeof(double) + sizeof(int) + sizeof(int) +
+			sizeof(int) + (unsigned int)rule_stats->values_num *
+			(sizeof(zbx_uint64_t) + sizeof(zbx_uint64_t) + sizeof(double)));
 
 	ptr = *data = (unsigned char *)zbx_malloc(NULL, data_len);
 
@@ -233,20 +296,54 @@ zbx_uint32_t	zbx_discovery_pack_usage_stats(unsigned char **data, const zbx_vect
 	for (i = 0; i < usage->values_num; i++)
 		ptr += zbx_serialize_value(ptr, usage->values[i]);
 
-	(void)zbx_serialize_value(ptr, count);
+	ptr += zbx_serialize_value(ptr, count);
+	ptr += zbx_serialize_value(ptr, rule_stats->values_num);
+
+	for (i = 0; i < rule_stats->values_num; i++)
+	{
+		ptr += zbx_serialize_value(ptr, rule_stats->values[i].druleid);
+		ptr += zbx_serialize_value(ptr, rule_stats->values[i].checks_num);
+		ptr += zbx_serialize_value(ptr, rule_stats->values[i].time);
+	}
 
 	return data_len;
 }
 
 void zbx_discovery_stats_ext_get(struct zbx_json *json, const void *arg)
 {
-	zbx_uint64_t	size;
+	zbx_uint64_t				size;
+	zbx_vector_discovery_rule_stats_t	rule_stats;
+	char					*error = NULL;
+	int					i;
 
 	ZBX_UNUSED(arg);
 
 	/* zabbix[discovery_queue] */
 	if (SUCCEED == zbx_discovery_get_queue_size(&size, NULL))
 		zbx_json_adduint64(json, "discovery_queue", size);
+
+	zbx_vector_discovery_rule_stats_create(&rule_stats);
+
+	if (SUCCEED != zbx_discovery_get_rule_stats(&rule_stats, &error))
+	{
+		zbx_free(error);
+		goto out;
+	}
+
+	zbx_json_addarray(json, "discovery_rules");
+
+	for (i = 0; i < rule_stats.values_num; i++)
+	{
+		zbx_json_addobject(json, NULL);
+		zbx_json_adduint64(json, "druleid", rule_stats.values[i].druleid);
+		zbx_json_adduint64(json, "checks", rule_stats.values[i].checks_num);
+		zbx_json_addfloat(json, "time", rule_stats.values[i].time);
+		zbx_json_close(json);
+	}
+
+	zbx_json_close(json);
+out:
+	zbx_vector_discovery_rule_stats_destroy(&rule_stats);
 }
 
 /******************************************************************************
@@ -0,0 +1,281 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxeval.h"
+#include "eval.h"
+
+#include "zbxalgo.h"
+#include "zbxvariant.h"
+
+/* operand of simulated output stack during expression compilation */
+typedef struct
+{
+	/* index of the first token of operand subexpression */
+	int		start;
+	/* index of the constant token holding operand value or -1 if operand is not constant */
+	int		index;
+	/* location of operand subexpression in expression text */
+	zbx_strloc_t	loc;
+}
+zbx_eval_operand_t;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds closest non-whitespace character before specified position  *
+ *                                                                            *
+ * Return value: SUCCEED - the character was found                            *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	eval_find_prev_char(const char *expression, size_t pos, size_t *prev)
+{
+	while (0 < pos)
+	{
+		if (0 == isspace((unsigned char)expression[--pos]))
+		{
+			*prev = pos;
+			return SUCCEED;
+		}
+	}
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets operand location including enclosing parentheses             *
+ *                                                                            *
+ * Parameters: ctx     - [IN] evaluation context                              *
+ *             operand - [IN]                                                 *
+ *             loc     - [OUT] operand location                               *
+ *                                                                            *
+ * Comments: Operator operands are never function arguments, so parentheses   *
+ *           directly enclosing operand can only be grouping parentheses.     *
+ *                                                                            *
+ ******************************************************************************/
+static void	eval_get_operand_loc(const zbx_eval_context_t *ctx, const zbx_eval_operand_t *operand,
+		zbx_strloc_t *loc)
+{
+	size_t	l, r;
+
+	*loc = operand->loc;
+
+	while (SUCCEED == eval_find_prev_char(ctx->expression, loc->l, &l) && '(' == ctx->expression[l])
+	{
+		for (r = loc->r + 1; 0 != isspace((unsigned char)ctx->expression[r]); r++)
+			;
+
+		if (')' != ctx->expression[r])
+			break;
+
+		loc->l = l;
+		loc->r = r;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: replaces operator with constant operands by its result            *
+ *                                                                            *
+ * Parameters: ctx      - [IN/OUT] evaluation context                         *
+ *             op_index - [IN] operator token index                           *
+ *             operands - [IN/OUT] operator operands, the first operand is    *
+ *                                 replaced by the folded constant            *
+ *             args_num - [IN] number of operands                             *
+ *                                                                            *
+ * Return value: SUCCEED - operator was folded into constant                  *
+ *               FAIL    - operator cannot be calculated during compilation   *
+ *                                                                            *
+ * Comments: Operators resulting in errors are left to fail at runtime.       *
+ *                                                                            *
+ ******************************************************************************/
+static int	eval_fold_operator(zbx_eval_context_t *ctx, int op_index, zbx_eval_operand_t *operands,
+		int args_num)
+{
+	zbx_eval_token_t	*token = &ctx->stack.values[op_index];
+	zbx_vector_var_t	output;
+	zbx_strloc_t		loc;
+	char			*error = NULL;
+	int			i, ret = FAIL;
+
+	for (i = 0; i < args_num; i++)
+	{
+		if (-1 == operands[i].index)
+			return FAIL;
+	}
+
+	zbx_vector_var_create(&output);
+
+	for (i = 0; i < args_num; i++)
+	{
+		zbx_variant_t	value;
+
+		zbx_variant_copy(&value, &ctx->stack.values[operands[i].index].value);
+		zbx_vector_var_append_ptr(&output, &value);
+	}
+
+	if (SUCCEED != eval_execute_operator(ctx, token, &output, &error))
+	{
+		zbx_free(error);
+		goto out;
+	}
+
+	if (1 != output.values_num || ZBX_VARIANT_ERR == output.values[0].type)
+		goto out;
+
+	/* unary operators precede operand while binary operators are placed between operands */
+	if (1 == args_num)
+	{
+		eval_get_operand_loc(ctx, &operands[0], &loc);
+		loc.l = token->loc.l;
+	}
+	else
+	{
+		zbx_strloc_t	loc_right;
+
+		eval_get_operand_loc(ctx, &operands[0], &loc);
+		eval_get_operand_loc(ctx, &operands[1], &loc_right);
+		loc.r = loc_right.r;
+	}
+
+	for (i = operands[0].start; i < op_index; i++)
+	{
+		zbx_variant_clear(&ctx->stack.values[i].value);
+		ctx->stack.values[i].type = ZBX_EVAL_TOKEN_NOP;
+	}
+
+	token->type = ZBX_EVAL_TOKEN_VAR_NUM;
+	token->opt = 0;
+	token->loc = loc;
+	token->value = output.values[0];
+	output.values_num = 0;
+
+	operands[0].index = op_index;
+	operands[0].loc = loc;
+
+	ret = SUCCEED;
+out:
+	for (i = 0; i < output.values_num; i++)
+		zbx_variant_clear(&output.values[i]);
+
+	zbx_vector_var_destroy(&output);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compiles parsed expression for faster repeated evaluation         *
+ *                                                                            *
+ * Parameters: ctx - [IN/OUT] evaluation context                              *
+ *                                                                            *
+ * Comments: Numeric constants are converted to values, so they are not       *
+ *           parsed from expression text during every evaluation, and         *
+ *           operators having only constant operands are replaced by their    *
+ *           results. Replaced tokens are turned into no-op tokens, keeping   *
+ *           functionids, macros and function tokens intact.                  *
+ *           Common function tokens get their function index stored in        *
+ *           the upper bits of token options, so function handlers are        *
+ *           not looked up by name during evaluation.                         *
+ *           The compiled context must be serialized for caching and must     *
+ *           not be used to compose expressions other than for logging.       *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_eval_compile(zbx_eval_context_t *ctx)
+{
+	zbx_eval_operand_t	*operands;
+	int			i, operands_num = 0, folded = 0, resolved = 0;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() expression:'%s'", __func__, ctx->expression);
+
+	if (0 == ctx->stack.values_num)
+		goto out;
+
+	operands = (zbx_eval_operand_t *)zbx_malloc(NULL, sizeof(zbx_eval_operand_t) * ctx->stack.values_num);
+
+	for (i = 0; i < ctx->stack.values_num; i++)
+	{
+		zbx_eval_token_t	*token = &ctx->stack.values[i];
+		zbx_eval_operand_t	*operand;
+		int			args_num;
+
+		if (ZBX_EVAL_TOKEN_NOP == token->type)
+			continue;
+
+		if (0 != (token->type & (ZBX_EVAL_CLASS_OPERATOR | ZBX_EVAL_CLASS_FUNCTION)))
+		{
+			if (ZBX_EVAL_TOKEN_FUNCTION == token->type &&
+					0 == ZBX_EVAL_FUNCTION_INDEX(token->opt))
+			{
+				token->opt |= (zbx_uint32_t)eval_get_function_index(ctx, token) <<
+						ZBX_EVAL_FUNCTION_INDEX_SHIFT;
+				resolved++;
+			}
+
+			if (0 != (token->type & ZBX_EVAL_CLASS_OPERATOR1))
+				args_num = 1;
+			else if (0 != (token->type & ZBX_EVAL_CLASS_OPERATOR2))
+				args_num = 2;
+			else
+				args_num = (int)ZBX_EVAL_FUNCTION_ARGS_NUM(token->opt);
+
+			/* malformed stack, leave the rest of expression as it is */
+			if (operands_num < args_num)
+				break;
+
+			operands_num -= args_num;
+			operand = &operands[operands_num++];
+
+			if (0 == args_num)
+			{
+				operand->start = i;
+				operand->loc = token->loc;
+				operand->index = -1;
+			}
+			else if (0 != (token->type & ZBX_EVAL_CLASS_OPERATOR) &&
+					SUCCEED == eval_fold_operator(ctx, i, operand, args_num))
+			{
+				folded++;
+			}
+			else
+				operand->index = -1;
+
+			continue;
+		}
+
+		operand = &operands[operands_num++];
+		operand->start = i;
+		operand->loc = token->loc;
+		operand->index = -1;
+
+		/* numeric constants containing macros are resolved during evaluation */
+		if (ZBX_EVAL_TOKEN_VAR_NUM == token->type && NULL == memchr(ctx->expression + token->loc.l, '{',
+				token->loc.r - token->loc.l + 1))
+		{
+			if (ZBX_VARIANT_NONE == token->value.type)
+				eval_get_number_token_value(ctx, token, &token->value);
+
+			operand->index = i;
+		}
+	}
+
+	zbx_free(operands);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() folded:%d resolved:%d", __func__, folded, resolved);
+}
@@ -22,9 +22,22 @@
 
 #include "zbxeval.h"
 
+/* compiled function tokens keep resolved function index (0 - not resolved) in the upper bits of token options */
+/* (options are serialized as 31 bit values, limiting function index to 127)                                  */
+#define ZBX_EVAL_FUNCTION_INDEX_SHIFT	24
+#define ZBX_EVAL_FUNCTION_ARGS_MASK	((1 << ZBX_EVAL_FUNCTION_INDEX_SHIFT) - 1)
+
+#define ZBX_EVAL_FUNCTION_ARGS_NUM(opt)	((opt) & ZBX_EVAL_FUNCTION_ARGS_MASK)
+#define ZBX_EVAL_FUNCTION_INDEX(opt)	((opt) >> ZBX_EVAL_FUNCTION_INDEX_SHIFT)
+
 int	eval_suffixed_number_parse(const char *value, char *suffix);
 int	eval_compare_token(const zbx_eval_context_t *ctx, const zbx_strloc_t *loc, const char *text,
 		size_t len);
 size_t	eval_parse_query(const char *str, const char **phost, const char **pkey, const char **pfilter);
+void	eval_get_number_token_value(const zbx_eval_context_t *ctx, const zbx_eval_token_t *token,
+		zbx_variant_t *value);
+int	eval_get_function_index(const zbx_eval_context_t *ctx, const zbx_eval_token_t *token);
+int	eval_execute_operator(const zbx_eval_context_t *ctx, const zbx_eval_token_t *token, zbx_vector_var_t *output,
+		char **error);
 
 #endif
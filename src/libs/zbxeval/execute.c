@@ -55,6 +55,126 @@ typedef enum
 }
 zbx_function_trim_optype_t;
 
+/* common functions, compiled expressions store the function index in function token options */
+typedef enum
+{
+	EVAL_FUNCTION_UNRESOLVED = 0,
+	EVAL_FUNCTION_MIN,
+	EVAL_FUNCTION_MAX,
+	EVAL_FUNCTION_SUM,
+	EVAL_FUNCTION_AVG,
+	EVAL_FUNCTION_ABS,
+	EVAL_FUNCTION_LENGTH,
+	EVAL_FUNCTION_DATE,
+	EVAL_FUNCTION_TIME,
+	EVAL_FUNCTION_NOW,
+	EVAL_FUNCTION_DAYOFWEEK,
+	EVAL_FUNCTION_DAYOFMONTH,
+	EVAL_FUNCTION_BITAND,
+	EVAL_FUNCTION_BITOR,
+	EVAL_FUNCTION_BITXOR,
+	EVAL_FUNCTION_BITLSHIFT,
+	EVAL_FUNCTION_BITRSHIFT,
+	EVAL_FUNCTION_BITNOT,
+	EVAL_FUNCTION_BETWEEN,
+	EVAL_FUNCTION_IN,
+	EVAL_FUNCTION_ASCII,
+	EVAL_FUNCTION_CHAR,
+	EVAL_FUNCTION_LEFT,
+	EVAL_FUNCTION_RIGHT,
+	EVAL_FUNCTION_MID,
+	EVAL_FUNCTION_BITLENGTH,
+	EVAL_FUNCTION_BYTELENGTH,
+	EVAL_FUNCTION_CONCAT,
+	EVAL_FUNCTION_INSERT,
+	EVAL_FUNCTION_REPLACE,
+	EVAL_FUNCTION_REPEAT,
+	EVAL_FUNCTION_LTRIM,
+	EVAL_FUNCTION_RTRIM,
+	EVAL_FUNCTION_TRIM,
+	EVAL_FUNCTION_CBRT,
+	EVAL_FUNCTION_CEIL,
+	EVAL_FUNCTION_EXP,
+	EVAL_FUNCTION_EXPM1,
+	EVAL_FUNCTION_FLOOR,
+	EVAL_FUNCTION_SIGNUM,
+	EVAL_FUNCTION_DEGREES,
+	EVAL_FUNCTION_RADIANS,
+	EVAL_FUNCTION_ACOS,
+	EVAL_FUNCTION_ASIN,
+	EVAL_FUNCTION_ATAN,
+	EVAL_FUNCTION_COS,
+	EVAL_FUNCTION_COSH,
+	EVAL_FUNCTION_COT,
+	EVAL_FUNCTION_SIN,
+	EVAL_FUNCTION_SINH,
+	EVAL_FUNCTION_TAN,
+	EVAL_FUNCTION_LOG,
+	EVAL_FUNCTION_LOG10,
+	EVAL_FUNCTION_SQRT,
+	EVAL_FUNCTION_POWER,
+	EVAL_FUNCTION_ROUND,
+	EVAL_FUNCTION_MOD,
+	EVAL_FUNCTION_TRUNCATE,
+	EVAL_FUNCTION_ATAN2,
+	EVAL_FUNCTION_PI,
+	EVAL_FUNCTION_E,
+	EVAL_FUNCTION_RAND,
+	EVAL_FUNCTION_KURTOSIS,
+	EVAL_FUNCTION_MAD,
+	EVAL_FUNCTION_SKEWNESS,
+	EVAL_FUNCTION_STDDEVPOP,
+	EVAL_FUNCTION_STDDEVSAMP,
+	EVAL_FUNCTION_SUMOFSQUARES,
+	EVAL_FUNCTION_VARPOP,
+	EVAL_FUNCTION_VARSAMP,
+	EVAL_FUNCTION_COUNT,
+	EVAL_FUNCTION_HISTOGRAM_QUANTILE,
+	EVAL_FUNCTION_JSONPATH,
+	EVAL_FUNCTION_XMLXPATH,
+	/* not a common function, evaluated by callback */
+	EVAL_FUNCTION_CALLBACK
+}
+zbx_eval_function_t;
+
+typedef struct
+{
+	const char	*name;
+	size_t		len;
+}
+zbx_eval_function_name_t;
+
+#define EVAL_FUNCTION_NAME(name)	{name, ZBX_CONST_STRLEN(name)}
+
+/* common function names, indexed by zbx_eval_function_t */
+static const zbx_eval_function_name_t	eval_functions[] = {
+	{NULL, 0},
+	EVAL_FUNCTION_NAME("min"), EVAL_FUNCTION_NAME("max"), EVAL_FUNCTION_NAME("sum"), EVAL_FUNCTION_NAME("avg"),
+	EVAL_FUNCTION_NAME("abs"), EVAL_FUNCTION_NAME("length"), EVAL_FUNCTION_NAME("date"), EVAL_FUNCTION_NAME("time"),
+	EVAL_FUNCTION_NAME("now"), EVAL_FUNCTION_NAME("dayofweek"), EVAL_FUNCTION_NAME("dayofmonth"),
+	EVAL_FUNCTION_NAME("bitand"), EVAL_FUNCTION_NAME("bitor"), EVAL_FUNCTION_NAME("bitxor"),
+	EVAL_FUNCTION_NAME("bitlshift"), EVAL_FUNCTION_NAME("bitrshift"), EVAL_FUNCTION_NAME("bitnot"),
+	EVAL_FUNCTION_NAME("between"), EVAL_FUNCTION_NAME("in"), EVAL_FUNCTION_NAME("ascii"),
+	EVAL_FUNCTION_NAME("char"), EVAL_FUNCTION_NAME("left"), EVAL_FUNCTION_NAME("right"), EVAL_FUNCTION_NAME("mid"),
+	EVAL_FUNCTION_NAME("bitlength"), EVAL_FUNCTION_NAME("bytelength"), EVAL_FUNCTION_NAME("concat"),
+	EVAL_FUNCTION_NAME("insert"), EVAL_FUNCTION_NAME("replace"), EVAL_FUNCTION_NAME("repeat"),
+	EVAL_FUNCTION_NAME("ltrim"), EVAL_FUNCTION_NAME("rtrim"), EVAL_FUNCTION_NAME("trim"),
+	EVAL_FUNCTION_NAME("cbrt"), EVAL_FUNCTION_NAME("ceil"), EVAL_FUNCTION_NAME("exp"), EVAL_FUNCTION_NAME("expm1"),
+	EVAL_FUNCTION_NAME("floor"), EVAL_FUNCTION_NAME("signum"), EVAL_FUNCTION_NAME("degrees"),
+	EVAL_FUNCTION_NAME("radians"), EVAL_FUNCTION_NAME("acos"), EVAL_FUNCTION_NAME("asin"),
+	EVAL_FUNCTION_NAME("atan"), EVAL_FUNCTION_NAME("cos"), EVAL_FUNCTION_NAME("cosh"), EVAL_FUNCTION_NAME("cot"),
+	EVAL_FUNCTION_NAME("sin"), EVAL_FUNCTION_NAME("sinh"), EVAL_FUNCTION_NAME("tan"), EVAL_FUNCTION_NAME("log"),
+	EVAL_FUNCTION_NAME("log10"), EVAL_FUNCTION_NAME("sqrt"), EVAL_FUNCTION_NAME("power"),
+	EVAL_FUNCTION_NAME("round"), EVAL_FUNCTION_NAME("mod"), EVAL_FUNCTION_NAME("truncate"),
+	EVAL_FUNCTION_NAME("atan2"), EVAL_FUNCTION_NAME("pi"), EVAL_FUNCTION_NAME("e"), EVAL_FUNCTION_NAME("rand"),
+	EVAL_FUNCTION_NAME("kurtosis"), EVAL_FUNCTION_NAME("mad"), EVAL_FUNCTION_NAME("skewness"),
+	EVAL_FUNCTION_NAME("stddevpop"), EVAL_FUNCTION_NAME("stddevsamp"), EVAL_FUNCTION_NAME("sumofsquares"),
+	EVAL_FUNCTION_NAME("varpop"), EVAL_FUNCTION_NAME("varsamp"), EVAL_FUNCTION_NAME("count"),
+	EVAL_FUNCTION_NAME("histogram_quantile"), EVAL_FUNCTION_NAME("jsonpath"), EVAL_FUNCTION_NAME("xmlxpath")
+};
+
+#undef EVAL_FUNCTION_NAME
+
 /******************************************************************************
  *                                                                            *
  * Purpose: converts variant string value containing suffixed number to       *
@@ -405,6 +525,28 @@ finish:
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: evaluates unary or binary operator                                *
+ *                                                                            *
+ * Parameters: ctx      - [IN] evaluation context                             *
+ *             token    - [IN] operator token                                 *
+ *             output   - [IN/OUT] output value stack                         *
+ *             error    - [OUT] error message in the case of failure          *
+ *                                                                            *
+ * Return value: SUCCEED - operator was evaluated successfully                *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	eval_execute_operator(const zbx_eval_context_t *ctx, const zbx_eval_token_t *token, zbx_vector_var_t *output,
+		char **error)
+{
+	if (0 != (token->type & ZBX_EVAL_CLASS_OPERATOR1))
+		return eval_execute_op_unary(ctx, token, output, error);
+
+	return eval_execute_op_binary(ctx, token, output, error);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: checks if value is suffixed number and returns suffix if exists   *
@@ -435,6 +577,31 @@ int	 eval_suffixed_number_parse(const char *value, char *suffix)
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets value of numeric constant token                              *
+ *                                                                            *
+ * Parameters: ctx   - [IN] evaluation context                                *
+ *             token - [IN] numeric constant token                            *
+ *             value - [OUT] unsigned integer or floating point value         *
+ *                                                                            *
+ ******************************************************************************/
+void	eval_get_number_token_value(const zbx_eval_context_t *ctx, const zbx_eval_token_t *token,
+		zbx_variant_t *value)
+{
+	zbx_uint64_t	ui64;
+
+	if (SUCCEED == zbx_is_uint64_n(ctx->expression + token->loc.l, token->loc.r - token->loc.l + 1, &ui64))
+	{
+		zbx_variant_set_ui64(value, ui64);
+	}
+	else
+	{
+		zbx_variant_set_dbl(value, atof(ctx->expression + token->loc.l) *
+				suffix2factor(ctx->expression[token->loc.r]));
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: pushes value in output stack                                      *
@@ -458,20 +625,7 @@ static int	eval_execute_push_value(const zbx_eval_context_t *ctx, const zbx_eval
 	if (ZBX_VARIANT_NONE == token->value.type)
 	{
 		if (ZBX_EVAL_TOKEN_VAR_NUM == token->type)
-		{
-			zbx_uint64_t	ui64;
-
-			if (SUCCEED == zbx_is_uint64_n(ctx->expression + token->loc.l, token->loc.r - token->loc.l + 1,
-					&ui64))
-			{
-				zbx_variant_set_ui64(&value, ui64);
-			}
-			else
-			{
-				zbx_variant_set_dbl(&value, atof(ctx->expression + token->loc.l) *
-						suffix2factor(ctx->expression[token->loc.r]));
-			}
-		}
+			eval_get_number_token_value(ctx, token, &value);
 		else
 		{
 			dst = zbx_malloc(NULL, token->loc.r - token->loc.l + 2);
@@ -2961,6 +3115,31 @@ static int	eval_execute_function_xmlxpath(const zbx_eval_context_t *ctx, const z
 #endif
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: resolves common function by its name                              *
+ *                                                                            *
+ * Parameters: ctx   - [IN] evaluation context                                *
+ *             token - [IN] function token                                    *
+ *                                                                            *
+ * Return value: function index in common function table or                   *
+ *               EVAL_FUNCTION_CALLBACK if function is not a common           *
+ *               function and must be evaluated by callback                   *
+ *                                                                            *
+ ******************************************************************************/
+int	eval_get_function_index(const zbx_eval_context_t *ctx, const zbx_eval_token_t *token)
+{
+	int	i;
+
+	for (i = EVAL_FUNCTION_UNRESOLVED + 1; i < EVAL_FUNCTION_CALLBACK; i++)
+	{
+		if (SUCCEED == eval_compare_token(ctx, &token->loc, eval_functions[i].name, eval_functions[i].len))
+			return i;
+	}
+
+	return EVAL_FUNCTION_CALLBACK;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: evaluates common function                                         *
@@ -2977,6 +3156,17 @@ static int	eval_execute_function_xmlxpath(const zbx_eval_context_t *ctx, const z
 static int	eval_execute_common_function(const zbx_eval_context_t *ctx, const zbx_eval_token_t *token,
 		zbx_vector_var_t *output, char **error)
 {
+	zbx_eval_token_t	function_token;
+	int			index;
+
+	if (EVAL_FUNCTION_UNRESOLVED == (index = (int)ZBX_EVAL_FUNCTION_INDEX(token->opt)))
+		index = eval_get_function_index(ctx, token);
+
+	/* function handlers expect only the number of arguments in token options */
+	function_token = *token;
+	function_token.opt = ZBX_EVAL_FUNCTION_ARGS_NUM(token->opt);
+	token = &function_token;
+
 	if ((zbx_uint32_t)output->values_num < token->opt)
 	{
 		*error = zbx_dsprintf(*error, "not enough arguments for function at \"%s\"",
@@ -2984,155 +3174,158 @@ static int	eval_execute_common_function(const zbx_eval_context_t *ctx, const zbx
 		return FAIL;
 	}
 
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "min", ZBX_CONST_STRLEN("min")))
-		return eval_execute_function_min(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "max", ZBX_CONST_STRLEN("max")))
-		return eval_execute_function_max(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "sum", ZBX_CONST_STRLEN("sum")))
-		return eval_execute_function_sum(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "avg", ZBX_CONST_STRLEN("avg")))
-		return eval_execute_function_avg(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "abs", ZBX_CONST_STRLEN("abs")))
-		return eval_execute_function_abs(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "length", ZBX_CONST_STRLEN("length")))
-		return eval_execute_function_length(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "date", ZBX_CONST_STRLEN("date")))
-		return eval_execute_function_date(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "time", ZBX_CONST_STRLEN("time")))
-		return eval_execute_function_time(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "now", ZBX_CONST_STRLEN("now")))
-		return eval_execute_function_now(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "dayofweek", ZBX_CONST_STRLEN("dayofweek")))
-		return eval_execute_function_dayofweek(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "dayofmonth", ZBX_CONST_STRLEN("dayofmonth")))
-		return eval_execute_function_dayofmonth(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "bitand", ZBX_CONST_STRLEN("bitand")))
-		return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_AND, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "bitor", ZBX_CONST_STRLEN("bitor")))
-		return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_OR, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "bitxor", ZBX_CONST_STRLEN("bitxor")))
-		return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_XOR, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "bitlshift", ZBX_CONST_STRLEN("bitlshift")))
-		return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_LSHIFT, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "bitrshift", ZBX_CONST_STRLEN("bitrshift")))
-		return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_RSHIFT, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "bitnot", ZBX_CONST_STRLEN("bitnot")))
-		return eval_execute_function_bitnot(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "between", ZBX_CONST_STRLEN("between")))
-		return eval_execute_function_between(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "in", ZBX_CONST_STRLEN("in")))
-		return eval_execute_function_in(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "ascii", ZBX_CONST_STRLEN("ascii")))
-		return eval_execute_function_ascii(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "char", ZBX_CONST_STRLEN("char")))
-		return eval_execute_function_char(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "left", ZBX_CONST_STRLEN("left")))
-		return eval_execute_function_left(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "right", ZBX_CONST_STRLEN("right")))
-		return eval_execute_function_right(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "mid", ZBX_CONST_STRLEN("mid")))
-		return eval_execute_function_mid(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "bitlength", ZBX_CONST_STRLEN("bitlength")))
-		return eval_execute_function_bitlength(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "bytelength", ZBX_CONST_STRLEN("bytelength")))
-		return eval_execute_function_bytelength(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "concat", ZBX_CONST_STRLEN("concat")))
-		return eval_execute_function_concat(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "insert", ZBX_CONST_STRLEN("insert")))
-		return eval_execute_function_insert(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "replace", ZBX_CONST_STRLEN("replace")))
-		return eval_execute_function_replace(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "repeat", ZBX_CONST_STRLEN("repeat")))
-		return eval_execute_function_repeat(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "ltrim", ZBX_CONST_STRLEN("ltrim")))
-		return eval_execute_function_trim(ctx, token, FUNCTION_OPTYPE_TRIM_LEFT, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "rtrim", ZBX_CONST_STRLEN("rtrim")))
-		return eval_execute_function_trim(ctx, token, FUNCTION_OPTYPE_TRIM_RIGHT, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "trim", ZBX_CONST_STRLEN("trim")))
-		return eval_execute_function_trim(ctx, token, FUNCTION_OPTYPE_TRIM_ALL, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "cbrt", ZBX_CONST_STRLEN("cbrt")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, cbrt);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "ceil", ZBX_CONST_STRLEN("ceil")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, ceil);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "exp", ZBX_CONST_STRLEN("exp")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, exp);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "expm1", ZBX_CONST_STRLEN("expm1")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, expm1);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "floor", ZBX_CONST_STRLEN("floor")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, floor);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "signum", ZBX_CONST_STRLEN("signum")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, eval_math_func_signum);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "degrees", ZBX_CONST_STRLEN("degrees")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, eval_math_func_degrees);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "radians", ZBX_CONST_STRLEN("radians")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, eval_math_func_radians);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "acos", ZBX_CONST_STRLEN("acos")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, acos);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "asin", ZBX_CONST_STRLEN("asin")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, asin);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "atan", ZBX_CONST_STRLEN("atan")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, atan);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "cos", ZBX_CONST_STRLEN("cos")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, cos);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "cosh", ZBX_CONST_STRLEN("cosh")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, cosh);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "cot", ZBX_CONST_STRLEN("cot")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, eval_math_func_cot);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "sin", ZBX_CONST_STRLEN("sin")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, sin);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "sinh", ZBX_CONST_STRLEN("sinh")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, sinh);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "tan", ZBX_CONST_STRLEN("tan")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, tan);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "log", ZBX_CONST_STRLEN("log")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, log);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "log10", ZBX_CONST_STRLEN("log10")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, log10);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "sqrt", ZBX_CONST_STRLEN("sqrt")))
-		return eval_execute_math_function_single_param(ctx, token, output, error, sqrt);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "power", ZBX_CONST_STRLEN("power")))
-		return eval_execute_math_function_double_param(ctx, token, output, error, pow);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "round", ZBX_CONST_STRLEN("round")))
-		return eval_execute_math_function_double_param(ctx, token, output, error, eval_math_func_round);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "mod", ZBX_CONST_STRLEN("mod")))
-		return eval_execute_math_function_double_param(ctx, token, output, error, fmod);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "truncate", ZBX_CONST_STRLEN("truncate")))
-		return eval_execute_math_function_double_param(ctx, token, output, error, eval_math_func_truncate);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "atan2", ZBX_CONST_STRLEN("atan2")))
-		return eval_execute_math_function_double_param(ctx, token, output, error, atan2);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "pi", ZBX_CONST_STRLEN("pi")))
-		return eval_execute_math_return_value(ctx, token, output, error, ZBX_MATH_CONST_PI);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "e", ZBX_CONST_STRLEN("e")))
-		return eval_execute_math_return_value(ctx, token, output, error, ZBX_MATH_CONST_E);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "rand", ZBX_CONST_STRLEN("rand")))
-		return eval_execute_math_return_value(ctx, token, output, error, ZBX_MATH_RANDOM);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "kurtosis", ZBX_CONST_STRLEN("kurtosis")))
-		return eval_execute_statistical_function(ctx, token, zbx_eval_calc_kurtosis, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "mad", ZBX_CONST_STRLEN("mad")))
-		return eval_execute_statistical_function(ctx, token, zbx_eval_calc_mad, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "skewness", ZBX_CONST_STRLEN("skewness")))
-		return eval_execute_statistical_function(ctx, token, zbx_eval_calc_skewness, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "stddevpop", ZBX_CONST_STRLEN("stddevpop")))
-		return eval_execute_statistical_function(ctx, token, zbx_eval_calc_stddevpop, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "stddevsamp", ZBX_CONST_STRLEN("stddevsamp")))
-		return eval_execute_statistical_function(ctx, token, zbx_eval_calc_stddevsamp, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "sumofsquares", ZBX_CONST_STRLEN("sumofsquares")))
-		return eval_execute_statistical_function(ctx, token, zbx_eval_calc_sumofsquares, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "varpop", ZBX_CONST_STRLEN("varpop")))
-		return eval_execute_statistical_function(ctx, token, zbx_eval_calc_varpop, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "varsamp", ZBX_CONST_STRLEN("varsamp")))
-		return eval_execute_statistical_function(ctx, token, zbx_eval_calc_varsamp, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "count", ZBX_CONST_STRLEN("count")))
-		return eval_execute_function_count(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "histogram_quantile",
-			ZBX_CONST_STRLEN("histogram_quantile")))
-	{
-		return eval_execute_function_histogram_quantile(ctx, token, output, error);
-	}
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "jsonpath", ZBX_CONST_STRLEN("jsonpath")))
-		return eval_execute_function_jsonpath(ctx, token, output, error);
-	if (SUCCEED == eval_compare_token(ctx, &token->loc, "xmlxpath", ZBX_CONST_STRLEN("xmlxpath")))
-		return eval_execute_function_xmlxpath(ctx, token, output, error);
+	switch (index)
+	{
+		case EVAL_FUNCTION_MIN:
+			return eval_execute_function_min(ctx, token, output, error);
+		case EVAL_FUNCTION_MAX:
+			return eval_execute_function_max(ctx, token, output, error);
+		case EVAL_FUNCTION_SUM:
+			return eval_execute_function_sum(ctx, token, output, error);
+		case EVAL_FUNCTION_AVG:
+			return eval_execute_function_avg(ctx, token, output, error);
+		case EVAL_FUNCTION_ABS:
+			return eval_execute_function_abs(ctx, token, output, error);
+		case EVAL_FUNCTION_LENGTH:
+			return eval_execute_function_length(ctx, token, output, error);
+		case EVAL_FUNCTION_DATE:
+			return eval_execute_function_date(ctx, token, output, error);
+		case EVAL_FUNCTION_TIME:
+			return eval_execute_function_time(ctx, token, output, error);
+		case EVAL_FUNCTION_NOW:
+			return eval_execute_function_now(ctx, token, output, error);
+		case EVAL_FUNCTION_DAYOFWEEK:
+			return eval_execute_function_dayofweek(ctx, token, output, error);
+		case EVAL_FUNCTION_DAYOFMONTH:
+			return eval_execute_function_dayofmonth(ctx, token, output, error);
+		case EVAL_FUNCTION_BITAND:
+			return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_AND, output, error);
+		case EVAL_FUNCTION_BITOR:
+			return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_OR, output, error);
+		case EVAL_FUNCTION_BITXOR:
+			return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_XOR, output, error);
+		case EVAL_FUNCTION_BITLSHIFT:
+			return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_LSHIFT, output, error);
+		case EVAL_FUNCTION_BITRSHIFT:
+			return eval_execute_function_bitwise(ctx, token, FUNCTION_OPTYPE_BIT_RSHIFT, output, error);
+		case EVAL_FUNCTION_BITNOT:
+			return eval_execute_function_bitnot(ctx, token, output, error);
+		case EVAL_FUNCTION_BETWEEN:
+			return eval_execute_function_between(ctx, token, output, error);
+		case EVAL_FUNCTION_IN:
+			return eval_execute_function_in(ctx, token, output, error);
+		case EVAL_FUNCTION_ASCII:
+			return eval_execute_function_ascii(ctx, token, output, error);
+		case EVAL_FUNCTION_CHAR:
+			return eval_execute_function_char(ctx, token, output, error);
+		case EVAL_FUNCTION_LEFT:
+			return eval_execute_function_left(ctx, token, output, error);
+		case EVAL_FUNCTION_RIGHT:
+			return eval_execute_function_right(ctx, token, output, error);
+		case EVAL_FUNCTION_MID:
+			return eval_execute_function_mid(ctx, token, output, error);
+		case EVAL_FUNCTION_BITLENGTH:
+			return eval_execute_function_bitlength(ctx, token, output, error);
+		case EVAL_FUNCTION_BYTELENGTH:
+			return eval_execute_function_bytelength(ctx, token, output, error);
+		case EVAL_FUNCTION_CONCAT:
+			return eval_execute_function_concat(ctx, token, output, error);
+		case EVAL_FUNCTION_INSERT:
+			return eval_execute_function_insert(ctx, token, output, error);
+		case EVAL_FUNCTION_REPLACE:
+			return eval_execute_function_replace(ctx, token, output, error);
+		case EVAL_FUNCTION_REPEAT:
+			return eval_execute_function_repeat(ctx, token, output, error);
+		case EVAL_FUNCTION_LTRIM:
+			return eval_execute_function_trim(ctx, token, FUNCTION_OPTYPE_TRIM_LEFT, output, error);
+		case EVAL_FUNCTION_RTRIM:
+			return eval_execute_function_trim(ctx, token, FUNCTION_OPTYPE_TRIM_RIGHT, output, error);
+		case EVAL_FUNCTION_TRIM:
+			return eval_execute_function_trim(ctx, token, FUNCTION_OPTYPE_TRIM_ALL, output, error);
+		case EVAL_FUNCTION_CBRT:
+			return eval_execute_math_function_single_param(ctx, token, output, error, cbrt);
+		case EVAL_FUNCTION_CEIL:
+			return eval_execute_math_function_single_param(ctx, token, output, error, ceil);
+		case EVAL_FUNCTION_EXP:
+			return eval_execute_math_function_single_param(ctx, token, output, error, exp);
+		case EVAL_FUNCTION_EXPM1:
+			return eval_execute_math_function_single_param(ctx, token, output, error, expm1);
+		case EVAL_FUNCTION_FLOOR:
+			return eval_execute_math_function_single_param(ctx, token, output, error, floor);
+		case EVAL_FUNCTION_SIGNUM:
+			return eval_execute_math_function_single_param(ctx, token, output, error, eval_math_func_signum);
+		case EVAL_FUNCTION_DEGREES:
+			return eval_execute_math_function_single_param(ctx, token, output, error,
+					eval_math_func_degrees);
+		case EVAL_FUNCTION_RADIANS:
+			return eval_execute_math_function_single_param(ctx, token, output, error,
+					eval_math_func_radians);
+		case EVAL_FUNCTION_ACOS:
+			return eval_execute_math_function_single_param(ctx, token, output, error, acos);
+		case EVAL_FUNCTION_ASIN:
+			return eval_execute_math_function_single_param(ctx, token, output, error, asin);
+		case EVAL_FUNCTION_ATAN:
+			return eval_execute_math_function_single_param(ctx, token, output, error, atan);
+		case EVAL_FUNCTION_COS:
+			return eval_execute_math_function_single_param(ctx, token, output, error, cos);
+		case EVAL_FUNCTION_COSH:
+			return eval_execute_math_function_single_param(ctx, token, output, error, cosh);
+		case EVAL_FUNCTION_COT:
+			return eval_execute_math_function_single_param(ctx, token, output, error, eval_math_func_cot);
+		case EVAL_FUNCTION_SIN:
+			return eval_execute_math_function_single_param(ctx, token, output, error, sin);
+		case EVAL_FUNCTION_SINH:
+			return eval_execute_math_function_single_param(ctx, token, output, error, sinh);
+		case EVAL_FUNCTION_TAN:
+			return eval_execute_math_function_single_param(ctx, token, output, error, tan);
+		case EVAL_FUNCTION_LOG:
+			return eval_execute_math_function_single_param(ctx, token, output, error, log);
+		case EVAL_FUNCTION_LOG10:
+			return eval_execute_math_function_single_param(ctx, token, output, error, log10);
+		case EVAL_FUNCTION_SQRT:
+			return eval_execute_math_function_single_param(ctx, token, output, error, sqrt);
+		case EVAL_FUNCTION_POWER:
+			return eval_execute_math_function_double_param(ctx, token, output, error, pow);
+		case EVAL_FUNCTION_ROUND:
+			return eval_execute_math_function_double_param(ctx, token, output, error, eval_math_func_round);
+		case EVAL_FUNCTION_MOD:
+			return eval_execute_math_function_double_param(ctx, token, output, error, fmod);
+		case EVAL_FUNCTION_TRUNCATE:
+			return eval_execute_math_function_double_param(ctx, token, output, error,
+					eval_math_func_truncate);
+		case EVAL_FUNCTION_ATAN2:
+			return eval_execute_math_function_double_param(ctx, token, output, error, atan2);
+		case EVAL_FUNCTION_PI:
+			return eval_execute_math_return_value(ctx, token, output, error, ZBX_MATH_CONST_PI);
+		case EVAL_FUNCTION_E:
+			return eval_execute_math_return_value(ctx, token, output, error, ZBX_MATH_CONST_E);
+		case EVAL_FUNCTION_RAND:
+			return eval_execute_math_return_value(ctx, token, output, error, ZBX_MATH_RANDOM);
+		case EVAL_FUNCTION_KURTOSIS:
+			return eval_execute_statistical_function(ctx, token, zbx_eval_calc_kurtosis, output, error);
+		case EVAL_FUNCTION_MAD:
+			return eval_execute_statistical_function(ctx, token, zbx_eval_calc_mad, output, error);
+		case EVAL_FUNCTION_SKEWNESS:
+			return eval_execute_statistical_function(ctx, token, zbx_eval_calc_skewness, output, error);
+		case EVAL_FUNCTION_STDDEVPOP:
+			return eval_execute_statistical_function(ctx, token, zbx_eval_calc_stddevpop, output, error);
+		case EVAL_FUNCTION_STDDEVSAMP:
+			return eval_execute_statistical_function(ctx, token, zbx_eval_calc_stddevsamp, output, error);
+		case EVAL_FUNCTION_SUMOFSQUARES:
+			return eval_execute_statistical_function(ctx, token, zbx_eval_calc_sumofsquares, output, error);
+		case EVAL_FUNCTION_VARPOP:
+			return eval_execute_statistical_function(ctx, token, zbx_eval_calc_varpop, output, error);
+		case EVAL_FUNCTION_VARSAMP:
+			return eval_execute_statistical_function(ctx, token, zbx_eval_calc_varsamp, output, error);
+		case EVAL_FUNCTION_COUNT:
+			return eval_execute_function_count(ctx, token, output, error);
+		case EVAL_FUNCTION_HISTOGRAM_QUANTILE:
+			return eval_execute_function_histogram_quantile(ctx, token, output, error);
+		case EVAL_FUNCTION_JSONPATH:
+			return eval_execute_function_jsonpath(ctx, token, output, error);
+		case EVAL_FUNCTION_XMLXPATH:
+			return eval_execute_function_xmlxpath(ctx, token, output, error);
+	}
 
 	if (NULL != ctx->common_func_cb)
 		return eval_execute_cb_function(ctx, token, ctx->common_func_cb, output, error);
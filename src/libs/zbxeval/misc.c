@@ -261,7 +261,7 @@ static const zbx_eval_token_t	*eval_get_next_function_token(const zbx_eval_conte
 		const zbx_eval_token_t	*token = &ctx->stack.values[i];
 		if (0 != (token->type & ZBX_EVAL_CLASS_FUNCTION))
 		{
-			if (token->opt < (zbx_uint32_t)(i - token_index))
+			if (ZBX_EVAL_FUNCTION_ARGS_NUM(token->opt) < (zbx_uint32_t)(i - token_index))
 				return NULL;
 
 			return &ctx->stack.values[i];
@@ -18,19 +18,52 @@
 **/
 
 #include "zbxexport.h"
+#include "export.h"
 
 #include "zbxcommon.h"
 #include "zbxstr.h"
 #include "zbxtypes.h"
+#include "zbxipcservice.h"
+
+#ifdef HAVE_ZLIB
+#include "zlib.h"
+#endif
 
 #define ZBX_OPTION_EXPTYPE_EVENTS	"events"
 #define ZBX_OPTION_EXPTYPE_HISTORY	"history"
 #define ZBX_OPTION_EXPTYPE_TRENDS	"trends"
 
+#define ZBX_OPTION_EXPCOMPRESSION_NONE	"none"
+#define ZBX_OPTION_EXPCOMPRESSION_GZIP	"gzip"
+
+#define ZBX_EXPORT_COMPRESSION_NONE	0
+#define ZBX_EXPORT_COMPRESSION_GZIP	1
+
+struct zbx_export_file
+{
+	char		*name;
+	FILE		*file;
+#ifdef HAVE_ZLIB
+	gzFile		gzfile;
+#endif
+	int		missing;
+	time_t		opened;
+
+	/* export writer number when data is sent to export writer, 0 when file is written directly */
+	int		writer;
+	zbx_uint32_t	code;
+
+	/* export data batch, sent to export writer or written to file on flush */
+	char		*buf;
+	size_t		buf_alloc;
+	size_t		buf_offset;
+};
+
 static zbx_get_export_file_f	get_history_file;
 static zbx_get_export_file_f	get_trends_file;
 static zbx_get_export_file_f	get_problems_file;
 static zbx_config_export_t	*config_export;
+static unsigned char		export_compression = ZBX_EXPORT_COMPRESSION_NONE;
 
 /******************************************************************************
  *                                                                            *
@@ -143,6 +176,34 @@ int	zbx_has_export_dir(void)
 	return NULL != config_export && NULL != config_export->dir;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parses export compression type                                    *
+ *                                                                            *
+ * Parameters: compression - [IN] compression option value                    *
+ *             type        - [OUT] compression type                           *
+ *                                                                            *
+ * Return value: SUCCEED - compression type is supported                      *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	parse_export_compression(const char *compression, unsigned char *type)
+{
+	if (NULL == compression || 0 == strcmp(compression, ZBX_OPTION_EXPCOMPRESSION_NONE))
+	{
+		*type = ZBX_EXPORT_COMPRESSION_NONE;
+		return SUCCEED;
+	}
+#ifdef HAVE_ZLIB
+	if (0 == strcmp(compression, ZBX_OPTION_EXPCOMPRESSION_GZIP))
+	{
+		*type = ZBX_EXPORT_COMPRESSION_GZIP;
+		return SUCCEED;
+	}
+#endif
+	return FAIL;
+}
+
 int	zbx_init_library_export(zbx_config_export_t *zbx_config_export, char **error)
 {
 	struct stat	fs;
@@ -185,6 +246,13 @@ int	zbx_init_library_export(zbx_config_export_t *zbx_config_export, char **error
 		return FAIL;
 	}
 
+	if (SUCCEED != parse_export_compression(zbx_config_export->compression, &export_compression))
+	{
+		*error = zbx_dsprintf(*error, "Unsupported \"ExportCompression\" value '%s'.",
+				zbx_config_export->compression);
+		return FAIL;
+	}
+
 	config_export = zbx_config_export;
 
 	return SUCCEED;
@@ -196,29 +264,140 @@ void	zbx_deinit_library_export(void)
 	{
 		zbx_free(config_export->dir);
 		zbx_free(config_export->type);
+		zbx_free(config_export->compression);
 	}
 	get_history_file = NULL;
 	get_trends_file = NULL;
 	get_problems_file = NULL;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns name of export writer IPC service                         *
+ *                                                                            *
+ * Parameters: writer - [IN] export writer number                             *
+ *                                                                            *
+ * Return value: service name, must be freed by caller                        *
+ *                                                                            *
+ ******************************************************************************/
+char	*export_writer_service_name(int writer)
+{
+	return zbx_dsprintf(NULL, "%s%d", ZBX_IPC_SERVICE_EXPORT_WRITER, writer);
+}
+
+static int	export_file_is_open(const zbx_export_file_t *file)
+{
+#ifdef HAVE_ZLIB
+	if (NULL != file->gzfile)
+		return SUCCEED;
+#endif
+	return NULL != file->file ? SUCCEED : FAIL;
+}
+
 static int	open_export_file(zbx_export_file_t *file, char **error)
 {
+#ifdef HAVE_ZLIB
+	if (ZBX_EXPORT_COMPRESSION_GZIP == export_compression)
+	{
+		/* appending to existing file starts new gzip member, concatenated members form valid gzip file */
+		if (NULL == (file->gzfile = gzopen(file->name, "ab")))
+		{
+			*error = zbx_dsprintf(*error, "cannot open export file '%s': %s", file->name,
+					zbx_strerror(errno));
+			return FAIL;
+		}
+
+		goto out;
+	}
+#endif
 	if (NULL == (file->file = fopen(file->name, "a")))
 	{
 		*error = zbx_dsprintf(*error, "cannot open export file '%s': %s", file->name, zbx_strerror(errno));
 		return FAIL;
 	}
+#ifdef HAVE_ZLIB
+out:
+#endif
+	file->opened = time(NULL);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "successfully created export file '%s'", file->name);
 
 	return SUCCEED;
 }
 
-static zbx_export_file_t	*export_init(const char *process_type, const char *process_name, int process_num)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: closes export file                                                *
+ *                                                                            *
+ * Return value: SUCCEED - file was closed successfully                       *
+ *               FAIL    - otherwise, errno is set                            *
+ *                                                                            *
+ ******************************************************************************/
+static int	close_export_file(zbx_export_file_t *file)
 {
-	char			*export_dir, *error = NULL;
-	zbx_export_file_t	*file = NULL;
+	int	ret = SUCCEED;
+
+#ifdef HAVE_ZLIB
+	if (NULL != file->gzfile)
+	{
+		if (Z_OK != gzclose(file->gzfile))
+			ret = FAIL;
+
+		file->gzfile = NULL;
+	}
+#endif
+	if (NULL != file->file)
+	{
+		if (0 != fclose(file->file))
+			ret = FAIL;
+
+		file->file = NULL;
+	}
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets current size of export file                                  *
+ *                                                                            *
+ * Comments: For compressed files the size does not include data buffered by  *
+ *           compression library.                                             *
+ *                                                                            *
+ ******************************************************************************/
+static int	get_export_file_size(zbx_export_file_t *file, zbx_uint64_t *size)
+{
+	long	offset;
+
+#ifdef HAVE_ZLIB
+	if (NULL != file->gzfile)
+		offset = (long)gzoffset(file->gzfile);
+	else
+#endif
+		offset = ftell(file->file);
+
+	if (-1 == offset)
+		return FAIL;
+
+	*size = (zbx_uint64_t)offset;
+
+	return SUCCEED;
+}
+
+static int	write_export_file(zbx_export_file_t *file, const char *buf, size_t count)
+{
+#ifdef HAVE_ZLIB
+	if (NULL != file->gzfile)
+		return (int)count == gzwrite(file->gzfile, buf, (unsigned int)count) ? SUCCEED : FAIL;
+#endif
+	return count == fwrite(buf, 1, count, file->file) ? SUCCEED : FAIL;
+}
+
+static zbx_export_file_t	*export_file_create(const char *process_type, const char *process_name,
+		int process_num)
+{
+	char			*export_dir;
+	zbx_export_file_t	*file;
 
 	if (NULL == config_export)
 	{
@@ -231,9 +410,31 @@ static zbx_export_file_t	*export_init(const char *process_type, const char *proc
 		export_dir[strlen(export_dir) - 1] = '\0';
 
 	file = (zbx_export_file_t *)zbx_malloc(NULL, sizeof(zbx_export_file_t));
-	file->name = zbx_dsprintf(NULL, "%s/%s-%s-%d.ndjson", export_dir, process_type, process_name, process_num);
+	memset(file, 0, sizeof(zbx_export_file_t));
 
-	free(export_dir);
+	file->name = zbx_dsprintf(NULL, "%s/%s-%s-%d.ndjson%s", export_dir, process_type, process_name, process_num,
+			ZBX_EXPORT_COMPRESSION_GZIP == export_compression ? ".gz" : "");
+
+	zbx_free(export_dir);
+
+	return file;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: opens export file written directly by the calling process         *
+ *                                                                            *
+ * Parameters: process_type - [IN] export type (history, trends, problems)    *
+ *             process_name - [IN] name of process writing the file           *
+ *             process_num  - [IN] number of process writing the file         *
+ *                                                                            *
+ ******************************************************************************/
+zbx_export_file_t	*export_file_open(const char *process_type, const char *process_name, int process_num)
+{
+	char			*error = NULL;
+	zbx_export_file_t	*file;
+
+	file = export_file_create(process_type, process_name, process_num);
 
 	if (FAIL == open_export_file(file, &error))
 	{
@@ -241,7 +442,43 @@ static zbx_export_file_t	*export_init(const char *process_type, const char *proc
 		exit(EXIT_FAILURE);
 	}
 
-	file->missing = 0;
+	return file;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initializes export of specified type for the calling process      *
+ *                                                                            *
+ * Parameters: process_type - [IN] export type (history, trends, problems)    *
+ *             process_name - [IN] name of process producing export data      *
+ *             process_num  - [IN] number of process producing export data    *
+ *             code         - [IN] export writer message code                 *
+ *                                                                            *
+ * Comments: When export writers are started the data is sent to export       *
+ *           writer selected by process number, otherwise it is written to    *
+ *           file directly. Main process (number 0) always writes directly as *
+ *           it exports the remaining data after export writers are stopped.  *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_export_file_t	*export_init(const char *process_type, const char *process_name, int process_num,
+		zbx_uint32_t code)
+{
+	zbx_export_file_t	*file;
+
+	if (NULL == config_export)
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "export library is not initialized");
+		exit(EXIT_FAILURE);
+	}
+
+	if (0 == process_num || 0 == config_export->writers_num)
+		return export_file_open(process_type, process_name, process_num);
+
+	file = (zbx_export_file_t *)zbx_malloc(NULL, sizeof(zbx_export_file_t));
+	memset(file, 0, sizeof(zbx_export_file_t));
+
+	file->writer = (process_num - 1) % config_export->writers_num + 1;
+	file->code = code;
 
 	return file;
 }
@@ -251,7 +488,7 @@ zbx_export_file_t	*zbx_history_export_init(zbx_get_export_file_f get_export_file
 {
 	get_history_file = get_export_file_cb;
 
-	return export_init("history", process_name, process_num);
+	return export_init("history", process_name, process_num, ZBX_IPC_EXPORT_HISTORY);
 }
 
 zbx_export_file_t	*zbx_trends_export_init(zbx_get_export_file_f get_export_file_cb, const char *process_name,
@@ -259,7 +496,7 @@ zbx_export_file_t	*zbx_trends_export_init(zbx_get_export_file_f get_export_file_
 {
 	get_trends_file = get_export_file_cb;
 
-	return export_init("trends", process_name, process_num);
+	return export_init("trends", process_name, process_num, ZBX_IPC_EXPORT_TRENDS);
 }
 
 zbx_export_file_t	*zbx_problems_export_init(zbx_get_export_file_f get_export_file_cb, const char *process_name,
@@ -267,24 +504,70 @@ zbx_export_file_t	*zbx_problems_export_init(zbx_get_export_file_f get_export_fil
 {
 	get_problems_file = get_export_file_cb;
 
-	return export_init("problems", process_name, process_num);
+	return export_init("problems", process_name, process_num, ZBX_IPC_EXPORT_PROBLEMS);
 }
 
 void	zbx_export_deinit(zbx_export_file_t *file)
 {
-	zbx_fclose(file->file);
+	if (0 == file->writer)
+		(void)close_export_file(file);
+
 	zbx_free(file->name);
+	zbx_free(file->buf);
 	zbx_free(file);
 }
 
-static void	export_write(const char *buf, size_t count, zbx_export_file_t *file)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: renames current export file to .old file and opens new file       *
+ *                                                                            *
+ ******************************************************************************/
+static int	rotate_export_file(zbx_export_file_t *file, char **error)
+{
+	char	filename_old[MAX_STRING_LEN];
+
+	zbx_strscpy(filename_old, file->name);
+	zbx_strlcat(filename_old, ".old", MAX_STRING_LEN);
+
+	if (0 == access(filename_old, F_OK) && 0 != remove(filename_old))
+	{
+		*error = zbx_dsprintf(*error, "cannot remove export file '%s': %s", filename_old,
+				zbx_strerror(errno));
+		return FAIL;
+	}
+
+	if (FAIL == close_export_file(file))
+	{
+		*error = zbx_dsprintf(*error, "cannot close export file %s': %s", file->name, zbx_strerror(errno));
+		return FAIL;
+	}
+
+	if (0 != rename(file->name, filename_old))
+	{
+		*error = zbx_dsprintf(*error, "cannot rename export file '%s': %s", file->name, zbx_strerror(errno));
+		return FAIL;
+	}
+
+	return open_export_file(file, error);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: writes data to export file, rotating it by size or time           *
+ *                                                                            *
+ * Parameters: file  - [IN] export file                                       *
+ *             buf   - [IN] data to write, newline separated JSON objects     *
+ *             count - [IN] data size                                         *
+ *                                                                            *
+ ******************************************************************************/
+void	export_file_write(zbx_export_file_t *file, const char *buf, size_t count)
 {
 #define ZBX_LOGGING_SUSPEND_TIME	10
 
 	static time_t	last_log_time = 0;
 	time_t		now;
 	char		*error_msg = NULL;
-	long		file_offset;
+	zbx_uint64_t	file_size;
 
 	if (NULL == config_export)
 	{
@@ -292,16 +575,18 @@ static void	export_write(const char *buf, size_t count, zbx_export_file_t *file)
 		exit(EXIT_FAILURE);
 	}
 
+	now = time(NULL);
+
 	if (0 == file->missing && 0 != access(file->name, F_OK))
 	{
-		if (NULL != file->file && 0 != fclose(file->file))
+		if (FAIL == close_export_file(file))
+		{
 			zabbix_log(LOG_LEVEL_DEBUG, "cannot close export file '%s': %s",file->name,
 					zbx_strerror(errno));
-
-		file->file = NULL;
+		}
 	}
 
-	if (NULL == file->file && FAIL == open_export_file(file, &error_msg))
+	if (FAIL == export_file_is_open(file) && FAIL == open_export_file(file, &error_msg))
 	{
 		file->missing = 1;
 		goto error;
@@ -313,48 +598,22 @@ static void	export_write(const char *buf, size_t count, zbx_export_file_t *file)
 		zabbix_log(LOG_LEVEL_ERR, "regained access to export file '%s'", file->name);
 	}
 
-	if (-1 == (file_offset = ftell(file->file)))
+	if (FAIL == get_export_file_size(file, &file_size))
 	{
 		error_msg = zbx_dsprintf(error_msg, "cannot get current position in export file '%s': %s",
 				file->name, zbx_strerror(errno));
 		goto error;
 	}
 
-	if (config_export->file_size <= count + (size_t)file_offset + 1)
+	if ((0 != count && config_export->file_size <= count + file_size) || (0 != file_size &&
+			0 != config_export->file_rotate_period &&
+			file->opened + config_export->file_rotate_period <= now))
 	{
-		char	filename_old[MAX_STRING_LEN];
-
-		zbx_strscpy(filename_old, file->name);
-		zbx_strlcat(filename_old, ".old", MAX_STRING_LEN);
-
-		if (0 == access(filename_old, F_OK) && 0 != remove(filename_old))
-		{
-			error_msg = zbx_dsprintf(error_msg, "cannot remove export file '%s': %s",
-					filename_old, zbx_strerror(errno));
-			goto error;
-		}
-
-		if (0 != fclose(file->file))
-		{
-			error_msg = zbx_dsprintf(error_msg, "cannot close export file %s': %s",
-					file->name, zbx_strerror(errno));
-			file->file = NULL;
-			goto error;
-		}
-		file->file = NULL;
-
-		if (0 != rename(file->name, filename_old))
-		{
-			error_msg = zbx_dsprintf(error_msg, "cannot rename export file '%s': %s",
-					file->name, zbx_strerror(errno));
-			goto error;
-		}
-
-		if (FAIL == open_export_file(file, &error_msg))
+		if (FAIL == rotate_export_file(file, &error_msg))
 			goto error;
 	}
 
-	if (count != fwrite(buf, 1, count, file->file) || '\n' != fputc('\n', file->file))
+	if (0 != count && FAIL == write_export_file(file, buf, count))
 	{
 		error_msg = zbx_dsprintf(error_msg, "cannot write to export file '%s': %s", file->name,
 				zbx_strerror(errno));
@@ -363,15 +622,12 @@ static void	export_write(const char *buf, size_t count, zbx_export_file_t *file)
 
 	return;
 error:
-	if (NULL != file->file && 0 != fclose(file->file))
+	if (FAIL == close_export_file(file))
 	{
 		error_msg = zbx_dsprintf(error_msg, "%s; cannot close export file %s': %s",
 				error_msg, file->name, zbx_strerror(errno));
 	}
 
-	file->file = NULL;
-	now = time(NULL);
-
 	if (ZBX_LOGGING_SUSPEND_TIME < now - last_log_time)
 	{
 		zabbix_log(LOG_LEVEL_ERR, "%s", error_msg);
@@ -383,6 +639,184 @@ error:
 #undef ZBX_LOGGING_SUSPEND_TIME
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: rotates export file when rotation period has expired              *
+ *                                                                            *
+ * Comments: Allows to rotate files not receiving new data. Empty files are   *
+ *           not rotated.                                                     *
+ *                                                                            *
+ ******************************************************************************/
+void	export_file_check_rotation(zbx_export_file_t *file)
+{
+	if (0 == config_export->file_rotate_period || FAIL == export_file_is_open(file))
+		return;
+
+	if (file->opened + config_export->file_rotate_period <= time(NULL))
+		export_file_write(file, NULL, 0);
+}
+
+void	export_file_flush(zbx_export_file_t *file)
+{
+#ifdef HAVE_ZLIB
+	if (NULL != file->gzfile)
+	{
+		if (Z_OK != gzflush(file->gzfile, Z_SYNC_FLUSH))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "cannot flush export file '%s': %s", file->name,
+					zbx_strerror(errno));
+		}
+
+		return;
+	}
+#endif
+	if (NULL != file->file && 0 != fflush(file->file))
+		zabbix_log(LOG_LEVEL_ERR, "cannot flush export file '%s': %s", file->name, zbx_strerror(errno));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sends batch of export data to export writer                       *
+ *                                                                            *
+ * Parameters: file  - [IN] export data batch                                 *
+ *             error - [OUT] error message                                    *
+ *                                                                            *
+ * Return value: SUCCEED - the data was sent                                  *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Each process has a permanent connection to one export writer.    *
+ *           If sending over existing connection fails, for example after     *
+ *           export writer was restarted, the connection is reopened and      *
+ *           sending is retried once.                                         *
+ *                                                                            *
+ ******************************************************************************/
+static int	export_writer_send(zbx_export_file_t *file, char **error)
+{
+#define ZBX_EXPORT_WRITER_CONNECT_TIMEOUT	1
+
+	static zbx_ipc_socket_t	socket;
+	char			*service_name;
+	int			ret;
+
+	if (0 != socket.fd)
+	{
+		if (SUCCEED == zbx_ipc_socket_write(&socket, file->code, (const unsigned char *)file->buf,
+				(zbx_uint32_t)file->buf_offset))
+		{
+			return SUCCEED;
+		}
+
+		zbx_ipc_socket_close(&socket);
+		socket.fd = 0;
+	}
+
+	/* export data producers must not be blocked for long when export writer is not running */
+	service_name = export_writer_service_name(file->writer);
+	ret = zbx_ipc_socket_open(&socket, service_name, ZBX_EXPORT_WRITER_CONNECT_TIMEOUT, error);
+	zbx_free(service_name);
+
+	if (FAIL == ret)
+	{
+		socket.fd = 0;
+		return FAIL;
+	}
+
+	if (FAIL == zbx_ipc_socket_write(&socket, file->code, (const unsigned char *)file->buf,
+			(zbx_uint32_t)file->buf_offset))
+	{
+		*error = zbx_strdup(*error, "cannot write to export writer socket");
+		zbx_ipc_socket_close(&socket);
+		socket.fd = 0;
+		return FAIL;
+	}
+
+	return SUCCEED;
+
+#undef ZBX_EXPORT_WRITER_CONNECT_TIMEOUT
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: counts export data batches that could not be sent to export       *
+ *          writer and reports them                                           *
+ *                                                                            *
+ * Parameters: file  - [IN] export data batch                                 *
+ *             error - [IN] error message, NULL if the batch was sent         *
+ *                                                                            *
+ * Comments: Failures are reported at most once in ZBX_LOGGING_SUSPEND_TIME   *
+ *           seconds. The amount of dropped data is reported again when       *
+ *           sending succeeds.                                                *
+ *                                                                            *
+ ******************************************************************************/
+static void	export_writer_report(const zbx_export_file_t *file, const char *error)
+{
+#define ZBX_LOGGING_SUSPEND_TIME	10
+
+	static time_t		last_log_time = 0;
+	static int		dropped_num = 0;
+	static zbx_uint64_t	dropped_size = 0;
+	time_t			now;
+
+	if (NULL == error)
+	{
+		if (0 != dropped_num)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "resumed sending export data to export writer #%d, dropped %d"
+					" batches (" ZBX_FS_UI64 " bytes)", file->writer, dropped_num, dropped_size);
+			dropped_num = 0;
+			dropped_size = 0;
+			last_log_time = 0;
+		}
+
+		return;
+	}
+
+	dropped_num++;
+	dropped_size += file->buf_offset;
+	now = time(NULL);
+
+	if (ZBX_LOGGING_SUSPEND_TIME < now - last_log_time)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot send export data to export writer #%d, dropped %d batches ("
+				ZBX_FS_UI64 " bytes) so far: %s", file->writer, dropped_num, dropped_size, error);
+		last_log_time = now;
+	}
+
+#undef ZBX_LOGGING_SUSPEND_TIME
+}
+
+static void	export_send(zbx_export_file_t *file)
+{
+	if (0 != file->writer)
+	{
+		char	*error = NULL;
+
+		if (FAIL == export_writer_send(file, &error))
+			export_writer_report(file, error);
+		else
+			export_writer_report(file, NULL);
+
+		zbx_free(error);
+	}
+	else
+		export_file_write(file, file->buf, file->buf_offset);
+
+	file->buf_offset = 0;
+}
+
+static void	export_write(const char *buf, size_t count, zbx_export_file_t *file)
+{
+#define ZBX_EXPORT_BATCH_SIZE	ZBX_MEBIBYTE
+
+	zbx_strncpy_alloc(&file->buf, &file->buf_alloc, &file->buf_offset, buf, count);
+	zbx_chrcpy_alloc(&file->buf, &file->buf_alloc, &file->buf_offset, '\n');
+
+	if (ZBX_EXPORT_BATCH_SIZE <= file->buf_offset)
+		export_send(file);
+
+#undef ZBX_EXPORT_BATCH_SIZE
+}
+
 void	zbx_problems_export_write(const char *buf, size_t count)
 {
 	export_write(buf, count, get_problems_file());
@@ -400,8 +834,14 @@ void	zbx_trends_export_write(const char *buf, size_t count)
 
 static void	export_flush(zbx_export_file_t *file)
 {
-	if (NULL != file && NULL != file->file && 0 != fflush(file->file))
-		zabbix_log(LOG_LEVEL_ERR, "cannot flush export file '%s': %s", file->name, zbx_strerror(errno));
+	if (NULL == file)
+		return;
+
+	if (0 != file->buf_offset)
+		export_send(file);
+
+	if (0 == file->writer)
+		export_file_flush(file);
 }
 
 void	zbx_problems_export_flush(void)
@@ -0,0 +1,39 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#ifndef ZABBIX_EXPORT_EXPORT_H
+#define ZABBIX_EXPORT_EXPORT_H
+
+#include "zbxexport.h"
+
+#define ZBX_IPC_SERVICE_EXPORT_WRITER	"export"
+
+#define ZBX_IPC_EXPORT_PROBLEMS		0
+#define ZBX_IPC_EXPORT_HISTORY		1
+#define ZBX_IPC_EXPORT_TRENDS		2
+#define ZBX_IPC_EXPORT_COUNT		3
+
+char			*export_writer_service_name(int writer);
+
+zbx_export_file_t	*export_file_open(const char *process_type, const char *process_name, int process_num);
+void			export_file_write(zbx_export_file_t *file, const char *buf, size_t count);
+void			export_file_flush(zbx_export_file_t *file);
+void			export_file_check_rotation(zbx_export_file_t *file);
+
+#endif
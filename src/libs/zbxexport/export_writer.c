@@ -0,0 +1,190 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxexport.h"
+#include "export.h"
+
+#include "zbxcommon.h"
+#include "zbxipcservice.h"
+#include "zbxlog.h"
+#include "zbxnix.h"
+#include "zbxself.h"
+#include "zbxtime.h"
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: writes received export data batch to the corresponding file       *
+ *                                                                            *
+ * Parameters: files   - [IN] export files by message code                    *
+ *             message - [IN] export data batch                               *
+ *                                                                            *
+ * Return value: SUCCEED - data was written                                   *
+ *               FAIL    - unknown or disabled export type                    *
+ *                                                                            *
+ ******************************************************************************/
+static int	export_writer_process_message(zbx_export_file_t **files, const zbx_ipc_message_t *message)
+{
+	if (ZBX_IPC_EXPORT_COUNT <= message->code || NULL == files[message->code])
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		return FAIL;
+	}
+
+	export_file_write(files[message->code], (const char *)message->data, message->size);
+
+	return SUCCEED;
+}
+
+static void	export_writer_flush(zbx_export_file_t **files)
+{
+	for (int i = 0; i < ZBX_IPC_EXPORT_COUNT; i++)
+	{
+		if (NULL == files[i])
+			continue;
+
+		export_file_flush(files[i]);
+		export_file_check_rotation(files[i]);
+	}
+}
+
+ZBX_THREAD_ENTRY(zbx_export_writer_thread, args)
+{
+#define ZBX_EXPORT_WRITER_DELAY		1
+#define ZBX_EXPORT_WRITER_FLUSH_DELAY	1
+#define	STAT_INTERVAL	5	/* if a process is busy and does not sleep then update status not faster than */
+				/* once in STAT_INTERVAL seconds */
+
+	zbx_ipc_service_t	service;
+	char			*error = NULL, *service_name;
+	zbx_ipc_client_t	*client;
+	zbx_ipc_message_t	*message;
+	zbx_export_file_t	*files[ZBX_IPC_EXPORT_COUNT] = {0};
+	int			ret, batches_num = 0;
+	zbx_uint64_t		written = 0;
+	double			time_stat, time_idle = 0, time_now, time_flush, sec;
+	zbx_timespec_t		timeout = {ZBX_EXPORT_WRITER_DELAY, 0}, nowait = {0, 0};
+	const zbx_thread_info_t	*info = &((zbx_thread_args_t *)args)->info;
+	int			server_num = ((zbx_thread_args_t *)args)->info.server_num;
+	int			process_num = ((zbx_thread_args_t *)args)->info.process_num;
+	unsigned char		process_type = ((zbx_thread_args_t *)args)->info.process_type;
+
+	zabbix_log(LOG_LEVEL_INFORMATION, "%s #%d started [%s #%d]", get_program_type_string(info->program_type),
+			server_num, get_process_type_string(process_type), process_num);
+
+	zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_BUSY);
+
+	service_name = export_writer_service_name(process_num);
+
+	if (FAIL == zbx_ipc_service_start(&service, service_name, &error))
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "cannot start export writer service: %s", error);
+		zbx_free(error);
+		exit(EXIT_FAILURE);
+	}
+
+	zbx_free(service_name);
+
+	if (SUCCEED == zbx_is_export_enabled(ZBX_FLAG_EXPTYPE_EVENTS))
+		files[ZBX_IPC_EXPORT_PROBLEMS] = export_file_open("problems", "export-writer", process_num);
+
+	if (SUCCEED == zbx_is_export_enabled(ZBX_FLAG_EXPTYPE_HISTORY))
+		files[ZBX_IPC_EXPORT_HISTORY] = export_file_open("history", "export-writer", process_num);
+
+	if (SUCCEED == zbx_is_export_enabled(ZBX_FLAG_EXPTYPE_TRENDS))
+		files[ZBX_IPC_EXPORT_TRENDS] = export_file_open("trends", "export-writer", process_num);
+
+	zbx_setproctitle("%s #%d started", get_process_type_string(process_type), process_num);
+
+	time_stat = time_flush = zbx_time();
+
+	while (ZBX_IS_RUNNING())
+	{
+		time_now = zbx_time();
+
+		if (STAT_INTERVAL < time_now - time_stat)
+		{
+			zbx_setproctitle("%s #%d [exported %d batches (" ZBX_FS_UI64 " bytes), idle " ZBX_FS_DBL
+					" sec during " ZBX_FS_DBL " sec]", get_process_type_string(process_type),
+					process_num, batches_num, written, time_idle, time_now - time_stat);
+
+			time_stat = time_now;
+			time_idle = 0;
+			batches_num = 0;
+			written = 0;
+		}
+
+		zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_IDLE);
+		ret = zbx_ipc_service_recv(&service, &timeout, &client, &message);
+		zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_BUSY);
+		sec = zbx_time();
+		zbx_update_env(get_process_type_string(process_type), sec);
+
+		if (ZBX_IPC_RECV_IMMEDIATE != ret)
+			time_idle += sec - time_now;
+
+		if (NULL != message)
+		{
+			if (SUCCEED == export_writer_process_message(files, message))
+			{
+				batches_num++;
+				written += message->size;
+			}
+
+			zbx_ipc_message_free(message);
+		}
+
+		if (NULL != client)
+			zbx_ipc_client_release(client);
+
+		if (ZBX_EXPORT_WRITER_FLUSH_DELAY <= sec - time_flush)
+		{
+			export_writer_flush(files);
+			time_flush = sec;
+		}
+	}
+
+	/* write data already received from clients */
+	while (ZBX_IPC_RECV_TIMEOUT != zbx_ipc_service_recv(&service, &nowait, &client, &message))
+	{
+		if (NULL != message)
+		{
+			(void)export_writer_process_message(files, message);
+			zbx_ipc_message_free(message);
+		}
+
+		if (NULL != client)
+			zbx_ipc_client_release(client);
+	}
+
+	for (int i = 0; i < ZBX_IPC_EXPORT_COUNT; i++)
+	{
+		if (NULL == files[i])
+			continue;
+
+		export_file_flush(files[i]);
+		zbx_export_deinit(files[i]);
+	}
+
+	zbx_ipc_service_close(&service);
+
+	exit(EXIT_SUCCESS);
+#undef ZBX_EXPORT_WRITER_DELAY
+#undef ZBX_EXPORT_WRITER_FLUSH_DELAY
+#undef STAT_INTERVAL
+}
@@ -637,12 +637,9 @@ int	zbx_evaluatable_for_notsupported(const char *fn)
 static int	get_last_n_value(const zbx_dc_evaluate_item_t *item, const char *parameters, const zbx_timespec_t *ts,
 		zbx_history_record_t *value, char **error)
 {
-	int				arg1 = 1, ret = FAIL, time_shift;
-	zbx_value_type_t		arg1_type = ZBX_VALUE_NVALUES;
-	zbx_vector_history_record_t	values;
-	zbx_timespec_t			ts_end = *ts;
-
-	zbx_history_record_vector_create(&values);
+	int			arg1 = 1, ret = FAIL, time_shift, values_num;
+	zbx_value_type_t	arg1_type = ZBX_VALUE_NVALUES;
+	zbx_timespec_t		ts_end = *ts;
 
 	if (SUCCEED != get_function_parameter_hist_range(ts->sec, parameters, 1, &arg1, &arg1_type, &time_shift))
 	{
@@ -655,23 +652,25 @@ static int	get_last_n_value(const zbx_dc_evaluate_item_t *item, const char *para
 
 	ts_end.sec -= time_shift;
 
-	if (SUCCEED != zbx_vc_get_values(item->itemid, item->value_type, &values, 0, arg1, &ts_end))
+	/* the Nth last value is the oldest value of the last N values */
+	if (SUCCEED != zbx_vc_aggregate(item->itemid, item->value_type, ZBX_VC_AGGREGATE_FIRST, 0, 0, arg1, &ts_end,
+			value, &values_num))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
 		goto out;
 	}
 
-	if (arg1 <= values.values_num)
+	if (arg1 > values_num)
 	{
-		*value = values.values[arg1 - 1];
-		zbx_vector_history_record_remove(&values, arg1 - 1);
-		ret = SUCCEED;
-	}
-	else
+		if (0 != values_num)
+			zbx_history_record_clear(value, item->value_type);
+
 		*error = zbx_strdup(*error, "not enough data");
-out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
+		goto out;
+	}
 
+	ret = SUCCEED;
+out:
 	return ret;
 }
 
@@ -1077,7 +1076,8 @@ int	zbx_execute_count_with_pattern(char *pattern, unsigned char value_type, zbx_
 static int	evaluate_COUNT(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item, const char *parameters,
 		const zbx_timespec_t *ts, int limit, int unique, char **error)
 {
-	int				arg1, nparams, count = 0, ret = FAIL, seconds = 0, nvalues = 0, time_shift;
+	int				arg1, nparams, count = 0, ret = FAIL, seconds = 0, nvalues = 0, time_shift,
+					values_num;
 	char				*operator = NULL, *pattern = NULL;
 	zbx_value_type_t		arg1_type;
 	zbx_vector_history_record_t	values;
@@ -1137,40 +1137,57 @@ static int	evaluate_COUNT(zbx_variant_t *value, const zbx_dc_evaluate_item_t *it
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	/* count values directly in cache if they are neither filtered nor deduplicated */
+	if (OP_ANY == pdata.op && COUNT_UNIQUE != unique)
 	{
-		*error = zbx_strdup(*error, "cannot get values from value cache");
-		goto clean;
-	}
+		zbx_history_record_t	result;
 
-	if (COUNT_UNIQUE == unique)
+		if (FAIL == zbx_vc_aggregate(item->itemid, item->value_type, ZBX_VC_AGGREGATE_COUNT, 0, seconds,
+				nvalues, &ts_end, &result, &values_num))
+		{
+			*error = zbx_strdup(*error, "cannot get values from value cache");
+			goto clean;
+		}
+	}
+	else
 	{
-		switch (item->value_type)
+		if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
 		{
-			case ITEM_VALUE_TYPE_UINT64:
-				zbx_vector_history_record_sort(&values,
-						(zbx_compare_func_t)history_record_uint64_compare);
-				zbx_vector_history_record_uniq(&values,
-						(zbx_compare_func_t)history_record_uint64_compare);
-				break;
-			case ITEM_VALUE_TYPE_FLOAT:
-				zbx_vector_history_record_sort(&values,
-						(zbx_compare_func_t)zbx_history_record_float_compare);
-				zbx_vector_history_record_uniq(&values,
-						(zbx_compare_func_t)zbx_history_record_float_compare);
-				break;
-			case ITEM_VALUE_TYPE_LOG:
-				zbx_vector_history_record_sort(&values,
-						(zbx_compare_func_t)history_record_log_compare);
-				zbx_vector_history_record_log_uniq(&values,
-						(zbx_compare_func_t)history_record_log_compare);
-				break;
-			default:
-				zbx_vector_history_record_sort(&values,
-						(zbx_compare_func_t)history_record_str_compare);
-				zbx_vector_history_record_str_uniq(&values,
-						(zbx_compare_func_t)history_record_str_compare);
+			*error = zbx_strdup(*error, "cannot get values from value cache");
+			goto clean;
 		}
+
+		if (COUNT_UNIQUE == unique)
+		{
+			switch (item->value_type)
+			{
+				case ITEM_VALUE_TYPE_UINT64:
+					zbx_vector_history_record_sort(&values,
+							(zbx_compare_func_t)history_record_uint64_compare);
+					zbx_vector_history_record_uniq(&values,
+							(zbx_compare_func_t)history_record_uint64_compare);
+					break;
+				case ITEM_VALUE_TYPE_FLOAT:
+					zbx_vector_history_record_sort(&values,
+							(zbx_compare_func_t)zbx_history_record_float_compare);
+					zbx_vector_history_record_uniq(&values,
+							(zbx_compare_func_t)zbx_history_record_float_compare);
+					break;
+				case ITEM_VALUE_TYPE_LOG:
+					zbx_vector_history_record_sort(&values,
+							(zbx_compare_func_t)history_record_log_compare);
+					zbx_vector_history_record_log_uniq(&values,
+							(zbx_compare_func_t)history_record_log_compare);
+					break;
+				default:
+					zbx_vector_history_record_sort(&values,
+							(zbx_compare_func_t)history_record_str_compare);
+					zbx_vector_history_record_str_uniq(&values,
+							(zbx_compare_func_t)history_record_str_compare);
+			}
+		}
+
+		values_num = values.values_num;
 	}
 
 	/* skip counting values one by one if filter matches any value */
@@ -1184,7 +1201,7 @@ static int	evaluate_COUNT(zbx_variant_t *value, const zbx_dc_evaluate_item_t *it
 	}
 	else
 	{
-		if ((count = values.values_num) > limit)
+		if ((count = values_num) > limit)
 			count = limit;
 	}
 
@@ -1222,16 +1239,13 @@ out:
 static int	evaluate_SUM(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item, const char *parameters,
 		const zbx_timespec_t *ts, char **error)
 {
-	int				arg1, i, ret = FAIL, seconds = 0, nvalues = 0, time_shift;
-	zbx_value_type_t		arg1_type;
-	zbx_vector_history_record_t	values;
-	zbx_history_value_t		result;
-	zbx_timespec_t			ts_end = *ts;
+	int			arg1, ret = FAIL, seconds = 0, nvalues = 0, time_shift, values_num;
+	zbx_value_type_t	arg1_type;
+	zbx_history_record_t	result;
+	zbx_timespec_t		ts_end = *ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
-
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
 		*error = zbx_strdup(*error, "invalid value type");
@@ -1265,32 +1279,16 @@ static int	evaluate_SUM(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (FAIL == zbx_vc_aggregate(item->itemid, item->value_type, ZBX_VC_AGGREGATE_SUM, 0, seconds, nvalues, &ts_end,
+			&result, &values_num))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
 		goto out;
 	}
 
-	if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
-	{
-		result.dbl = 0;
-
-		for (i = 0; i < values.values_num; i++)
-			result.dbl += values.values[i].value.dbl;
-	}
-	else
-	{
-		result.ui64 = 0;
-
-		for (i = 0; i < values.values_num; i++)
-			result.ui64 += values.values[i].value.ui64;
-	}
-
-	zbx_history_value2variant(&result, item->value_type, value);
+	zbx_history_value2variant(&result.value, item->value_type, value);
 	ret = SUCCEED;
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
-
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
 	return ret;
@@ -1314,15 +1312,13 @@ out:
 static int	evaluate_AVG(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item, const char *parameters,
 		const zbx_timespec_t *ts, char **error)
 {
-	int				arg1, ret = FAIL, i, seconds = 0, nvalues = 0, time_shift;
-	zbx_value_type_t		arg1_type;
-	zbx_vector_history_record_t	values;
-	zbx_timespec_t			ts_end = *ts;
+	int			arg1, ret = FAIL, seconds = 0, nvalues = 0, time_shift, values_num;
+	zbx_value_type_t	arg1_type;
+	zbx_history_record_t	result;
+	zbx_timespec_t		ts_end = *ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
-
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
 		*error = zbx_strdup(*error, "invalid value type");
@@ -1356,29 +1352,16 @@ static int	evaluate_AVG(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (FAIL == zbx_vc_aggregate(item->itemid, item->value_type, ZBX_VC_AGGREGATE_AVG, 0, seconds, nvalues, &ts_end,
+			&result, &values_num))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
 		goto out;
 	}
 
-	if (0 < values.values_num)
+	if (0 < values_num)
 	{
-		double	avg = 0;
-
-		if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
-		{
-			for (i = 0; i < values.values_num; i++)
-				avg += values.values[i].value.dbl / (i + 1) - avg / (i + 1);
-		}
-		else
-		{
-			for (i = 0; i < values.values_num; i++)
-				avg += (double)values.values[i].value.ui64;
-
-			avg = avg / values.values_num;
-		}
-		zbx_variant_set_dbl(value, avg);
+		zbx_variant_set_dbl(value, result.value.dbl);
 
 		ret = SUCCEED;
 	}
@@ -1388,8 +1371,6 @@ static int	evaluate_AVG(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item
 		*error = zbx_strdup(*error, "not enough data");
 	}
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
-
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
 	return ret;
@@ -1432,17 +1413,6 @@ static int	evaluate_LAST(zbx_variant_t *value, const zbx_dc_evaluate_item_t *ite
 #define EVALUATE_MIN	0
 #define EVALUATE_MAX	1
 
-#define LOOP_FIND_MIN_OR_MAX(type, mode_op)							\
-	do											\
-	{											\
-		for (i = 1; i < values.values_num; i++)							\
-		{											\
-			if (values.values[i].value.type mode_op values.values[index].value.type)	\
-				index = i;								\
-		}											\
-	}												\
-	while(0)
-
 /******************************************************************************
  *                                                                            *
  * Purpose: evaluate function 'min' or 'max' for the item.                    *
@@ -1462,15 +1432,13 @@ static int	evaluate_LAST(zbx_variant_t *value, const zbx_dc_evaluate_item_t *ite
 static int	evaluate_MIN_or_MAX(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item, const char *parameters,
 		const zbx_timespec_t *ts, char **error, int min_or_max)
 {
-	int				arg1, i, ret = FAIL, seconds = 0, nvalues = 0, time_shift;
-	zbx_value_type_t		arg1_type;
-	zbx_vector_history_record_t	values;
-	zbx_timespec_t			ts_end = *ts;
+	int			arg1, ret = FAIL, seconds = 0, nvalues = 0, time_shift, values_num;
+	zbx_value_type_t	arg1_type;
+	zbx_history_record_t	result;
+	zbx_timespec_t		ts_end = *ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
-
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
 		*error = zbx_strdup(*error, "invalid value type");
@@ -1504,40 +1472,17 @@ static int	evaluate_MIN_or_MAX(zbx_variant_t *value, const zbx_dc_evaluate_item_
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (FAIL == zbx_vc_aggregate(item->itemid, item->value_type,
+			EVALUATE_MIN == min_or_max ? ZBX_VC_AGGREGATE_MIN : ZBX_VC_AGGREGATE_MAX, 0, seconds, nvalues,
+			&ts_end, &result, &values_num))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
 		goto out;
 	}
 
-	if (0 < values.values_num)
+	if (0 < values_num)
 	{
-		int	index = 0;
-
-		if (ITEM_VALUE_TYPE_UINT64 == item->value_type)
-		{
-			if (EVALUATE_MIN == min_or_max)
-			{
-				LOOP_FIND_MIN_OR_MAX(ui64, <);
-			}
-			else
-			{
-				LOOP_FIND_MIN_OR_MAX(ui64, >);
-			}
-		}
-		else
-		{
-			if (EVALUATE_MIN == min_or_max)
-			{
-				LOOP_FIND_MIN_OR_MAX(dbl, <);
-			}
-			else
-			{
-				LOOP_FIND_MIN_OR_MAX(dbl, >);
-			}
-		}
-
-		zbx_history_value2variant(&values.values[index].value, item->value_type, value);
+		zbx_history_value2variant(&result.value, item->value_type, value);
 		ret = SUCCEED;
 	}
 	else
@@ -1546,8 +1491,6 @@ static int	evaluate_MIN_or_MAX(zbx_variant_t *value, const zbx_dc_evaluate_item_
 		*error = zbx_strdup(*error, "not enough data");
 	}
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
-
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
 	return ret;
@@ -1572,16 +1515,14 @@ out:
 static int	evaluate_PERCENTILE(zbx_variant_t  *value, const zbx_dc_evaluate_item_t *item, const char *parameters,
 		const zbx_timespec_t *ts, char **error)
 {
-	int				arg1, time_shift, ret = FAIL, seconds = 0, nvalues = 0;
-	zbx_value_type_t		arg1_type;
-	double				percentage;
-	zbx_vector_history_record_t	values;
-	zbx_timespec_t			ts_end = *ts;
+	int			arg1, time_shift, ret = FAIL, seconds = 0, nvalues = 0, values_num;
+	zbx_value_type_t	arg1_type;
+	double			percentage;
+	zbx_history_record_t	result;
+	zbx_timespec_t		ts_end = *ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
-
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
 		*error = zbx_strdup(*error, "invalid value type");
@@ -1622,27 +1563,16 @@ static int	evaluate_PERCENTILE(zbx_variant_t  *value, const zbx_dc_evaluate_item
 		goto out;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (FAIL == zbx_vc_aggregate(item->itemid, item->value_type, ZBX_VC_AGGREGATE_PERCENTILE, percentage,
+			seconds, nvalues, &ts_end, &result, &values_num))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
 		goto out;
 	}
 
-	if (0 < values.values_num)
+	if (0 < values_num)
 	{
-		int	index;
-
-		if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
-			zbx_vector_history_record_sort(&values, (zbx_compare_func_t)zbx_history_record_float_compare);
-		else
-			zbx_vector_history_record_sort(&values, (zbx_compare_func_t)history_record_uint64_compare);
-
-		if (0 == percentage)
-			index = 1;
-		else
-			index = (int)ceil(values.values_num * (percentage / 100));
-
-		zbx_history_value2variant(&values.values[index - 1].value, item->value_type, value);
+		zbx_history_value2variant(&result.value, item->value_type, value);
 
 		ret = SUCCEED;
 	}
@@ -1652,8 +1582,6 @@ static int	evaluate_PERCENTILE(zbx_variant_t  *value, const zbx_dc_evaluate_item
 		*error = zbx_strdup(*error, "not enough data");
 	}
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
-
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
 	return ret;
@@ -1675,17 +1603,15 @@ out:
 static int	evaluate_NODATA(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item, const char *parameters,
 		char **error)
 {
-	int				arg1, num, period, lazy = 1, ret = FAIL;
-	zbx_value_type_t		arg1_type;
-	zbx_vector_history_record_t	values;
-	zbx_timespec_t			ts;
-	char				*arg2 = NULL;
-	zbx_proxy_suppress_t		nodata_win;
+	int			arg1, num, period, lazy = 1, ret = FAIL, values_num;
+	zbx_value_type_t	arg1_type;
+	zbx_history_record_t	result;
+	zbx_timespec_t		ts;
+	char			*arg2 = NULL;
+	zbx_proxy_suppress_t	nodata_win;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
-
 	if (2 < (num = zbx_function_param_parse_count(parameters)))
 	{
 		*error = zbx_strdup(*error, "invalid number of parameters");
@@ -1724,8 +1650,8 @@ static int	evaluate_NODATA(zbx_variant_t *value, const zbx_dc_evaluate_item_t *i
 	else
 		period = arg1;
 
-	if (SUCCEED == zbx_vc_get_values(item->itemid, item->value_type, &values, period, 1, &ts) &&
-			1 == values.values_num)
+	if (SUCCEED == zbx_vc_aggregate(item->itemid, item->value_type, ZBX_VC_AGGREGATE_COUNT, 0, period, 1, &ts,
+			&result, &values_num) && 1 == values_num)
 	{
 		zbx_variant_set_dbl(value, 0);
 	}
@@ -1763,7 +1689,6 @@ static int	evaluate_NODATA(zbx_variant_t *value, const zbx_dc_evaluate_item_t *i
 
 	ret = SUCCEED;
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
 	zbx_free(arg2);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
@@ -1787,57 +1712,34 @@ out:
 static int	evaluate_CHANGE(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item, const zbx_timespec_t *ts,
 		char **error)
 {
-	int				ret = FAIL;
-	zbx_vector_history_record_t	values;
-	double				result;
+	int			ret = FAIL, values_num;
+	zbx_history_record_t	result;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
-
-	if (SUCCEED != zbx_vc_get_values(item->itemid, item->value_type, &values, 0, 2, ts) ||
-			2 > values.values_num)
-	{
-		*error = zbx_strdup(*error, "cannot get values from value cache");
-		goto out;
-	}
-
 	switch (item->value_type)
 	{
 		case ITEM_VALUE_TYPE_FLOAT:
-			result = values.values[0].value.dbl - values.values[1].value.dbl;
-			break;
 		case ITEM_VALUE_TYPE_UINT64:
-			/* to avoid overflow */
-			if (values.values[0].value.ui64 >= values.values[1].value.ui64)
-				result = values.values[0].value.ui64 - values.values[1].value.ui64;
-			else
-				result = -(double)(values.values[1].value.ui64 - values.values[0].value.ui64);
-			break;
 		case ITEM_VALUE_TYPE_LOG:
-			if (0 == strcmp(values.values[0].value.log->value, values.values[1].value.log->value))
-				result = 0;
-			else
-				result = 1;
-			break;
-
 		case ITEM_VALUE_TYPE_STR:
 		case ITEM_VALUE_TYPE_TEXT:
-			if (0 == strcmp(values.values[0].value.str, values.values[1].value.str))
-				result = 0;
-			else
-				result = 1;
 			break;
 		default:
 			*error = zbx_strdup(*error, "invalid value type");
 			goto out;
 	}
 
-	zbx_variant_set_dbl(value, result);
+	if (SUCCEED != zbx_vc_aggregate(item->itemid, item->value_type, ZBX_VC_AGGREGATE_CHANGE, 0, 0, 2, ts, &result,
+			&values_num) || 2 > values_num)
+	{
+		*error = zbx_strdup(*error, "cannot get values from value cache");
+		goto out;
+	}
+
+	zbx_variant_set_dbl(value, result.value.dbl);
 	ret = SUCCEED;
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
-
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
 	return ret;
@@ -2616,15 +2518,13 @@ static int	validate_params_and_get_data(const zbx_dc_evaluate_item_t *item, cons
 static int	evaluate_FIRST(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item, const char *parameters,
 		const zbx_timespec_t *ts, char **error)
 {
-	int				arg1 = 1, ret = FAIL, seconds = 0, time_shift;
-	zbx_value_type_t		arg1_type = ZBX_VALUE_NVALUES;
-	zbx_vector_history_record_t	values;
-	zbx_timespec_t			ts_end = *ts;
+	int			arg1 = 1, ret = FAIL, seconds = 0, time_shift, values_num;
+	zbx_value_type_t	arg1_type = ZBX_VALUE_NVALUES;
+	zbx_history_record_t	result;
+	zbx_timespec_t		ts_end = *ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
-
 	if (1 != zbx_function_param_parse_count(parameters))
 	{
 		*error = zbx_strdup(*error, "invalid number of parameters");
@@ -2662,11 +2562,13 @@ static int	evaluate_FIRST(zbx_variant_t *value, const zbx_dc_evaluate_item_t *it
 
 	ts_end.sec -= time_shift;
 
-	if (SUCCEED == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, 0, &ts_end))
+	if (SUCCEED == zbx_vc_aggregate(item->itemid, item->value_type, ZBX_VC_AGGREGATE_FIRST, 0, seconds, 0,
+			&ts_end, &result, &values_num))
 	{
-		if (0 < values.values_num)
+		if (0 < values_num)
 		{
-			zbx_history_value2variant(&values.values[values.values_num - 1].value, item->value_type, value);
+			zbx_history_value2variant(&result.value, item->value_type, value);
+			zbx_history_record_clear(&result, item->value_type);
 			ret = SUCCEED;
 		}
 		else
@@ -2678,8 +2580,6 @@ static int	evaluate_FIRST(zbx_variant_t *value, const zbx_dc_evaluate_item_t *it
 	else
 		*error = zbx_strdup(*error, "cannot get values from value cache");
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
-
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
 	return ret;
@@ -275,6 +275,16 @@ static int	func_compare_func(const void *d1, const void *d2)
 	return 0;
 }
 
+static int	func_compare_by_itemid(const void *d1, const void *d2)
+{
+	const zbx_func_t	*func1 = *(const zbx_func_t * const *)d1;
+	const zbx_func_t	*func2 = *(const zbx_func_t * const *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(func1->itemid, func2->itemid);
+
+	return 0;
+}
+
 static void	func_clean(void *ptr)
 {
 	zbx_func_t	*func = (zbx_func_t *)ptr;
@@ -362,27 +372,54 @@ static void	zbx_populate_function_items(const zbx_vector_uint64_t *functionids,
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() ifuncs_num:%d", __func__, ifuncs->num_data);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: evaluate unique trigger functions                                 *
+ *                                                                            *
+ * Parameters: funcs            - [IN/OUT] functions to evaluate              *
+ *             history_itemids  - [IN] identifiers of items with history      *
+ *                                     values in the current batch            *
+ *             history_items    - [IN] items with history values              *
+ *             history_errcodes - [IN] item error codes                       *
+ *             items            - [OUT] other items used in functions         *
+ *             items_err        - [OUT] other item error codes                *
+ *             items_num        - [OUT] number of other items                 *
+ *                                                                            *
+ * Comments: Functions are evaluated grouped by items, so all functions of    *
+ *           the same item are calculated one after another while its values  *
+ *           are still hot in value cache and the item is resolved only once. *
+ *                                                                            *
+ ******************************************************************************/
 static void	zbx_evaluate_item_functions(zbx_hashset_t *funcs, const zbx_vector_uint64_t *history_itemids,
 		const zbx_history_sync_item_t *history_items, const int *history_errcodes,
 		zbx_history_sync_item_t **items, int **items_err, int *items_num)
 {
-	char			*error = NULL;
-	int			i;
-	zbx_func_t		*func;
-	zbx_vector_uint64_t	itemids;
-	zbx_hashset_iter_t	iter;
+	char				*error = NULL;
+	int				i, errcode = FAIL;
+	zbx_uint64_t			itemid = 0;
+	zbx_func_t			*func;
+	zbx_vector_uint64_t		itemids;
+	zbx_vector_ptr_t		funcs_sorted;
+	zbx_hashset_iter_t		iter;
+	const zbx_history_sync_item_t	*item = NULL;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() funcs_num:%d", __func__, funcs->num_data);
 
 	zbx_vector_uint64_create(&itemids);
+	zbx_vector_ptr_create(&funcs_sorted);
+	zbx_vector_ptr_reserve(&funcs_sorted, (size_t)funcs->num_data);
 
 	zbx_hashset_iter_reset(funcs, &iter);
 	while (NULL != (func = (zbx_func_t *)zbx_hashset_iter_next(&iter)))
 	{
+		zbx_vector_ptr_append(&funcs_sorted, func);
+
 		if (FAIL == zbx_vector_uint64_bsearch(history_itemids, func->itemid, ZBX_DEFAULT_UINT64_COMPARE_FUNC))
 			zbx_vector_uint64_append(&itemids, func->itemid);
 	}
 
+	zbx_vector_ptr_sort(&funcs_sorted, func_compare_by_itemid);
+
 	if (0 != itemids.values_num)
 	{
 		zbx_vector_uint64_sort(&itemids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
@@ -397,26 +434,32 @@ static void	zbx_evaluate_item_functions(zbx_hashset_t *funcs, const zbx_vector_u
 				(size_t)itemids.values_num, ZBX_ITEM_GET_SYNC);
 	}
 
-	zbx_hashset_iter_reset(funcs, &iter);
-	while (NULL != (func = (zbx_func_t *)zbx_hashset_iter_next(&iter)))
+	for (int j = 0; j < funcs_sorted.values_num; j++)
 	{
-		int				errcode, ret;
-		const zbx_history_sync_item_t	*item;
-		char				*params;
-		zbx_dc_evaluate_item_t		evaluate_item;
-
-		/* avoid double copying from configuration cache if already retrieved when saving history */
-		if (FAIL != (i = zbx_vector_uint64_bsearch(history_itemids, func->itemid,
-				ZBX_DEFAULT_UINT64_COMPARE_FUNC)))
-		{
-			item = history_items + i;
-			errcode = history_errcodes[i];
-		}
-		else
+		int			ret;
+		char			*params;
+		zbx_dc_evaluate_item_t	evaluate_item;
+
+		func = (zbx_func_t *)funcs_sorted.values[j];
+
+		/* functions are sorted by itemid, resolve the item only when it changes */
+		if (itemid != func->itemid)
 		{
-			i = zbx_vector_uint64_bsearch(&itemids, func->itemid, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
-			item = *items + i;
-			errcode = (*items_err)[i];
+			itemid = func->itemid;
+
+			/* avoid double copying from configuration cache if already retrieved when saving history */
+			if (FAIL != (i = zbx_vector_uint64_bsearch(history_itemids, func->itemid,
+					ZBX_DEFAULT_UINT64_COMPARE_FUNC)))
+			{
+				item = history_items + i;
+				errcode = history_errcodes[i];
+			}
+			else
+			{
+				i = zbx_vector_uint64_bsearch(&itemids, func->itemid, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+				item = *items + i;
+				errcode = (*items_err)[i];
+			}
 		}
 
 		if (SUCCEED != errcode)
@@ -503,6 +546,7 @@ static void	zbx_evaluate_item_functions(zbx_hashset_t *funcs, const zbx_vector_u
 	}
 
 	zbx_vc_flush_stats();
+	zbx_vector_ptr_destroy(&funcs_sorted);
 	zbx_vector_uint64_destroy(&itemids);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
@@ -611,18 +655,36 @@ static void	zbx_substitute_functions_results(zbx_hashset_t *ifuncs, zbx_vector_d
  *                                                                            *
  * Purpose: substitute expression functions with their values.                *
  *                                                                            *
+ * Parameters: triggers         - [IN/OUT] triggers to substitute functions   *
+ *             history_itemids  - [IN] identifiers of items with history      *
+ *                                     values in the current batch            *
+ *             history_items    - [IN] items with history values              *
+ *             history_errcodes - [IN] item error codes                       *
+ *             items            - [OUT] other items used in functions         *
+ *             items_err        - [OUT] other item error codes                *
+ *             items_num        - [OUT] number of other items                 *
+ *             functions_num    - [OUT] number of trigger functions           *
+ *             functions_unique - [OUT] number of evaluated unique functions  *
+ *                                                                            *
  * Comments: example: "({15}>10) or ({123}=1)" => "(26.416>10) or (0=1)"      *
  *                                                                            *
+ *           Functions of different triggers having the same item, function,  *
+ *           parameters and timestamp are evaluated only once.                *
+ *                                                                            *
  ******************************************************************************/
 static void	substitute_functions(zbx_vector_dc_trigger_t *triggers, const zbx_vector_uint64_t *history_itemids,
 		const zbx_history_sync_item_t *history_items, const int *history_errcodes,
-		zbx_history_sync_item_t **items, int **items_err, int *items_num)
+		zbx_history_sync_item_t **items, int **items_err, int *items_num, int *functions_num,
+		int *functions_unique)
 {
 	zbx_vector_uint64_t	functionids;
 	zbx_hashset_t		ifuncs, funcs;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
+	*functions_num = 0;
+	*functions_unique = 0;
+
 	zbx_vector_uint64_create(&functionids);
 	zbx_extract_functionids(&functionids, triggers);
 
@@ -644,12 +706,16 @@ static void	substitute_functions(zbx_vector_dc_trigger_t *triggers, const zbx_ve
 		zbx_substitute_functions_results(&ifuncs, triggers);
 	}
 
+	*functions_num = ifuncs.num_data;
+	*functions_unique = funcs.num_data;
+
 	zbx_hashset_destroy(&ifuncs);
 	zbx_hashset_destroy(&funcs);
 empty:
 	zbx_vector_uint64_destroy(&functionids);
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() functions:%d unique:%d", __func__, *functions_num,
+			*functions_unique);
 }
 
 static int	evaluate_expression(zbx_eval_context_t *ctx, const zbx_timespec_t *ts, double *result,
@@ -731,12 +797,19 @@ static int	dc_item_compare_by_itemid(const void *d1, const void *d2)
  *                                                                            *
  * Purpose: evaluate trigger expressions.                                     *
  *                                                                            *
- * Parameters: triggers - [IN] vector of zbx_dc_trigger_t pointers, sorted by *
- *                             triggerids                                     *
+ * Parameters: triggers         - [IN] vector of zbx_dc_trigger_t pointers,   *
+ *                                     sorted by triggerids                   *
+ *             history_itemids  - [IN] identifiers of items with history      *
+ *                                     values in the current batch            *
+ *             history_items    - [IN] items with history values              *
+ *             history_errcodes - [IN] item error codes                       *
+ *             functions_num    - [OUT] number of trigger functions           *
+ *             functions_unique - [OUT] number of evaluated unique functions  *
  *                                                                            *
  ******************************************************************************/
 void	zbx_evaluate_expressions(zbx_vector_dc_trigger_t *triggers, const zbx_vector_uint64_t *history_itemids,
-		const zbx_history_sync_item_t *history_items, const int *history_errcodes)
+		const zbx_history_sync_item_t *history_items, const int *history_errcodes, int *functions_num,
+		int *functions_unique)
 {
 	zbx_db_event		event;
 	zbx_dc_trigger_t	*tr;
@@ -754,7 +827,7 @@ void	zbx_evaluate_expressions(zbx_vector_dc_trigger_t *triggers, const zbx_vecto
 	um_handle = zbx_dc_open_user_macros();
 
 	substitute_functions(triggers, history_itemids, history_items, history_errcodes, &items, &items_err,
-			&items_num);
+			&items_num, functions_num, functions_unique);
 
 	for (i = 0; i < triggers->values_num; i++)
 	{
@@ -18,6 +18,7 @@
 **/
 
 #include "zbxicmpping.h"
+#include "icmpping_native.h"
 
 #include <signal.h>
 
@@ -1203,6 +1204,9 @@ void	zbx_init_icmpping_env(const char *prefix, long int id)
  *               NOTSUPPORTED - otherwise                                     *
  *                                                                            *
  * Comments: use external binary 'fping' to avoid superuser privileges        *
+ *           unless native ICMP ping is enabled in configuration, in which    *
+ *           case hosts are pinged from within the process using datagram     *
+ *           or raw ICMP sockets                                              *
  *                                                                            *
  ******************************************************************************/
 int	zbx_ping(ZBX_FPING_HOST *hosts, int hosts_count, int requests_count, int period, int size, int timeout,
@@ -1212,8 +1216,18 @@ int	zbx_ping(ZBX_FPING_HOST *hosts, int hosts_count, int requests_count, int per
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() hosts_count:%d", __func__, hosts_count);
 
-	if (NOTSUPPORTED == (ret = hosts_ping(hosts, hosts_count, requests_count, period, size, timeout,
-			allow_redirect, rdns, error, max_error_len)))
+	if (NULL != config_icmpping->get_native_ping && 0 != config_icmpping->get_native_ping())
+	{
+		ret = icmpping_native_ping(hosts, hosts_count, requests_count, period, size, timeout, allow_redirect,
+				rdns, config_icmpping->get_source_ip(), error, max_error_len);
+	}
+	else
+	{
+		ret = hosts_ping(hosts, hosts_count, requests_count, period, size, timeout, allow_redirect, rdns,
+				error, max_error_len);
+	}
+
+	if (NOTSUPPORTED == ret)
 	{
 		zabbix_log(LOG_LEVEL_ERR, "%s", error);
 	}
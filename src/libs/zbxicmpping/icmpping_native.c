@@ -0,0 +1,671 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "icmpping_native.h"
+
+#include "zbxcomms.h"
+#include "zbxtime.h"
+#include "zbxstr.h"
+
+#define ICMP_ECHO_REPLY_TYPE		0
+#define ICMP_ECHO_REQUEST_TYPE		8
+#define ICMP6_ECHO_REQUEST_TYPE		128
+#define ICMP6_ECHO_REPLY_TYPE		129
+
+/* defaults matching the fping options used by the external pinger */
+#define ICMPPING_PERIOD_DEFAULT		1000	/* -p, milliseconds */
+#define ICMPPING_TIMEOUT_DEFAULT	500	/* -t, milliseconds */
+#define ICMPPING_SIZE_DEFAULT		56	/* -b, bytes */
+
+#define ICMPPING_SEND_RETRY_WAIT	10	/* wait for socket buffer space, milliseconds */
+#define ICMPPING_RCVBUF_SIZE		(4 * ZBX_MEBIBYTE)
+#define ICMPPING_RECV_BUF_SIZE		(64 * ZBX_KIBIBYTE)
+
+#define ICMPPING_SOCKET_IPV4		0
+#define ICMPPING_SOCKET_IPV6		1
+#define ICMPPING_SOCKET_COUNT		2
+
+typedef struct
+{
+	unsigned char	type;
+	unsigned char	code;
+	unsigned short	checksum;
+	unsigned short	id;
+	unsigned short	seq;
+}
+zbx_icmp_echo_t;
+
+/* echo request payload prefix identifying the request when the reply is received */
+typedef struct
+{
+	zbx_uint32_t	cookie;
+	zbx_uint32_t	host_index;
+	zbx_uint32_t	request_index;
+}
+zbx_icmp_marker_t;
+
+typedef struct
+{
+	int	fd;
+	int	family;
+}
+zbx_icmp_socket_t;
+
+typedef struct
+{
+	struct sockaddr_storage	addr;
+	socklen_t		addr_len;
+	zbx_icmp_socket_t	*sock;	/* NULL if the host cannot be pinged */
+}
+zbx_icmp_target_t;
+
+typedef struct
+{
+	ZBX_FPING_HOST		*hosts;
+	zbx_icmp_target_t	*targets;
+	int			hosts_count;
+	int			requests_count;
+	double			*sent;		/* request send timestamps, 0 - not sent yet */
+	unsigned char		*replied;
+	zbx_uint32_t		cookie;
+	double			timeout;	/* individual request timeout, seconds */
+	double			last_sent;
+	int			outstanding;	/* number of requests without reply */
+	unsigned char		allow_redirect;
+	unsigned char		*packet;
+	size_t			packet_len;
+}
+zbx_icmp_ping_t;
+
+static ZBX_THREAD_LOCAL zbx_uint32_t	ping_num;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculate Internet checksum (RFC 1071) of ICMP packet             *
+ *                                                                            *
+ ******************************************************************************/
+static unsigned short	icmp_checksum(const unsigned char *data, size_t len)
+{
+	zbx_uint32_t	sum = 0;
+
+	for (; 1 < len; data += 2, len -= 2)
+		sum += (zbx_uint32_t)((data[0] << 8) | data[1]);
+
+	if (0 != len)
+		sum += (zbx_uint32_t)(data[0] << 8);
+
+	while (0 != (sum >> 16))
+		sum = (sum & 0xffff) + (sum >> 16);
+
+	return htons((unsigned short)~sum);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: bind ICMP socket to the configured source address                 *
+ *                                                                            *
+ * Comments: source address of other address family is silently ignored       *
+ *                                                                            *
+ ******************************************************************************/
+static int	icmp_socket_bind(const zbx_icmp_socket_t *sock, const char *source_ip, char *error,
+		size_t max_error_len)
+{
+	struct addrinfo	hints, *ai = NULL;
+	int		ret = SUCCEED;
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = sock->family;
+	hints.ai_socktype = SOCK_DGRAM;
+
+	if (0 != getaddrinfo(source_ip, NULL, &hints, &ai))
+		goto out;
+
+	if (-1 == bind(sock->fd, ai->ai_addr, ai->ai_addrlen))
+	{
+		zbx_snprintf(error, max_error_len, "Cannot bind ICMP socket to \"%s\": %s", source_ip,
+				zbx_strerror(errno));
+		ret = FAIL;
+	}
+out:
+	if (NULL != ai)
+		freeaddrinfo(ai);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: open non-blocking ICMP socket                                     *
+ *                                                                            *
+ * Parameters: sock          - [OUT] opened socket                            *
+ *             family        - [IN] address family                            *
+ *             source_ip     - [IN] source address to bind to (optional)      *
+ *             error         - [OUT] error message                            *
+ *             max_error_len - [IN] error buffer size                         *
+ *                                                                            *
+ * Return value: SUCCEED - socket was opened                                  *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Unprivileged datagram ICMP sockets are tried first (allowed by   *
+ *           net.ipv4.ping_group_range on Linux), falling back to raw sockets *
+ *           which require root privileges or CAP_NET_RAW capability.         *
+ *                                                                            *
+ ******************************************************************************/
+static int	icmp_socket_open(zbx_icmp_socket_t *sock, int family, const char *source_ip, char *error,
+		size_t max_error_len)
+{
+	int	protocol = IPPROTO_ICMP, rcvbuf = ICMPPING_RCVBUF_SIZE;
+
+#ifdef HAVE_IPV6
+	if (AF_INET6 == family)
+		protocol = IPPROTO_ICMPV6;
+#endif
+	if (-1 == (sock->fd = socket(family, SOCK_DGRAM, protocol)) &&
+			-1 == (sock->fd = socket(family, SOCK_RAW, protocol)))
+	{
+		zbx_snprintf(error, max_error_len, "Cannot create ICMP socket: %s", zbx_strerror(errno));
+		return FAIL;
+	}
+
+	sock->family = family;
+
+	if (-1 == fcntl(sock->fd, F_SETFL, fcntl(sock->fd, F_GETFL, 0) | O_NONBLOCK))
+	{
+		zbx_snprintf(error, max_error_len, "Cannot set ICMP socket to non-blocking mode: %s",
+				zbx_strerror(errno));
+		goto fail;
+	}
+
+	/* replies to thousands of requests can arrive in a burst, failure is not critical */
+	if (-1 == setsockopt(sock->fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf)))
+		zabbix_log(LOG_LEVEL_DEBUG, "cannot set ICMP socket receive buffer size: %s", zbx_strerror(errno));
+
+	if (NULL != source_ip && SUCCEED != icmp_socket_bind(sock, source_ip, error, max_error_len))
+		goto fail;
+
+	return SUCCEED;
+fail:
+	close(sock->fd);
+	sock->fd = -1;
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: resolve host address and assign ICMP socket of its family         *
+ *                                                                            *
+ * Parameters: target        - [OUT] resolved target                          *
+ *             addr          - [IN] host IP address or DNS name               *
+ *             sockets       - [IN/OUT] ICMP sockets, opened on first use     *
+ *             source_ip     - [IN] source address to bind to (optional)      *
+ *             error         - [OUT] error message                            *
+ *             max_error_len - [IN] error buffer size                         *
+ *                                                                            *
+ * Return value: SUCCEED - target can be pinged                               *
+ *               FAIL    - address cannot be resolved or ICMP socket cannot   *
+ *                         be opened, error is set in the latter case         *
+ *                                                                            *
+ ******************************************************************************/
+static int	icmp_target_resolve(zbx_icmp_target_t *target, const char *addr, zbx_icmp_socket_t *sockets,
+		const char *source_ip, char *error, size_t max_error_len)
+{
+	struct addrinfo		hints, *ai = NULL;
+	zbx_icmp_socket_t	*sock;
+	int			ret = FAIL;
+
+	target->sock = NULL;
+
+	memset(&hints, 0, sizeof(hints));
+#ifdef HAVE_IPV6
+	hints.ai_family = PF_UNSPEC;
+#else
+	hints.ai_family = AF_INET;
+#endif
+	hints.ai_socktype = SOCK_DGRAM;
+
+	if (0 != getaddrinfo(addr, NULL, &hints, &ai))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "cannot resolve ICMP ping target \"%s\"", addr);
+		goto out;
+	}
+
+	if (AF_INET == ai->ai_family)
+		sock = &sockets[ICMPPING_SOCKET_IPV4];
+#ifdef HAVE_IPV6
+	else if (AF_INET6 == ai->ai_family)
+		sock = &sockets[ICMPPING_SOCKET_IPV6];
+#endif
+	else
+		goto out;
+
+	if (-1 == sock->fd && SUCCEED != icmp_socket_open(sock, ai->ai_family, source_ip, error, max_error_len))
+	{
+		/* do not retry opening socket for every host of the same family */
+		sock->fd = -2;
+	}
+
+	if (0 > sock->fd)
+		goto out;
+
+	memcpy(&target->addr, ai->ai_addr, ai->ai_addrlen);
+	target->addr_len = (socklen_t)ai->ai_addrlen;
+	target->sock = sock;
+	ret = SUCCEED;
+out:
+	if (NULL != ai)
+		freeaddrinfo(ai);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if reply came from the pinged address                       *
+ *                                                                            *
+ ******************************************************************************/
+static int	icmp_target_addr_compare(const zbx_icmp_target_t *target, const struct sockaddr_storage *from)
+{
+	if (target->addr.ss_family != from->ss_family)
+		return FAIL;
+
+	if (AF_INET == from->ss_family)
+	{
+		if (0 != memcmp(&((const struct sockaddr_in *)&target->addr)->sin_addr,
+				&((const struct sockaddr_in *)from)->sin_addr, sizeof(struct in_addr)))
+		{
+			return FAIL;
+		}
+
+		return SUCCEED;
+	}
+#ifdef HAVE_IPV6
+	if (AF_INET6 == from->ss_family)
+	{
+		if (0 != memcmp(&((const struct sockaddr_in6 *)&target->addr)->sin6_addr,
+				&((const struct sockaddr_in6 *)from)->sin6_addr, sizeof(struct in6_addr)))
+		{
+			return FAIL;
+		}
+
+		return SUCCEED;
+	}
+#endif
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: send echo request to the host                                     *
+ *                                                                            *
+ * Parameters: ping          - [IN/OUT] ping state                            *
+ *             host_index    - [IN]                                           *
+ *             request_index - [IN]                                           *
+ *                                                                            *
+ * Return value: SUCCEED - request was sent or is considered lost             *
+ *               FAIL    - socket buffer is full, send must be retried later  *
+ *                                                                            *
+ ******************************************************************************/
+static int	icmp_request_send(zbx_icmp_ping_t *ping, int host_index, int request_index)
+{
+	const zbx_icmp_target_t	*target = &ping->targets[host_index];
+	zbx_icmp_echo_t		echo;
+	zbx_icmp_marker_t	marker;
+	int			idx = host_index * ping->requests_count + request_index;
+
+	memset(&echo, 0, sizeof(echo));
+#ifdef HAVE_IPV6
+	echo.type = (AF_INET6 == target->sock->family ? ICMP6_ECHO_REQUEST_TYPE : ICMP_ECHO_REQUEST_TYPE);
+#else
+	echo.type = ICMP_ECHO_REQUEST_TYPE;
+#endif
+	/* identifier is replaced by kernel for datagram ICMP sockets, replies are matched by marker */
+	echo.id = htons((unsigned short)ping->cookie);
+	echo.seq = htons((unsigned short)idx);
+
+	marker.cookie = ping->cookie;
+	marker.host_index = (zbx_uint32_t)host_index;
+	marker.request_index = (zbx_uint32_t)request_index;
+
+	memcpy(ping->packet, &echo, sizeof(echo));
+	memcpy(ping->packet + sizeof(echo), &marker, sizeof(marker));
+
+	/* ICMPv6 checksum covers IPv6 pseudo header and is always calculated by kernel */
+	if (AF_INET == target->sock->family)
+	{
+		echo.checksum = icmp_checksum(ping->packet, ping->packet_len);
+		memcpy(ping->packet, &echo, sizeof(echo));
+	}
+
+	if (-1 == sendto(target->sock->fd, ping->packet, ping->packet_len, 0, (const struct sockaddr *)&target->addr,
+			target->addr_len))
+	{
+		if (EAGAIN == errno || EWOULDBLOCK == errno || ENOBUFS == errno || EINTR == errno)
+			return FAIL;
+
+		zabbix_log(LOG_LEVEL_DEBUG, "cannot send ICMP echo request to \"%s\": %s",
+				ping->hosts[host_index].addr, zbx_strerror(errno));
+	}
+
+	ping->last_sent = ping->sent[idx] = zbx_time();
+	ping->outstanding++;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: receive pending echo replies and update host statistics           *
+ *                                                                            *
+ * Parameters: ping - [IN/OUT] ping state                                     *
+ *             sock - [IN] socket with pending data                           *
+ *             buf  - [IN] receive buffer of ICMPPING_RECV_BUF_SIZE bytes     *
+ *                                                                            *
+ ******************************************************************************/
+static void	icmp_replies_recv(zbx_icmp_ping_t *ping, const zbx_icmp_socket_t *sock, unsigned char *buf)
+{
+	struct sockaddr_storage	from;
+	socklen_t		from_len;
+	ssize_t			n;
+	unsigned char		reply_type = ICMP_ECHO_REPLY_TYPE;
+
+#ifdef HAVE_IPV6
+	if (AF_INET6 == sock->family)
+		reply_type = ICMP6_ECHO_REPLY_TYPE;
+#endif
+	for (;;)
+	{
+		const unsigned char	*data = buf;
+		size_t			len, hdr_len;
+		zbx_icmp_echo_t		echo;
+		zbx_icmp_marker_t	marker;
+		ZBX_FPING_HOST		*host;
+		int			idx;
+		double			sec;
+
+		from_len = sizeof(from);
+
+		if (-1 == (n = recvfrom(sock->fd, buf, ICMPPING_RECV_BUF_SIZE, 0, (struct sockaddr *)&from,
+				&from_len)))
+		{
+			if (EINTR == errno)
+				continue;
+
+			break;
+		}
+
+		len = (size_t)n;
+
+		/* IPv4 raw sockets receive IP header too, it is told apart by version as echo reply type is 0 */
+		if (AF_INET == sock->family && 0 != len && 4 == (data[0] >> 4))
+		{
+			if (len < (hdr_len = (size_t)(data[0] & 0x0f) * 4))
+				continue;
+
+			data += hdr_len;
+			len -= hdr_len;
+		}
+
+		if (len < sizeof(echo) + sizeof(marker))
+			continue;
+
+		memcpy(&echo, data, sizeof(echo));
+		memcpy(&marker, data + sizeof(echo), sizeof(marker));
+
+		/* raw sockets receive all ICMP traffic of the system, including replies to other pingers */
+		if (reply_type != echo.type || ping->cookie != marker.cookie ||
+				(zbx_uint32_t)ping->hosts_count <= marker.host_index ||
+				(zbx_uint32_t)ping->requests_count <= marker.request_index ||
+				sock != ping->targets[marker.host_index].sock)
+		{
+			continue;
+		}
+
+		idx = (int)marker.host_index * ping->requests_count + (int)marker.request_index;
+
+		if (0 == ping->sent[idx] || 0 != ping->replied[idx])
+			continue;
+
+		if (0 == ping->allow_redirect &&
+				SUCCEED != icmp_target_addr_compare(&ping->targets[marker.host_index], &from))
+		{
+			continue;
+		}
+
+		if (ping->timeout < (sec = zbx_time() - ping->sent[idx]))
+			continue;
+
+		ping->replied[idx] = 1;
+		ping->outstanding--;
+
+		host = &ping->hosts[marker.host_index];
+
+		if (0 == host->rcv || host->min > sec)
+			host->min = sec;
+		if (0 == host->rcv || host->max < sec)
+			host->max = sec;
+		host->sum += sec;
+		host->rcv++;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: ping hosts from within the process without executing fping        *
+ *                                                                            *
+ * Parameters: hosts          - [IN/OUT] list of target hosts                 *
+ *             hosts_count    - [IN] number of target hosts                   *
+ *             requests_count - [IN] number of pings to send to each target   *
+ *             period         - [IN] interval between ping packets to one     *
+ *                                   target, in milliseconds                  *
+ *             size           - [IN] amount of ping data to send, in bytes    *
+ *             timeout        - [IN] individual request timeout, milliseconds *
+ *             allow_redirect - [IN] treat redirected response as host up:    *
+ *                                   0 - no, 1 - yes                          *
+ *             rdns           - [IN] resolve host DNS names                   *
+ *             source_ip      - [IN] source address to bind to (optional)     *
+ *             error          - [OUT] error string if function fails          *
+ *             max_error_len  - [IN] length of error buffer                   *
+ *                                                                            *
+ * Return value: SUCCEED      - successfully processed hosts                  *
+ *               NOTSUPPORTED - otherwise                                     *
+ *                                                                            *
+ * Comments: Requests to all hosts are sent in rounds, one round per period,  *
+ *           and are kept in flight simultaneously. Replies are matched by    *
+ *           the marker in the payload. Default values and statistics follow  *
+ *           fping so that the results are interchangeable. Hosts that cannot *
+ *           be resolved or whose address family has no ICMP socket are left  *
+ *           with zero request count.                                         *
+ *                                                                            *
+ ******************************************************************************/
+int	icmpping_native_ping(ZBX_FPING_HOST *hosts, int hosts_count, int requests_count, int period, int size,
+		int timeout, unsigned char allow_redirect, int rdns, const char *source_ip, char *error,
+		size_t max_error_len)
+{
+	zbx_icmp_socket_t	sockets[ICMPPING_SOCKET_COUNT];
+	zbx_icmp_ping_t		ping;
+	zbx_pollfd_t		pollfds[ICMPPING_SOCKET_COUNT];
+	unsigned char		*buf = NULL;
+	int			i, ret = NOTSUPPORTED, targets_num = 0, round = 0, cursor = 0;
+	double			start, period_sec;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() hosts_count:%d requests_count:%d period:%d size:%d timeout:%d",
+			__func__, hosts_count, requests_count, period, size, timeout);
+
+	if (0 == period)
+		period = ICMPPING_PERIOD_DEFAULT;
+
+	if (0 == timeout)
+		timeout = (1 < requests_count ? period : ICMPPING_TIMEOUT_DEFAULT);
+
+	if (0 == size)
+		size = ICMPPING_SIZE_DEFAULT;
+
+	for (i = 0; i < ICMPPING_SOCKET_COUNT; i++)
+		sockets[i].fd = -1;
+
+	memset(&ping, 0, sizeof(ping));
+	ping.hosts = hosts;
+	ping.hosts_count = hosts_count;
+	ping.requests_count = requests_count;
+	ping.timeout = timeout / 1000.0;
+	ping.allow_redirect = allow_redirect;
+	ping.targets = (zbx_icmp_target_t *)zbx_malloc(NULL, sizeof(zbx_icmp_target_t) * (size_t)hosts_count);
+
+	*error = '\0';
+
+	for (i = 0; i < hosts_count; i++)
+	{
+		if (SUCCEED == icmp_target_resolve(&ping.targets[i], hosts[i].addr, sockets, source_ip, error,
+				max_error_len))
+		{
+			targets_num++;
+		}
+	}
+
+	if (0 == targets_num && '\0' != *error)
+		goto out;
+
+	ping.sent = (double *)zbx_calloc(NULL, (size_t)hosts_count * (size_t)requests_count, sizeof(double));
+	ping.replied = (unsigned char *)zbx_calloc(NULL, (size_t)hosts_count * (size_t)requests_count, 1);
+	ping.packet_len = sizeof(zbx_icmp_echo_t) + MAX((size_t)size, sizeof(zbx_icmp_marker_t));
+	ping.packet = (unsigned char *)zbx_malloc(NULL, ping.packet_len);
+	memset(ping.packet, 0xa5, ping.packet_len);
+	buf = (unsigned char *)zbx_malloc(NULL, ICMPPING_RECV_BUF_SIZE);
+
+	start = zbx_time();
+	period_sec = period / 1000.0;
+	ping.cookie = (zbx_uint32_t)getpid() ^ ((zbx_uint32_t)(start * 1000000) << 8) ^ (++ping_num << 24);
+
+	while (0 != targets_num)
+	{
+		double	now, wait;
+		int	pollfds_num = 0, blocked = 0;
+
+		while (round < requests_count && zbx_time() >= start + round * period_sec)
+		{
+			for (; cursor < hosts_count; cursor++)
+			{
+				if (NULL == ping.targets[cursor].sock)
+					continue;
+
+				if (SUCCEED != icmp_request_send(&ping, cursor, round))
+				{
+					blocked = 1;
+					break;
+				}
+			}
+
+			if (0 != blocked)
+				break;
+
+			cursor = 0;
+			round++;
+		}
+
+		now = zbx_time();
+
+		if (0 != blocked)
+		{
+			wait = ICMPPING_SEND_RETRY_WAIT / 1000.0;
+		}
+		else if (round < requests_count)
+		{
+			wait = start + round * period_sec - now;
+		}
+		else
+		{
+			if (0 == ping.outstanding || 0 >= (wait = ping.last_sent + ping.timeout - now))
+				break;
+		}
+
+		for (i = 0; i < ICMPPING_SOCKET_COUNT; i++)
+		{
+			if (0 > sockets[i].fd)
+				continue;
+
+			pollfds[pollfds_num].fd = sockets[i].fd;
+			pollfds[pollfds_num].events = POLLIN;
+			pollfds[pollfds_num++].revents = 0;
+		}
+
+		if (-1 == zbx_socket_poll(pollfds, (unsigned long)pollfds_num, 0 < wait ? (int)(wait * 1000) + 1 : 0) &&
+				EINTR != zbx_socket_last_error())
+		{
+			zbx_snprintf(error, max_error_len, "Cannot wait for ICMP replies: %s",
+					zbx_strerror(zbx_socket_last_error()));
+			goto out;
+		}
+
+		for (i = 0; i < pollfds_num; i++)
+		{
+			int	j;
+
+			if (0 == (pollfds[i].revents & POLLIN))
+				continue;
+
+			for (j = 0; j < ICMPPING_SOCKET_COUNT; j++)
+			{
+				if (sockets[j].fd == pollfds[i].fd)
+					icmp_replies_recv(&ping, &sockets[j], buf);
+			}
+		}
+	}
+
+	for (i = 0; i < hosts_count; i++)
+	{
+		ZBX_FPING_HOST	*host = &hosts[i];
+
+		if (NULL == ping.targets[i].sock)
+			continue;
+
+		host->cnt += requests_count;
+
+		if (0 != rdns)
+		{
+			char	dnsname[ZBX_MAX_DNSNAME_LEN + 1];
+
+			if (0 != getnameinfo((const struct sockaddr *)&ping.targets[i].addr, ping.targets[i].addr_len,
+					dnsname, sizeof(dnsname), NULL, 0, NI_NAMEREQD))
+			{
+				*dnsname = '\0';
+			}
+
+			host->dnsname = zbx_strdup(host->dnsname, dnsname);
+		}
+	}
+
+	ret = SUCCEED;
+out:
+	for (i = 0; i < ICMPPING_SOCKET_COUNT; i++)
+	{
+		if (0 <= sockets[i].fd)
+			close(sockets[i].fd);
+	}
+
+	zbx_free(buf);
+	zbx_free(ping.packet);
+	zbx_free(ping.replied);
+	zbx_free(ping.sent);
+	zbx_free(ping.targets);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+
+	return ret;
+}
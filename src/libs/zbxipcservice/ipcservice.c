@@ -7,6 +7,8 @@
 #	include <event2/thread.h>
 #endif
 
+#include <sys/uio.h>
+
 #include "zbxipcservice.h"
 #include "zbxalgo.h"
 #include "zbxstr.h"
@@ -15,6 +17,13 @@
 
 #define ZBX_IPC_DATA_DUMP_SIZE		128
 
+/* the maximum number of buffers written with a single writev() call */
+#if defined(IOV_MAX) && 64 > IOV_MAX
+#	define ZBX_IPC_TX_IOV_MAX	IOV_MAX
+#else
+#	define ZBX_IPC_TX_IOV_MAX	64
+#endif
+
 static char	ipc_path[ZBX_IPC_PATH_MAX] = {0};
 static size_t	ipc_path_root_len = 0;
 
@@ -45,6 +54,9 @@ struct zbx_ipc_client
 
 	zbx_uint64_t		id;
 	unsigned char		state;
+	unsigned char		send_mode;
+
+	zbx_ipc_stats_t		stats;
 
 	void			*userdata;
 
@@ -190,6 +202,44 @@ static int	ipc_write_data(int fd, const unsigned char *data, zbx_uint32_t size,
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: writes data from multiple buffers to a socket with single call    *
+ *                                                                            *
+ * Parameters: fd        - [IN] the socket file descriptor                    *
+ *             iov       - [IN] the data buffers                              *
+ *             iov_num   - [IN] the number of data buffers                    *
+ *             size_sent - [OUT] the actual size written to socket            *
+ *                                                                            *
+ * Return value: SUCCEED - no socket errors were detected. Either the data or *
+ *                         a part of it was written to socket or a write to   *
+ *                         non-blocking socket would block                    *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	ipc_writev_data(int fd, const struct iovec *iov, int iov_num, size_t *size_sent)
+{
+	ssize_t	n;
+
+	*size_sent = 0;
+
+	while (-1 == (n = writev(fd, iov, iov_num)))
+	{
+		if (EINTR == errno)
+			continue;
+
+		if (EWOULDBLOCK == errno || EAGAIN == errno)
+			return SUCCEED;
+
+		zabbix_log(LOG_LEVEL_WARNING, "cannot write to IPC socket: %s", strerror(errno));
+		return FAIL;
+	}
+
+	*size_sent = (size_t)n;
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: reads data from a socket                                          *
@@ -239,6 +289,7 @@ static int	ipc_read_data(int fd, unsigned char *buffer, zbx_uint32_t size, zbx_u
  *             buffer    - [IN] the data                                      *
  *             size      - [IN] the data size                                 *
  *             read_size - [IN] the actual size read from socket              *
+ *             reads_num - [IN/OUT] the number of socket reads (optional)     *
  *                                                                            *
  * Return value: SUCCEED - the data was successfully read                     *
  *               FAIL    - otherwise                                          *
@@ -248,7 +299,8 @@ static int	ipc_read_data(int fd, unsigned char *buffer, zbx_uint32_t size, zbx_u
  *           the requested data has been read.                                *
  *                                                                            *
  ******************************************************************************/
-static int	ipc_read_data_full(int fd, unsigned char *buffer, zbx_uint32_t size, zbx_uint32_t *read_size)
+static int	ipc_read_data_full(int fd, unsigned char *buffer, zbx_uint32_t size, zbx_uint32_t *read_size,
+		zbx_uint64_t *reads_num)
 {
 	int		ret = FAIL;
 	zbx_uint32_t	offset = 0, chunk_size;
@@ -257,6 +309,9 @@ static int	ipc_read_data_full(int fd, unsigned char *buffer, zbx_uint32_t size,
 
 	while (offset < size)
 	{
+		if (NULL != reads_num)
+			(*reads_num)++;
+
 		if (FAIL == ipc_read_data(fd, buffer + offset, size - offset, &chunk_size))
 			goto out;
 
@@ -323,6 +378,48 @@ static int	ipc_socket_write_message(zbx_ipc_socket_t *csocket, zbx_uint32_t code
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: writes IPC message to client socket                               *
+ *                                                                            *
+ * Parameters: client  - [IN] the IPC client                                  *
+ *             code    - [IN] the message code                                *
+ *             data    - [IN] the data                                        *
+ *             size    - [IN] the data size                                   *
+ *             tx_size - [OUT] the actual size written to socket              *
+ *                                                                            *
+ * Return value: SUCCEED - no socket errors were detected. Either the data or *
+ *                         a part of it was written to socket or a write to   *
+ *                         non-blocking socket would block                    *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The message header and data are written with a single writev()   *
+ *           call without copying them into intermediate buffer.              *
+ *                                                                            *
+ ******************************************************************************/
+static int	ipc_client_write_message(zbx_ipc_client_t *client, zbx_uint32_t code, const unsigned char *data,
+		zbx_uint32_t size, zbx_uint32_t *tx_size)
+{
+	zbx_uint32_t	header[2];
+	struct iovec	iov[2];
+	size_t		write_size;
+	int		ret;
+
+	header[ZBX_IPC_MESSAGE_CODE] = code;
+	header[ZBX_IPC_MESSAGE_SIZE] = size;
+
+	iov[0].iov_base = header;
+	iov[0].iov_len = ZBX_IPC_HEADER_SIZE;
+	iov[1].iov_base = (unsigned char *)data;
+	iov[1].iov_len = size;
+
+	ret = ipc_writev_data(client->csocket.fd, iov, 0 != size ? 2 : 1, &write_size);
+	client->stats.tx_writes++;
+	*tx_size = (zbx_uint32_t)write_size;
+
+	return ret;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: reads message header and data from buffer                         *
@@ -411,6 +508,7 @@ static int	ipc_message_is_completed(const zbx_uint32_t *header, zbx_uint32_t rx_
  *             data     - [OUT] the data of the message                       *
  *             rx_bytes - [IN/OUT] the total message size read (including     *
  *                                 header                                     *
+ *             reads_num - [IN/OUT] the number of socket reads (optional)     *
  *                                                                            *
  * Return value:  SUCCEED - data was read successfully, check rx_bytes to     *
  *                          determine if the message was completed.           *
@@ -419,7 +517,7 @@ static int	ipc_message_is_completed(const zbx_uint32_t *header, zbx_uint32_t rx_
  *                                                                            *
  ******************************************************************************/
 static int	ipc_socket_read_message(zbx_ipc_socket_t *csocket, zbx_uint32_t *header, unsigned char **data,
-		zbx_uint32_t *rx_bytes)
+		zbx_uint32_t *rx_bytes, zbx_uint64_t *reads_num)
 {
 	zbx_uint32_t	data_size, offset, read_size = 0;
 	int		ret = FAIL;
@@ -451,12 +549,15 @@ static int	ipc_socket_read_message(zbx_ipc_socket_t *csocket, zbx_uint32_t *head
 			/* long messages will be read directly into message buffer */
 			if (ZBX_IPC_SOCKET_BUFFER_SIZE * 0.75 < data_size)
 			{
-				ret = ipc_read_data_full(csocket->fd, *data + offset, data_size, &read_size);
+				ret = ipc_read_data_full(csocket->fd, *data + offset, data_size, &read_size, reads_num);
 				*rx_bytes += read_size;
 				goto out;
 			}
 		}
 
+		if (NULL != reads_num)
+			(*reads_num)++;
+
 		if (FAIL == ipc_read_data(csocket->fd, csocket->rx_buffer, ZBX_IPC_SOCKET_BUFFER_SIZE, &read_size))
 			goto out;
 
@@ -548,6 +649,7 @@ static void	ipc_client_push_rx_message(zbx_ipc_client_t *client)
 	message->size = client->rx_header[ZBX_IPC_MESSAGE_SIZE];
 	message->data = client->rx_data;
 	zbx_queue_ptr_push(&client->rx_queue, message);
+	client->stats.rx_messages++;
 
 	client->rx_data = NULL;
 	client->rx_bytes = 0;
@@ -577,6 +679,30 @@ static void	ipc_client_pop_tx_message(zbx_ipc_client_t *client)
 	zbx_free(message);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: advances send queue by the number of bytes written to socket      *
+ *                                                                            *
+ * Parameters: client - [IN] the client                                       *
+ *             size   - [IN] the number of bytes written                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	ipc_client_complete_tx(zbx_ipc_client_t *client, size_t size)
+{
+	while (0 != size && 0 != client->tx_bytes)
+	{
+		if (size < client->tx_bytes)
+		{
+			client->tx_bytes -= (zbx_uint32_t)size;
+			break;
+		}
+
+		size -= client->tx_bytes;
+		client->stats.tx_messages++;
+		ipc_client_pop_tx_message(client);
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: reads data from IPC service client                                *
@@ -596,7 +722,7 @@ static int	ipc_client_read(zbx_ipc_client_t *client)
 	do
 	{
 		if (FAIL == ipc_socket_read_message(&client->csocket, client->rx_header, &client->rx_data,
-				&client->rx_bytes))
+				&client->rx_bytes, &client->stats.rx_reads))
 		{
 			zbx_free(client->rx_data);
 			client->rx_bytes = 0;
@@ -621,48 +747,66 @@ static int	ipc_client_read(zbx_ipc_client_t *client)
  * Return value: SUCCEED - the data was sent successfully                     *
  *               FAIL    - otherwise                                          *
  *                                                                            *
+ * Comments: The unsent part of the current message is written together with  *
+ *           the following queued messages in a single writev() call.         *
+ *                                                                            *
  ******************************************************************************/
 static int	ipc_client_write(zbx_ipc_client_t *client)
 {
-	zbx_uint32_t	data_size, write_size;
-
-	data_size = client->tx_header[ZBX_IPC_MESSAGE_SIZE];
+	struct iovec		iov[ZBX_IPC_TX_IOV_MAX];
+	zbx_uint32_t		headers[ZBX_IPC_TX_IOV_MAX][2], data_size, size;
+	zbx_ipc_message_t	*message;
+	size_t			tx_size, write_size;
+	int			iov_num, i;
 
-	if (data_size < client->tx_bytes)
+	while (0 < client->tx_bytes)
 	{
-		zbx_uint32_t	size, offset;
+		iov_num = 0;
+		tx_size = client->tx_bytes;
+		data_size = client->tx_header[ZBX_IPC_MESSAGE_SIZE];
 
-		size = client->tx_bytes - data_size;
-		offset = ZBX_IPC_HEADER_SIZE - size;
+		if (data_size < client->tx_bytes)
+		{
+			size = client->tx_bytes - data_size;
+			iov[iov_num].iov_base = (unsigned char *)client->tx_header + ZBX_IPC_HEADER_SIZE - size;
+			iov[iov_num++].iov_len = size;
+		}
 
-		if (SUCCEED != ipc_write_data(client->csocket.fd, (unsigned char *)client->tx_header + offset, size,
-				&write_size))
+		if (0 != (size = MIN(data_size, client->tx_bytes)))
 		{
-			return FAIL;
+			iov[iov_num].iov_base = client->tx_data + data_size - size;
+			iov[iov_num++].iov_len = size;
 		}
 
-		client->tx_bytes -= write_size;
+		for (i = 0; ZBX_IPC_TX_IOV_MAX - 1 > iov_num; i++)
+		{
+			if (NULL == (message = (zbx_ipc_message_t *)zbx_queue_ptr_peek(&client->tx_queue, i)))
+				break;
 
-		if (data_size < client->tx_bytes)
-			return SUCCEED;
-	}
+			headers[i][ZBX_IPC_MESSAGE_CODE] = message->code;
+			headers[i][ZBX_IPC_MESSAGE_SIZE] = message->size;
+			iov[iov_num].iov_base = headers[i];
+			iov[iov_num++].iov_len = ZBX_IPC_HEADER_SIZE;
 
-	while (0 < client->tx_bytes)
-	{
-		if (SUCCEED != ipc_write_data(client->csocket.fd, client->tx_data + data_size - client->tx_bytes,
-				client->tx_bytes, &write_size))
-		{
-			return FAIL;
+			if (0 != message->size)
+			{
+				iov[iov_num].iov_base = message->data;
+				iov[iov_num++].iov_len = message->size;
+			}
+
+			tx_size += ZBX_IPC_HEADER_SIZE + message->size;
 		}
 
-		if (0 == write_size)
-			return SUCCEED;
+		if (SUCCEED != ipc_writev_data(client->csocket.fd, iov, iov_num, &write_size))
+			return FAIL;
 
-		client->tx_bytes -= write_size;
-	}
+		client->stats.tx_writes++;
+		ipc_client_complete_tx(client, write_size);
 
-	if (0 == client->tx_bytes)
-		ipc_client_pop_tx_message(client);
+		/* socket buffer is full, wait for the next write event */
+		if (write_size < tx_size)
+			break;
+	}
 
 	return SUCCEED;
 }
@@ -746,6 +890,7 @@ static void	ipc_service_add_client(zbx_ipc_service_t *service, int fd)
 	client->csocket.rx_buffer_offset = 0;
 	client->id = next_clientid++;
 	client->state = ZBX_IPC_CLIENT_STATE_NONE;
+	client->send_mode = service->send_mode;
 	client->refcount = 1;
 
 	zbx_queue_ptr_create(&client->rx_queue);
@@ -761,6 +906,22 @@ static void	ipc_service_add_client(zbx_ipc_service_t *service, int fd)
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() clientid:" ZBX_FS_UI64, __func__, client->id);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds IPC message exchange statistics to the total statistics      *
+ *                                                                            *
+ * Parameters: total - [IN/OUT] the total statistics                          *
+ *             stats - [IN] the statistics to add                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	ipc_stats_add(zbx_ipc_stats_t *total, const zbx_ipc_stats_t *stats)
+{
+	total->rx_messages += stats->rx_messages;
+	total->rx_reads += stats->rx_reads;
+	total->tx_messages += stats->tx_messages;
+	total->tx_writes += stats->tx_writes;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: removes IPC service client                                        *
@@ -776,7 +937,10 @@ static void	ipc_service_remove_client(zbx_ipc_service_t *service, zbx_ipc_client
 	for (i = 0; i < service->clients.values_num; i++)
 	{
 		if (service->clients.values[i] == client)
+		{
+			ipc_stats_add(&service->stats, &client->stats);
 			zbx_vector_ptr_remove_noorder(&service->clients, i);
+		}
 	}
 }
 
@@ -1206,7 +1370,7 @@ int	zbx_ipc_socket_read(zbx_ipc_socket_t *csocket, zbx_ipc_message_t *message)
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	if (SUCCEED != ipc_socket_read_message(csocket, header, &data, &rx_bytes))
+	if (SUCCEED != ipc_socket_read_message(csocket, header, &data, &rx_bytes, NULL))
 		goto out;
 
 	if (SUCCEED != ipc_message_is_completed(header, rx_bytes))
@@ -1505,6 +1669,8 @@ int	zbx_ipc_service_start(zbx_ipc_service_t *service, const char *service_name,
 	service->path = zbx_strdup(NULL, service_name);
 	zbx_vector_ptr_create(&service->clients);
 	zbx_queue_ptr_create(&service->clients_recv);
+	service->send_mode = ZBX_IPC_SEND_IMMEDIATE;
+	memset(&service->stats, 0, sizeof(service->stats));
 
 	service->ev = event_base_new();
 	service->ev_listener = event_new(service->ev, service->fd, EV_READ | EV_PERSIST,
@@ -1536,6 +1702,16 @@ void	zbx_ipc_service_close(zbx_ipc_service_t *service)
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() path:%s", __func__, service->path);
 
+	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_DEBUG))
+	{
+		zbx_ipc_stats_t	stats;
+
+		zbx_ipc_service_get_stats(service, &stats);
+		zabbix_log(LOG_LEVEL_DEBUG, "%s() received messages:" ZBX_FS_UI64 " reads:" ZBX_FS_UI64
+				" sent messages:" ZBX_FS_UI64 " writes:" ZBX_FS_UI64, __func__, stats.rx_messages,
+				stats.rx_reads, stats.tx_messages, stats.tx_writes);
+	}
+
 	close(service->fd);
 
 	for (i = 0; i < service->clients.values_num; i++)
@@ -1644,6 +1820,54 @@ void	zbx_ipc_service_alert(zbx_ipc_service_t *service)
 	event_active(service->ev_alert, 0, 0);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sets send mode of the service clients                             *
+ *                                                                            *
+ * Parameters: service   - [IN] the IPC service                               *
+ *             send_mode - [IN] the send mode:                                *
+ *                           ZBX_IPC_SEND_IMMEDIATE - messages are written to *
+ *                                    socket directly when possible           *
+ *                           ZBX_IPC_SEND_BATCH - messages are queued and     *
+ *                                    written during zbx_ipc_service_recv()   *
+ *                                    messaging loop with as few writes as    *
+ *                                    possible                                *
+ *                                                                            *
+ * Comments: The send mode is applied to the connected and new clients.       *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_ipc_service_set_send_mode(zbx_ipc_service_t *service, unsigned char send_mode)
+{
+	int	i;
+
+	service->send_mode = send_mode;
+
+	for (i = 0; i < service->clients.values_num; i++)
+		((zbx_ipc_client_t *)service->clients.values[i])->send_mode = send_mode;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets message exchange statistics of the service                   *
+ *                                                                            *
+ * Parameters: service - [IN] the IPC service                                 *
+ *             stats   - [OUT] the statistics                                 *
+ *                                                                            *
+ * Comments: The statistics include connected and disconnected clients. The   *
+ *           ratio of messages and socket reads/writes shows how many         *
+ *           messages are processed per system call.                          *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_ipc_service_get_stats(const zbx_ipc_service_t *service, zbx_ipc_stats_t *stats)
+{
+	int	i;
+
+	*stats = service->stats;
+
+	for (i = 0; i < service->clients.values_num; i++)
+		ipc_stats_add(stats, &((const zbx_ipc_client_t *)service->clients.values[i])->stats);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: Sends IPC message to client                                       *
@@ -1656,6 +1880,8 @@ void	zbx_ipc_service_alert(zbx_ipc_service_t *service)
  * Comments: If data can't be written directly to socket (buffer full) then   *
  *           the message is queued and sent during zbx_ipc_service_recv()     *
  *           messaging loop whenever socket becomes ready.                    *
+ *           In batch send mode the message is always queued, so messages     *
+ *           sent before the next messaging loop are written together.        *
  *                                                                            *
  ******************************************************************************/
 int	zbx_ipc_client_send(zbx_ipc_client_t *client, zbx_uint32_t code, const unsigned char *data, zbx_uint32_t size)
@@ -1674,8 +1900,11 @@ int	zbx_ipc_client_send(zbx_ipc_client_t *client, zbx_uint32_t code, const unsig
 		goto out;
 	}
 
-	if (FAIL == ipc_socket_write_message(&client->csocket, code, data, size, &tx_size))
-		goto out;
+	if (ZBX_IPC_SEND_BATCH != client->send_mode)
+	{
+		if (FAIL == ipc_client_write_message(client, code, data, size, &tx_size))
+			goto out;
+	}
 
 	if (tx_size != ZBX_IPC_HEADER_SIZE + size)
 	{
@@ -1686,6 +1915,8 @@ int	zbx_ipc_client_send(zbx_ipc_client_t *client, zbx_uint32_t code, const unsig
 		client->tx_bytes = ZBX_IPC_HEADER_SIZE + size - tx_size;
 		event_add(client->tx_event, NULL);
 	}
+	else
+		client->stats.tx_messages++;
 
 	ret = SUCCEED;
 out:
@@ -2029,6 +2260,39 @@ int	zbx_ipc_async_socket_connected(zbx_ipc_async_socket_t *asocket)
 	return zbx_ipc_client_connected(asocket->client);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sets send mode of asynchronous IPC socket                         *
+ *                                                                            *
+ * Parameters: asocket   - [IN] the asynchronous IPC socket                   *
+ *             send_mode - [IN] the send mode:                                *
+ *                           ZBX_IPC_SEND_IMMEDIATE - messages are written to *
+ *                                    socket directly when possible           *
+ *                           ZBX_IPC_SEND_BATCH - messages are queued and     *
+ *                                    written during                          *
+ *                                    zbx_ipc_async_socket_recv() or          *
+ *                                    zbx_ipc_async_socket_flush() calls with *
+ *                                    as few writes as possible               *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_ipc_async_socket_set_send_mode(zbx_ipc_async_socket_t *asocket, unsigned char send_mode)
+{
+	asocket->client->send_mode = send_mode;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets message exchange statistics of asynchronous IPC socket       *
+ *                                                                            *
+ * Parameters: asocket - [IN] the asynchronous IPC socket                     *
+ *             stats   - [OUT] the statistics                                 *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_ipc_async_socket_get_stats(const zbx_ipc_async_socket_t *asocket, zbx_ipc_stats_t *stats)
+{
+	*stats = asocket->client->stats;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: connect, send message and receive response in a given timeout     *
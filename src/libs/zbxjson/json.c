@@ -592,6 +592,308 @@ static const char	*__zbx_json_rbracket(const char *p)
 	return NULL;
 }
 
+#define JSON_INDEX_BRACKETS_CACHE_SIZE	64
+
+typedef struct
+{
+	zbx_uint32_t	offset;
+	int		i;
+}
+zbx_json_index_bracket_t;
+
+/* structural index of json data */
+struct zbx_json_index
+{
+	const char		*start;
+	const char		*end;
+
+	/* offsets of brackets, colons and commas outside strings */
+	zbx_vector_uint32_t	pos;
+
+	/* for brackets - index of the matching bracket in pos vector */
+	zbx_vector_uint32_t	match;
+
+	/* index of the last located structural character, used to avoid */
+	/* searching when json data is walked sequentially               */
+	int			hint;
+
+	/* recently opened brackets, used to limit searching to the opened object or array */
+	zbx_json_index_bracket_t	brackets[JSON_INDEX_BRACKETS_CACHE_SIZE];
+
+	/* previously active index */
+	zbx_json_index_t	*prev;
+};
+
+static ZBX_THREAD_LOCAL zbx_json_index_t	*json_index = NULL;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: create structural index of json data                              *
+ *                                                                            *
+ * Parameters: jp - [IN] json data opened with zbx_json_open()                *
+ *                                                                            *
+ * Return value: The created index or NULL if json data cannot be indexed.    *
+ *                                                                            *
+ * Comments: The json data is scanned once recording positions of all         *
+ *           structural characters and matching brackets. Until the index is  *
+ *           freed zbx_json_next(), zbx_json_brackets_open() and functions    *
+ *           based on them use it for json data inside the indexed range of   *
+ *           the calling thread instead of rescanning the nested values.      *
+ *           Indexes must be freed in reverse order of creation and before    *
+ *           the json data is freed.                                          *
+ *                                                                            *
+ ******************************************************************************/
+zbx_json_index_t	*zbx_json_index_create(const struct zbx_json_parse *jp)
+{
+	zbx_json_index_t	*index;
+	zbx_vector_uint32_t	brackets;
+	const char		*p;
+
+	if ((size_t)(jp->end - jp->start) >= ZBX_MAX_UINT31_1)
+		return NULL;
+
+	index = (zbx_json_index_t *)zbx_malloc(NULL, sizeof(zbx_json_index_t));
+	index->start = jp->start;
+	index->end = jp->end;
+	index->hint = 0;
+
+	for (int i = 0; i < JSON_INDEX_BRACKETS_CACHE_SIZE; i++)
+		index->brackets[i].i = -1;
+
+	zbx_vector_uint32_create(&index->pos);
+	zbx_vector_uint32_create(&index->match);
+	zbx_vector_uint32_create(&brackets);
+
+	/* the characters are located with strcspn() which is vectorized by most C libraries */
+	for (p = jp->start; p <= jp->end; p++)
+	{
+		zbx_uint32_t	i, offset;
+
+		p += strcspn(p, "{}[],:\"");
+
+		if ('\0' == *p || p > jp->end)
+			break;
+
+		if ('"' == *p)
+		{
+			for (p++; '"' != *(p += strcspn(p, "\"\\")); p += 2)
+			{
+				if ('\0' == *p || '\0' == p[1])
+					goto fail;
+			}
+
+			continue;
+		}
+
+		offset = (zbx_uint32_t)(p - jp->start);
+		i = (zbx_uint32_t)index->pos.values_num;
+
+		zbx_vector_uint32_append(&index->pos, offset);
+		zbx_vector_uint32_append(&index->match, i);
+
+		switch (*p)
+		{
+			case '{':
+			case '[':
+				zbx_vector_uint32_append(&brackets, i);
+				break;
+			case '}':
+			case ']':
+				if (0 == brackets.values_num)
+					goto fail;
+
+				index->match.values[i] = brackets.values[--brackets.values_num];
+				index->match.values[index->match.values[i]] = i;
+				break;
+		}
+	}
+
+	if (0 != brackets.values_num)
+		goto fail;
+
+	zbx_vector_uint32_destroy(&brackets);
+
+	index->prev = json_index;
+	json_index = index;
+
+	return index;
+fail:
+	zbx_vector_uint32_destroy(&brackets);
+	zbx_vector_uint32_destroy(&index->match);
+	zbx_vector_uint32_destroy(&index->pos);
+	zbx_free(index);
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: free structural index of json data                                *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_json_index_free(zbx_json_index_t *index)
+{
+	if (NULL == index)
+		return;
+
+	if (json_index == index)
+		json_index = index->prev;
+	else
+		THIS_SHOULD_NEVER_HAPPEN;
+
+	zbx_vector_uint32_destroy(&index->match);
+	zbx_vector_uint32_destroy(&index->pos);
+	zbx_free(index);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get active structural index containing the specified location     *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_json_index_t	*json_index_get(const char *p)
+{
+	if (NULL == json_index || p < json_index->start || p > json_index->end)
+		return NULL;
+
+	return json_index;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: find the first structural character at or after the specified     *
+ *          location                                                          *
+ *                                                                            *
+ * Parameters: index - [IN] structural index                                  *
+ *             p     - [IN] location in json data                             *
+ *             lo    - [IN] the first structural character to search from     *
+ *             hi    - [IN] the last structural character to search to        *
+ *                                                                            *
+ * Return value: The index of structural character in pos vector or hi if     *
+ *               there are none between location and hi.                      *
+ *                                                                            *
+ ******************************************************************************/
+static int	json_index_find(zbx_json_index_t *index, const char *p, int lo, int hi)
+{
+	zbx_uint32_t	offset = (zbx_uint32_t)(p - index->start);
+	int		i;
+
+	/* check the last located character and the ones after it first */
+	for (i = MAX(index->hint, lo); i < index->hint + 3 && i <= hi; i++)
+	{
+		if ((i == hi || offset <= index->pos.values[i]) && (i == lo || offset > index->pos.values[i - 1]))
+			return i;
+	}
+
+	while (lo < hi)
+	{
+		int	mid = lo + (hi - lo) / 2;
+
+		if (index->pos.values[mid] < offset)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: find left bracket at the specified location                       *
+ *                                                                            *
+ * Return value: The index of bracket in pos vector or -1 if there is no      *
+ *               bracket at the location.                                     *
+ *                                                                            *
+ ******************************************************************************/
+static int	json_index_find_bracket(zbx_json_index_t *index, const char *p)
+{
+	zbx_uint32_t			offset = (zbx_uint32_t)(p - index->start);
+	zbx_json_index_bracket_t	*bracket = &index->brackets[offset % JSON_INDEX_BRACKETS_CACHE_SIZE];
+	int				i;
+
+	if (-1 != bracket->i && offset == bracket->offset)
+		return bracket->i;
+
+	if ('{' != *p && '[' != *p)
+		return -1;
+
+	i = json_index_find(index, p, 0, index->pos.values_num);
+
+	if (i == index->pos.values_num || offset != index->pos.values[i])
+		return -1;
+
+	bracket->offset = offset;
+	bracket->i = i;
+
+	return i;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: locate next pair or element using structural index                *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*json_index_next(zbx_json_index_t *index, const struct zbx_json_parse *jp, const char *p)
+{
+	zbx_uint32_t	end = (zbx_uint32_t)(jp->end - index->start);
+	int		i, lo = 0, hi = index->pos.values_num;
+
+	if (-1 != (i = json_index_find_bracket(index, jp->start)))
+	{
+		lo = i + 1;
+		hi = (int)index->match.values[i];
+	}
+
+	for (i = json_index_find(index, p, lo, hi); i < index->pos.values_num && index->pos.values[i] <= end; i++)
+	{
+		switch (index->start[index->pos.values[i]])
+		{
+			case '{':
+			case '[':
+				i = (int)index->match.values[i];
+				break;
+			case '}':
+			case ']':
+				index->hint = i;
+				return NULL;
+			case ',':
+				index->hint = i + 1;
+				p = index->start + index->pos.values[i] + 1;
+				SKIP_WHITESPACE(p);
+				return p;
+		}
+	}
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: locate right bracket using structural index if possible           *
+ *                                                                            *
+ * Return value: position of the right bracket                                *
+ *               NULL - an error occurred                                     *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*json_rbracket(const char *p)
+{
+	zbx_json_index_t	*index;
+
+	if (NULL != (index = json_index_get(p)))
+	{
+		int	i;
+
+		if (-1 != (i = json_index_find_bracket(index, p)))
+		{
+			index->hint = i + 1;
+			return index->start + index->pos.values[index->match.values[i]];
+		}
+	}
+
+	return __zbx_json_rbracket(p);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: open json buffer and check for brackets                           *
@@ -646,8 +948,9 @@ int	zbx_json_open(const char *buffer, struct zbx_json_parse *jp)
  ******************************************************************************/
 const char	*zbx_json_next(const struct zbx_json_parse *jp, const char *p)
 {
-	int	level = 0;
-	int	state = 0;	/* 0 - outside string; 1 - inside string */
+	int			level = 0;
+	int			state = 0;	/* 0 - outside string; 1 - inside string */
+	zbx_json_index_t	*index;
 
 	if (1 == jp->end - jp->start)	/* empty object or array */
 		return NULL;
@@ -659,6 +962,9 @@ const char	*zbx_json_next(const struct zbx_json_parse *jp, const char *p)
 		return p;
 	}
 
+	if (NULL != (index = json_index_get(p)) && jp->end <= index->end)
+		return json_index_next(index, jp, p);
+
 	while (p <= jp->end)
 	{
 		switch (*p)
@@ -1127,7 +1433,7 @@ int	zbx_json_value_by_name_dyn(const struct zbx_json_parse *jp, const char *name
  ******************************************************************************/
 int	zbx_json_brackets_open(const char *p, struct zbx_json_parse *jp)
 {
-	if (NULL == (jp->end = __zbx_json_rbracket(p)))
+	if (NULL == (jp->end = json_rbracket(p)))
 	{
 		zbx_set_json_strerror("cannot open JSON object or array \"%.64s\"", p);
 		return FAIL;
@@ -1254,7 +1560,7 @@ int	zbx_json_open_path(const struct zbx_json_parse *jp, const char *path, struct
 
 		object.start = p;
 
-		if (NULL == (object.end = __zbx_json_rbracket(p)))
+		if (NULL == (object.end = json_rbracket(p)))
 			object.end = p + json_parse_value(p, NULL, 0, NULL) - 1;
 	}
 
@@ -58,6 +58,8 @@ zbx_int64_t	json_error(const char *message, const char *ptr, char **error)
  * Purpose: Parses JSON string value or object name                           *
  *                                                                            *
  * Parameters: start - [IN] the JSON data without leading whitespace          *
+ *             doc   - [IN] the JSON document the data belongs to (can be     *
+ *                          NULL if str is NULL)                              *
  *             str   - [OUT] the parsed unquoted string (can be NULL)         *
  *             error - [OUT] the parsing error message (can be NULL)          *
  *                                                                            *
@@ -66,9 +68,10 @@ zbx_int64_t	json_error(const char *message, const char *ptr, char **error)
  *               message.                                                     *
  *                                                                            *
  ******************************************************************************/
-static zbx_int64_t	json_parse_string(const char *start, char **str, char **error)
+static zbx_int64_t	json_parse_string(const char *start, zbx_jsonobj_doc_t *doc, char **str, char **error)
 {
 	const char	*ptr = start;
+	int		escaped = 0;
 
 	/* skip starting '"' */
 	ptr++;
@@ -88,6 +91,8 @@ static zbx_int64_t	json_parse_string(const char *start, char **str, char **error
 			if ('\0' == *(++ptr))
 				return json_error("invalid escape sequence in string", escape_start, error);
 
+			escaped = 1;
+
 			switch (*ptr)
 			{
 				case '"':
@@ -121,16 +126,8 @@ static zbx_int64_t	json_parse_string(const char *start, char **str, char **error
 		ptr++;
 	}
 
-	if (NULL != str)
-	{
-		*str = (char *)zbx_malloc(NULL, (size_t)(ptr - start));
-
-		if (NULL == json_copy_string(start, *str, (size_t)(ptr - start)))
-		{
-			zbx_free(*str);
-			return json_error("invalid string data", start, error);
-		}
-	}
+	if (NULL != str && NULL == (*str = jsonobj_doc_string(doc, start, (size_t)(ptr - start), escaped)))
+		return json_error("invalid string data", start, error);
 
 	return ptr - start + 1;
 }
@@ -148,14 +145,18 @@ static zbx_int64_t	json_parse_string(const char *start, char **str, char **error
  *               error parameter (if not NULL) contains allocated error       *
  *               message.                                                     *
  *                                                                            *
+ * Comments: If object is specified, the JSON data must be the text of        *
+ *           the document the object belongs to.                              *
+ *                                                                            *
  ******************************************************************************/
 zbx_int64_t	json_parse_array(const char *start, zbx_jsonobj_t *obj, int depth, char **error)
 {
 	const char	*ptr = start;
 	zbx_int64_t	len;
+	int		values_start = 0;
 
 	if (NULL != obj)
-		jsonobj_init(obj, ZBX_JSON_TYPE_ARRAY);
+		values_start = obj->doc->values.values_num;
 
 	ptr++;
 	SKIP_WHITESPACE(ptr);
@@ -164,29 +165,20 @@ zbx_int64_t	json_parse_array(const char *start, zbx_jsonobj_t *obj, int depth, c
 	{
 		while (1)
 		{
-			zbx_jsonobj_t	*value;
+			zbx_jsonobj_t	value;
 
 			if (NULL != obj)
 			{
-				value = zbx_malloc(NULL, sizeof(zbx_jsonobj_t));
-				jsonobj_init(value, ZBX_JSON_TYPE_UNKNOWN);
+				jsonobj_init(&value, ZBX_JSON_TYPE_UNKNOWN);
+				value.doc = obj->doc;
 			}
-			else
-				value = NULL;
 
 			/* json_parse_value strips leading whitespace, so we don't have to do it here */
-			if (0 == (len = json_parse_value(ptr, value, depth, error)))
-			{
-				if (NULL != obj)
-				{
-					zbx_jsonobj_clear(value);
-					zbx_free(value);
-				}
+			if (0 == (len = json_parse_value(ptr, (NULL != obj ? &value : NULL), depth, error)))
 				return 0;
-			}
 
 			if (NULL != obj)
-				zbx_vector_jsonobj_ptr_append(&obj->data.array, value);
+				zbx_vector_jsonobj_append(&obj->doc->values, value);
 
 			ptr += len;
 			SKIP_WHITESPACE(ptr);
@@ -202,6 +194,9 @@ zbx_int64_t	json_parse_array(const char *start, zbx_jsonobj_t *obj, int depth, c
 			return json_error("invalid array format, expected closing character ']'", ptr, error);
 	}
 
+	if (NULL != obj)
+		jsonobj_set_array(obj, values_start);
+
 	return ptr - start + 1;
 }
 
@@ -350,7 +345,12 @@ zbx_int64_t	json_parse_value(const char *start, zbx_jsonobj_t *obj, int depth, c
 		case '\0':
 			return json_error("unexpected end of object value", NULL, error);
 		case '"':
-			if (0 == (len = json_parse_string(ptr, (NULL != obj ? &str : NULL), error)))
+			if (NULL == obj)
+				len = json_parse_string(ptr, NULL, NULL, error);
+			else
+				len = json_parse_string(ptr, obj->doc, &str, error);
+
+			if (0 == len)
 				return 0;
 
 			if (NULL != obj)
@@ -424,14 +424,18 @@ zbx_int64_t	json_parse_value(const char *start, zbx_jsonobj_t *obj, int depth, c
  *               error parameter (if not NULL) contains allocated error       *
  *               message.                                                     *
  *                                                                            *
+ * Comments: If object is specified, the JSON data must be the text of        *
+ *           the document the object belongs to.                              *
+ *                                                                            *
  ******************************************************************************/
 zbx_int64_t	json_parse_object(const char *start, zbx_jsonobj_t *obj, int depth, char **error)
 {
 	const char		*ptr = start;
 	zbx_int64_t		len;
+	int			elements_start = 0;
 
 	if (NULL != obj)
-		jsonobj_init(obj, ZBX_JSON_TYPE_OBJECT);
+		elements_start = obj->doc->elements.values_num;
 
 	/* parse object name */
 	SKIP_WHITESPACE(ptr);
@@ -448,10 +452,19 @@ zbx_int64_t	json_parse_object(const char *start, zbx_jsonobj_t *obj, int depth,
 			if ('"' != *ptr)
 				return json_error("invalid object name", ptr, error);
 
-			jsonobj_el_init(&el);
-
 			/* cannot parse object name, failing */
-			if (0 == (len = json_parse_string(ptr, (NULL != obj ? &el.name : NULL), error)))
+			if (NULL == obj)
+			{
+				len = json_parse_string(ptr, NULL, NULL, error);
+			}
+			else
+			{
+				jsonobj_init(&el.value, ZBX_JSON_TYPE_UNKNOWN);
+				el.value.doc = obj->doc;
+				len = json_parse_string(ptr, obj->doc, &el.name, error);
+			}
+
+			if (0 == len)
 				return 0;
 
 			ptr += len;
@@ -460,34 +473,16 @@ zbx_int64_t	json_parse_object(const char *start, zbx_jsonobj_t *obj, int depth,
 			SKIP_WHITESPACE(ptr);
 
 			if (':' != *ptr)
-			{
-				jsonobj_el_clear(&el);
 				return json_error("invalid object name/value separator", ptr, error);
-			}
 
 			ptr++;
 
 			if (0 == (len = json_parse_value(ptr, (NULL != obj ? &el.value : NULL), depth, error)))
-			{
-				jsonobj_el_clear(&el);
 				return 0;
-			}
 
+			/* elements with duplicate names are resolved when the parsed object is set */
 			if (NULL != obj)
-			{
-				zbx_jsonobj_el_t	*pel;
-
-				pel = (zbx_jsonobj_el_t *)zbx_hashset_insert(&obj->data.object, &el, sizeof(el));
-
-				/* check if they element was inserted, if not solve the conflict */
-				/* by overwriting old data                                       */
-				if (pel->name != el.name)
-				{
-					zbx_free(pel->name);
-					zbx_jsonobj_clear(&pel->value);
-					*pel = el;
-				}
-			}
+				zbx_vector_jsonobj_el_append(&obj->doc->elements, el);
 
 			ptr += len;
 
@@ -505,6 +500,9 @@ zbx_int64_t	json_parse_object(const char *start, zbx_jsonobj_t *obj, int depth,
 			return json_error("invalid object format, expected closing character '}'", ptr, error);
 	}
 
+	if (NULL != obj)
+		jsonobj_set_object(obj, elements_start);
+
 	return ptr - start + 1;
 }
 
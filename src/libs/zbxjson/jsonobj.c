@@ -23,26 +23,199 @@
 #include "json.h"
 #include "zbxstr.h"
 
-ZBX_PTR_VECTOR_IMPL(jsonobj_ptr, zbx_jsonobj_t *)
+ZBX_VECTOR_IMPL(jsonobj, zbx_jsonobj_t)
+ZBX_VECTOR_IMPL(jsonobj_el, zbx_jsonobj_el_t)
 ZBX_VECTOR_IMPL(jsonobj_ref, zbx_jsonobj_ref_t)
 
-/* jsonobject values hashset support */
+/* Objects with less elements are searched sequentially instead of creating index. Larger objects are */
+/* indexed when parsed, even if they are never searched by name. This adds hashset creation cost to */
+/* parsing, but parsed documents are never modified and can be queried by several threads without */
+/* locking. */
+#define JSONOBJ_INDEX_MIN_ELEMENTS	8
+
+#define JSONOBJ_CHUNK_SIZE_MIN		ZBX_KIBIBYTE
+#define JSONOBJ_CHUNK_SIZE_MAX		(256 * ZBX_KIBIBYTE)
+
+struct zbx_jsonobj_chunk
+{
+	zbx_jsonobj_chunk_t	*next;
+	size_t			size;
+	size_t			offset;
+};
+
+#define JSONOBJ_CHUNK_HEADER_SIZE	ZBX_SIZE_T_ALIGN8(sizeof(zbx_jsonobj_chunk_t))
+#define JSONOBJ_CHUNK_DATA(chunk)	((char *)(chunk) + JSONOBJ_CHUNK_HEADER_SIZE)
+
+/* json object index contains pointers to object elements */
 
 static zbx_hash_t	jsonobj_el_hash(const void *v)
 {
-	const zbx_jsonobj_el_t	*el = (const zbx_jsonobj_el_t *)v;
+	const zbx_jsonobj_el_t	*el = *(const zbx_jsonobj_el_t * const *)v;
 
 	return ZBX_DEFAULT_STRING_HASH_FUNC(el->name);
 }
 
 static int	jsonobj_el_compare(const void *v1, const void *v2)
 {
-	const zbx_jsonobj_el_t	*el1 = (const zbx_jsonobj_el_t *)v1;
-	const zbx_jsonobj_el_t	*el2 = (const zbx_jsonobj_el_t *)v2;
+	const zbx_jsonobj_el_t	*el1 = *(const zbx_jsonobj_el_t * const *)v1;
+	const zbx_jsonobj_el_t	*el2 = *(const zbx_jsonobj_el_t * const *)v2;
 
 	return strcmp(el1->name, el2->name);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: allocate memory from json document chunks                         *
+ *                                                                            *
+ * Parameters: doc  - [IN] the json document                                  *
+ *             size - [IN] the number of bytes to allocate                    *
+ *                                                                            *
+ * Return value: The allocated memory, freed together with the document.      *
+ *                                                                            *
+ * Comments: Chunk size is doubled with every new chunk up to the maximum     *
+ *           size, so small documents do not waste memory while large         *
+ *           documents need few allocations.                                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	*jsonobj_doc_malloc(zbx_jsonobj_doc_t *doc, size_t size)
+{
+	zbx_jsonobj_chunk_t	*chunk;
+	void			*ptr;
+
+	size = ZBX_SIZE_T_ALIGN8(size);
+
+	/* allocate large blocks in separate chunks to keep using the free space of the current chunk */
+	if (JSONOBJ_CHUNK_SIZE_MAX / 4 < size)
+	{
+		chunk = (zbx_jsonobj_chunk_t *)zbx_malloc(NULL, JSONOBJ_CHUNK_HEADER_SIZE + size);
+		chunk->size = chunk->offset = size;
+
+		if (NULL != doc->chunks)
+		{
+			chunk->next = doc->chunks->next;
+			doc->chunks->next = chunk;
+		}
+		else
+		{
+			chunk->next = NULL;
+			doc->chunks = chunk;
+		}
+
+		return JSONOBJ_CHUNK_DATA(chunk);
+	}
+
+	if (NULL == (chunk = doc->chunks) || chunk->size - chunk->offset < size)
+	{
+		size_t	chunk_size;
+
+		if (0 == doc->chunk_size)
+			doc->chunk_size = JSONOBJ_CHUNK_SIZE_MIN;
+		else if (JSONOBJ_CHUNK_SIZE_MAX > doc->chunk_size)
+			doc->chunk_size *= 2;
+
+		chunk_size = MAX(doc->chunk_size, size);
+		chunk = (zbx_jsonobj_chunk_t *)zbx_malloc(NULL, JSONOBJ_CHUNK_HEADER_SIZE + chunk_size);
+		chunk->size = chunk_size;
+		chunk->offset = 0;
+		chunk->next = doc->chunks;
+		doc->chunks = chunk;
+	}
+
+	ptr = JSONOBJ_CHUNK_DATA(chunk) + chunk->offset;
+	chunk->offset += size;
+
+	return ptr;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: create json document for parsing json data                        *
+ *                                                                            *
+ * Parameters: root - [IN] the object json data will be parsed into           *
+ *             data - [IN] the json data                                      *
+ *             len  - [IN] the json data length                               *
+ *                                                                            *
+ * Return value: The created document.                                        *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_jsonobj_doc_t	*jsonobj_doc_create(zbx_jsonobj_t *root, const char *data, size_t len)
+{
+	zbx_jsonobj_doc_t	*doc;
+
+	doc = (zbx_jsonobj_doc_t *)zbx_malloc(NULL, sizeof(zbx_jsonobj_doc_t));
+	doc->root = root;
+	doc->chunks = NULL;
+	doc->chunk_size = 0;
+	zbx_vector_ptr_create(&doc->indexes);
+	zbx_vector_jsonobj_create(&doc->values);
+	zbx_vector_jsonobj_el_create(&doc->elements);
+
+	doc->text = (char *)jsonobj_doc_malloc(doc, len + 1);
+	memcpy(doc->text, data, len);
+	doc->text[len] = '\0';
+
+	return doc;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: free json document together with all its objects                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	jsonobj_doc_free(zbx_jsonobj_doc_t *doc)
+{
+	zbx_jsonobj_chunk_t	*chunk;
+
+	for (int i = 0; i < doc->indexes.values_num; i++)
+		zbx_hashset_destroy((zbx_hashset_t *)doc->indexes.values[i]);
+
+	zbx_vector_ptr_destroy(&doc->indexes);
+	zbx_vector_jsonobj_destroy(&doc->values);
+	zbx_vector_jsonobj_el_destroy(&doc->elements);
+
+	while (NULL != (chunk = doc->chunks))
+	{
+		doc->chunks = chunk->next;
+		zbx_free(chunk);
+	}
+
+	zbx_free(doc);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get string value parsed from json document text                   *
+ *                                                                            *
+ * Parameters: doc     - [IN] the json document                               *
+ *             start   - [IN] the opening quote of string in document text    *
+ *             len     - [IN] the string length, including opening quote      *
+ *             escaped - [IN] 1 - the string contains escape sequences        *
+ *                            0 - otherwise                                   *
+ *                                                                            *
+ * Return value: The unquoted string or NULL if the string cannot be decoded. *
+ *                                                                            *
+ * Comments: The string is terminated or decoded in place inside document     *
+ *           text, without allocating memory. This works because unescaped    *
+ *           string is never longer than the escaped one and the parsing      *
+ *           never returns to the already parsed text.                        *
+ *                                                                            *
+ ******************************************************************************/
+char	*jsonobj_doc_string(zbx_jsonobj_doc_t *doc, const char *start, size_t len, int escaped)
+{
+	char	*str = doc->text + (start - doc->text);
+
+	if (0 == escaped)
+	{
+		str[len] = '\0';
+		return str + 1;
+	}
+
+	if (NULL == json_copy_string(start, str, len))
+		return NULL;
+
+	return str;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: initialize json object structure                                  *
@@ -54,19 +227,149 @@ static int	jsonobj_el_compare(const void *v1, const void *v2)
 void	jsonobj_init(zbx_jsonobj_t *obj, zbx_json_type_t type)
 {
 	obj->type = type;
+	obj->doc = NULL;
+	memset(&obj->data, 0, sizeof(obj->data));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: set array value to json object                                    *
+ *                                                                            *
+ * Parameters: obj          - [IN/OUT] the json object                        *
+ *             values_start - [IN] the index of the first array value in      *
+ *                                 document values being parsed               *
+ *                                                                            *
+ ******************************************************************************/
+void	jsonobj_set_array(zbx_jsonobj_t *obj, int values_start)
+{
+	zbx_jsonobj_doc_t	*doc = obj->doc;
+	zbx_jsonobj_array_t	*array = &obj->data.array;
+	size_t			size;
+
+	obj->type = ZBX_JSON_TYPE_ARRAY;
+	array->values_num = doc->values.values_num - values_start;
 
-	switch (type)
+	if (0 == array->values_num)
 	{
-		case ZBX_JSON_TYPE_ARRAY:
-			zbx_vector_jsonobj_ptr_create(&obj->data.array);
-			break;
-		case ZBX_JSON_TYPE_OBJECT:
-			zbx_hashset_create(&obj->data.object, 0, jsonobj_el_hash, jsonobj_el_compare);
-			break;
-		default:
-			memset(&obj->data, 0, sizeof(obj->data));
-			break;
+		array->values = NULL;
+		return;
 	}
+
+	size = sizeof(zbx_jsonobj_t) * (size_t)array->values_num;
+	array->values = (zbx_jsonobj_t *)jsonobj_doc_malloc(doc, size);
+	memcpy(array->values, doc->values.values + values_start, size);
+
+	doc->values.values_num = values_start;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: find object element by name                                       *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_jsonobj_el_t	*jsonobj_object_find_el(const zbx_jsonobj_object_t *object, const char *name)
+{
+	zbx_jsonobj_el_t	el_local, *el = &el_local, **pel;
+
+	if (NULL == object->index)
+	{
+		for (int i = 0; i < object->values_num; i++)
+		{
+			if (0 == strcmp(object->values[i].name, name))
+				return &object->values[i];
+		}
+
+		return NULL;
+	}
+
+	el_local.name = (char *)name;
+
+	if (NULL == (pel = (zbx_jsonobj_el_t **)zbx_hashset_search(object->index, &el)))
+		return NULL;
+
+	return *pel;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: remove overridden elements of parsed object and create element    *
+ *          index for larger objects                                          *
+ *                                                                            *
+ * Parameters: doc    - [IN] the json document                                *
+ *             object - [IN/OUT] the parsed object                            *
+ *                                                                            *
+ * Comments: If object has several elements with the same name, only the last *
+ *           one is kept. Elements are checked from the last one and moved    *
+ *           towards the end of array, so the already indexed elements are    *
+ *           never moved. The object is not changed after parsing, so it can  *
+ *           be searched by multiple threads without locking.                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	jsonobj_index_elements(zbx_jsonobj_doc_t *doc, zbx_jsonobj_object_t *object)
+{
+	zbx_jsonobj_el_t	*values = object->values;
+	int			i, values_num = object->values_num;
+
+	if (JSONOBJ_INDEX_MIN_ELEMENTS <= values_num)
+	{
+		object->index = (zbx_hashset_t *)jsonobj_doc_malloc(doc, sizeof(zbx_hashset_t));
+		zbx_hashset_create(object->index, (size_t)values_num, jsonobj_el_hash, jsonobj_el_compare);
+		zbx_vector_ptr_append(&doc->indexes, object->index);
+	}
+
+	object->values += values_num;
+	object->values_num = 0;
+
+	for (i = values_num - 1; 0 <= i; i--)
+	{
+		zbx_jsonobj_el_t	*el;
+
+		if (NULL != jsonobj_object_find_el(object, values[i].name))
+			continue;
+
+		el = --object->values;
+		object->values_num++;
+
+		if (el != &values[i])
+			*el = values[i];
+
+		if (NULL != object->index)
+			zbx_hashset_insert(object->index, &el, sizeof(el));
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: set object value to json object                                   *
+ *                                                                            *
+ * Parameters: obj            - [IN/OUT] the json object                      *
+ *             elements_start - [IN] the index of the first object element in *
+ *                                   document elements being parsed           *
+ *                                                                            *
+ ******************************************************************************/
+void	jsonobj_set_object(zbx_jsonobj_t *obj, int elements_start)
+{
+	zbx_jsonobj_doc_t	*doc = obj->doc;
+	zbx_jsonobj_object_t	*object = &obj->data.object;
+	size_t			size;
+
+	obj->type = ZBX_JSON_TYPE_OBJECT;
+	object->values_num = doc->elements.values_num - elements_start;
+	object->index = NULL;
+
+	if (0 == object->values_num)
+	{
+		object->values = NULL;
+		return;
+	}
+
+	size = sizeof(zbx_jsonobj_el_t) * (size_t)object->values_num;
+	object->values = (zbx_jsonobj_el_t *)jsonobj_doc_malloc(doc, size);
+	memcpy(object->values, doc->elements.values + elements_start, size);
+
+	doc->elements.values_num = elements_start;
+
+	jsonobj_index_elements(doc, object);
 }
 
 /******************************************************************************
@@ -123,68 +426,77 @@ void	jsonobj_set_null(zbx_jsonobj_t *obj)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: initialize json object element                                    *
+ * Purpose: free resources allocated by json object                           *
+ *                                                                            *
+ * Comments: Objects parsed from json data belong to the json document and    *
+ *           are freed together with it when the root object is cleared.      *
  *                                                                            *
  ******************************************************************************/
-void	jsonobj_el_init(zbx_jsonobj_el_t *el)
+void	zbx_jsonobj_clear(zbx_jsonobj_t *obj)
 {
-	el->name = NULL;
-	jsonobj_init(&el->value, ZBX_JSON_TYPE_UNKNOWN);
+	if (NULL == obj->doc)
+	{
+		if (ZBX_JSON_TYPE_STRING == obj->type)
+			zbx_free(obj->data.string);
+	}
+	else if (obj == obj->doc->root)
+	{
+		jsonobj_doc_free(obj->doc);
+		obj->doc = NULL;
+	}
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: free resources allocated by json object element                   *
+ * Purpose: get json object element by name                                   *
  *                                                                            *
- ******************************************************************************/
-void	jsonobj_el_clear(zbx_jsonobj_el_t *el)
-{
-	zbx_free(el->name);
-	zbx_jsonobj_clear(&el->value);
-}
-
-/******************************************************************************
+ * Parameters: obj  - [IN] the json object                                    *
+ *             name - [IN] the element name                                   *
+ *                                                                            *
+ * Return value: The object element or NULL if the object has no element      *
+ *               with such name.                                              *
  *                                                                            *
- * Purpose: free json object                                                  *
+ * Comments: If object has several elements with the same name, the last one  *
+ *           is returned. Larger objects are searched using element index     *
+ *           created during parsing.                                          *
  *                                                                            *
  ******************************************************************************/
-static void	jsonobj_free(zbx_jsonobj_t *obj)
+zbx_jsonobj_el_t	*zbx_jsonobj_get_el(zbx_jsonobj_t *obj, const char *name)
 {
-	zbx_jsonobj_clear(obj);
-	zbx_free(obj);
+	if (ZBX_JSON_TYPE_OBJECT != obj->type)
+		return NULL;
+
+	return jsonobj_object_find_el(&obj->data.object, name);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: free resources allocated by json object                           *
+ * Purpose: iterate json object elements                                      *
+ *                                                                            *
+ * Parameters: obj - [IN] the json object                                     *
+ *             el  - [IN] the previous element, NULL to get the first one     *
+ *                                                                            *
+ * Return value: The next object element or NULL if there are no more         *
+ *               elements.                                                    *
+ *                                                                            *
+ * Comments: Elements are returned in the order they appear in json data,     *
+ *           skipping elements overridden by later ones with the same name.   *
  *                                                                            *
  ******************************************************************************/
-void	zbx_jsonobj_clear(zbx_jsonobj_t *obj)
+zbx_jsonobj_el_t	*zbx_jsonobj_next_el(zbx_jsonobj_t *obj, zbx_jsonobj_el_t *el)
 {
-	zbx_jsonobj_el_t	*el;
-	zbx_hashset_iter_t	iter;
+	zbx_jsonobj_object_t	*object = &obj->data.object;
 
-	switch (obj->type)
-	{
-		case ZBX_JSON_TYPE_STRING:
-			zbx_free(obj->data.string);
-			break;
-		case ZBX_JSON_TYPE_ARRAY:
-			zbx_vector_jsonobj_ptr_clear_ext(&obj->data.array, jsonobj_free);
-			zbx_vector_jsonobj_ptr_destroy(&obj->data.array);
-			break;
-		case ZBX_JSON_TYPE_OBJECT:
-			zbx_hashset_iter_reset(&obj->data.object, &iter);
-			while (NULL != (el = (zbx_jsonobj_el_t *)zbx_hashset_iter_next(&iter)))
-			{
-				zbx_free(el->name);
-				zbx_jsonobj_clear(&el->value);
-			}
-			zbx_hashset_destroy(&obj->data.object);
-			break;
-		default:
-			break;
-	}
+	if (ZBX_JSON_TYPE_OBJECT != obj->type || 0 == object->values_num)
+		return NULL;
+
+	if (NULL == el)
+		return object->values;
+
+	if (++el == object->values + object->values_num)
+		return NULL;
+
+	return el;
 }
 
 /******************************************************************************
@@ -196,8 +508,7 @@ int	zbx_jsonobj_to_string(char **str, size_t *str_alloc, size_t *str_offset, zbx
 {
 	char			*tmp, buf[32];
 	int			i;
-	zbx_hashset_iter_t	iter;
-	zbx_jsonobj_el_t	*el;
+	zbx_jsonobj_el_t	*el = NULL;
 
 	switch (obj->type)
 	{
@@ -227,14 +538,13 @@ int	zbx_jsonobj_to_string(char **str, size_t *str_alloc, size_t *str_offset, zbx
 				if (0 != i)
 					zbx_chrcpy_alloc(str, str_alloc, str_offset, ',');
 
-				zbx_jsonobj_to_string(str, str_alloc, str_offset, obj->data.array.values[i]);
+				zbx_jsonobj_to_string(str, str_alloc, str_offset, &obj->data.array.values[i]);
 			}
 			zbx_chrcpy_alloc(str, str_alloc, str_offset, ']');
 			break;
 		case ZBX_JSON_TYPE_OBJECT:
 			zbx_chrcpy_alloc(str, str_alloc, str_offset, '{');
-			zbx_hashset_iter_reset(&obj->data.object, &iter);
-			while (NULL != (el = (zbx_jsonobj_el_t *)zbx_hashset_iter_next(&iter)))
+			while (NULL != (el = zbx_jsonobj_next_el(obj, el)))
 			{
 				if ((*str)[*str_offset - 1] != '{')
 					zbx_chrcpy_alloc(str, str_alloc, str_offset, ',');
@@ -259,32 +569,53 @@ int	zbx_jsonobj_to_string(char **str, size_t *str_alloc, size_t *str_offset, zbx
 
 /******************************************************************************
  *                                                                            *
- * Purpose: parses json formatted data into json object structure             *
+ * Purpose: parses json formatted data of the specified length into json      *
+ *          object structure                                                  *
+ *                                                                            *
+ * Parameters: data - [IN] the json data                                      *
+ *             len  - [IN] the json data length                               *
+ *             obj  - [OUT] the parsed json object                            *
+ *                                                                            *
+ * Return value: SUCCEED - the json data was parsed successfully              *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Only the specified data is copied, so a value located inside     *
+ *           larger json document can be parsed without copying the rest of   *
+ *           the document.                                                    *
  *                                                                            *
  ******************************************************************************/
-int	zbx_jsonobj_open(const char *data, zbx_jsonobj_t *obj)
+int	zbx_jsonobj_open_len(const char *data, size_t len, zbx_jsonobj_t *obj)
 {
-	int	ret = FAIL;
-	char	*error = NULL;
+	int		ret = FAIL;
+	char		*error = NULL;
+	const char	*start = data;
 
 	SKIP_WHITESPACE(data);
 
-	switch (*data)
+	jsonobj_init(obj, ZBX_JSON_TYPE_UNKNOWN);
+
+	if (len <= (size_t)(data - start) || ('{' != *data && '[' != *data))
 	{
-		case '{':
-			if (0 == json_parse_object(data, obj, 0, &error))
-				goto out;
-			break;
-		case '[':
-			if (0 == json_parse_array(data, obj, 0, &error))
-				goto out;
-			break;
-		default:
-			/* not json data, failing */
-			jsonobj_init(obj, ZBX_JSON_TYPE_UNKNOWN);
-			(void)json_error("invalid object format, expected opening character '{' or '['", data, &error);
+		/* not json data, failing */
+		(void)json_error("invalid object format, expected opening character '{' or '['", data, &error);
+		goto out;
+	}
+
+	len -= (size_t)(data - start);
+
+	obj->doc = jsonobj_doc_create(obj, data, len);
+
+	if ('{' == *data)
+	{
+		if (0 == json_parse_object(obj->doc->text, obj, 0, &error))
 			goto out;
 	}
+	else if (0 == json_parse_array(obj->doc->text, obj, 0, &error))
+		goto out;
+
+	/* parsing is finished, free memory used for parsing arrays and objects */
+	zbx_vector_jsonobj_destroy(&obj->doc->values);
+	zbx_vector_jsonobj_el_destroy(&obj->doc->elements);
 
 	ret = SUCCEED;
 out:
@@ -298,6 +629,16 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parses json formatted data into json object structure             *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_jsonobj_open(const char *data, zbx_jsonobj_t *obj)
+{
+	return zbx_jsonobj_open_len(data, strlen(data), obj);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: free resources allocated by json object reference                 *
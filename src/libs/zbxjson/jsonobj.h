@@ -22,6 +22,32 @@
 
 #include "zbxjson.h"
 
+ZBX_VECTOR_DECL(jsonobj, zbx_jsonobj_t)
+ZBX_VECTOR_DECL(jsonobj_el, zbx_jsonobj_el_t)
+
+typedef struct zbx_jsonobj_chunk zbx_jsonobj_chunk_t;
+
+/* json document, owning all objects parsed from json data */
+struct zbx_jsonobj_doc
+{
+	/* the object json data was parsed into */
+	zbx_jsonobj_t		*root;
+
+	/* copy of json data, parsed strings are stored inside it */
+	char			*text;
+
+	/* memory chunks objects, arrays and object indexes are allocated from */
+	zbx_jsonobj_chunk_t	*chunks;
+	size_t			chunk_size;
+
+	/* the created object indexes */
+	zbx_vector_ptr_t	indexes;
+
+	/* array values and object elements being parsed, moved to chunks when parsing is finished */
+	zbx_vector_jsonobj_t	values;
+	zbx_vector_jsonobj_el_t	elements;
+};
+
 typedef struct
 {
 	char		*name;
@@ -36,9 +62,10 @@ ZBX_VECTOR_DECL(jsonobj_ref, zbx_jsonobj_ref_t)
 
 void	jsonobj_init(zbx_jsonobj_t *obj, zbx_json_type_t type);
 
-void	jsonobj_el_init(zbx_jsonobj_el_t *el);
-void	jsonobj_el_clear(zbx_jsonobj_el_t *el);
+char	*jsonobj_doc_string(zbx_jsonobj_doc_t *doc, const char *start, size_t len, int escaped);
 
+void	jsonobj_set_array(zbx_jsonobj_t *obj, int values_start);
+void	jsonobj_set_object(zbx_jsonobj_t *obj, int elements_start);
 void	jsonobj_set_string(zbx_jsonobj_t *obj, char *str);
 void	jsonobj_set_number(zbx_jsonobj_t *obj, double number);
 void	jsonobj_set_true(zbx_jsonobj_t *obj);
@@ -1678,11 +1678,11 @@ static int	jsonpath_query_next_segment(zbx_jsonpath_context_t *ctx, const char *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static int	jsonpath_match_name(zbx_jsonpath_context_t *ctx, const zbx_jsonobj_t *parent, int path_depth)
+static int	jsonpath_match_name(zbx_jsonpath_context_t *ctx, zbx_jsonobj_t *parent, int path_depth)
 {
 	const zbx_jsonpath_segment_t	*segment = &ctx->path->segments[path_depth];
 	zbx_jsonpath_list_node_t	*node;
-	zbx_jsonobj_el_t		el_local, *el;
+	zbx_jsonobj_el_t		*el;
 
 	/* object contents can match only name list */
 	if (ZBX_JSONPATH_LIST_NAME != segment->data.list.type)
@@ -1690,8 +1690,7 @@ static int	jsonpath_match_name(zbx_jsonpath_context_t *ctx, const zbx_jsonobj_t
 
 	for (node = segment->data.list.values; NULL != node; node = node->next)
 	{
-		el_local.name = node->data;
-		if (NULL != (el = (zbx_jsonobj_el_t *)zbx_hashset_search(&parent->data.object, &el_local)))
+		if (NULL != (el = zbx_jsonobj_get_el(parent, node->data)))
 		{
 			if (FAIL == jsonpath_query_next_segment(ctx, el->name, &el->value, path_depth))
 				return FAIL;
@@ -2228,8 +2227,7 @@ static int	jsonpath_query_object(zbx_jsonpath_context_t *ctx, zbx_jsonobj_t *obj
 {
 	const zbx_jsonpath_segment_t	*segment;
 	int				ret = SUCCEED;
-	zbx_hashset_iter_t		iter;
-	zbx_jsonobj_el_t		*el;
+	zbx_jsonobj_el_t		*el = NULL;
 
 	segment = &ctx->path->segments[path_depth];
 
@@ -2249,9 +2247,7 @@ static int	jsonpath_query_object(zbx_jsonpath_context_t *ctx, zbx_jsonobj_t *obj
 
 	}
 #endif
-	zbx_hashset_iter_reset(&obj->data.object, &iter);
-	while (NULL != (el = (zbx_jsonobj_el_t *)zbx_hashset_iter_next(&iter)) && SUCCEED == ret &&
-			0 == ctx->found)
+	while (NULL != (el = zbx_jsonobj_next_el(obj, el)) && SUCCEED == ret && 0 == ctx->found)
 	{
 		switch (segment->type)
 		{
@@ -2308,7 +2304,7 @@ static int	jsonpath_match_index(zbx_jsonpath_context_t *ctx, zbx_jsonobj_t *pare
 
 			zbx_snprintf(name, sizeof(name), "%d", query_index);
 
-			if (FAIL == jsonpath_query_next_segment(ctx, name, parent->data.array.values[query_index],
+			if (FAIL == jsonpath_query_next_segment(ctx, name, &parent->data.array.values[query_index],
 					path_depth))
 			{
 				return FAIL;
@@ -2357,7 +2353,7 @@ static int	jsonpath_match_range(zbx_jsonpath_context_t *ctx, zbx_jsonobj_t *pare
 
 		zbx_snprintf(name, sizeof(name), "%d", i);
 
-		if (FAIL == jsonpath_query_next_segment(ctx, name, parent->data.array.values[i], path_depth))
+		if (FAIL == jsonpath_query_next_segment(ctx, name, &parent->data.array.values[i], path_depth))
 			return FAIL;
 	}
 
@@ -2422,17 +2418,17 @@ static int	jsonpath_query_array(zbx_jsonpath_context_t *ctx, zbx_jsonobj_t *arra
 		switch (segment->type)
 		{
 			case ZBX_JSONPATH_SEGMENT_MATCH_ALL:
-				ret = jsonpath_query_next_segment(ctx, name, array->data.array.values[i], path_depth);
+				ret = jsonpath_query_next_segment(ctx, name, &array->data.array.values[i], path_depth);
 				break;
 			case ZBX_JSONPATH_SEGMENT_MATCH_EXPRESSION:
-				ret = jsonpath_match_expression(ctx, name, array->data.array.values[i], path_depth);
+				ret = jsonpath_match_expression(ctx, name, &array->data.array.values[i], path_depth);
 				break;
 			default:
 				break;
 		}
 
 		if (1 == segment->detached)
-			ret = jsonpath_query_contents(ctx, array->data.array.values[i], path_depth);
+			ret = jsonpath_query_contents(ctx, &array->data.array.values[i], path_depth);
 	}
 
 	return ret;
@@ -2545,7 +2541,7 @@ static int	jsonpath_apply_function(const zbx_vector_jsonobj_ref_t *in, zbx_jsonp
 			char	name[MAX_ID_LEN + 1];
 
 			zbx_snprintf(name, sizeof(name), "%d", i);
-			zbx_vector_jsonobj_ref_add_object(&tmp, name, in->values[0].value->data.array.values[i]);
+			zbx_vector_jsonobj_ref_add_object(&tmp, name, &in->values[0].value->data.array.values[i]);
 		}
 
 		in = &tmp;
@@ -2854,7 +2850,7 @@ int	zbx_jsonpath_query(const struct zbx_json_parse *jp, const char *path, char *
 	int		ret;
 	zbx_jsonobj_t	obj;
 
-	if (SUCCEED != zbx_jsonobj_open(jp->start, &obj))
+	if (SUCCEED != zbx_jsonobj_open_len(jp->start, (size_t)(jp->end - jp->start + 1), &obj))
 		return FAIL;
 
 	ret = zbx_jsonobj_query(&obj, path, output);
@@ -2872,30 +2868,30 @@ static void	jsonpath_ctx_clear(zbx_jsonpath_context_t *ctx)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: perform jsonpath query on the specified json object               *
+ * Purpose: perform compiled jsonpath query on the specified json object      *
  *                                                                            *
- * Parameters: obj    - [IN] json object                                  *
- *             index  - [IN] jsonpath index (optional)                        *
- *             path   - [IN] jsonpath                                         *
- *             output - [OUT] output value                                    *
+ * Parameters: obj      - [IN] json object                                    *
+ *             index    - [IN] jsonpath index (optional)                      *
+ *             jsonpath - [IN] compiled jsonpath                              *
+ *             output   - [OUT] output value                                  *
  *                                                                            *
  * Return value: SUCCEED - the query was performed successfully (empty result *
  *                         being counted as successful query)                 *
  *               FAIL    - otherwise                                          *
  *                                                                            *
+ * Comments: The compiled jsonpath is not modified during query, so it can be *
+ *           shared between threads.                                          *
+ *                                                                            *
  ******************************************************************************/
-int	zbx_jsonobj_query_ext(zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, const char *path, char **output)
+int	zbx_jsonobj_query_compiled(zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, const zbx_jsonpath_t *jsonpath,
+		char **output)
 {
 	zbx_jsonpath_context_t	ctx;
-	zbx_jsonpath_t		jsonpath;
 	int			ret = SUCCEED;
 
-	if (FAIL == zbx_jsonpath_compile(path, &jsonpath))
-		return FAIL;
-
 	ctx.found = 0;
 	ctx.root = obj;
-	ctx.path = &jsonpath;
+	ctx.path = jsonpath;
 	zbx_vector_jsonobj_ref_create(&ctx.objects);
 	ctx.index = index;
 
@@ -2914,15 +2910,15 @@ int	zbx_jsonobj_query_ext(zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, const
 	if (SUCCEED == ret)
 	{
 		zbx_vector_jsonobj_ref_t	out;
-		int				definite_path = jsonpath.definite, path_depth;
+		int				definite_path = jsonpath->definite, path_depth;
 
 		zbx_vector_jsonobj_ref_create(&out);
 
-		path_depth = jsonpath.segments_num;
-		while (0 < path_depth && ZBX_JSONPATH_SEGMENT_FUNCTION == jsonpath.segments[path_depth - 1].type)
+		path_depth = jsonpath->segments_num;
+		while (0 < path_depth && ZBX_JSONPATH_SEGMENT_FUNCTION == jsonpath->segments[path_depth - 1].type)
 			path_depth--;
 
-		if (path_depth < jsonpath.segments_num)
+		if (path_depth < jsonpath->segments_num)
 		{
 			if (SUCCEED == (ret = jsonpath_apply_functions(&ctx, path_depth, &definite_path, &out)))
 				ret = jsonpath_format_query_result(&out, definite_path, output);
@@ -2935,6 +2931,34 @@ int	zbx_jsonobj_query_ext(zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, const
 	}
 
 	jsonpath_ctx_clear(&ctx);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: perform jsonpath query on the specified json object               *
+ *                                                                            *
+ * Parameters: obj    - [IN] json object                                      *
+ *             index  - [IN] jsonpath index (optional)                        *
+ *             path   - [IN] jsonpath                                         *
+ *             output - [OUT] output value                                    *
+ *                                                                            *
+ * Return value: SUCCEED - the query was performed successfully (empty result *
+ *                         being counted as successful query)                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_jsonobj_query_ext(zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, const char *path, char **output)
+{
+	zbx_jsonpath_t	jsonpath;
+	int		ret;
+
+	if (FAIL == zbx_jsonpath_compile(path, &jsonpath))
+		return FAIL;
+
+	ret = zbx_jsonobj_query_compiled(obj, index, &jsonpath, output);
+
 	zbx_jsonpath_clear(&jsonpath);
 
 	return ret;
@@ -3054,11 +3078,9 @@ static zbx_hashset_t	*jsonpath_index_add(zbx_jsonpath_index_t *index, zbx_jsonob
 
 	if (ZBX_JSON_TYPE_OBJECT == obj->type)
 	{
-		zbx_hashset_iter_t	iter;
-		zbx_jsonobj_el_t	*el;
+		zbx_jsonobj_el_t	*el = NULL;
 
-		zbx_hashset_iter_reset(&obj->data.object, &iter);
-		while (NULL != (el = (zbx_jsonobj_el_t *)zbx_hashset_iter_next(&iter)))
+		while (NULL != (el = zbx_jsonobj_next_el(obj, el)))
 		{
 			ctx.found = 0;
 			if (SUCCEED == jsonpath_query_contents(&ctx, &el->value, 0) && 1 == ctx.objects.values_num)
@@ -3077,7 +3099,7 @@ static zbx_hashset_t	*jsonpath_index_add(zbx_jsonpath_index_t *index, zbx_jsonob
 		for (i = 0; i < obj->data.array.values_num; i++)
 		{
 			char		name[MAX_ID_LEN + 1];
-			zbx_jsonobj_t	*value = obj->data.array.values[i];
+			zbx_jsonobj_t	*value = &obj->data.array.values[i];
 
 			zbx_snprintf(name, sizeof(name), "%d", i);
 
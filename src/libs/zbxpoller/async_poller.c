@@ -133,7 +133,8 @@ static void	process_snmp_result(void *data)
 	zbx_snmp_context_t	*snmp_context = (zbx_snmp_context_t *)data;
 	zbx_poller_config_t	*poller_config = (zbx_poller_config_t *)zbx_async_check_snmp_get_arg(snmp_context);
 
-	process_async_result(zbx_async_check_snmp_get_item_context(snmp_context), poller_config);
+	for (int i = 0; i < zbx_async_check_snmp_get_items_num(snmp_context); i++)
+		process_async_result(zbx_async_check_snmp_get_item_context(snmp_context, i), poller_config);
 
 	zbx_async_check_snmp_clean(snmp_context);
 }
@@ -251,6 +252,9 @@ static void	async_initiate_queued_checks(zbx_poller_config_t *poller_config, con
 	for (int j = 0; j < poller_items.values_num; j++)
 	{
 		int	num;
+#ifdef HAVE_NETSNMP
+		int	snmp_num = 0;
+#endif
 
 		items = poller_items.values[j]->items;
 		results = poller_items.values[j]->results;
@@ -286,11 +290,9 @@ static void	async_initiate_queued_checks(zbx_poller_config_t *poller_config, con
 			else
 			{
 	#ifdef HAVE_NETSNMP
-				zbx_set_snmp_bulkwalk_options(zbx_progname);
-
-				errcodes[i] = zbx_async_check_snmp(&items[i], &results[i], process_snmp_result,
-						poller_config, poller_config, poller_config->base,
-						poller_config->dnsbase, poller_config->config_source_ip);
+				/* SNMP items are started together to coalesce requests to the same interface */
+				snmp_num++;
+				continue;
 	#else
 				errcodes[i] = NOTSUPPORTED;
 				SET_MSG_RESULT(&results[i], zbx_strdup(NULL, "Support for SNMP checks was not compiled"
@@ -301,6 +303,16 @@ static void	async_initiate_queued_checks(zbx_poller_config_t *poller_config, con
 			if (SUCCEED == errcodes[i])
 				poller_config->processing++;
 		}
+#ifdef HAVE_NETSNMP
+		if (0 != snmp_num)
+		{
+			zbx_set_snmp_bulkwalk_options(zbx_progname);
+
+			poller_config->processing += zbx_async_check_snmp_items(items, results, errcodes, num,
+					process_snmp_result, poller_config, poller_config, poller_config->base,
+					poller_config->dnsbase, poller_config->config_source_ip);
+		}
+#endif
 
 		zbx_timespec(&timespec);
 
@@ -759,6 +759,26 @@ int	get_value_internal(const zbx_dc_item_t *item, AGENT_RESULT *result, const zb
 				goto out;
 			}
 		}
+		else if (0 == strcmp(tmp, "sync"))
+		{
+			if (NULL == tmp1 || '\0' == *tmp1 || 0 == strcmp(tmp1, "batch"))
+			{
+				SET_UI64_RESULT(result, *(zbx_uint64_t *)zbx_dc_get_stats(ZBX_STATS_SYNC_BATCH_SIZE));
+			}
+			else if (0 == strcmp(tmp1, "values"))
+			{
+				SET_UI64_RESULT(result, *(zbx_uint64_t *)zbx_dc_get_stats(ZBX_STATS_SYNC_BATCH_VALUES));
+			}
+			else if (0 == strcmp(tmp1, "time"))
+			{
+				SET_DBL_RESULT(result, *(double *)zbx_dc_get_stats(ZBX_STATS_SYNC_BATCH_TIME));
+			}
+			else
+			{
+				SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid third parameter."));
+				goto out;
+			}
+		}
 		else
 		{
 			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid second parameter."));
@@ -986,6 +1006,59 @@ int	get_value_internal(const zbx_dc_item_t *item, AGENT_RESULT *result, const zb
 
 		SET_UI64_RESULT(result, zbx_preprocessor_get_queue_size());
 	}
+	else if (0 == strcmp(tmp, "regexp_cache"))			/* zabbix[regexp_cache,<mode>] */
+	{
+		zbx_regexp_cache_stats_t	stats;
+		char				*error = NULL;
+
+		if (2 < nparams)
+		{
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid number of parameters."));
+			goto out;
+		}
+
+		if (FAIL == zbx_preprocessor_get_regexp_cache_stats(&stats, &error))
+		{
+			SET_MSG_RESULT(result, error);
+			goto out;
+		}
+
+		tmp = get_rparam(&request, 1);
+
+		if (NULL == tmp || '\0' == *tmp || 0 == strcmp(tmp, "all"))
+		{
+			SET_UI64_RESULT(result, stats.hits + stats.misses);
+		}
+		else if (0 == strcmp(tmp, "hits"))
+		{
+			SET_UI64_RESULT(result, stats.hits);
+		}
+		else if (0 == strcmp(tmp, "misses"))
+		{
+			SET_UI64_RESULT(result, stats.misses);
+		}
+		else if (0 == strcmp(tmp, "evictions"))
+		{
+			SET_UI64_RESULT(result, stats.evictions);
+		}
+		else if (0 == strcmp(tmp, "phits"))
+		{
+			zbx_uint64_t	total = stats.hits + stats.misses;
+
+			SET_DBL_RESULT(result, (0 == total ? 0 : (double)stats.hits / (double)total * 100));
+		}
+		else if (0 == strcmp(tmp, "pmisses"))
+		{
+			zbx_uint64_t	total = stats.hits + stats.misses;
+
+			SET_DBL_RESULT(result, (0 == total ? 0 : (double)stats.misses / (double)total * 100));
+		}
+		else
+		{
+			SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid second parameter."));
+			goto out;
+		}
+	}
 	else if (0 == strcmp(tmp, "discovery_queue"))			/* zabbix[discovery_queue] */
 	{
 		zbx_uint64_t	size;
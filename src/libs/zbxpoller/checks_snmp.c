@@ -110,6 +110,16 @@ typedef struct
 }
 zbx_snmpidx_main_key_t;
 
+/* SNMP agent the dynamic index cache entries belong to */
+typedef struct
+{
+	const char	*addr;
+	unsigned short	port;
+	const char	*community_context;	/* community (SNMPv1 or v2c) or contextName (SNMPv3) */
+	const char	*security_name;		/* only SNMPv3, empty string in case of other versions */
+}
+zbx_snmpidx_agent_t;
+
 typedef struct
 {
 	char		*value;
@@ -149,6 +159,78 @@ zbx_bulkwalk_context_t;
 ZBX_PTR_VECTOR_DECL(bulkwalk_context, zbx_bulkwalk_context_t*)
 ZBX_PTR_VECTOR_IMPL(bulkwalk_context, zbx_bulkwalk_context_t*)
 
+#define ZBX_SNMP_ITEM_QUERY	0	/* value OID is known */
+#define ZBX_SNMP_ITEM_VERIFY	1	/* cached dynamic index must be verified before querying value */
+#define ZBX_SNMP_ITEM_WALK	2	/* dynamic index must be found by walking index table */
+#define ZBX_SNMP_ITEM_DONE	3
+
+/* regular (normal or dynamic index) SNMP item coalesced into a shared GET request context */
+typedef struct
+{
+	zbx_dc_item_context_t	*item;
+	unsigned char		state;
+	char			*snmp_oid;
+	oid			name[MAX_OID_LEN];
+	size_t			name_length;
+	char			*value_oid;			/* dynamic items only */
+	char			*index_oid;			/* dynamic items only */
+	char			*index_value;			/* dynamic items only */
+	oid			index_name[MAX_OID_LEN];	/* dynamic items only, cached index to verify */
+	size_t			index_name_length;
+}
+zbx_snmp_get_item_t;
+
+ZBX_PTR_VECTOR_DECL(snmp_get_item_ptr, zbx_snmp_get_item_t *)
+ZBX_PTR_VECTOR_IMPL(snmp_get_item_ptr, zbx_snmp_get_item_t *)
+
+/* variable binding of request in flight */
+typedef struct
+{
+	zbx_snmp_get_item_t	*get_item;
+	unsigned char		verify;
+}
+zbx_snmp_binding_t;
+
+ZBX_VECTOR_DECL(snmp_binding, zbx_snmp_binding_t)
+ZBX_VECTOR_IMPL(snmp_binding, zbx_snmp_binding_t)
+
+/* walk of dynamic index table */
+typedef struct
+{
+	const char	*snmp_oid;
+	oid		root[MAX_OID_LEN];
+	size_t		root_length;
+	size_t		root_string_len;
+	size_t		root_numeric_len;
+	char		root_oid[MAX_STRING_LEN];
+	oid		name[MAX_OID_LEN];
+	size_t		name_length;
+	int		max_vars;
+	int		level;
+	int		running;
+	int		check_oid_increase;
+	int		bulk;
+	zbx_hashset_t	oids_seen;
+}
+zbx_snmp_index_walk_t;
+
+typedef struct
+{
+	zbx_vector_snmp_get_item_ptr_t	items;
+	zbx_vector_snmp_binding_t	bindings;
+	zbx_snmp_index_walk_t		*walk;
+	zbx_snmpidx_agent_t		agent;
+	int				reqid;
+	int				waiting;
+	int				max_vars;
+	int				level;
+	int				bulk;
+	int				max_succeed;
+	int				min_fail;
+	netsnmp_large_fd_set		fdset;
+}
+zbx_snmp_get_context_t;
+
 struct zbx_snmp_context
 {
 	void				*arg;
@@ -175,6 +257,7 @@ struct zbx_snmp_context
 	char				*snmpv3_privpassphrase;
 	const char			*config_source_ip;
 	unsigned char			snmp_oid_type;
+	zbx_snmp_get_context_t		*get_context;
 };
 
 typedef struct
@@ -194,8 +277,9 @@ static char				snmp_rwlock_init_done;
 static zbx_hashset_t	engineid_cache;
 static int		engineid_cache_initialized = 0;
 
-#define ZBX_SNMP_GET	0
-#define ZBX_SNMP_WALK	1
+#define ZBX_SNMP_GET		0
+#define ZBX_SNMP_WALK		1
+#define ZBX_SNMP_STANDARD	2
 
 #define	SNMP_MT_EXECLOCK					\
 	if (0 != snmp_rwlock_init_done)				\
@@ -488,32 +572,42 @@ static void	vector_snmp_oid_free(zbx_snmp_oid_t *ptr)
 	zbx_free(ptr);
 }
 
-static char	*get_item_community_context(const zbx_dc_item_t *item)
+static void	snmpidx_agent_init(zbx_snmpidx_agent_t *agent, const char *addr, unsigned short port,
+		unsigned char snmp_version, const char *snmp_community, const char *snmpv3_contextname,
+		const char *snmpv3_securityname)
 {
-	if (ZBX_IF_SNMP_VERSION_1 == item->snmp_version || ZBX_IF_SNMP_VERSION_2 == item->snmp_version)
-		return item->snmp_community;
-	else if (ZBX_IF_SNMP_VERSION_3 == item->snmp_version)
-		return item->snmpv3_contextname;
+	agent->addr = addr;
+	agent->port = port;
 
-	THIS_SHOULD_NEVER_HAPPEN;
-	exit(EXIT_FAILURE);
+	if (ZBX_IF_SNMP_VERSION_1 == snmp_version || ZBX_IF_SNMP_VERSION_2 == snmp_version)
+	{
+		agent->community_context = snmp_community;
+		agent->security_name = "";
+	}
+	else if (ZBX_IF_SNMP_VERSION_3 == snmp_version)
+	{
+		agent->community_context = snmpv3_contextname;
+		agent->security_name = snmpv3_securityname;
+	}
+	else
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		exit(EXIT_FAILURE);
+	}
 }
 
-static char	*get_item_security_name(const zbx_dc_item_t *item)
+static void	snmpidx_agent_init_by_item(zbx_snmpidx_agent_t *agent, const zbx_dc_item_t *item)
 {
-	if (ZBX_IF_SNMP_VERSION_3 == item->snmp_version)
-		return item->snmpv3_securityname;
-
-	return "";
+	snmpidx_agent_init(agent, item->interface.addr, item->interface.port, item->snmp_version,
+			item->snmp_community, item->snmpv3_contextname, item->snmpv3_securityname);
 }
 
 /******************************************************************************
  *                                                                            *
  * Purpose: retrieves index that matches value from relevant index cache      *
  *                                                                            *
- * Parameters: item      - [IN] Configuration of Zabbix item, contains        *
- *                              IP address, port, community string, context,  *
- *                              security name.                                *
+ * Parameters: agent     - [IN] SNMP agent IP address, port, community        *
+ *                              string, context, security name                *
  *             snmp_oid  - [IN] OID of table which contains indexes           *
  *             value     - [IN] value for which to look up index              *
  *             idx       - [IN/OUT] destination pointer for                   *
@@ -527,8 +621,8 @@ static char	*get_item_security_name(const zbx_dc_item_t *item)
  *                         heap-(re)allocated idx                             *
  *                                                                            *
  ******************************************************************************/
-static int	cache_get_snmp_index(const zbx_dc_item_t *item, const char *snmp_oid, const char *value, char **idx,
-		size_t *idx_alloc)
+static int	cache_get_snmp_index(const zbx_snmpidx_agent_t *agent, const char *snmp_oid, const char *value,
+		char **idx, size_t *idx_alloc)
 {
 	int			ret = FAIL;
 	zbx_snmpidx_main_key_t	*main_key, main_key_local;
@@ -540,12 +634,12 @@ static int	cache_get_snmp_index(const zbx_dc_item_t *item, const char *snmp_oid,
 	if (NULL == snmpidx.slots)
 		goto end;
 
-	main_key_local.addr = item->interface.addr;
-	main_key_local.port = item->interface.port;
+	main_key_local.addr = (char *)agent->addr;
+	main_key_local.port = agent->port;
 	main_key_local.oid = (char *)snmp_oid;
 
-	main_key_local.community_context = get_item_community_context(item);
-	main_key_local.security_name = get_item_security_name(item);
+	main_key_local.community_context = (char *)agent->community_context;
+	main_key_local.security_name = (char *)agent->security_name;
 
 	if (NULL == (main_key = (zbx_snmpidx_main_key_t *)zbx_hashset_search(&snmpidx, &main_key_local)))
 		goto end;
@@ -566,15 +660,14 @@ end:
  *                                                                            *
  * Purpose: stores index-value pair in relevant index cache                   *
  *                                                                            *
- * Parameters: item      - [IN] Configuration of Zabbix item, contains        *
- *                              IP address, port, community string, context,  *
- *                              security name.                                *
+ * Parameters: agent     - [IN] SNMP agent IP address, port, community        *
+ *                              string, context, security name                *
  *             snmp_oid  - [IN] OID of table which contains indexes           *
  *             index     - [IN] index part of index-value pair                *
  *             value     - [IN] value part of index-value pair                *
  *                                                                            *
  ******************************************************************************/
-static void	cache_put_snmp_index(const zbx_dc_item_t *item, const char *snmp_oid, const char *index,
+static void	cache_put_snmp_index(const zbx_snmpidx_agent_t *agent, const char *snmp_oid, const char *index,
 		const char *value)
 {
 	zbx_snmpidx_main_key_t	*main_key, main_key_local;
@@ -589,20 +682,20 @@ static void	cache_put_snmp_index(const zbx_dc_item_t *item, const char *snmp_oid
 				ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
 	}
 
-	main_key_local.addr = item->interface.addr;
-	main_key_local.port = item->interface.port;
+	main_key_local.addr = (char *)agent->addr;
+	main_key_local.port = agent->port;
 	main_key_local.oid = (char *)snmp_oid;
 
-	main_key_local.community_context = get_item_community_context(item);
-	main_key_local.security_name = get_item_security_name(item);
+	main_key_local.community_context = (char *)agent->community_context;
+	main_key_local.security_name = (char *)agent->security_name;
 
 	if (NULL == (main_key = (zbx_snmpidx_main_key_t *)zbx_hashset_search(&snmpidx, &main_key_local)))
 	{
-		main_key_local.addr = zbx_strdup(NULL, item->interface.addr);
+		main_key_local.addr = zbx_strdup(NULL, agent->addr);
 		main_key_local.oid = zbx_strdup(NULL, snmp_oid);
 
-		main_key_local.community_context = zbx_strdup(NULL, get_item_community_context(item));
-		main_key_local.security_name = zbx_strdup(NULL, get_item_security_name(item));
+		main_key_local.community_context = zbx_strdup(NULL, agent->community_context);
+		main_key_local.security_name = zbx_strdup(NULL, agent->security_name);
 
 		main_key_local.mappings = (zbx_hashset_t *)zbx_malloc(NULL, sizeof(zbx_hashset_t));
 		zbx_hashset_create_ext(main_key_local.mappings, 100,
@@ -633,16 +726,15 @@ static void	cache_put_snmp_index(const zbx_dc_item_t *item, const char *snmp_oid
  *                                                                            *
  * Purpose: deletes index-value mappings from specified index cache           *
  *                                                                            *
- * Parameters: item      - [IN] Configuration of Zabbix item, contains        *
- *                              IP address, port, community string, context,  *
- *                              security name.                                *
+ * Parameters: agent     - [IN] SNMP agent IP address, port, community        *
+ *                              string, context, security name                *
  *             snmp_oid  - [IN] OID of table which contains indexes           *
  *                                                                            *
  * Comments: Does nothing if the index cache is empty or if it does not       *
  *           contain the cache for the specified OID.                         *
  *                                                                            *
  ******************************************************************************/
-static void	cache_del_snmp_index_subtree(const zbx_dc_item_t *item, const char *snmp_oid)
+static void	cache_del_snmp_index_subtree(const zbx_snmpidx_agent_t *agent, const char *snmp_oid)
 {
 	zbx_snmpidx_main_key_t	*main_key, main_key_local;
 
@@ -651,12 +743,12 @@ static void	cache_del_snmp_index_subtree(const zbx_dc_item_t *item, const char *
 	if (NULL == snmpidx.slots)
 		goto end;
 
-	main_key_local.addr = item->interface.addr;
-	main_key_local.port = item->interface.port;
+	main_key_local.addr = (char *)agent->addr;
+	main_key_local.port = agent->port;
 	main_key_local.oid = (char *)snmp_oid;
 
-	main_key_local.community_context = get_item_community_context(item);
-	main_key_local.security_name = get_item_security_name(item);
+	main_key_local.community_context = (char *)agent->community_context;
+	main_key_local.security_name = (char *)agent->security_name;
 
 	if (NULL == (main_key = (zbx_snmpidx_main_key_t *)zbx_hashset_search(&snmpidx, &main_key_local)))
 		goto end;
@@ -1370,6 +1462,62 @@ static int	zbx_oid_is_new(zbx_hashset_t *hs, size_t root_len, const oid *p_oid,
 #undef ZBX_OIDS_MAX_NUM
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: prepares root OID of walk and lengths of its printed forms that   *
+ *          are needed to choose index of walked OIDs                         *
+ *                                                                            *
+ * Parameters: snmp_oid         - [IN] OID of table to walk                   *
+ *             root             - [OUT] parsed root OID                       *
+ *             root_len         - [IN/OUT] root OID buffer size/length        *
+ *             root_string_len  - [OUT] length of root OID printed with       *
+ *                                      string indices                        *
+ *             root_numeric_len - [OUT] length of root OID printed with       *
+ *                                      numeric indices                       *
+ *             root_oid         - [OUT] root OID printed with numeric indices *
+ *             root_oid_size    - [IN] size of root_oid buffer                *
+ *             error            - [OUT] buffer to store error message         *
+ *             max_error_len    - [IN] maximum error message length           *
+ *                                                                            *
+ * Return value: SUCCEED - root OID was prepared                              *
+ *               CONFIG_ERROR - OID cannot be parsed or printed               *
+ *                                                                            *
+ ******************************************************************************/
+static int	zbx_snmp_walk_root_init(const char *snmp_oid, oid *root, size_t *root_len, size_t *root_string_len,
+		size_t *root_numeric_len, char *root_oid, size_t root_oid_size, char *error, size_t max_error_len)
+{
+	char	oid_index[MAX_STRING_LEN];
+
+	/* create OID from string */
+	if (NULL == snmp_parse_oid(snmp_oid, root, root_len))
+	{
+		zbx_snprintf(error, max_error_len, "snmp_parse_oid(): cannot parse OID \"%s\".", snmp_oid);
+		return CONFIG_ERROR;
+	}
+
+	if (-1 == zbx_snmp_print_oid(oid_index, sizeof(oid_index), root, *root_len, ZBX_OID_INDEX_STRING))
+	{
+		zbx_snprintf(error, max_error_len, "zbx_snmp_print_oid(): cannot print OID \"%s\" with string indices.",
+				snmp_oid);
+		return CONFIG_ERROR;
+	}
+
+	*root_string_len = strlen(oid_index);
+
+	if (-1 == zbx_snmp_print_oid(oid_index, sizeof(oid_index), root, *root_len, ZBX_OID_INDEX_NUMERIC))
+	{
+		zbx_snprintf(error, max_error_len, "zbx_snmp_print_oid(): cannot print OID \"%s\""
+				" with numeric indices.", snmp_oid);
+		return CONFIG_ERROR;
+	}
+
+	*root_numeric_len = strlen(oid_index);
+
+	zbx_strlcpy(root_oid, oid_index, root_oid_size);
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: retrieves information by walking OID tree                         *
@@ -1412,36 +1560,12 @@ static int	zbx_snmp_walk(zbx_snmp_sess_t ssp, const zbx_dc_item_t *item, const c
 	if (ZBX_IF_SNMP_VERSION_1 == item->snmp_version)	/* GetBulkRequest-PDU available since SNMPv2 */
 		bulk = SNMP_BULK_DISABLED;
 
-	/* create OID from string */
-	if (NULL == snmp_parse_oid(snmp_oid, rootOID, &rootOID_len))
-	{
-		zbx_snprintf(error, max_error_len, "snmp_parse_oid(): cannot parse OID \"%s\".", snmp_oid);
-		ret = CONFIG_ERROR;
-		goto out;
-	}
-
-	if (-1 == zbx_snmp_print_oid(oid_index, sizeof(oid_index), rootOID, rootOID_len, ZBX_OID_INDEX_STRING))
-	{
-		zbx_snprintf(error, max_error_len, "zbx_snmp_print_oid(): cannot print OID \"%s\" with string indices.",
-				snmp_oid);
-		ret = CONFIG_ERROR;
-		goto out;
-	}
-
-	root_string_len = strlen(oid_index);
-
-	if (-1 == zbx_snmp_print_oid(oid_index, sizeof(oid_index), rootOID, rootOID_len, ZBX_OID_INDEX_NUMERIC))
+	if (SUCCEED != (ret = zbx_snmp_walk_root_init(snmp_oid, rootOID, &rootOID_len, &root_string_len,
+			&root_numeric_len, root_oid, sizeof(root_oid), error, max_error_len)))
 	{
-		zbx_snprintf(error, max_error_len, "zbx_snmp_print_oid(): cannot print OID \"%s\""
-				" with numeric indices.", snmp_oid);
-		ret = CONFIG_ERROR;
 		goto out;
 	}
 
-	root_numeric_len = strlen(oid_index);
-
-	zbx_strlcpy(root_oid, oid_index, sizeof(root_oid));
-
 	/* copy rootOID to anOID */
 	memcpy(anOID, rootOID, rootOID_len * sizeof(oid));
 	anOID_len = rootOID_len;
@@ -2227,7 +2351,7 @@ out:
 
 static void	zbx_snmp_walk_cache_cb(void *arg, const char *snmp_oid, const char *index, const char *value)
 {
-	cache_put_snmp_index((const zbx_dc_item_t *)arg, snmp_oid, index, value);
+	cache_put_snmp_index((const zbx_snmpidx_agent_t *)arg, snmp_oid, index, value);
 }
 
 typedef struct
@@ -2715,14 +2839,79 @@ static void	snmp_bulkwalk_context_free(zbx_bulkwalk_context_t *bulkwalk_context)
 	zbx_free(bulkwalk_context);
 }
 
-static int	snmp_bulkwalk_add(zbx_snmp_context_t *snmp_context, int *fd, char *error, size_t max_error_len)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sends asynchronous request and gets socket to wait response on    *
+ *                                                                            *
+ * Parameters: snmp_context  - [IN] asynchronous SNMP context                 *
+ *             pdu           - [IN] request PDU, freed by net-snmp or here    *
+ *             callback      - [IN] response callback                         *
+ *             magic         - [IN] response callback argument                *
+ *             reqid         - [OUT] request id                               *
+ *             fdset         - [IN/OUT] file descriptor set of session        *
+ *             fd            - [OUT] socket to wait response on               *
+ *             error         - [OUT] buffer to store error message            *
+ *             max_error_len - [IN] maximum error message length              *
+ *                                                                            *
+ * Return value: SUCCEED - request was sent                                   *
+ *               NETWORK_ERROR, NOTSUPPORTED - request cannot be sent         *
+ *                                                                            *
+ ******************************************************************************/
+static int	snmp_context_send(zbx_snmp_context_t *snmp_context, struct snmp_pdu *pdu, snmp_callback callback,
+		void *magic, int *reqid, netsnmp_large_fd_set *fdset, int *fd, char *error, size_t max_error_len)
 {
-	struct snmp_pdu			*pdu;
-	zbx_bulkwalk_context_t		*bulkwalk_context = snmp_context->bulkwalk_contexts.values[snmp_context->i];
 	struct netsnmp_transport_s	*transport;
-	int				ret, numfds = 0, block = 0;
+	int				numfds = 0, block = 0;
 	struct timeval			timeout = {.tv_sec = snmp_context->config_timeout};
-	fd_set				fdset;
+	fd_set				tmp_fdset;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() sending", __func__);
+
+	*reqid = -1;
+
+	if (0 == (*reqid = snmp_sess_async_send(snmp_context->ssp, pdu, callback, magic)))
+	{
+		int	ret;
+
+		ret = zbx_get_snmp_response_error(snmp_context->ssp, &snmp_context->item.interface, STAT_ERROR, NULL,
+				error, max_error_len);
+		snmp_free_pdu(pdu);
+
+		return ret;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() send completed", __func__);
+
+	FD_ZERO(&tmp_fdset);
+
+	netsnmp_copy_fd_set_to_large_fd_set(fdset, &tmp_fdset);
+
+	if (1 > snmp_sess_select_info2(snmp_context->ssp, &numfds, fdset, &timeout, &block))
+	{
+		zbx_strlcpy(error, "snmp_sess_select_info2(): cannot get socket.", max_error_len);
+		snmp_sess_timeout(snmp_context->ssp);
+
+		return NETWORK_ERROR;
+	}
+
+	if (NULL == (transport = snmp_sess_transport(snmp_context->ssp)) || -1 == transport->sock)
+	{
+		zbx_strlcpy(error, "snmp_sess_transport(): cannot get socket.", max_error_len);
+		snmp_sess_timeout(snmp_context->ssp);
+
+		return NETWORK_ERROR;
+	}
+
+	*fd = transport->sock;
+
+	return SUCCEED;
+}
+
+static int	snmp_bulkwalk_add(zbx_snmp_context_t *snmp_context, int *fd, char *error, size_t max_error_len)
+{
+	struct snmp_pdu		*pdu;
+	zbx_bulkwalk_context_t	*bulkwalk_context = snmp_context->bulkwalk_contexts.values[snmp_context->i];
+	int			ret;
 
 	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_DEBUG))
 	{
@@ -2771,45 +2960,10 @@ static int	snmp_bulkwalk_add(zbx_snmp_context_t *snmp_context, int *fd, char *er
 		}
 	}
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() sending", __func__);
-
-	bulkwalk_context->reqid = -1;
 	bulkwalk_context->waiting = 1;
 
-	if (0 == (bulkwalk_context->reqid = snmp_sess_async_send(snmp_context->ssp, pdu, asynch_response,
-			bulkwalk_context)))
-	{
-		ret = zbx_get_snmp_response_error(snmp_context->ssp, &snmp_context->item.interface, STAT_ERROR, NULL,
-				error, max_error_len);
-		snmp_free_pdu(pdu);
-		goto out;
-	}
-
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() send completed", __func__);
-
-	FD_ZERO(&fdset);
-
-	netsnmp_copy_fd_set_to_large_fd_set(&bulkwalk_context->fdset, &fdset);
-
-	if (1 > snmp_sess_select_info2(snmp_context->ssp, &numfds, &bulkwalk_context->fdset, &timeout, &block))
-	{
-		zbx_strlcpy(error, "snmp_sess_select_info2(): cannot get socket.", max_error_len);
-		ret = NETWORK_ERROR;
-		snmp_sess_timeout(snmp_context->ssp);
-		goto out;
-	}
-
-	if (NULL == (transport = snmp_sess_transport(snmp_context->ssp)) || -1 == transport->sock)
-	{
-		zbx_strlcpy(error, "snmp_sess_transport(): cannot get socket.", max_error_len);
-		ret = NETWORK_ERROR;
-		snmp_sess_timeout(snmp_context->ssp);
-		goto out;
-	}
-
-	*fd = transport->sock;
-
-	ret = SUCCEED;
+	ret = snmp_context_send(snmp_context, pdu, asynch_response, bulkwalk_context, &bulkwalk_context->reqid,
+			&bulkwalk_context->fdset, fd, error, max_error_len);
 out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s fd:%d", __func__, zbx_result_string(ret), *fd);
 
@@ -2849,98 +3003,1191 @@ void	zbx_unset_snmp_bulkwalk_options(void)
 	snmp_bulkwalk_set_options(&default_opts);
 }
 
-static int	snmp_task_process(short event, void *data, int *fd, const char *addr, char *dnserr)
+static void	snmp_set_default_options(zbx_snmp_format_opts_t *saved_opts)
 {
-	zbx_bulkwalk_context_t	*bulkwalk_context;
-	zbx_snmp_context_t	*snmp_context = (zbx_snmp_context_t *)data;
-	char			error[MAX_STRING_LEN];
-	int			ret, task_ret = ZBX_ASYNC_TASK_STOP;
-	zbx_poller_config_t	*poller_config = (zbx_poller_config_t *)snmp_context->arg_action;
+	snmp_bulkwalk_get_options(saved_opts);
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() event:%d fd:%d itemid:" ZBX_FS_UI64, __func__, event, *fd,
-			snmp_context->item.itemid);
+	if (1 == zbx_snmp_init_bulkwalk_done)
+		snmp_bulkwalk_set_options(&default_opts);
+}
 
-	bulkwalk_context = snmp_context->bulkwalk_contexts.values[snmp_context->i];
+static void	snmp_item_context_init(zbx_dc_item_context_t *item_context, zbx_dc_item_t *item)
+{
+	item_context->interface = item->interface;
+	item_context->interface.addr = (item->interface.addr == item->interface.dns_orig ?
+			item_context->interface.dns_orig : item_context->interface.ip_orig);
+	zbx_strlcpy(item_context->host, item->host.host, sizeof(item_context->host));
+	item_context->itemid = item->itemid;
+	item_context->hostid = item->host.hostid;
+	item_context->value_type = item->value_type;
+	item_context->flags = item->flags;
+	item_context->key = item->key;
+	item->key = NULL;
+	item_context->key_orig = zbx_strdup(NULL, item->key_orig);
 
-	if (NULL != poller_config && ZBX_PROCESS_STATE_IDLE == poller_config->state)
-	{
-		zbx_update_selfmon_counter(poller_config->info, ZBX_PROCESS_STATE_BUSY);
-		poller_config->state = ZBX_PROCESS_STATE_BUSY;
-	}
+	item_context->version = item->interface.version;
 
-	/* initialization */
-	if (0 != event)
-	{
-		if (0 != (event & EV_TIMEOUT))
-		{
-			char	buffer[MAX_OID_LEN];
+	zbx_init_agent_result(&item_context->result);
+}
 
-			snprint_objid(buffer, sizeof(buffer), bulkwalk_context->name, bulkwalk_context->name_length);
+static void	snmp_item_context_clean(zbx_dc_item_context_t *item_context)
+{
+	zbx_free(item_context->key);
+	zbx_free(item_context->key_orig);
+	zbx_free_agent_result(&item_context->result);
+}
 
-			if (NULL != dnserr)
-			{
-				SET_MSG_RESULT(&snmp_context->item.result, zbx_dsprintf(NULL,
-						"cannot resolve address [[%s]:%hu]: timed out: %s",
-						snmp_context->item.interface.addr, snmp_context->item.interface.port,
-						dnserr));
-				snmp_context->item.ret = TIMEOUT_ERROR;
-			}
-			else if (ZBX_IF_SNMP_VERSION_3 == snmp_context->snmp_version && 0 == snmp_context->probe)
-			{
-				SET_MSG_RESULT(&snmp_context->item.result, zbx_dsprintf(NULL,
-						"Probe successful, cannot retrieve OID: '%s' from [[%s]:%hu]:"
-						" timed out", buffer, snmp_context->item.interface.addr,
-						snmp_context->item.interface.port));
-				snmp_context->item.ret = TIMEOUT_ERROR;
-			}
-			else
-			{
-				SET_MSG_RESULT(&snmp_context->item.result, zbx_dsprintf(NULL,
-						"cannot retrieve OID: '%s' from [[%s]:%hu]:"
-						" timed out", buffer, snmp_context->item.interface.addr,
-						snmp_context->item.interface.port));
-				snmp_context->item.ret = TIMEOUT_ERROR;
-			}
+static void	snmp_get_item_free(zbx_snmp_get_item_t *get_item)
+{
+	zbx_free(get_item->snmp_oid);
+	zbx_free(get_item->value_oid);
+	zbx_free(get_item->index_oid);
+	zbx_free(get_item->index_value);
+	zbx_free(get_item);
+}
 
-			goto stop;
-		}
+static void	snmp_get_item_set_error(zbx_snmp_get_item_t *get_item, int errcode, const char *error)
+{
+	get_item->item->ret = errcode;
+	SET_MSG_RESULT(&get_item->item->result, zbx_strdup(NULL, error));
+	get_item->state = ZBX_SNMP_ITEM_DONE;
+}
 
-		if (0 != snmp_sess_read2(snmp_context->ssp, &bulkwalk_context->fdset))
-		{
-			char		*tmp_err_str = NULL;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: builds value and index verification OIDs of dynamic item          *
+ *                                                                            *
+ * Parameters: get_item      - [IN/OUT] dynamic item                          *
+ *             idx           - [IN] index found in index table                *
+ *             error         - [OUT] buffer to store error message            *
+ *             max_error_len - [IN] maximum error message length              *
+ *                                                                            *
+ * Return value: SUCCEED - OIDs were built                                    *
+ *               FAIL - OID cannot be parsed                                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	snmp_get_item_set_index(zbx_snmp_get_item_t *get_item, const char *idx, char *error,
+		size_t max_error_len)
+{
+	char	oid_str[ZBX_ITEM_SNMP_OID_LEN_MAX];
 
-			snmp_context->item.ret = NOTSUPPORTED;
+	zbx_snprintf(oid_str, sizeof(oid_str), "%s.%s", get_item->index_oid, idx);
+	get_item->index_name_length = MAX_OID_LEN;
 
-			snmp_sess_error(snmp_context->ssp, NULL, NULL, &tmp_err_str);
-			if (NULL != snmp_context->ssp)
-			{
-				SET_MSG_RESULT(&snmp_context->item.result, zbx_dsprintf(NULL, "cannot read from"
-						" session: %s", tmp_err_str));
-			}
-			else
-			{
-				SET_MSG_RESULT(&snmp_context->item.result, zbx_dsprintf(NULL, "cannot read from"
-						" session"));
-			}
+	if (NULL == snmp_parse_oid(oid_str, get_item->index_name, &get_item->index_name_length))
+		goto fail;
 
-			zbx_free(tmp_err_str);
-			goto stop;
-		}
+	zbx_snprintf(oid_str, sizeof(oid_str), "%s.%s", get_item->value_oid, idx);
+	get_item->name_length = MAX_OID_LEN;
 
-		if (1 == snmp_context->probe)
-		{
-			netsnmp_session	*session = snmp_sess_session(snmp_context->ssp);
+	if (NULL == snmp_parse_oid(oid_str, get_item->name, &get_item->name_length))
+		goto fail;
 
-			if (0 != session->engineBoots || 0 != session->engineTime)
-			{
-				set_enginetime(session->securityEngineID, (u_int)session->securityEngineIDLen,
-						session->engineBoots, session->engineTime, TRUE);
-			}
+	return SUCCEED;
+fail:
+	zbx_snprintf(error, max_error_len, "snmp_parse_oid(): cannot parse OID \"%s\".", oid_str);
 
-			if (FAIL == zbx_snmp_cache_handle_engineid(session, &snmp_context->item))
-			{
-				snmp_context->item.ret = NOTSUPPORTED;
-				SET_MSG_RESULT(&snmp_context->item.result, zbx_dsprintf(NULL,
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: prepares regular (normal or dynamic index) SNMP item to be        *
+ *          queried with asynchronous GET requests                            *
+ *                                                                            *
+ * Parameters: item          - [IN] item to query                             *
+ *             get_item      - [OUT] prepared item                            *
+ *             error         - [OUT] buffer to store error message            *
+ *             max_error_len - [IN] maximum error message length              *
+ *                                                                            *
+ * Return value: SUCCEED - item was prepared                                  *
+ *               CONFIG_ERROR - invalid OID                                   *
+ *                                                                            *
+ * Comments: Dynamic items with index found in dynamic index cache are        *
+ *           verified before querying value, the rest must walk index table.  *
+ *                                                                            *
+ ******************************************************************************/
+static int	snmp_get_item_create(zbx_dc_item_t *item, zbx_snmp_get_item_t **get_item, char *error,
+		size_t max_error_len)
+{
+	char	oid_translated[ZBX_ITEM_SNMP_OID_LEN_MAX];
+	int	ret = CONFIG_ERROR;
+
+	*get_item = (zbx_snmp_get_item_t *)zbx_malloc(NULL, sizeof(zbx_snmp_get_item_t));
+	(*get_item)->item = NULL;
+	(*get_item)->snmp_oid = zbx_strdup(NULL, item->snmp_oid);
+	(*get_item)->value_oid = NULL;
+	(*get_item)->index_oid = NULL;
+	(*get_item)->index_value = NULL;
+
+	if (NULL == strchr(item->snmp_oid, '['))
+	{
+		zbx_snmp_translate(oid_translated, item->snmp_oid, sizeof(oid_translated));
+		(*get_item)->name_length = MAX_OID_LEN;
+
+		if (NULL == snmp_parse_oid(oid_translated, (*get_item)->name, &(*get_item)->name_length))
+		{
+			zbx_snprintf(error, max_error_len, "snmp_parse_oid(): cannot parse OID \"%s\".",
+					oid_translated);
+			goto out;
+		}
+
+		(*get_item)->state = ZBX_SNMP_ITEM_QUERY;
+	}
+	else
+	{
+		char			method[8], index_oid[ZBX_ITEM_SNMP_OID_LEN_MAX],
+					index_value[ZBX_ITEM_SNMP_OID_LEN_MAX], *pl, *idx = NULL;
+		size_t			idx_alloc = 0;
+		zbx_snmpidx_agent_t	agent;
+
+		if (3 != zbx_num_key_param(item->snmp_oid))
+		{
+			zbx_snprintf(error, max_error_len, "OID \"%s\" contains unsupported parameters.",
+					item->snmp_oid);
+			goto out;
+		}
+
+		zbx_get_key_param(item->snmp_oid, 1, method, sizeof(method));
+		zbx_get_key_param(item->snmp_oid, 2, index_oid, sizeof(index_oid));
+		zbx_get_key_param(item->snmp_oid, 3, index_value, sizeof(index_value));
+
+		if (0 != strcmp("index", method))
+		{
+			zbx_snprintf(error, max_error_len, "Unsupported method \"%s\" in the OID \"%s\".", method,
+					item->snmp_oid);
+			goto out;
+		}
+
+		zbx_snmp_translate(oid_translated, index_oid, sizeof(oid_translated));
+		(*get_item)->index_oid = zbx_strdup(NULL, oid_translated);
+		(*get_item)->index_value = zbx_strdup(NULL, index_value);
+
+		pl = strchr(item->snmp_oid, '[');
+		*pl = '\0';
+		zbx_snmp_translate(oid_translated, item->snmp_oid, sizeof(oid_translated));
+		*pl = '[';
+		(*get_item)->value_oid = zbx_strdup(NULL, oid_translated);
+
+		snmpidx_agent_init_by_item(&agent, item);
+
+		if (SUCCEED == cache_get_snmp_index(&agent, (*get_item)->index_oid, (*get_item)->index_value, &idx,
+				&idx_alloc))
+		{
+			int	res;
+
+			res = snmp_get_item_set_index(*get_item, idx, error, max_error_len);
+			zbx_free(idx);
+
+			if (SUCCEED != res)
+				goto out;
+
+			(*get_item)->state = ZBX_SNMP_ITEM_VERIFY;
+		}
+		else
+			(*get_item)->state = ZBX_SNMP_ITEM_WALK;
+	}
+
+	ret = SUCCEED;
+out:
+	if (SUCCEED != ret)
+		snmp_get_item_free(*get_item);
+
+	return ret;
+}
+
+static void	snmp_get_walk_free(zbx_snmp_index_walk_t *walk)
+{
+	if (0 == walk->check_oid_increase)
+		zbx_hashset_destroy(&walk->oids_seen);
+
+	zbx_free(walk);
+}
+
+static void	snmp_get_context_free(zbx_snmp_context_t *snmp_context)
+{
+	zbx_snmp_get_context_t	*get_context = snmp_context->get_context;
+
+	for (int i = 0; i < get_context->items.values_num; i++)
+	{
+		zbx_snmp_get_item_t	*get_item = get_context->items.values[i];
+
+		if (get_item->item != &snmp_context->item)
+		{
+			snmp_item_context_clean(get_item->item);
+			zbx_free(get_item->item);
+		}
+
+		snmp_get_item_free(get_item);
+	}
+
+	zbx_vector_snmp_get_item_ptr_destroy(&get_context->items);
+	zbx_vector_snmp_binding_destroy(&get_context->bindings);
+
+	if (NULL != get_context->walk)
+		snmp_get_walk_free(get_context->walk);
+
+	netsnmp_large_fd_set_cleanup(&get_context->fdset);
+	zbx_free(get_context);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sets error for all items of context that are not processed yet    *
+ *                                                                            *
+ ******************************************************************************/
+static void	snmp_get_context_set_error(zbx_snmp_get_context_t *get_context, int errcode, const char *error)
+{
+	for (int i = 0; i < get_context->items.values_num; i++)
+	{
+		zbx_snmp_get_item_t	*get_item = get_context->items.values[i];
+
+		if (ZBX_SNMP_ITEM_DONE != get_item->state)
+			snmp_get_item_set_error(get_item, errcode, error);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sets error for items queried by request in flight                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	snmp_get_bindings_set_error(zbx_snmp_get_context_t *get_context, int errcode, const char *error)
+{
+	for (int i = 0; i < get_context->bindings.values_num; i++)
+	{
+		zbx_snmp_get_item_t	*get_item = get_context->bindings.values[i].get_item;
+
+		if (ZBX_SNMP_ITEM_DONE != get_item->state)
+			snmp_get_item_set_error(get_item, errcode, error);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sets error for dynamic items waiting for walk of index table      *
+ *                                                                            *
+ ******************************************************************************/
+static void	snmp_get_walk_set_error(zbx_snmp_get_context_t *get_context, const char *snmp_oid, int errcode,
+		const char *error)
+{
+	for (int i = 0; i < get_context->items.values_num; i++)
+	{
+		zbx_snmp_get_item_t	*get_item = get_context->items.values[i];
+
+		if (ZBX_SNMP_ITEM_WALK == get_item->state && 0 == strcmp(get_item->index_oid, snmp_oid))
+			snmp_get_item_set_error(get_item, errcode, error);
+	}
+}
+
+static void	snmp_context_set_error(zbx_snmp_context_t *snmp_context, int errcode, char *error)
+{
+	if (ZBX_SNMP_STANDARD == snmp_context->snmp_oid_type)
+	{
+		snmp_get_context_set_error(snmp_context->get_context, errcode, error);
+		zbx_free(error);
+	}
+	else
+	{
+		snmp_context->item.ret = errcode;
+		SET_MSG_RESULT(&snmp_context->item.result, error);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reduces number of variables queried by single request after       *
+ *          device failed to handle the last one                              *
+ *                                                                            *
+ * Comments: The logic is the same as in zbx_snmp_get_values() - halve the    *
+ *           number of variables first, then resort to querying them one by   *
+ *           one.                                                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	snmp_get_halve(zbx_snmp_get_context_t *get_context)
+{
+	int	num = get_context->bindings.values_num;
+
+	if (get_context->min_fail > num)
+		get_context->min_fail = num;
+
+	if (0 == get_context->level)
+		get_context->max_vars = num / 2;
+	else
+		get_context->max_vars = 1;
+
+	get_context->level++;
+}
+
+static void	snmp_get_binding_process(zbx_snmp_binding_t *binding, const struct variable_list *var)
+{
+	zbx_snmp_get_item_t	*get_item = binding->get_item;
+	unsigned char		val_type;
+
+	if (1 == binding->verify)
+	{
+		AGENT_RESULT	result;
+
+		zbx_init_agent_result(&result);
+		(void)zbx_snmp_set_result(var, &result, &val_type);
+
+		if (ZBX_ISSET_TEXT(&result) && ZBX_SNMP_STR_HEX == val_type)
+			zbx_remove_chars(result.text, "\r\n");
+
+		if (NULL == ZBX_GET_STR_RESULT(&result) || 0 != strcmp(result.str, get_item->index_value))
+			get_item->state = ZBX_SNMP_ITEM_WALK;
+		else
+			get_item->state = ZBX_SNMP_ITEM_QUERY;
+
+		zbx_free_agent_result(&result);
+
+		return;
+	}
+
+	/* value of item with stale index is ignored */
+	if (ZBX_SNMP_ITEM_QUERY != get_item->state)
+		return;
+
+	get_item->item->ret = zbx_snmp_set_result(var, &get_item->item->result, &val_type);
+
+	if (ZBX_ISSET_TEXT(&get_item->item->result) && ZBX_SNMP_STR_HEX == val_type)
+		zbx_remove_chars(get_item->item->result.text, "\r\n");
+
+	get_item->state = ZBX_SNMP_ITEM_DONE;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes response to GET request of coalesced items              *
+ *                                                                            *
+ * Parameters: snmp_context - [IN] asynchronous SNMP context                  *
+ *             status       - [IN] response status                            *
+ *             response     - [IN] response PDU                               *
+ *                                                                            *
+ * Comments: Errors that do not relate to the whole interface are assigned    *
+ *           to individual items after request is reduced to single item.     *
+ *                                                                            *
+ ******************************************************************************/
+static void	snmp_get_values_process(zbx_snmp_context_t *snmp_context, int status, struct snmp_pdu *response)
+{
+	zbx_snmp_get_context_t	*get_context = snmp_context->get_context;
+	zbx_vector_snmp_binding_t	*bindings = &get_context->bindings;
+	struct snmp_session	*ss = snmp_sess_session(snmp_context->ssp);
+	char			error[MAX_STRING_LEN];
+	int			num = bindings->values_num;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() status:%d s_snmp_errno:%d errstat:%ld num:%d", __func__, status,
+			ss->s_snmp_errno, NULL == response ? (long)-1 : response->errstat, num);
+
+	if (STAT_SUCCESS == status && SNMP_ERR_NOERROR == response->errstat)
+	{
+		struct variable_list	*var;
+		int			i;
+
+		/* check that response variable bindings match the request variable bindings */
+		for (i = 0, var = response->variables; i < num && NULL != var; i++, var = var->next_variable)
+		{
+			const oid	*name;
+			size_t		name_length;
+
+			if (1 == bindings->values[i].verify)
+			{
+				name = bindings->values[i].get_item->index_name;
+				name_length = bindings->values[i].get_item->index_name_length;
+			}
+			else
+			{
+				name = bindings->values[i].get_item->name;
+				name_length = bindings->values[i].get_item->name_length;
+			}
+
+			if (1 != num && (name_length != var->name_length ||
+					0 != memcmp(name, var->name, name_length * sizeof(oid))))
+			{
+				char	sent_oid[ZBX_ITEM_SNMP_OID_LEN_MAX], received_oid[ZBX_ITEM_SNMP_OID_LEN_MAX];
+
+				zbx_snmp_dump_oid(sent_oid, sizeof(sent_oid), name, name_length);
+				zbx_snmp_dump_oid(received_oid, sizeof(received_oid), var->name, var->name_length);
+
+				zabbix_log(LOG_LEVEL_WARNING, "SNMP response from host \"%s\" contains variable bindings"
+						" that do not match the request: sent \"%s\", received \"%s\"",
+						snmp_context->item.host, sent_oid, received_oid);
+
+				snmp_get_halve(get_context);	/* give device a chance to handle a smaller request */
+				goto out;
+			}
+		}
+
+		if (i != num || NULL != var)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "SNMP response from host \"%s\" contains too %s variable"
+					" bindings", snmp_context->item.host, i != num ? "few" : "many");
+
+			if (1 != num)	/* give device a chance to handle a smaller request */
+			{
+				snmp_get_halve(get_context);
+			}
+			else
+			{
+				zbx_snprintf(error, sizeof(error), "Invalid SNMP response: too %s variable bindings.",
+						i != num ? "few" : "many");
+				snmp_get_bindings_set_error(get_context, NOTSUPPORTED, error);
+			}
+
+			goto out;
+		}
+
+		for (i = 0, var = response->variables; i < num; i++, var = var->next_variable)
+			snmp_get_binding_process(&bindings->values[i], var);
+
+		if (get_context->max_succeed < num)
+			get_context->max_succeed = num;
+	}
+	else if (STAT_SUCCESS == status && SNMP_ERR_NOSUCHNAME == response->errstat && 0 != response->errindex)
+	{
+		/* SNMPv1 agent rejected the whole PDU because of one bad variable, see zbx_snmp_get_values() */
+		int			i = (int)response->errindex - 1;
+		zbx_snmp_binding_t	*binding;
+
+		if (0 > i || i >= num)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "SNMP response from host \"%s\" contains an out of bounds error"
+					" index: %ld", snmp_context->item.host, response->errindex);
+
+			snmp_get_bindings_set_error(get_context, NOTSUPPORTED,
+					"Invalid SNMP response: error index out of bounds.");
+			goto out;
+		}
+
+		binding = &bindings->values[i];
+
+		zabbix_log(LOG_LEVEL_DEBUG, "%s() errindex:%ld OID:'%s'", __func__, response->errindex,
+				binding->get_item->snmp_oid);
+
+		/* the rest of variables are queried again with the next request */
+		if (1 == binding->verify)
+		{
+			binding->get_item->state = ZBX_SNMP_ITEM_WALK;
+		}
+		else
+		{
+			int	errcode;
+
+			errcode = zbx_get_snmp_response_error(snmp_context->ssp, &snmp_context->item.interface, status,
+					response, error, sizeof(error));
+			snmp_get_item_set_error(binding->get_item, errcode, error);
+		}
+	}
+	else if (1 < num &&
+			((STAT_SUCCESS == status && SNMP_ERR_TOOBIG == response->errstat) || STAT_TIMEOUT == status ||
+			(STAT_ERROR == status && SNMPERR_TOO_LONG == ss->s_snmp_errno)))
+	{
+		snmp_get_halve(get_context);
+	}
+	else
+	{
+		int	errcode;
+
+		errcode = zbx_get_snmp_response_error(snmp_context->ssp, &snmp_context->item.interface, status,
+				response, error, sizeof(error));
+
+		if (NETWORK_ERROR == errcode)
+			snmp_get_context_set_error(get_context, errcode, error);
+		else if (1 < num)
+			snmp_get_halve(get_context);
+		else
+			snmp_get_bindings_set_error(get_context, errcode, error);
+	}
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: resolves dynamic items waiting for walk of index table that has   *
+ *          just been stored in dynamic index cache                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	snmp_get_walk_finish(zbx_snmp_get_context_t *get_context)
+{
+	zbx_snmp_index_walk_t	*walk = get_context->walk;
+	char			*idx = NULL, error[MAX_STRING_LEN];
+	size_t			idx_alloc = 0;
+
+	for (int i = 0; i < get_context->items.values_num; i++)
+	{
+		zbx_snmp_get_item_t	*get_item = get_context->items.values[i];
+
+		if (ZBX_SNMP_ITEM_WALK != get_item->state || 0 != strcmp(get_item->index_oid, walk->snmp_oid))
+			continue;
+
+		if (SUCCEED == cache_get_snmp_index(&get_context->agent, get_item->index_oid, get_item->index_value,
+				&idx, &idx_alloc))
+		{
+			if (SUCCEED == snmp_get_item_set_index(get_item, idx, error, sizeof(error)))
+				get_item->state = ZBX_SNMP_ITEM_QUERY;
+			else
+				snmp_get_item_set_error(get_item, CONFIG_ERROR, error);
+		}
+		else
+		{
+			char	index_oid[ZBX_ITEM_SNMP_OID_LEN_MAX];
+
+			zbx_get_key_param(get_item->snmp_oid, 2, index_oid, sizeof(index_oid));
+			zbx_snprintf(error, sizeof(error), "Cannot find index of \"%s\" in \"%s\".",
+					get_item->index_value, index_oid);
+			snmp_get_item_set_error(get_item, NOTSUPPORTED, error);
+		}
+	}
+
+	zbx_free(idx);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes response to GETNEXT/GETBULK request of dynamic index    *
+ *          table walk                                                        *
+ *                                                                            *
+ * Parameters: snmp_context - [IN] asynchronous SNMP context                  *
+ *             status       - [IN] response status                            *
+ *             response     - [IN] response PDU                               *
+ *                                                                            *
+ * Comments: The logic is the same as in zbx_snmp_walk().                     *
+ *                                                                            *
+ ******************************************************************************/
+static void	snmp_get_walk_process(zbx_snmp_context_t *snmp_context, int status, struct snmp_pdu *response)
+{
+	zbx_snmp_get_context_t	*get_context = snmp_context->get_context;
+	zbx_snmp_index_walk_t	*walk = get_context->walk;
+	struct variable_list	*var;
+	char			error[MAX_STRING_LEN], oid_index[MAX_STRING_LEN];
+	int			num_vars, ret = SUCCEED;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() OID:'%s' status:%d errstat:%ld max_vars:%d", __func__, walk->snmp_oid,
+			status, NULL == response ? (long)-1 : response->errstat, walk->max_vars);
+
+	if (1 < walk->max_vars &&
+			((STAT_SUCCESS == status && SNMP_ERR_TOOBIG == response->errstat) || STAT_TIMEOUT == status))
+	{
+reduce_max_vars:
+		if (get_context->min_fail > walk->max_vars)
+			get_context->min_fail = walk->max_vars;
+
+		if (0 == walk->level)
+			walk->max_vars /= 2;
+		else if (1 == walk->level)
+			walk->max_vars = 1;
+
+		walk->level++;
+
+		goto out;
+	}
+	else if (STAT_SUCCESS != status || SNMP_ERR_NOERROR != response->errstat)
+	{
+		if (1 >= walk->level && 1 < walk->max_vars)
+			goto reduce_max_vars;
+
+		ret = zbx_get_snmp_response_error(snmp_context->ssp, &snmp_context->item.interface, status, response,
+				error, sizeof(error));
+		goto out;
+	}
+
+	if (NULL == response->variables)
+	{
+		if (1 >= walk->level && 1 < walk->max_vars)
+			goto reduce_max_vars;
+
+		zbx_strlcpy(error, "No values received.", sizeof(error));
+		ret = NOTSUPPORTED;
+		goto out;
+	}
+
+	for (num_vars = 0, var = response->variables; NULL != var; num_vars++, var = var->next_variable)
+	{
+		AGENT_RESULT	snmp_result;
+		unsigned char	val_type;
+
+		/* verify if we are in the same subtree */
+		if (SNMP_ENDOFMIBVIEW == var->type || var->name_length < walk->root_length ||
+				0 != memcmp(walk->root, var->name, walk->root_length * sizeof(oid)))
+		{
+			/* reached the end or past this subtree */
+			walk->running = 0;
+			break;
+		}
+
+		if (SNMP_NOSUCHOBJECT == var->type || SNMP_NOSUCHINSTANCE == var->type)
+		{
+			/* an exception value, so stop */
+			char	*errmsg;
+
+			errmsg = zbx_get_snmp_type_error(var->type);
+			zbx_strlcpy(error, errmsg, sizeof(error));
+			zbx_free(errmsg);
+			ret = NOTSUPPORTED;
+			break;
+		}
+
+		if (1 == walk->check_oid_increase)
+		{
+			int	res;
+
+			if (-1 != (res = snmp_oid_compare(walk->name, walk->name_length, var->name, var->name_length)))
+			{
+				if (0 == res)
+				{
+					zbx_strlcpy(error, "OID not changing.", sizeof(error));
+					ret = NOTSUPPORTED;
+					break;
+				}
+
+				/* OID decreased, set up a protection against endless looping */
+				walk->check_oid_increase = 0;
+				zbx_detect_loop_init(&walk->oids_seen);
+			}
+		}
+
+		if (0 == walk->check_oid_increase && FAIL == zbx_oid_is_new(&walk->oids_seen, walk->root_length,
+				var->name, var->name_length))
+		{
+			zbx_strlcpy(error, "OID loop detected or too many OIDs.", sizeof(error));
+			ret = NOTSUPPORTED;
+			break;
+		}
+
+		if (SUCCEED != zbx_snmp_choose_index(oid_index, sizeof(oid_index), var->name, var->name_length,
+				walk->root_string_len, walk->root_numeric_len, walk->root_oid))
+		{
+			zbx_snprintf(error, sizeof(error), "zbx_snmp_choose_index(): cannot choose appropriate index"
+					" while walking for OID \"%s\".", walk->snmp_oid);
+			ret = NOTSUPPORTED;
+			break;
+		}
+
+		zbx_init_agent_result(&snmp_result);
+
+		if (SUCCEED == zbx_snmp_set_result(var, &snmp_result, &val_type))
+		{
+			if (ZBX_ISSET_TEXT(&snmp_result) && ZBX_SNMP_STR_HEX == val_type)
+				zbx_remove_chars(snmp_result.text, "\r\n");
+
+			if (NULL != ZBX_GET_STR_RESULT(&snmp_result))
+				cache_put_snmp_index(&get_context->agent, walk->snmp_oid, oid_index, snmp_result.str);
+		}
+
+		zbx_free_agent_result(&snmp_result);
+
+		memcpy(walk->name, var->name, var->name_length * sizeof(oid));
+		walk->name_length = var->name_length;
+	}
+
+	if (get_context->max_succeed < num_vars)
+		get_context->max_succeed = num_vars;
+out:
+	if (SUCCEED != ret)
+	{
+		/* network error relates to all items, including those not waiting for this walk */
+		if (NETWORK_ERROR == ret)
+			snmp_get_context_set_error(get_context, ret, error);
+		else
+			snmp_get_walk_set_error(get_context, walk->snmp_oid, ret, error);
+	}
+	else if (0 == walk->running)
+		snmp_get_walk_finish(get_context);
+
+	if (SUCCEED != ret || 0 == walk->running)
+	{
+		snmp_get_walk_free(walk);
+		get_context->walk = NULL;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+}
+
+static int	asynch_get_response(int operation, struct snmp_session *sp, int reqid, struct snmp_pdu *pdu,
+		void *magic)
+{
+	zbx_snmp_context_t	*snmp_context = (zbx_snmp_context_t *)magic;
+	zbx_snmp_get_context_t	*get_context = snmp_context->get_context;
+	int			stat;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	ZBX_UNUSED(sp);
+
+	if (reqid != get_context->reqid && ((NULL != pdu && SNMP_MSG_REPORT != pdu->command) ||
+			NETSNMP_CALLBACK_OP_TIMED_OUT == operation))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "unexpected response request id:%d expected request id:%d command:%d"
+				" operation:%d", reqid, get_context->reqid, NULL != pdu ? pdu->command : -1, operation);
+		return 0;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "operation:%d response id:%d command:%d probe:%d", operation, reqid,
+			NULL != pdu ? pdu->command : -1, snmp_context->probe);
+
+	get_context->waiting = 0;
+
+	if (1 == snmp_context->probe)
+		goto out;
+
+	switch (operation)
+	{
+		case NETSNMP_CALLBACK_OP_RECEIVED_MESSAGE:
+			stat = STAT_SUCCESS;
+			break;
+		case NETSNMP_CALLBACK_OP_TIMED_OUT:
+			stat = STAT_TIMEOUT;
+			break;
+		case NETSNMP_CALLBACK_OP_SEND_FAILED:
+		case NETSNMP_CALLBACK_OP_DISCONNECT:
+		case NETSNMP_CALLBACK_OP_SEC_ERROR:
+			stat = STAT_ERROR;
+			break;
+		case NETSNMP_CALLBACK_OP_CONNECT:
+		case NETSNMP_CALLBACK_OP_RESEND:
+		default:
+			goto out;
+	}
+
+	if (STAT_SUCCESS == stat && NULL == pdu)
+	{
+		char	error[MAX_STRING_LEN];
+
+		zbx_snprintf(error, sizeof(error), "SNMP error: [%d]", stat);
+		snmp_get_context_set_error(get_context, NOTSUPPORTED, error);
+	}
+	else if (NULL != get_context->walk)
+		snmp_get_walk_process(snmp_context, stat, pdu);
+	else
+		snmp_get_values_process(snmp_context, stat, pdu);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+
+	return 1;
+}
+
+static int	snmp_get_values_pdu_create(zbx_snmp_get_context_t *get_context, struct snmp_pdu **pdu, char *error,
+		size_t max_error_len)
+{
+	for (int i = 0; i < get_context->items.values_num; i++)
+	{
+		zbx_snmp_get_item_t	*get_item = get_context->items.values[i];
+		zbx_snmp_binding_t	binding = {.get_item = get_item};
+
+		if (get_context->bindings.values_num >= get_context->max_vars)
+			break;
+
+		if (ZBX_SNMP_ITEM_VERIFY == get_item->state)
+		{
+			/* value is queried together with cached index verification, */
+			/* it is ignored if the index turns out to be stale           */
+			binding.verify = 1;
+			zbx_vector_snmp_binding_append(&get_context->bindings, binding);
+
+			if (get_context->bindings.values_num >= get_context->max_vars)
+				break;
+		}
+		else if (ZBX_SNMP_ITEM_QUERY != get_item->state)
+			continue;
+
+		binding.verify = 0;
+		zbx_vector_snmp_binding_append(&get_context->bindings, binding);
+	}
+
+	if (0 == get_context->bindings.values_num)
+		return FAIL;
+
+	if (NULL == (*pdu = snmp_pdu_create(SNMP_MSG_GET)))
+	{
+		zbx_strlcpy(error, "snmp_pdu_create(): cannot create PDU object.", max_error_len);
+		return CONFIG_ERROR;
+	}
+
+	for (int i = 0; i < get_context->bindings.values_num; i++)
+	{
+		zbx_snmp_binding_t	*binding = &get_context->bindings.values[i];
+		netsnmp_variable_list	*var;
+
+		if (1 == binding->verify)
+		{
+			var = snmp_add_null_var(*pdu, binding->get_item->index_name,
+					binding->get_item->index_name_length);
+		}
+		else
+			var = snmp_add_null_var(*pdu, binding->get_item->name, binding->get_item->name_length);
+
+		if (NULL == var)
+		{
+			zbx_strlcpy(error, "snmp_add_null_var(): cannot add null variable.", max_error_len);
+			snmp_free_pdu(*pdu);
+			return CONFIG_ERROR;
+		}
+	}
+
+	return SUCCEED;
+}
+
+static int	snmp_get_walk_start(zbx_snmp_context_t *snmp_context, const char *snmp_oid, char *error,
+		size_t max_error_len)
+{
+	zbx_snmp_get_context_t	*get_context = snmp_context->get_context;
+	zbx_snmp_index_walk_t	*walk;
+
+	walk = (zbx_snmp_index_walk_t *)zbx_malloc(NULL, sizeof(zbx_snmp_index_walk_t));
+	walk->root_length = MAX_OID_LEN;
+
+	if (SUCCEED != zbx_snmp_walk_root_init(snmp_oid, walk->root, &walk->root_length, &walk->root_string_len,
+			&walk->root_numeric_len, walk->root_oid, sizeof(walk->root_oid), error, max_error_len))
+	{
+		zbx_free(walk);
+		return FAIL;
+	}
+
+	memcpy(walk->name, walk->root, walk->root_length * sizeof(oid));
+	walk->name_length = walk->root_length;
+	walk->snmp_oid = snmp_oid;
+	walk->max_vars = get_context->max_vars;
+	walk->level = 0;
+	walk->running = 1;
+	walk->check_oid_increase = 1;
+
+	/* GetBulkRequest-PDU available since SNMPv2 */
+	if (ZBX_IF_SNMP_VERSION_1 == snmp_context->snmp_version)
+		walk->bulk = SNMP_BULK_DISABLED;
+	else
+		walk->bulk = get_context->bulk;
+
+	cache_del_snmp_index_subtree(&get_context->agent, snmp_oid);
+	get_context->walk = walk;
+
+	return SUCCEED;
+}
+
+static int	snmp_get_walk_pdu_create(zbx_snmp_context_t *snmp_context, struct snmp_pdu **pdu, char *error,
+		size_t max_error_len)
+{
+	zbx_snmp_get_context_t	*get_context = snmp_context->get_context;
+	zbx_snmp_index_walk_t	*walk;
+
+	while (NULL == get_context->walk)
+	{
+		zbx_snmp_get_item_t	*get_item = NULL;
+
+		for (int i = 0; i < get_context->items.values_num; i++)
+		{
+			if (ZBX_SNMP_ITEM_WALK == get_context->items.values[i]->state)
+			{
+				get_item = get_context->items.values[i];
+				break;
+			}
+		}
+
+		if (NULL == get_item)
+			return FAIL;
+
+		if (SUCCEED != snmp_get_walk_start(snmp_context, get_item->index_oid, error, max_error_len))
+			snmp_get_walk_set_error(get_context, get_item->index_oid, CONFIG_ERROR, error);
+	}
+
+	walk = get_context->walk;
+
+	if (NULL == (*pdu = snmp_pdu_create(SNMP_BULK_ENABLED == walk->bulk ? SNMP_MSG_GETBULK : SNMP_MSG_GETNEXT)))
+	{
+		zbx_strlcpy(error, "snmp_pdu_create(): cannot create PDU object.", max_error_len);
+		return CONFIG_ERROR;
+	}
+
+	if (NULL == snmp_add_null_var(*pdu, walk->name, walk->name_length))
+	{
+		zbx_strlcpy(error, "snmp_add_null_var(): cannot add null variable.", max_error_len);
+		snmp_free_pdu(*pdu);
+		return CONFIG_ERROR;
+	}
+
+	if (SNMP_BULK_ENABLED == walk->bulk)
+	{
+		(*pdu)->non_repeaters = 0;
+		(*pdu)->max_repetitions = walk->max_vars;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sends next request of coalesced items                             *
+ *                                                                            *
+ * Parameters: snmp_context  - [IN] asynchronous SNMP context                 *
+ *             fd            - [OUT] socket to wait response on               *
+ *             error         - [OUT] buffer to store error message            *
+ *             max_error_len - [IN] maximum error message length              *
+ *                                                                            *
+ * Return value: SUCCEED - request was sent                                   *
+ *               FAIL - all items are processed                               *
+ *               CONFIG_ERROR, NETWORK_ERROR - request cannot be sent         *
+ *                                                                            *
+ * Comments: Values and cached indices are queried first, then index tables   *
+ *           of dynamic items with unknown or stale indices are walked and    *
+ *           values of those items are queried afterwards.                    *
+ *                                                                            *
+ ******************************************************************************/
+static int	snmp_get_add(zbx_snmp_context_t *snmp_context, int *fd, char *error, size_t max_error_len)
+{
+	zbx_snmp_get_context_t	*get_context = snmp_context->get_context;
+	struct snmp_pdu		*pdu;
+	int			ret;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	zbx_vector_snmp_binding_clear(&get_context->bindings);
+
+	if (1 == snmp_context->probe)
+	{
+		netsnmp_session	*session = snmp_sess_session(snmp_context->ssp);
+
+		session->flags |= SNMP_FLAGS_DONT_PROBE;
+
+		if (NULL == (pdu = usm_probe_pdu_create()))
+		{
+			zbx_strlcpy(error, "snmp_pdu_create(): cannot create PDU object.", max_error_len);
+			ret = CONFIG_ERROR;
+			goto out;
+		}
+	}
+	else if (NULL != get_context->walk ||
+			FAIL == (ret = snmp_get_values_pdu_create(get_context, &pdu, error, max_error_len)))
+	{
+		if (SUCCEED != (ret = snmp_get_walk_pdu_create(snmp_context, &pdu, error, max_error_len)))
+			goto out;
+	}
+	else if (SUCCEED != ret)
+		goto out;
+
+	get_context->waiting = 1;
+
+	ret = snmp_context_send(snmp_context, pdu, asynch_get_response, snmp_context, &get_context->reqid,
+			&get_context->fdset, fd, error, max_error_len);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reduces coalesced request that timed out and lets device respond  *
+ *          to a smaller one                                                  *
+ *                                                                            *
+ * Parameters: snmp_context - [IN] asynchronous SNMP context                  *
+ *                                                                            *
+ * Return value: SUCCEED - request should be sent again with fewer variables  *
+ *               FAIL - request in flight cannot be reduced any further       *
+ *                                                                            *
+ * Comments: The logic is the same as timeout handling of synchronous         *
+ *           pollers - halve the number of variables first, then query them   *
+ *           one by one. Timeout of a single variable request fails all items *
+ *           that are not processed yet.                                      *
+ *                                                                            *
+ ******************************************************************************/
+static int	snmp_get_context_retry(zbx_snmp_context_t *snmp_context)
+{
+	zbx_snmp_get_context_t	*get_context = snmp_context->get_context;
+
+	if (NULL == snmp_context->ssp || 1 == snmp_context->probe || 0 == get_context->waiting)
+		return FAIL;
+
+	if (NULL != get_context->walk)
+	{
+		if (1 >= get_context->walk->max_vars)
+			return FAIL;
+
+		snmp_get_walk_process(snmp_context, STAT_TIMEOUT, NULL);
+	}
+	else
+	{
+		if (1 >= get_context->bindings.values_num)
+			return FAIL;
+
+		snmp_get_values_process(snmp_context, STAT_TIMEOUT, NULL);
+	}
+
+	/* late response to the abandoned request is ignored by request id */
+	get_context->waiting = 0;
+
+	return SUCCEED;
+}
+
+static void	snmp_get_context_timeout(zbx_snmp_context_t *snmp_context, const char *dnserr)
+{
+	zbx_snmp_get_context_t	*get_context = snmp_context->get_context;
+	int			num;
+
+	/* the request in flight might have been too big for device to respond to at all, */
+	/* make configuration cache suggest fewer variables next time                     */
+	if (NULL != get_context->walk)
+		num = get_context->walk->max_vars;
+	else
+		num = get_context->bindings.values_num;
+
+	if (1 < num && get_context->min_fail > num)
+		get_context->min_fail = num;
+
+	for (int i = 0; i < get_context->items.values_num; i++)
+	{
+		zbx_snmp_get_item_t	*get_item = get_context->items.values[i];
+		zbx_dc_item_context_t	*item = get_item->item;
+
+		if (ZBX_SNMP_ITEM_DONE == get_item->state)
+			continue;
+
+		if (NULL != dnserr)
+		{
+			SET_MSG_RESULT(&item->result, zbx_dsprintf(NULL, "cannot resolve address [[%s]:%hu]: timed out:"
+					" %s", item->interface.addr, item->interface.port, dnserr));
+		}
+		else if (ZBX_IF_SNMP_VERSION_3 == snmp_context->snmp_version && 0 == snmp_context->probe)
+		{
+			SET_MSG_RESULT(&item->result, zbx_dsprintf(NULL, "Probe successful, cannot retrieve OID: '%s'"
+					" from [[%s]:%hu]: timed out", get_item->snmp_oid, item->interface.addr,
+					item->interface.port));
+		}
+		else
+		{
+			SET_MSG_RESULT(&item->result, zbx_dsprintf(NULL, "cannot retrieve OID: '%s' from [[%s]:%hu]:"
+					" timed out", get_item->snmp_oid, item->interface.addr, item->interface.port));
+		}
+
+		item->ret = TIMEOUT_ERROR;
+		get_item->state = ZBX_SNMP_ITEM_DONE;
+	}
+}
+
+static void	snmp_get_context_update_stats(zbx_snmp_context_t *snmp_context)
+{
+	zbx_snmp_get_context_t	*get_context = snmp_context->get_context;
+
+	if (SNMP_BULK_ENABLED == get_context->bulk &&
+			(0 != get_context->max_succeed || ZBX_MAX_SNMP_ITEMS + 1 != get_context->min_fail))
+	{
+		zbx_dc_config_update_interface_snmp_stats(snmp_context->item.interface.interfaceid,
+				get_context->max_succeed, get_context->min_fail);
+	}
+}
+
+static int	snmp_task_process(short event, void *data, int *fd, const char *addr, char *dnserr)
+{
+	zbx_bulkwalk_context_t	*bulkwalk_context = NULL;
+	zbx_snmp_context_t	*snmp_context = (zbx_snmp_context_t *)data;
+	char			error[MAX_STRING_LEN];
+	int			ret, task_ret = ZBX_ASYNC_TASK_STOP;
+	zbx_poller_config_t	*poller_config = (zbx_poller_config_t *)snmp_context->arg_action;
+	netsnmp_large_fd_set	*fdset;
+	int			*waiting;
+	zbx_snmp_format_opts_t	saved_opts;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() event:%d fd:%d itemid:" ZBX_FS_UI64, __func__, event, *fd,
+			snmp_context->item.itemid);
+
+	if (ZBX_SNMP_STANDARD == snmp_context->snmp_oid_type)
+	{
+		/* values of regular items must be formatted the same way as by synchronous pollers */
+		snmp_set_default_options(&saved_opts);
+		fdset = &snmp_context->get_context->fdset;
+		waiting = &snmp_context->get_context->waiting;
+	}
+	else
+	{
+		bulkwalk_context = snmp_context->bulkwalk_contexts.values[snmp_context->i];
+		fdset = &bulkwalk_context->fdset;
+		waiting = &bulkwalk_context->waiting;
+	}
+
+	if (NULL != poller_config && ZBX_PROCESS_STATE_IDLE == poller_config->state)
+	{
+		zbx_update_selfmon_counter(poller_config->info, ZBX_PROCESS_STATE_BUSY);
+		poller_config->state = ZBX_PROCESS_STATE_BUSY;
+	}
+
+	/* initialization */
+	if (0 != event)
+	{
+		if (0 != (event & EV_TIMEOUT) && ZBX_SNMP_STANDARD == snmp_context->snmp_oid_type)
+		{
+			if (NULL == dnserr && SUCCEED == snmp_get_context_retry(snmp_context))
+				goto send;
+
+			snmp_get_context_timeout(snmp_context, dnserr);
+			goto stop;
+		}
+
+		if (0 != (event & EV_TIMEOUT))
+		{
+			char	buffer[MAX_OID_LEN];
+
+			snprint_objid(buffer, sizeof(buffer), bulkwalk_context->name, bulkwalk_context->name_length);
+
+			if (NULL != dnserr)
+			{
+				SET_MSG_RESULT(&snmp_context->item.result, zbx_dsprintf(NULL,
+						"cannot resolve address [[%s]:%hu]: timed out: %s",
+						snmp_context->item.interface.addr, snmp_context->item.interface.port,
+						dnserr));
+				snmp_context->item.ret = TIMEOUT_ERROR;
+			}
+			else if (ZBX_IF_SNMP_VERSION_3 == snmp_context->snmp_version && 0 == snmp_context->probe)
+			{
+				SET_MSG_RESULT(&snmp_context->item.result, zbx_dsprintf(NULL,
+						"Probe successful, cannot retrieve OID: '%s' from [[%s]:%hu]:"
+						" timed out", buffer, snmp_context->item.interface.addr,
+						snmp_context->item.interface.port));
+				snmp_context->item.ret = TIMEOUT_ERROR;
+			}
+			else
+			{
+				SET_MSG_RESULT(&snmp_context->item.result, zbx_dsprintf(NULL,
+						"cannot retrieve OID: '%s' from [[%s]:%hu]:"
+						" timed out", buffer, snmp_context->item.interface.addr,
+						snmp_context->item.interface.port));
+				snmp_context->item.ret = TIMEOUT_ERROR;
+			}
+
+			goto stop;
+		}
+
+		if (0 != snmp_sess_read2(snmp_context->ssp, fdset))
+		{
+			char		*tmp_err_str = NULL;
+
+			snmp_sess_error(snmp_context->ssp, NULL, NULL, &tmp_err_str);
+			if (NULL != snmp_context->ssp)
+			{
+				snmp_context_set_error(snmp_context, NOTSUPPORTED, zbx_dsprintf(NULL, "cannot read from"
+						" session: %s", tmp_err_str));
+			}
+			else
+			{
+				snmp_context_set_error(snmp_context, NOTSUPPORTED, zbx_dsprintf(NULL, "cannot read from"
+						" session"));
+			}
+
+			zbx_free(tmp_err_str);
+			goto stop;
+		}
+
+		if (1 == snmp_context->probe)
+		{
+			netsnmp_session	*session = snmp_sess_session(snmp_context->ssp);
+
+			if (0 != session->engineBoots || 0 != session->engineTime)
+			{
+				set_enginetime(session->securityEngineID, (u_int)session->securityEngineIDLen,
+						session->engineBoots, session->engineTime, TRUE);
+			}
+
+			if (FAIL == zbx_snmp_cache_handle_engineid(session, &snmp_context->item))
+			{
+				snmp_context_set_error(snmp_context, NOTSUPPORTED, zbx_dsprintf(NULL,
 						"SNMP engineId is not unique"));
 				goto stop;
 			}
@@ -2954,7 +4201,7 @@ static int	snmp_task_process(short event, void *data, int *fd, const char *addr,
 			snmp_context->probe = 0;
 		}
 
-		if (NULL != bulkwalk_context->error)
+		if (NULL != bulkwalk_context && NULL != bulkwalk_context->error)
 		{
 			snmp_context->item.ret = NOTSUPPORTED;
 			SET_MSG_RESULT(&snmp_context->item.result, bulkwalk_context->error);
@@ -2962,13 +4209,13 @@ static int	snmp_task_process(short event, void *data, int *fd, const char *addr,
 			goto stop;
 		}
 
-		if (1 == bulkwalk_context->waiting)
+		if (1 == *waiting)
 		{
 			zabbix_log(LOG_LEVEL_DEBUG, "cannot process PDU result for itemid:" ZBX_FS_UI64,
 					snmp_context->item.itemid);
 		}
 
-		if (0 == bulkwalk_context->running)
+		if (NULL != bulkwalk_context && 0 == bulkwalk_context->running)
 		{
 			if (0 == bulkwalk_context->vars_num && SNMP_MSG_GETBULK == bulkwalk_context->pdu_type)
 			{
@@ -3002,28 +4249,48 @@ static int	snmp_task_process(short event, void *data, int *fd, const char *addr,
 				snmp_context->snmpv3_privpassphrase, error, sizeof(error),
 				snmp_context->config_timeout, snmp_context->config_source_ip)))
 		{
-			snmp_context->item.ret = NOTSUPPORTED;
-			SET_MSG_RESULT(&snmp_context->item.result, zbx_dsprintf(NULL,
+			snmp_context_set_error(snmp_context, NOTSUPPORTED, zbx_dsprintf(NULL,
 					"zbx_snmp_open_session() failed"));
 			goto stop;
 		}
 	}
-
-	if (SUCCEED != (ret = snmp_bulkwalk_add(snmp_context, fd, error, sizeof(error))))
-	{
-		snmp_context->item.ret = ret;
-		SET_MSG_RESULT(&snmp_context->item.result, zbx_dsprintf(NULL, "Get value failed: %s", error));
-	}
+send:
+	if (ZBX_SNMP_STANDARD == snmp_context->snmp_oid_type)
+		ret = snmp_get_add(snmp_context, fd, error, sizeof(error));
 	else
+		ret = snmp_bulkwalk_add(snmp_context, fd, error, sizeof(error));
+
+	if (SUCCEED == ret)
 		task_ret = ZBX_ASYNC_TASK_READ;
+	else if (FAIL != ret)	/* FAIL - all coalesced items are processed */
+		snmp_context_set_error(snmp_context, ret, zbx_dsprintf(NULL, "Get value failed: %s", error));
 stop:
+	if (ZBX_SNMP_STANDARD == snmp_context->snmp_oid_type)
+	{
+		if (ZBX_ASYNC_TASK_STOP == task_ret)
+			snmp_get_context_update_stats(snmp_context);
+
+		snmp_bulkwalk_set_options(&saved_opts);
+	}
+
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 
 	return task_ret;
 }
 
-zbx_dc_item_context_t	*zbx_async_check_snmp_get_item_context(zbx_snmp_context_t *snmp_context)
+int	zbx_async_check_snmp_get_items_num(zbx_snmp_context_t *snmp_context)
 {
+	if (ZBX_SNMP_STANDARD == snmp_context->snmp_oid_type)
+		return snmp_context->get_context->items.values_num;
+
+	return 1;
+}
+
+zbx_dc_item_context_t	*zbx_async_check_snmp_get_item_context(zbx_snmp_context_t *snmp_context, int index)
+{
+	if (ZBX_SNMP_STANDARD == snmp_context->snmp_oid_type)
+		return snmp_context->get_context->items.values[index]->item;
+
 	return &snmp_context->item;
 }
 
@@ -3043,10 +4310,11 @@ void	zbx_async_check_snmp_clean(zbx_snmp_context_t *snmp_context)
 	zbx_free(snmp_context->snmpv3_authpassphrase);
 	zbx_free(snmp_context->snmpv3_privpassphrase);
 
-	zbx_free(snmp_context->item.key);
-	zbx_free(snmp_context->item.key_orig);
+	if (NULL != snmp_context->get_context)
+		snmp_get_context_free(snmp_context);
+
+	snmp_item_context_clean(&snmp_context->item);
 	zbx_free(snmp_context->results);
-	zbx_free_agent_result(&snmp_context->item.result);
 
 	zbx_vector_bulkwalk_context_clear_ext(&snmp_context->bulkwalk_contexts, snmp_bulkwalk_context_free);
 	zbx_vector_bulkwalk_context_destroy(&snmp_context->bulkwalk_contexts);
@@ -3055,35 +4323,14 @@ void	zbx_async_check_snmp_clean(zbx_snmp_context_t *snmp_context)
 	zbx_free(snmp_context);
 }
 
-int	zbx_async_check_snmp(zbx_dc_item_t *item, AGENT_RESULT *result, zbx_async_task_clear_cb_t clear_cb,
-		void *arg, void *arg_action, struct event_base *base, struct evdns_base *dnsbase,
+static zbx_snmp_context_t	*snmp_context_create(zbx_dc_item_t *item, void *arg, void *arg_action,
 		const char *config_source_ip)
 {
-	int			ret = SUCCEED, pdu_type;
-	AGENT_REQUEST		request;
 	zbx_snmp_context_t	*snmp_context;
-	char			error[MAX_STRING_LEN];
-
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() key:'%s' host:'%s' addr:'%s'", __func__, item->key,
-			item->host.host, item->interface.addr);
 
 	snmp_context = zbx_malloc(NULL, sizeof(zbx_snmp_context_t));
 	snmp_context->ssp = NULL;
-	snmp_context->item.interface = item->interface;
-	snmp_context->item.interface.addr = (item->interface.addr == item->interface.dns_orig ?
-			snmp_context->item.interface.dns_orig : snmp_context->item.interface.ip_orig);
-	zbx_strlcpy(snmp_context->item.host, item->host.host, sizeof(snmp_context->item.host));
-	snmp_context->item.itemid = item->itemid;
-	snmp_context->item.hostid = item->host.hostid;
-	snmp_context->item.value_type = item->value_type;
-	snmp_context->item.flags = item->flags;
-	snmp_context->item.key = item->key;
-	item->key = NULL;
-	snmp_context->item.key_orig = zbx_strdup(NULL, item->key_orig);
-
-	snmp_context->item.version = item->interface.version;
-
-	zbx_init_agent_result(&snmp_context->item.result);
+	snmp_item_context_init(&snmp_context->item, item);
 
 	snmp_context->config_timeout = item->timeout;
 
@@ -3110,12 +4357,31 @@ int	zbx_async_check_snmp(zbx_dc_item_t *item, AGENT_RESULT *result, zbx_async_ta
 	snmp_context->snmpv3_privpassphrase = item->snmpv3_privpassphrase;
 	item->snmpv3_privpassphrase = NULL;
 	snmp_context->config_source_ip = config_source_ip;
+	snmp_context->probe = ZBX_IF_SNMP_VERSION_3 == item->snmp_version ? 1 : 0;
+	snmp_context->snmp_oid_type = ZBX_SNMP_GET;
+	snmp_context->get_context = NULL;
 
 	zbx_vector_bulkwalk_context_create(&snmp_context->bulkwalk_contexts);
+	zbx_vector_snmp_oid_create(&snmp_context->param_oids);
 
-	zbx_init_agent_request(&request);
+	return snmp_context;
+}
 
-	zbx_vector_snmp_oid_create(&snmp_context->param_oids);
+int	zbx_async_check_snmp(zbx_dc_item_t *item, AGENT_RESULT *result, zbx_async_task_clear_cb_t clear_cb,
+		void *arg, void *arg_action, struct event_base *base, struct evdns_base *dnsbase,
+		const char *config_source_ip)
+{
+	int			ret = SUCCEED, pdu_type;
+	AGENT_REQUEST		request;
+	zbx_snmp_context_t	*snmp_context;
+	char			error[MAX_STRING_LEN];
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() key:'%s' host:'%s' addr:'%s'", __func__, item->key,
+			item->host.host, item->interface.addr);
+
+	snmp_context = snmp_context_create(item, arg, arg_action, config_source_ip);
+
+	zbx_init_agent_request(&request);
 
 	if (SUCCEED != zbx_parse_item_key(item->snmp_oid, &request))
 	{
@@ -3142,8 +4408,6 @@ int	zbx_async_check_snmp(zbx_dc_item_t *item, AGENT_RESULT *result, zbx_async_ta
 		pdu_type = SNMP_MSG_GET;
 	}
 
-	snmp_context->probe = ZBX_IF_SNMP_VERSION_3 == item->snmp_version ? 1 : 0;
-
 	if (SNMP_MSG_GETBULK == pdu_type && 1 > item->snmp_max_repetitions)
 	{
 		SET_MSG_RESULT(result, zbx_strdup(NULL, "Invalid max repetition count: it should be at least 1."));
@@ -3184,6 +4448,181 @@ out:
 	return ret;
 }
 
+typedef struct
+{
+	zbx_uint64_t		interfaceid;
+	zbx_snmp_context_t	*snmp_context;
+}
+zbx_snmp_interface_context_t;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if item can be queried within session of existing context  *
+ *                                                                            *
+ ******************************************************************************/
+static int	snmp_context_match_item(const zbx_snmp_context_t *snmp_context, const zbx_dc_item_t *item)
+{
+	if (snmp_context->get_context->items.values_num >= snmp_context->get_context->max_vars)
+		return FAIL;
+
+	if (snmp_context->config_timeout != item->timeout || snmp_context->snmp_version != item->snmp_version ||
+			snmp_context->snmpv3_securitylevel != item->snmpv3_securitylevel ||
+			snmp_context->snmpv3_authprotocol != item->snmpv3_authprotocol ||
+			snmp_context->snmpv3_privprotocol != item->snmpv3_privprotocol)
+	{
+		return FAIL;
+	}
+
+	if (0 != zbx_strcmp_null(snmp_context->snmp_community, item->snmp_community) ||
+			0 != zbx_strcmp_null(snmp_context->snmpv3_securityname, item->snmpv3_securityname) ||
+			0 != zbx_strcmp_null(snmp_context->snmpv3_contextname, item->snmpv3_contextname) ||
+			0 != zbx_strcmp_null(snmp_context->snmpv3_authpassphrase, item->snmpv3_authpassphrase) ||
+			0 != zbx_strcmp_null(snmp_context->snmpv3_privpassphrase, item->snmpv3_privpassphrase))
+	{
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: starts asynchronous checks of SNMP items                          *
+ *                                                                            *
+ * Parameters: items            - [IN/OUT] items to check                     *
+ *             results          - [OUT] results of items that failed to start *
+ *             errcodes         - [IN/OUT] item error codes, only items with  *
+ *                                         SUCCEED are checked                *
+ *             num              - [IN] number of items                        *
+ *             clear_cb         - [IN] callback to process finished context   *
+ *             arg              - [IN] callback argument                      *
+ *             arg_action       - [IN] poller configuration                   *
+ *             base             - [IN] event base                             *
+ *             dnsbase          - [IN] asynchronous DNS base                  *
+ *             config_source_ip - [IN]                                        *
+ *                                                                            *
+ * Return value: number of items being checked                                *
+ *                                                                            *
+ * Comments: walk[] and get[] items are checked by separate tasks, regular    *
+ *           items of the same interface and session parameters are coalesced *
+ *           into single task that queries them with shared GET requests of   *
+ *           up to the number of variables suggested by configuration cache.  *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_async_check_snmp_items(zbx_dc_item_t *items, AGENT_RESULT *results, int *errcodes, int num,
+		zbx_async_task_clear_cb_t clear_cb, void *arg, void *arg_action, struct event_base *base,
+		struct evdns_base *dnsbase, const char *config_source_ip)
+{
+	int			started = 0;
+	zbx_hashset_t		interface_contexts;
+	zbx_vector_ptr_t	snmp_contexts;
+	char			error[MAX_STRING_LEN];
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() num:%d", __func__, num);
+
+	zbx_hashset_create(&interface_contexts, (size_t)num, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_ptr_create(&snmp_contexts);
+
+	for (int i = 0; i < num; i++)
+	{
+		zbx_snmp_interface_context_t	*interface_context, interface_context_local;
+		zbx_snmp_context_t		*snmp_context;
+		zbx_snmp_get_item_t		*get_item;
+		zbx_dc_item_context_t		*item_context;
+
+		if (SUCCEED != errcodes[i] || ITEM_TYPE_SNMP != items[i].type)
+			continue;
+
+		if (0 == strncmp(items[i].snmp_oid, "walk[", ZBX_CONST_STRLEN("walk[")) ||
+				0 == strncmp(items[i].snmp_oid, "get[", ZBX_CONST_STRLEN("get[")))
+		{
+			if (SUCCEED == (errcodes[i] = zbx_async_check_snmp(&items[i], &results[i], clear_cb, arg,
+					arg_action, base, dnsbase, config_source_ip)))
+			{
+				started++;
+			}
+
+			continue;
+		}
+
+		if (SUCCEED != (errcodes[i] = snmp_get_item_create(&items[i], &get_item, error, sizeof(error))))
+		{
+			SET_MSG_RESULT(&results[i], zbx_strdup(NULL, error));
+			continue;
+		}
+
+		if (NULL == (interface_context = (zbx_snmp_interface_context_t *)zbx_hashset_search(
+				&interface_contexts, &items[i].interface.interfaceid)))
+		{
+			interface_context_local.interfaceid = items[i].interface.interfaceid;
+			interface_context_local.snmp_context = NULL;
+			interface_context = (zbx_snmp_interface_context_t *)zbx_hashset_insert(&interface_contexts,
+					&interface_context_local, sizeof(interface_context_local));
+		}
+
+		if (NULL == (snmp_context = interface_context->snmp_context) ||
+				SUCCEED != snmp_context_match_item(snmp_context, &items[i]))
+		{
+			zbx_snmp_get_context_t	*get_context;
+
+			snmp_context = snmp_context_create(&items[i], arg, arg_action, config_source_ip);
+			snmp_context->snmp_oid_type = ZBX_SNMP_STANDARD;
+
+			get_context = (zbx_snmp_get_context_t *)zbx_malloc(NULL, sizeof(zbx_snmp_get_context_t));
+			zbx_vector_snmp_get_item_ptr_create(&get_context->items);
+			zbx_vector_snmp_binding_create(&get_context->bindings);
+			get_context->walk = NULL;
+			get_context->reqid = -1;
+			get_context->waiting = 0;
+			get_context->level = 0;
+			get_context->max_succeed = 0;
+			get_context->min_fail = ZBX_MAX_SNMP_ITEMS + 1;
+			get_context->max_vars = zbx_dc_config_get_suggested_snmp_vars(items[i].interface.interfaceid,
+					&get_context->bulk);
+			snmpidx_agent_init(&get_context->agent, snmp_context->item.interface.addr,
+					snmp_context->item.interface.port, snmp_context->snmp_version,
+					snmp_context->snmp_community, snmp_context->snmpv3_contextname,
+					snmp_context->snmpv3_securityname);
+			netsnmp_large_fd_set_init(&get_context->fdset, FD_SETSIZE);
+			snmp_context->get_context = get_context;
+
+			interface_context->snmp_context = snmp_context;
+			zbx_vector_ptr_append(&snmp_contexts, snmp_context);
+
+			item_context = &snmp_context->item;
+		}
+		else
+		{
+			item_context = (zbx_dc_item_context_t *)zbx_malloc(NULL, sizeof(zbx_dc_item_context_t));
+			snmp_item_context_init(item_context, &items[i]);
+		}
+
+		get_item->item = item_context;
+		zbx_vector_snmp_get_item_ptr_append(&snmp_context->get_context->items, get_item);
+		started++;
+	}
+
+	for (int i = 0; i < snmp_contexts.values_num; i++)
+	{
+		zbx_snmp_context_t	*snmp_context = (zbx_snmp_context_t *)snmp_contexts.values[i];
+
+		zabbix_log(LOG_LEVEL_DEBUG, "%s() host:'%s' addr:'%s' coalesced:%d max_vars:%d", __func__,
+				snmp_context->item.host, snmp_context->item.interface.addr,
+				snmp_context->get_context->items.values_num, snmp_context->get_context->max_vars);
+
+		zbx_async_poller_add_task(base, dnsbase, snmp_context->item.interface.addr, snmp_context,
+				snmp_context->config_timeout, snmp_task_process, clear_cb);
+	}
+
+	zbx_vector_ptr_destroy(&snmp_contexts);
+	zbx_hashset_destroy(&interface_contexts);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() started:%d", __func__, started);
+
+	return started;
+}
+
 static int	zbx_snmp_process_dynamic(zbx_snmp_sess_t ssp, const zbx_dc_item_t *items, AGENT_RESULT *results,
 		int *errcodes, int num, char *error, size_t max_error_len, int *max_succeed, int *min_fail, int bulk,
 		unsigned char poller_type)
@@ -3197,10 +4636,12 @@ static int	zbx_snmp_process_dynamic(zbx_snmp_sess_t ssp, const zbx_dc_item_t *it
 			oids_translated[ZBX_MAX_SNMP_ITEMS][ZBX_ITEM_SNMP_OID_LEN_MAX];
 	char		*idx = NULL;
 	size_t		idx_alloc = 32;
+	zbx_snmpidx_agent_t	agent;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	idx = (char *)zbx_malloc(idx, idx_alloc);
+	snmpidx_agent_init_by_item(&agent, &items[0]);
 
 	/* perform initial item validation */
 
@@ -3233,7 +4674,7 @@ static int	zbx_snmp_process_dynamic(zbx_snmp_sess_t ssp, const zbx_dc_item_t *it
 
 		zbx_snmp_translate(oids_translated[i], index_oids[i], sizeof(oids_translated[i]));
 
-		if (SUCCEED == cache_get_snmp_index(&items[i], oids_translated[i], index_values[i], &idx, &idx_alloc))
+		if (SUCCEED == cache_get_snmp_index(&agent, oids_translated[i], index_values[i], &idx, &idx_alloc))
 		{
 			zbx_snprintf(to_verify_oids[i], sizeof(to_verify_oids[i]), "%s.%s", oids_translated[i], idx);
 
@@ -3307,10 +4748,10 @@ static int	zbx_snmp_process_dynamic(zbx_snmp_sess_t ssp, const zbx_dc_item_t *it
 
 			/* walk */
 
-			cache_del_snmp_index_subtree(&items[j], oids_translated[j]);
+			cache_del_snmp_index_subtree(&agent, oids_translated[j]);
 
 			int	errcode = zbx_snmp_walk(ssp, &items[j], oids_translated[j], error, max_error_len,
-					max_succeed, min_fail, num, bulk, zbx_snmp_walk_cache_cb, (void *)&items[j]);
+					max_succeed, min_fail, num, bulk, zbx_snmp_walk_cache_cb, (void *)&agent);
 
 			if (NETWORK_ERROR == errcode)
 			{
@@ -3344,7 +4785,7 @@ static int	zbx_snmp_process_dynamic(zbx_snmp_sess_t ssp, const zbx_dc_item_t *it
 			if (SUCCEED != errcodes[j])
 				continue;
 
-			if (SUCCEED == cache_get_snmp_index(&items[j], oids_translated[j], index_values[j], &idx,
+			if (SUCCEED == cache_get_snmp_index(&agent, oids_translated[j], index_values[j], &idx,
 						&idx_alloc))
 			{
 				/* ready to construct the final OID with index */
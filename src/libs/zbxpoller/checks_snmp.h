@@ -40,7 +40,11 @@ void	get_values_snmp(zbx_dc_item_t *items, AGENT_RESULT *results, int *errcodes,
 int	zbx_async_check_snmp(zbx_dc_item_t *item, AGENT_RESULT *result, zbx_async_task_clear_cb_t clear_cb,
 		void *arg, void *arg_action, struct event_base *base, struct evdns_base *dnsbase,
 		const char *config_source_ip);
-zbx_dc_item_context_t	*zbx_async_check_snmp_get_item_context(zbx_snmp_context_t *snmp_context);
+int	zbx_async_check_snmp_items(zbx_dc_item_t *items, AGENT_RESULT *results, int *errcodes, int num,
+		zbx_async_task_clear_cb_t clear_cb, void *arg, void *arg_action, struct event_base *base,
+		struct evdns_base *dnsbase, const char *config_source_ip);
+int	zbx_async_check_snmp_get_items_num(zbx_snmp_context_t *snmp_context);
+zbx_dc_item_context_t	*zbx_async_check_snmp_get_item_context(zbx_snmp_context_t *snmp_context, int index);
 void	*zbx_async_check_snmp_get_arg(zbx_snmp_context_t *snmp_context);
 void	zbx_async_check_snmp_clean(zbx_snmp_context_t *snmp_context);
 
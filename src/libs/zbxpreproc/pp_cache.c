@@ -23,6 +23,89 @@
 #include "zbxjson.h"
 #include "zbxprometheus.h"
 #include "preproc_snmp.h"
+#include "zbxxml.h"
+
+struct zbx_pp_cache_results
+{
+	zbx_hashset_t	results;
+	pthread_mutex_t	lock;
+};
+
+/* result of leading preprocessing steps, identified by normalized step types and parameters */
+typedef struct
+{
+	char		*key;
+	zbx_pp_cache_t	*cache;
+}
+zbx_pp_cache_result_t;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get cache type for the preprocessing step using cache             *
+ *                                                                            *
+ ******************************************************************************/
+static int	pp_cache_get_type(int step_type)
+{
+	switch (step_type)
+	{
+		/* 'prometheus pattern' cache is reused for 'prometheus to json' */
+		case ZBX_PREPROC_PROMETHEUS_TO_JSON:
+			return ZBX_PREPROC_PROMETHEUS_PATTERN;
+		default:
+			return step_type;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: create shared step result registry                                *
+ *                                                                            *
+ * Return value: The created registry or NULL if its lock cannot be           *
+ *               initialized.                                                 *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_pp_cache_results_t	*pp_cache_results_create(void)
+{
+	zbx_pp_cache_results_t	*results;
+	int			err;
+
+	results = (zbx_pp_cache_results_t *)zbx_malloc(NULL, sizeof(zbx_pp_cache_results_t));
+
+	if (0 != (err = pthread_mutex_init(&results->lock, NULL)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot initialize preprocessing cache mutex: %s", zbx_strerror(err));
+		zbx_free(results);
+
+		return NULL;
+	}
+
+	zbx_hashset_create(&results->results, 0, ZBX_DEFAULT_STRING_PTR_HASH_FUNC, ZBX_DEFAULT_STR_COMPARE_FUNC);
+
+	return results;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: free shared step result registry                                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	pp_cache_results_free(zbx_pp_cache_results_t *results)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_pp_cache_result_t	*result;
+
+	zbx_hashset_iter_reset(&results->results, &iter);
+
+	while (NULL != (result = (zbx_pp_cache_result_t *)zbx_hashset_iter_next(&iter)))
+	{
+		zbx_free(result->key);
+		pp_cache_release(result->cache);
+	}
+
+	zbx_hashset_destroy(&results->results);
+	pthread_mutex_destroy(&results->lock);
+	zbx_free(results);
+}
 
 /******************************************************************************
  *                                                                            *
@@ -37,27 +120,38 @@
  ******************************************************************************/
 zbx_pp_cache_t	*pp_cache_create(const zbx_pp_item_preproc_t *preproc, const zbx_variant_t *value)
 {
-	zbx_pp_cache_t	*cache = (zbx_pp_cache_t *)zbx_malloc(NULL, sizeof(zbx_pp_cache_t));
+	zbx_pp_cache_t	*cache;
 
-	if (0 != preproc->steps_num)
-	{
-		switch (preproc->steps[0].type)
-		{
-			/* 'prometheus pattern' cache is reused for 'prometheus to json' */
-			case ZBX_PREPROC_PROMETHEUS_TO_JSON:
-				cache->type = ZBX_PREPROC_PROMETHEUS_PATTERN;
-				break;
-			default:
-				cache->type = preproc->steps[0].type;
-		}
-	}
-	else
-		cache->type = ZBX_PREPROC_NONE;
+	cache = pp_cache_create_step_result(0 != preproc->steps_num ? preproc->steps[0].type : ZBX_PREPROC_NONE,
+			value);
+	cache->results = pp_cache_results_create();
+
+	return cache;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: create cache for intermediate preprocessing step result           *
+ *                                                                            *
+ * Parameters: step_type - [IN] type of the step using the result as input    *
+ *             value     - [IN] step result                                   *
+ *                                                                            *
+ * Return value: The created preprocessing cache                              *
+ *                                                                            *
+ * Comments: Step result caches are shared by adding them to master value     *
+ *           cache, they do not have their own shared results.                *
+ *                                                                            *
+ ******************************************************************************/
+zbx_pp_cache_t	*pp_cache_create_step_result(int step_type, const zbx_variant_t *value)
+{
+	zbx_pp_cache_t	*cache = (zbx_pp_cache_t *)zbx_malloc(NULL, sizeof(zbx_pp_cache_t));
 
+	cache->type = pp_cache_get_type(step_type);
 	zbx_variant_copy(&cache->value, value);
 	cache->data = NULL;
 	cache->refcount = 1;
 	cache->error = NULL;
+	cache->results = NULL;
 
 	return cache;
 }
@@ -85,11 +179,18 @@ static void	pp_cache_free(zbx_pp_cache_t *cache)
 			case ZBX_PREPROC_SNMP_WALK_VALUE:
 				zbx_snmp_value_cache_clear((zbx_snmp_value_cache_t *)cache->data);
 				break;
+			case ZBX_PREPROC_XPATH:
+				zbx_xml_doc_free(cache->data);
+				cache->data = NULL;
+				break;
 		}
 
 		zbx_free(cache->data);
 	}
 
+	if (NULL != cache->results)
+		pp_cache_results_free(cache->results);
+
 	zbx_free(cache->error);
 	zbx_free(cache);
 }
@@ -143,6 +244,52 @@ void	pp_cache_prepare_output_value(zbx_pp_cache_t *cache, int step_type, zbx_var
 		zbx_variant_copy(value, &cache->value);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if preprocessing step result can be shared between          *
+ *          dependent items                                                   *
+ *                                                                            *
+ * Parameters: step_type - [IN] preprocessing step type                       *
+ *                                                                            *
+ * Return value: SUCCEED - the step result depends only on input value, step  *
+ *                         parameters and item value type                     *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	pp_cache_is_step_shareable(int step_type)
+{
+	switch (step_type)
+	{
+		case ZBX_PREPROC_MULTIPLIER:
+		case ZBX_PREPROC_RTRIM:
+		case ZBX_PREPROC_LTRIM:
+		case ZBX_PREPROC_TRIM:
+		case ZBX_PREPROC_REGSUB:
+		case ZBX_PREPROC_BOOL2DEC:
+		case ZBX_PREPROC_OCT2DEC:
+		case ZBX_PREPROC_HEX2DEC:
+		case ZBX_PREPROC_XPATH:
+		case ZBX_PREPROC_JSONPATH:
+		case ZBX_PREPROC_VALIDATE_RANGE:
+		case ZBX_PREPROC_VALIDATE_REGEX:
+		case ZBX_PREPROC_VALIDATE_NOT_REGEX:
+		case ZBX_PREPROC_ERROR_FIELD_JSON:
+		case ZBX_PREPROC_ERROR_FIELD_XML:
+		case ZBX_PREPROC_ERROR_FIELD_REGEX:
+		case ZBX_PREPROC_PROMETHEUS_PATTERN:
+		case ZBX_PREPROC_PROMETHEUS_TO_JSON:
+		case ZBX_PREPROC_CSV_TO_JSON:
+		case ZBX_PREPROC_XML_TO_JSON:
+		case ZBX_PREPROC_STR_REPLACE:
+		case ZBX_PREPROC_SNMP_WALK_VALUE:
+		case ZBX_PREPROC_SNMP_WALK_TO_JSON:
+		case ZBX_PREPROC_SNMP_GET_VALUE:
+			return SUCCEED;
+		default:
+			return FAIL;
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: check if caching can be done for the specified preprocessing      *
@@ -164,9 +311,132 @@ int	pp_cache_is_supported(zbx_pp_item_preproc_t *preproc)
 			case ZBX_PREPROC_PROMETHEUS_PATTERN:
 			case ZBX_PREPROC_PROMETHEUS_TO_JSON:
 			case ZBX_PREPROC_SNMP_WALK_VALUE:
+			case ZBX_PREPROC_XPATH:
 				return SUCCEED;
 		}
+
+		/* the first step result can be shared with other dependent items */
+		if (1 < preproc->steps_num)
+			return pp_cache_is_step_shareable(preproc->steps[0].type);
 	}
 
 	return FAIL;
 }
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: append preprocessing step to shared step result key               *
+ *                                                                            *
+ * Parameters: preproc    - [IN] preprocessing data                           *
+ *             index      - [IN] step index                                   *
+ *             key        - [IN/OUT] key of the previous step results         *
+ *             key_alloc  - [IN/OUT]                                          *
+ *             key_offset - [IN/OUT]                                          *
+ *                                                                            *
+ * Return value: SUCCEED - the step was appended to the key                   *
+ *               FAIL    - the step result cannot be shared                   *
+ *                                                                            *
+ * Comments: Only results of steps depending solely on the input value and    *
+ *           step parameters can be shared between dependent items. The key   *
+ *           does not include host because dependent items belong to the      *
+ *           master item host.                                                *
+ *                                                                            *
+ ******************************************************************************/
+int	pp_cache_append_step_key(const zbx_pp_item_preproc_t *preproc, int index, char **key, size_t *key_alloc,
+		size_t *key_offset)
+{
+	const zbx_pp_step_t	*step = preproc->steps + index;
+	const char		*params;
+
+	if (SUCCEED != pp_cache_is_step_shareable(step->type))
+		return FAIL;
+
+	switch (step->type)
+	{
+		case ZBX_PREPROC_MULTIPLIER:
+		case ZBX_PREPROC_VALIDATE_RANGE:
+			/* the result depends on item value type */
+			zbx_snprintf_alloc(key, key_alloc, key_offset, "%d:%d:", step->type, (int)preproc->value_type);
+			break;
+		default:
+			zbx_snprintf_alloc(key, key_alloc, key_offset, "%d::", step->type);
+	}
+
+	/* prefix parameters with their length so keys of different step sequences cannot match */
+	params = ZBX_NULL2EMPTY_STR(step->params);
+	zbx_snprintf_alloc(key, key_alloc, key_offset, ZBX_FS_SIZE_T ":", (zbx_fs_size_t)strlen(params));
+	zbx_strcpy_alloc(key, key_alloc, key_offset, params);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get shared step result                                            *
+ *                                                                            *
+ * Parameters: cache - [IN] master value cache                                *
+ *             key   - [IN] step result key                                   *
+ *                                                                            *
+ * Return value: The step result cache or NULL if the result was not shared.  *
+ *                                                                            *
+ * Comments: The returned cache is owned by master value cache and must not   *
+ *           be released.                                                     *
+ *                                                                            *
+ ******************************************************************************/
+zbx_pp_cache_t	*pp_cache_get_step_result(zbx_pp_cache_t *cache, const char *key)
+{
+	zbx_pp_cache_result_t	*result;
+	zbx_pp_cache_t		*result_cache = NULL;
+
+	if (NULL == cache->results)
+		return NULL;
+
+	pthread_mutex_lock(&cache->results->lock);
+
+	if (NULL != (result = (zbx_pp_cache_result_t *)zbx_hashset_search(&cache->results->results, &key)))
+		result_cache = result->cache;
+
+	pthread_mutex_unlock(&cache->results->lock);
+
+	return result_cache;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: share step result with other dependent items                      *
+ *                                                                            *
+ * Parameters: cache  - [IN] master value cache                               *
+ *             key    - [IN] step result key                                  *
+ *             result - [IN] the step result cache                            *
+ *                                                                            *
+ * Comments: The key and step result are owned by master value cache after    *
+ *           this call. The step result cache must not be modified after it   *
+ *           has been shared, so it must be added only after the next step    *
+ *           has initialized its cached data. If the result was already       *
+ *           shared by another worker the passed key and result are freed.    *
+ *                                                                            *
+ ******************************************************************************/
+void	pp_cache_add_step_result(zbx_pp_cache_t *cache, char *key, zbx_pp_cache_t *result)
+{
+	zbx_pp_cache_result_t	result_local;
+
+	if (NULL != cache->results)
+	{
+		result_local.key = key;
+		result_local.cache = result;
+
+		pthread_mutex_lock(&cache->results->lock);
+
+		if (NULL == zbx_hashset_search(&cache->results->results, &result_local))
+		{
+			zbx_hashset_insert(&cache->results->results, &result_local, sizeof(result_local));
+			key = NULL;
+			result = NULL;
+		}
+
+		pthread_mutex_unlock(&cache->results->lock);
+	}
+
+	zbx_free(key);
+	pp_cache_release(result);
+}
@@ -32,11 +32,24 @@ zbx_pp_cache_jsonpath_t;
 
 typedef struct
 {
-	zbx_uint32_t	refcount;
-	zbx_variant_t	value;
-	int		type;
-	void		*data;
-	char		*error;
+	zbx_uint64_t	hits;
+	zbx_uint64_t	misses;
+}
+zbx_pp_cache_stats_t;
+
+typedef struct zbx_pp_cache_results zbx_pp_cache_results_t;
+
+typedef struct
+{
+	zbx_uint32_t		refcount;
+	zbx_variant_t		value;
+	int			type;
+	void			*data;
+	char			*error;
+
+	/* results of leading preprocessing steps shared between dependent items, */
+	/* NULL for step result caches                                            */
+	zbx_pp_cache_results_t	*results;
 }
 zbx_pp_cache_t;
 
@@ -47,4 +60,10 @@ zbx_pp_cache_t	*pp_cache_copy(zbx_pp_cache_t *cache);
 void	pp_cache_prepare_output_value(zbx_pp_cache_t *cache, int step_type, zbx_variant_t *value);
 int	pp_cache_is_supported(zbx_pp_item_preproc_t *preproc);
 
+int		pp_cache_append_step_key(const zbx_pp_item_preproc_t *preproc, int index, char **key,
+		size_t *key_alloc, size_t *key_offset);
+zbx_pp_cache_t	*pp_cache_create_step_result(int step_type, const zbx_variant_t *value);
+zbx_pp_cache_t	*pp_cache_get_step_result(zbx_pp_cache_t *cache, const char *key);
+void		pp_cache_add_step_result(zbx_pp_cache_t *cache, char *key, zbx_pp_cache_t *result);
+
 #endif
@@ -78,11 +78,12 @@ int	zbx_diag_add_preproc_info(const struct zbx_json_parse *jp, struct zbx_json *
 
 		if (0 != (fields & ZBX_DIAG_PREPROC_SIMPLE))
 		{
-			zbx_uint64_t	preproc_num, pending_num, finished_num, sequences_num;
+			zbx_uint64_t	preproc_num, pending_num, finished_num, sequences_num, cache_hits, cache_misses;
+			zbx_ipc_stats_t	ipc_stats;
 
 			time1 = zbx_time();
 			if (FAIL == (ret = zbx_preprocessor_get_diag_stats(&preproc_num, &pending_num, &finished_num,
-					&sequences_num, error)))
+					&sequences_num, &cache_hits, &cache_misses, &ipc_stats, error)))
 			{
 				goto out;
 			}
@@ -96,7 +97,51 @@ int	zbx_diag_add_preproc_info(const struct zbx_json_parse *jp, struct zbx_json *
 				zbx_json_adduint64(json, "pending tasks", pending_num);
 				zbx_json_adduint64(json, "finished tasks", finished_num);
 				zbx_json_adduint64(json, "task sequences", sequences_num);
+
+				/* results of leading steps shared between dependent items of the same master value */
+				zbx_json_addobject(json, "shared cache");
+				zbx_json_adduint64(json, "hits", cache_hits);
+				zbx_json_adduint64(json, "misses", cache_misses);
+				zbx_json_addfloat(json, "hit ratio", 0 == cache_hits + cache_misses ? 0 :
+						(double)cache_hits / (double)(cache_hits + cache_misses));
+				zbx_json_close(json);
+
+				zbx_diag_add_ipc_stats(json, "ipc", &ipc_stats);
+			}
+		}
+
+		if (0 != (fields & ZBX_DIAG_PREPROC_INFO))
+		{
+			zbx_vector_dbl_t	lock_wait;
+			double			lock_wait_total = 0, lock_wait_max = 0;
+
+			zbx_vector_dbl_create(&lock_wait);
+
+			time1 = zbx_time();
+			if (FAIL == (ret = zbx_preprocessor_get_lock_wait_stats(&lock_wait, error)))
+			{
+				zbx_vector_dbl_destroy(&lock_wait);
+				goto out;
 			}
+
+			time2 = zbx_time();
+			time_total += time2 - time1;
+
+			for (int i = 0; i < lock_wait.values_num; i++)
+			{
+				lock_wait_total += lock_wait.values[i];
+
+				if (lock_wait.values[i] > lock_wait_max)
+					lock_wait_max = lock_wait.values[i];
+			}
+
+			/* time workers spent waiting for task queue locks, in seconds */
+			zbx_json_addobject(json, "lock wait");
+			zbx_json_addfloat(json, "total", lock_wait_total);
+			zbx_json_addfloat(json, "max", lock_wait_max);
+			zbx_json_close(json);
+
+			zbx_vector_dbl_destroy(&lock_wait);
 		}
 
 		if (0 != tops.values_num)
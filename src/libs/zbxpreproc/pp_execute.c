@@ -236,18 +236,21 @@ static int	pp_execute_regsub(zbx_variant_t *value, const char *params)
  *                                                                            *
  * Purpose: execute jsonpath query                                            *
  *                                                                            *
- * Parameters: cache  - [IN] preprocessing cache                              *
- *             value  - [IN/OUT] value to process                             *
- *             params - [IN] step parameters                                  *
- *             errmsg - [OUT]                                                 *
+ * Parameters: cache    - [IN] preprocessing cache                            *
+ *             value    - [IN/OUT] value to process                           *
+ *             params   - [IN] step parameters                                *
+ *             jsonpath - [IN] compiled step parameters (optional)            *
+ *             errmsg   - [OUT]                                               *
  *                                                                            *
  * Result value: SUCCEED - the query was executed successfully.               *
  *               FAIL    - otherwise.                                         *
  *                                                                            *
  ******************************************************************************/
 static int	pp_excute_jsonpath_query(zbx_pp_cache_t *cache, zbx_variant_t *value, const char *params,
-		char **errmsg)
+		const zbx_jsonpath_t *jsonpath, char **errmsg)
 {
+	int	ret;
+
 	char	*data = NULL;
 
 	if (NULL == cache || ZBX_PREPROC_JSONPATH != cache->type)
@@ -263,7 +266,12 @@ static int	pp_excute_jsonpath_query(zbx_pp_cache_t *cache, zbx_variant_t *value,
 			return FAIL;
 		}
 
-		if (FAIL == zbx_jsonobj_query(&obj, params, &data))
+		if (NULL != jsonpath)
+			ret = zbx_jsonobj_query_compiled(&obj, NULL, jsonpath, &data);
+		else
+			ret = zbx_jsonobj_query(&obj, params, &data);
+
+		if (FAIL == ret)
 		{
 			zbx_jsonobj_clear(&obj);
 			*errmsg = zbx_strdup(*errmsg, zbx_json_strerror());
@@ -308,7 +316,12 @@ static int	pp_excute_jsonpath_query(zbx_pp_cache_t *cache, zbx_variant_t *value,
 			cache->data = (void *)index;
 		}
 
-		if (FAIL == zbx_jsonobj_query_ext(&index->obj, index->index, params, &data))
+		if (NULL != jsonpath)
+			ret = zbx_jsonobj_query_compiled(&index->obj, index->index, jsonpath, &data);
+		else
+			ret = zbx_jsonobj_query_ext(&index->obj, index->index, params, &data);
+
+		if (FAIL == ret)
 		{
 			*errmsg = zbx_strdup(*errmsg, zbx_json_strerror());
 			return FAIL;
@@ -331,19 +344,21 @@ static int	pp_excute_jsonpath_query(zbx_pp_cache_t *cache, zbx_variant_t *value,
  *                                                                            *
  * Purpose: execute 'jsonpath' step                                           *
  *                                                                            *
- * Parameters: cache  - [IN] preprocessing cache                              *
- *             value  - [IN/OUT] value to process                             *
- *             params - [IN] step parameters                                  *
+ * Parameters: cache    - [IN] preprocessing cache                            *
+ *             value    - [IN/OUT] value to process                           *
+ *             params   - [IN] step parameters                                *
+ *             jsonpath - [IN] compiled step parameters (optional)            *
  *                                                                            *
  * Result value: SUCCEED - the preprocessing step was executed successfully.  *
  *               FAIL    - otherwise. The error message is stored in value.   *
  *                                                                            *
  ******************************************************************************/
-static int	pp_execute_jsonpath(zbx_pp_cache_t *cache, zbx_variant_t *value, const char *params)
+static int	pp_execute_jsonpath(zbx_pp_cache_t *cache, zbx_variant_t *value, const char *params,
+		const zbx_jsonpath_t *jsonpath)
 {
 	char	*errmsg = NULL;
 
-	if (SUCCEED == pp_excute_jsonpath_query(cache, value, params, &errmsg))
+	if (SUCCEED == pp_excute_jsonpath_query(cache, value, params, jsonpath, &errmsg))
 		return SUCCEED;
 
 	zbx_variant_clear(value);
@@ -409,7 +424,8 @@ static int	pp_execute_2dec(int type, zbx_variant_t *value)
  *                                                                            *
  * Purpose: execute xpath query                                               *
  *                                                                            *
- * Parameters: value  - [IN/OUT] value to process                             *
+ * Parameters: cache  - [IN] preprocessing cache                              *
+ *             value  - [IN/OUT] value to process                             *
  *             params - [IN] step parameters                                  *
  *             error  - [OUT]                                                 *
  *                                                                            *
@@ -417,14 +433,35 @@ static int	pp_execute_2dec(int type, zbx_variant_t *value)
  *               FAIL    - otherwise.                                         *
  *                                                                            *
  ******************************************************************************/
-static int	pp_execute_xpath_query(zbx_variant_t *value, const char *params, char **error)
+static int	pp_execute_xpath_query(zbx_pp_cache_t *cache, zbx_variant_t *value, const char *params, char **error)
 {
 	char	*errmsg = NULL;
+	int	ret = FAIL;
 
-	if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, error))
-		return FAIL;
+	if (NULL == cache || ZBX_PREPROC_XPATH != cache->type)
+	{
+		if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, error))
+			return FAIL;
+
+		ret = zbx_query_xpath(value, params, &errmsg);
+	}
+	else
+	{
+		if (NULL == cache->data && NULL == cache->error)
+		{
+			if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, error))
+				return FAIL;
+
+			(void)zbx_xml_doc_open(value->data.str, &cache->data, &cache->error);
+		}
 
-	if (SUCCEED == zbx_query_xpath(value, params, &errmsg))
+		if (NULL != cache->error)
+			errmsg = zbx_strdup(NULL, cache->error);
+		else
+			ret = zbx_query_xpath_doc(cache->data, value, params, &errmsg);
+	}
+
+	if (SUCCEED == ret)
 		return SUCCEED;
 
 	*error = zbx_dsprintf(NULL, "cannot extract XML value with xpath \"%s\": %s", params, errmsg);
@@ -437,18 +474,19 @@ static int	pp_execute_xpath_query(zbx_variant_t *value, const char *params, char
  *                                                                            *
  * Purpose: execute 'xpath' step                                              *
  *                                                                            *
- * Parameters: value  - [IN/OUT] value to process                             *
+ * Parameters: cache  - [IN] preprocessing cache                              *
+ *             value  - [IN/OUT] value to process                             *
  *             params - [IN] step parameters                                  *
  *                                                                            *
  * Result value: SUCCEED - the preprocessing step was executed successfully.  *
  *               FAIL    - otherwise. The error message is stored in value.   *
  *                                                                            *
  ******************************************************************************/
-static int	pp_execute_xpath(zbx_variant_t *value, const char *params)
+static int	pp_execute_xpath(zbx_pp_cache_t *cache, zbx_variant_t *value, const char *params)
 {
 	char	*errmsg = NULL;
 
-	if (SUCCEED == pp_execute_xpath_query(value, params, &errmsg))
+	if (SUCCEED == pp_execute_xpath_query(cache, value, params, &errmsg))
 		return SUCCEED;
 
 	zbx_variant_clear(value);
@@ -1096,10 +1134,10 @@ int	pp_execute_step(zbx_pp_context_t *ctx, zbx_pp_cache_t *cache, zbx_dc_um_shar
 			ret = pp_execute_delta(step->type, value_type, value, ts, history_value, history_ts);
 			goto out;
 		case ZBX_PREPROC_XPATH:
-			ret = pp_execute_xpath(value, params);
+			ret = pp_execute_xpath(cache, value, params);
 			goto out;
 		case ZBX_PREPROC_JSONPATH:
-			ret = pp_execute_jsonpath(cache, value, params);
+			ret = pp_execute_jsonpath(cache, value, params, step->jsonpath);
 			goto out;
 		case ZBX_PREPROC_VALIDATE_RANGE:
 			ret = pp_validate_range(value_type, value, params);
@@ -1192,8 +1230,11 @@ void	pp_execute(zbx_pp_context_t *ctx, zbx_pp_item_preproc_t *preproc, zbx_pp_ca
 {
 	zbx_pp_result_t		*results;
 	zbx_pp_history_t	*history;
-	int			quote_error, results_num, action;
+	int			quote_error, results_num, action, ret, share;
 	zbx_variant_t		value_raw;
+	zbx_pp_cache_t		*step_cache, *step_result = NULL;
+	char			*key = NULL, *step_result_key = NULL;
+	size_t			key_alloc = 0, key_offset = 0;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s(): value:%s type:%s", __func__,
 			zbx_variant_value_desc(NULL == cache ? value_in : &cache->value),
@@ -1226,6 +1267,10 @@ void	pp_execute(zbx_pp_context_t *ctx, zbx_pp_item_preproc_t *preproc, zbx_pp_ca
 
 	zbx_variant_set_none(&value_raw);
 
+	/* master value cache is used by the first step, the following steps use cached results of previous steps */
+	step_cache = cache;
+	share = (NULL != cache && NULL != cache->results ? SUCCEED : FAIL);
+
 	for (int i = 0; i < preproc->steps_num; i++)
 	{
 		zbx_variant_t	history_value;
@@ -1237,10 +1282,35 @@ void	pp_execute(zbx_pp_context_t *ctx, zbx_pp_item_preproc_t *preproc, zbx_pp_ca
 		action = ZBX_PREPROC_FAIL_DEFAULT;
 		quote_error = 0;
 
+		if (SUCCEED == share && SUCCEED == (share = pp_cache_append_step_key(preproc, i, &key, &key_alloc,
+				&key_offset)))
+		{
+			zbx_pp_cache_t	*shared_result;
+
+			if (NULL != (shared_result = pp_cache_get_step_result(cache, key)))
+			{
+				ctx->cache_stats.hits++;
+
+				/* the previous step result was not used by this step and cannot be shared */
+				pp_cache_release(step_result);
+				step_result = NULL;
+				zbx_free(step_result_key);
+
+				zbx_variant_clear(value_out);
+				zbx_variant_copy(value_out, &shared_result->value);
+				pp_result_set(results + results_num++, value_out, action, &value_raw);
+				step_cache = shared_result;
+
+				continue;
+			}
+
+			ctx->cache_stats.misses++;
+		}
+
 		zbx_pp_history_pop(preproc->history, i, &history_value, &history_ts);
 
-		if (SUCCEED != pp_execute_step(ctx, cache, um_handle, preproc->hostid, preproc->value_type, value_out,
-				ts, preproc->steps + i, &history_value, &history_ts, config_source_ip))
+		if (SUCCEED != (ret = pp_execute_step(ctx, step_cache, um_handle, preproc->hostid, preproc->value_type,
+				value_out, ts, preproc->steps + i, &history_value, &history_ts, config_source_ip)))
 		{
 			zbx_variant_copy(&value_raw, value_out);
 
@@ -1266,12 +1336,37 @@ void	pp_execute(zbx_pp_context_t *ctx, zbx_pp_item_preproc_t *preproc, zbx_pp_ca
 
 		zbx_variant_clear(&history_value);
 
-		cache = NULL;
+		/* share previous step result after its cached data was initialized by this step */
+		if (NULL != step_result)
+		{
+			pp_cache_add_step_result(cache, step_result_key, step_result);
+			step_result = NULL;
+			step_result_key = NULL;
+		}
+
+		step_cache = NULL;
+
+		if (SUCCEED == share)
+		{
+			if (SUCCEED == ret && ZBX_VARIANT_ERR != value_out->type &&
+					ZBX_VARIANT_NONE != value_out->type && i + 1 < preproc->steps_num)
+			{
+				step_result = pp_cache_create_step_result(preproc->steps[i + 1].type, value_out);
+				step_result_key = zbx_strdup(NULL, key);
+				step_cache = step_result;
+			}
+			else
+				share = FAIL;
+		}
 
 		if (ZBX_VARIANT_NONE == value_out->type)
 			break;
 	}
 
+	pp_cache_release(step_result);
+	zbx_free(step_result_key);
+	zbx_free(key);
+
 	if (ZBX_VARIANT_ERR == value_out->type)
 	{
 		/* reset preprocessing history in the case of error */
@@ -29,8 +29,11 @@
 
 typedef struct
 {
-	int		es_initialized;
-	zbx_es_t	es_engine;
+	int			es_initialized;
+	zbx_es_t		es_engine;
+
+	/* shared step result statistics */
+	zbx_pp_cache_stats_t	cache_stats;
 }
 zbx_pp_context_t;
 
@@ -19,6 +19,8 @@
 
 #include "zbxpreprocbase.h"
 
+#include "zbxcommon.h"
+
 ZBX_PTR_VECTOR_IMPL(pp_step_ptr, zbx_pp_step_t *)
 
 /******************************************************************************
@@ -57,10 +59,54 @@ zbx_pp_item_preproc_t	*zbx_pp_item_preproc_create(zbx_uint64_t hostid, unsigned
 	return preproc;
 }
 
-void	zbx_pp_step_free(zbx_pp_step_t *step)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: prepare preprocessing step parameters for repeated execution      *
+ *                                                                            *
+ * Parameters: step - [IN/OUT] preprocessing step                             *
+ *                                                                            *
+ * Comments: JSONPath is compiled only when it has no user macros, because    *
+ *           macros are resolved before each step execution and can change    *
+ *           without changing item configuration. Steps failing to compile    *
+ *           are left to report errors during execution.                      *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_pp_step_compile(zbx_pp_step_t *step)
+{
+	zbx_jsonpath_t	jsonpath;
+
+	step->jsonpath = NULL;
+
+	if (ZBX_PREPROC_JSONPATH != step->type || NULL != strstr(step->params, "{$"))
+		return;
+
+	if (SUCCEED != zbx_jsonpath_compile(step->params, &jsonpath))
+		return;
+
+	step->jsonpath = (zbx_jsonpath_t *)zbx_malloc(NULL, sizeof(zbx_jsonpath_t));
+	*step->jsonpath = jsonpath;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: free resources allocated by preprocessing step                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	pp_step_clear(zbx_pp_step_t *step)
 {
 	zbx_free(step->params);
 	zbx_free(step->error_handler_params);
+
+	if (NULL != step->jsonpath)
+	{
+		zbx_jsonpath_clear(step->jsonpath);
+		zbx_free(step->jsonpath);
+	}
+}
+
+void	zbx_pp_step_free(zbx_pp_step_t *step)
+{
+	pp_step_clear(step);
 	zbx_free(step);
 }
 
@@ -72,10 +118,7 @@ void	zbx_pp_step_free(zbx_pp_step_t *step)
 static void	pp_item_preproc_free(zbx_pp_item_preproc_t *preproc)
 {
 	for (int i = 0; i < preproc->steps_num; i++)
-	{
-		zbx_free(preproc->steps[i].params);
-		zbx_free(preproc->steps[i].error_handler_params);
-	}
+		pp_step_clear(&preproc->steps[i]);
 
 	zbx_free(preproc->steps);
 	zbx_free(preproc->dep_itemids);
@@ -142,7 +142,7 @@ static zbx_pp_manager_t	*zbx_pp_manager_create(int workers_num, zbx_pp_notify_cb
 	manager = (zbx_pp_manager_t *)zbx_malloc(NULL, sizeof(zbx_pp_manager_t));
 	memset(manager, 0, sizeof(zbx_pp_manager_t));
 
-	if (SUCCEED != pp_task_queue_init(&manager->queue, error))
+	if (SUCCEED != pp_task_queue_init(&manager->queue, workers_num, error))
 		goto out;
 
 	manager->timekeeper = zbx_timekeeper_create(workers_num, NULL);
@@ -219,6 +219,7 @@ static void	zbx_pp_manager_free(zbx_pp_manager_t *manager)
 	for (i = 0; i < manager->workers_num; i++)
 		pp_worker_stop(&manager->workers[i]);
 
+	pp_task_queue_stop(&manager->queue);
 	pp_task_queue_notify_all(&manager->queue);
 	pp_task_queue_unlock(&manager->queue);
 
@@ -583,9 +584,7 @@ static void	zbx_pp_manager_process_finished(zbx_pp_manager_t *manager, zbx_vecto
 		zbx_vector_pp_task_ptr_append(tasks, task);
 	}
 
-	*pending_num = manager->queue.pending_num;
-	*finished_num = manager->queue.finished_num;
-	*processing_num = manager->queue.processing_num;
+	pp_task_queue_get_stats(&manager->queue, pending_num, processing_num, finished_num);
 
 	pp_task_queue_unlock(&manager->queue);
 	zbx_prof_end();
@@ -655,12 +654,28 @@ zbx_hashset_t  *zbx_pp_manager_items(zbx_pp_manager_t *manager)
  *                                                                            *
  ******************************************************************************/
 static void	zbx_pp_manager_get_diag_stats(zbx_pp_manager_t *manager, zbx_uint64_t *preproc_num,
-		zbx_uint64_t *pending_num, zbx_uint64_t *finished_num, zbx_uint64_t *sequences_num)
+		zbx_uint64_t *pending_num, zbx_uint64_t *finished_num, zbx_uint64_t *sequences_num,
+		zbx_pp_cache_stats_t *cache_stats)
 {
 	*preproc_num = (zbx_uint64_t)manager->items.num_data;
-	*pending_num = manager->queue.pending_num;
-	*finished_num = manager->queue.finished_num;
+
+	/* workers register new task sequences within task queue lock */
+	pp_task_queue_lock(&manager->queue);
 	*sequences_num = (zbx_uint64_t)manager->queue.sequences.num_data;
+	pp_task_queue_unlock(&manager->queue);
+
+	pp_task_queue_get_stats(&manager->queue, pending_num, NULL, finished_num);
+
+	memset(cache_stats, 0, sizeof(zbx_pp_cache_stats_t));
+
+	/* workers publish their thread local counters under worker task queue lock */
+	for (int i = 0; i < manager->workers_num; i++)
+	{
+		pp_task_queue_lock_shard(&manager->queue, i, NULL);
+		cache_stats->hits += manager->workers[i].cache_stats.hits;
+		cache_stats->misses += manager->workers[i].cache_stats.misses;
+		pp_task_queue_unlock_shard(&manager->queue, i);
+	}
 }
 
 /******************************************************************************
@@ -678,10 +693,44 @@ static void	zbx_pp_manager_get_sequence_stats(zbx_pp_manager_t *manager,
  *                                                                            *
  * Purpose: get worker usage statistics                                       *
  *                                                                            *
+ * Parameters: manager      - [IN] preprocessing manager                      *
+ *             worker_usage - [OUT] worker busy state usage                   *
+ *             lock_wait    - [OUT] total time in seconds workers spent       *
+ *                                  waiting for task queue locks              *
+ *                                                                            *
  ******************************************************************************/
-static void	zbx_pp_manager_get_worker_usage(zbx_pp_manager_t *manager, zbx_vector_dbl_t *worker_usage)
+static void	zbx_pp_manager_get_worker_usage(zbx_pp_manager_t *manager, zbx_vector_dbl_t *worker_usage,
+		zbx_vector_dbl_t *lock_wait)
 {
 	(void)zbx_timekeeper_get_usage(manager->timekeeper, worker_usage);
+
+	zbx_vector_dbl_reserve(lock_wait, (size_t)manager->workers_num);
+
+	for (int i = 0; i < manager->workers_num; i++)
+	{
+		pp_task_queue_lock_shard(&manager->queue, i, NULL);
+		zbx_vector_dbl_append(lock_wait, manager->workers[i].lock_wait);
+		pp_task_queue_unlock_shard(&manager->queue, i);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get compiled regexp cache statistics summed over all workers      *
+ *                                                                            *
+ ******************************************************************************/
+static void	zbx_pp_manager_get_regexp_cache_stats(zbx_pp_manager_t *manager, zbx_regexp_cache_stats_t *stats)
+{
+	memset(stats, 0, sizeof(zbx_regexp_cache_stats_t));
+
+	for (int i = 0; i < manager->workers_num; i++)
+	{
+		pp_task_queue_lock_shard(&manager->queue, i, NULL);
+		stats->hits += manager->workers[i].regexp_cache_stats.hits;
+		stats->misses += manager->workers[i].regexp_cache_stats.misses;
+		stats->evictions += manager->workers[i].regexp_cache_stats.evictions;
+		pp_task_queue_unlock_shard(&manager->queue, i);
+	}
 }
 
 /******************************************************************************
@@ -929,8 +978,9 @@ static void	preprocessor_add_test_request(zbx_pp_manager_t *manager, zbx_ipc_cli
 
 static void	preprocessor_reply_queue_size(zbx_pp_manager_t *manager, zbx_ipc_client_t *client)
 {
-	zbx_uint64_t	pending_num = manager->queue.pending_num;
+	zbx_uint64_t	pending_num;
 
+	pp_task_queue_get_stats(&manager->queue, &pending_num, NULL, NULL);
 	zbx_ipc_client_send(client, ZBX_IPC_PREPROCESSOR_QUEUE, (unsigned char *)&pending_num, sizeof(pending_num));
 }
 
@@ -1011,17 +1061,24 @@ static void	preprocessor_flush_tasks(zbx_pp_manager_t *manager, zbx_vector_pp_ta
  * Purpose: respond to diagnostic information request                         *
  *                                                                            *
  * Parameters: manager - [IN] preprocessing manager                           *
+ *             service - [IN] preprocessing service                           *
  *             client  - [IN] request source                                  *
  *                                                                            *
  ******************************************************************************/
-static void	preprocessor_reply_diag_info(zbx_pp_manager_t *manager, zbx_ipc_client_t *client)
+static void	preprocessor_reply_diag_info(zbx_pp_manager_t *manager, const zbx_ipc_service_t *service,
+		zbx_ipc_client_t *client)
 {
-	zbx_uint64_t	preproc_num, pending_num, finished_num, sequences_num;
-	unsigned char	*data;
-	zbx_uint32_t	data_len;
+	zbx_uint64_t		preproc_num, pending_num, finished_num, sequences_num;
+	zbx_pp_cache_stats_t	cache_stats;
+	zbx_ipc_stats_t		ipc_stats;
+	unsigned char		*data;
+	zbx_uint32_t		data_len;
 
-	zbx_pp_manager_get_diag_stats(manager, &preproc_num, &pending_num, &finished_num, &sequences_num);
-	data_len = zbx_preprocessor_pack_diag_stats(&data, preproc_num, pending_num, finished_num, sequences_num);
+	zbx_pp_manager_get_diag_stats(manager, &preproc_num, &pending_num, &finished_num, &sequences_num,
+			&cache_stats);
+	zbx_ipc_service_get_stats(service, &ipc_stats);
+	data_len = zbx_preprocessor_pack_diag_stats(&data, preproc_num, pending_num, finished_num, sequences_num,
+			cache_stats.hits, cache_stats.misses, &ipc_stats);
 
 	zbx_ipc_client_send(client, ZBX_IPC_PREPROCESSOR_DIAG_STATS_RESULT, data, data_len);
 
@@ -1085,21 +1142,40 @@ static void	preprocessor_reply_top_sequences(zbx_pp_manager_t *manager, zbx_ipc_
  ******************************************************************************/
 static void	preprocessor_reply_usage_stats(zbx_pp_manager_t *manager, int workers_num, zbx_ipc_client_t *client)
 {
-	zbx_vector_dbl_t	usage;
+	zbx_vector_dbl_t	usage, lock_wait;
 	unsigned char		*data;
 	zbx_uint32_t		data_len;
 
 	zbx_vector_dbl_create(&usage);
-	zbx_pp_manager_get_worker_usage(manager, &usage);
+	zbx_vector_dbl_create(&lock_wait);
+	zbx_pp_manager_get_worker_usage(manager, &usage, &lock_wait);
 
-	data_len = zbx_preprocessor_pack_usage_stats(&data, &usage, workers_num);
+	data_len = zbx_preprocessor_pack_usage_stats(&data, &usage, workers_num, &lock_wait);
 
 	zbx_ipc_client_send(client, ZBX_IPC_PREPROCESSOR_DIAG_STATS_RESULT, data, data_len);
 
 	zbx_free(data);
+	zbx_vector_dbl_destroy(&lock_wait);
 	zbx_vector_dbl_destroy(&usage);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: respond to compiled regexp cache statistics request               *
+ *                                                                            *
+ * Parameters: manager - [IN] preprocessing manager                           *
+ *             client  - [IN] request source                                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	preprocessor_reply_regexp_cache_stats(zbx_pp_manager_t *manager, zbx_ipc_client_t *client)
+{
+	zbx_regexp_cache_stats_t	stats;
+
+	zbx_pp_manager_get_regexp_cache_stats(manager, &stats);
+
+	zbx_ipc_client_send(client, ZBX_IPC_PREPROCESSOR_REGEXP_CACHE_STATS, (unsigned char *)&stats, sizeof(stats));
+}
+
 static void	preprocessor_finished_task_cb(void *data)
 {
 	zbx_ipc_service_alert((zbx_ipc_service_t *)data);
@@ -1202,6 +1278,9 @@ ZBX_THREAD_ENTRY(zbx_pp_manager_thread, args)
 		exit(EXIT_FAILURE);
 	}
 
+	/* replies are written together when the messaging loop is processed */
+	zbx_ipc_service_set_send_mode(&service, ZBX_IPC_SEND_BATCH);
+
 	if (NULL == (manager = zbx_pp_manager_create(pp_args->workers_num, preprocessor_finished_task_cb,
 			(void *)&service, pp_manager_args_in->config_source_ip, &error)))
 	{
@@ -1267,7 +1346,7 @@ ZBX_THREAD_ENTRY(zbx_pp_manager_thread, args)
 					preprocessor_add_test_request(manager, client, message);
 					break;
 				case ZBX_IPC_PREPROCESSOR_DIAG_STATS:
-					preprocessor_reply_diag_info(manager, client);
+					preprocessor_reply_diag_info(manager, &service, client);
 					break;
 				case ZBX_IPC_PREPROCESSOR_TOP_SEQUENCES:
 					preprocessor_reply_top_sequences(manager, client, message);
@@ -1275,6 +1354,9 @@ ZBX_THREAD_ENTRY(zbx_pp_manager_thread, args)
 				case ZBX_IPC_PREPROCESSOR_USAGE_STATS:
 					preprocessor_reply_usage_stats(manager, pp_args->workers_num, client);
 					break;
+				case ZBX_IPC_PREPROCESSOR_REGEXP_CACHE_STATS:
+					preprocessor_reply_regexp_cache_stats(manager, client);
+					break;
 				case ZBX_RTC_LOG_LEVEL_INCREASE:
 					preprocessor_change_loglevel(manager, 1, (const char *)message->data);
 					break;
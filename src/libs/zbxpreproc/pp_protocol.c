@@ -393,6 +393,7 @@ static int	preprocessor_unpack_step(const unsigned char *data, zbx_pp_step_t *st
 	offset += zbx_deserialize_str(offset, &step->params, value_len);
 	offset += zbx_deserialize_char(offset, &step->error_handler);
 	offset += zbx_deserialize_str(offset, &step->error_handler_params, value_len);
+	step->jsonpath = NULL;
 
 	return (int)(offset - data);
 }
@@ -482,10 +483,14 @@ zbx_uint32_t	zbx_preprocessor_pack_test_result(unsigned char **data, const zbx_p
  *                               preprocessed                                 *
  *             finished_num  - [IN] number of values being preprocessed       *
  *             sequences_num - [IN] number of registered task sequences       *
+ *             cache_hits    - [IN] number of shared step results reused      *
+ *             cache_misses  - [IN] number of shareable steps executed        *
+ *             ipc_stats     - [IN] preprocessing service IPC statistics      *
  *                                                                            *
  ******************************************************************************/
 zbx_uint32_t	zbx_preprocessor_pack_diag_stats(unsigned char **data, zbx_uint64_t preproc_num,
-		zbx_uint64_t pending_num, zbx_uint64_t finished_num, zbx_uint64_t sequences_num)
+		zbx_uint64_t pending_num, zbx_uint64_t finished_num, zbx_uint64_t sequences_num,
+		zbx_uint64_t cache_hits, zbx_uint64_t cache_misses, const zbx_ipc_stats_t *ipc_stats)
 {
 	unsigned char	*ptr;
 	zbx_uint32_t	data_len = 0;
@@ -494,6 +499,12 @@ zbx_uint32_t	zbx_preprocessor_pack_diag_stats(unsigned char **data, zbx_uint64_t
 	zbx_serialize_prepare_value(data_len, pending_num);
 	zbx_serialize_prepare_value(data_len, finished_num);
 	zbx_serialize_prepare_value(data_len, sequences_num);
+	zbx_serialize_prepare_value(data_len, cache_hits);
+	zbx_serialize_prepare_value(data_len, cache_misses);
+	zbx_serialize_prepare_value(data_len, ipc_stats->rx_messages);
+	zbx_serialize_prepare_value(data_len, ipc_stats->rx_reads);
+	zbx_serialize_prepare_value(data_len, ipc_stats->tx_messages);
+	zbx_serialize_prepare_value(data_len, ipc_stats->tx_writes);
 
 	*data = (unsigned char *)zbx_malloc(NULL, data_len);
 
@@ -501,7 +512,13 @@ zbx_uint32_t	zbx_preprocessor_pack_diag_stats(unsigned char **data, zbx_uint64_t
 	ptr += zbx_serialize_value(ptr, preproc_num);
 	ptr += zbx_serialize_value(ptr, pending_num);
 	ptr += zbx_serialize_value(ptr, finished_num);
-	(void)zbx_serialize_value(ptr, sequences_num);
+	ptr += zbx_serialize_value(ptr, sequences_num);
+	ptr += zbx_serialize_value(ptr, cache_hits);
+	ptr += zbx_serialize_value(ptr, cache_misses);
+	ptr += zbx_serialize_value(ptr, ipc_stats->rx_messages);
+	ptr += zbx_serialize_value(ptr, ipc_stats->rx_reads);
+	ptr += zbx_serialize_value(ptr, ipc_stats->tx_messages);
+	(void)zbx_serialize_value(ptr, ipc_stats->tx_writes);
 
 	return data_len;
 }
@@ -511,26 +528,34 @@ zbx_uint32_t	zbx_preprocessor_pack_diag_stats(unsigned char **data, zbx_uint64_t
  * Purpose: pack diagnostic statistics data into a single buffer that can be  *
  *          used in IPC                                                       *
  *                                                                            *
- * Parameters: data  - [OUT] memory buffer for packed data                    *
- *             usage - [IN] worker usage statistics                           *
- *             count - [IN]                                                   *
+ * Parameters: data      - [OUT] memory buffer for packed data                *
+ *             usage     - [IN] worker usage statistics                       *
+ *             count     - [IN]                                               *
+ *             lock_wait - [IN] worker task queue lock wait time              *
  *                                                                            *
  ******************************************************************************/
-zbx_uint32_t	zbx_preprocessor_pack_usage_stats(unsigned char **data, const zbx_vector_dbl_t *usage, int count)
+zbx_uint32_t	zbx_preprocessor_pack_usage_stats(unsigned char **data, const zbx_vector_dbl_t *usage, int count,
+		const zbx_vector_dbl_t *lock_wait)
 {
 	unsigned char	*ptr;
 	zbx_uint32_t	data_len;
+	int		i;
 
-	data_len = (zbx_uint32_t)((unsigned int)usage->values_num * sizeof(double) + sizeof(int) + sizeof(int));
+	data_len = (zbx_uint32_t)((unsigned int)usage->values_num * sizeof(double) + sizeof(int) + sizeof(int) +
+			sizeof(int) + (unsigned int)lock_wait->values_num * sizeof(double));
 
 	ptr = *data = (unsigned char *)zbx_malloc(NULL, data_len);
 
 	ptr += zbx_serialize_value(ptr, usage->values_num);
 
-	for (int i = 0; i < usage->values_num; i++)
+	for (i = 0; i < usage->values_num; i++)
 		ptr += zbx_serialize_value(ptr, usage->values[i]);
 
-	(void)zbx_serialize_value(ptr, count);
+	ptr += zbx_serialize_value(ptr, count);
+	ptr += zbx_serialize_value(ptr, lock_wait->values_num);
+
+	for (i = 0; i < lock_wait->values_num; i++)
+		ptr += zbx_serialize_value(ptr, lock_wait->values[i]);
 
 	return data_len;
 }
@@ -704,46 +729,76 @@ void	zbx_preprocessor_unpack_test_result(zbx_vector_pp_result_ptr_t *results, zb
  *                               preprocessed                                 *
  *             finished_num  - [OUT] number of values being preprocessed      *
  *             sequences_num - [OUT] number of registered task sequences      *
+ *             cache_hits    - [OUT] number of shared step results reused     *
+ *             cache_misses  - [OUT] number of shareable steps executed       *
+ *             ipc_stats     - [OUT] preprocessing service IPC statistics     *
  *             data          - [OUT] data buffer                              *
  *                                                                            *
  ******************************************************************************/
 void	zbx_preprocessor_unpack_diag_stats(zbx_uint64_t *preproc_num, zbx_uint64_t *pending_num,
-		zbx_uint64_t *finished_num, zbx_uint64_t *sequences_num, const unsigned char *data)
+		zbx_uint64_t *finished_num, zbx_uint64_t *sequences_num, zbx_uint64_t *cache_hits,
+		zbx_uint64_t *cache_misses, zbx_ipc_stats_t *ipc_stats, const unsigned char *data)
 {
 	const unsigned char	*offset = data;
 
 	offset += zbx_deserialize_value(offset, preproc_num);
 	offset += zbx_deserialize_value(offset, pending_num);
 	offset += zbx_deserialize_value(offset, finished_num);
-	(void)zbx_deserialize_value(offset, sequences_num);
+	offset += zbx_deserialize_value(offset, sequences_num);
+	offset += zbx_deserialize_value(offset, cache_hits);
+	offset += zbx_deserialize_value(offset, cache_misses);
+	offset += zbx_deserialize_value(offset, &ipc_stats->rx_messages);
+	offset += zbx_deserialize_value(offset, &ipc_stats->rx_reads);
+	offset += zbx_deserialize_value(offset, &ipc_stats->tx_messages);
+	(void)zbx_deserialize_value(offset, &ipc_stats->tx_writes);
 }
 
 /******************************************************************************
  *                                                                            *
  * Purpose: unpack worker usage statistics                                    *
  *                                                                            *
- * Parameters: usage - [OUT] worker usage statistics                          *
- *             count - [OUT]                                                  *
- *             data  - [IN] input data                                        *
+ * Parameters: usage     - [OUT] worker usage statistics (optional)           *
+ *             count     - [OUT] (optional)                                   *
+ *             lock_wait - [OUT] worker task queue lock wait time (optional)  *
+ *             data      - [IN] input data                                    *
  *                                                                            *
  ******************************************************************************/
-static void	preprocessor_unpack_usage_stats(zbx_vector_dbl_t *usage, int *count, const unsigned char *data)
+static void	preprocessor_unpack_usage_stats(zbx_vector_dbl_t *usage, int *count, zbx_vector_dbl_t *lock_wait,
+		const unsigned char *data)
 {
 	const unsigned char	*offset = data;
-	int			usage_num;
+	int			usage_num, lock_wait_num, count_local, i;
+	double			value;
 
 	offset += zbx_deserialize_value(offset, &usage_num);
-	zbx_vector_dbl_reserve(usage, (size_t)usage_num);
 
-	for (int i = 0; i < usage_num; i++)
+	if (NULL != usage)
+		zbx_vector_dbl_reserve(usage, (size_t)usage_num);
+
+	for (i = 0; i < usage_num; i++)
 	{
-		double	busy;
+		offset += zbx_deserialize_value(offset, &value);
 
-		offset += zbx_deserialize_value(offset, &busy);
-		zbx_vector_dbl_append(usage, busy);
+		if (NULL != usage)
+			zbx_vector_dbl_append(usage, value);
 	}
 
-	(void)zbx_deserialize_value(offset, count);
+	offset += zbx_deserialize_value(offset, &count_local);
+
+	if (NULL != count)
+		*count = count_local;
+
+	if (NULL == lock_wait)
+		return;
+
+	offset += zbx_deserialize_value(offset, &lock_wait_num);
+	zbx_vector_dbl_reserve(lock_wait, (size_t)lock_wait_num);
+
+	for (i = 0; i < lock_wait_num; i++)
+	{
+		offset += zbx_deserialize_value(offset, &value);
+		zbx_vector_dbl_append(lock_wait, value);
+	}
 }
 
 /******************************************************************************
@@ -1061,7 +1116,8 @@ out:
  *                                                                            *
  ******************************************************************************/
 int	zbx_preprocessor_get_diag_stats(zbx_uint64_t *preproc_num, zbx_uint64_t *pending_num,
-		zbx_uint64_t *finished_num, zbx_uint64_t *sequences_num, char **error)
+		zbx_uint64_t *finished_num, zbx_uint64_t *sequences_num, zbx_uint64_t *cache_hits,
+		zbx_uint64_t *cache_misses, zbx_ipc_stats_t *ipc_stats, char **error)
 {
 	unsigned char	*result;
 
@@ -1071,7 +1127,8 @@ int	zbx_preprocessor_get_diag_stats(zbx_uint64_t *preproc_num, zbx_uint64_t *pen
 		return FAIL;
 	}
 
-	zbx_preprocessor_unpack_diag_stats(preproc_num, pending_num, finished_num, sequences_num, result);
+	zbx_preprocessor_unpack_diag_stats(preproc_num, pending_num, finished_num, sequences_num, cache_hits,
+			cache_misses, ipc_stats, result);
 	zbx_free(result);
 
 	return SUCCEED;
@@ -1130,7 +1187,52 @@ int	zbx_preprocessor_get_usage_stats(zbx_vector_dbl_t *usage, int *count, char *
 		return FAIL;
 	}
 
-	preprocessor_unpack_usage_stats(usage, count, result);
+	preprocessor_unpack_usage_stats(usage, count, NULL, result);
+	zbx_free(result);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get time preprocessing workers spent waiting for task queue locks *
+ *                                                                            *
+ * Parameters: lock_wait - [OUT] total lock wait time in seconds per worker   *
+ *             error     - [OUT]                                              *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_preprocessor_get_lock_wait_stats(zbx_vector_dbl_t *lock_wait, char **error)
+{
+	unsigned char	*result;
+
+	if (SUCCEED != zbx_ipc_async_exchange(ZBX_IPC_SERVICE_PREPROCESSING, ZBX_IPC_PREPROCESSOR_USAGE_STATS,
+			SEC_PER_MIN, NULL, 0, &result, error))
+	{
+		return FAIL;
+	}
+
+	preprocessor_unpack_usage_stats(NULL, NULL, lock_wait, result);
+	zbx_free(result);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get compiled regexp cache statistics of preprocessing workers     *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_preprocessor_get_regexp_cache_stats(zbx_regexp_cache_stats_t *stats, char **error)
+{
+	unsigned char	*result;
+
+	if (SUCCEED != zbx_ipc_async_exchange(ZBX_IPC_SERVICE_PREPROCESSING, ZBX_IPC_PREPROCESSOR_REGEXP_CACHE_STATS,
+			SEC_PER_MIN, NULL, 0, &result, error))
+	{
+		return FAIL;
+	}
+
+	memcpy(stats, result, sizeof(zbx_regexp_cache_stats_t));
 	zbx_free(result);
 
 	return SUCCEED;
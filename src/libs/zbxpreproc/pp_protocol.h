@@ -37,6 +37,7 @@
 #define ZBX_IPC_PREPROCESSOR_TOP_SEQUENCES		10007
 #define ZBX_IPC_PREPROCESSOR_TOP_SEQUENCES_RESULT	10008
 #define ZBX_IPC_PREPROCESSOR_USAGE_STATS		10009
+#define ZBX_IPC_PREPROCESSOR_REGEXP_CACHE_STATS		10010
 
 /* item value data used in preprocessing manager */
 typedef struct
@@ -75,10 +76,12 @@ void	zbx_preprocessor_unpack_test_result(zbx_vector_pp_result_ptr_t *results, zb
 		const unsigned char *data);
 
 zbx_uint32_t	zbx_preprocessor_pack_diag_stats(unsigned char **data, zbx_uint64_t preproc_num,
-		zbx_uint64_t pending_num, zbx_uint64_t finished_num, zbx_uint64_t sequences_num);
+		zbx_uint64_t pending_num, zbx_uint64_t finished_num, zbx_uint64_t sequences_num,
+		zbx_uint64_t cache_hits, zbx_uint64_t cache_misses, const zbx_ipc_stats_t *ipc_stats);
 
 void	zbx_preprocessor_unpack_diag_stats(zbx_uint64_t *preproc_num, zbx_uint64_t *pending_num,
-		zbx_uint64_t *finished_num, zbx_uint64_t *sequences_num, const unsigned char *data);
+		zbx_uint64_t *finished_num, zbx_uint64_t *sequences_num, zbx_uint64_t *cache_hits,
+		zbx_uint64_t *cache_misses, zbx_ipc_stats_t *ipc_stats, const unsigned char *data);
 
 zbx_uint32_t	zbx_preprocessor_pack_top_sequences_request(unsigned char **data, int limit);
 
@@ -90,6 +93,7 @@ zbx_uint32_t	zbx_preprocessor_pack_top_sequences_result(unsigned char **data,
 void	zbx_preprocessor_unpack_top_sequences_result(zbx_vector_pp_sequence_stats_ptr_t *sequences,
 		const unsigned char *data);
 
-zbx_uint32_t	zbx_preprocessor_pack_usage_stats(unsigned char **data, const zbx_vector_dbl_t *usage, int count);
+zbx_uint32_t	zbx_preprocessor_pack_usage_stats(unsigned char **data, const zbx_vector_dbl_t *usage, int count,
+		const zbx_vector_dbl_t *lock_wait);
 
 #endif
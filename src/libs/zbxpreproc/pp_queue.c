@@ -21,10 +21,10 @@
 #include "pp_task.h"
 #include "zbxcommon.h"
 #include "zbxalgo.h"
+#include "zbxtime.h"
 
 #define PP_TASK_QUEUE_INIT_NONE		0x00
 #define PP_TASK_QUEUE_INIT_LOCK		0x01
-#define PP_TASK_QUEUE_INIT_EVENT	0x02
 
 ZBX_PTR_VECTOR_IMPL(pp_sequence_stats_ptr, zbx_pp_sequence_stats_t *)
 
@@ -38,26 +38,104 @@ zbx_pp_item_task_sequence_t;
 
 /******************************************************************************
  *                                                                            *
- * Purpose: initialize task queue                                             *
+ * Purpose: clear task list                                                   *
  *                                                                            *
- * Parameters: queue - [IN] task queue                                        *
+ ******************************************************************************/
+static void	pp_task_queue_clear_tasks(zbx_list_t *tasks)
+{
+	zbx_pp_task_t	*task = NULL;
+
+	while (SUCCEED == zbx_list_pop(tasks, (void **)&task))
+		pp_task_free(task);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initialize worker task queue                                      *
+ *                                                                            *
+ * Parameters: shard - [IN] worker task queue                                 *
  *             error - [OUT]                                                  *
  *                                                                            *
+ * Return value: SUCCEED - the worker task queue was initialized successfully *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	pp_task_queue_shard_init(zbx_pp_queue_shard_t *shard, char **error)
+{
+	int	err;
+
+	if (0 != (err = pthread_mutex_init(&shard->lock, NULL)))
+	{
+		*error = zbx_dsprintf(NULL, "cannot initialize task queue mutex: %s", zbx_strerror(err));
+		return FAIL;
+	}
+
+	if (0 != (err = pthread_cond_init(&shard->event, NULL)))
+	{
+		pthread_mutex_destroy(&shard->lock);
+		*error = zbx_dsprintf(NULL, "cannot initialize task queue conditional variable: %s", zbx_strerror(err));
+		return FAIL;
+	}
+
+	shard->pending_num = 0;
+	shard->finished_num = 0;
+	shard->processing_num = 0;
+	shard->stop = 0;
+	shard->idle = 0;
+	shard->pushed_num = 0;
+	shard->pushed_seq = 0;
+
+	zbx_list_create(&shard->immediate);
+	zbx_list_create(&shard->pending);
+	zbx_list_create(&shard->pending_seq);
+	zbx_list_create(&shard->finished);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: destroy worker task queue                                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	pp_task_queue_shard_destroy(zbx_pp_queue_shard_t *shard)
+{
+	pthread_mutex_destroy(&shard->lock);
+	pthread_cond_destroy(&shard->event);
+
+	pp_task_queue_clear_tasks(&shard->immediate);
+	zbx_list_destroy(&shard->immediate);
+
+	pp_task_queue_clear_tasks(&shard->pending);
+	zbx_list_destroy(&shard->pending);
+
+	pp_task_queue_clear_tasks(&shard->pending_seq);
+	zbx_list_destroy(&shard->pending_seq);
+
+	pp_task_queue_clear_tasks(&shard->finished);
+	zbx_list_destroy(&shard->finished);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initialize task queue                                             *
+ *                                                                            *
+ * Parameters: queue      - [IN] task queue                                   *
+ *             shards_num - [IN] number of worker task queues                 *
+ *             error      - [OUT]                                             *
+ *                                                                            *
  * Return value: SUCCEED - the task queue was initialized successfully        *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	pp_task_queue_init(zbx_pp_queue_t *queue, char **error)
+int	pp_task_queue_init(zbx_pp_queue_t *queue, int shards_num, char **error)
 {
 	int	err, ret = FAIL;
 
 	queue->workers_num = 0;
-	queue->pending_num = 0;
-	queue->finished_num = 0;
-	queue->processing_num = 0;
-	zbx_list_create(&queue->pending);
-	zbx_list_create(&queue->immediate);
-	zbx_list_create(&queue->finished);
+	queue->finished_index = 0;
+	queue->shards_num = 0;
+	queue->shards = (zbx_pp_queue_shard_t *)zbx_calloc(NULL, (size_t)shards_num, sizeof(zbx_pp_queue_shard_t));
 
 	zbx_hashset_create(&queue->sequences, 100, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
@@ -68,12 +146,11 @@ int	pp_task_queue_init(zbx_pp_queue_t *queue, char **error)
 	}
 	queue->init_flags |= PP_TASK_QUEUE_INIT_LOCK;
 
-	if (0 != (err = pthread_cond_init(&queue->event, NULL)))
+	for (; queue->shards_num < shards_num; queue->shards_num++)
 	{
-		*error = zbx_dsprintf(NULL, "cannot initialize task queue conditional variable: %s", zbx_strerror(err));
-		goto out;
+		if (SUCCEED != pp_task_queue_shard_init(&queue->shards[queue->shards_num], error))
+			goto out;
 	}
-	queue->init_flags |= PP_TASK_QUEUE_INIT_EVENT;
 
 	ret = SUCCEED;
 out:
@@ -85,42 +162,50 @@ out:
 
 /******************************************************************************
  *                                                                            *
- * Purpose: clear task list                                                   *
+ * Purpose: destroy task queue                                                *
  *                                                                            *
  ******************************************************************************/
-static void	pp_task_queue_clear_tasks(zbx_list_t *tasks)
+void	pp_task_queue_destroy(zbx_pp_queue_t *queue)
 {
-	zbx_pp_task_t	*task = NULL;
+	if (0 != (queue->init_flags & PP_TASK_QUEUE_INIT_LOCK))
+		pthread_mutex_destroy(&queue->lock);
 
-	while (SUCCEED == zbx_list_pop(tasks, (void **)&task))
-		pp_task_free(task);
+	for (int i = 0; i < queue->shards_num; i++)
+		pp_task_queue_shard_destroy(&queue->shards[i]);
+
+	zbx_free(queue->shards);
+	queue->shards_num = 0;
+
+	zbx_hashset_destroy(&queue->sequences);
+
+	queue->init_flags = PP_TASK_QUEUE_INIT_NONE;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: destroy task queue                                                *
+ * Purpose: lock mutex, measuring the time spent waiting for it               *
+ *                                                                            *
+ * Parameters: lock      - [IN] mutex to lock                                 *
+ *             lock_wait - [IN/OUT] total lock wait time in seconds           *
+ *                                  (optional)                                *
  *                                                                            *
  ******************************************************************************/
-void	pp_task_queue_destroy(zbx_pp_queue_t *queue)
+static void	pp_task_queue_mutex_lock(pthread_mutex_t *lock, double *lock_wait)
 {
-	if (0 != (queue->init_flags & PP_TASK_QUEUE_INIT_LOCK))
-		pthread_mutex_destroy(&queue->lock);
+	double	time_start;
 
-	if (0 != (queue->init_flags & PP_TASK_QUEUE_INIT_EVENT))
-		pthread_cond_destroy(&queue->event);
-
-	pp_task_queue_clear_tasks(&queue->pending);
-	zbx_list_destroy(&queue->pending);
-
-	pp_task_queue_clear_tasks(&queue->immediate);
-	zbx_list_destroy(&queue->immediate);
-
-	pp_task_queue_clear_tasks(&queue->finished);
-	zbx_list_destroy(&queue->finished);
+	/* uncontended locks are not timed to keep the fast path cheap */
+	if (NULL == lock_wait || 0 == pthread_mutex_trylock(lock))
+	{
+		if (NULL == lock_wait)
+			pthread_mutex_lock(lock);
 
-	zbx_hashset_destroy(&queue->sequences);
+		return;
+	}
 
-	queue->init_flags = PP_TASK_QUEUE_INIT_NONE;
+	time_start = zbx_time();
+	pthread_mutex_lock(lock);
+	*lock_wait += zbx_time() - time_start;
 }
 
 /******************************************************************************
@@ -133,6 +218,19 @@ void	pp_task_queue_lock(zbx_pp_queue_t *queue)
 	pthread_mutex_lock(&queue->lock);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: lock task queue, measuring the time spent waiting for the lock    *
+ *                                                                            *
+ * Parameters: queue     - [IN] task queue                                    *
+ *             lock_wait - [IN/OUT] total lock wait time in seconds           *
+ *                                                                            *
+ ******************************************************************************/
+void	pp_task_queue_lock_timed(zbx_pp_queue_t *queue, double *lock_wait)
+{
+	pp_task_queue_mutex_lock(&queue->lock, lock_wait);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: unlock task queue                                                 *
@@ -143,6 +241,34 @@ void	pp_task_queue_unlock(zbx_pp_queue_t *queue)
 	pthread_mutex_unlock(&queue->lock);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: lock worker task queue                                            *
+ *                                                                            *
+ * Parameters: queue     - [IN] task queue                                    *
+ *             index     - [IN] worker task queue index                       *
+ *             lock_wait - [IN/OUT] total lock wait time in seconds           *
+ *                                  (optional)                                *
+ *                                                                            *
+ * Comments: Worker task queue can be locked while holding task queue lock,   *
+ *           but not the other way around.                                    *
+ *                                                                            *
+ ******************************************************************************/
+void	pp_task_queue_lock_shard(zbx_pp_queue_t *queue, int index, double *lock_wait)
+{
+	pp_task_queue_mutex_lock(&queue->shards[index].lock, lock_wait);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: unlock worker task queue                                          *
+ *                                                                            *
+ ******************************************************************************/
+void	pp_task_queue_unlock_shard(zbx_pp_queue_t *queue, int index)
+{
+	pthread_mutex_unlock(&queue->shards[index].lock);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: register a new worker                                             *
@@ -163,6 +289,20 @@ void	pp_task_queue_deregister_worker(zbx_pp_queue_t *queue)
 	queue->workers_num--;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get worker task queue of the specified item                       *
+ *                                                                            *
+ * Comments: All tasks of an item are placed into the same worker task queue, *
+ *           so the item value tasks are moved to the item task sequence in   *
+ *           the same order as they were queued.                              *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_pp_queue_shard_t	*pp_task_queue_get_shard(zbx_pp_queue_t *queue, zbx_uint64_t itemid)
+{
+	return &queue->shards[ZBX_DEFAULT_UINT64_HASH_FUNC(&itemid) % (zbx_hash_t)queue->shards_num];
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: add task to an existing sequence or create/append to a new one    *
@@ -173,6 +313,8 @@ void	pp_task_queue_deregister_worker(zbx_pp_queue_t *queue)
  * Return value: The created sequence task or NULL if task was added to an    *
  *               existing sequence.                                           *
  *                                                                            *
+ * Comments: This function must be called within task queue lock.             *
+ *                                                                            *
  ******************************************************************************/
 static zbx_pp_task_t	*pp_task_queue_add_sequence(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
 {
@@ -209,24 +351,31 @@ static zbx_pp_task_t	*pp_task_queue_add_sequence(zbx_pp_queue_t *queue, zbx_pp_t
  ******************************************************************************/
 void	pp_task_queue_push_immediate(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
 {
+	zbx_pp_queue_shard_t	*shard = pp_task_queue_get_shard(queue, task->itemid);
+
+	pthread_mutex_lock(&shard->lock);
+
 	switch (task->type)
 	{
 		case ZBX_PP_TASK_VALUE_SEQ:
 		case ZBX_PP_TASK_DEPENDENT:
-			queue->pending_num++;
+			shard->pending_num++;
 			if (NULL == (task = pp_task_queue_add_sequence(queue, task)))
-				return;
+				goto out;
 			break;
 		case ZBX_PP_TASK_SEQUENCE:
 			/* sequence task is just a container for other tasks - it does not affect statistics, */
-			/* so there is no need to increment queue->pending_num                                */
+			/* so there is no need to increment shard->pending_num                                */
 			break;
 		default:
-			queue->pending_num++;
+			shard->pending_num++;
 			break;
 	}
 
-	(void)zbx_list_append(&queue->immediate, task, NULL);
+	(void)zbx_list_append(&shard->immediate, task, NULL);
+	shard->pushed_num++;
+out:
+	pthread_mutex_unlock(&shard->lock);
 }
 
 /******************************************************************************
@@ -252,8 +401,13 @@ void	pp_task_queue_remove_sequence(zbx_pp_queue_t *queue, zbx_uint64_t itemid)
  ******************************************************************************/
 void	pp_task_queue_push_test(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
 {
-	queue->pending_num++;
-	(void)zbx_list_append(&queue->immediate, task, NULL);
+	zbx_pp_queue_shard_t	*shard = pp_task_queue_get_shard(queue, task->itemid);
+
+	pthread_mutex_lock(&shard->lock);
+	shard->pending_num++;
+	(void)zbx_list_append(&shard->immediate, task, NULL);
+	shard->pushed_num++;
+	pthread_mutex_unlock(&shard->lock);
 }
 
 /******************************************************************************
@@ -270,73 +424,153 @@ void	pp_task_queue_push_test(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
 void	pp_task_queue_push(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
 {
 	zbx_pp_task_value_t	*d = (zbx_pp_task_value_t *)PP_TASK_DATA(task);
-	queue->pending_num++;
+	zbx_pp_queue_shard_t	*shard = pp_task_queue_get_shard(queue, task->itemid);
+	zbx_pp_task_t		*seq_task;
+
+	pthread_mutex_lock(&shard->lock);
+	shard->pending_num++;
 
 	if (ITEM_TYPE_INTERNAL != d->preproc->type)
 	{
-		(void)zbx_list_append(&queue->pending, task, NULL);
-		return;
+		if (ZBX_PP_TASK_VALUE_SEQ == task->type)
+		{
+			(void)zbx_list_append(&shard->pending_seq, task, NULL);
+			shard->pushed_seq = 1;
+		}
+		else
+		{
+			(void)zbx_list_append(&shard->pending, task, NULL);
+			shard->pushed_num++;
+		}
 	}
-
-	if (ZBX_PP_TASK_VALUE == task->type)
+	else if (ZBX_PP_TASK_VALUE == task->type)
 	{
-		(void)zbx_list_append(&queue->immediate, task, NULL);
-		return;
+		(void)zbx_list_append(&shard->immediate, task, NULL);
+		shard->pushed_num++;
+	}
+	else if (NULL != (seq_task = pp_task_queue_add_sequence(queue, task)))
+	{
+		(void)zbx_list_append(&shard->immediate, seq_task, NULL);
+		shard->pushed_num++;
 	}
 
-	zbx_pp_task_t	*seq_task;
+	pthread_mutex_unlock(&shard->lock);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: steal task from other worker task queues                          *
+ *                                                                            *
+ * Parameters: queue     - [IN] task queue                                    *
+ *             index     - [IN] worker task queue index                       *
+ *             lock_wait - [IN/OUT] total lock wait time in seconds           *
+ *                                                                            *
+ * Return value: The stolen task or NULL if there are no tasks that can be    *
+ *               processed by other workers.                                  *
+ *                                                                            *
+ * Comments: Value tasks of sequentially processed items are never stolen, so *
+ *           they are moved to the item task sequence by the owner worker in  *
+ *           the order they were queued.                                      *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_pp_task_t	*pp_task_queue_steal(zbx_pp_queue_t *queue, int index, double *lock_wait)
+{
+	zbx_pp_queue_shard_t	*shard;
+	zbx_pp_task_t		*task;
+
+	for (int i = 1; i < queue->shards_num; i++)
+	{
+		shard = &queue->shards[(index + i) % queue->shards_num];
+
+		pp_task_queue_mutex_lock(&shard->lock, lock_wait);
+
+		if (SUCCEED == zbx_list_pop(&shard->immediate, (void **)&task) ||
+				SUCCEED == zbx_list_pop(&shard->pending, (void **)&task))
+		{
+			shard->pending_num--;
+			pthread_mutex_unlock(&shard->lock);
+
+			shard = &queue->shards[index];
+
+			pp_task_queue_mutex_lock(&shard->lock, lock_wait);
+			shard->processing_num++;
+			pthread_mutex_unlock(&shard->lock);
 
-	if (NULL != (seq_task = pp_task_queue_add_sequence(queue, task)))
-		(void)zbx_list_append(&queue->immediate, seq_task, NULL);
+			return task;
+		}
+
+		pthread_mutex_unlock(&shard->lock);
+	}
+
+	return NULL;
 }
 
 /******************************************************************************
  *                                                                            *
  * Purpose: pop task from task queue                                          *
  *                                                                            *
- * Parameters: queue - [IN] task queue                                        *
+ * Parameters: queue     - [IN] task queue                                    *
+ *             index     - [IN] worker task queue index                       *
+ *             lock_wait - [IN/OUT] total lock wait time in seconds           *
  *                                                                            *
  * Return value: The popped task or NULL if there are no tasks to be          *
  *               processed.                                                   *
  *                                                                            *
- * Comments: This function is used by workers to pop tasks for processing.    *
+ * Comments: This function is used by workers to pop tasks for processing and *
+ *           must be called outside task queue lock. Tasks are taken from the *
+ *           worker's own task queue first and stolen from other worker task  *
+ *           queues when it is empty.                                         *
  *           Sequence tasks will be moved to existing tasks sequences or      *
  *           returned if there are no registered sequences for this item.     *
  *                                                                            *
  ******************************************************************************/
-zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue)
+zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue, int index, double *lock_wait)
 {
-	zbx_pp_task_t	*task = NULL;
+	zbx_pp_queue_shard_t	*shard = &queue->shards[index];
+	zbx_pp_task_t		*task = NULL;
 
-	if (SUCCEED == zbx_list_pop(&queue->immediate, (void **)&task))
-	{
-		/* while sequence tasks do not affect statistics, the first task in sequence */
-		/* does, so the statistics can be updated for all tasks                      */
-		queue->pending_num--;
-		queue->processing_num++;
+	pp_task_queue_mutex_lock(&shard->lock, lock_wait);
 
-		return (zbx_pp_task_t *)task;
+	if (0 != shard->stop)
+	{
+		pthread_mutex_unlock(&shard->lock);
+		return NULL;
 	}
 
-	while (SUCCEED == zbx_list_pop(&queue->pending, (void **)&task))
+	if (SUCCEED == zbx_list_pop(&shard->immediate, (void **)&task))
+		goto out;
+
+	while (SUCCEED == zbx_list_pop(&shard->pending_seq, (void **)&task))
 	{
-		if (ZBX_PP_TASK_VALUE_SEQ == task->type)
-		{
-			/* task is being moved from pending to immediate queue */
-			/* while still pending, so statistics are not affected */
-			task = pp_task_queue_add_sequence(queue, task);
-		}
+		pthread_mutex_unlock(&shard->lock);
 
-		if (NULL != task)
-		{
-			queue->pending_num--;
-			queue->processing_num++;
+		/* task is being moved from pending to immediate queue */
+		/* while still pending, so statistics are not affected */
+		pp_task_queue_mutex_lock(&queue->lock, lock_wait);
+		task = pp_task_queue_add_sequence(queue, task);
+		pthread_mutex_unlock(&queue->lock);
 
-			return task;
-		}
+		pp_task_queue_mutex_lock(&shard->lock, lock_wait);
+
+		if (NULL != task)
+			goto out;
 	}
 
-	return NULL;
+	if (SUCCEED == zbx_list_pop(&shard->pending, (void **)&task))
+		goto out;
+
+	pthread_mutex_unlock(&shard->lock);
+
+	return pp_task_queue_steal(queue, index, lock_wait);
+out:
+	/* while sequence tasks do not affect statistics, the first task in sequence */
+	/* does, so the statistics can be updated for all tasks                      */
+	shard->pending_num--;
+	shard->processing_num++;
+
+	pthread_mutex_unlock(&shard->lock);
+
+	return task;
 }
 
 /******************************************************************************
@@ -344,14 +578,19 @@ zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue)
  * Purpose: push finished task into queue                                     *
  *                                                                            *
  * Parameters: queue - [IN] task queue                                        *
+ *             index - [IN] worker task queue index                           *
  *             task  - [IN] task                                              *
  *                                                                            *
+ * Comments: This function must be called within worker task queue lock.      *
+ *                                                                            *
  ******************************************************************************/
-void	pp_task_queue_push_finished(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
+void	pp_task_queue_push_finished(zbx_pp_queue_t *queue, int index, zbx_pp_task_t *task)
 {
-	queue->finished_num++;
-	queue->processing_num--;
-	(void)zbx_list_append(&queue->finished, task, NULL);
+	zbx_pp_queue_shard_t	*shard = &queue->shards[index];
+
+	shard->finished_num++;
+	shard->processing_num--;
+	(void)zbx_list_append(&shard->finished, task, NULL);
 }
 
 /******************************************************************************
@@ -365,35 +604,127 @@ void	pp_task_queue_push_finished(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
  ******************************************************************************/
 zbx_pp_task_t	*pp_task_queue_pop_finished(zbx_pp_queue_t *queue)
 {
-	zbx_pp_task_t	*task;
+	zbx_pp_queue_shard_t	*shard;
+	zbx_pp_task_t		*task;
+	int			ret;
 
-	if (SUCCEED == zbx_list_pop(&queue->finished, (void **)&task))
+	for (int i = 0; i < queue->shards_num; i++)
 	{
-		queue->finished_num--;
-		return task;
+		shard = &queue->shards[queue->finished_index];
+
+		pthread_mutex_lock(&shard->lock);
+
+		if (SUCCEED == (ret = zbx_list_pop(&shard->finished, (void **)&task)))
+			shard->finished_num--;
+
+		pthread_mutex_unlock(&shard->lock);
+
+		if (SUCCEED == ret)
+			return task;
+
+		queue->finished_index = (queue->finished_index + 1) % queue->shards_num;
 	}
 
 	return NULL;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get number of pending, processing and finished tasks              *
+ *                                                                            *
+ * Parameters: queue          - [IN] task queue                               *
+ *             pending_num    - [OUT] pending tasks (optional)                *
+ *             processing_num - [OUT] processed tasks (optional)              *
+ *             finished_num   - [OUT] finished tasks (optional)               *
+ *                                                                            *
+ ******************************************************************************/
+void	pp_task_queue_get_stats(zbx_pp_queue_t *queue, zbx_uint64_t *pending_num, zbx_uint64_t *processing_num,
+		zbx_uint64_t *finished_num)
+{
+	zbx_uint64_t	pending = 0, processing = 0, finished = 0;
+
+	for (int i = 0; i < queue->shards_num; i++)
+	{
+		zbx_pp_queue_shard_t	*shard = &queue->shards[i];
+
+		pthread_mutex_lock(&shard->lock);
+		pending += shard->pending_num;
+		processing += shard->processing_num;
+		finished += shard->finished_num;
+		pthread_mutex_unlock(&shard->lock);
+	}
+
+	if (NULL != pending_num)
+		*pending_num = pending;
+
+	if (NULL != processing_num)
+		*processing_num = processing;
+
+	if (NULL != finished_num)
+		*finished_num = finished;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if there are tasks the worker can process                   *
+ *                                                                            *
+ * Parameters: queue - [IN] task queue                                        *
+ *             index - [IN] worker task queue index                           *
+ *                                                                            *
+ * Return value: SUCCEED - there are tasks in the worker task queue or tasks  *
+ *                         that can be stolen from other worker task queues   *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: This function must be called within task queue lock.             *
+ *                                                                            *
+ ******************************************************************************/
+int	pp_task_queue_has_tasks(zbx_pp_queue_t *queue, int index)
+{
+	int	ret = FAIL;
+
+	for (int i = 0; i < queue->shards_num && SUCCEED != ret; i++)
+	{
+		zbx_pp_queue_shard_t	*shard = &queue->shards[(index + i) % queue->shards_num];
+
+		pthread_mutex_lock(&shard->lock);
+
+		if (NULL != shard->immediate.head || NULL != shard->pending.head ||
+				(0 == i && NULL != shard->pending_seq.head))
+		{
+			ret = SUCCEED;
+		}
+
+		pthread_mutex_unlock(&shard->lock);
+	}
+
+	return ret;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: wait for queue notifications                                      *
  *                                                                            *
  * Parameters: queue - [IN] task queue                                        *
+ *             index - [IN] worker task queue index                           *
  *             error - [IN]                                                   *
  *                                                                            *
  * Return value: SUCCEED - the wait succeeded                                 *
  *               FAIL    - an error has occurred                              *
  *                                                                            *
- * Comments: This function is used by workers to wait for new tasks.          *
+ * Comments: This function is used by workers to wait for new tasks and must  *
+ *           be called within task queue lock.                                *
  *                                                                            *
  ******************************************************************************/
-int	pp_task_queue_wait(zbx_pp_queue_t *queue, char **error)
+int	pp_task_queue_wait(zbx_pp_queue_t *queue, int index, char **error)
 {
-	int	err;
+	zbx_pp_queue_shard_t	*shard = &queue->shards[index];
+	int			err;
+
+	shard->idle = 1;
+	err = pthread_cond_wait(&shard->event, &queue->lock);
+	shard->idle = 0;
 
-	if (0 != (err = pthread_cond_wait(&queue->event, &queue->lock)))
+	if (0 != err)
 	{
 		*error = zbx_dsprintf(NULL, "cannot wait for conditional variable: %s", zbx_strerror(err));
 		return FAIL;
@@ -404,21 +735,67 @@ int	pp_task_queue_wait(zbx_pp_queue_t *queue, char **error)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: notify one worker                                                 *
+ * Purpose: wake worker waiting for new tasks                                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	pp_task_queue_signal(zbx_pp_queue_shard_t *shard)
+{
+	int	err;
+
+	if (0 != (err = pthread_cond_signal(&shard->event)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot signal conditional variable: %s", zbx_strerror(err));
+	}
+
+	shard->idle = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: notify workers about new tasks                                    *
  *                                                                            *
  * Parameters: queue - [IN] task queue                                        *
  *                                                                            *
- * Comments: This function is used by manager to notify a worker when a new   *
- *           task has been queued.                                            *
+ * Comments: This function is used by manager to notify workers when new      *
+ *           tasks have been queued. Idle owners of worker task queues with   *
+ *           new tasks are woken first, then other idle workers are woken to  *
+ *           steal the remaining new tasks.                                   *
  *                                                                            *
  ******************************************************************************/
 void	pp_task_queue_notify(zbx_pp_queue_t *queue)
 {
-	int	err;
+	zbx_pp_queue_shard_t	*shard;
+	int			i, steal_num = 0;
 
-	if (0 != (err = pthread_cond_signal(&queue->event)))
+	for (i = 0; i < queue->shards_num; i++)
 	{
-		zabbix_log(LOG_LEVEL_WARNING, "cannot signal conditional variable: %s", zbx_strerror(err));
+		shard = &queue->shards[i];
+
+		if (0 == shard->pushed_num && 0 == shard->pushed_seq)
+			continue;
+
+		if (0 != shard->idle)
+		{
+			pp_task_queue_signal(shard);
+
+			if (0 != shard->pushed_num)
+				shard->pushed_num--;
+		}
+
+		steal_num += shard->pushed_num;
+		shard->pushed_num = 0;
+		shard->pushed_seq = 0;
+	}
+
+	for (i = 0; i < queue->shards_num && 0 < steal_num; i++)
+	{
+		shard = &queue->shards[i];
+
+		if (0 != shard->idle)
+		{
+			pp_task_queue_signal(shard);
+			steal_num--;
+		}
 	}
 }
 
@@ -428,17 +805,30 @@ void	pp_task_queue_notify(zbx_pp_queue_t *queue)
  *                                                                            *
  * Parameters: queue - [IN] task queue                                        *
  *                                                                            *
- * Comments: This function is used by manager to notify workers when either   *
- *           multiple tasks have been pushed or when stopping workers.        *
+ * Comments: This function is used by manager to notify workers when stopping *
+ *           workers.                                                         *
  *                                                                            *
  ******************************************************************************/
 void	pp_task_queue_notify_all(zbx_pp_queue_t *queue)
 {
-	int	err;
+	for (int i = 0; i < queue->shards_num; i++)
+		pp_task_queue_signal(&queue->shards[i]);
+}
 
-	if (0 != (err = pthread_cond_broadcast(&queue->event)))
+/******************************************************************************
+ *                                                                            *
+ * Purpose: stop handing out new tasks to workers                             *
+ *                                                                            *
+ * Parameters: queue - [IN] task queue                                        *
+ *                                                                            *
+ ******************************************************************************/
+void	pp_task_queue_stop(zbx_pp_queue_t *queue)
+{
+	for (int i = 0; i < queue->shards_num; i++)
 	{
-		zabbix_log(LOG_LEVEL_WARNING, "cannot broadcast conditional variable: %s", zbx_strerror(err));
+		pthread_mutex_lock(&queue->shards[i].lock);
+		queue->shards[i].stop = 1;
+		pthread_mutex_unlock(&queue->shards[i].lock);
 	}
 }
 
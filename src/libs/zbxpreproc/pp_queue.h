@@ -23,46 +23,74 @@
 #include "zbxpreproc.h"
 #include "zbxalgo.h"
 
+/* per worker task queue, tasks are placed by itemid and can be stolen by idle workers */
 typedef struct
 {
-	zbx_uint32_t	init_flags;
-	int		workers_num;
 	zbx_uint64_t	pending_num;
 	zbx_uint64_t	finished_num;
 	zbx_uint64_t	processing_num;
 
-	zbx_hashset_t	sequences;
-
-	zbx_list_t	pending;
 	zbx_list_t	immediate;
+	zbx_list_t	pending;
+	zbx_list_t	pending_seq;	/* value tasks of sequentially processed items, not stolen */
 	zbx_list_t	finished;
 
+	int		stop;
+
 	pthread_mutex_t	lock;
+
+	/* the fields below are protected by task queue lock */
+	int		idle;
+	int		pushed_num;	/* tasks that can be stolen, pushed since the last notification */
+	int		pushed_seq;	/* tasks that cannot be stolen were pushed since the last notification */
 	pthread_cond_t	event;
 }
+zbx_pp_queue_shard_t;
+
+typedef struct
+{
+	zbx_uint32_t		init_flags;
+	int			workers_num;
+
+	zbx_hashset_t		sequences;
+
+	zbx_pp_queue_shard_t	*shards;
+	int			shards_num;
+	int			finished_index;
+
+	pthread_mutex_t		lock;
+}
 zbx_pp_queue_t;
 
-int	pp_task_queue_init(zbx_pp_queue_t *queue, char **error);
+int	pp_task_queue_init(zbx_pp_queue_t *queue, int shards_num, char **error);
 void	pp_task_queue_destroy(zbx_pp_queue_t *queue);
 
 void	pp_task_queue_lock(zbx_pp_queue_t *queue);
+void	pp_task_queue_lock_timed(zbx_pp_queue_t *queue, double *lock_wait);
 void	pp_task_queue_unlock(zbx_pp_queue_t *queue);
+void	pp_task_queue_lock_shard(zbx_pp_queue_t *queue, int index, double *lock_wait);
+void	pp_task_queue_unlock_shard(zbx_pp_queue_t *queue, int index);
 void	pp_task_queue_register_worker(zbx_pp_queue_t *queue);
 void	pp_task_queue_deregister_worker(zbx_pp_queue_t *queue);
 void	pp_task_queue_remove_sequence(zbx_pp_queue_t *queue, zbx_uint64_t itemid);
 
-int	pp_task_queue_wait(zbx_pp_queue_t *queue, char **error);
+int	pp_task_queue_has_tasks(zbx_pp_queue_t *queue, int index);
+int	pp_task_queue_wait(zbx_pp_queue_t *queue, int index, char **error);
 void	pp_task_queue_notify(zbx_pp_queue_t *queue);
 void	pp_task_queue_notify_all(zbx_pp_queue_t *queue);
+void	pp_task_queue_stop(zbx_pp_queue_t *queue);
 
 void	pp_task_queue_push_test(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
 void	pp_task_queue_push(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
 
-zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue);
+zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue, int index, double *lock_wait);
 void	pp_task_queue_push_immediate(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
-void	pp_task_queue_push_finished(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
+void	pp_task_queue_push_finished(zbx_pp_queue_t *queue, int index, zbx_pp_task_t *task);
 zbx_pp_task_t	*pp_task_queue_pop_finished(zbx_pp_queue_t *queue);
 
+void	pp_task_queue_get_stats(zbx_pp_queue_t *queue, zbx_uint64_t *pending_num, zbx_uint64_t *processing_num,
+		zbx_uint64_t *finished_num);
+
 void	pp_task_queue_get_sequence_stats(zbx_pp_queue_t *queue, zbx_vector_pp_sequence_stats_ptr_t *stats);
 
 #endif
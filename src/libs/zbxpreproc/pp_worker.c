@@ -111,7 +111,8 @@ static void	*pp_worker_entry(void *args)
 	zbx_pp_task_t		*in;
 	char			*error = NULL, component[MAX_ID_LEN + 1];
 	sigset_t		mask;
-	int			err;
+	int			err, index = worker->id - 1;
+	double			lock_wait = 0;
 
 	zbx_snprintf(component, sizeof(component), "%d", worker->id);
 	zbx_set_log_component(component, &worker->logger);
@@ -140,10 +141,22 @@ static void	*pp_worker_entry(void *args)
 
 	while (0 == worker->stop)
 	{
-		if (NULL != (in = pp_task_queue_pop_new(queue)))
+		if (SUCCEED != pp_task_queue_has_tasks(queue, index))
 		{
-			pp_task_queue_unlock(queue);
+			if (SUCCEED != pp_task_queue_wait(queue, index, &error))
+			{
+				zabbix_log(LOG_LEVEL_WARNING, "[%d] %s", worker->id, error);
+				zbx_free(error);
+				worker->stop = 1;
+			}
 
+			continue;
+		}
+
+		pp_task_queue_unlock(queue);
+
+		while (NULL != (in = pp_task_queue_pop_new(queue, index, &lock_wait)))
+		{
 			zbx_timekeeper_update(worker->timekeeper, worker->id - 1, ZBX_PROCESS_STATE_BUSY);
 
 			zabbix_log(LOG_LEVEL_TRACE, "%s() process task type:%u itemid:" ZBX_FS_UI64, __func__,
@@ -168,29 +181,29 @@ static void	*pp_worker_entry(void *args)
 
 			zbx_timekeeper_update(worker->timekeeper, worker->id - 1, ZBX_PROCESS_STATE_IDLE);
 
-			pp_task_queue_lock(queue);
-			pp_task_queue_push_finished(queue, in);
+			pp_task_queue_lock_shard(queue, index, &lock_wait);
+			pp_task_queue_push_finished(queue, index, in);
+
+			/* publish thread local regexp cache, shared step result and lock wait */
+			/* statistics, protected by worker task queue lock                     */
+			zbx_regexp_cache_get_stats(&worker->regexp_cache_stats);
+			worker->cache_stats = worker->execute_ctx.cache_stats;
+			worker->lock_wait = lock_wait;
 
 			if (NULL != worker->finished_cb)
 				worker->finished_cb(worker->finished_data);
 
-			continue;
-		}
-
-		if (SUCCEED != pp_task_queue_wait(queue, &error))
-		{
-			zabbix_log(LOG_LEVEL_WARNING, "[%d] %s", worker->id, error);
-			zbx_free(error);
-			worker->stop = 1;
+			pp_task_queue_unlock_shard(queue, index);
 		}
 
-		if (1 < queue->pending_num)
-			pp_task_queue_notify(queue);
+		pp_task_queue_lock_timed(queue, &lock_wait);
 	}
 
 	pp_task_queue_deregister_worker(queue);
 	pp_task_queue_unlock(queue);
 
+	zbx_regexp_cache_clear();
+
 	zabbix_log(LOG_LEVEL_INFORMATION, "thread stopped [%s #%d]",
 			get_process_type_string(ZBX_PROCESS_TYPE_PREPROCESSOR), worker->id);
 
@@ -24,6 +24,7 @@
 #include "pp_execute.h"
 #include "zbxtimekeeper.h"
 #include "zbxpreproc.h"
+#include "zbxregexp.h"
 
 
 typedef struct
@@ -47,6 +48,12 @@ typedef struct
 	zbx_log_component_t		logger;
 
 	const char			*config_source_ip;
+
+	zbx_regexp_cache_stats_t	regexp_cache_stats;
+
+	zbx_pp_cache_stats_t		cache_stats;
+
+	double				lock_wait;
 }
 zbx_pp_worker_t;
 
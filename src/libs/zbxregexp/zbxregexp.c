@@ -262,43 +262,158 @@ int	zbx_regexp_compile_ext(const char *pattern, zbx_regexp_t **regexp, int flags
 	return regexp_compile(pattern, flags, regexp, err_msg);
 }
 
+/* the number of compiled regular expressions cached by each thread */
+#define ZBX_REGEXP_CACHE_SIZE	32
+
+typedef struct
+{
+	char		*pattern;
+	zbx_hash_t	hash;
+	int		flags;
+	zbx_regexp_t	*regexp;
+	zbx_uint64_t	lastaccess;
+}
+zbx_regexp_cache_entry_t;
+
+static ZBX_THREAD_LOCAL zbx_regexp_cache_entry_t	regexp_cache[ZBX_REGEXP_CACHE_SIZE];
+static ZBX_THREAD_LOCAL zbx_uint64_t			regexp_cache_clock;
+static ZBX_THREAD_LOCAL zbx_regexp_cache_stats_t	regexp_cache_stats;
+
+#ifdef HAVE_PCRE2_H
+/* match data reused by the calling thread for regexps with few capture groups */
+static ZBX_THREAD_LOCAL pcre2_match_data	*match_data_buff = NULL;
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: JIT compile regular expression if supported by pcre2 library     *
+ *                                                                            *
+ * Comments: JIT compilation failure is not an error - the pattern will be    *
+ *           matched by interpreter.                                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	regexp_jit_compile(zbx_regexp_t *regexp)
+{
+#if defined(HAVE_PCRE2_H) && defined(PCRE2_JIT_COMPLETE)
+	int	ret;
+
+	if (0 != (ret = pcre2_jit_compile(regexp->pcre2_regexp, PCRE2_JIT_COMPLETE)))
+		zabbix_log(LOG_LEVEL_TRACE, "%s() JIT compilation failed with error %d", __func__, ret);
+#else
+	ZBX_UNUSED(regexp);
+#endif
+}
+
 /****************************************************************************************************
  *                                                                                                  *
- * Purpose: wrapper for zbx_regexp_compile. Caches and reuses the last used regexp.                 *
+ * Purpose: wrapper for zbx_regexp_compile. Caches and reuses recently used regexps in per thread   *
+ *          cache, discarding the least recently used regexp when cache is full.                    *
+ *                                                                                                  *
+ * Comments: The returned regexp is owned by cache and must not be freed by caller. It stays valid  *
+ *           until the next regexp_prepare() call in the same thread.                               *
  *                                                                                                  *
  ****************************************************************************************************/
 static int	regexp_prepare(const char *pattern, int flags, zbx_regexp_t **regexp, char **err_msg)
 {
-	static ZBX_THREAD_LOCAL zbx_regexp_t	*curr_regexp = NULL;
-	static ZBX_THREAD_LOCAL char		*curr_pattern = NULL;
-	static ZBX_THREAD_LOCAL int		curr_flags = 0;
-	int					ret = SUCCEED;
+	zbx_regexp_cache_entry_t	*entry = NULL;
+	zbx_hash_t			hash;
+	int				i;
+
+	hash = ZBX_DEFAULT_STRING_HASH_FUNC(pattern);
 
-	if (NULL == curr_regexp || 0 != strcmp(curr_pattern, pattern) || curr_flags != flags)
+	for (i = 0; i < ZBX_REGEXP_CACHE_SIZE; i++)
 	{
-		if (NULL != curr_regexp)
+		zbx_regexp_cache_entry_t	*e = &regexp_cache[i];
+
+		if (NULL == e->regexp)
 		{
-			zbx_regexp_free(curr_regexp);
-			zbx_free(curr_pattern);
+			if (NULL == entry)
+				entry = e;
+			continue;
 		}
 
-		curr_regexp = NULL;
-		curr_pattern = NULL;
-		curr_flags = 0;
-
-		if (SUCCEED == regexp_compile(pattern, flags, &curr_regexp, err_msg))
+		if (e->hash == hash && e->flags == flags && 0 == strcmp(e->pattern, pattern))
 		{
-			curr_pattern = zbx_strdup(curr_pattern, pattern);
-			curr_flags = flags;
+			e->lastaccess = ++regexp_cache_clock;
+			regexp_cache_stats.hits++;
+			*regexp = e->regexp;
+
+			return SUCCEED;
 		}
-		else
-			ret = FAIL;
+
+		if (NULL == entry || (NULL != entry->regexp && e->lastaccess < entry->lastaccess))
+			entry = e;
 	}
 
-	*regexp = curr_regexp;
-	return ret;
+	regexp_cache_stats.misses++;
+
+	if (SUCCEED != regexp_compile(pattern, flags, regexp, err_msg))
+	{
+		*regexp = NULL;
+		return FAIL;
+	}
+
+	regexp_jit_compile(*regexp);
+
+	if (NULL != entry->regexp)
+	{
+		zbx_regexp_free(entry->regexp);
+		zbx_free(entry->pattern);
+		regexp_cache_stats.evictions++;
+	}
+
+	entry->pattern = zbx_strdup(NULL, pattern);
+	entry->hash = hash;
+	entry->flags = flags;
+	entry->regexp = *regexp;
+	entry->lastaccess = ++regexp_cache_clock;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get compiled regexp cache statistics of the calling thread        *
+ *                                                                            *
+ * Parameters: stats - [OUT] cache statistics                                 *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_regexp_cache_get_stats(zbx_regexp_cache_stats_t *stats)
+{
+	*stats = regexp_cache_stats;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: free compiled regexps and match data cached by the calling thread *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_regexp_cache_clear(void)
+{
+	int	i;
+
+	for (i = 0; i < ZBX_REGEXP_CACHE_SIZE; i++)
+	{
+		zbx_regexp_cache_entry_t	*entry = &regexp_cache[i];
+
+		if (NULL == entry->regexp)
+			continue;
+
+		zbx_regexp_free(entry->regexp);
+		zbx_free(entry->pattern);
+		memset(entry, 0, sizeof(zbx_regexp_cache_entry_t));
+	}
+#ifdef HAVE_PCRE2_H
+	if (NULL != match_data_buff)
+	{
+		pcre2_match_data_free(match_data_buff);
+		match_data_buff = NULL;
+	}
+#endif
 }
 
+#undef ZBX_REGEXP_CACHE_SIZE
+
 /* calculate recursion limit, PCRE man page suggests to reckon on about 500 bytes per recursion */
 /* but to be on the safe side - reckon on 800 bytes and do not set limit higher than 100000 */
 #define REGEXP_RECURSION_STEP	800
@@ -453,7 +568,19 @@ static int	regexp_exec(const char *string, const zbx_regexp_t *regexp, int flags
 	pcre2_set_match_limit(regexp->match_ctx, 1000000);
 
 	pcre2_set_recursion_limit(regexp->match_ctx, (uint32_t)compute_recursion_limit());
-	match_data = pcre2_match_data_create((uint32_t)count, NULL);
+
+	/* reuse match data for the common case of few capture groups to avoid allocation on every match */
+	if (ZBX_REGEXP_GROUPS_MAX < count)
+	{
+		match_data = pcre2_match_data_create((uint32_t)count, NULL);
+	}
+	else
+	{
+		if (NULL == match_data_buff)
+			match_data_buff = pcre2_match_data_create(ZBX_REGEXP_GROUPS_MAX, NULL);
+
+		match_data = match_data_buff;
+	}
 
 	if (NULL == match_data)
 	{
@@ -466,8 +593,17 @@ static int	regexp_exec(const char *string, const zbx_regexp_t *regexp, int flags
 		flags |= PCRE2_NO_UTF_CHECK;
 #endif
 
-		if (0 <= (r = pcre2_match(regexp->pcre2_regexp, (PCRE2_SPTR)string, PCRE2_ZERO_TERMINATED, 0, flags,
-			match_data, regexp->match_ctx)))
+		r = pcre2_match(regexp->pcre2_regexp, (PCRE2_SPTR)string, PCRE2_ZERO_TERMINATED, 0, flags, match_data,
+				regexp->match_ctx);
+#if defined(PCRE2_ERROR_JIT_STACKLIMIT) && defined(PCRE2_NO_JIT)
+		/* JIT stack is much smaller than the interpreter limits, retry without JIT */
+		if (PCRE2_ERROR_JIT_STACKLIMIT == r)
+		{
+			r = pcre2_match(regexp->pcre2_regexp, (PCRE2_SPTR)string, PCRE2_ZERO_TERMINATED, 0,
+					flags | PCRE2_NO_JIT, match_data, regexp->match_ctx);
+		}
+#endif
+		if (0 <= r)
 		{
 			if (NULL != matches)
 			{
@@ -497,7 +633,8 @@ static int	regexp_exec(const char *string, const zbx_regexp_t *regexp, int flags
 			result = FAIL;
 		}
 
-		pcre2_match_data_free(match_data);
+		if (match_data != match_data_buff)
+			pcre2_match_data_free(match_data);
 	}
 
 	return result;
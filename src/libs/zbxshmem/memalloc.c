@@ -523,6 +523,268 @@ static void	__mem_free(zbx_shmem_info_t *info, void *ptr)
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ *                            Slab allocator mode                             *
+ *                          -----------------------                           *
+ *                                                                            *
+ * (*) when slab mode is enabled small allocations (below                     *
+ *     SHMEM_MAX_BUCKET_SIZE) are served from slab pages                      *
+ *                                                                            *
+ * (*) slab page: a regular used chunk split into objects of the same size    *
+ *     class, preceded by page header with a bitmap of used objects           *
+ *                                                                            *
+ *     page header|tag|object|tag|object|...|tag|object|unused tail           *
+ *                                                                            *
+ *     each object is preceded by 8 byte tag having SHMEM_FLG_USED and        *
+ *     SHMEM_FLG_SLAB bits set and the tag offset from page header in the     *
+ *     remaining bits, so the page of object is found in constant time        *
+ *                                                                            *
+ * (*) pages with free objects are stored in doubly-linked lists according    *
+ *     to their size class                                                    *
+ *                                                                            *
+ * (*) slab pages are accounted as used memory, so the shared memory free     *
+ *     size is not increased by free objects that can serve only small        *
+ *     allocations - their size is tracked separately as slab free size       *
+ *                                                                            *
+ ******************************************************************************/
+
+#define SHMEM_FLG_SLAB			((__UINT64_C(1))<<62)
+#define SLAB_OBJECT(ptr)		(((*(zbx_uint64_t *)(ptr)) & SHMEM_FLG_SLAB) != 0)
+#define SLAB_OBJECT_OFFSET(ptr)		((*(zbx_uint64_t *)(ptr)) & ~(SHMEM_FLG_USED | SHMEM_FLG_SLAB))
+
+#define SHMEM_SLAB_PAGE_SIZE		(16 * ZBX_KIBIBYTE)
+#define SHMEM_SLAB_CLASS_COUNT		(ZBX_SHMEM_BUCKET_COUNT - 1)
+#define SHMEM_SLAB_OBJECTS_MAX		(SHMEM_SLAB_PAGE_SIZE / (SHMEM_MIN_ALLOC + SHMEM_SIZE_FIELD))
+#define SHMEM_SLAB_BITMAP_SIZE		((SHMEM_SLAB_OBJECTS_MAX + 63) / 64)
+
+typedef struct zbx_shmem_slab_page
+{
+	struct zbx_shmem_slab_page	*prev;
+	struct zbx_shmem_slab_page	*next;
+	zbx_uint64_t			object_size;	/* object size, without tag */
+	unsigned int			objects_num;
+	unsigned int			used_num;
+	unsigned int			free_hint;	/* the first bitmap word that might have free objects */
+	int				class_index;
+	zbx_uint64_t			bitmap[SHMEM_SLAB_BITMAP_SIZE];	/* set bits mark used objects */
+}
+zbx_shmem_slab_page_t;
+
+typedef struct
+{
+	zbx_shmem_slab_page_t	*partial[SHMEM_SLAB_CLASS_COUNT];
+	unsigned int		pages_num;
+	unsigned int		objects_num;
+	unsigned int		used_num;
+	zbx_uint64_t		free_size;
+	zbx_uint64_t		overhead;
+}
+zbx_shmem_slab_t;
+
+#define SLAB_PAGE_OBJECTS(page)	((char *)(page) + sizeof(zbx_shmem_slab_page_t))
+
+static void	mem_slab_link_page(zbx_shmem_slab_t *slab, zbx_shmem_slab_page_t *page)
+{
+	page->prev = NULL;
+	page->next = slab->partial[page->class_index];
+
+	if (NULL != page->next)
+		page->next->prev = page;
+
+	slab->partial[page->class_index] = page;
+}
+
+static void	mem_slab_unlink_page(zbx_shmem_slab_t *slab, zbx_shmem_slab_page_t *page)
+{
+	if (NULL != page->prev)
+		page->prev->next = page->next;
+	else
+		slab->partial[page->class_index] = page->next;
+
+	if (NULL != page->next)
+		page->next->prev = page->prev;
+
+	page->prev = NULL;
+	page->next = NULL;
+}
+
+static zbx_shmem_slab_page_t	*mem_slab_create_page(zbx_shmem_info_t *info, int class_index)
+{
+	zbx_shmem_slab_t	*slab = (zbx_shmem_slab_t *)info->slab;
+	zbx_shmem_slab_page_t	*page;
+	void			*chunk;
+	zbx_uint64_t		object_size, page_size;
+	int			allow_oom = info->allow_oom;
+
+	/* failing to allocate slab page is not an error - the allocation falls back to regular chunks */
+	info->allow_oom = 1;
+	chunk = __mem_malloc(info, SHMEM_SLAB_PAGE_SIZE);
+	info->allow_oom = allow_oom;
+
+	if (NULL == chunk)
+		return NULL;
+
+	page_size = CHUNK_SIZE(chunk);
+	page = (zbx_shmem_slab_page_t *)((char *)chunk + SHMEM_SIZE_FIELD);
+	object_size = ZBX_SHMEM_MIN_BUCKET_SIZE + 8 * (zbx_uint64_t)class_index;
+
+	memset(page, 0, sizeof(zbx_shmem_slab_page_t));
+	page->class_index = class_index;
+	page->object_size = object_size;
+	page->objects_num = (unsigned int)MIN(SHMEM_SLAB_OBJECTS_MAX,
+			(page_size - sizeof(zbx_shmem_slab_page_t)) / (object_size + SHMEM_SIZE_FIELD));
+
+	slab->pages_num++;
+	slab->objects_num += page->objects_num;
+	slab->free_size += page->objects_num * object_size;
+	slab->overhead += page_size - page->objects_num * object_size;
+
+	mem_slab_link_page(slab, page);
+
+	return page;
+}
+
+static void	mem_slab_release_page(zbx_shmem_info_t *info, zbx_shmem_slab_page_t *page)
+{
+	zbx_shmem_slab_t	*slab = (zbx_shmem_slab_t *)info->slab;
+	zbx_uint64_t		page_size;
+
+	page_size = CHUNK_SIZE((char *)page - SHMEM_SIZE_FIELD);
+
+	mem_slab_unlink_page(slab, page);
+
+	slab->pages_num--;
+	slab->objects_num -= page->objects_num;
+	slab->free_size -= page->objects_num * page->object_size;
+	slab->overhead -= page_size - page->objects_num * page->object_size;
+
+	__mem_free(info, page);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: allocates small object from slab page                             *
+ *                                                                            *
+ * Return value: the object tag address (as chunk address is returned by      *
+ *               __mem_malloc()) or NULL if there is no memory for new page   *
+ *                                                                            *
+ ******************************************************************************/
+static void	*mem_slab_malloc(zbx_shmem_info_t *info, zbx_uint64_t size)
+{
+	zbx_shmem_slab_t	*slab = (zbx_shmem_slab_t *)info->slab;
+	zbx_shmem_slab_page_t	*page;
+	int			class_index;
+	unsigned int		word, bit, object;
+	char			*tag;
+
+	size = mem_proper_alloc_size(size);
+	class_index = mem_bucket_by_size(size);
+
+	if (NULL == (page = slab->partial[class_index]) && NULL == (page = mem_slab_create_page(info, class_index)))
+		return NULL;
+
+	for (word = page->free_hint; ~__UINT64_C(0) == page->bitmap[word]; word++)
+		;
+
+	for (bit = 0; 0 != (page->bitmap[word] & (__UINT64_C(1) << bit)); bit++)
+		;
+
+	object = word * 64 + bit;
+	page->bitmap[word] |= __UINT64_C(1) << bit;
+	page->free_hint = word;
+
+	if (++page->used_num == page->objects_num)
+		mem_slab_unlink_page(slab, page);
+
+	slab->used_num++;
+	slab->free_size -= page->object_size;
+
+	tag = SLAB_PAGE_OBJECTS(page) + (zbx_uint64_t)object * (page->object_size + SHMEM_SIZE_FIELD);
+	*(zbx_uint64_t *)tag = SHMEM_FLG_USED | SHMEM_FLG_SLAB | (zbx_uint64_t)(tag - (char *)page);
+
+	return tag;
+}
+
+static void	mem_slab_free(zbx_shmem_info_t *info, void *ptr)
+{
+	zbx_shmem_slab_t	*slab = (zbx_shmem_slab_t *)info->slab;
+	zbx_shmem_slab_page_t	*page;
+	char			*tag = (char *)ptr - SHMEM_SIZE_FIELD;
+	unsigned int		object;
+
+	page = (zbx_shmem_slab_page_t *)(tag - SLAB_OBJECT_OFFSET(tag));
+	object = (unsigned int)((tag - SLAB_PAGE_OBJECTS(page)) / (page->object_size + SHMEM_SIZE_FIELD));
+
+	page->bitmap[object / 64] &= ~(__UINT64_C(1) << (object % 64));
+
+	if (object / 64 < page->free_hint)
+		page->free_hint = object / 64;
+
+	if (page->used_num-- == page->objects_num)
+		mem_slab_link_page(slab, page);
+
+	slab->used_num--;
+	slab->free_size += page->object_size;
+
+	/* release empty page unless it's the only page with free objects of its size class */
+	if (0 == page->used_num && (NULL != page->prev || NULL != page->next))
+		mem_slab_release_page(info, page);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: allocates memory from slab pages if possible, otherwise from      *
+ *          regular chunks                                                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	*mem_malloc(zbx_shmem_info_t *info, zbx_uint64_t size)
+{
+	void	*chunk;
+
+	if (NULL != info->slab && SHMEM_MAX_BUCKET_SIZE > mem_proper_alloc_size(size) &&
+			NULL != (chunk = mem_slab_malloc(info, size)))
+		return chunk;
+
+	return __mem_malloc(info, size);
+}
+
+static void	mem_free(zbx_shmem_info_t *info, void *ptr)
+{
+	if (SLAB_OBJECT((char *)ptr - SHMEM_SIZE_FIELD))
+		mem_slab_free(info, ptr);
+	else
+		__mem_free(info, ptr);
+}
+
+static void	*mem_slab_realloc(zbx_shmem_info_t *info, void *old, zbx_uint64_t size)
+{
+	zbx_shmem_slab_page_t	*page;
+	char			*tag = (char *)old - SHMEM_SIZE_FIELD;
+	void			*chunk;
+
+	page = (zbx_shmem_slab_page_t *)(tag - SLAB_OBJECT_OFFSET(tag));
+
+	if (size <= page->object_size)
+		return tag;
+
+	if (NULL == (chunk = mem_malloc(info, size)))
+		return NULL;
+
+	memcpy((char *)chunk + SHMEM_SIZE_FIELD, old, page->object_size);
+	mem_slab_free(info, old);
+
+	return chunk;
+}
+
+static void	*mem_realloc(zbx_shmem_info_t *info, void *old, zbx_uint64_t size)
+{
+	if (SLAB_OBJECT((char *)old - SHMEM_SIZE_FIELD))
+		return mem_slab_realloc(info, old, size);
+
+	return __mem_realloc(info, old, size);
+}
+
 /* public memory interface */
 
 int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *descr, const char *param,
@@ -596,6 +858,7 @@ int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *des
 	base = (void *)((char *)base + strlen(param) + 1);
 
 	(*info)->allow_oom = allow_oom;
+	(*info)->slab = NULL;
 
 	/* prepare shared memory for further allocation by creating one big chunk */
 	(*info)->lo_bound = ALIGN8(base);
@@ -665,6 +928,35 @@ void	zbx_shmem_destroy(zbx_shmem_info_t *info)
 	(void)shmdt(info->base);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: enables slab allocator for small allocations                      *
+ *                                                                            *
+ * Parameters: info - [IN] shared memory                                      *
+ *                                                                            *
+ * Comments: Slab mode reduces fragmentation and allocation overhead of       *
+ *           shared memory used for many small, frequently allocated and      *
+ *           freed objects. It must be enabled right after shared memory      *
+ *           is created, before anything is allocated from it.                *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_shmem_enable_slab(zbx_shmem_info_t *info)
+{
+	void	*chunk;
+
+	if (NULL != info->slab)
+		return;
+
+	if (NULL == (chunk = __mem_malloc(info, sizeof(zbx_shmem_slab_t))))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot enable slab allocator for %s", info->mem_descr);
+		return;
+	}
+
+	info->slab = (char *)chunk + SHMEM_SIZE_FIELD;
+	memset(info->slab, 0, sizeof(zbx_shmem_slab_t));
+}
+
 void	*__zbx_shmem_malloc(const char *file, int line, zbx_shmem_info_t *info, const void *old, size_t size)
 {
 	void	*chunk;
@@ -683,7 +975,7 @@ void	*__zbx_shmem_malloc(const char *file, int line, zbx_shmem_info_t *info, con
 		exit(EXIT_FAILURE);
 	}
 
-	chunk = __mem_malloc(info, size);
+	chunk = mem_malloc(info, size);
 
 	if (NULL == chunk)
 	{
@@ -715,9 +1007,9 @@ void	*__zbx_shmem_realloc(const char *file, int line, zbx_shmem_info_t *info, vo
 	}
 
 	if (NULL == old)
-		chunk = __mem_malloc(info, size);
+		chunk = mem_malloc(info, size);
 	else
-		chunk = __mem_realloc(info, old, size);
+		chunk = mem_realloc(info, old, size);
 
 	if (NULL == chunk)
 	{
@@ -745,7 +1037,7 @@ void	__zbx_shmem_free(const char *file, int line, zbx_shmem_info_t *info, void *
 		exit(EXIT_FAILURE);
 	}
 
-	__mem_free(info, ptr);
+	mem_free(info, ptr);
 }
 
 void	zbx_shmem_clear(zbx_shmem_info_t *info)
@@ -763,6 +1055,12 @@ void	zbx_shmem_clear(zbx_shmem_info_t *info)
 	info->used_size = 0;
 	info->free_size = info->total_size;
 
+	if (NULL != info->slab)
+	{
+		info->slab = NULL;
+		zbx_shmem_enable_slab(info);
+	}
+
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
@@ -800,6 +1098,53 @@ void	zbx_shmem_get_stats(const zbx_shmem_info_t *info, zbx_shmem_stats_t *stats)
 	stats->used_chunks = stats->overhead / (2 * SHMEM_SIZE_FIELD) + 1 - stats->free_chunks;
 	stats->free_size = info->free_size;
 	stats->used_size = info->used_size;
+
+	if (NULL != info->slab)
+	{
+		const zbx_shmem_slab_t	*slab = (const zbx_shmem_slab_t *)info->slab;
+
+		stats->slab_pages = slab->pages_num;
+		stats->slab_used_objects = slab->used_num;
+		stats->slab_free_objects = slab->objects_num - slab->used_num;
+		stats->slab_free_size = slab->free_size;
+		stats->slab_overhead = slab->overhead;
+	}
+	else
+	{
+		stats->slab_pages = 0;
+		stats->slab_used_objects = 0;
+		stats->slab_free_objects = 0;
+		stats->slab_free_size = 0;
+		stats->slab_overhead = 0;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds memory allocator statistics to the total statistics, used    *
+ *          to report caches split into several shared memory segments        *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_shmem_add_stats(zbx_shmem_stats_t *total, const zbx_shmem_stats_t *stats)
+{
+	if (0 != stats->free_chunks && (0 == total->free_chunks || total->min_chunk_size > stats->min_chunk_size))
+		total->min_chunk_size = stats->min_chunk_size;
+
+	total->max_chunk_size = MAX(total->max_chunk_size, stats->max_chunk_size);
+	total->free_size += stats->free_size;
+	total->used_size += stats->used_size;
+	total->overhead += stats->overhead;
+	total->free_chunks += stats->free_chunks;
+	total->used_chunks += stats->used_chunks;
+
+	total->slab_pages += stats->slab_pages;
+	total->slab_used_objects += stats->slab_used_objects;
+	total->slab_free_objects += stats->slab_free_objects;
+	total->slab_free_size += stats->slab_free_size;
+	total->slab_overhead += stats->slab_overhead;
+
+	for (int i = 0; i < ZBX_SHMEM_BUCKET_COUNT; i++)
+		total->chunks_num[i] += stats->chunks_num[i];
 }
 
 void	zbx_shmem_dump_stats(int level, zbx_shmem_info_t *info)
@@ -833,6 +1178,16 @@ void	zbx_shmem_dump_stats(int level, zbx_shmem_info_t *info)
 	zabbix_log(level, "of those, %10llu bytes are used by allocation overhead",
 			(unsigned long long)stats.overhead);
 
+	if (0 != stats.slab_pages)
+	{
+		zabbix_log(level, "slab pages: %u, used objects: %u, free objects: %u", stats.slab_pages,
+				stats.slab_used_objects, stats.slab_free_objects);
+		zabbix_log(level, "of those, %10llu bytes are in free slab objects",
+				(unsigned long long)stats.slab_free_size);
+		zabbix_log(level, "of those, %10llu bytes are used by slab overhead",
+				(unsigned long long)stats.slab_overhead);
+	}
+
 	zabbix_log(level, "================================");
 }
 
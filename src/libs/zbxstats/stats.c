@@ -207,6 +207,12 @@ void	zbx_zabbix_stats_get(struct zbx_json *json, int config_startup_time)
 			(double)wcache_info.index_total);
 	zbx_json_close(json);
 
+	zbx_json_addobject(json, "sync");
+	zbx_json_adduint64(json, "batch", (zbx_uint64_t)wcache_info.sync_batch_size);
+	zbx_json_adduint64(json, "values", (zbx_uint64_t)wcache_info.sync_batch_values);
+	zbx_json_addfloat(json, "time", wcache_info.sync_batch_time);
+	zbx_json_close(json);
+
 	if (0 != (get_program_type_cb() & ZBX_PROGRAM_TYPE_SERVER))
 	{
 		zbx_json_addobject(json, "trend");
@@ -256,9 +256,80 @@ void zbx_xml_escape_xpath(char **data)
 	*data = buffer;
 }
 
-static int	query_xpath(zbx_variant_t *value, const char *params, int *is_empty, char **errmsg)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parse xml document for repeated xpath queries                     *
+ *                                                                            *
+ * Parameters: data   - [IN] xml data                                         *
+ *             doc    - [OUT] parsed xml document                             *
+ *             errmsg - [OUT] error message                                   *
+ *                                                                            *
+ * Return value: SUCCEED - the document was parsed successfully               *
+ *               FAIL - otherwise                                             *
+ *                                                                            *
+ * Comments: The parsed document must be freed with zbx_xml_doc_free().       *
+ *           Documents can be queried concurrently by multiple threads as     *
+ *           xpath queries do not modify the document.                        *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_xml_doc_open(const char *data, void **doc, char **errmsg)
+{
+#ifndef HAVE_LIBXML2
+	ZBX_UNUSED(data);
+	ZBX_UNUSED(doc);
+	*errmsg = zbx_dsprintf(*errmsg, "Zabbix was compiled without libxml2 support");
+
+	return FAIL;
+#else
+	const xmlError	*pErr;
+
+	if (NULL == (*doc = (void *)xmlReadMemory(data, strlen(data), "noname.xml", NULL, 0)))
+	{
+		if (NULL != (pErr = xmlGetLastError()))
+			*errmsg = zbx_dsprintf(*errmsg, "cannot parse xml value: %s", pErr->message);
+		else
+			*errmsg = zbx_strdup(*errmsg, "cannot parse xml value");
+		return FAIL;
+	}
+
+	return SUCCEED;
+#endif
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: free xml document parsed by zbx_xml_doc_open()                    *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_xml_doc_free(void *doc)
+{
+#ifdef HAVE_LIBXML2
+	if (NULL != doc)
+		xmlFreeDoc((xmlDoc *)doc);
+#else
+	ZBX_UNUSED(doc);
+#endif
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: execute xpath query on parsed xml document                        *
+ *                                                                            *
+ * Parameters: doc      - [IN] parsed xml document                            *
+ *             value    - [OUT] the query result                              *
+ *             params   - [IN] the operation parameters                       *
+ *             is_empty - [OUT] whether the xpath returned empty nodeset      *
+ *                                 (optional)                                 *
+ *             errmsg   - [OUT] error message                                 *
+ *                                                                            *
+ * Return value: SUCCEED - the query was executed successfully                *
+ *               FAIL - otherwise                                             *
+ *                                                                            *
+ ******************************************************************************/
+static int	query_xpath_doc(void *doc, zbx_variant_t *value, const char *params, int *is_empty, char **errmsg)
 {
 #ifndef HAVE_LIBXML2
+	ZBX_UNUSED(doc);
 	ZBX_UNUSED(value);
 	ZBX_UNUSED(params);
 	ZBX_UNUSED(is_empty);
@@ -268,23 +339,13 @@ static int	query_xpath(zbx_variant_t *value, const char *params, int *is_empty,
 #else
 	int		ret = FAIL;
 	char		buffer[32], *ptr;
-	xmlDoc		*doc = NULL;
 	xmlXPathContext	*xpathCtx;
 	xmlXPathObject	*xpathObj;
 	xmlNodeSetPtr	nodeset;
 	const xmlError	*pErr;
 	xmlBufferPtr	xmlBufferLocal;
 
-	if (NULL == (doc = xmlReadMemory(value->data.str, strlen(value->data.str), "noname.xml", NULL, 0)))
-	{
-		if (NULL != (pErr = xmlGetLastError()))
-			*errmsg = zbx_dsprintf(*errmsg, "cannot parse xml value: %s", pErr->message);
-		else
-			*errmsg = zbx_strdup(*errmsg, "cannot parse xml value");
-		return FAIL;
-	}
-
-	xpathCtx = xmlXPathNewContext(doc);
+	xpathCtx = xmlXPathNewContext((xmlDoc *)doc);
 
 	if (NULL == (xpathObj = xmlXPathEvalExpression((const xmlChar *)params, xpathCtx)))
 	{
@@ -313,7 +374,7 @@ static int	query_xpath(zbx_variant_t *value, const char *params, int *is_empty,
 					*is_empty = SUCCEED;
 
 				for (int i = 0; i < nodeset->nodeNr; i++)
-					xmlNodeDump(xmlBufferLocal, doc, nodeset->nodeTab[i], 0, 0);
+					xmlNodeDump(xmlBufferLocal, (xmlDoc *)doc, nodeset->nodeTab[i], 0, 0);
 			}
 			else if (NULL != is_empty)
 				*is_empty = SUCCEED;
@@ -358,12 +419,25 @@ static int	query_xpath(zbx_variant_t *value, const char *params, int *is_empty,
 out:
 	xmlXPathFreeObject(xpathObj);
 	xmlXPathFreeContext(xpathCtx);
-	xmlFreeDoc(doc);
 
 	return ret;
 #endif
 }
 
+static int	query_xpath(zbx_variant_t *value, const char *params, int *is_empty, char **errmsg)
+{
+	void	*doc;
+	int	ret;
+
+	if (SUCCEED != zbx_xml_doc_open(value->data.str, &doc, errmsg))
+		return FAIL;
+
+	ret = query_xpath_doc(doc, value, params, is_empty, errmsg);
+	zbx_xml_doc_free(doc);
+
+	return ret;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: execute xpath query                                               *
@@ -399,6 +473,24 @@ int	zbx_query_xpath_contents(zbx_variant_t *value, const char *params, int *is_e
 	return query_xpath(value, params, is_empty, errmsg);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: execute xpath query on parsed xml document                        *
+ *                                                                            *
+ * Parameters: doc    - [IN] xml document parsed by zbx_xml_doc_open()        *
+ *             value  - [OUT] the query result                                *
+ *             params - [IN] the operation parameters                         *
+ *             errmsg - [OUT] error message                                   *
+ *                                                                            *
+ * Return value: SUCCEED - the query was executed successfully                *
+ *               FAIL - otherwise                                             *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_query_xpath_doc(void *doc, zbx_variant_t *value, const char *params, char **errmsg)
+{
+	return query_xpath_doc(doc, value, params, NULL, errmsg);
+}
+
 #ifdef HAVE_LIBXML2
 
 #define XML_TEXT_NAME	"text"
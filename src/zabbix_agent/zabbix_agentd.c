@@ -273,7 +273,8 @@ static int	config_forks[ZBX_PROCESS_TYPE_COUNT] = {
 	0, /* ZBX_PROCESS_TYPE_CONNECTORWORKER*/
 	0, /* ZBX_PROCESS_TYPE_HTTPAGENT_POLLER */
 	0, /* ZBX_PROCESS_TYPE_AGENT_POLLER */
-	0 /* ZBX_PROCESS_TYPE_DBCONFIGWORKER */
+	0, /* ZBX_PROCESS_TYPE_DBCONFIGWORKER */
+	0 /* ZBX_PROCESS_TYPE_EXPORTWRITER */
 };
 
 static char	*config_file	= NULL;
@@ -179,6 +179,7 @@ ZBX_GET_CONFIG_VAR2(char *, const char *, zbx_config_pid_file, NULL)
 ZBX_GET_CONFIG_VAR2(char *, const char *, zbx_config_tmpdir, NULL)
 ZBX_GET_CONFIG_VAR2(char *, const char *, zbx_config_fping_location, NULL)
 ZBX_GET_CONFIG_VAR2(char *, const char *, zbx_config_fping6_location, NULL)
+ZBX_GET_CONFIG_VAR(int, zbx_config_native_ping, 0)
 
 static int	config_proxymode		= ZBX_PROXYMODE_ACTIVE;
 
@@ -227,7 +228,8 @@ int	CONFIG_FORKS[ZBX_PROCESS_TYPE_COUNT] = {
 	1, /* ZBX_PROCESS_TYPE_AGENT_POLLER */
 	1, /* ZBX_PROCESS_TYPE_SNMP_POLLER */
 	1, /* ZBX_PROCESS_TYPE_INTERNAL_POLLER */
-	0 /* ZBX_PROCESS_TYPE_DBCONFIGWORKER */
+	0, /* ZBX_PROCESS_TYPE_DBCONFIGWORKER */
+	0 /* ZBX_PROCESS_TYPE_EXPORTWRITER */
 };
 
 static int	get_config_forks(unsigned char process_type)
@@ -264,12 +266,15 @@ static int	config_vmware_timeout		= 10;
 static zbx_uint64_t	config_conf_cache_size		= 8 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_history_cache_size	= 16 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_history_index_cache_size	= 4 * ZBX_MEBIBYTE;
+static int		config_history_sync_batch_min	= 100;
+static int		config_history_sync_batch_max	= 1000;
 static zbx_uint64_t	config_trends_cache_size	= 0;
 static zbx_uint64_t	config_vmware_cache_size	= 8 * ZBX_MEBIBYTE;
 
 static int	config_unreachable_period		= 45;
 static int	config_unreachable_delay		= 15;
 static int	config_max_concurrent_checks_per_poller	= 1000;
+static int	config_snmp_async_get			= 1;
 
 static int	config_log_level		= LOG_LEVEL_WARNING;
 
@@ -625,6 +630,13 @@ static void	zbx_validate_config(ZBX_TASK_EX *task)
 		err = 1;
 	}
 
+	if (config_history_sync_batch_min > config_history_sync_batch_max)
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "\"HistorySyncBatchMin\" configuration parameter must not be greater than"
+				" \"HistorySyncBatchMax\"");
+		err = 1;
+	}
+
 	if (ZBX_PROXYMODE_ACTIVE == config_proxymode)
 	{
 		if (NULL != strchr(config_server, ','))
@@ -870,6 +882,10 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"HistoryIndexCacheSize",	&config_history_index_cache_size,	TYPE_UINT64,
 			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
+		{"HistorySyncBatchMin",		&config_history_sync_batch_min,		TYPE_INT,
+			PARM_OPT,	10,			100000},
+		{"HistorySyncBatchMax",		&config_history_sync_batch_max,		TYPE_INT,
+			PARM_OPT,	10,			100000},
 		{"HousekeepingFrequency",	&config_housekeeping_frequency,		TYPE_INT,
 			PARM_OPT,	0,			24},
 		{"ProxyLocalBuffer",		&config_proxy_local_buffer,		TYPE_INT,
@@ -890,6 +906,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	0,			0},
 		{"Fping6Location",		&zbx_config_fping6_location,		TYPE_STRING,
 			PARM_OPT,	0,			0},
+		{"NativePing",			&zbx_config_native_ping,		TYPE_INT,
+			PARM_OPT,	0,			1},
 		{"Timeout",			&zbx_config_timeout,			TYPE_INT,
 			PARM_OPT,	1,			30},
 		{"TrapperTimeout",		&zbx_config_trapper_timeout,		TYPE_INT,
@@ -1044,6 +1062,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	0,			1000},
 		{"StartSNMPPollers",		&CONFIG_FORKS[ZBX_PROCESS_TYPE_SNMP_POLLER],	TYPE_INT,
 			PARM_OPT,	0,			1000},
+		{"SNMPAsyncGet",		&config_snmp_async_get,	TYPE_INT,
+			PARM_OPT,	0,			1},
 		{"MaxConcurrentChecksPerPoller",	&config_max_concurrent_checks_per_poller,	TYPE_INT,
 			PARM_OPT,	1,			1000},
 		{NULL}
@@ -1159,7 +1179,8 @@ int	main(int argc, char **argv)
 		get_zbx_config_fping_location,
 		get_zbx_config_fping6_location,
 		get_zbx_config_tmpdir,
-		get_zbx_progname};
+		get_zbx_progname,
+		get_zbx_config_native_ping};
 
 	ZBX_TASK_EX			t = {ZBX_TASK_START};
 	char				ch;
@@ -1570,7 +1591,8 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 	}
 
 	if (SUCCEED != zbx_init_database_cache(get_zbx_program_type, zbx_sync_proxy_history, config_history_cache_size,
-			config_history_index_cache_size, &config_trends_cache_size, &error))
+			config_history_index_cache_size, &config_trends_cache_size, config_history_sync_batch_min,
+			config_history_sync_batch_max, &error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize database cache: %s", error);
 		zbx_free(error);
@@ -1585,7 +1607,7 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 	}
 
 	if (SUCCEED != zbx_init_configuration_cache(get_zbx_program_type, get_config_forks, config_conf_cache_size,
-			&error))
+			config_snmp_async_get, &error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize configuration cache: %s", error);
 		zbx_free(error);
@@ -28,9 +28,13 @@
 
 #define ZBX_DIAG_LLD_RULES		0x00000001
 #define ZBX_DIAG_LLD_VALUES		0x00000002
+#define ZBX_DIAG_LLD_STAGES		0x00000004
+#define ZBX_DIAG_LLD_IPC		0x00000008
 
 #define ZBX_DIAG_LLD_SIMPLE		(ZBX_DIAG_LLD_RULES | \
-					ZBX_DIAG_LLD_VALUES)
+					ZBX_DIAG_LLD_VALUES | \
+					ZBX_DIAG_LLD_STAGES | \
+					ZBX_DIAG_LLD_IPC)
 
 #define ZBX_DIAG_ALERTING_ALERTS	0x00000001
 
@@ -240,6 +244,28 @@ static void	diag_add_lld_items(struct zbx_json *json, const char *field, const z
 	zbx_json_close(json);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: add lld processing stage statistics to json data                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	diag_add_lld_stages(struct zbx_json *json, const zbx_lld_stage_stats_t *stats)
+{
+	zbx_json_addobject(json, "stages");
+	zbx_json_addint64(json, "processed", stats->rules_num);
+	zbx_json_addint64(json, "batches", stats->batches_num);
+	zbx_json_addint64(json, "skipped", stats->skipped_num);
+	zbx_json_addfloat(json, "prefetch", stats->time[ZBX_LLD_STAGE_PREFETCH]);
+	zbx_json_addfloat(json, "rows", stats->time[ZBX_LLD_STAGE_ROWS]);
+	zbx_json_addfloat(json, "items", stats->time[ZBX_LLD_STAGE_ITEMS]);
+	zbx_json_addfloat(json, "triggers", stats->time[ZBX_LLD_STAGE_TRIGGERS]);
+	zbx_json_addfloat(json, "graphs", stats->time[ZBX_LLD_STAGE_GRAPHS]);
+	zbx_json_addfloat(json, "hosts", stats->time[ZBX_LLD_STAGE_HOSTS]);
+	zbx_json_addfloat(json, "state", stats->time[ZBX_LLD_STAGE_STATE]);
+	zbx_json_addfloat(json, "refresh", stats->time[ZBX_LLD_STAGE_REFRESH]);
+	zbx_json_close(json);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: add requested lld manager diagnostic information to json data     *
@@ -262,6 +288,8 @@ static int	diag_add_lld_info(const struct zbx_json_parse *jp, struct zbx_json *j
 					{"", ZBX_DIAG_LLD_SIMPLE},
 					{"rules", ZBX_DIAG_LLD_RULES},
 					{"values", ZBX_DIAG_LLD_VALUES},
+					{"stages", ZBX_DIAG_LLD_STAGES},
+					{"ipc", ZBX_DIAG_LLD_IPC},
 					{NULL, 0}
 					};
 
@@ -273,10 +301,12 @@ static int	diag_add_lld_info(const struct zbx_json_parse *jp, struct zbx_json *j
 
 		if (0 != (fields & ZBX_DIAG_LLD_SIMPLE))
 		{
-			zbx_uint64_t	values_num, items_num;
+			zbx_uint64_t		values_num, items_num;
+			zbx_lld_stage_stats_t	stats;
+			zbx_ipc_stats_t		ipc_stats;
 
 			time1 = zbx_time();
-			if (FAIL == (ret = zbx_lld_get_diag_stats(&items_num, &values_num, error)))
+			if (FAIL == (ret = zbx_lld_get_diag_stats(&items_num, &values_num, &stats, &ipc_stats, error)))
 				goto out;
 			time2 = zbx_time();
 			time_total += time2 - time1;
@@ -285,6 +315,10 @@ static int	diag_add_lld_info(const struct zbx_json_parse *jp, struct zbx_json *j
 				zbx_json_addint64(json, "rules", items_num);
 			if (0 != (fields & ZBX_DIAG_LLD_VALUES))
 				zbx_json_addint64(json, "values", values_num);
+			if (0 != (fields & ZBX_DIAG_LLD_STAGES))
+				diag_add_lld_stages(json, &stats);
+			if (0 != (fields & ZBX_DIAG_LLD_IPC))
+				zbx_diag_add_ipc_stats(json, "ipc", &ipc_stats);
 		}
 
 		if (0 != tops.values_num)
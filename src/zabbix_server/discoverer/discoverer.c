@@ -35,6 +35,7 @@
 #include "zbxtimekeeper.h"
 #include "discoverer_queue.h"
 #include "discoverer_job.h"
+#include "discoverer_async.h"
 #include "zbx_discoverer_constants.h"
 #include "zbxpoller.h"
 
@@ -93,10 +94,12 @@ typedef struct
 zbx_discoverer_worker_t;
 
 ZBX_PTR_VECTOR_DECL(discoverer_jobs_ptr, zbx_discoverer_job_t*)
+ZBX_PTR_VECTOR_DECL(discoverer_tasks_ptr, zbx_discoverer_task_t*)
 
 ZBX_PTR_VECTOR_IMPL(discoverer_services_ptr, zbx_discoverer_dservice_t*)
 ZBX_PTR_VECTOR_IMPL(discoverer_results_ptr, zbx_discoverer_results_t*)
 ZBX_PTR_VECTOR_IMPL(discoverer_jobs_ptr, zbx_discoverer_job_t*)
+ZBX_PTR_VECTOR_IMPL(discoverer_tasks_ptr, zbx_discoverer_task_t*)
 
 typedef struct
 {
@@ -107,6 +110,7 @@ typedef struct
 
 	zbx_hashset_t				incomplete_checks_count;
 	zbx_hashset_t				results;
+	zbx_hashset_t				rule_stats;
 	pthread_mutex_t				results_lock;
 
 	zbx_timekeeper_t			*timekeeper;
@@ -889,6 +893,10 @@ static int	process_results(zbx_discoverer_manager_t *manager, zbx_vector_uint64_
 	zbx_hashset_clear(incomplete_druleids);
 
 	pthread_mutex_lock(&manager->results_lock);
+
+	for (i = 0; i < del_druleids->values_num; i++)
+		zbx_hashset_remove(&manager->rule_stats, &del_druleids->values[i]);
+
 	zbx_hashset_iter_reset(&manager->results, &iter);
 
 	while (NULL != (result = (zbx_discoverer_results_t *)zbx_hashset_iter_next(&iter)))
@@ -1344,37 +1352,26 @@ static void	discoverer_net_check_icmp(zbx_uint64_t druleid, zbx_discoverer_task_
 	zbx_vector_discoverer_results_ptr_destroy(&results);
 }
 
-static void	discoverer_net_check_common(zbx_uint64_t druleid, zbx_discoverer_task_t *task)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: add services discovered by the task to discovery results          *
+ *                                                                            *
+ * Parameters: druleid      - [IN]                                            *
+ *             task         - [IN]                                            *
+ *             services     - [IN] task services, one for each task check     *
+ *             services_num - [IN]                                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	discoverer_results_add(zbx_uint64_t druleid, const zbx_discoverer_task_t *task,
+		zbx_discoverer_dservice_t **services, int services_num)
 {
-	int					i;
-	char					dns[ZBX_INTERFACE_DNS_LEN_MAX];
-	zbx_vector_discoverer_services_ptr_t	services;
-	zbx_discoverer_results_t		*result = NULL, result_cmp;
-	char					*value = NULL;
-	size_t					value_alloc = 128;
+	char				dns[ZBX_INTERFACE_DNS_LEN_MAX];
+	zbx_discoverer_results_t	*result = NULL, result_cmp;
+	int				i;
 
 	if (1 == task->resolve_dns)
 		zbx_gethost_by_ip(task->ip, dns, sizeof(dns));
 
-	zbx_vector_discoverer_services_ptr_create(&services);
-
-	value = (char *)zbx_malloc(value, value_alloc);
-
-	for (i = 0; i < task->dchecks.values_num; i++)
-	{
-		zbx_dc_dcheck_t			*dcheck = (zbx_dc_dcheck_t*)task->dchecks.values[i];
-		zbx_discoverer_dservice_t	*service;
-
-		service = result_dservice_create(task, dcheck);
-		service->status = (SUCCEED == discover_service(dcheck, task->ip, task->port, &value, &value_alloc)) ?
-				DOBJECT_STATUS_UP : DOBJECT_STATUS_DOWN;
-		zbx_strlcpy_utf8(service->value, value, ZBX_MAX_DISCOVERED_VALUE_SIZE);
-
-		zbx_vector_discoverer_services_ptr_append(&services, service);
-	}
-
-	zbx_free(value);
-
 	result_cmp.druleid = druleid;
 	result_cmp.ip = task->ip;
 
@@ -1383,7 +1380,9 @@ static void	discoverer_net_check_common(zbx_uint64_t druleid, zbx_discoverer_tas
 	if (FAIL == discoverer_check_count_decrease(&dmanager.incomplete_checks_count, druleid, task->ip,
 			(zbx_uint64_t)task->dchecks.values_num))
 	{
-		zbx_vector_discoverer_services_ptr_clear_ext(&services, service_free);
+		for (i = 0; i < services_num; i++)
+			service_free(services[i]);
+
 		goto out;
 	}
 
@@ -1401,11 +1400,203 @@ static void	discoverer_net_check_common(zbx_uint64_t druleid, zbx_discoverer_tas
 	if (1 == task->resolve_dns)
 		result->dnsname = zbx_strdup(result->dnsname, dns);
 
-	zbx_vector_discoverer_services_ptr_append_array(&result->services, services.values, services.values_num);
+	zbx_vector_discoverer_services_ptr_append_array(&result->services, services, services_num);
 out:
 	pthread_mutex_unlock(&dmanager.results_lock);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: perform checks of tasks with single IP address                    *
+ *                                                                            *
+ * Parameters: druleid         - [IN]                                         *
+ *             tasks           - [IN] tasks of the same discovery rule        *
+ *             concurrency_max - [IN] maximum number of asynchronous checks   *
+ *                                    in progress                             *
+ *             async_sec       - [OUT] time spent performing asynchronous     *
+ *                                     checks                                 *
+ *                                                                            *
+ * Return value: number of checks performed by asynchronous engine            *
+ *                                                                            *
+ * Comments: Checks supported by asynchronous engine are performed at once    *
+ *           using single event loop, other checks are performed              *
+ *           sequentially afterwards.                                         *
+ *                                                                            *
+ ******************************************************************************/
+static int	discoverer_net_check_common(zbx_uint64_t druleid, zbx_vector_discoverer_tasks_ptr_t *tasks,
+		int concurrency_max, double *async_sec)
+{
+	int					i, j, k, checks_num = 0, async_num = 0;
+	zbx_vector_discoverer_services_ptr_t	services;
+	zbx_discoverer_async_check_t		*async_checks;
+	zbx_discoverer_dservice_t		**async_services;
+	char					*value = NULL, *error = NULL;
+	size_t					value_alloc = 128;
+
+	for (i = 0; i < tasks->values_num; i++)
+		checks_num += tasks->values[i]->dchecks.values_num;
+
+	zbx_vector_discoverer_services_ptr_create(&services);
+	zbx_vector_discoverer_services_ptr_reserve(&services, (size_t)checks_num);
+
+	async_checks = (zbx_discoverer_async_check_t *)zbx_malloc(NULL,
+			sizeof(zbx_discoverer_async_check_t) * (size_t)checks_num);
+	async_services = (zbx_discoverer_dservice_t **)zbx_malloc(NULL,
+			sizeof(zbx_discoverer_dservice_t *) * (size_t)checks_num);
+
+	for (i = 0; i < tasks->values_num; i++)
+	{
+		zbx_discoverer_task_t	*task = tasks->values[i];
+
+		for (j = 0; j < task->dchecks.values_num; j++)
+		{
+			zbx_dc_dcheck_t			*dcheck = (zbx_dc_dcheck_t*)task->dchecks.values[j];
+			zbx_discoverer_dservice_t	*service;
+
+			service = result_dservice_create(task, dcheck);
+			service->status = DOBJECT_STATUS_DOWN;
+			*service->value = '\0';
+			zbx_vector_discoverer_services_ptr_append(&services, service);
+
+			if (SUCCEED != discoverer_async_check_supported(dcheck))
+				continue;
+
+			async_checks[async_num].dcheck = dcheck;
+			async_checks[async_num].ip = task->ip;
+			async_checks[async_num].port = task->port;
+			async_checks[async_num].status = DOBJECT_STATUS_DOWN;
+			async_checks[async_num].value = NULL;
+			async_services[async_num++] = service;
+		}
+	}
+
+	*async_sec = zbx_time();
+
+	if (0 != async_num && SUCCEED != discoverer_async_checks_process(async_checks, async_num, concurrency_max,
+			source_ip, &error))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot perform asynchronous discovery checks: %s", error);
+		zbx_free(error);
+	}
+
+	*async_sec = zbx_time() - *async_sec;
+
+	for (i = 0; i < async_num; i++)
+	{
+		async_services[i]->status = async_checks[i].status;
+
+		if (NULL != async_checks[i].value)
+		{
+			zbx_strlcpy_utf8(async_services[i]->value, async_checks[i].value,
+					ZBX_MAX_DISCOVERED_VALUE_SIZE);
+			zbx_free(async_checks[i].value);
+		}
+	}
+
+	zbx_free(async_services);
+	zbx_free(async_checks);
+
+	value = (char *)zbx_malloc(value, value_alloc);
+
+	for (i = 0, k = 0; i < tasks->values_num; i++)
+	{
+		zbx_discoverer_task_t	*task = tasks->values[i];
+
+		for (j = 0; j < task->dchecks.values_num; j++, k++)
+		{
+			zbx_dc_dcheck_t			*dcheck = (zbx_dc_dcheck_t*)task->dchecks.values[j];
+			zbx_discoverer_dservice_t	*service = services.values[k];
+
+			if (SUCCEED == discoverer_async_check_supported(dcheck))
+				continue;
+
+			service->status = (SUCCEED == discover_service(dcheck, task->ip, task->port, &value,
+					&value_alloc)) ? DOBJECT_STATUS_UP : DOBJECT_STATUS_DOWN;
+			zbx_strlcpy_utf8(service->value, value, ZBX_MAX_DISCOVERED_VALUE_SIZE);
+		}
+	}
+
+	zbx_free(value);
+
+	for (i = 0, k = 0; i < tasks->values_num; i++)
+	{
+		zbx_discoverer_task_t	*task = tasks->values[i];
+
+		discoverer_results_add(druleid, task, services.values + k, task->dchecks.values_num);
+		k += task->dchecks.values_num;
+	}
 
 	zbx_vector_discoverer_services_ptr_destroy(&services);
+
+	return async_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if task checks can be performed by asynchronous engine      *
+ *                                                                            *
+ ******************************************************************************/
+static int	discoverer_task_is_async(const zbx_discoverer_task_t *task)
+{
+	int	i;
+
+	if (NULL != task->ips)
+		return FAIL;
+
+	for (i = 0; i < task->dchecks.values_num; i++)
+	{
+		if (SUCCEED != discoverer_async_check_supported(task->dchecks.values[i]))
+			return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if task has checks performed by asynchronous engine         *
+ *                                                                            *
+ ******************************************************************************/
+static int	discoverer_task_has_async_checks(const zbx_discoverer_task_t *task)
+{
+	int	i;
+
+	for (i = 0; i < task->dchecks.values_num; i++)
+	{
+		if (SUCCEED == discoverer_async_check_supported(task->dchecks.values[i]))
+			return SUCCEED;
+	}
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: update discovery rule check throughput statistics                 *
+ *                                                                            *
+ * Parameters: druleid    - [IN]                                              *
+ *             checks_num - [IN] number of completed checks                   *
+ *             sec        - [IN] time spent performing the checks             *
+ *                                                                            *
+ ******************************************************************************/
+static void	discoverer_rule_stats_add(zbx_uint64_t druleid, zbx_uint64_t checks_num, double sec)
+{
+	zbx_discovery_rule_stats_t	*stats;
+
+	pthread_mutex_lock(&dmanager.results_lock);
+
+	if (NULL == (stats = (zbx_discovery_rule_stats_t *)zbx_hashset_search(&dmanager.rule_stats, &druleid)))
+	{
+		zbx_discovery_rule_stats_t	stats_local = {.druleid = druleid};
+
+		stats = (zbx_discovery_rule_stats_t *)zbx_hashset_insert(&dmanager.rule_stats, &stats_local,
+				sizeof(stats_local));
+	}
+
+	stats->checks_num += checks_num;
+	stats->time += sec;
+
+	pthread_mutex_unlock(&dmanager.results_lock);
 }
 
 static void	*discoverer_worker_entry(void *net_check_worker)
@@ -1414,6 +1605,7 @@ static void	*discoverer_worker_entry(void *net_check_worker)
 	sigset_t			mask;
 	zbx_discoverer_worker_t		*worker = (zbx_discoverer_worker_t*)net_check_worker;
 	zbx_discoverer_queue_t		*queue = worker->queue;
+	zbx_vector_discoverer_tasks_ptr_t	tasks;
 
 	zabbix_log(LOG_LEVEL_INFORMATION, "thread started [%s #%d]",
 			get_process_type_string(ZBX_PROCESS_TYPE_DISCOVERER), worker->worker_id);
@@ -1433,6 +1625,8 @@ static void	*discoverer_worker_entry(void *net_check_worker)
 	zbx_init_icmpping_env(get_process_type_string(ZBX_PROCESS_TYPE_DISCOVERER), worker->worker_id);
 	worker->stop = 0;
 
+	zbx_vector_discoverer_tasks_ptr_create(&tasks);
+
 	discoverer_queue_lock(queue);
 	discoverer_queue_register_worker(queue);
 
@@ -1443,8 +1637,8 @@ static void	*discoverer_worker_entry(void *net_check_worker)
 
 		if (NULL != (job = discoverer_queue_pop(queue)))
 		{
-			int			worker_max;
-			zbx_uint64_t		druleid;
+			int			i, worker_max, concurrency_max, checks_used = 0;
+			zbx_uint64_t		druleid, checks_num = 0;
 			zbx_discoverer_task_t	*task;
 
 			if (SUCCEED != zbx_list_pop(&job->tasks, (void*)&task))
@@ -1457,10 +1651,36 @@ static void	*discoverer_worker_entry(void *net_check_worker)
 				continue;
 			}
 
+			zbx_vector_discoverer_tasks_ptr_append(&tasks, task);
+
+			/* Rule concurrency limits asynchronous and ICMP checks. Synchronous checks occupy */
+			/* the worker, so they are limited by the number of workers instead.               */
+			if (SUCCEED == discoverer_task_is_async(task))
+			{
+				/* take more tasks of the same rule to be checked by single event loop */
+				while (DISCOVERER_ASYNC_CHECKS_MAX > tasks.values_num && (0 == job->workers_max ||
+						job->checks_used + tasks.values_num < job->workers_max) &&
+						SUCCEED == zbx_list_peek(&job->tasks, (void*)&task) &&
+						SUCCEED == discoverer_task_is_async(task))
+				{
+					(void)zbx_list_pop(&job->tasks, (void*)&task);
+					zbx_vector_discoverer_tasks_ptr_append(&tasks, task);
+				}
+
+				task = tasks.values[0];
+				checks_used = tasks.values_num;
+			}
+			else if (NULL != task->ips || SUCCEED == discoverer_task_has_async_checks(task))
+				checks_used = 1;
+
+			for (i = 0; i < tasks.values_num; i++)
+				checks_num += discoverer_task_check_count_get(tasks.values[i]);
+
 			job->workers_used++;
-			queue->pending_checks_count -= discoverer_task_check_count_get(task);
+			job->checks_used += checks_used;
+			queue->pending_checks_count -= checks_num;
 
-			if (0 == job->workers_max || job->workers_used != job->workers_max)
+			if (0 == job->workers_max || job->checks_used < job->workers_max)
 			{
 				discoverer_queue_push(queue, job);
 				discoverer_queue_notify(queue);
@@ -1478,19 +1698,30 @@ static void	*discoverer_worker_entry(void *net_check_worker)
 			zbx_timekeeper_update(worker->timekeeper, worker->worker_id - 1, ZBX_PROCESS_STATE_BUSY);
 
 			if (NULL == task->ips)
-				discoverer_net_check_common(druleid, task);
+			{
+				double	sec;
+				int	async_num;
+
+				concurrency_max = 0 != worker_max ? checks_used : DISCOVERER_ASYNC_CHECKS_MAX;
+				async_num = discoverer_net_check_common(druleid, &tasks, concurrency_max, &sec);
+
+				/* throughput statistics cover only checks performed by asynchronous engine */
+				if (0 != async_num)
+					discoverer_rule_stats_add(druleid, (zbx_uint64_t)async_num, sec);
+			}
 			else
 				discoverer_net_check_icmp(druleid, task, worker_max);
 
-			discoverer_task_free(task);
+			zbx_vector_discoverer_tasks_ptr_clear_ext(&tasks, discoverer_task_free);
 			zbx_timekeeper_update(worker->timekeeper, worker->worker_id - 1, ZBX_PROCESS_STATE_IDLE);
 
 			/* proceed to the next job */
 
 			discoverer_queue_lock(queue);
 			job->workers_used--;
+			job->checks_used -= checks_used;
 
-			if (DISCOVERER_JOB_STATUS_WAITING == job->status)
+			if (DISCOVERER_JOB_STATUS_WAITING == job->status && job->checks_used < job->workers_max)
 			{
 				job->status = DISCOVERER_JOB_STATUS_QUEUED;
 				discoverer_queue_push(queue, job);
@@ -1514,6 +1745,8 @@ static void	*discoverer_worker_entry(void *net_check_worker)
 	discoverer_queue_deregister_worker(queue);
 	discoverer_queue_unlock(queue);
 
+	zbx_vector_discoverer_tasks_ptr_destroy(&tasks);
+
 	zabbix_log(LOG_LEVEL_INFORMATION, "thread stopped [%s #%d]",
 			get_process_type_string(ZBX_PROCESS_TYPE_DISCOVERER), worker->worker_id);
 
@@ -1615,6 +1848,7 @@ static int	discoverer_manager_init(zbx_discoverer_manager_t *manager, int worker
 	discoverer_libs_init();
 
 	zbx_hashset_create(&manager->results, 1, discoverer_result_hash, discoverer_result_compare);
+	zbx_hashset_create(&manager->rule_stats, 1, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 	zbx_hashset_create(&manager->incomplete_checks_count, 1, discoverer_check_count_hash,
 			discoverer_check_count_compare);
 
@@ -1664,6 +1898,7 @@ out:
 		discoverer_queue_destroy(&manager->queue);
 
 		zbx_hashset_destroy(&manager->results);
+		zbx_hashset_destroy(&manager->rule_stats);
 		zbx_hashset_destroy(&manager->incomplete_checks_count);
 		zbx_vector_discoverer_jobs_ptr_destroy(&manager->job_refs);
 
@@ -1708,6 +1943,7 @@ static void	discoverer_manager_free(zbx_discoverer_manager_t *manager)
 		results_clear(result);
 
 	zbx_hashset_destroy(&manager->results);
+	zbx_hashset_destroy(&manager->rule_stats);
 
 	pthread_mutex_destroy(&manager->results_lock);
 
@@ -1724,18 +1960,34 @@ static void	discoverer_manager_free(zbx_discoverer_manager_t *manager)
  ******************************************************************************/
 static void	discoverer_reply_usage_stats(zbx_discoverer_manager_t *manager, zbx_ipc_client_t *client)
 {
-	zbx_vector_dbl_t	usage;
-	unsigned char		*data;
-	zbx_uint32_t		data_len;
+	zbx_vector_dbl_t			usage;
+	zbx_vector_discovery_rule_stats_t	rule_stats;
+	zbx_discovery_rule_stats_t		*stats;
+	zbx_hashset_iter_t			iter;
+	unsigned char				*data;
+	zbx_uint32_t				data_len;
 
 	zbx_vector_dbl_create(&usage);
 	(void)zbx_timekeeper_get_usage(manager->timekeeper, &usage);
 
-	data_len = zbx_discovery_pack_usage_stats(&data, &usage,  manager->workers_num);
+	zbx_vector_discovery_rule_stats_create(&rule_stats);
+
+	pthread_mutex_lock(&manager->results_lock);
+
+	zbx_vector_discovery_rule_stats_reserve(&rule_stats, (size_t)manager->rule_stats.num_data);
+	zbx_hashset_iter_reset(&manager->rule_stats, &iter);
+
+	while (NULL != (stats = (zbx_discovery_rule_stats_t *)zbx_hashset_iter_next(&iter)))
+		zbx_vector_discovery_rule_stats_append(&rule_stats, *stats);
+
+	pthread_mutex_unlock(&manager->results_lock);
+
+	data_len = zbx_discovery_pack_usage_stats(&data, &usage,  manager->workers_num, &rule_stats);
 
 	zbx_ipc_client_send(client, ZBX_IPC_DISCOVERER_USAGE_STATS_RESULT, data, data_len);
 
 	zbx_free(data);
+	zbx_vector_discovery_rule_stats_destroy(&rule_stats);
 	zbx_vector_dbl_destroy(&usage);
 }
 
@@ -0,0 +1,492 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "discoverer_async.h"
+
+#include "zbxasyncpoller.h"
+#include "zbxcomms.h"
+#include "zbxagentget.h"
+#include "zbxsysinfo.h"
+#include "zbx_discoverer_constants.h"
+
+#include <event2/event.h>
+#include <event2/dns.h>
+
+#define DISCOVERER_EXPECT_OK		0
+#define DISCOVERER_EXPECT_FAIL		1
+#define DISCOVERER_EXPECT_IGNORE	2
+
+typedef enum
+{
+	DISCOVERER_ASYNC_STEP_CONNECT_INIT = 0,
+	DISCOVERER_ASYNC_STEP_CONNECT_WAIT,
+	DISCOVERER_ASYNC_STEP_SEND,
+	DISCOVERER_ASYNC_STEP_RECV
+}
+zbx_discoverer_async_step_t;
+
+typedef struct
+{
+	zbx_discoverer_async_check_t	*check;
+	zbx_discoverer_async_step_t	step;
+	zbx_socket_t			s;
+	zbx_tcp_send_context_t		tcp_send_context;
+	zbx_tcp_recv_context_t		tcp_recv_context;
+	char				line[MAX_STRING_LEN];
+	size_t				line_offset;
+	const char			*source_ip;
+	int				*checks_running;
+}
+zbx_discoverer_async_context_t;
+
+/* validation functions for service checks, see net.tcp.service implementation */
+static int	validate_smtp(const char *line)
+{
+	if (0 == strncmp(line, "220", 3))
+	{
+		if ('-' == line[3])
+			return DISCOVERER_EXPECT_IGNORE;
+
+		if ('\0' == line[3] || ' ' == line[3])
+			return DISCOVERER_EXPECT_OK;
+	}
+
+	return DISCOVERER_EXPECT_FAIL;
+}
+
+static int	validate_ftp(const char *line)
+{
+	if (0 == strncmp(line, "220 ", 4))
+		return DISCOVERER_EXPECT_OK;
+
+	return DISCOVERER_EXPECT_IGNORE;
+}
+
+static int	validate_pop(const char *line)
+{
+	return 0 == strncmp(line, "+OK", 3) ? DISCOVERER_EXPECT_OK : DISCOVERER_EXPECT_FAIL;
+}
+
+static int	validate_nntp(const char *line)
+{
+	if (0 == strncmp(line, "200", 3) || 0 == strncmp(line, "201", 3))
+		return DISCOVERER_EXPECT_OK;
+
+	return DISCOVERER_EXPECT_FAIL;
+}
+
+static int	validate_imap(const char *line)
+{
+	return 0 == strncmp(line, "* OK", 4) ? DISCOVERER_EXPECT_OK : DISCOVERER_EXPECT_FAIL;
+}
+
+static int	validate_ssh(const char *line)
+{
+	int	major, minor;
+
+	/* parse line for SSH identification string as per RFC 4253, section 4.2 */
+	if (2 == sscanf(line, "SSH-%d.%d-%*s", &major, &minor))
+		return DISCOVERER_EXPECT_OK;
+
+	return DISCOVERER_EXPECT_IGNORE;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if discovery check can be performed asynchronously          *
+ *                                                                            *
+ * Parameters: dcheck - [IN]                                                  *
+ *                                                                            *
+ * Return value: SUCCEED - check is supported by asynchronous engine          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	discoverer_async_check_supported(const zbx_dc_dcheck_t *dcheck)
+{
+	switch (dcheck->type)
+	{
+		case SVC_SSH:
+		case SVC_SMTP:
+		case SVC_FTP:
+		case SVC_HTTP:
+		case SVC_POP:
+		case SVC_NNTP:
+		case SVC_IMAP:
+		case SVC_TCP:
+		case SVC_AGENT:
+			return SUCCEED;
+		default:
+			return FAIL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get service response validation function and the string to send   *
+ *          before closing connection                                         *
+ *                                                                            *
+ * Parameters: type        - [IN] service type                                *
+ *             sendtoclose - [OUT]                                            *
+ *                                                                            *
+ * Return value: validation function or NULL if connection check is enough    *
+ *                                                                            *
+ ******************************************************************************/
+static int	(*service_get_validator(unsigned char type, const char **sendtoclose))(const char *)
+{
+	*sendtoclose = "QUIT\r\n";
+
+	switch (type)
+	{
+		case SVC_SMTP:
+			return validate_smtp;
+		case SVC_FTP:
+			return validate_ftp;
+		case SVC_POP:
+			return validate_pop;
+		case SVC_NNTP:
+			return validate_nntp;
+		case SVC_IMAP:
+			*sendtoclose = "a1 LOGOUT\r\n";
+			return validate_imap;
+		case SVC_SSH:
+			*sendtoclose = NULL;
+			return validate_ssh;
+		default:
+			*sendtoclose = NULL;
+			return NULL;
+	}
+}
+
+static zbx_async_task_state_t	get_task_state_for_event(short event)
+{
+	if (POLLIN & event)
+		return ZBX_ASYNC_TASK_READ;
+
+	if (POLLOUT & event)
+		return ZBX_ASYNC_TASK_WRITE;
+
+	return ZBX_ASYNC_TASK_STOP;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: read service response and validate received lines                 *
+ *                                                                            *
+ * Parameters: context - [IN]                                                 *
+ *                                                                            *
+ * Return value: DISCOVERER_EXPECT_OK     - service responded as expected     *
+ *               DISCOVERER_EXPECT_FAIL   - unexpected response or error      *
+ *               DISCOVERER_EXPECT_IGNORE - more data must be read            *
+ *                                                                            *
+ ******************************************************************************/
+static int	service_recv_lines(zbx_discoverer_async_context_t *context)
+{
+	int		(*validate)(const char *);
+	const char	*sendtoclose;
+	char		*line, *eol;
+	ssize_t		n;
+	short		events = 0;
+	int		ret = DISCOVERER_EXPECT_IGNORE;
+
+	validate = service_get_validator(context->check->dcheck->type, &sendtoclose);
+
+	if (ZBX_PROTO_ERROR == (n = zbx_tcp_read(&context->s, context->line + context->line_offset,
+			sizeof(context->line) - context->line_offset - 1, &events)))
+	{
+		return 0 != (POLLIN & events) ? DISCOVERER_EXPECT_IGNORE : DISCOVERER_EXPECT_FAIL;
+	}
+
+	if (0 == n)
+		return DISCOVERER_EXPECT_FAIL;
+
+	context->line_offset += (size_t)n;
+	context->line[context->line_offset] = '\0';
+
+	for (line = context->line; NULL != (eol = strchr(line, '\n')); line = eol + 1)
+	{
+		*eol = '\0';
+
+		if (eol != line && '\r' == eol[-1])
+			eol[-1] = '\0';
+
+		if (DISCOVERER_EXPECT_IGNORE != (ret = validate(line)))
+			break;
+	}
+
+	/* validate line exceeding the buffer as is */
+	if (DISCOVERER_EXPECT_IGNORE == ret && line == context->line &&
+			sizeof(context->line) - 1 == context->line_offset)
+	{
+		if (DISCOVERER_EXPECT_IGNORE == (ret = validate(line)))
+			line += context->line_offset;
+	}
+
+	if (DISCOVERER_EXPECT_FAIL == ret)
+		zabbix_log(LOG_LEVEL_DEBUG, "TCP expect content error, received [%s]", line);
+
+	if (DISCOVERER_EXPECT_OK == ret)
+	{
+		char	buf[MAX_STRING_LEN];
+		int	major, minor;
+
+		if (SVC_SSH == context->check->dcheck->type && 2 == sscanf(line, "SSH-%d.%d-%*s", &major, &minor))
+		{
+			zbx_snprintf(buf, sizeof(buf), "SSH-%d.%d-zabbix_agent\r\n", major, minor);
+			sendtoclose = buf;
+		}
+
+		/* the connection is closed right after, so sending is done on best effort basis */
+		if (NULL != sendtoclose)
+			(void)zbx_tcp_write(&context->s, sendtoclose, strlen(sendtoclose), &events);
+	}
+	else if (DISCOVERER_EXPECT_IGNORE == ret)
+	{
+		context->line_offset = (size_t)(context->line + context->line_offset - line);
+		memmove(context->line, line, context->line_offset);
+	}
+
+	return ret;
+}
+
+static int	discoverer_async_task_process(short event, void *data, int *fd, const char *addr, char *dnserr)
+{
+	zbx_discoverer_async_context_t	*context = (zbx_discoverer_async_context_t *)data;
+	zbx_discoverer_async_check_t	*check = context->check;
+	zbx_async_task_state_t		state;
+	ssize_t				received_len;
+	short				event_new;
+	int				errnum = 0, version = 0;
+	socklen_t			optlen = sizeof(int);
+	const char			*sendtoclose;
+	char				**pvalue;
+	AGENT_RESULT			result;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() step:%d event:%d ip:'%s' port:%hu", __func__, (int)context->step, event,
+			check->ip, check->port);
+
+	if (0 != (event & EV_TIMEOUT))
+	{
+		if (NULL != dnserr)
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "discovery check error: cannot resolve address: %s", dnserr);
+			return ZBX_ASYNC_TASK_STOP;
+		}
+
+		zabbix_log(LOG_LEVEL_DEBUG, "discovery check of [[%s]:%hu] timed out", check->ip, check->port);
+
+		if (DISCOVERER_ASYNC_STEP_CONNECT_INIT == context->step)
+			return ZBX_ASYNC_TASK_STOP;
+
+		goto stop;
+	}
+
+	switch (context->step)
+	{
+		case DISCOVERER_ASYNC_STEP_CONNECT_INIT:
+			context->step = DISCOVERER_ASYNC_STEP_CONNECT_WAIT;
+
+			if (SUCCEED != zbx_socket_connect(&context->s, SOCK_STREAM, context->source_ip, addr,
+					check->port, check->dcheck->timeout))
+			{
+				zabbix_log(LOG_LEVEL_DEBUG, "discovery check error: %s", zbx_socket_strerror());
+				return ZBX_ASYNC_TASK_STOP;
+			}
+
+			*fd = context->s.socket;
+
+			return ZBX_ASYNC_TASK_WRITE;
+		case DISCOVERER_ASYNC_STEP_CONNECT_WAIT:
+			if (0 == getsockopt(context->s.socket, SOL_SOCKET, SO_ERROR, &errnum, &optlen) && 0 != errnum)
+			{
+				zabbix_log(LOG_LEVEL_DEBUG, "discovery check error: cannot establish TCP connection to"
+						" [[%s]:%hu]: %s", check->ip, check->port, zbx_strerror(errnum));
+				break;
+			}
+
+			if (SVC_AGENT != check->dcheck->type)
+			{
+				if (NULL == service_get_validator(check->dcheck->type, &sendtoclose))
+				{
+					check->status = DOBJECT_STATUS_UP;
+					break;
+				}
+
+				context->step = DISCOVERER_ASYNC_STEP_RECV;
+
+				return ZBX_ASYNC_TASK_READ;
+			}
+
+			zbx_tcp_send_context_init(check->dcheck->key_, strlen(check->dcheck->key_), 0, ZBX_TCP_PROTOCOL,
+					&context->tcp_send_context);
+			context->step = DISCOVERER_ASYNC_STEP_SEND;
+			ZBX_FALLTHROUGH;
+		case DISCOVERER_ASYNC_STEP_SEND:
+			if (SUCCEED != zbx_tcp_send_context(&context->s, &context->tcp_send_context, &event_new))
+			{
+				if (ZBX_ASYNC_TASK_STOP != (state = get_task_state_for_event(event_new)))
+					return state;
+
+				zabbix_log(LOG_LEVEL_DEBUG, "discovery check error: cannot send: %s",
+						zbx_socket_strerror());
+				break;
+			}
+
+			context->step = DISCOVERER_ASYNC_STEP_RECV;
+			zbx_tcp_recv_context_init(&context->s, &context->tcp_recv_context, 0);
+
+			return ZBX_ASYNC_TASK_READ;
+		case DISCOVERER_ASYNC_STEP_RECV:
+			if (SVC_AGENT != check->dcheck->type)
+			{
+				switch (service_recv_lines(context))
+				{
+					case DISCOVERER_EXPECT_OK:
+						check->status = DOBJECT_STATUS_UP;
+						break;
+					case DISCOVERER_EXPECT_IGNORE:
+						return ZBX_ASYNC_TASK_READ;
+				}
+
+				break;
+			}
+
+			if (FAIL == (received_len = zbx_tcp_recv_context(&context->s, &context->tcp_recv_context, 0,
+					&event_new)))
+			{
+				if (ZBX_ASYNC_TASK_STOP != (state = get_task_state_for_event(event_new)))
+					return state;
+
+				zabbix_log(LOG_LEVEL_DEBUG, "discovery check error: cannot read response: %s",
+						zbx_socket_strerror());
+				break;
+			}
+
+			zbx_init_agent_result(&result);
+
+			if (SUCCEED == zbx_agent_handle_response(context->s.buffer, context->s.read_bytes, received_len,
+					check->ip, &result, &version) && NULL != (pvalue = ZBX_GET_TEXT_RESULT(&result)))
+			{
+				check->value = zbx_strdup(check->value, *pvalue);
+				check->status = DOBJECT_STATUS_UP;
+			}
+			else if (ZBX_ISSET_MSG(&result))
+			{
+				zabbix_log(LOG_LEVEL_DEBUG, "discovery: item [%s] error: %s", check->dcheck->key_,
+						result.msg);
+			}
+
+			zbx_free_agent_result(&result);
+			break;
+	}
+stop:
+	zbx_tcp_close(&context->s);
+
+	return ZBX_ASYNC_TASK_STOP;
+}
+
+static void	discoverer_async_task_clear(void *data)
+{
+	zbx_discoverer_async_context_t	*context = (zbx_discoverer_async_context_t *)data;
+
+	zbx_tcp_send_context_clear(&context->tcp_send_context);
+	(*context->checks_running)--;
+
+	zbx_free(context);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: perform discovery checks asynchronously                           *
+ *                                                                            *
+ * Parameters: checks          - [IN/OUT] checks to perform, status and value *
+ *                                        are set on return                   *
+ *             checks_num      - [IN]                                         *
+ *             concurrency_max - [IN] maximum number of checks in progress    *
+ *             source_ip       - [IN]                                         *
+ *             error           - [OUT]                                        *
+ *                                                                            *
+ * Return value: SUCCEED - checks were performed                              *
+ *               FAIL    - event loop failure, status of checks not yet       *
+ *                         performed is left unchanged                        *
+ *                                                                            *
+ * Comments: all checks share single event loop, so processing of the batch   *
+ *           takes about as long as its slowest check                         *
+ *                                                                            *
+ ******************************************************************************/
+int	discoverer_async_checks_process(zbx_discoverer_async_check_t *checks, int checks_num, int concurrency_max,
+		const char *source_ip, char **error)
+{
+	struct event_base	*base;
+	struct evdns_base	*dnsbase;
+	int			i = 0, checks_running = 0, ret = FAIL;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() checks_num:%d concurrency_max:%d", __func__, checks_num,
+			concurrency_max);
+
+	if (NULL == (base = event_base_new()))
+	{
+		*error = zbx_strdup(NULL, "cannot initialize event base");
+		goto out;
+	}
+
+	/* discovered addresses are numeric, so name servers are not needed */
+	if (NULL == (dnsbase = evdns_base_new(base, 0)))
+	{
+		event_base_free(base);
+		*error = zbx_strdup(NULL, "cannot initialize asynchronous DNS library");
+		goto out;
+	}
+
+	while (i < checks_num || 0 != checks_running)
+	{
+		for (; i < checks_num && checks_running < concurrency_max; i++)
+		{
+			zbx_discoverer_async_context_t	*context;
+
+			context = (zbx_discoverer_async_context_t *)zbx_malloc(NULL,
+					sizeof(zbx_discoverer_async_context_t));
+			memset(context, 0, sizeof(zbx_discoverer_async_context_t));
+
+			context->check = &checks[i];
+			context->step = DISCOVERER_ASYNC_STEP_CONNECT_INIT;
+			context->source_ip = source_ip;
+			context->checks_running = &checks_running;
+			checks_running++;
+
+			zbx_async_poller_add_task(base, dnsbase, checks[i].ip, context, checks[i].dcheck->timeout,
+					discoverer_async_task_process, discoverer_async_task_clear);
+		}
+
+		if (0 != checks_running && 0 != event_base_loop(base, EVLOOP_ONCE))
+		{
+			*error = zbx_strdup(NULL, "cannot process event base");
+			break;
+		}
+	}
+
+	if (i == checks_num && 0 == checks_running)
+		ret = SUCCEED;
+
+	evdns_base_free(dnsbase, 0);
+	event_base_free(base);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+
+	return ret;
+}
@@ -0,0 +1,41 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#ifndef ZABBIX_DISCOVERER_ASYNC_H
+#define ZABBIX_DISCOVERER_ASYNC_H
+
+#include "zbxcacheconfig.h"
+
+#define DISCOVERER_ASYNC_CHECKS_MAX	1000
+
+typedef struct
+{
+	const zbx_dc_dcheck_t	*dcheck;
+	const char		*ip;
+	unsigned short		port;
+	int			status;
+	char			*value;
+}
+zbx_discoverer_async_check_t;
+
+int	discoverer_async_check_supported(const zbx_dc_dcheck_t *dcheck);
+int	discoverer_async_checks_process(zbx_discoverer_async_check_t *checks, int checks_num, int concurrency_max,
+		const char *source_ip, char **error);
+
+#endif
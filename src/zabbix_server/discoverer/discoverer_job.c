@@ -98,6 +98,7 @@ zbx_discoverer_job_t	*discoverer_job_create(zbx_dc_drule_t *drule)
 	job->druleid = drule->druleid;
 	job->workers_max = drule->concurrency_max;
 	job->workers_used = 0;
+	job->checks_used = 0;
 	job->drule_revision = drule->revision;
 	job->status = DISCOVERER_JOB_STATUS_QUEUED;
 	zbx_list_create(&job->tasks);
@@ -42,8 +42,9 @@ typedef struct
 	zbx_uint64_t			druleid;
 	zbx_list_t			tasks;
 	zbx_uint64_t			drule_revision;
-	int				workers_used;
-	int				workers_max;
+	int				workers_used;	/* workers processing the job tasks */
+	int				workers_max;	/* rule concurrency limit, 0 - unlimited */
+	int				checks_used;	/* concurrency limit taken by checks in progress */
 	unsigned char			status;
 }
 zbx_discoverer_job_t;
@@ -0,0 +1,487 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "history_partition.h"
+
+#include "zbxdbhigh.h"
+#include "zbxdb.h"
+#include "zbxstr.h"
+#include "zbxalgo.h"
+
+/* Native range partition management for history and trends tables.                  */
+/* Tables must be partitioned by range of clock column by database administrator,    */
+/* housekeeper then creates daily partitions in advance and drops partitions holding  */
+/* only expired data instead of deleting the records.                                 */
+
+#if defined(HAVE_POSTGRESQL) || defined(HAVE_MYSQL)
+
+/* upper bound of partition accepting all values (MAXVALUE) */
+#define HK_PARTITION_UNBOUNDED	INT_MAX
+
+typedef struct
+{
+	char	*name;
+
+	/* the range of clock values stored in partition - [from, to) */
+	int	from;
+	int	to;
+}
+zbx_hk_partition_t;
+
+ZBX_PTR_VECTOR_DECL(hk_partition_ptr, zbx_hk_partition_t *)
+ZBX_PTR_VECTOR_IMPL(hk_partition_ptr, zbx_hk_partition_t *)
+
+static void	hk_partition_free(zbx_hk_partition_t *partition)
+{
+	zbx_free(partition->name);
+	zbx_free(partition);
+}
+
+static void	hk_partition_add(zbx_vector_hk_partition_ptr_t *partitions, const char *name, int from, int to)
+{
+	zbx_hk_partition_t	*partition;
+
+	partition = (zbx_hk_partition_t *)zbx_malloc(NULL, sizeof(zbx_hk_partition_t));
+	partition->name = zbx_strdup(NULL, name);
+	partition->from = from;
+	partition->to = to;
+
+	zbx_vector_hk_partition_ptr_append(partitions, partition);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: formats daily partition name suffix                               *
+ *                                                                            *
+ * Parameters: clock  - [IN] the partition start time                         *
+ *             buffer - [OUT] the name suffix in YYYYMMDD format              *
+ *             size   - [IN] the buffer size                                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	hk_partition_day_suffix(int clock, char *buffer, size_t size)
+{
+	time_t		time_clock = (time_t)clock;
+	struct tm	tm;
+
+	gmtime_r(&time_clock, &tm);
+	zbx_snprintf(buffer, size, "%04d%02d%02d", tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday);
+}
+
+#if defined(HAVE_POSTGRESQL)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parses single partition bound value                               *
+ *                                                                            *
+ * Parameters: ptr   - [IN] the bound, starting with opening parenthesis      *
+ *             value - [OUT] the bound value                                  *
+ *                                                                            *
+ * Return value: pointer after the parsed bound or NULL on error              *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*hk_partition_parse_bound(const char *ptr, int *value)
+{
+	char	*end;
+
+	if ('(' != *ptr++)
+		return NULL;
+
+	if ('\'' == *ptr)
+		ptr++;
+
+	if (0 == strncmp(ptr, "MINVALUE", ZBX_CONST_STRLEN("MINVALUE")))
+	{
+		*value = 0;
+		ptr += ZBX_CONST_STRLEN("MINVALUE");
+	}
+	else if (0 == strncmp(ptr, "MAXVALUE", ZBX_CONST_STRLEN("MAXVALUE")))
+	{
+		*value = HK_PARTITION_UNBOUNDED;
+		ptr += ZBX_CONST_STRLEN("MAXVALUE");
+	}
+	else
+	{
+		long	num = strtol(ptr, &end, 10);
+
+		if (end == ptr)
+			return NULL;
+
+		*value = (int)MIN(num, HK_PARTITION_UNBOUNDED);
+		ptr = end;
+	}
+
+	if ('\'' == *ptr)
+		ptr++;
+
+	if (')' != *ptr++)
+		return NULL;
+
+	return ptr;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parses partition bound expression                                 *
+ *                                                                            *
+ * Parameters: expr - [IN] the expression in format                           *
+ *                         FOR VALUES FROM (<from>) TO (<to>)                 *
+ *             from - [OUT] the lower bound                                   *
+ *             to   - [OUT] the upper bound                                   *
+ *                                                                            *
+ * Return value: SUCCEED - the bounds were parsed                             *
+ *               FAIL    - otherwise (default partition)                      *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_partition_parse_range(const char *expr, int *from, int *to)
+{
+#define HK_RANGE_FROM	"FOR VALUES FROM "
+#define HK_RANGE_TO	" TO "
+	const char	*ptr;
+
+	if (0 != strncmp(expr, HK_RANGE_FROM, ZBX_CONST_STRLEN(HK_RANGE_FROM)))
+		return FAIL;
+
+	if (NULL == (ptr = hk_partition_parse_bound(expr + ZBX_CONST_STRLEN(HK_RANGE_FROM), from)))
+		return FAIL;
+
+	if (0 != strncmp(ptr, HK_RANGE_TO, ZBX_CONST_STRLEN(HK_RANGE_TO)))
+		return FAIL;
+
+	if (NULL == hk_partition_parse_bound(ptr + ZBX_CONST_STRLEN(HK_RANGE_TO), to))
+		return FAIL;
+
+	return SUCCEED;
+#undef HK_RANGE_FROM
+#undef HK_RANGE_TO
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: loads range partitions of table partitioned by clock              *
+ *                                                                            *
+ * Parameters: table_name - [IN]                                              *
+ *             partitions - [OUT] the partitions sorted by range              *
+ *                                                                            *
+ * Return value: SUCCEED - the table is range partitioned by clock            *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_partition_load(const char *table_name, zbx_vector_hk_partition_ptr_t *partitions)
+{
+	zbx_db_result_t	result;
+	zbx_db_row_t	row;
+	int		ret = FAIL;
+
+#if defined(HAVE_POSTGRESQL)
+	result = zbx_db_select(
+			"select pg_get_partkeydef(c.oid)"
+			" from pg_class c,pg_namespace n"
+			" where c.relnamespace=n.oid"
+				" and c.relkind='p'"
+				" and c.relname='%s'"
+				" and n.nspname='%s'",
+			table_name, zbx_db_get_schema_esc());
+
+	if (NULL != (row = zbx_db_fetch(result)) && 0 == strcmp(row[0], "RANGE (clock)"))
+		ret = SUCCEED;
+
+	zbx_db_free_result(result);
+
+	if (SUCCEED != ret)
+		return FAIL;
+
+	/* partition names are schema qualified, partitions can reside in other schema than the parent table */
+	result = zbx_db_select(
+			"select quote_ident(cn.nspname)||'.'||quote_ident(c.relname),"
+				"pg_get_expr(c.relpartbound,c.oid)"
+			" from pg_inherits i,pg_class c,pg_namespace cn,pg_class p,pg_namespace n"
+			" where i.inhrelid=c.oid"
+				" and c.relnamespace=cn.oid"
+				" and i.inhparent=p.oid"
+				" and p.relnamespace=n.oid"
+				" and p.relname='%s'"
+				" and n.nspname='%s'",
+			table_name, zbx_db_get_schema_esc());
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		int	from, to;
+
+		if (SUCCEED != hk_partition_parse_range(row[1], &from, &to))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "skipping partition \"%s\" of table \"%s\" with bounds \"%s\"",
+					row[0], table_name, row[1]);
+			continue;
+		}
+
+		hk_partition_add(partitions, row[0], from, to);
+	}
+	zbx_db_free_result(result);
+#else
+	int	from = 0;
+
+	result = zbx_db_select(
+			"select partition_name,partition_description"
+			" from information_schema.partitions"
+			" where table_schema=database()"
+				" and table_name='%s'"
+				" and partition_method='RANGE'"
+				" and partition_expression in ('clock','`clock`')"
+			" order by partition_ordinal_position",
+			table_name);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		int	to;
+
+		if (0 == strcmp(row[1], "MAXVALUE"))
+			to = HK_PARTITION_UNBOUNDED;
+		else
+			to = atoi(row[1]);
+
+		hk_partition_add(partitions, row[0], from, to);
+		from = to;
+		ret = SUCCEED;
+	}
+	zbx_db_free_result(result);
+#endif
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates daily partitions in advance                               *
+ *                                                                            *
+ * Parameters: table_name - [IN]                                              *
+ *             partitions - [IN] the existing partitions                      *
+ *             now        - [IN] current timestamp                            *
+ *             days_ahead - [IN] the number of days to create partitions for  *
+ *                                                                            *
+ * Return value: The number of created partitions                             *
+ *                                                                            *
+ * Comments: Days already covered by existing partitions are skipped, so      *
+ *           partitions with different ranges created by database             *
+ *           administrator are respected.                                     *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_partition_create(const char *table_name, const zbx_vector_hk_partition_ptr_t *partitions, int now,
+		int days_ahead)
+{
+	int	created = 0, day, clock, i;
+	char	suffix[16];
+#if defined(HAVE_POSTGRESQL)
+	for (day = 0, clock = now - now % SEC_PER_DAY; day <= days_ahead; day++, clock += SEC_PER_DAY)
+	{
+		for (i = 0; i < partitions->values_num; i++)
+		{
+			if (partitions->values[i]->from < clock + SEC_PER_DAY && partitions->values[i]->to > clock)
+				break;
+		}
+
+		if (i != partitions->values_num)
+			continue;
+
+		hk_partition_day_suffix(clock, suffix, sizeof(suffix));
+
+		if (ZBX_DB_OK <= zbx_db_execute("create table if not exists \"%s\".%s_p%s partition of \"%s\".%s"
+				" for values from (%d) to (%d)", zbx_db_get_schema_esc(), table_name, suffix,
+				zbx_db_get_schema_esc(), table_name, clock, clock + SEC_PER_DAY))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "created partition %s_p%s", table_name, suffix);
+			created++;
+		}
+	}
+#else
+	char	*sql = NULL;
+	size_t	sql_alloc = 0, sql_offset = 0;
+	int	last_to = 0;
+
+	for (i = 0; i < partitions->values_num; i++)
+		last_to = MAX(last_to, partitions->values[i]->to);
+
+	/* partitions cannot be added after the partition accepting all values */
+	if (HK_PARTITION_UNBOUNDED == last_to)
+		return 0;
+
+	for (day = 0, clock = now - now % SEC_PER_DAY; day <= days_ahead; day++, clock += SEC_PER_DAY)
+	{
+		if (clock + SEC_PER_DAY <= last_to)
+			continue;
+
+		hk_partition_day_suffix(clock, suffix, sizeof(suffix));
+
+		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "%spartition p%s values less than (%d)",
+				0 == created ? "" : ",", suffix, clock + SEC_PER_DAY);
+		created++;
+	}
+
+	if (0 != created)
+	{
+		if (ZBX_DB_OK > zbx_db_execute("alter table %s add partition (%s)", table_name, sql))
+			created = 0;
+		else
+			zabbix_log(LOG_LEVEL_DEBUG, "created %d partitions of table %s", created, table_name);
+	}
+
+	zbx_free(sql);
+#endif
+	return created;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: drops partitions with expired data                                *
+ *                                                                            *
+ * Parameters: table_name - [IN]                                              *
+ *             partitions - [IN] the existing partitions                      *
+ *             keep_from  - [IN] the oldest data timestamp to keep            *
+ *                                                                            *
+ * Return value: The number of dropped partitions                             *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_partition_drop(const char *table_name, const zbx_vector_hk_partition_ptr_t *partitions,
+		int keep_from)
+{
+	int	dropped = 0, i;
+#if defined(HAVE_POSTGRESQL)
+	for (i = 0; i < partitions->values_num; i++)
+	{
+		const zbx_hk_partition_t	*partition = partitions->values[i];
+
+		if (partition->to > keep_from)
+			continue;
+
+		if (ZBX_DB_OK <= zbx_db_execute("drop table %s", partition->name))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "dropped partition %s of table %s", partition->name, table_name);
+			dropped++;
+		}
+	}
+#else
+	char	*sql = NULL;
+	size_t	sql_alloc = 0, sql_offset = 0;
+
+	/* the last partition cannot be dropped */
+	for (i = 0; i < partitions->values_num - 1; i++)
+	{
+		const zbx_hk_partition_t	*partition = partitions->values[i];
+
+		if (partition->to > keep_from)
+			continue;
+
+		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, "%s`%s`", 0 == dropped ? "" : ",",
+				partition->name);
+		dropped++;
+	}
+
+	if (0 != dropped)
+	{
+		if (ZBX_DB_OK > zbx_db_execute("alter table %s drop partition %s", table_name, sql))
+			dropped = 0;
+		else
+			zabbix_log(LOG_LEVEL_DEBUG, "dropped %d partitions of table %s", dropped, table_name);
+	}
+
+	zbx_free(sql);
+#endif
+	return dropped;
+}
+
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if table is natively range partitioned by clock            *
+ *                                                                            *
+ * Parameters: table_name - [IN]                                              *
+ *                                                                            *
+ * Return value: SUCCEED - the partitions can be managed by housekeeper       *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	hk_partition_table_is_supported(const char *table_name)
+{
+#if defined(HAVE_POSTGRESQL) || defined(HAVE_MYSQL)
+	zbx_vector_hk_partition_ptr_t	partitions;
+	int				ret;
+
+	zbx_vector_hk_partition_ptr_create(&partitions);
+
+	ret = hk_partition_load(table_name, &partitions);
+
+	zbx_vector_hk_partition_ptr_clear_ext(&partitions, hk_partition_free);
+	zbx_vector_hk_partition_ptr_destroy(&partitions);
+
+	return ret;
+#else
+	ZBX_UNUSED(table_name);
+
+	return FAIL;
+#endif
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates daily partitions in advance and drops expired partitions  *
+ *                                                                            *
+ * Parameters: table_name - [IN]                                              *
+ *             now        - [IN] current timestamp                            *
+ *             keep_from  - [IN] the oldest data timestamp to keep            *
+ *             days_ahead - [IN] the number of days to create partitions for  *
+ *             created    - [OUT] the number of created partitions            *
+ *             dropped    - [OUT] the number of dropped partitions            *
+ *                                                                            *
+ * Return value: SUCCEED - the partitions were updated                        *
+ *               FAIL    - the table is not range partitioned by clock        *
+ *                                                                            *
+ ******************************************************************************/
+int	hk_partition_update(const char *table_name, int now, int keep_from, int days_ahead, int *created,
+		int *dropped)
+{
+#if defined(HAVE_POSTGRESQL) || defined(HAVE_MYSQL)
+	zbx_vector_hk_partition_ptr_t	partitions;
+	int				ret;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() table:%s keep_from:%d", __func__, table_name, keep_from);
+
+	zbx_vector_hk_partition_ptr_create(&partitions);
+
+	if (SUCCEED == (ret = hk_partition_load(table_name, &partitions)))
+	{
+		*created = hk_partition_create(table_name, &partitions, now, days_ahead);
+		*dropped = hk_partition_drop(table_name, &partitions, keep_from);
+	}
+
+	zbx_vector_hk_partition_ptr_clear_ext(&partitions, hk_partition_free);
+	zbx_vector_hk_partition_ptr_destroy(&partitions);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+
+	return ret;
+#else
+	ZBX_UNUSED(table_name);
+	ZBX_UNUSED(now);
+	ZBX_UNUSED(keep_from);
+	ZBX_UNUSED(days_ahead);
+	ZBX_UNUSED(created);
+	ZBX_UNUSED(dropped);
+
+	return FAIL;
+#endif
+}
@@ -27,6 +27,7 @@
 #include "zbxnum.h"
 #include "zbxtime.h"
 #include "history_compress.h"
+#include "history_partition.h"
 #include "zbx_rtc_constants.h"
 #include "zbx_host_constants.h"
 #include "zbxalgo.h"
@@ -35,6 +36,7 @@
 #include "zbxdbhigh.h"
 #include "zbxipcservice.h"
 #include "zbxstr.h"
+#include "zbxfile.h"
 
 #ifdef HAVE_POSTGRESQL
 #include "zbxjson.h"
@@ -51,6 +53,9 @@
 #define HK_UPDATE_CACHE_OFFSET_TREND_UINT	(HK_UPDATE_CACHE_OFFSET_TREND_FLOAT + 1)
 #define HK_UPDATE_CACHE_TREND_COUNT		2
 
+/* the minimum number of items in delete queue per delete worker */
+#define HK_DELETE_WORKER_ITEMS_MIN		100
+
 /* Housekeeping rule definition.                                */
 /* A housekeeping rule describes table from which records older */
 /* than history setting must be removed according to optional   */
@@ -144,9 +149,24 @@ typedef struct
 
 	/* the item delete queue */
 	zbx_vector_hk_delete_queue_ptr_t	delete_queue;
+
+	/* the table is natively range partitioned by clock and its partitions are managed by housekeeper */
+	unsigned char				partitioned;
+
+	/* the longest item storage period, partitions older than that are dropped when */
+	/* storage period override is disabled                                          */
+	int					history_max;
 }
 zbx_hk_history_rule_t;
 
+/* history deletion statistics */
+typedef struct
+{
+	int	items;
+	int	deleted;
+}
+zbx_hk_delete_stats_t;
+
 static struct zbx_db_version_info_t	*db_version_info;
 
 #if defined(HAVE_POSTGRESQL)
@@ -225,6 +245,31 @@ static int	hk_history_rules_partition_is_table_name_excluded(const char *table_n
 	return FAIL;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if history rule requires per item housekeeping             *
+ *                                                                            *
+ * Parameters: rule - [IN] history housekeeping rule                          *
+ *                                                                            *
+ * Return value: SUCCEED - records must be deleted by item storage periods    *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Expired data of partitioned tables is removed by dropping        *
+ *           partitions, so with storage period override enabled there is     *
+ *           nothing left for per item housekeeping.                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_history_rule_is_per_item(const zbx_hk_history_rule_t *rule)
+{
+	if (ZBX_HK_MODE_REGULAR != *rule->poption_mode)
+		return FAIL;
+
+	if (0 != rule->partitioned && ZBX_HK_OPTION_DISABLED != *rule->poption_global)
+		return FAIL;
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: compare two delete queue items by their itemid                    *
@@ -407,6 +452,7 @@ static void	hk_history_update(zbx_hk_history_rule_t *rules, int now)
 	zbx_db_row_t		row;
 	char			*tmp = NULL;
 	zbx_dc_um_handle_t	*um_handle;
+	int			items_num = 0, history_max = 0, trends_max = 0;
 
 	result = zbx_db_select(
 			"select i.itemid,i.value_type,i.history,i.trends,h.hostid"
@@ -428,6 +474,7 @@ static void	hk_history_update(zbx_hk_history_rule_t *rules, int now)
 		ZBX_STR2UINT64(itemid, row[0]);
 		value_type = atoi(row[1]);
 		ZBX_STR2UINT64(hostid, row[4]);
+		items_num++;
 
 		if (value_type <= ITEM_VALUE_TYPE_BIN &&
 				ZBX_HK_MODE_REGULAR == *(rule = rules + value_type)->poption_mode)
@@ -442,18 +489,22 @@ static void	hk_history_update(zbx_hk_history_rule_t *rules, int now)
 			{
 				zabbix_log(LOG_LEVEL_WARNING, "invalid history storage period '%s' for itemid '%s'",
 						tmp, row[0]);
+				history_max = ZBX_HK_PERIOD_MAX;
 				continue;
 			}
 
 			if (0 != history && (ZBX_HK_HISTORY_MIN > history || ZBX_HK_PERIOD_MAX < history))
 			{
 				zabbix_log(LOG_LEVEL_WARNING, "invalid history storage period for itemid '%s'", row[0]);
+				history_max = ZBX_HK_PERIOD_MAX;
 				continue;
 			}
 
 			if (0 != history && ZBX_HK_OPTION_DISABLED != *rule->poption_global)
 				history = *rule->poption;
 
+			history_max = MAX(history_max, history);
+
 			hk_history_item_update(rules, ITEM_VALUE_TYPE_BIN + 1, rule, now, itemid, history);
 		}
 
@@ -478,11 +529,13 @@ static void	hk_history_update(zbx_hk_history_rule_t *rules, int now)
 			{
 				zabbix_log(LOG_LEVEL_WARNING, "invalid trends storage period '%s' for itemid '%s'",
 						tmp, row[0]);
+				trends_max = ZBX_HK_PERIOD_MAX;
 				continue;
 			}
 			else if (0 != trends && (ZBX_HK_TRENDS_MIN > trends || ZBX_HK_PERIOD_MAX < trends))
 			{
 				zabbix_log(LOG_LEVEL_WARNING, "invalid trends storage period for itemid '%s'", row[0]);
+				trends_max = ZBX_HK_PERIOD_MAX;
 				continue;
 			}
 		}
@@ -498,6 +551,8 @@ static void	hk_history_update(zbx_hk_history_rule_t *rules, int now)
 		if (0 != trends && ZBX_HK_OPTION_DISABLED != *rule->poption_global)
 			trends = *rule->poption;
 
+		trends_max = MAX(trends_max, trends);
+
 		hk_history_item_update(rules + HK_UPDATE_CACHE_OFFSET_TREND_FLOAT, HK_UPDATE_CACHE_TREND_COUNT,
 				rule_add, now, itemid, trends);
 	}
@@ -506,6 +561,13 @@ static void	hk_history_update(zbx_hk_history_rule_t *rules, int now)
 	zbx_dc_close_user_macros(um_handle);
 
 	zbx_free(tmp);
+
+	/* do not drop any partitions if item storage periods are not known */
+	if (0 == items_num)
+		history_max = trends_max = ZBX_HK_PERIOD_MAX;
+
+	for (zbx_hk_history_rule_t *rule = rules; NULL != rule->table; rule++)
+		rule->history_max = (0 == strcmp(rule->history, "trends") ? trends_max : history_max);
 }
 
 /******************************************************************************
@@ -529,7 +591,7 @@ static void	hk_history_delete_queue_prepare_all(zbx_hk_history_rule_t *rules, in
 	/* prepare history item cache (hashset containing itemid:min_clock values) */
 	for (zbx_hk_history_rule_t *rule = rules; NULL != rule->table; rule++)
 	{
-		if (ZBX_HK_MODE_REGULAR == *rule->poption_mode)
+		if (SUCCEED == hk_history_rule_is_per_item(rule))
 		{
 			if (0 == rule->item_cache.num_slots)
 				hk_history_prepare(rule);
@@ -650,14 +712,379 @@ static void 	hk_update_dbversion_status(void)
 }
 #endif
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: delete limited count of rows from table                           *
+ *                                                                            *
+ * Return value: number of deleted rows or less than 0 if an error occurred   *
+ *                                                                            *
+ ******************************************************************************/
+static int	DBdelete_from_table(const char *tablename, const char *filter, int limit)
+{
+	if (0 == limit)
+	{
+		return zbx_db_execute(
+				"delete from %s"
+				" where %s",
+				tablename,
+				filter);
+	}
+	else
+	{
+#if defined(HAVE_ORACLE)
+		return zbx_db_execute(
+				"delete from %s"
+				" where %s"
+					" and rownum<=%d",
+				tablename,
+				filter,
+				limit);
+#elif defined(HAVE_MYSQL)
+		return zbx_db_execute(
+				"delete from %s"
+				" where %s limit %d",
+				tablename,
+				filter,
+				limit);
+#elif defined(HAVE_POSTGRESQL)
+		return zbx_db_execute(
+				"delete from %s"
+				" where %s and ctid = any(array(select ctid from %s"
+					" where %s limit %d))",
+				tablename,
+				filter,
+				tablename,
+				filter,
+				limit);
+#elif defined(HAVE_SQLITE3)
+		return zbx_db_execute(
+				"delete from %s"
+				" where %s",
+				tablename,
+				filter);
+#endif
+	}
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: deletes expired history records of single item                    *
+ *                                                                            *
+ * Parameters: table       - [IN] history table name                          *
+ *             item_record - [IN] item and its records removal timestamp      *
+ *             chunk_size  - [IN] the maximum number of records deleted by    *
+ *                                one statement, 0 - unlimited                *
+ *                                                                            *
+ * Return value: number of deleted records                                    *
+ *                                                                            *
+ * Comments: Records are deleted in chunks to keep transactions short.        *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_history_delete_item(const char *table, const zbx_hk_delete_queue_t *item_record, int chunk_size)
+{
+	char	filter[MAX_STRING_LEN];
+	int	deleted = 0, rc;
+
+	zbx_snprintf(filter, sizeof(filter), "itemid=" ZBX_FS_UI64 " and clock<%d", item_record->itemid,
+			item_record->min_clock);
+
+	do
+	{
+		if (ZBX_DB_OK > (rc = DBdelete_from_table(table, filter, chunk_size)))
+			break;
+
+		deleted += rc;
+	}
+	while (0 != chunk_size && rc == chunk_size && ZBX_IS_RUNNING());
+
+	return deleted;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: deletes expired history records of every n-th item in delete      *
+ *          queue                                                             *
+ *                                                                            *
+ * Parameters: rule       - [IN] history housekeeping rule                    *
+ *             slice      - [IN] the index of first item to process           *
+ *             slices     - [IN] the step between processed items             *
+ *             chunk_size - [IN] the maximum number of records deleted by one *
+ *                               statement, 0 - unlimited                     *
+ *             stats      - [IN/OUT] deletion statistics                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	hk_history_delete_slice(const zbx_hk_history_rule_t *rule, int slice, int slices, int chunk_size,
+		zbx_hk_delete_stats_t *stats)
+{
+	double	time_progress = 0, time_now;
+	int	items = 0, items_total = (rule->delete_queue.values_num - slice + slices - 1) / slices;
+
+	for (int i = slice; i < rule->delete_queue.values_num && ZBX_IS_RUNNING(); i += slices)
+	{
+		if (1 <= (time_now = zbx_time()) - time_progress)
+		{
+			zbx_setproctitle("%s [removing old records from %s: %d of %d items, worker %d of %d]",
+					get_process_type_string(ZBX_PROCESS_TYPE_HOUSEKEEPER), rule->table, items,
+					items_total, slice + 1, slices);
+			time_progress = time_now;
+		}
+
+		stats->deleted += hk_history_delete_item(rule->table, rule->delete_queue.values[i], chunk_size);
+		items++;
+	}
+
+	stats->items += items;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: asks delete worker to stop after the current statement            *
+ *                                                                            *
+ * Parameters: pid - [IN] the worker process id                               *
+ *                                                                            *
+ * Comments: Delete workers are forked from housekeeper and are not known to  *
+ *           the main process, so the housekeeper must stop them on shutdown. *
+ *           Child processes ignore SIGTERM, SIGUSR2 is used to politely ask  *
+ *           them to finish, like the main process does.                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	hk_history_delete_worker_stop(pid_t pid)
+{
+	if (-1 == kill(pid, SIGUSR2))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "cannot stop housekeeper delete worker (pid:%d): %s", (int)pid,
+				zbx_strerror(errno));
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: waits for delete worker to finish and collects its statistics     *
+ *                                                                            *
+ * Parameters: pid   - [IN] the worker process id                             *
+ *             fd    - [IN] the pipe to read worker statistics from           *
+ *             stats - [IN/OUT] deletion statistics                           *
+ *                                                                            *
+ * Comments: If housekeeper is stopped while waiting, the worker is asked to  *
+ *           stop and is still waited for, so it is always reaped.            *
+ *                                                                            *
+ ******************************************************************************/
+static void	hk_history_delete_worker_wait(pid_t pid, int fd, zbx_hk_delete_stats_t *stats)
+{
+	zbx_hk_delete_stats_t	worker_stats;
+	size_t			offset = 0;
+	ssize_t			n;
+	int			status, stopping = 0;
+
+	while (offset < sizeof(worker_stats))
+	{
+		if (0 == stopping && !ZBX_IS_RUNNING())
+		{
+			hk_history_delete_worker_stop(pid);
+			stopping = 1;
+		}
+
+		if (-1 == (n = read(fd, (char *)&worker_stats + offset, sizeof(worker_stats) - offset)))
+		{
+			/* interrupted by signal, the worker is asked to stop with the next iteration if needed */
+			if (EINTR == errno)
+				continue;
+
+			zabbix_log(LOG_LEVEL_ERR, "cannot read housekeeper delete worker statistics: %s",
+					zbx_strerror(errno));
+			break;
+		}
+
+		if (0 == n)
+			break;
+
+		offset += (size_t)n;
+	}
+
+	close(fd);
+
+	while (-1 == waitpid(pid, &status, 0))
+	{
+		if (EINTR != errno)
+		{
+			zabbix_log(LOG_LEVEL_ERR, "failed to wait on housekeeper delete worker: %s",
+					zbx_strerror(errno));
+			break;
+		}
+	}
+
+	if (sizeof(worker_stats) != offset)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "housekeeper delete worker terminated without reporting statistics");
+		return;
+	}
+
+	stats->items += worker_stats.items;
+	stats->deleted += worker_stats.deleted;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: deletes expired history records in parallel                       *
+ *                                                                            *
+ * Parameters: rule       - [IN] history housekeeping rule                    *
+ *             chunk_size - [IN] the maximum number of records deleted by one *
+ *                               statement, 0 - unlimited                     *
+ *             workers    - [IN] the number of delete workers                 *
+ *             stats      - [IN/OUT] deletion statistics                      *
+ *                                                                            *
+ * Comments: Delete queue is split between short-lived child processes, each  *
+ *           using its own database connection. The first part of the queue   *
+ *           and parts of workers that could not be started are processed by  *
+ *           housekeeper itself.                                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	hk_history_delete_parallel(const zbx_hk_history_rule_t *rule, int chunk_size, int workers,
+		zbx_hk_delete_stats_t *stats)
+{
+	pid_t	pids[HK_DELETE_WORKERS_MAX];
+	int	fds[HK_DELETE_WORKERS_MAX], i;
+
+	/* database connection must not be shared with child processes */
+	zbx_db_close();
+
+	for (i = 1; i < workers; i++)
+	{
+		int	pipe_fds[2];
+
+		if (-1 == pipe(pipe_fds))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "cannot create housekeeper delete worker pipe: %s",
+					zbx_strerror(errno));
+			pids[i] = -1;
+			continue;
+		}
+
+		if (-1 == (pids[i] = zbx_fork()))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "cannot fork housekeeper delete worker: %s", zbx_strerror(errno));
+			close(pipe_fds[0]);
+			close(pipe_fds[1]);
+			continue;
+		}
+
+		if (0 == pids[i])
+		{
+			zbx_hk_delete_stats_t	worker_stats = {0};
+			int			ret;
+
+			close(pipe_fds[0]);
+
+			zbx_db_connect(ZBX_DB_CONNECT_NORMAL);
+			hk_history_delete_slice(rule, i, workers, chunk_size, &worker_stats);
+			zbx_db_close();
+
+			ret = zbx_write_all(pipe_fds[1], (const char *)&worker_stats, sizeof(worker_stats));
+			close(pipe_fds[1]);
+
+			exit(SUCCEED == ret ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+
+		close(pipe_fds[1]);
+		fds[i] = pipe_fds[0];
+	}
+
+	zbx_db_connect(ZBX_DB_CONNECT_NORMAL);
+
+	hk_history_delete_slice(rule, 0, workers, chunk_size, stats);
+
+	for (i = 1; i < workers; i++)
+	{
+		if (-1 == pids[i])
+			hk_history_delete_slice(rule, i, workers, chunk_size, stats);
+	}
+
+	/* stop all workers at once rather than one by one while waiting for them */
+	if (!ZBX_IS_RUNNING())
+	{
+		for (i = 1; i < workers; i++)
+		{
+			if (-1 != pids[i])
+				hk_history_delete_worker_stop(pids[i]);
+		}
+	}
+
+	for (i = 1; i < workers; i++)
+	{
+		if (-1 != pids[i])
+			hk_history_delete_worker_wait(pids[i], fds[i], stats);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: deletes expired history records of items in delete queue          *
+ *                                                                            *
+ * Parameters: rule       - [IN/OUT] history housekeeping rule                *
+ *             chunk_size - [IN] the maximum number of records deleted by one *
+ *                               statement, 0 - unlimited                     *
+ *             workers    - [IN] the maximum number of delete workers         *
+ *                                                                            *
+ * Return value: number of deleted records                                    *
+ *                                                                            *
+ ******************************************************************************/
+static int	hk_history_delete_queue_process(zbx_hk_history_rule_t *rule, int chunk_size, int workers)
+{
+	zbx_hk_delete_stats_t	stats = {0};
+	double			sec;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() table:%s items:%d", __func__, rule->table,
+			rule->delete_queue.values_num);
+
+	if (0 == rule->delete_queue.values_num)
+		goto out;
+
+	zbx_vector_hk_delete_queue_ptr_sort(&rule->delete_queue, hk_item_update_cache_compare);
+
+	/* do not start workers for small delete queues */
+	workers = MIN(workers, rule->delete_queue.values_num / HK_DELETE_WORKER_ITEMS_MIN);
+
+	sec = zbx_time();
+
+	if (1 >= workers)
+	{
+		workers = 1;
+		hk_history_delete_slice(rule, 0, 1, chunk_size, &stats);
+	}
+	else
+		hk_history_delete_parallel(rule, chunk_size, workers, &stats);
+
+	sec = zbx_time() - sec;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() table:%s items:%d deleted:%d workers:%d in " ZBX_FS_DBL " sec, "
+			ZBX_FS_DBL " records/sec", __func__, rule->table, stats.items, stats.deleted, workers, sec,
+			0 < sec ? stats.deleted / sec : 0);
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%d", __func__, stats.deleted);
+
+	return stats.deleted;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: performs housekeeping for history and trends tables               *
  *                                                                            *
- * Parameters: now - [IN] current timestamp                                   *
+ * Parameters: now                  - [IN] current timestamp                  *
+ *             config_max_hk_delete - [IN] the maximum number of records      *
+ *                                         deleted by one statement           *
+ *             partitions_days      - [IN] the number of days to create       *
+ *                                         partitions for, 0 - native         *
+ *                                         partition management is disabled   *
+ *             delete_workers       - [IN] the number of delete workers       *
+ *             partitions_dropped   - [OUT] the number of dropped partitions  *
+ *                                                                            *
+ * Return value: number of deleted records                                    *
  *                                                                            *
  ******************************************************************************/
-static int	housekeeping_history_and_trends(int now)
+static int	housekeeping_history_and_trends(int now, int config_max_hk_delete, int partitions_days,
+		int delete_workers, int *partitions_dropped)
 {
 	int			deleted = 0;
 	zbx_hk_history_rule_t	*rule;
@@ -667,6 +1094,19 @@ static int	housekeeping_history_and_trends(int now)
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() now:%d", __func__, now);
 
+	*partitions_dropped = 0;
+
+	for (rule = hk_history_rules; NULL != rule->table; rule++)
+	{
+		rule->partitioned = 0;
+
+		if (0 != partitions_days && ZBX_HK_MODE_REGULAR == *rule->poption_mode &&
+				SUCCEED == hk_partition_table_is_supported(rule->table))
+		{
+			rule->partitioned = 1;
+		}
+	}
+
 	/* prepare delete queues for all history housekeeping rules */
 	hk_history_delete_queue_prepare_all(hk_history_rules, now);
 
@@ -682,6 +1122,30 @@ static int	housekeeping_history_and_trends(int now)
 		if (ZBX_HK_MODE_DISABLED == *rule->poption_mode)
 			goto skip;
 
+		/* Natively partitioned tables have partitions with data older than the storage period dropped. */
+		/* When storage period override is disabled, the longest item storage period is used and the    */
+		/* remaining expired records are deleted per item.                                              */
+		if (0 != rule->partitioned)
+		{
+			int	keep_from, created = 0, dropped = 0;
+
+			if (ZBX_HK_OPTION_DISABLED != *rule->poption_global)
+				keep_from = now - *rule->poption;
+			else
+				keep_from = now - rule->history_max;
+
+			if (SUCCEED == hk_partition_update(rule->table, now, keep_from, partitions_days, &created,
+					&dropped))
+			{
+				zabbix_log(LOG_LEVEL_DEBUG, "table %s: created %d, dropped %d partitions", rule->table,
+						created, dropped);
+				*partitions_dropped += dropped;
+			}
+
+			if (SUCCEED != hk_history_rule_is_per_item(rule))
+				goto skip;
+		}
+
 		if (SUCCEED == hk_history_rules_partition_is_table_name_excluded(rule->table))
 			goto process_delete_queue_for_housekeeping_rule;
 
@@ -731,17 +1195,7 @@ static int	housekeeping_history_and_trends(int now)
 		}
 #endif
 process_delete_queue_for_housekeeping_rule:
-		zbx_vector_hk_delete_queue_ptr_sort(&rule->delete_queue, hk_item_update_cache_compare);
-
-		for (int i = 0; i < rule->delete_queue.values_num; i++)
-		{
-			zbx_hk_delete_queue_t	*item_record = (zbx_hk_delete_queue_t *)rule->delete_queue.values[i];
-			int	rc = zbx_db_execute("delete from %s where itemid=" ZBX_FS_UI64 " and clock<%d",
-					rule->table, item_record->itemid, item_record->min_clock);
-
-			if (ZBX_DB_OK < rc)
-				deleted += rc;
-		}
+		deleted += hk_history_delete_queue_process(rule, config_max_hk_delete, delete_workers);
 skip:
 		/* clear history rule delete queue so it's ready for the next housekeeping cycle */
 		hk_history_delete_queue_clear(rule);
@@ -904,62 +1358,6 @@ ret:
 	return deleted;
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: delete limited count of rows from table                           *
- *                                                                            *
- * Return value: number of deleted rows or less than 0 if an error occurred   *
- *                                                                            *
- ******************************************************************************/
-static int	DBdelete_from_table(const char *tablename, const char *filter, int limit)
-{
-	if (0 == limit)
-	{
-		return zbx_db_execute(
-				"delete from %s"
-				" where %s",
-				tablename,
-				filter);
-	}
-	else
-	{
-#if defined(HAVE_ORACLE)
-		return zbx_db_execute(
-				"delete from %s"
-				" where %s"
-					" and rownum<=%d",
-				tablename,
-				filter,
-				limit);
-#elif defined(HAVE_MYSQL)
-		return zbx_db_execute(
-				"delete from %s"
-				" where %s limit %d",
-				tablename,
-				filter,
-				limit);
-#elif defined(HAVE_POSTGRESQL)
-		return zbx_db_execute(
-				"delete from %s"
-				" where %s and ctid = any(array(select ctid from %s"
-					" where %s limit %d))",
-				tablename,
-				filter,
-				tablename,
-				filter,
-				limit);
-#elif defined(HAVE_SQLITE3)
-		return zbx_db_execute(
-				"delete from %s"
-				" where %s",
-				tablename,
-				filter);
-#endif
-	}
-
-	return 0;
-}
-
 /******************************************************************************
  *                                                                            *
  * Purpose: perform problem table cleanup                                     *
@@ -1515,7 +1913,11 @@ ZBX_THREAD_ENTRY(housekeeper_thread, args)
 		zbx_setproctitle("%s [removing old history and trends]",
 				get_process_type_string(process_type));
 		sec = zbx_time();
-		int	d_history_and_trends = housekeeping_history_and_trends(now);
+		int	d_partitions;
+		int	d_history_and_trends = housekeeping_history_and_trends(now,
+				housekeeper_args_in->config_max_housekeeper_delete,
+				housekeeper_args_in->config_housekeeping_partitions,
+				housekeeper_args_in->config_housekeeper_delete_workers, &d_partitions);
 
 		zbx_setproctitle("%s [removing old problems]", get_process_type_string(process_type));
 		int	d_problems = housekeeping_problems(now, housekeeper_args_in->config_housekeeping_frequency);
@@ -1542,11 +1944,12 @@ ZBX_THREAD_ENTRY(housekeeper_thread, args)
 		int	d_cleanup = housekeeping_cleanup(housekeeper_args_in->config_housekeeping_frequency);
 		sec = zbx_time() - sec;
 
-		zabbix_log(LOG_LEVEL_WARNING, "%s [deleted %d hist/trends, %d items/triggers, %d events, %d problems,"
-				" %d sessions, %d alarms, %d audit, %d autoreg_host, %d records in " ZBX_FS_DBL
-				" sec, %s]",
-				get_process_type_string(process_type), d_history_and_trends, d_cleanup, d_events,
-				d_problems, d_sessions, d_services, d_audit, d_autoreg_host, records, sec, sleeptext);
+		zabbix_log(LOG_LEVEL_WARNING, "%s [deleted %d hist/trends, %d hist/trends partitions, %d items/triggers,"
+				" %d events, %d problems, %d sessions, %d alarms, %d audit, %d autoreg_host, %d records"
+				" in " ZBX_FS_DBL " sec, %s]",
+				get_process_type_string(process_type), d_history_and_trends, d_partitions, d_cleanup,
+				d_events, d_problems, d_sessions, d_services, d_audit, d_autoreg_host, records, sec,
+				sleeptext);
 
 		zbx_config_clean(&cfg);
 
@@ -22,12 +22,17 @@
 
 #include "zbxthreads.h"
 
+/* the maximum number of processes deleting history records in parallel */
+#define HK_DELETE_WORKERS_MAX	32
+
 typedef struct
 {
 	struct zbx_db_version_info_t	*db_version_info;
 	int				config_timeout;
 	int				config_housekeeping_frequency;
 	int				config_max_housekeeper_delete;
+	int				config_housekeeping_partitions;
+	int				config_housekeeper_delete_workers;
 }
 zbx_thread_housekeeper_args;
 
@@ -18,6 +18,7 @@
 **/
 
 #include "lld.h"
+#include "lld_manager.h"
 #include "zbxexpression.h"
 
 #include "zbxregexp.h"
@@ -111,16 +112,16 @@ static void	lld_filter_clean(zbx_lld_filter_t *filter)
 	lld_conditions_free(&filter->conditions);
 }
 
-static int	lld_filter_condition_add(zbx_vector_ptr_t *conditions, const char *id, const char *macro,
-		const char *regexp, const char *op, const zbx_dc_item_t *item, char **error)
+static int	lld_filter_condition_append(zbx_vector_ptr_t *conditions, zbx_uint64_t id, const char *macro,
+		const char *regexp, unsigned char op, const zbx_dc_item_t *item, char **error)
 {
 	lld_condition_t	*condition;
 
 	condition = (lld_condition_t *)zbx_malloc(NULL, sizeof(lld_condition_t));
-	ZBX_STR2UINT64(condition->id, id);
+	condition->id = id;
 	condition->macro = zbx_strdup(NULL, macro);
 	condition->regexp = zbx_strdup(NULL, regexp);
-	condition->op = (unsigned char)atoi(op);
+	condition->op = op;
 
 	zbx_vector_expression_create(&condition->regexps);
 
@@ -146,35 +147,44 @@ static int	lld_filter_condition_add(zbx_vector_ptr_t *conditions, const char *id
 	return SUCCEED;
 }
 
+static int	lld_filter_condition_add(zbx_vector_ptr_t *conditions, const char *id, const char *macro,
+		const char *regexp, const char *op, const zbx_dc_item_t *item, char **error)
+{
+	zbx_uint64_t	conditionid;
+
+	ZBX_STR2UINT64(conditionid, id);
+
+	return lld_filter_condition_append(conditions, conditionid, macro, regexp, (unsigned char)atoi(op), item,
+			error);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: loads lld filter data                                             *
  *                                                                            *
- * Parameters: filter     - [IN] lld filter                                   *
- *             lld_ruleid - [IN] lld rule id                                  *
- *             item       - [IN] lld item                                     *
- *             error      - [OUT] error message                               *
+ * Parameters: filter - [IN] lld filter                                       *
+ *             rule   - [IN] prefetched lld rule data                         *
+ *             item   - [IN] lld item                                         *
+ *             error  - [OUT] error message                                   *
  *                                                                            *
  ******************************************************************************/
-static int	lld_filter_load(zbx_lld_filter_t *filter, zbx_uint64_t lld_ruleid, const zbx_dc_item_t *item,
+static int	lld_filter_load(zbx_lld_filter_t *filter, const zbx_lld_rule_data_t *rule, const zbx_dc_item_t *item,
 		char **error)
 {
-	zbx_db_result_t	result;
-	zbx_db_row_t	row;
-	int		ret = SUCCEED;
+	int	i, ret = SUCCEED;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	result = zbx_db_select(
-			"select item_conditionid,macro,value,operator"
-			" from item_condition"
-			" where itemid=" ZBX_FS_UI64,
-			lld_ruleid);
+	for (i = 0; i < rule->conditions.values_num; i++)
+	{
+		const lld_condition_t	*condition = (const lld_condition_t *)rule->conditions.values[i];
 
-	while (NULL != (row = zbx_db_fetch(result)) && SUCCEED == (ret = lld_filter_condition_add(&filter->conditions,
-			row[0], row[1], row[2], row[3], item, error)))
-		;
-	zbx_db_free_result(result);
+		if (SUCCEED != (ret = lld_filter_condition_append(&filter->conditions, condition->id, condition->macro,
+				condition->regexp, condition->op, item, error)))
+		{
+			break;
+		}
+	}
 
 	if (ZBX_CONDITION_EVAL_TYPE_AND_OR == filter->evaltype)
 		zbx_vector_ptr_sort(&filter->conditions, lld_condition_compare_by_macro);
@@ -970,6 +980,7 @@ static int	lld_rows_get(const char *value, zbx_lld_filter_t *filter, zbx_vector_
 	struct zbx_json_parse	jp, jp_array, jp_row;
 	const char		*p;
 	zbx_lld_row_t		*lld_row;
+	zbx_json_index_t	*index = NULL;
 	int			ret = FAIL, i;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
@@ -980,6 +991,9 @@ static int	lld_rows_get(const char *value, zbx_lld_filter_t *filter, zbx_vector_
 		goto out;
 	}
 
+	if (ZBX_JSON_INDEX_MIN_SIZE <= jp.end - jp.start)
+		index = zbx_json_index_create(&jp);
+
 	if ('[' == *jp.start)
 	{
 		jp_array = jp;
@@ -1027,6 +1041,8 @@ static int	lld_rows_get(const char *value, zbx_lld_filter_t *filter, zbx_vector_
 
 	ret = SUCCEED;
 out:
+	zbx_json_index_free(index);
+
 	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_TRACE))
 	{
 		for (i = 0; i < lld_rows->values_num; i++)
@@ -1065,24 +1081,505 @@ static void	lld_row_free(zbx_lld_row_t *lld_row)
 	zbx_free(lld_row);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: releases resources allocated by prefetched discovery rule data    *
+ *                                                                            *
+ ******************************************************************************/
+void	lld_rule_data_clean(zbx_lld_rule_data_t *rule)
+{
+	zbx_free(rule->key);
+	zbx_free(rule->formula);
+	zbx_free(rule->lifetime);
+
+	lld_conditions_free(&rule->conditions);
+
+	zbx_vector_ptr_clear_ext(&rule->item_prototypes, (zbx_clean_func_t)lld_item_prototype_free);
+	zbx_vector_ptr_destroy(&rule->item_prototypes);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds database row to the configuration digest of discovery rule   *
+ *                                                                            *
+ * Parameters: rule    - [IN/OUT] prefetched discovery rule data              *
+ *             row     - [IN] database row                                    *
+ *             columns - [IN] number of columns to hash                       *
+ *                                                                            *
+ * Comments: Terminating zeros are hashed as well to keep column boundaries.  *
+ *                                                                            *
+ ******************************************************************************/
+void	lld_rule_data_hash_row(zbx_lld_rule_data_t *rule, zbx_db_row_t row, int columns)
+{
+	int	i;
+
+	for (i = 0; i < columns; i++)
+	{
+		const char	*field = ZBX_NULL2EMPTY_STR(row[i]);
+
+		zbx_md5_append(&rule->config_md5, (const md5_byte_t *)field, (int)strlen(field) + 1);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates digest of discovery value combined with discovery rule *
+ *          configuration                                                     *
+ *                                                                            *
+ * Parameters: rule   - [IN] prefetched discovery rule data                   *
+ *             value  - [IN] discovery value                                  *
+ *             digest - [OUT] the digest                                      *
+ *                                                                            *
+ ******************************************************************************/
+void	lld_rule_value_digest(const zbx_lld_rule_data_t *rule, const char *value, md5_byte_t *digest)
+{
+	md5_state_t	state = rule->config_md5;
+
+	zbx_md5_append(&state, (const md5_byte_t *)value, (int)strlen(value));
+	zbx_md5_finish(&state, digest);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates digest of filtered discovery rows combined with        *
+ *          discovery rule configuration                                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	lld_rows_digest(const zbx_lld_rule_data_t *rule, int lifetime, const zbx_vector_lld_row_t *lld_rows,
+		md5_byte_t *digest)
+{
+	md5_state_t	state = rule->config_md5;
+	int		i;
+
+	zbx_md5_append(&state, (const md5_byte_t *)&lifetime, (int)sizeof(lifetime));
+
+	for (i = 0; i < lld_rows->values_num; i++)
+	{
+		const struct zbx_json_parse	*jp_row = &lld_rows->values[i]->jp_row;
+
+		zbx_md5_append(&state, (const md5_byte_t *)jp_row->start, (int)(jp_row->end - jp_row->start + 1));
+	}
+
+	zbx_md5_finish(&state, digest);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds configuration rows of multiple discovery rules to their      *
+ *          configuration digests                                             *
+ *                                                                            *
+ * Parameters: rules       - [IN/OUT] prefetched discovery rule data          *
+ *             lld_ruleids - [IN] discovery rule ids                          *
+ *             select      - [IN] query selecting discovery rule id followed  *
+ *                                by the hashed columns                       *
+ *             fieldname   - [IN] discovery rule id field name                *
+ *             order       - [IN] ordering of the selected rows               *
+ *             columns     - [IN] number of hashed columns                    *
+ *             sql         - [IN/OUT] query buffer                            *
+ *             sql_alloc   - [IN/OUT] query buffer size                       *
+ *                                                                            *
+ ******************************************************************************/
+static void	lld_rules_hash_rows(zbx_hashset_t *rules, const zbx_vector_uint64_t *lld_ruleids, const char *select,
+		const char *fieldname, const char *order, int columns, char **sql, size_t *sql_alloc)
+{
+	zbx_db_result_t		result;
+	zbx_db_row_t		row;
+	zbx_lld_rule_data_t	*rule;
+	zbx_uint64_t		lld_ruleid;
+	size_t			sql_offset = 0;
+
+	zbx_strcpy_alloc(sql, sql_alloc, &sql_offset, select);
+	zbx_db_add_condition_alloc(sql, sql_alloc, &sql_offset, fieldname, lld_ruleids->values,
+			lld_ruleids->values_num);
+	zbx_snprintf_alloc(sql, sql_alloc, &sql_offset, " order by %s", order);
+
+	result = zbx_db_select("%s", *sql);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		ZBX_STR2UINT64(lld_ruleid, row[0]);
+
+		if (NULL == (rule = (zbx_lld_rule_data_t *)zbx_hashset_search(rules, &lld_ruleid)))
+			continue;
+
+		lld_rule_data_hash_row(rule, row + 1, columns);
+	}
+	zbx_db_free_result(result);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds configuration which is not prefetched, but affects           *
+ *          discovered objects, to configuration digests of discovery rules   *
+ *                                                                            *
+ * Parameters: rules       - [IN/OUT] prefetched discovery rule data          *
+ *             lld_ruleids - [IN] discovery rule ids                          *
+ *                                                                            *
+ * Comments: LLD macro paths, overrides, trigger, graph and host prototypes   *
+ *           and revision of user macros are hashed, so that their changes    *
+ *           force full processing of discovery rule. Prototype details not   *
+ *           covered here are applied when digests expire in LLD manager.     *
+ *                                                                            *
+ ******************************************************************************/
+static void	lld_rules_hash_config(zbx_hashset_t *rules, const zbx_vector_uint64_t *lld_ruleids)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_lld_rule_data_t	*rule;
+	char			*sql = NULL;
+	size_t			sql_alloc = 0;
+
+	lld_rules_hash_rows(rules, lld_ruleids,
+			"select itemid,lld_macro_pathid,lld_macro,path"
+			" from lld_macro_path"
+			" where",
+			"itemid", "lld_macro_pathid", 3, &sql, &sql_alloc);
+
+	lld_rules_hash_rows(rules, lld_ruleids,
+			"select itemid,lld_overrideid,name,step,evaltype,formula,stop"
+			" from lld_override"
+			" where",
+			"itemid", "lld_overrideid", 6, &sql, &sql_alloc);
+
+	lld_rules_hash_rows(rules, lld_ruleids,
+			"select o.itemid,c.lld_override_conditionid,c.lld_overrideid,c.operator,c.macro,c.value"
+			" from lld_override o,lld_override_condition c"
+			" where o.lld_overrideid=c.lld_overrideid"
+				" and",
+			"o.itemid", "c.lld_override_conditionid", 5, &sql, &sql_alloc);
+
+	lld_rules_hash_rows(rules, lld_ruleids,
+			"select o.itemid,op.lld_override_operationid,op.lld_overrideid,op.operationobject,"
+				"op.operator,op.value,s.status,d.discover,p.delay,h.history,t.trends,v.severity,"
+				"i.inventory_mode"
+			" from lld_override o"
+			" join lld_override_operation op"
+				" on o.lld_overrideid=op.lld_overrideid"
+			" left join lld_override_opstatus s"
+				" on op.lld_override_operationid=s.lld_override_operationid"
+			" left join lld_override_opdiscover d"
+				" on op.lld_override_operationid=d.lld_override_operationid"
+			" left join lld_override_opperiod p"
+				" on op.lld_override_operationid=p.lld_override_operationid"
+			" left join lld_override_ophistory h"
+				" on op.lld_override_operationid=h.lld_override_operationid"
+			" left join lld_override_optrends t"
+				" on op.lld_override_operationid=t.lld_override_operationid"
+			" left join lld_override_opseverity v"
+				" on op.lld_override_operationid=v.lld_override_operationid"
+			" left join lld_override_opinventory i"
+				" on op.lld_override_operationid=i.lld_override_operationid"
+			" where",
+			"o.itemid", "op.lld_override_operationid", 12, &sql, &sql_alloc);
+
+	lld_rules_hash_rows(rules, lld_ruleids,
+			"select o.itemid,t.lld_override_optagid,t.lld_override_operationid,t.tag,t.value"
+			" from lld_override o,lld_override_operation op,lld_override_optag t"
+			" where o.lld_overrideid=op.lld_overrideid"
+				" and op.lld_override_operationid=t.lld_override_operationid"
+				" and",
+			"o.itemid", "t.lld_override_optagid", 4, &sql, &sql_alloc);
+
+	lld_rules_hash_rows(rules, lld_ruleids,
+			"select o.itemid,t.lld_override_optemplateid,t.lld_override_operationid,t.templateid"
+			" from lld_override o,lld_override_operation op,lld_override_optemplate t"
+			" where o.lld_overrideid=op.lld_overrideid"
+				" and op.lld_override_operationid=t.lld_override_operationid"
+				" and",
+			"o.itemid", "t.lld_override_optemplateid", 3, &sql, &sql_alloc);
+
+	lld_rules_hash_rows(rules, lld_ruleids,
+			"select id.parent_itemid,t.triggerid,t.description,t.expression,t.recovery_expression,"
+				"t.recovery_mode,t.priority,t.comments,t.url,t.url_name,t.type,t.status,"
+				"t.correlation_mode,t.correlation_tag,t.manual_close,t.opdata,t.event_name,"
+				"t.discover,f.functionid,f.itemid,f.name,f.parameter"
+			" from item_discovery id,functions f,triggers t"
+			" where id.itemid=f.itemid"
+				" and f.triggerid=t.triggerid"
+				" and",
+			"id.parent_itemid", "t.triggerid,f.functionid", 21, &sql, &sql_alloc);
+
+	lld_rules_hash_rows(rules, lld_ruleids,
+			"select id.parent_itemid,tt.triggertagid,tt.triggerid,tt.tag,tt.value,f.functionid"
+			" from item_discovery id,functions f,trigger_tag tt"
+			" where id.itemid=f.itemid"
+				" and f.triggerid=tt.triggerid"
+				" and",
+			"id.parent_itemid", "tt.triggertagid,f.functionid", 5, &sql, &sql_alloc);
+
+	lld_rules_hash_rows(rules, lld_ruleids,
+			"select id.parent_itemid,g.graphid,g.name,g.width,g.height,g.yaxismin,g.yaxismax,"
+				"g.show_work_period,g.show_triggers,g.graphtype,g.show_legend,g.show_3d,"
+				"g.percent_left,g.percent_right,g.ymin_type,g.ymax_type,g.ymin_itemid,"
+				"g.ymax_itemid,g.discover,gi.gitemid,gi.itemid,gi.drawtype,gi.sortorder,gi.color,"
+				"gi.yaxisside,gi.calc_fnc,gi.type"
+			" from item_discovery id,graphs_items gi,graphs g"
+			" where id.itemid=gi.itemid"
+				" and gi.graphid=g.graphid"
+				" and",
+			"id.parent_itemid", "g.graphid,gi.gitemid", 26, &sql, &sql_alloc);
+
+	lld_rules_hash_rows(rules, lld_ruleids,
+			"select hd.parent_itemid,h.hostid,h.host,h.name,h.status,h.discover,h.custom_interfaces"
+			" from host_discovery hd,hosts h"
+			" where hd.hostid=h.hostid"
+				" and",
+			"hd.parent_itemid", "h.hostid", 6, &sql, &sql_alloc);
+
+	zbx_free(sql);
+
+	zbx_hashset_iter_reset(rules, &iter);
+	while (NULL != (rule = (zbx_lld_rule_data_t *)zbx_hashset_iter_next(&iter)))
+	{
+		zbx_uint64_t	revision;
+
+		revision = zbx_dc_get_host_macro_revision(rule->hostid);
+		zbx_md5_append(&rule->config_md5, (const md5_byte_t *)&revision, (int)sizeof(revision));
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: loads configuration, filter conditions and item prototypes of     *
+ *          multiple discovery rules with one query per table                 *
+ *                                                                            *
+ * Parameters: rules       - [OUT] discovery rule data, indexed by rule id    *
+ *             lld_ruleids - [IN] discovery rule ids                          *
+ *                                                                            *
+ * Comments: Trigger, graph and host prototypes and objects discovered        *
+ *           earlier are not prefetched, they are loaded per rule when the    *
+ *           rule is processed. The prototype configuration is only hashed    *
+ *           into configuration digest.                                       *
+ *                                                                            *
+ ******************************************************************************/
+void	lld_rules_prefetch(zbx_hashset_t *rules, const zbx_vector_uint64_t *lld_ruleids)
+{
+	zbx_db_result_t		result;
+	zbx_db_row_t		row;
+	zbx_lld_rule_data_t	*rule, rule_local;
+	char			*sql = NULL;
+	size_t			sql_alloc = 0, sql_offset = 0;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() rules:%d", __func__, lld_ruleids->values_num);
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
+			"select itemid,hostid,key_,evaltype,formula,lifetime"
+			" from items"
+			" where");
+	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "itemid", lld_ruleids->values,
+			lld_ruleids->values_num);
+
+	result = zbx_db_select("%s", sql);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		ZBX_STR2UINT64(rule_local.itemid, row[0]);
+
+		rule = (zbx_lld_rule_data_t *)zbx_hashset_insert(rules, &rule_local, sizeof(rule_local));
+
+		ZBX_STR2UINT64(rule->hostid, row[1]);
+		rule->key = zbx_strdup(NULL, row[2]);
+		rule->evaltype = atoi(row[3]);
+		rule->formula = zbx_strdup(NULL, row[4]);
+		rule->lifetime = zbx_strdup(NULL, row[5]);
+
+		zbx_vector_ptr_create(&rule->conditions);
+		zbx_vector_ptr_create(&rule->item_prototypes);
+
+		zbx_md5_init(&rule->config_md5);
+		lld_rule_data_hash_row(rule, row, 6);
+	}
+	zbx_db_free_result(result);
+
+	if (0 == rules->num_data)
+		goto out;
+
+	sql_offset = 0;
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
+			"select itemid,item_conditionid,macro,value,operator"
+			" from item_condition"
+			" where");
+	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "itemid", lld_ruleids->values,
+			lld_ruleids->values_num);
+
+	result = zbx_db_select("%s", sql);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		lld_condition_t	*condition;
+
+		ZBX_STR2UINT64(rule_local.itemid, row[0]);
+
+		if (NULL == (rule = (zbx_lld_rule_data_t *)zbx_hashset_search(rules, &rule_local)))
+			continue;
+
+		lld_rule_data_hash_row(rule, row, 5);
+
+		condition = (lld_condition_t *)zbx_malloc(NULL, sizeof(lld_condition_t));
+		ZBX_STR2UINT64(condition->id, row[1]);
+		condition->macro = zbx_strdup(NULL, row[2]);
+		condition->regexp = zbx_strdup(NULL, row[3]);
+		condition->op = (unsigned char)atoi(row[4]);
+		zbx_vector_expression_create(&condition->regexps);
+
+		zbx_vector_ptr_append(&rule->conditions, condition);
+	}
+	zbx_db_free_result(result);
+
+	lld_item_prototypes_get(rules, lld_ruleids);
+	lld_rules_hash_config(rules, lld_ruleids);
+out:
+	zbx_free(sql);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() rules:%d", __func__, rules->num_data);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates last check time of objects discovered by discovery rules  *
+ *          which received unchanged discovery value                          *
+ *                                                                            *
+ * Parameters: rules       - [IN] prefetched discovery rule data              *
+ *             lld_ruleids - [IN] discovery rule ids                          *
+ *             lastcheck   - [IN] the last check time                         *
+ *                                                                            *
+ * Comments: Discovered objects are still present in the discovery data, so   *
+ *           only their last check time must be updated to prevent them from  *
+ *           being treated as lost resources.                                 *
+ *                                                                            *
+ ******************************************************************************/
+void	lld_rules_refresh_lastcheck(zbx_hashset_t *rules, const zbx_vector_uint64_t *lld_ruleids, int lastcheck)
+{
+	zbx_vector_uint64_t	protoids, host_protoids;
+	zbx_lld_rule_data_t	*rule;
+	zbx_db_result_t		result;
+	zbx_db_row_t		row;
+	char			*sql = NULL;
+	size_t			sql_alloc = 0, sql_offset = 0;
+	int			i, j;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() rules:%d", __func__, lld_ruleids->values_num);
+
+	zbx_vector_uint64_create(&protoids);
+	zbx_vector_uint64_create(&host_protoids);
+
+	for (i = 0; i < lld_ruleids->values_num; i++)
+	{
+		if (NULL == (rule = (zbx_lld_rule_data_t *)zbx_hashset_search(rules, &lld_ruleids->values[i])))
+			continue;
+
+		for (j = 0; j < rule->item_prototypes.values_num; j++)
+		{
+			zbx_vector_uint64_append(&protoids,
+					((zbx_lld_item_prototype_t *)rule->item_prototypes.values[j])->itemid);
+		}
+	}
+
+	zbx_vector_uint64_sort(&protoids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, "select hostid from host_discovery where");
+	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "parent_itemid", lld_ruleids->values,
+			lld_ruleids->values_num);
+
+	result = zbx_db_select("%s", sql);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		zbx_uint64_t	hostid;
+
+		ZBX_STR2UINT64(hostid, row[0]);
+		zbx_vector_uint64_append(&host_protoids, hostid);
+	}
+	zbx_db_free_result(result);
+
+	if (0 == protoids.values_num && 0 == host_protoids.values_num)
+		goto out;
+
+	zbx_vector_uint64_sort(&host_protoids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	sql_offset = 0;
+	zbx_db_begin();
+	zbx_db_begin_multiple_update(&sql, &sql_alloc, &sql_offset);
+
+	if (0 != protoids.values_num)
+	{
+		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+				"update item_discovery set lastcheck=%d where ts_delete=0 and", lastcheck);
+		zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "parent_itemid", protoids.values,
+				protoids.values_num);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ";\n");
+
+		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+				"update trigger_discovery set lastcheck=%d"
+				" where ts_delete=0"
+					" and parent_triggerid in"
+						" (select f.triggerid from functions f where", lastcheck);
+		zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "f.itemid", protoids.values,
+				protoids.values_num);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ");\n");
+
+		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+				"update graph_discovery set lastcheck=%d"
+				" where ts_delete=0"
+					" and parent_graphid in"
+						" (select gi.graphid from graphs_items gi where", lastcheck);
+		zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "gi.itemid", protoids.values,
+				protoids.values_num);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ");\n");
+	}
+
+	if (0 != host_protoids.values_num)
+	{
+		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+				"update host_discovery set lastcheck=%d where ts_delete=0 and", lastcheck);
+		zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "parent_hostid", host_protoids.values,
+				host_protoids.values_num);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ";\n");
+
+		zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+				"update group_discovery set lastcheck=%d"
+				" where ts_delete=0"
+					" and parent_group_prototypeid in"
+						" (select group_prototypeid from group_prototype where", lastcheck);
+		zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "hostid", host_protoids.values,
+				host_protoids.values_num);
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, ");\n");
+	}
+
+	zbx_db_end_multiple_update(&sql, &sql_alloc, &sql_offset);
+
+	if (16 < sql_offset)
+		zbx_db_execute("%s", sql);
+
+	zbx_db_commit();
+out:
+	zbx_free(sql);
+	zbx_vector_uint64_destroy(&host_protoids);
+	zbx_vector_uint64_destroy(&protoids);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: add or update items, triggers and graphs for discovery item       *
  *                                                                            *
- * Parameters: lld_ruleid - [IN] discovery item identifier from database      *
- *             value      - [IN] received value from agent                    *
- *             error      - [OUT] error or informational message. Will be set *
- *                               to empty string on successful discovery      *
- *                               without additional information.              *
+ * Parameters: lld_ruleid  - [IN] discovery item identifier from database     *
+ *             rule        - [IN] prefetched discovery rule data, NULL if the *
+ *                                rule was not found in database              *
+ *             value       - [IN] received value from agent                   *
+ *             error       - [OUT] error or informational message. Will be    *
+ *                                 set to empty string on successful          *
+ *                                 discovery without additional information.  *
+ *             stage_times - [IN/OUT] time spent in processing stages         *
  *                                                                            *
  ******************************************************************************/
-int	lld_process_discovery_rule(zbx_uint64_t lld_ruleid, const char *value, char **error)
+int	lld_process_discovery_rule(zbx_uint64_t lld_ruleid, zbx_lld_rule_data_t *rule, const char *value,
+		char **error, md5_byte_t *rows_digest, unsigned char *digest_state, double *stage_times)
 {
-	zbx_db_result_t			result;
-	zbx_db_row_t			row;
 	zbx_uint64_t			hostid;
-	char				*discovery_key = NULL, *info = NULL;
+	char				*lifetime_str, *info = NULL;
 	int				lifetime, ret = SUCCEED, errcode;
+	double				sec;
 	zbx_vector_lld_macro_path_t	lld_macro_paths;
 	zbx_lld_filter_t		filter;
 	time_t				now;
@@ -1091,6 +1588,7 @@ int	lld_process_discovery_rule(zbx_uint64_t lld_ruleid, const char *value, char
 	zbx_dc_um_handle_t		*um_handle;
 	zbx_vector_lld_override_t	overrides;
 	zbx_vector_lld_row_t		lld_rows;
+	md5_byte_t			digest[ZBX_MD5_DIGEST_SIZE];
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64, __func__, lld_ruleid);
 
@@ -1111,43 +1609,32 @@ int	lld_process_discovery_rule(zbx_uint64_t lld_ruleid, const char *value, char
 		goto out;
 	}
 
-	result = zbx_db_select(
-			"select hostid,key_,evaltype,formula,lifetime"
-			" from items"
-			" where itemid=" ZBX_FS_UI64,
-			lld_ruleid);
-
-	if (NULL != (row = zbx_db_fetch(result)))
+	if (NULL == rule)
 	{
-		char	*lifetime_str;
+		zabbix_log(LOG_LEVEL_WARNING, "invalid discovery rule ID [" ZBX_FS_UI64 "]", lld_ruleid);
+		goto out;
+	}
 
-		ZBX_STR2UINT64(hostid, row[0]);
-		discovery_key = zbx_strdup(discovery_key, row[1]);
-		filter.evaltype = atoi(row[2]);
-		filter.expression = zbx_strdup(NULL, row[3]);
-		lifetime_str = zbx_strdup(NULL, row[4]);
-		zbx_substitute_simple_macros(NULL, NULL, NULL, NULL, &hostid, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-				&lifetime_str, ZBX_MACRO_TYPE_COMMON, NULL, 0);
-
-		if (SUCCEED != zbx_is_time_suffix(lifetime_str, &lifetime, ZBX_LENGTH_UNLIMITED))
-		{
-			zabbix_log(LOG_LEVEL_WARNING, "cannot process lost resources for the discovery rule \"%s:%s\":"
-					" \"%s\" is not a valid value",
-					zbx_host_string(hostid), discovery_key, lifetime_str);
-			lifetime = 25 * SEC_PER_YEAR;	/* max value for the field */
-		}
+	sec = zbx_time();
 
-		zbx_free(lifetime_str);
-	}
-	zbx_db_free_result(result);
+	hostid = rule->hostid;
+	filter.evaltype = rule->evaltype;
+	filter.expression = zbx_strdup(NULL, rule->formula);
+	lifetime_str = zbx_strdup(NULL, rule->lifetime);
+	zbx_substitute_simple_macros(NULL, NULL, NULL, NULL, &hostid, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+			&lifetime_str, ZBX_MACRO_TYPE_COMMON, NULL, 0);
 
-	if (NULL == row)
+	if (SUCCEED != zbx_is_time_suffix(lifetime_str, &lifetime, ZBX_LENGTH_UNLIMITED))
 	{
-		zabbix_log(LOG_LEVEL_WARNING, "invalid discovery rule ID [" ZBX_FS_UI64 "]", lld_ruleid);
-		goto out;
+		zabbix_log(LOG_LEVEL_WARNING, "cannot process lost resources for the discovery rule \"%s:%s\":"
+				" \"%s\" is not a valid value",
+				zbx_host_string(hostid), rule->key, lifetime_str);
+		lifetime = 25 * SEC_PER_YEAR;	/* max value for the field */
 	}
 
-	if (SUCCEED != lld_filter_load(&filter, lld_ruleid, &item, error))
+	zbx_free(lifetime_str);
+
+	if (SUCCEED != lld_filter_load(&filter, rule, &item, error))
 	{
 		ret = FAIL;
 		goto out;
@@ -1168,14 +1655,30 @@ int	lld_process_discovery_rule(zbx_uint64_t lld_ruleid, const char *value, char
 		goto out;
 	}
 
+	stage_times[ZBX_LLD_STAGE_ROWS] += zbx_time() - sec;
+
 	*error = zbx_strdup(*error, "");
 
+	lld_rows_digest(rule, lifetime, &lld_rows, digest);
+
+	if (ZBX_LLD_DIGEST_SET == *digest_state && 0 == memcmp(digest, rows_digest, ZBX_MD5_DIGEST_SIZE))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "filtered discovery rows have not changed, skipping update of"
+				" discovered objects");
+		*digest_state = ZBX_LLD_DIGEST_SKIPPED;
+		goto info;
+	}
+
+	*digest_state = ZBX_LLD_DIGEST_NONE;
 	now = time(NULL);
 
 	zbx_config_get(&cfg, ZBX_CONFIG_FLAGS_AUDITLOG_ENABLED | ZBX_CONFIG_FLAGS_AUDITLOG_MODE);
 	zbx_audit_init(cfg.auditlog_enabled, cfg.auditlog_mode, ZBX_AUDIT_LLD_CONTEXT);
 
-	if (SUCCEED != lld_update_items(hostid, lld_ruleid, &lld_rows, &lld_macro_paths, error, lifetime, now))
+	sec = zbx_time();
+
+	if (SUCCEED != lld_update_items(hostid, &rule->item_prototypes, &lld_rows, &lld_macro_paths, error, lifetime,
+			now))
 	{
 		zabbix_log(LOG_LEVEL_DEBUG, "cannot update/add items because parent host was removed while"
 				" processing lld rule");
@@ -1184,6 +1687,9 @@ int	lld_process_discovery_rule(zbx_uint64_t lld_ruleid, const char *value, char
 
 	lld_item_links_sort(&lld_rows);
 
+	stage_times[ZBX_LLD_STAGE_ITEMS] += zbx_time() - sec;
+	sec = zbx_time();
+
 	if (SUCCEED != lld_update_triggers(hostid, lld_ruleid, &lld_rows, &lld_macro_paths, error, lifetime, now))
 	{
 		zabbix_log(LOG_LEVEL_DEBUG, "cannot update/add triggers because parent host was removed while"
@@ -1191,6 +1697,9 @@ int	lld_process_discovery_rule(zbx_uint64_t lld_ruleid, const char *value, char
 		goto out;
 	}
 
+	stage_times[ZBX_LLD_STAGE_TRIGGERS] += zbx_time() - sec;
+	sec = zbx_time();
+
 	if (SUCCEED != lld_update_graphs(hostid, lld_ruleid, &lld_rows, &lld_macro_paths, error, lifetime, now))
 	{
 		zabbix_log(LOG_LEVEL_DEBUG, "cannot update/add graphs because parent host was removed while"
@@ -1198,8 +1707,16 @@ int	lld_process_discovery_rule(zbx_uint64_t lld_ruleid, const char *value, char
 		goto out;
 	}
 
+	stage_times[ZBX_LLD_STAGE_GRAPHS] += zbx_time() - sec;
+	sec = zbx_time();
+
 	lld_update_hosts(lld_ruleid, &lld_rows, &lld_macro_paths, error, lifetime, now);
 
+	stage_times[ZBX_LLD_STAGE_HOSTS] += zbx_time() - sec;
+
+	memcpy(rows_digest, digest, ZBX_MD5_DIGEST_SIZE);
+	*digest_state = ZBX_LLD_DIGEST_SET;
+info:
 	/* add informative warning to the error message about lack of data for macros used in filter */
 	if (NULL != info)
 		*error = zbx_strdcat(*error, info);
@@ -1207,7 +1724,6 @@ out:
 	zbx_audit_flush(ZBX_AUDIT_LLD_CONTEXT);
 	zbx_dc_config_clean_items(&item, &errcode, 1);
 	zbx_free(info);
-	zbx_free(discovery_key);
 
 	lld_filter_clean(&filter);
 
@@ -24,6 +24,7 @@
 #include "zbxjson.h"
 #include "zbxdbhigh.h"
 #include "zbxcacheconfig.h"
+#include "zbxhash.h"
 
 typedef struct
 {
@@ -153,6 +154,27 @@ typedef struct
 }
 zbx_lld_item_prototype_t;
 
+/* discovery rule configuration prefetched for a batch of rules */
+typedef struct
+{
+	zbx_uint64_t		itemid;
+	zbx_uint64_t		hostid;
+	char			*key;
+	char			*formula;
+	char			*lifetime;
+	int			evaltype;
+
+	/* filter conditions as stored in database, without macros expanded */
+	zbx_vector_ptr_t	conditions;
+
+	/* item prototypes, sorted by itemid */
+	zbx_vector_ptr_t	item_prototypes;
+
+	/* digest of the prefetched rule configuration, filter conditions and item prototypes */
+	md5_state_t		config_md5;
+}
+zbx_lld_rule_data_t;
+
 typedef struct zbx_lld_item_full_s zbx_lld_item_full_t;
 
 ZBX_VECTOR_STRUCT_DECL(lld_item_full, zbx_lld_item_full_t*)
@@ -303,7 +325,10 @@ void	lld_override_graph(const zbx_vector_lld_override_t *overrides, const char *
 int	lld_validate_item_override_no_discover(const zbx_vector_lld_override_t *overrides, const char *name,
 		unsigned char override_default);
 
-int	lld_update_items(zbx_uint64_t hostid, zbx_uint64_t lld_ruleid, zbx_vector_lld_row_t *lld_rows,
+void	lld_item_prototype_free(zbx_lld_item_prototype_t *item_prototype);
+void	lld_item_prototypes_get(zbx_hashset_t *rules, const zbx_vector_uint64_t *lld_ruleids);
+
+int	lld_update_items(zbx_uint64_t hostid, zbx_vector_ptr_t *item_prototypes, zbx_vector_lld_row_t *lld_rows,
 		const zbx_vector_lld_macro_path_t *lld_macro_paths, char **error, int lifetime, int lastcheck);
 
 void	lld_item_links_sort(zbx_vector_lld_row_t *lld_rows);
@@ -325,6 +350,13 @@ typedef void	(*get_object_info_f)(const void *object, zbx_uint64_t *id, int *dis
 void	lld_remove_lost_objects(const char *table, const char *id_name, const zbx_vector_ptr_t *objects,
 		int lifetime, int lastcheck, delete_ids_f cb, get_object_info_f cb_info);
 
-int	lld_process_discovery_rule(zbx_uint64_t lld_ruleid, const char *value, char **error);
+void	lld_rules_prefetch(zbx_hashset_t *rules, const zbx_vector_uint64_t *lld_ruleids);
+void	lld_rule_data_clean(zbx_lld_rule_data_t *rule);
+void	lld_rule_data_hash_row(zbx_lld_rule_data_t *rule, zbx_db_row_t row, int columns);
+void	lld_rule_value_digest(const zbx_lld_rule_data_t *rule, const char *value, md5_byte_t *digest);
+void	lld_rules_refresh_lastcheck(zbx_hashset_t *rules, const zbx_vector_uint64_t *lld_ruleids, int lastcheck);
+
+int	lld_process_discovery_rule(zbx_uint64_t lld_ruleid, zbx_lld_rule_data_t *rule, const char *value,
+		char **error, md5_byte_t *rows_digest, unsigned char *digest_state, double *stage_times);
 
 #endif
@@ -157,7 +157,7 @@ static void	lld_item_preproc_free(zbx_lld_item_preproc_t *op)
 	zbx_free(op);
 }
 
-static void	lld_item_prototype_free(zbx_lld_item_prototype_t *item_prototype)
+void	lld_item_prototype_free(zbx_lld_item_prototype_t *item_prototype)
 {
 	zbx_free(item_prototype->name);
 	zbx_free(item_prototype->key);
@@ -4180,25 +4180,56 @@ void	lld_item_links_sort(zbx_vector_lld_row_t *lld_rows)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: load discovery rule item prototypes                               *
+ * Purpose: adds item prototype property row to the configuration digest of   *
+ *          discovery rule it belongs to                                      *
  *                                                                            *
- * Parameters: lld_ruleid      - [IN] discovery rule id                       *
- *             item_prototypes - [OUT]                                        *
+ * Parameters: rules   - [IN/OUT] prefetched discovery rule data              *
+ *             row     - [IN] database row, the discovery rule id is stored   *
+ *                            after the hashed columns                        *
+ *             columns - [IN] number of columns to hash                       *
  *                                                                            *
  ******************************************************************************/
-static void	lld_item_prototypes_get(zbx_uint64_t lld_ruleid, zbx_vector_ptr_t *item_prototypes)
+static void	lld_item_prototype_hash_row(zbx_hashset_t *rules, zbx_db_row_t row, int columns)
+{
+	zbx_uint64_t		lld_ruleid;
+	zbx_lld_rule_data_t	*rule;
+
+	ZBX_STR2UINT64(lld_ruleid, row[columns]);
+
+	if (NULL != (rule = (zbx_lld_rule_data_t *)zbx_hashset_search(rules, &lld_ruleid)))
+		lld_rule_data_hash_row(rule, row, columns);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: load item prototypes of multiple discovery rules                  *
+ *                                                                            *
+ * Parameters: rules       - [IN/OUT] prefetched discovery rule data, item    *
+ *                                    prototypes are added to the rule they   *
+ *                                    belong to                               *
+ *             lld_ruleids - [IN] discovery rule ids                          *
+ *                                                                            *
+ ******************************************************************************/
+void	lld_item_prototypes_get(zbx_hashset_t *rules, const zbx_vector_uint64_t *lld_ruleids)
 {
 	zbx_db_result_t			result;
 	zbx_db_row_t				row;
 	zbx_lld_item_prototype_t	*item_prototype;
 	zbx_lld_item_preproc_t		*preproc_op;
 	zbx_item_param_t		*item_param;
-	zbx_uint64_t			itemid;
+	zbx_uint64_t			itemid, lld_ruleid;
 	int				index, i;
+	zbx_vector_ptr_t		item_prototypes;
+	zbx_lld_rule_data_t		*rule;
+	zbx_hashset_iter_t		iter;
+	char				*sql = NULL;
+	size_t				sql_alloc = 0, sql_offset = 0;
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() rules:%d", __func__, lld_ruleids->values_num);
 
-	result = zbx_db_select(
+	zbx_vector_ptr_create(&item_prototypes);
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
 			"select i.itemid,i.name,i.key_,i.type,i.value_type,i.delay,"
 				"i.history,i.trends,i.status,i.trapper_hosts,i.units,i.formula,"
 				"i.logtimefmt,i.valuemapid,i.params,i.ipmi_sensor,i.snmp_oid,i.authtype,"
@@ -4206,14 +4237,25 @@ static void	lld_item_prototypes_get(zbx_uint64_t lld_ruleid, zbx_vector_ptr_t *i
 				"i.jmx_endpoint,i.master_itemid,i.timeout,i.url,i.query_fields,"
 				"i.posts,i.status_codes,i.follow_redirects,i.post_type,i.http_proxy,i.headers,"
 				"i.retrieve_mode,i.request_method,i.output_format,i.ssl_cert_file,i.ssl_key_file,"
-				"i.ssl_key_password,i.verify_peer,i.verify_host,i.allow_traps,i.discover"
+				"i.ssl_key_password,i.verify_peer,i.verify_host,i.allow_traps,i.discover,"
+				"id.parent_itemid"
 			" from items i,item_discovery id"
 			" where i.itemid=id.itemid"
-				" and id.parent_itemid=" ZBX_FS_UI64,
-			lld_ruleid);
+				" and");
+	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "id.parent_itemid", lld_ruleids->values,
+			lld_ruleids->values_num);
+
+	result = zbx_db_select("%s", sql);
 
 	while (NULL != (row = zbx_db_fetch(result)))
 	{
+		ZBX_STR2UINT64(lld_ruleid, row[45]);
+
+		if (NULL == (rule = (zbx_lld_rule_data_t *)zbx_hashset_search(rules, &lld_ruleid)))
+			continue;
+
+		lld_rule_data_hash_row(rule, row, 45);
+
 		item_prototype = (zbx_lld_item_prototype_t *)zbx_malloc(NULL, sizeof(zbx_lld_item_prototype_t));
 
 		ZBX_STR2UINT64(item_prototype->itemid, row[0]);
@@ -4268,69 +4310,84 @@ static void	lld_item_prototypes_get(zbx_uint64_t lld_ruleid, zbx_vector_ptr_t *i
 		zbx_vector_item_param_ptr_create(&item_prototype->item_params);
 		zbx_vector_db_tag_ptr_create(&item_prototype->item_tags);
 
-		zbx_vector_ptr_append(item_prototypes, item_prototype);
+		zbx_vector_ptr_append(&rule->item_prototypes, item_prototype);
+		zbx_vector_ptr_append(&item_prototypes, item_prototype);
 	}
 	zbx_db_free_result(result);
 
-	zbx_vector_ptr_sort(item_prototypes, ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC);
+	/* prototypes of all rules are sorted by item id to look up preprocessing, parameters and tags */
+	zbx_vector_ptr_sort(&item_prototypes, ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC);
 
-	if (0 == item_prototypes->values_num)
+	if (0 == item_prototypes.values_num)
 		goto out;
 
 	/* get item prototype preprocessing options */
 
-	result = zbx_db_select(
-			"select ip.itemid,ip.step,ip.type,ip.params,ip.error_handler,ip.error_handler_params"
+	sql_offset = 0;
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
+			"select ip.itemid,ip.step,ip.type,ip.params,ip.error_handler,ip.error_handler_params,"
+				"id.parent_itemid"
 			" from item_preproc ip,item_discovery id"
 			" where ip.itemid=id.itemid"
-				" and id.parent_itemid=" ZBX_FS_UI64,
-			lld_ruleid);
+				" and");
+	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "id.parent_itemid", lld_ruleids->values,
+			lld_ruleids->values_num);
+
+	result = zbx_db_select("%s", sql);
 
 	while (NULL != (row = zbx_db_fetch(result)))
 	{
 		ZBX_STR2UINT64(itemid, row[0]);
 
-		if (FAIL == (index = zbx_vector_ptr_bsearch(item_prototypes, &itemid,
+		if (FAIL == (index = zbx_vector_ptr_bsearch(&item_prototypes, &itemid,
 				ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC)))
 		{
 			THIS_SHOULD_NEVER_HAPPEN;
 			continue;
 		}
 
-		item_prototype = (zbx_lld_item_prototype_t *)item_prototypes->values[index];
+		lld_item_prototype_hash_row(rules, row, 6);
+
+		item_prototype = (zbx_lld_item_prototype_t *)item_prototypes.values[index];
 		preproc_op = zbx_init_lld_item_preproc(0, ZBX_FLAG_LLD_ITEM_PREPROC_UNSET, atoi(row[1]), atoi(row[2]),
 				row[3], atoi(row[4]), row[5]);
 		zbx_vector_lld_item_preproc_append(&item_prototype->preproc_ops, preproc_op);
 	}
 	zbx_db_free_result(result);
 
-	for (i = 0; i < item_prototypes->values_num; i++)
+	for (i = 0; i < item_prototypes.values_num; i++)
 	{
-		item_prototype = (zbx_lld_item_prototype_t *)item_prototypes->values[i];
+		item_prototype = (zbx_lld_item_prototype_t *)item_prototypes.values[i];
 		zbx_vector_lld_item_preproc_sort(&item_prototype->preproc_ops, lld_item_preproc_sort_by_step);
 	}
 
 	/* get item prototype parameters */
 
-	result = zbx_db_select(
-			"select ip.itemid,ip.name,ip.value"
+	sql_offset = 0;
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
+			"select ip.itemid,ip.name,ip.value,id.parent_itemid"
 			" from item_parameter ip,item_discovery id"
 			" where ip.itemid=id.itemid"
-				" and id.parent_itemid=" ZBX_FS_UI64,
-			lld_ruleid);
+				" and");
+	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "id.parent_itemid", lld_ruleids->values,
+			lld_ruleids->values_num);
+
+	result = zbx_db_select("%s", sql);
 
 	while (NULL != (row = zbx_db_fetch(result)))
 	{
 		ZBX_STR2UINT64(itemid, row[0]);
 
-		if (FAIL == (index = zbx_vector_ptr_bsearch(item_prototypes, &itemid,
+		if (FAIL == (index = zbx_vector_ptr_bsearch(&item_prototypes, &itemid,
 				ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC)))
 		{
 			THIS_SHOULD_NEVER_HAPPEN;
 			continue;
 		}
 
-		item_prototype = (zbx_lld_item_prototype_t *)item_prototypes->values[index];
+		lld_item_prototype_hash_row(rules, row, 3);
+
+		item_prototype = (zbx_lld_item_prototype_t *)item_prototypes.values[index];
 		item_param = zbx_item_param_create(row[1], row[2]);
 		zbx_vector_item_param_ptr_append(&item_prototype->item_params, item_param);
 	}
@@ -4338,12 +4395,16 @@ static void	lld_item_prototypes_get(zbx_uint64_t lld_ruleid, zbx_vector_ptr_t *i
 
 	/* get item prototype tags */
 
-	result = zbx_db_select(
-			"select it.itemid,it.tag,it.value"
+	sql_offset = 0;
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
+			"select it.itemid,it.tag,it.value,id.parent_itemid"
 			" from item_tag it,item_discovery id"
 			" where it.itemid=id.itemid"
-				" and id.parent_itemid=" ZBX_FS_UI64,
-			lld_ruleid);
+				" and");
+	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "id.parent_itemid", lld_ruleids->values,
+			lld_ruleids->values_num);
+
+	result = zbx_db_select("%s", sql);
 
 	while (NULL != (row = zbx_db_fetch(result)))
 	{
@@ -4351,21 +4412,31 @@ static void	lld_item_prototypes_get(zbx_uint64_t lld_ruleid, zbx_vector_ptr_t *i
 
 		ZBX_STR2UINT64(itemid, row[0]);
 
-		if (FAIL == (index = zbx_vector_ptr_bsearch(item_prototypes, &itemid,
+		if (FAIL == (index = zbx_vector_ptr_bsearch(&item_prototypes, &itemid,
 				ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC)))
 		{
 			THIS_SHOULD_NEVER_HAPPEN;
 			continue;
 		}
 
-		item_prototype = (zbx_lld_item_prototype_t *)item_prototypes->values[index];
+		lld_item_prototype_hash_row(rules, row, 3);
+
+		item_prototype = (zbx_lld_item_prototype_t *)item_prototypes.values[index];
 
 		db_tag = zbx_db_tag_create(row[1], row[2]);
 		zbx_vector_db_tag_ptr_append(&item_prototype->item_tags, db_tag);
 	}
 	zbx_db_free_result(result);
 out:
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%d prototypes", __func__, item_prototypes->values_num);
+	zbx_hashset_iter_reset(rules, &iter);
+	while (NULL != (rule = (zbx_lld_rule_data_t *)zbx_hashset_iter_next(&iter)))
+		zbx_vector_ptr_sort(&rule->item_prototypes, ZBX_DEFAULT_UINT64_PTR_COMPARE_FUNC);
+
+	zbx_free(sql);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%d prototypes", __func__, item_prototypes.values_num);
+
+	zbx_vector_ptr_destroy(&item_prototypes);
 }
 
 /******************************************************************************
@@ -4410,49 +4481,49 @@ static void	lld_link_dependent_items(zbx_vector_lld_item_full_t *items, zbx_hash
  *                                                                            *
  * Purpose: add or update discovered items                                    *
  *                                                                            *
+ * Parameters: hostid          - [IN] discovery rule host id                  *
+ *             item_prototypes - [IN] prefetched discovery rule item          *
+ *                                    prototypes                              *
+ *                                                                            *
  * Return value: SUCCEED - if items were successfully added/updated or        *
  *                         adding/updating was not necessary                  *
  *               FAIL    - items cannot be added/updated                      *
  *                                                                            *
  ******************************************************************************/
-int	lld_update_items(zbx_uint64_t hostid, zbx_uint64_t lld_ruleid, zbx_vector_lld_row_t *lld_rows,
+int	lld_update_items(zbx_uint64_t hostid, zbx_vector_ptr_t *item_prototypes, zbx_vector_lld_row_t *lld_rows,
 		const zbx_vector_lld_macro_path_t *lld_macro_paths, char **error, int lifetime, int lastcheck)
 {
-	zbx_vector_ptr_t		item_prototypes, item_dependencies;
+	zbx_vector_ptr_t		item_dependencies;
 	zbx_hashset_t			items_index;
 	int				ret = SUCCEED, host_record_is_locked = 0;
 	zbx_vector_lld_item_full_t	items;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_vector_ptr_create(&item_prototypes);
-
-	lld_item_prototypes_get(lld_ruleid, &item_prototypes);
-
-	if (0 == item_prototypes.values_num)
+	if (0 == item_prototypes->values_num)
 		goto out;
 
 	zbx_vector_lld_item_full_create(&items);
-	zbx_hashset_create(&items_index, item_prototypes.values_num * lld_rows->values_num, lld_item_index_hash_func,
+	zbx_hashset_create(&items_index, item_prototypes->values_num * lld_rows->values_num, lld_item_index_hash_func,
 			lld_item_index_compare_func);
 	zbx_db_begin();
-	lld_items_get(&item_prototypes, &items);
+	lld_items_get(item_prototypes, &items);
 	zbx_db_commit();
-	lld_items_make(&item_prototypes, lld_rows, lld_macro_paths, &items, &items_index, error);
-	lld_items_preproc_make(&item_prototypes, lld_macro_paths, &items);
-	lld_items_param_make(&item_prototypes, lld_macro_paths, &items, error);
-	lld_items_tags_make(&item_prototypes, lld_macro_paths, &items, error);
+	lld_items_make(item_prototypes, lld_rows, lld_macro_paths, &items, &items_index, error);
+	lld_items_preproc_make(item_prototypes, lld_macro_paths, &items);
+	lld_items_param_make(item_prototypes, lld_macro_paths, &items, error);
+	lld_items_tags_make(item_prototypes, lld_macro_paths, &items, error);
 
 	lld_link_dependent_items(&items, &items_index);
 
 	zbx_vector_ptr_create(&item_dependencies);
-	lld_item_dependencies_get(&item_prototypes, &item_dependencies);
+	lld_item_dependencies_get(item_prototypes, &item_dependencies);
 
-	lld_items_validate(hostid, &items, &item_prototypes, &item_dependencies, error);
+	lld_items_validate(hostid, &items, item_prototypes, &item_dependencies, error);
 
 	zbx_db_begin();
 
-	if (SUCCEED == lld_items_save(hostid, &item_prototypes, &items, &items_index, &host_record_is_locked) &&
+	if (SUCCEED == lld_items_save(hostid, item_prototypes, &items, &items_index, &host_record_is_locked) &&
 			SUCCEED == lld_items_param_save(hostid, &items, &host_record_is_locked) &&
 			SUCCEED == lld_items_preproc_save(hostid, &items, &host_record_is_locked) &&
 			SUCCEED == lld_items_tags_save(hostid, &items, &host_record_is_locked))
@@ -4469,7 +4540,7 @@ int	lld_update_items(zbx_uint64_t hostid, zbx_uint64_t lld_ruleid, zbx_vector_ll
 		goto clean;
 	}
 
-	lld_item_links_populate(&item_prototypes, lld_rows, &items_index);
+	lld_item_links_populate(item_prototypes, lld_rows, &items_index);
 	lld_remove_lost_objects("item_discovery", "itemid", (const zbx_vector_ptr_t *)&items, lifetime, lastcheck,
 			zbx_db_delete_items, get_item_info);
 clean:
@@ -4480,11 +4551,7 @@ clean:
 
 	zbx_vector_lld_item_full_clear_ext(&items, lld_item_free);
 	zbx_vector_lld_item_full_destroy(&items);
-
-	zbx_vector_ptr_clear_ext(&item_prototypes, (zbx_clean_func_t)lld_item_prototype_free);
 out:
-	zbx_vector_ptr_destroy(&item_prototypes);
-
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 
 	return ret;
@@ -27,6 +27,7 @@
 #include "lld_protocol.h"
 #include "zbxstr.h"
 #include "zbxtime.h"
+#include "zbxcacheconfig.h"
 
 /*
  * The LLD queue is organized as a queue (rule_queue binary heap) of LLD rules,
@@ -41,8 +42,45 @@
  * values in the list the rule is removed from the index (rule_index hashset),
  * otherwise the rule is enqueued back in LLD queue.
  *
+ * Rules inherited from the same template rule on different hosts have the same
+ * filter and prototype structure. When the popped rule is inherited from template,
+ * the next queued rules are scanned for the same template rule and sent to worker
+ * in one task, so the worker can prefetch rule configuration and prototypes with
+ * one query per table.
+ *
+ * The manager keeps digests of the last fully processed value and of its filtered
+ * rows for each rule (rule_digests hashset). The digests are sent to the worker
+ * together with the new value, so a worker can skip the processing when neither
+ * value nor rule configuration have changed and only refresh the last check time
+ * of discovered objects. The configuration digest covers rule, filter, item, trigger,
+ * graph and host prototype rows, overrides, LLD macro paths and user macro revision.
+ * Full processing is still forced after the digests become older than
+ * ZBX_LLD_DIGEST_TTL, to apply prototype details that are not covered by the
+ * configuration digest (host prototype groups, templates, macros, interfaces and
+ * tags, trigger prototype dependencies) and to remove expired lost resources.
+ *
  */
 
+/* the maximum number of rules sent to worker in one task */
+#define ZBX_LLD_BATCH_MAX	32
+
+/* the maximum number of queued rules checked when looking for rules of the same template */
+#define ZBX_LLD_BATCH_SCAN	128
+
+/* the time after which value digests are discarded to force full rule processing */
+#define ZBX_LLD_DIGEST_TTL	SEC_PER_HOUR
+
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	md5_byte_t	value_digest[ZBX_MD5_DIGEST_SIZE];
+	md5_byte_t	rows_digest[ZBX_MD5_DIGEST_SIZE];
+
+	/* the time of the last full rule processing */
+	time_t		processed;
+}
+zbx_lld_rule_digest_t;
+
 typedef struct
 {
 	/* workers vector, created during manager initialization */
@@ -66,13 +104,20 @@ typedef struct
 	/* the number of queued LLD rules */
 	zbx_uint64_t		queued_num;
 
+	/* LLD processing statistics */
+	zbx_lld_stage_stats_t	stats;
+
+	/* digests of the last processed rule values, indexed by rule item id */
+	zbx_hashset_t		rule_digests;
 }
 zbx_lld_manager_t;
 
 typedef struct
 {
 	zbx_ipc_client_t	*client;
-	zbx_lld_rule_t		*rule;
+
+	/* the rules being processed by worker */
+	zbx_vector_ptr_t	rules;
 }
 zbx_lld_worker_t;
 
@@ -159,6 +204,8 @@ static void	lld_manager_init(zbx_lld_manager_t *manager, zbx_get_config_forks_f
 
 	zbx_binary_heap_create(&manager->rule_queue, rule_elem_compare_func, ZBX_BINARY_HEAP_OPTION_EMPTY);
 
+	zbx_hashset_create(&manager->rule_digests, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
 	manager->next_worker_index = 0;
 
 	for (i = 0; i < get_config_forks_cb(ZBX_PROCESS_TYPE_LLDWORKER); i++)
@@ -166,11 +213,13 @@ static void	lld_manager_init(zbx_lld_manager_t *manager, zbx_get_config_forks_f
 		worker = (zbx_lld_worker_t *)zbx_malloc(NULL, sizeof(zbx_lld_worker_t));
 
 		worker->client = NULL;
+		zbx_vector_ptr_create(&worker->rules);
 
 		zbx_vector_ptr_append(&manager->workers, worker);
 	}
 
 	manager->queued_num = 0;
+	memset(&manager->stats, 0, sizeof(manager->stats));
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
@@ -276,10 +325,13 @@ static void	lld_queue_request(zbx_lld_manager_t *manager, const zbx_ipc_message_
 
 	data = (zbx_lld_data_t *)zbx_malloc(NULL, sizeof(zbx_lld_data_t));
 	data->next = NULL;
+	data->digest_state = ZBX_LLD_DIGEST_NONE;
 
 	zbx_lld_deserialize_item_value(message->data, &data->itemid, &hostid, &data->value, &data->ts, &data->meta,
 			&data->lastlogsize, &data->mtime, &data->error);
 
+	zbx_dc_config_get_item_templateids(&data->itemid, &data->templateid, 1);
+
 	if (NULL == (rule = zbx_hashset_search(&manager->rule_index, &hostid)))
 	{
 		zbx_lld_rule_t	rule_local = {.hostid = hostid, .values_num = 0, .tail = data, .head = data};
@@ -339,17 +391,72 @@ static void	lld_process_next_request(zbx_lld_manager_t *manager, zbx_lld_worker_
 	zbx_binary_heap_elem_t	*elem;
 	unsigned char		*buf;
 	zbx_uint32_t		buf_len;
-	zbx_lld_data_t		*data;
+	zbx_lld_rule_t		*rule;
+	zbx_uint64_t		templateid;
+	const zbx_lld_data_t	**values;
+	int			i;
+	time_t			now;
 
 	elem = zbx_binary_heap_find_min(&manager->rule_queue);
-	worker->rule = (zbx_lld_rule_t *)elem->data;
+	rule = (zbx_lld_rule_t *)elem->data;
 	zbx_binary_heap_remove_min(&manager->rule_queue);
 
-	data = worker->rule->head;
-	buf_len = zbx_lld_serialize_item_value(&buf, data->itemid, 0, data->value, &data->ts, data->meta,
-			data->lastlogsize, data->mtime, data->error);
+	zbx_vector_ptr_append(&worker->rules, rule);
+
+	if (0 != (templateid = rule->head->templateid))
+	{
+		zbx_vector_ptr_t	skipped;
+
+		zbx_vector_ptr_create(&skipped);
+
+		for (i = 0; i < ZBX_LLD_BATCH_SCAN && ZBX_LLD_BATCH_MAX > worker->rules.values_num &&
+				SUCCEED != zbx_binary_heap_empty(&manager->rule_queue); i++)
+		{
+			elem = zbx_binary_heap_find_min(&manager->rule_queue);
+			rule = (zbx_lld_rule_t *)elem->data;
+			zbx_binary_heap_remove_min(&manager->rule_queue);
+
+			if (templateid == rule->head->templateid)
+				zbx_vector_ptr_append(&worker->rules, rule);
+			else
+				zbx_vector_ptr_append(&skipped, rule);
+		}
+
+		for (i = 0; i < skipped.values_num; i++)
+			lld_queue_rule(manager, (zbx_lld_rule_t *)skipped.values[i]);
+
+		zbx_vector_ptr_destroy(&skipped);
+	}
+
+	values = (const zbx_lld_data_t **)zbx_malloc(NULL, sizeof(zbx_lld_data_t *) *
+			(size_t)worker->rules.values_num);
+
+	now = time(NULL);
+
+	for (i = 0; i < worker->rules.values_num; i++)
+	{
+		zbx_lld_data_t		*data = ((zbx_lld_rule_t *)worker->rules.values[i])->head;
+		zbx_lld_rule_digest_t	*digest;
+
+		data->digest_state = ZBX_LLD_DIGEST_NONE;
+
+		if (NULL != (digest = (zbx_lld_rule_digest_t *)zbx_hashset_search(&manager->rule_digests,
+				&data->itemid)) && ZBX_LLD_DIGEST_TTL > now - digest->processed)
+		{
+			memcpy(data->value_digest, digest->value_digest, sizeof(data->value_digest));
+			memcpy(data->rows_digest, digest->rows_digest, sizeof(data->rows_digest));
+			data->digest_state = ZBX_LLD_DIGEST_SET;
+		}
+
+		values[i] = data;
+	}
+
+	buf_len = zbx_lld_serialize_task(&buf, values, worker->rules.values_num);
 	zbx_ipc_client_send(worker->client, ZBX_IPC_LLD_TASK, buf, buf_len);
 	zbx_free(buf);
+	zbx_free(values);
+
+	manager->stats.batches_num++;
 }
 
 /******************************************************************************
@@ -370,51 +477,158 @@ static void	lld_process_queue(zbx_lld_manager_t *manager)
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates rule digests with the value processing result             *
+ *                                                                            *
+ * Parameters: manager - [IN]                                                 *
+ *             data    - [IN] processed value                                 *
+ *             now     - [IN] current time                                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	lld_update_rule_digest(zbx_lld_manager_t *manager, const zbx_lld_data_t *data, time_t now)
+{
+	zbx_lld_rule_digest_t	*digest;
+
+	digest = (zbx_lld_rule_digest_t *)zbx_hashset_search(&manager->rule_digests, &data->itemid);
+
+	switch (data->digest_state)
+	{
+		case ZBX_LLD_DIGEST_NONE:
+			if (NULL != digest)
+				zbx_hashset_remove_direct(&manager->rule_digests, digest);
+			return;
+		case ZBX_LLD_DIGEST_SET:
+			if (NULL == digest)
+			{
+				zbx_lld_rule_digest_t	digest_local = {.itemid = data->itemid};
+
+				digest = (zbx_lld_rule_digest_t *)zbx_hashset_insert(&manager->rule_digests,
+						&digest_local, sizeof(digest_local));
+			}
+			digest->processed = now;
+			break;
+		case ZBX_LLD_DIGEST_SKIPPED:
+			manager->stats.skipped_num++;
+
+			/* keep the last full processing time, the digest could have been removed meanwhile */
+			if (NULL == digest)
+				return;
+			break;
+		default:
+			THIS_SHOULD_NEVER_HAPPEN;
+			return;
+	}
+
+	memcpy(digest->value_digest, data->value_digest, sizeof(digest->value_digest));
+	memcpy(digest->rows_digest, data->rows_digest, sizeof(digest->rows_digest));
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes expired rule digests                                      *
+ *                                                                            *
+ * Parameters: manager - [IN]                                                 *
+ *             now     - [IN] current time                                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	lld_remove_expired_digests(zbx_lld_manager_t *manager, time_t now)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_lld_rule_digest_t	*digest;
+
+	zbx_hashset_iter_reset(&manager->rule_digests, &iter);
+	while (NULL != (digest = (zbx_lld_rule_digest_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (ZBX_LLD_DIGEST_TTL <= now - digest->processed)
+			zbx_hashset_iter_remove(&iter);
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: processes LLD worker 'done' response                              *
  *                                                                            *
  * Parameters: manager - [IN]                                                 *
- * Parameters: client  - [IN] worker's IPC client connection                  *
+ *             client  - [IN] worker's IPC client connection                  *
+ *             message - [IN] response with processing stage timings and      *
+ *                            value digests                                   *
+ *                                                                            *
+ * Return value: The number of processed rule values                          *
  *                                                                            *
  ******************************************************************************/
-static void	lld_process_result(zbx_lld_manager_t *manager, zbx_ipc_client_t *client)
+static int	lld_process_result(zbx_lld_manager_t *manager, zbx_ipc_client_t *client,
+		const zbx_ipc_message_t *message)
 {
 	zbx_lld_worker_t	*worker;
 	zbx_lld_rule_t		*rule;
-	zbx_lld_data_t		*data;
+	zbx_lld_data_t		*data, **values;
+	double			stage_times[ZBX_LLD_STAGE_COUNT];
+	int			i, processed_num;
+	time_t			now;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	worker = lld_get_worker_by_client(manager, client);
 
-	zabbix_log(LOG_LEVEL_DEBUG, "discovery rule:" ZBX_FS_UI64 " has been processed", worker->rule->head->itemid);
-
-	rule = worker->rule;
-	worker->rule = NULL;
+	values = (zbx_lld_data_t **)zbx_malloc(NULL, sizeof(zbx_lld_data_t *) * (size_t)worker->rules.values_num);
 
-	data = rule->head;
-	rule->head = rule->head->next;
+	for (i = 0; i < worker->rules.values_num; i++)
+	{
+		values[i] = ((zbx_lld_rule_t *)worker->rules.values[i])->head;
+		values[i]->digest_state = ZBX_LLD_DIGEST_NONE;
+	}
 
-	if (NULL == rule->head)
+	if (0 != message->size)
 	{
-		zbx_hashset_remove_direct(&manager->rule_index, rule);
+		zbx_lld_deserialize_result(message->data, stage_times, values, worker->rules.values_num);
+
+		for (i = 0; i < ZBX_LLD_STAGE_COUNT; i++)
+			manager->stats.time[i] += stage_times[i];
 	}
-	else
+
+	zbx_free(values);
+
+	now = time(NULL);
+
+	for (i = 0; i < worker->rules.values_num; i++)
 	{
-		rule->head->prev = NULL;
-		rule->values_num--;
-		lld_queue_rule(manager, rule);
+		rule = (zbx_lld_rule_t *)worker->rules.values[i];
+
+		zabbix_log(LOG_LEVEL_DEBUG, "discovery rule:" ZBX_FS_UI64 " has been processed", rule->head->itemid);
+
+		data = rule->head;
+		lld_update_rule_digest(manager, data, now);
+
+		rule->head = rule->head->next;
+
+		if (NULL == rule->head)
+		{
+			zbx_hashset_remove_direct(&manager->rule_index, rule);
+		}
+		else
+		{
+			rule->head->prev = NULL;
+			rule->values_num--;
+			lld_queue_rule(manager, rule);
+		}
+
+		lld_data_free(data);
 	}
 
-	lld_data_free(data);
+	processed_num = worker->rules.values_num;
+	zbx_vector_ptr_clear(&worker->rules);
+
+	manager->stats.rules_num += (zbx_uint64_t)processed_num;
 
 	if (SUCCEED != zbx_binary_heap_empty(&manager->rule_queue))
 		lld_process_next_request(manager, worker);
 	else
 		zbx_queue_ptr_push(&manager->free_workers, worker);
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() processed:%d", __func__, processed_num);
+
+	return processed_num;
 }
 
 /******************************************************************************
@@ -422,15 +636,20 @@ static void	lld_process_result(zbx_lld_manager_t *manager, zbx_ipc_client_t *cli
  * Purpose: processes external diagnostic statistics request                  *
  *                                                                            *
  * Parameters: manager - [IN]                                                 *
- * Parameters: client  - [IN] external IPC connection                         *
+ *             service - [IN] LLD manager IPC service                         *
+ *             client  - [IN] external IPC connection                         *
  *                                                                            *
  ******************************************************************************/
-static void	lld_process_diag_stats(zbx_lld_manager_t *manager, zbx_ipc_client_t *client)
+static void	lld_process_diag_stats(zbx_lld_manager_t *manager, const zbx_ipc_service_t *service,
+		zbx_ipc_client_t *client)
 {
 	unsigned char	*data;
 	zbx_uint32_t	data_len;
+	zbx_ipc_stats_t	ipc_stats;
 
-	data_len = zbx_lld_serialize_diag_stats(&data, manager->rule_index.num_data, manager->queued_num);
+	zbx_ipc_service_get_stats(service, &ipc_stats);
+	data_len = zbx_lld_serialize_diag_stats(&data, manager->rule_index.num_data, manager->queued_num,
+			&manager->stats, &ipc_stats);
 	zbx_ipc_client_send(client, ZBX_IPC_LLD_DIAG_STATS_RESULT, data, data_len);
 	zbx_free(data);
 }
@@ -527,9 +746,10 @@ ZBX_THREAD_ENTRY(lld_manager_thread, args)
 	zbx_ipc_client_t	*client;
 	zbx_ipc_message_t	*message;
 	double			time_stat, time_now, sec, time_idle = 0;
+	time_t			digests_cleanup;
 	zbx_lld_manager_t	manager;
 	zbx_uint64_t		processed_num = 0;
-	int			ret;
+	int			ret, num;
 	zbx_timespec_t		timeout = {1, 0};
 	const zbx_thread_info_t	*info = &((zbx_thread_args_t *)args)->info;
 	int			server_num = ((zbx_thread_args_t *)args)->info.server_num;
@@ -550,10 +770,14 @@ ZBX_THREAD_ENTRY(lld_manager_thread, args)
 		exit(EXIT_FAILURE);
 	}
 
+	/* tasks and replies are written together when the messaging loop is processed */
+	zbx_ipc_service_set_send_mode(&lld_service, ZBX_IPC_SEND_BATCH);
+
 	lld_manager_init(&manager, args_in->get_process_forks_cb_arg);
 
 	/* initialize statistics */
 	time_stat = zbx_time();
+	digests_cleanup = time(NULL);
 
 	zbx_setproctitle("%s #%d started", get_process_type_string(process_type), process_num);
 
@@ -575,6 +799,12 @@ ZBX_THREAD_ENTRY(lld_manager_thread, args)
 			processed_num = 0;
 		}
 
+		if (ZBX_LLD_DIGEST_TTL <= time_now - digests_cleanup)
+		{
+			lld_remove_expired_digests(&manager, (time_t)time_now);
+			digests_cleanup = (time_t)time_now;
+		}
+
 		zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_IDLE);
 		ret = zbx_ipc_service_recv(&lld_service, &timeout, &client, &message);
 		zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_BUSY);
@@ -597,16 +827,16 @@ ZBX_THREAD_ENTRY(lld_manager_thread, args)
 					lld_process_queue(&manager);
 					break;
 				case ZBX_IPC_LLD_DONE:
-					lld_process_result(&manager, client);
-					processed_num++;
-					manager.queued_num--;
+					num = lld_process_result(&manager, client, message);
+					processed_num += (zbx_uint64_t)num;
+					manager.queued_num -= (zbx_uint64_t)num;
 					break;
 				case ZBX_IPC_LLD_QUEUE:
 					zbx_ipc_client_send(client, message->code, (unsigned char *)&manager.queued_num,
 							sizeof(zbx_uint64_t));
 					break;
 				case ZBX_IPC_LLD_DIAG_STATS:
-					lld_process_diag_stats(&manager, client);
+					lld_process_diag_stats(&manager, &lld_service, client);
 					break;
 				case ZBX_IPC_LLD_TOP_ITEMS:
 					lld_process_top_items(&manager, client, message);
@@ -22,12 +22,21 @@
 
 #include "zbxthreads.h"
 #include "zbxtime.h"
+#include "zbxhash.h"
+
+/* LLD rule value digest states */
+#define ZBX_LLD_DIGEST_NONE	0	/* digests are not known or value processing failed */
+#define ZBX_LLD_DIGEST_SET	1	/* digests of the last fully processed value */
+#define ZBX_LLD_DIGEST_SKIPPED	2	/* value was processed without object reconciliation */
 
 typedef struct zbx_lld_value
 {
 	/* the LLD rule id */
 	zbx_uint64_t		itemid;
 
+	/* the template LLD rule id, used to batch rules created from the same template */
+	zbx_uint64_t		templateid;
+
 	char			*value;
 	char			*error;
 	zbx_timespec_t		ts;
@@ -35,6 +44,12 @@ typedef struct zbx_lld_value
 	zbx_uint64_t		lastlogsize;
 	int			mtime;
 	unsigned char		meta;
+
+	/* digests of the value and of its filtered rows, combined with rule configuration digest */
+	md5_byte_t		value_digest[ZBX_MD5_DIGEST_SIZE];
+	md5_byte_t		rows_digest[ZBX_MD5_DIGEST_SIZE];
+	unsigned char		digest_state;
+
 	struct	zbx_lld_value	*prev;
 	struct	zbx_lld_value	*next;
 }
@@ -67,6 +82,33 @@ typedef struct
 }
 zbx_lld_rule_info_t;
 
+/* LLD processing stages timed by workers */
+#define ZBX_LLD_STAGE_PREFETCH	0
+#define ZBX_LLD_STAGE_ROWS	1
+#define ZBX_LLD_STAGE_ITEMS	2
+#define ZBX_LLD_STAGE_TRIGGERS	3
+#define ZBX_LLD_STAGE_GRAPHS	4
+#define ZBX_LLD_STAGE_HOSTS	5
+#define ZBX_LLD_STAGE_STATE	6
+#define ZBX_LLD_STAGE_REFRESH	7
+#define ZBX_LLD_STAGE_COUNT	8
+
+typedef struct
+{
+	/* total time spent in each processing stage, seconds */
+	double		time[ZBX_LLD_STAGE_COUNT];
+
+	/* the number of processed LLD rule values */
+	zbx_uint64_t	rules_num;
+
+	/* the number of tasks sent to workers, each task can contain multiple rule values */
+	zbx_uint64_t	batches_num;
+
+	/* the number of rule values processed without object reconciliation */
+	zbx_uint64_t	skipped_num;
+}
+zbx_lld_stage_stats_t;
+
 typedef struct
 {
 	zbx_get_config_forks_f	get_process_forks_cb_arg;
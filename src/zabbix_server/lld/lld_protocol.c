@@ -80,28 +80,301 @@ void	zbx_lld_deserialize_item_value(const unsigned char *data, zbx_uint64_t *ite
 	}
 }
 
-zbx_uint32_t	zbx_lld_serialize_diag_stats(unsigned char **data, zbx_uint64_t items_num, zbx_uint64_t values_num)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: serializes batch of LLD rule values for a worker                  *
+ *                                                                            *
+ * Parameters: data       - [OUT] serialized data                             *
+ *             values     - [IN] rule values to process                       *
+ *             values_num - [IN] number of values                             *
+ *                                                                            *
+ * Return value: The size of serialized data                                  *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint32_t	zbx_lld_serialize_task(unsigned char **data, const zbx_lld_data_t **values, int values_num)
+{
+	unsigned char	*ptr;
+	zbx_uint32_t	data_len = 0, *value_len, *error_len;
+	int		i;
+
+	value_len = (zbx_uint32_t *)zbx_malloc(NULL, sizeof(zbx_uint32_t) * (size_t)values_num);
+	error_len = (zbx_uint32_t *)zbx_malloc(NULL, sizeof(zbx_uint32_t) * (size_t)values_num);
+
+	zbx_serialize_prepare_value(data_len, values_num);
+
+	for (i = 0; i < values_num; i++)
+	{
+		const zbx_lld_data_t	*value = values[i];
+
+		zbx_serialize_prepare_value(data_len, value->itemid);
+		zbx_serialize_prepare_str_len(data_len, value->value, value_len[i]);
+		zbx_serialize_prepare_value(data_len, value->ts);
+		zbx_serialize_prepare_str_len(data_len, value->error, error_len[i]);
+		zbx_serialize_prepare_value(data_len, value->meta);
+
+		if (0 != value->meta)
+		{
+			zbx_serialize_prepare_value(data_len, value->lastlogsize);
+			zbx_serialize_prepare_value(data_len, value->mtime);
+		}
+
+		zbx_serialize_prepare_value(data_len, value->digest_state);
+
+		if (ZBX_LLD_DIGEST_NONE != value->digest_state)
+		{
+			zbx_serialize_prepare_value(data_len, value->value_digest);
+			zbx_serialize_prepare_value(data_len, value->rows_digest);
+		}
+	}
+
+	*data = (unsigned char *)zbx_malloc(NULL, data_len);
+
+	ptr = *data;
+	ptr += zbx_serialize_value(ptr, values_num);
+
+	for (i = 0; i < values_num; i++)
+	{
+		const zbx_lld_data_t	*value = values[i];
+
+		ptr += zbx_serialize_value(ptr, value->itemid);
+		ptr += zbx_serialize_str(ptr, value->value, value_len[i]);
+		ptr += zbx_serialize_value(ptr, value->ts);
+		ptr += zbx_serialize_str(ptr, value->error, error_len[i]);
+		ptr += zbx_serialize_value(ptr, value->meta);
+
+		if (0 != value->meta)
+		{
+			ptr += zbx_serialize_value(ptr, value->lastlogsize);
+			ptr += zbx_serialize_value(ptr, value->mtime);
+		}
+
+		ptr += zbx_serialize_value(ptr, value->digest_state);
+
+		if (ZBX_LLD_DIGEST_NONE != value->digest_state)
+		{
+			ptr += zbx_serialize_value(ptr, value->value_digest);
+			ptr += zbx_serialize_value(ptr, value->rows_digest);
+		}
+	}
+
+	zbx_free(error_len);
+	zbx_free(value_len);
+
+	return data_len;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: deserializes batch of LLD rule values                             *
+ *                                                                            *
+ * Parameters: data   - [IN] serialized data                                  *
+ *             values - [OUT] rule values, must be freed by the caller        *
+ *                                                                            *
+ * Return value: The number of deserialized values                            *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_lld_deserialize_task(const unsigned char *data, zbx_lld_data_t **values)
+{
+	zbx_uint32_t	value_len, error_len;
+	int		i, values_num;
+
+	data += zbx_deserialize_value(data, &values_num);
+
+	*values = (zbx_lld_data_t *)zbx_malloc(NULL, sizeof(zbx_lld_data_t) * (size_t)values_num);
+
+	for (i = 0; i < values_num; i++)
+	{
+		zbx_lld_data_t	*value = &(*values)[i];
+
+		data += zbx_deserialize_value(data, &value->itemid);
+		data += zbx_deserialize_str(data, &value->value, value_len);
+		data += zbx_deserialize_value(data, &value->ts);
+		data += zbx_deserialize_str(data, &value->error, error_len);
+		data += zbx_deserialize_value(data, &value->meta);
+
+		if (0 != value->meta)
+		{
+			data += zbx_deserialize_value(data, &value->lastlogsize);
+			data += zbx_deserialize_value(data, &value->mtime);
+		}
+		else
+		{
+			value->lastlogsize = 0;
+			value->mtime = 0;
+		}
+
+		data += zbx_deserialize_value(data, &value->digest_state);
+
+		if (ZBX_LLD_DIGEST_NONE != value->digest_state)
+		{
+			data += zbx_deserialize_value(data, &value->value_digest);
+			data += zbx_deserialize_value(data, &value->rows_digest);
+		}
+
+		value->templateid = 0;
+		value->prev = NULL;
+		value->next = NULL;
+	}
+
+	return values_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: serializes LLD task processing result                             *
+ *                                                                            *
+ * Parameters: data        - [OUT] serialized data                            *
+ *             stage_times - [IN] time spent in processing stages             *
+ *             values      - [IN] processed values with updated digests       *
+ *             values_num  - [IN] number of values                            *
+ *                                                                            *
+ * Return value: The size of serialized data                                  *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint32_t	zbx_lld_serialize_result(unsigned char **data, const double *stage_times,
+		const zbx_lld_data_t *values, int values_num)
 {
 	unsigned char	*ptr;
 	zbx_uint32_t	data_len = 0;
+	int		i;
+
+	for (i = 0; i < ZBX_LLD_STAGE_COUNT; i++)
+		zbx_serialize_prepare_value(data_len, stage_times[i]);
+
+	zbx_serialize_prepare_value(data_len, values_num);
+
+	for (i = 0; i < values_num; i++)
+	{
+		zbx_serialize_prepare_value(data_len, values[i].digest_state);
+
+		if (ZBX_LLD_DIGEST_NONE != values[i].digest_state)
+		{
+			zbx_serialize_prepare_value(data_len, values[i].value_digest);
+			zbx_serialize_prepare_value(data_len, values[i].rows_digest);
+		}
+	}
+
+	*data = (unsigned char *)zbx_malloc(NULL, data_len);
+
+	for (ptr = *data, i = 0; i < ZBX_LLD_STAGE_COUNT; i++)
+		ptr += zbx_serialize_value(ptr, stage_times[i]);
+
+	ptr += zbx_serialize_value(ptr, values_num);
+
+	for (i = 0; i < values_num; i++)
+	{
+		ptr += zbx_serialize_value(ptr, values[i].digest_state);
+
+		if (ZBX_LLD_DIGEST_NONE != values[i].digest_state)
+		{
+			ptr += zbx_serialize_value(ptr, values[i].value_digest);
+			ptr += zbx_serialize_value(ptr, values[i].rows_digest);
+		}
+	}
+
+	return data_len;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: deserializes LLD task processing result                           *
+ *                                                                            *
+ * Parameters: data        - [IN] serialized data                             *
+ *             stage_times - [OUT] time spent in processing stages            *
+ *             values      - [OUT] values to update with the new digests,     *
+ *                                 in the same order as sent in task          *
+ *             values_num  - [IN] number of values                            *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_lld_deserialize_result(const unsigned char *data, double *stage_times, zbx_lld_data_t **values,
+		int values_num)
+{
+	int	i, num;
+
+	for (i = 0; i < ZBX_LLD_STAGE_COUNT; i++)
+		data += zbx_deserialize_value(data, &stage_times[i]);
+
+	data += zbx_deserialize_value(data, &num);
+
+	if (num != values_num)
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		num = MIN(num, values_num);
+	}
+
+	for (i = 0; i < num; i++)
+	{
+		zbx_lld_data_t	*value = values[i];
+
+		data += zbx_deserialize_value(data, &value->digest_state);
+
+		if (ZBX_LLD_DIGEST_NONE != value->digest_state)
+		{
+			data += zbx_deserialize_value(data, &value->value_digest);
+			data += zbx_deserialize_value(data, &value->rows_digest);
+		}
+	}
+}
+
+zbx_uint32_t	zbx_lld_serialize_diag_stats(unsigned char **data, zbx_uint64_t items_num, zbx_uint64_t values_num,
+		const zbx_lld_stage_stats_t *stats, const zbx_ipc_stats_t *ipc_stats)
+{
+	unsigned char	*ptr;
+	zbx_uint32_t	data_len = 0;
+	int		i;
 
 	zbx_serialize_prepare_value(data_len, items_num);
 	zbx_serialize_prepare_value(data_len, values_num);
+	zbx_serialize_prepare_value(data_len, stats->rules_num);
+	zbx_serialize_prepare_value(data_len, stats->batches_num);
+	zbx_serialize_prepare_value(data_len, stats->skipped_num);
+
+	for (i = 0; i < ZBX_LLD_STAGE_COUNT; i++)
+		zbx_serialize_prepare_value(data_len, stats->time[i]);
+
+	zbx_serialize_prepare_value(data_len, ipc_stats->rx_messages);
+	zbx_serialize_prepare_value(data_len, ipc_stats->rx_reads);
+	zbx_serialize_prepare_value(data_len, ipc_stats->tx_messages);
+	zbx_serialize_prepare_value(data_len, ipc_stats->tx_writes);
 
 	*data = (unsigned char *)zbx_malloc(NULL, data_len);
 
 	ptr = *data;
 	ptr += zbx_serialize_value(ptr, items_num);
-	(void)zbx_serialize_value(ptr, values_num);
+	ptr += zbx_serialize_value(ptr, values_num);
+	ptr += zbx_serialize_value(ptr, stats->rules_num);
+	ptr += zbx_serialize_value(ptr, stats->batches_num);
+	ptr += zbx_serialize_value(ptr, stats->skipped_num);
+
+	for (i = 0; i < ZBX_LLD_STAGE_COUNT; i++)
+		ptr += zbx_serialize_value(ptr, stats->time[i]);
+
+	ptr += zbx_serialize_value(ptr, ipc_stats->rx_messages);
+	ptr += zbx_serialize_value(ptr, ipc_stats->rx_reads);
+	ptr += zbx_serialize_value(ptr, ipc_stats->tx_messages);
+	(void)zbx_serialize_value(ptr, ipc_stats->tx_writes);
 
 	return data_len;
 }
 
 static void	zbx_lld_deserialize_diag_stats(const unsigned char *data, zbx_uint64_t *items_num,
-		zbx_uint64_t *values_num)
+		zbx_uint64_t *values_num, zbx_lld_stage_stats_t *stats, zbx_ipc_stats_t *ipc_stats)
 {
+	int	i;
+
 	data += zbx_deserialize_value(data, items_num);
-	(void)zbx_deserialize_value(data, values_num);
+	data += zbx_deserialize_value(data, values_num);
+	data += zbx_deserialize_value(data, &stats->rules_num);
+	data += zbx_deserialize_value(data, &stats->batches_num);
+	data += zbx_deserialize_value(data, &stats->skipped_num);
+
+	for (i = 0; i < ZBX_LLD_STAGE_COUNT; i++)
+		data += zbx_deserialize_value(data, &stats->time[i]);
+
+	data += zbx_deserialize_value(data, &ipc_stats->rx_messages);
+	data += zbx_deserialize_value(data, &ipc_stats->rx_reads);
+	data += zbx_deserialize_value(data, &ipc_stats->tx_messages);
+	(void)zbx_deserialize_value(data, &ipc_stats->tx_writes);
 }
 
 static zbx_uint32_t	zbx_lld_serialize_top_items_request(unsigned char **data, int limit)
@@ -296,7 +569,8 @@ out:
  * Purpose: get lld manager diagnostic statistics                             *
  *                                                                            *
  ******************************************************************************/
-int	zbx_lld_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num, char **error)
+int	zbx_lld_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num, zbx_lld_stage_stats_t *stats,
+		zbx_ipc_stats_t *ipc_stats, char **error)
 {
 	unsigned char	*result;
 
@@ -306,7 +580,7 @@ int	zbx_lld_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num, ch
 		return FAIL;
 	}
 
-	zbx_lld_deserialize_diag_stats(result, items_num, values_num);
+	zbx_lld_deserialize_diag_stats(result, items_num, values_num, stats, ipc_stats);
 	zbx_free(result);
 
 	return SUCCEED;
@@ -23,6 +23,7 @@
 #include "zbxalgo.h"
 #include "lld_manager.h"
 #include "zbxtime.h"
+#include "zbxipcservice.h"
 
 #define ZBX_IPC_SERVICE_LLD	"lld"
 
@@ -59,7 +60,16 @@ void	zbx_lld_deserialize_item_value(const unsigned char *data, zbx_uint64_t *ite
 		char **value, zbx_timespec_t *ts, unsigned char *meta, zbx_uint64_t *lastlogsize, int *mtime,
 		char **error);
 
-zbx_uint32_t	zbx_lld_serialize_diag_stats(unsigned char **data, zbx_uint64_t items_num, zbx_uint64_t values_num);
+zbx_uint32_t	zbx_lld_serialize_task(unsigned char **data, const zbx_lld_data_t **values, int values_num);
+int	zbx_lld_deserialize_task(const unsigned char *data, zbx_lld_data_t **values);
+
+zbx_uint32_t	zbx_lld_serialize_result(unsigned char **data, const double *stage_times,
+		const zbx_lld_data_t *values, int values_num);
+void	zbx_lld_deserialize_result(const unsigned char *data, double *stage_times, zbx_lld_data_t **values,
+		int values_num);
+
+zbx_uint32_t	zbx_lld_serialize_diag_stats(unsigned char **data, zbx_uint64_t items_num, zbx_uint64_t values_num,
+		const zbx_lld_stage_stats_t *stats, const zbx_ipc_stats_t *ipc_stats);
 
 void	zbx_lld_deserialize_top_items_request(const unsigned char *data, int *limit);
 
@@ -74,7 +84,8 @@ void	zbx_lld_process_agent_result(zbx_uint64_t itemid, zbx_uint64_t hostid, AGEN
 
 int	zbx_lld_get_queue_size(zbx_uint64_t *size, char **error);
 
-int	zbx_lld_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num, char **error);
+int	zbx_lld_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num, zbx_lld_stage_stats_t *stats,
+		zbx_ipc_stats_t *ipc_stats, char **error);
 
 int	zbx_lld_get_top_items(int limit, zbx_vector_uint64_pair_t *items, char **error);
 
@@ -50,124 +50,277 @@ static void	lld_register_worker(zbx_ipc_socket_t *socket)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: processes lld task and updates rule state/error in configuration  *
- *          cache and database                                                *
+ * Purpose: checks if discovery value matches the last fully processed value  *
+ *                                                                            *
+ * Parameters: value - [IN/OUT] LLD rule value, value digest is updated if    *
+ *                              the value has changed                         *
+ *             rule  - [IN] prefetched LLD rule data (can be NULL)            *
  *                                                                            *
- * Parameters: message - [IN] message with LLD request                        *
+ * Return value: SUCCEED - the value and rule configuration have not changed  *
+ *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static void	lld_process_task(zbx_ipc_message_t *message)
+static int	lld_value_is_unchanged(zbx_lld_data_t *value, const zbx_lld_rule_data_t *rule)
 {
-	zbx_uint64_t		itemid, hostid, lastlogsize;
-	char			*value, *error;
-	zbx_timespec_t		ts;
-	zbx_item_diff_t		diff;
-	zbx_dc_item_t		item;
-	int			errcode, mtime;
-	unsigned char		state, meta;
+	md5_byte_t	digest[ZBX_MD5_DIGEST_SIZE];
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+	if (NULL != value->error || NULL == rule)
+		return FAIL;
+
+	lld_rule_value_digest(rule, value->value, digest);
 
-	zbx_lld_deserialize_item_value(message->data, &itemid, &hostid, &value, &ts, &meta, &lastlogsize, &mtime,
-			&error);
+	if (ZBX_LLD_DIGEST_SET == value->digest_state && 0 == memcmp(digest, value->value_digest, sizeof(digest)))
+		return SUCCEED;
 
-	zbx_dc_config_get_items_by_itemids(&item, &itemid, &errcode, 1);
+	memcpy(value->value_digest, digest, sizeof(digest));
 
-	if (SUCCEED != errcode)
-		goto out;
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes lld rule value and prepares rule state/error changes    *
+ *                                                                            *
+ * Parameters: value       - [IN] LLD rule value                              *
+ *             item        - [IN] LLD rule configuration cache data           *
+ *             rule        - [IN] prefetched LLD rule data (can be NULL)      *
+ *             diff        - [OUT] rule changes                               *
+ *             events_num  - [IN/OUT] number of generated internal events     *
+ *             refresh     - [OUT] rules with unchanged discovery value       *
+ *             stage_times - [IN/OUT] time spent in processing stages         *
+ *                                                                            *
+ * Comments: Value digest is compared with the digest of the last fully       *
+ *           processed value. When they match, or when filtered rows match    *
+ *           the last processed rows, the discovered objects are up to date   *
+ *           and only their last check time must be refreshed.                *
+ *                                                                            *
+ ******************************************************************************/
+static void	lld_process_value(zbx_lld_data_t *value, const zbx_dc_item_t *item, zbx_lld_rule_data_t *rule,
+		zbx_item_diff_t *diff, int *events_num, zbx_vector_uint64_t *refresh, double *stage_times)
+{
+	unsigned char	state;
 
-	zabbix_log(LOG_LEVEL_DEBUG, "processing discovery rule:" ZBX_FS_UI64, itemid);
+	zabbix_log(LOG_LEVEL_DEBUG, "processing discovery rule:" ZBX_FS_UI64, value->itemid);
 
-	diff.flags = ZBX_FLAGS_ITEM_DIFF_UNSET;
+	diff->itemid = value->itemid;
+	diff->flags = ZBX_FLAGS_ITEM_DIFF_UNSET;
 
-	if (NULL != error || NULL != value)
+	if (NULL != value->error || NULL != value->value)
 	{
-		if (NULL == error && SUCCEED == lld_process_discovery_rule(itemid, value, &error))
+		if (SUCCEED == lld_value_is_unchanged(value, rule))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "discovery rule:" ZBX_FS_UI64 " value has not changed, skipping"
+					" processing", value->itemid);
+
+			value->digest_state = ZBX_LLD_DIGEST_SKIPPED;
+			zbx_vector_uint64_append(refresh, value->itemid);
 			state = ITEM_STATE_NORMAL;
+		}
+		else if (NULL == value->error && SUCCEED == lld_process_discovery_rule(value->itemid, rule,
+				value->value, &value->error, value->rows_digest, &value->digest_state, stage_times))
+		{
+			/* filtered rows have not changed, discovered objects must be kept from expiring */
+			if (ZBX_LLD_DIGEST_SKIPPED == value->digest_state)
+				zbx_vector_uint64_append(refresh, value->itemid);
+
+			state = ITEM_STATE_NORMAL;
+		}
 		else
 			state = ITEM_STATE_NOTSUPPORTED;
 
-		if (state != item.state)
+		if (ITEM_STATE_NORMAL != state || NULL == rule)
+			value->digest_state = ZBX_LLD_DIGEST_NONE;
+
+		if (state != item->state)
 		{
-			diff.state = state;
-			diff.flags |= ZBX_FLAGS_ITEM_DIFF_UPDATE_STATE;
+			diff->state = state;
+			diff->flags |= ZBX_FLAGS_ITEM_DIFF_UPDATE_STATE;
 
 			if (ITEM_STATE_NORMAL == state)
 			{
 				zabbix_log(LOG_LEVEL_WARNING, "discovery rule \"%s:%s\" became supported",
-						item.host.host, item.key_orig);
+						item->host.host, item->key_orig);
 
-				zbx_add_event(EVENT_SOURCE_INTERNAL, EVENT_OBJECT_LLDRULE, itemid, &ts,
+				zbx_add_event(EVENT_SOURCE_INTERNAL, EVENT_OBJECT_LLDRULE, value->itemid, &value->ts,
 						ITEM_STATE_NORMAL, NULL, NULL, NULL, 0, 0, NULL, 0, NULL, 0, NULL,
 						NULL, NULL);
 			}
 			else
 			{
 				zabbix_log(LOG_LEVEL_WARNING, "discovery rule \"%s:%s\" became not supported: %s",
-						item.host.host, item.key_orig, error);
+						item->host.host, item->key_orig, value->error);
 
-				zbx_add_event(EVENT_SOURCE_INTERNAL, EVENT_OBJECT_LLDRULE, itemid, &ts,
+				zbx_add_event(EVENT_SOURCE_INTERNAL, EVENT_OBJECT_LLDRULE, value->itemid, &value->ts,
 						ITEM_STATE_NOTSUPPORTED, NULL, NULL, NULL, 0, 0, NULL, 0, NULL, 0,
-						NULL, NULL, error);
+						NULL, NULL, value->error);
 			}
 
-			zbx_db_begin();
-			zbx_process_events(NULL, NULL);
-			zbx_db_commit();
-
-			zbx_clean_events();
+			(*events_num)++;
 		}
 
-		/* with successful LLD processing LLD error will be set to empty string */
-		if (NULL != error && 0 != strcmp(error, ZBX_NULL2EMPTY_STR(item.error)))
+		/* with successful LLD processing LLD error will be set to empty string, */
+		/* while skipped processing leaves it unchanged                           */
+		if (NULL != value->error && 0 != strcmp(value->error, ZBX_NULL2EMPTY_STR(item->error)))
 		{
-			diff.error = error;
-			diff.flags |= ZBX_FLAGS_ITEM_DIFF_UPDATE_ERROR;
+			diff->error = value->error;
+			diff->flags |= ZBX_FLAGS_ITEM_DIFF_UPDATE_ERROR;
 		}
 	}
+	else
+		value->digest_state = ZBX_LLD_DIGEST_NONE;
 
-	if (0 != meta)
+	if (0 != value->meta)
 	{
-		if (item.lastlogsize != lastlogsize)
+		if (item->lastlogsize != value->lastlogsize)
 		{
-			diff.lastlogsize = lastlogsize;
-			diff.flags |= ZBX_FLAGS_ITEM_DIFF_UPDATE_LASTLOGSIZE;
+			diff->lastlogsize = value->lastlogsize;
+			diff->flags |= ZBX_FLAGS_ITEM_DIFF_UPDATE_LASTLOGSIZE;
 		}
-		if (item.mtime != mtime)
+		if (item->mtime != value->mtime)
 		{
-			diff.mtime = mtime;
-			diff.flags |= ZBX_FLAGS_ITEM_DIFF_UPDATE_MTIME;
+			diff->mtime = value->mtime;
+			diff->flags |= ZBX_FLAGS_ITEM_DIFF_UPDATE_MTIME;
 		}
 	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes lld task and updates rule state/error in configuration  *
+ *          cache and database                                                *
+ *                                                                            *
+ * Parameters: socket  - [IN] connection to LLD manager                       *
+ *             message - [IN] message with LLD task                           *
+ *                                                                            *
+ * Return value: The number of processed rule values                          *
+ *                                                                            *
+ * Comments: The task contains values of rules sharing the same template      *
+ *           rule. Only their configuration, filter conditions and item       *
+ *           prototypes are loaded with one query per table. Trigger, graph   *
+ *           and host prototypes and existing discovered objects are still    *
+ *           loaded per rule and discovered objects are written row by row.   *
+ *           Rule state changes are flushed together. The result with stage   *
+ *           timings and updated value digests is sent back to LLD manager.   *
+ *                                                                            *
+ ******************************************************************************/
+static int	lld_process_task(zbx_ipc_socket_t *socket, zbx_ipc_message_t *message)
+{
+	zbx_lld_data_t		*values;
+	zbx_dc_item_t		*items;
+	zbx_item_diff_t		*diffs;
+	zbx_vector_uint64_t	itemids, refresh;
+	zbx_vector_ptr_t	changes;
+	zbx_hashset_t		rules;
+	int			*errcodes, values_num, events_num = 0, i;
+	double			sec, stage_times[ZBX_LLD_STAGE_COUNT] = {0};
+	unsigned char		*data;
+	zbx_uint32_t		data_len;
 
-	if (ZBX_FLAGS_ITEM_DIFF_UNSET != diff.flags)
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	values_num = zbx_lld_deserialize_task(message->data, &values);
+
+	zbx_vector_uint64_create(&itemids);
+	zbx_vector_uint64_create(&refresh);
+	zbx_vector_ptr_create(&changes);
+
+	for (i = 0; i < values_num; i++)
+		zbx_vector_uint64_append(&itemids, values[i].itemid);
+
+	items = (zbx_dc_item_t *)zbx_malloc(NULL, sizeof(zbx_dc_item_t) * (size_t)values_num);
+	errcodes = (int *)zbx_malloc(NULL, sizeof(int) * (size_t)values_num);
+	diffs = (zbx_item_diff_t *)zbx_malloc(NULL, sizeof(zbx_item_diff_t) * (size_t)values_num);
+
+	zbx_dc_config_get_items_by_itemids(items, itemids.values, errcodes, (size_t)values_num);
+
+	sec = zbx_time();
+
+	zbx_hashset_create_ext(&rules, (size_t)values_num, ZBX_DEFAULT_UINT64_HASH_FUNC,
+			ZBX_DEFAULT_UINT64_COMPARE_FUNC, (zbx_clean_func_t)lld_rule_data_clean,
+			ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+
+	lld_rules_prefetch(&rules, &itemids);
+
+	stage_times[ZBX_LLD_STAGE_PREFETCH] = zbx_time() - sec;
+
+	for (i = 0; i < values_num; i++)
+	{
+		zbx_lld_rule_data_t	*rule;
+
+		if (SUCCEED != errcodes[i])
+		{
+			values[i].digest_state = ZBX_LLD_DIGEST_NONE;
+			continue;
+		}
+
+		rule = (zbx_lld_rule_data_t *)zbx_hashset_search(&rules, &values[i].itemid);
+		lld_process_value(&values[i], &items[i], rule, &diffs[i], &events_num, &refresh, stage_times);
+
+		if (ZBX_FLAGS_ITEM_DIFF_UNSET != diffs[i].flags)
+			zbx_vector_ptr_append(&changes, &diffs[i]);
+	}
+
+	sec = zbx_time();
+
+	if (0 != events_num)
 	{
-		zbx_vector_ptr_t	diffs;
-		char			*sql = NULL;
-		size_t			sql_alloc = 0, sql_offset = 0;
+		zbx_db_begin();
+		zbx_process_events(NULL, NULL);
+		zbx_db_commit();
 
-		zbx_vector_ptr_create(&diffs);
-		diff.itemid = itemid;
-		zbx_vector_ptr_append(&diffs, &diff);
+		zbx_clean_events();
+	}
+
+	if (0 != changes.values_num)
+	{
+		char	*sql = NULL;
+		size_t	sql_alloc = 0, sql_offset = 0;
 
 		zbx_db_begin_multiple_update(&sql, &sql_alloc, &sql_offset);
-		zbx_db_save_item_changes(&sql, &sql_alloc, &sql_offset, &diffs, ZBX_FLAGS_ITEM_DIFF_UPDATE_DB);
+		zbx_db_save_item_changes(&sql, &sql_alloc, &sql_offset, &changes, ZBX_FLAGS_ITEM_DIFF_UPDATE_DB);
 		zbx_db_end_multiple_update(&sql, &sql_alloc, &sql_offset);
 		if (16 < sql_offset)
 			zbx_db_execute("%s", sql);
 
-		zbx_dc_config_items_apply_changes(&diffs);
+		zbx_dc_config_items_apply_changes(&changes);
 
-		zbx_vector_ptr_destroy(&diffs);
 		zbx_free(sql);
 	}
 
-	zbx_dc_config_clean_items(&item, &errcode, 1);
-out:
-	zbx_free(value);
-	zbx_free(error);
+	stage_times[ZBX_LLD_STAGE_STATE] = zbx_time() - sec;
+
+	if (0 != refresh.values_num)
+	{
+		sec = zbx_time();
+		lld_rules_refresh_lastcheck(&rules, &refresh, (int)time(NULL));
+		stage_times[ZBX_LLD_STAGE_REFRESH] = zbx_time() - sec;
+	}
+
+	data_len = zbx_lld_serialize_result(&data, stage_times, values, values_num);
+	zbx_ipc_socket_write(socket, ZBX_IPC_LLD_DONE, data, data_len);
+	zbx_free(data);
+
+	zbx_dc_config_clean_items(items, errcodes, (size_t)values_num);
+	zbx_hashset_destroy(&rules);
+
+	for (i = 0; i < values_num; i++)
+	{
+		zbx_free(values[i].value);
+		zbx_free(values[i].error);
+	}
+
+	zbx_free(diffs);
+	zbx_free(errcodes);
+	zbx_free(items);
+	zbx_free(values);
+
+	zbx_vector_ptr_destroy(&changes);
+	zbx_vector_uint64_destroy(&refresh);
+	zbx_vector_uint64_destroy(&itemids);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() values:%d", __func__, values_num);
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+	return values_num;
 }
 
 ZBX_THREAD_ENTRY(lld_worker_thread, args)
@@ -237,9 +390,7 @@ ZBX_THREAD_ENTRY(lld_worker_thread, args)
 		switch (message.code)
 		{
 			case ZBX_IPC_LLD_TASK:
-				lld_process_task(&message);
-				zbx_ipc_socket_write(&lld_socket, ZBX_IPC_LLD_DONE, NULL, 0);
-				processed_num++;
+				processed_num += (zbx_uint64_t)lld_process_task(&lld_socket, &message);
 				break;
 		}
 
@@ -151,9 +151,9 @@ static const char	*help_message[] = {
 	"        process-type              All processes of specified type",
 	"                                  (alerter, alert manager, availability manager, configuration syncer,",
 	"                                  configuration syncer worker, connector manager, connector worker,",
-	"                                  discovery manager, escalator, ha manager, history poller, history syncer,",
-	"                                  housekeeper, http poller, icmp pinger, internal poller, ipmi manager,",
-	"                                  ipmi poller, java poller, odbc poller, poller, agent poller,",
+	"                                  discovery manager, escalator, export writer, ha manager, history poller,",
+	"                                  history syncer, housekeeper, http poller, icmp pinger, internal poller,",
+	"                                  ipmi manager, ipmi poller, java poller, odbc poller, poller, agent poller,",
 	"                                  http agent poller, snmp poller, preprocessing manager, proxy poller,",
 	"                                  self-monitoring, service manager, snmp trapper,",
 	"                                  task manager, timer, trapper, unreachable poller, vmware collector)",
@@ -164,9 +164,9 @@ static const char	*help_message[] = {
 	"        process-type              All processes of specified type",
 	"                                  (alerter, alert manager, availability manager, configuration syncer,",
 	"                                  configuration syncer worker, connector manager, connector worker,",
-	"                                  discovery manager, escalator, ha manager, history poller, history syncer,",
-	"                                  housekeeper, http poller, icmp pinger, internal poller, ipmi manager,",
-	"                                  ipmi poller, java poller, odbc poller, poller, agent poller,",
+	"                                  discovery manager, escalator, export writer, ha manager, history poller,",
+	"                                  history syncer, housekeeper, http poller, icmp pinger, internal poller,",
+	"                                  ipmi manager, ipmi poller, java poller, odbc poller, poller, agent poller,",
 	"                                  http agent poller, snmp poller, preprocessing manager, proxy poller,",
 	"                                  self-monitoring, service manager, snmp trapper,",
 	"                                  task manager, timer, trapper, unreachable poller, vmware collector)",
@@ -268,7 +268,8 @@ int	CONFIG_FORKS[ZBX_PROCESS_TYPE_COUNT] = {
 	1, /* ZBX_PROCESS_TYPE_AGENT_POLLER */
 	1, /* ZBX_PROCESS_TYPE_SNMP_POLLER */
 	1, /* ZBX_PROCESS_TYPE_INTERNAL_POLLER */
-	1 /* ZBX_PROCESS_TYPE_DBCONFIGWORKER */
+	1, /* ZBX_PROCESS_TYPE_DBCONFIGWORKER */
+	0 /* ZBX_PROCESS_TYPE_EXPORTWRITER */
 };
 
 static int	get_config_forks(unsigned char process_type)
@@ -283,6 +284,7 @@ ZBX_GET_CONFIG_VAR2(char *, const char *, zbx_config_source_ip, NULL)
 ZBX_GET_CONFIG_VAR2(char *, const char *, zbx_config_tmpdir, NULL)
 ZBX_GET_CONFIG_VAR2(char *, const char *, zbx_config_fping_location, NULL)
 ZBX_GET_CONFIG_VAR2(char *, const char *, zbx_config_fping6_location, NULL)
+ZBX_GET_CONFIG_VAR(int, zbx_config_native_ping, 0)
 ZBX_GET_CONFIG_VAR2(char *, const char *, zbx_config_alert_scripts_path, NULL)
 ZBX_GET_CONFIG_VAR(int, zbx_config_timeout, 3)
 int	zbx_config_trapper_timeout = 300;
@@ -297,6 +299,8 @@ static char	*config_server		= NULL;		/* not used in zabbix_server, required for
 
 static int	config_housekeeping_frequency	= 1;
 static int	config_max_housekeeper_delete	= 5000;		/* applies for every separate field value */
+static int	config_housekeeping_partitions	= 0;
+static int	config_housekeeper_delete_workers	= 1;
 static int	config_confsyncer_frequency	= 10;
 
 static int	config_problemhousekeeping_frequency = 60;
@@ -308,14 +312,18 @@ static int	config_vmware_timeout		= 10;
 static zbx_uint64_t	config_conf_cache_size		= 32 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_history_cache_size	= 16 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_history_index_cache_size	= 4 * ZBX_MEBIBYTE;
+static int		config_history_sync_batch_min	= 100;
+static int		config_history_sync_batch_max	= 1000;
 static zbx_uint64_t	config_trends_cache_size	= 4 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_trend_func_cache_size	= 4 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_value_cache_size		= 8 * ZBX_MEBIBYTE;
+static char		*config_value_cache_snapshot_file	= NULL;
 static zbx_uint64_t	config_vmware_cache_size	= 8 * ZBX_MEBIBYTE;
 
 static int	config_unreachable_period		= 45;
 static int	config_unreachable_delay		= 15;
 static int	config_max_concurrent_checks_per_poller	= 1000;
+static int	config_snmp_async_get			= 1;
 static int	config_log_level		= LOG_LEVEL_WARNING;
 static char	*config_externalscripts		= NULL;
 static int	config_allow_unsupported_db_versions = 0;
@@ -345,7 +353,7 @@ static char	*config_ssl_cert_location = NULL;
 static char	*config_ssl_key_location = NULL;
 
 static zbx_config_tls_t		*zbx_config_tls = NULL;
-static zbx_config_export_t	zbx_config_export = {NULL, NULL, ZBX_GIBIBYTE};
+static zbx_config_export_t	zbx_config_export = {NULL, NULL, ZBX_GIBIBYTE, NULL, 0, 0};
 static zbx_config_vault_t	zbx_config_vault = {NULL, NULL, NULL, NULL, NULL, NULL};
 static zbx_config_dbhigh_t	*zbx_config_dbhigh = NULL;
 
@@ -457,6 +465,11 @@ int	get_process_info_by_thread(int local_server_num, unsigned char *local_proces
 		*local_process_type = ZBX_PROCESS_TYPE_DISCOVERYMANAGER;
 		*local_process_num = local_server_num - server_count + CONFIG_FORKS[ZBX_PROCESS_TYPE_DISCOVERYMANAGER];
 	}
+	else if (local_server_num <= (server_count += CONFIG_FORKS[ZBX_PROCESS_TYPE_EXPORTWRITER]))
+	{
+		*local_process_type = ZBX_PROCESS_TYPE_EXPORTWRITER;
+		*local_process_num = local_server_num - server_count + CONFIG_FORKS[ZBX_PROCESS_TYPE_EXPORTWRITER];
+	}
 	else if (local_server_num <= (server_count += CONFIG_FORKS[ZBX_PROCESS_TYPE_HISTSYNCER]))
 	{
 		*local_process_type = ZBX_PROCESS_TYPE_HISTSYNCER;
@@ -669,6 +682,11 @@ static void	zbx_set_defaults(void)
 
 	if (0 != CONFIG_FORKS[ZBX_PROCESS_TYPE_DISCOVERER])
 		CONFIG_FORKS[ZBX_PROCESS_TYPE_DISCOVERYMANAGER] = 1;
+
+	if (NULL == zbx_config_export.dir)
+		CONFIG_FORKS[ZBX_PROCESS_TYPE_EXPORTWRITER] = 0;
+
+	zbx_config_export.writers_num = CONFIG_FORKS[ZBX_PROCESS_TYPE_EXPORTWRITER];
 }
 
 /******************************************************************************
@@ -697,6 +715,13 @@ static void	zbx_validate_config(ZBX_TASK_EX *task)
 		err = 1;
 	}
 
+	if (config_history_sync_batch_min > config_history_sync_batch_max)
+	{
+		zabbix_log(LOG_LEVEL_CRIT, "\"HistorySyncBatchMin\" configuration parameter must not be greater than"
+				" \"HistorySyncBatchMax\"");
+		err = 1;
+	}
+
 	if (0 != config_value_cache_size && 128 * ZBX_KIBIBYTE > config_value_cache_size)
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "\"ValueCacheSize\" configuration parameter must be either 0"
@@ -860,24 +885,36 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"HistoryIndexCacheSize",	&config_history_index_cache_size,	TYPE_UINT64,
 			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
+		{"HistorySyncBatchMin",		&config_history_sync_batch_min,		TYPE_INT,
+			PARM_OPT,	10,			100000},
+		{"HistorySyncBatchMax",		&config_history_sync_batch_max,		TYPE_INT,
+			PARM_OPT,	10,			100000},
 		{"TrendCacheSize",		&config_trends_cache_size,		TYPE_UINT64,
 			PARM_OPT,	128 * ZBX_KIBIBYTE,	__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"TrendFunctionCacheSize",	&config_trend_func_cache_size,		TYPE_UINT64,
 			PARM_OPT,	0,			__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"ValueCacheSize",		&config_value_cache_size,		TYPE_UINT64,
 			PARM_OPT,	0,			__UINT64_C(64) * ZBX_GIBIBYTE},
+		{"ValueCacheSnapshotFile",	&config_value_cache_snapshot_file,	TYPE_STRING,
+			PARM_OPT,	0,			0},
 		{"CacheUpdateFrequency",	&config_confsyncer_frequency,		TYPE_INT,
 			PARM_OPT,	1,			SEC_PER_HOUR},
 		{"HousekeepingFrequency",	&config_housekeeping_frequency,		TYPE_INT,
 			PARM_OPT,	0,			24},
 		{"MaxHousekeeperDelete",	&config_max_housekeeper_delete,		TYPE_INT,
 			PARM_OPT,	0,			1000000},
+		{"HousekeepingPartitions",	&config_housekeeping_partitions,	TYPE_INT,
+			PARM_OPT,	0,			365},
+		{"HousekeeperDeleteWorkers",	&config_housekeeper_delete_workers,	TYPE_INT,
+			PARM_OPT,	1,			HK_DELETE_WORKERS_MAX},
 		{"TmpDir",			&zbx_config_tmpdir,			TYPE_STRING,
 			PARM_OPT,	0,			0},
 		{"FpingLocation",		&zbx_config_fping_location,		TYPE_STRING,
 			PARM_OPT,	0,			0},
 		{"Fping6Location",		&zbx_config_fping6_location,		TYPE_STRING,
 			PARM_OPT,	0,			0},
+		{"NativePing",			&zbx_config_native_ping,		TYPE_INT,
+			PARM_OPT,	0,			1},
 		{"Timeout",			&zbx_config_timeout,			TYPE_INT,
 			PARM_OPT,	1,			30},
 		{"TrapperTimeout",		&zbx_config_trapper_timeout,		TYPE_INT,
@@ -1020,6 +1057,12 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	0,			0},
 		{"ExportFileSize",		&(zbx_config_export.file_size),		TYPE_UINT64,
 			PARM_OPT,	ZBX_MEBIBYTE,	ZBX_GIBIBYTE},
+		{"ExportFileRotatePeriod",	&(zbx_config_export.file_rotate_period),	TYPE_INT,
+			PARM_OPT,	0,			SEC_PER_DAY},
+		{"ExportCompression",		&(zbx_config_export.compression),		TYPE_STRING,
+			PARM_OPT,	0,			0},
+		{"StartExportWriters",		&CONFIG_FORKS[ZBX_PROCESS_TYPE_EXPORTWRITER],	TYPE_INT,
+			PARM_OPT,	0,			100},
 		{"StartLLDProcessors",		&CONFIG_FORKS[ZBX_PROCESS_TYPE_LLDWORKER],		TYPE_INT,
 			PARM_OPT,	1,			100},
 		{"StatsAllowedIP",		&config_stats_allowed_ip,		TYPE_STRING_LIST,
@@ -1050,6 +1093,8 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 			PARM_OPT,	0,			1000},
 		{"StartSNMPPollers",			&CONFIG_FORKS[ZBX_PROCESS_TYPE_SNMP_POLLER],	TYPE_INT,
 			PARM_OPT,	0,			1000},
+		{"SNMPAsyncGet",			&config_snmp_async_get,	TYPE_INT,
+			PARM_OPT,	0,			1},
 		{"MaxConcurrentChecksPerPoller",	&config_max_concurrent_checks_per_poller,	TYPE_INT,
 			PARM_OPT,	1,			1000},
 		{"VPSLimit",			&config_vps_limit,	TYPE_INT,
@@ -1122,6 +1167,14 @@ static void	zbx_on_exit(int ret)
 
 		zbx_free_configuration_cache();
 
+		/* save value cache contents after history cache flush to start warm on next launch */
+		if (NULL != config_value_cache_snapshot_file &&
+				SUCCEED != zbx_vc_dump(config_value_cache_snapshot_file, CONFIG_HA_NODE_NAME, &error))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot save value cache snapshot: %s", error);
+			zbx_free(error);
+		}
+
 		/* free history value cache */
 		zbx_vc_destroy();
 
@@ -1174,7 +1227,8 @@ int	main(int argc, char **argv)
 		get_zbx_config_fping_location,
 		get_zbx_config_fping6_location,
 		get_zbx_config_tmpdir,
-		get_zbx_progname};
+		get_zbx_progname,
+		get_zbx_config_native_ping};
 
 	ZBX_TASK_EX			t = {ZBX_TASK_START};
 	char				ch;
@@ -1417,6 +1471,44 @@ static void	zbx_db_save_server_status(void)
 	zbx_json_free(&json);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets the last time other HA cluster nodes could write history     *
+ *                                                                            *
+ * Return value: the last access time of other running HA nodes or 0 if       *
+ *               server is not running in HA cluster                          *
+ *                                                                            *
+ * Comments: Standby nodes are ignored as they do not process data.           *
+ *                                                                            *
+ ******************************************************************************/
+static int	server_get_ha_nodes_lastaccess(void)
+{
+	zbx_db_result_t	result;
+	zbx_db_row_t	row;
+	char		*name_esc;
+	int		lastaccess = 0;
+
+	if (NULL == CONFIG_HA_NODE_NAME || '\0' == *CONFIG_HA_NODE_NAME)
+		return 0;
+
+	zbx_db_connect(ZBX_DB_CONNECT_NORMAL);
+
+	name_esc = zbx_db_dyn_escape_string(CONFIG_HA_NODE_NAME);
+
+	result = zbx_db_select("select max(lastaccess) from ha_node where name<>'%s' and status<>%d", name_esc,
+			ZBX_NODE_STATUS_STANDBY);
+
+	if (NULL != (row = zbx_db_fetch(result)) && SUCCEED != zbx_db_is_null(row[0]))
+		lastaccess = atoi(row[0]);
+
+	zbx_db_free_result(result);
+	zbx_free(name_esc);
+
+	zbx_db_close();
+
+	return lastaccess;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: initialize shared resources and start processes                   *
@@ -1465,7 +1557,9 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 							zbx_config_tls->key_file, zbx_config_source_ip,
 							zbx_config_webservice_url};
 	zbx_thread_housekeeper_args	housekeeper_args = {&db_version_info, zbx_config_timeout,
-							config_housekeeping_frequency, config_max_housekeeper_delete};
+							config_housekeeping_frequency, config_max_housekeeper_delete,
+							config_housekeeping_partitions,
+							config_housekeeper_delete_workers};
 	zbx_thread_server_trigger_housekeeper_args	trigger_housekeeper_args = {zbx_config_timeout,
 							config_problemhousekeeping_frequency};
 	zbx_thread_taskmanager_args	taskmanager_args = {zbx_config_timeout, config_startup_time};
@@ -1504,7 +1598,8 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 								config_service_manager_sync_frequency};
 
 	if (SUCCEED != zbx_init_database_cache(get_zbx_program_type, zbx_sync_server_history, config_history_cache_size,
-			config_history_index_cache_size, &config_trends_cache_size, &error))
+			config_history_index_cache_size, &config_trends_cache_size, config_history_sync_batch_min,
+			config_history_sync_batch_max, &error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize database cache: %s", error);
 		zbx_free(error);
@@ -1512,7 +1607,7 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 	}
 
 	if (SUCCEED != zbx_init_configuration_cache(get_zbx_program_type, get_config_forks, config_conf_cache_size,
-			&error))
+			config_snmp_async_get, &error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize configuration cache: %s", error);
 		zbx_free(error);
@@ -1542,6 +1637,13 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 		return FAIL;
 	}
 
+	if (NULL != config_value_cache_snapshot_file && SUCCEED != zbx_vc_load(config_value_cache_snapshot_file,
+			CONFIG_HA_NODE_NAME, server_get_ha_nodes_lastaccess(), &error))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot load value cache snapshot: %s", error);
+		zbx_free(error);
+	}
+
 	if (SUCCEED != zbx_tfc_init(config_trend_func_cache_size, &error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize trends read cache: %s", error);
@@ -1694,6 +1796,10 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 				thread_args.args = &discoverer_args;
 				zbx_thread_start(discoverer_thread, &thread_args, &zbx_threads[i]);
 				break;
+			case ZBX_PROCESS_TYPE_EXPORTWRITER:
+				threads_flags[i] = ZBX_THREAD_PRIORITY_SECOND;
+				zbx_thread_start(zbx_export_writer_thread, &thread_args, &zbx_threads[i]);
+				break;
 			case ZBX_PROCESS_TYPE_HISTSYNCER:
 				threads_flags[i] = ZBX_THREAD_PRIORITY_FIRST;
 				thread_args.args = &dbsyncer_args;
@@ -2150,7 +2256,8 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 	}
 
 	if (SUCCEED != zbx_init_database_cache(get_zbx_program_type, zbx_sync_server_history, config_history_cache_size,
-			config_history_index_cache_size, &config_trends_cache_size, &error))
+			config_history_index_cache_size, &config_trends_cache_size, config_history_sync_batch_min,
+			config_history_sync_batch_max, &error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize database cache: %s", error);
 		zbx_free(error);
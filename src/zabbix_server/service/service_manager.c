@@ -622,6 +622,10 @@ static void	sync_services(zbx_service_manager_t *service_manager, int *updated,
 			zbx_vector_service_problem_ptr_create(&service_local.service_problems);
 			zbx_vector_service_rule_ptr_create(&service_local.status_rules);
 			service_local.name = zbx_strdup(NULL, row[3]);
+			service_local.children_stats_valid = 0;
+			service_local.stats_status = ZBX_SERVICE_STATUS_IGNORED;
+			service_local.stats_weight = 0;
+			service_local.height = ZBX_SERVICE_HEIGHT_UNKNOWN;
 
 			service = zbx_hashset_insert(&service_manager->services, &service_local, sizeof(service_local));
 
@@ -1302,6 +1306,203 @@ int	service_get_status(const zbx_service_t	*service, int *status)
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: accounts children with specified status in children statistics    *
+ *                                                                            *
+ * Parameters: stats  - [IN/OUT] children statistics                          *
+ *             status - [IN] propagated child status                          *
+ *             weight - [IN] child weight                                     *
+ *             num    - [IN] number of children to add (negative to remove)   *
+ *                                                                            *
+ * Comments: Statuses above the highest severity are accounted as the         *
+ *           highest severity.                                                *
+ *                                                                            *
+ ******************************************************************************/
+static void	service_children_stats_add(zbx_service_children_stats_t *stats, int status, int weight, int num)
+{
+	int	index;
+
+	if (ZBX_SERVICE_STATUS_IGNORED == status)
+		return;
+
+	if (ZBX_SERVICE_STATUS_NUM <= (index = status - ZBX_SERVICE_STATUS_OK))
+		index = ZBX_SERVICE_STATUS_NUM - 1;
+
+	stats->num[index] += num;
+	stats->weight[index] += weight * num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates children statistics from service children              *
+ *                                                                            *
+ * Parameters: service - [IN]                                                 *
+ *             stats   - [OUT] children statistics                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	service_children_stats_calc(const zbx_service_t *service, zbx_service_children_stats_t *stats)
+{
+	int	child_status;
+
+	memset(stats, 0, sizeof(zbx_service_children_stats_t));
+
+	for (int i = 0; i < service->children.values_num; i++)
+	{
+		zbx_service_t	*child = service->children.values[i];
+
+		if (SUCCEED == service_get_status(child, &child_status))
+			service_children_stats_add(stats, child_status, child->weight, 1);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets service children statistics                                  *
+ *                                                                            *
+ * Parameters: service     - [IN]                                             *
+ *             stats_local - [OUT] buffer for statistics calculated on demand *
+ *                                                                            *
+ * Return value: cached children statistics if they are maintained by         *
+ *               service manager, otherwise statistics calculated from        *
+ *               service children                                             *
+ *                                                                            *
+ ******************************************************************************/
+static const zbx_service_children_stats_t	*service_get_children_stats(const zbx_service_t *service,
+		zbx_service_children_stats_t *stats_local)
+{
+	if (0 != service->children_stats_valid)
+		return &service->children_stats;
+
+	service_children_stats_calc(service, stats_local);
+
+	return stats_local;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets number and total weight of children with status greater      *
+ *          or equal to specified                                             *
+ *                                                                            *
+ * Parameters: stats  - [IN] children statistics                              *
+ *             status - [IN] target status                                    *
+ *             num    - [OUT] number of children having required status       *
+ *             weight - [OUT] weight of children having required status       *
+ *                                                                            *
+ ******************************************************************************/
+static void	service_children_stats_get(const zbx_service_children_stats_t *stats, int status, int *num,
+		int *weight)
+{
+	*num = 0;
+	*weight = 0;
+
+	for (int i = MAX(status - ZBX_SERVICE_STATUS_OK, 0); i < ZBX_SERVICE_STATUS_NUM; i++)
+	{
+		*num += stats->num[i];
+		*weight += stats->weight[i];
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates children statistics of parent services after service      *
+ *          status, propagation rule or weight has been changed               *
+ *                                                                            *
+ * Parameters: service - [IN]                                                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	service_update_parents_stats(zbx_service_t *service)
+{
+	int	status;
+
+	if (SUCCEED != service_get_status(service, &status))
+		status = ZBX_SERVICE_STATUS_IGNORED;
+
+	if (status == service->stats_status && service->weight == service->stats_weight)
+		return;
+
+	for (int i = 0; i < service->parents.values_num; i++)
+	{
+		zbx_service_t	*parent = service->parents.values[i];
+
+		if (0 == parent->children_stats_valid)
+			continue;
+
+		service_children_stats_add(&parent->children_stats, service->stats_status, service->stats_weight, -1);
+		service_children_stats_add(&parent->children_stats, status, service->weight, 1);
+	}
+
+	service->stats_status = status;
+	service->stats_weight = service->weight;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets the longest path from service to a leaf service              *
+ *                                                                            *
+ * Parameters: service - [IN]                                                 *
+ *                                                                            *
+ * Return value: service height                                               *
+ *                                                                            *
+ * Comments: The height is cached in service and must be reset to             *
+ *           ZBX_SERVICE_HEIGHT_UNKNOWN when service links are changed.       *
+ *                                                                            *
+ ******************************************************************************/
+static int	service_get_height(zbx_service_t *service)
+{
+	if (ZBX_SERVICE_HEIGHT_UNKNOWN != service->height)
+		return service->height;
+
+	/* set height before descending to children to stop on circular links */
+	service->height = 0;
+
+	for (int i = 0; i < service->children.values_num; i++)
+	{
+		int	height = service_get_height(service->children.values[i]) + 1;
+
+		if (service->height < height)
+			service->height = height;
+	}
+
+	return service->height;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: rebuilds cached children statistics and heights of all            *
+ *          services after configuration sync                                 *
+ *                                                                            *
+ * Parameters: services - [IN] services hashset                               *
+ *                                                                            *
+ * Comments: Service links are reloaded during every configuration sync, so   *
+ *           the cached data is rebuilt from scratch. Afterwards children     *
+ *           statistics are updated incrementally by service status changes.  *
+ *                                                                            *
+ ******************************************************************************/
+static void	services_reset_children_stats(zbx_hashset_t *services)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_service_t		*service;
+
+	zbx_hashset_iter_reset(services, &iter);
+	while (NULL != (service = (zbx_service_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (SUCCEED != service_get_status(service, &service->stats_status))
+			service->stats_status = ZBX_SERVICE_STATUS_IGNORED;
+
+		service->stats_weight = service->weight;
+		service->height = ZBX_SERVICE_HEIGHT_UNKNOWN;
+	}
+
+	zbx_hashset_iter_reset(services, &iter);
+	while (NULL != (service = (zbx_service_t *)zbx_hashset_iter_next(&iter)))
+	{
+		service_children_stats_calc(service, &service->children_stats);
+		service->children_stats_valid = 1;
+		service_get_height(service);
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: adds update to queue                                              *
@@ -1342,6 +1543,7 @@ static zbx_service_update_t	*update_service(zbx_hashset_t *service_updates, zbx_
 
 	update->ts = *ts;
 	service->status = status;
+	service_update_parents_stats(service);
 
 	return update;
 }
@@ -1560,38 +1762,27 @@ out:
  ******************************************************************************/
 int	service_get_main_status(const zbx_service_t *service)
 {
-	int	status = ZBX_SERVICE_STATUS_OK, child_status;
+	int					status = ZBX_SERVICE_STATUS_OK;
+	zbx_service_children_stats_t		stats_local;
+	const zbx_service_children_stats_t	*stats;
 
 	switch (service->algorithm)
 	{
 		case ZBX_SERVICE_STATUS_CALC_MOST_CRITICAL_ALL:
-			for (int i = 0; i < service->children.values_num; i++)
-			{
-				zbx_service_t	*child = service->children.values[i];
+		case ZBX_SERVICE_STATUS_CALC_MOST_CRITICAL_ONE:
+			stats = service_get_children_stats(service, &stats_local);
 
-				if (SUCCEED != service_get_status(child, &child_status))
-					continue;
+			/* when all children must have problems any child in OK status makes the service OK */
+			if (ZBX_SERVICE_STATUS_CALC_MOST_CRITICAL_ALL == service->algorithm && 0 != stats->num[0])
+				break;
 
-				if (ZBX_SERVICE_STATUS_OK == child_status)
+			for (int i = ZBX_SERVICE_STATUS_NUM - 1; 0 < i; i--)
+			{
+				if (0 != stats->num[i])
 				{
-					status = child_status;
+					status = i + ZBX_SERVICE_STATUS_OK;
 					break;
 				}
-
-				if (status < child_status)
-					status = child_status;
-			}
-			break;
-		case ZBX_SERVICE_STATUS_CALC_MOST_CRITICAL_ONE:
-			for (int i = 0; i < service->children.values_num; i++)
-			{
-				zbx_service_t	*child = service->children.values[i];
-
-				if (SUCCEED != service_get_status(child, &child_status))
-					continue;
-
-				if (status < child_status)
-					status = child_status;
 			}
 			break;
 		case ZBX_SERVICE_STATUS_CALC_SET_OK:
@@ -1639,25 +1830,6 @@ static void	service_get_children_by_status(const zbx_service_t *service, int sta
 	}
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: gets total weight of all specified services                       *
- *                                                                            *
- ******************************************************************************/
-static int	services_get_weight(const zbx_vector_service_ptr_t *services)
-{
-	int	weight = 0;
-
-	for (int i = 0; i < services->values_num; i++)
-	{
-		zbx_service_t	*service = services->values[i];
-
-		weight += service->weight;
-	}
-
-	return weight;
-}
-
 /******************************************************************************
  *                                                                            *
  * Purpose: gets service status according to specified rule                   *
@@ -1670,14 +1842,14 @@ static int	services_get_weight(const zbx_vector_service_ptr_t *services)
  ******************************************************************************/
 int	service_get_rule_status(const zbx_service_t *service, const zbx_service_rule_t *rule)
 {
-	zbx_vector_service_ptr_t	children;
-	int				status = ZBX_SERVICE_STATUS_OK, status_limit, total_num, total_weight, weight;
+	zbx_service_children_stats_t		stats_local;
+	const zbx_service_children_stats_t	*stats;
+	int					status = ZBX_SERVICE_STATUS_OK, status_limit, total_num, total_weight;
+	int					num, weight;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() service:" ZBX_FS_UI64 ", rule:" ZBX_FS_UI64, __func__, service->serviceid,
 			rule->service_ruleid);
 
-	zbx_vector_service_ptr_create(&children);
-
 	switch (rule->type)
 	{
 		case ZBX_SERVICE_STATUS_RULE_TYPE_N_GE:
@@ -1697,43 +1869,41 @@ int	service_get_rule_status(const zbx_service_t *service, const zbx_service_rule
 			goto out;
 	}
 
-	service_get_children_by_status(service, status_limit, &children, &total_weight, &total_num);
+	stats = service_get_children_stats(service, &stats_local);
+	service_children_stats_get(stats, ZBX_SERVICE_STATUS_OK, &total_num, &total_weight);
+	service_children_stats_get(stats, status_limit, &num, &weight);
 
 	switch (rule->type)
 	{
 		case ZBX_SERVICE_STATUS_RULE_TYPE_N_GE:
-			if (children.values_num < rule->limit_value)
+			if (num < rule->limit_value)
 				goto out;
 			break;
 		case ZBX_SERVICE_STATUS_RULE_TYPE_NP_GE:
-			if (0 == total_num || children.values_num * 100 / total_num < rule->limit_value)
+			if (0 == total_num || num * 100 / total_num < rule->limit_value)
 				goto out;
 			break;
 		case ZBX_SERVICE_STATUS_RULE_TYPE_N_L:
-			if (total_num - children.values_num >= rule->limit_value)
+			if (total_num - num >= rule->limit_value)
 				goto out;
 			break;
 		case ZBX_SERVICE_STATUS_RULE_TYPE_NP_L:
-			if (0 == total_num || (total_num - children.values_num) * 100 / total_num >= rule->limit_value)
+			if (0 == total_num || (total_num - num) * 100 / total_num >= rule->limit_value)
 				goto out;
 			break;
 		case ZBX_SERVICE_STATUS_RULE_TYPE_W_GE:
-			weight = services_get_weight(&children);
 			if (weight < rule->limit_value)
 				goto out;
 			break;
 		case ZBX_SERVICE_STATUS_RULE_TYPE_WP_GE:
-			weight = services_get_weight(&children);
 			if (0 == total_weight || weight * 100 / total_weight < rule->limit_value)
 				goto out;
 			break;
 		case ZBX_SERVICE_STATUS_RULE_TYPE_W_L:
-			weight = services_get_weight(&children);
 			if (total_weight - weight >= rule->limit_value)
 				goto out;
 			break;
 		case ZBX_SERVICE_STATUS_RULE_TYPE_WP_L:
-			weight = services_get_weight(&children);
 			if (0 == total_weight || (total_weight - weight) * 100 / total_weight >= rule->limit_value)
 				goto out;
 			break;
@@ -1744,8 +1914,6 @@ int	service_get_rule_status(const zbx_service_t *service, const zbx_service_rule
 
 	status = rule->new_status;
 out:
-	zbx_vector_service_ptr_destroy(&children);
-
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() status:%d", __func__, status);
 
 	return status;
@@ -1970,25 +2138,133 @@ void	service_get_rootcause_eventids(const zbx_service_t *parent, zbx_vector_uint
 	zbx_vector_uint64_uniq(eventids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 }
 
+/* parent service waiting for status recalculation */
+typedef struct
+{
+	zbx_service_t	*service;
+	zbx_timespec_t	ts;
+	int		flags;
+	int		processed;
+}
+zbx_service_recalc_t;
+
+/* services to recalculate, ordered by service height so that children are recalculated before parents */
+typedef struct
+{
+	zbx_hashset_t		services;
+	zbx_binary_heap_t	heap;
+}
+zbx_service_recalc_queue_t;
+
+static zbx_hash_t	service_recalc_hash_func(const void *d)
+{
+	const zbx_service_recalc_t	*recalc = (const zbx_service_recalc_t *)d;
+
+	return ZBX_DEFAULT_UINT64_HASH_FUNC(&recalc->service->serviceid);
+}
+
+static int	service_recalc_compare_func(const void *d1, const void *d2)
+{
+	const zbx_service_recalc_t	*recalc1 = (const zbx_service_recalc_t *)d1;
+	const zbx_service_recalc_t	*recalc2 = (const zbx_service_recalc_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(recalc1->service->serviceid, recalc2->service->serviceid);
+	return 0;
+}
+
+static int	service_recalc_height_compare_func(const void *d1, const void *d2)
+{
+	const zbx_binary_heap_elem_t	*e1 = (const zbx_binary_heap_elem_t *)d1;
+	const zbx_binary_heap_elem_t	*e2 = (const zbx_binary_heap_elem_t *)d2;
+	const zbx_service_recalc_t	*recalc1 = (const zbx_service_recalc_t *)e1->data;
+	const zbx_service_recalc_t	*recalc2 = (const zbx_service_recalc_t *)e2->data;
+
+	ZBX_RETURN_IF_NOT_EQUAL(recalc1->service->height, recalc2->service->height);
+	ZBX_RETURN_IF_NOT_EQUAL(recalc1->service->serviceid, recalc2->service->serviceid);
+	return 0;
+}
+
+static void	service_recalc_queue_init(zbx_service_recalc_queue_t *queue)
+{
+	zbx_hashset_create(&queue->services, 100, service_recalc_hash_func, service_recalc_compare_func);
+	zbx_binary_heap_create(&queue->heap, service_recalc_height_compare_func, ZBX_BINARY_HEAP_OPTION_EMPTY);
+}
+
+static void	service_recalc_queue_destroy(zbx_service_recalc_queue_t *queue)
+{
+	zbx_binary_heap_destroy(&queue->heap);
+	zbx_hashset_destroy(&queue->services);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: queues parents of the service for status recalculation            *
+ *                                                                            *
+ * Parameters: queue   - [IN/OUT] recalculation queue                         *
+ *             service - [IN] updated service                                 *
+ *             ts      - [IN] update timestamp                                *
+ *             flags   - [IN]                                                 *
+ *                                                                            *
+ * Comments: Parents queued by several children are recalculated once with    *
+ *           the latest update timestamp and combined flags.                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	service_recalc_queue_parents(zbx_service_recalc_queue_t *queue, const zbx_service_t *service,
+		const zbx_timespec_t *ts, int flags)
+{
+	for (int i = 0; i < service->parents.values_num; i++)
+	{
+		zbx_service_recalc_t	recalc_local = {.service = service->parents.values[i]}, *recalc;
+
+		if (NULL == (recalc = (zbx_service_recalc_t *)zbx_hashset_search(&queue->services, &recalc_local)))
+		{
+			zbx_binary_heap_elem_t	elem;
+
+			recalc_local.ts = *ts;
+			recalc_local.flags = flags;
+			recalc_local.processed = 0;
+
+			recalc = (zbx_service_recalc_t *)zbx_hashset_insert(&queue->services, &recalc_local,
+					sizeof(recalc_local));
+
+			elem.key = recalc->service->serviceid;
+			elem.data = (void *)recalc;
+			zbx_binary_heap_insert(&queue->heap, &elem);
+
+			continue;
+		}
+
+		/* already recalculated parent can be queued again only by circular service links */
+		if (0 != recalc->processed)
+			continue;
+
+		recalc->flags |= flags;
+
+		if (0 > zbx_timespec_compare(&recalc->ts, ts))
+			recalc->ts = *ts;
+	}
+}
+
 /******************************************************************************
  *                                                                            *
- * Purpose: updates service and its parents statuses                          *
+ * Purpose: updates service status                                            *
  *                                                                            *
  * Parameters: itservice       - [IN] service to update                       *
  *             ts              - [IN] update timestamp                        *
  *             alarms          - [OUT] alarms update queue                    *
  *             service_updates - [IN/OUT]                                     *
  *             flags           - [IN]                                         *
- *                                                                            *
+ *             queue           - [IN/OUT] recalculation queue                 *
  *                                                                            *
  * Comments: This function recalculates service status according to the       *
- *           algorithm and status of the children services. If the status     *
- *           has been changed, an alarm is generated and parent services      *
- *           (up until the root service) are updated too.                     *
+ *           algorithm and cached statistics of the children services. If     *
+ *           the status has been changed, an alarm is generated and parent    *
+ *           services are queued for recalculation.                           *
  *                                                                            *
  ******************************************************************************/
 static void	its_itservice_update_status(zbx_service_t *itservice, const zbx_timespec_t *ts,
-		zbx_vector_status_update_ptr_t *alarms, zbx_hashset_t *service_updates, int flags)
+		zbx_vector_status_update_ptr_t *alarms, zbx_hashset_t *service_updates, int flags,
+		zbx_service_recalc_queue_t *queue)
 {
 	int	status, rule_status;
 
@@ -2009,22 +2285,42 @@ static void	its_itservice_update_status(zbx_service_t *itservice, const zbx_time
 		update = update_service(service_updates, itservice, status, ts);
 		update->alarm = its_updates_append(alarms, itservice->serviceid, status, ts->sec);
 
-		/* update parent services */
-		for (int i = 0; i < itservice->parents.values_num; i++)
-		{
-			its_itservice_update_status(itservice->parents.values[i], ts, alarms,
-					service_updates, flags);
-		}
+		service_recalc_queue_parents(queue, itservice, ts, flags);
 	}
 	else if (0 != (ZBX_FLAG_SERVICE_RECALCULATE & flags))
+		service_recalc_queue_parents(queue, itservice, ts, flags);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: recalculates queued services from the lowest to the highest       *
+ *                                                                            *
+ * Parameters: queue           - [IN/OUT] recalculation queue                 *
+ *             alarms          - [OUT] alarms update queue                    *
+ *             service_updates - [IN/OUT]                                     *
+ *                                                                            *
+ * Comments: Parents are always higher than their children, so every service  *
+ *           is recalculated once after all its changed children.             *
+ *                                                                            *
+ ******************************************************************************/
+static void	service_recalc_queue_process(zbx_service_recalc_queue_t *queue, zbx_vector_status_update_ptr_t *alarms,
+		zbx_hashset_t *service_updates)
+{
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() queued:%d", __func__, queue->heap.elems_num);
+
+	while (FAIL == zbx_binary_heap_empty(&queue->heap))
 	{
-		/* update parent services */
-		for (int i = 0; i < itservice->parents.values_num; i++)
-		{
-			its_itservice_update_status((zbx_service_t *)itservice->parents.values[i], ts, alarms,
-					service_updates, flags);
-		}
+		zbx_service_recalc_t	*recalc;
+
+		recalc = (zbx_service_recalc_t *)zbx_binary_heap_find_min(&queue->heap)->data;
+		zbx_binary_heap_remove_min(&queue->heap);
+
+		recalc->processed = 1;
+		its_itservice_update_status(recalc->service, &recalc->ts, alarms, service_updates, recalc->flags,
+				queue);
 	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() recalculated:%d", __func__, queue->services.num_data);
 }
 
 static char	*service_get_event_name(zbx_service_manager_t *manager, const char *name, int status)
@@ -2552,6 +2848,7 @@ static void	db_update_services(zbx_service_manager_t *manager)
 	zbx_vector_service_problem_ptr_t	service_problems_new;
 	zbx_vector_uint64_t			service_problemids;
 	zbx_hashset_t				service_updates;
+	zbx_service_recalc_queue_t		queue;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -2559,6 +2856,7 @@ static void	db_update_services(zbx_service_manager_t *manager)
 	zbx_vector_service_problem_ptr_create(&service_problems_new);
 	zbx_vector_uint64_create(&service_problemids);
 	zbx_hashset_create(&service_updates, 100, service_update_hash_func, service_update_compare_func);
+	service_recalc_queue_init(&queue);
 
 	zbx_hashset_iter_reset(&manager->service_diffs, &iter);
 
@@ -2682,24 +2980,15 @@ static void	db_update_services(zbx_service_manager_t *manager)
 			update = update_service(&service_updates, service, status, &ts);
 			update->alarm = its_updates_append(&alarms, service->serviceid, service->status, ts.sec);
 
-			/* update parent services */
-			for (int i = 0; i < service->parents.values_num; i++)
-			{
-				its_itservice_update_status((zbx_service_t *)service->parents.values[i], &ts, &alarms,
-						&service_updates, service_diff->flags);
-			}
+			service_recalc_queue_parents(&queue, service, &ts, service_diff->flags);
 		}
 		else if (0 != (ZBX_FLAG_SERVICE_RECALCULATE & service_diff->flags))
-		{
-			/* update parent services */
-			for (int i = 0; i < service->parents.values_num; i++)
-			{
-				its_itservice_update_status((zbx_service_t *)service->parents.values[i], &ts, &alarms,
-						&service_updates, service_diff->flags);
-			}
-		}
+			service_recalc_queue_parents(&queue, service, &ts, service_diff->flags);
 	}
 
+	/* update parent services after all service problems are applied */
+	service_recalc_queue_process(&queue, &alarms, &service_updates);
+
 	do
 	{
 		zbx_db_begin();
@@ -2712,6 +3001,7 @@ static void	db_update_services(zbx_service_manager_t *manager)
 
 	zbx_vector_uint64_destroy(&service_problemids);
 	zbx_vector_service_problem_ptr_destroy(&service_problems_new);
+	service_recalc_queue_destroy(&queue);
 	zbx_hashset_destroy(&service_updates);
 	zbx_vector_status_update_ptr_clear_ext(&alarms, zbx_status_update_free);
 	zbx_vector_status_update_ptr_destroy(&alarms);
@@ -3512,6 +3802,8 @@ ZBX_THREAD_ENTRY(service_manager_thread, args)
 			}
 			while (ZBX_DB_DOWN == zbx_db_commit());
 
+			services_reset_children_stats(&service_manager.services);
+
 			if (0 != updated)
 				recalculate_services(&service_manager);
 
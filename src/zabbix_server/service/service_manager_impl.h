@@ -19,11 +19,16 @@
 
 #include "zbxalgo.h"
 #include "zbxtime.h"
+#include "zbx_trigger_constants.h"
 
 #ifndef ZABBIX_SERVICE_MANAGER_IMPL_H
 #define ZABBIX_SERVICE_MANAGER_IMPL_H
 
 #define ZBX_SERVICE_STATUS_OK		-1
+#define ZBX_SERVICE_STATUS_NUM		(TRIGGER_SEVERITY_COUNT + 1)
+#define ZBX_SERVICE_STATUS_IGNORED	-2
+
+#define ZBX_SERVICE_HEIGHT_UNKNOWN	-1
 
 #define ZBX_SERVICE_STATUS_PROPAGATION_AS_IS	0
 #define ZBX_SERVICE_STATUS_PROPAGATION_INCREASE	1
@@ -97,6 +102,14 @@ zbx_service_problem_tag_t;
 ZBX_PTR_VECTOR_DECL(service_problem_tag_ptr, zbx_service_problem_tag_t *)
 ZBX_VECTOR_STRUCT_DECL(service_ptr, zbx_service_t *)
 
+/* number and total weight of not ignored children, indexed by their propagated status - ZBX_SERVICE_STATUS_OK */
+typedef struct
+{
+	int	num[ZBX_SERVICE_STATUS_NUM];
+	int	weight[ZBX_SERVICE_STATUS_NUM];
+}
+zbx_service_children_stats_t;
+
 struct zbx_service_s
 {
 	zbx_uint64_t				serviceid;
@@ -113,6 +126,17 @@ struct zbx_service_s
 	int					weight;
 	int					propagation_rule;
 	int					propagation_value;
+
+	/* children statistics maintained by service manager, calculated on demand when not valid */
+	zbx_service_children_stats_t		children_stats;
+	int					children_stats_valid;
+
+	/* status and weight the service is currently accounted with in parent children statistics */
+	int					stats_status;
+	int					stats_weight;
+
+	/* the longest path to a leaf service, parents are always higher than their children */
+	int					height;
 };
 
 ZBX_PTR_VECTOR_FUNC_DECL(service_ptr, zbx_service_t *)
@@ -395,6 +395,8 @@ int	zbx_trapper_item_test_run(const struct zbx_json_parse *jp_data, zbx_uint64_t
 				zbx_eval_set_exception(&ctx, zbx_dsprintf(NULL, "Cannot parse formula: %s", error));
 				zbx_free(error);
 			}
+			else
+				zbx_eval_compile(&ctx);
 
 			zbx_eval_serialize(&ctx, NULL, &item.formula_bin);
 			zbx_eval_clear(&ctx);
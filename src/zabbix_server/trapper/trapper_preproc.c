@@ -200,6 +200,7 @@ static int	trapper_parse_preproc_test(const struct zbx_json_parse *jp, char **va
 			step->params = step_params;
 			step->error_handler = error_handler;
 			step->error_handler_params = error_handler_params;
+			step->jsonpath = NULL;
 			zbx_vector_pp_step_ptr_append(steps, step);
 		}
 		else
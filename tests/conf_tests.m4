@@ -63,6 +63,7 @@ AC_DEFUN([CONF_TESTS],
 			tests/libs/zbxdbcache/Makefile
 			tests/libs/zbxdbhigh/Makefile
 			tests/libs/zbxeval/Makefile
+			tests/libs/zbxexport/Makefile
 			tests/libs/zbxhistory/Makefile
 			tests/libs/zbxjson/Makefile
 			tests/libs/zbxmodules/Makefile
@@ -70,6 +71,7 @@ AC_DEFUN([CONF_TESTS],
 			tests/libs/zbxpreproc/Makefile
 			tests/libs/zbxprometheus/Makefile
 			tests/libs/zbxregexp/Makefile
+			tests/libs/zbxshmem/Makefile
 			tests/libs/zbxexpression/Makefile
 			tests/libs/zbxfile/Makefile
 			tests/libs/zbxsysinfo/Makefile
@@ -77,6 +79,7 @@ AC_DEFUN([CONF_TESTS],
 			tests/libs/zbxtagfilter/Makefile
 			tests/libs/zbxtrends/Makefile
 			tests/libs/zbxhttp/Makefile
+			tests/libs/zbxicmpping/Makefile
 			tests/libs/zbxtime/Makefile
 			tests/zabbix_server/Makefile
 			tests/zabbix_server/pinger/Makefile
@@ -32,6 +32,7 @@
 #define	COMPACT_HT	3
 #define	REMOVE_TH	4
 #define	REMOVE_HT	5
+#define	PEEK		6
 
 static void	mock_read_values(zbx_mock_handle_t hdata, zbx_vector_ptr_t *values)
 {
@@ -272,6 +273,51 @@ static void test_queue_ptr_remove_head_tail(void)
 	zbx_vector_ptr_destroy(&values);
 }
 
+static void test_queue_ptr_peek(void)
+{
+	zbx_vector_ptr_t	values;
+	zbx_queue_ptr_t		queue;
+	void			*ptr;
+	int			i, j;
+
+	zbx_vector_ptr_create(&values);
+	mock_read_values(zbx_mock_get_parameter_handle("in.values"), &values);
+
+	zbx_queue_ptr_create(&queue);
+	zbx_queue_ptr_reserve(&queue, (int)(values.values_num * 1.5));
+
+	/* move tail/head positions towards the end of queue buffer so that pushing all values will */
+	/* result in data wraparound                                                                */
+	queue.tail_pos = values.values_num;
+	queue.head_pos = queue.tail_pos;
+
+	for (i = 0; i < values.values_num; i++)
+		zbx_queue_ptr_push(&queue, values.values[i]);
+
+	/* peek all values, popping one value after each pass */
+	for (j = 0; j < values.values_num; j++)
+	{
+		for (i = j; i < values.values_num; i++)
+		{
+			ptr = zbx_queue_ptr_peek(&queue, i - j);
+			zbx_mock_assert_ptr_eq("peek value", ptr, values.values[i]);
+		}
+
+		ptr = zbx_queue_ptr_peek(&queue, values.values_num - j);
+		zbx_mock_assert_ptr_eq("peek value", NULL, ptr);
+		zbx_mock_assert_int_eq("quantity", zbx_queue_ptr_values_num(&queue), values.values_num - j);
+
+		ptr = zbx_queue_ptr_pop(&queue);
+		zbx_mock_assert_ptr_eq("value", ptr, values.values[j]);
+	}
+
+	ptr = zbx_queue_ptr_peek(&queue, 0);
+	zbx_mock_assert_ptr_eq("peek value", NULL, ptr);
+
+	zbx_queue_ptr_destroy(&queue);
+	zbx_vector_ptr_destroy(&values);
+}
+
 static int get_type(const char *str)
 {
 	if (0 == strcmp(str, "RANGE"))
@@ -284,6 +330,8 @@ static int get_type(const char *str)
 		return REMOVE_TH;
 	if (0 == strcmp(str, "REMOVE_HT"))
 		return REMOVE_HT;
+	if (0 == strcmp(str, "PEEK"))
+		return PEEK;
 
 	fail_msg("unknown cmocka step type: %s", str);
 	return FAIL;
@@ -310,6 +358,9 @@ void	zbx_mock_test_entry(void **state)
 		case REMOVE_HT:
 			test_queue_ptr_remove_head_tail();
 			break;
+		case PEEK:
+			test_queue_ptr_peek();
+			break;
 		default:
 			fail_msg("unknown cmocka step type: %s", zbx_mock_get_parameter_string("in.type"));
 	}
@@ -24,8 +24,11 @@
 
 void	zbx_vc_set_mode(int mode)
 {
-	vc_cache->mode = mode;
-	vc_cache->mode_time = time(NULL);
+	for (int i = 0; i < vc_cache->shards_num; i++)
+	{
+		vc_cache->shards[i]->mode = mode;
+		vc_cache->shards[i]->mode_time = time(NULL);
+	}
 }
 
 int	zbx_vc_get_cached_values(zbx_uint64_t itemid, unsigned char value_type, zbx_vector_history_record_t *values)
@@ -34,7 +37,7 @@ int	zbx_vc_get_cached_values(zbx_uint64_t itemid, unsigned char value_type, zbx_
 	int		i;
 	zbx_vc_chunk_t	*chunk;
 
-	if (NULL == (item = zbx_hashset_search(&vc_cache->items, &itemid)))
+	if (NULL == (item = zbx_hashset_search(&vc_get_shard(itemid)->items, &itemid)))
 		return FAIL;
 
 	if (NULL == item->head)
@@ -43,7 +46,7 @@ int	zbx_vc_get_cached_values(zbx_uint64_t itemid, unsigned char value_type, zbx_
 	for (chunk = item->tail; NULL != chunk; chunk = chunk->next)
 	{
 		for (i = chunk->first_value; i <= chunk->last_value; i++)
-			vc_history_record_vector_append(values, value_type, &chunk->slots[i]);
+			vc_history_record_vector_append_slot(values, value_type, chunk, i);
 	}
 
 	return SUCCEED;
@@ -54,25 +57,26 @@ int	zbx_vc_precache_values(zbx_uint64_t itemid, int value_type, int seconds, int
 	zbx_vc_item_t			*item;
 	int				ret;
 	zbx_vector_history_record_t	values;
+	zbx_vc_shard_t			*shard = vc_get_shard(itemid);
 
 	/* add item to cache if necessary */
-	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
+	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&shard->items, &itemid)))
 	{
 		zbx_vc_item_t   new_item = {.itemid = itemid, .value_type = value_type};
-		item = zbx_hashset_insert(&vc_cache->items, &new_item, sizeof(zbx_vc_item_t));
+		item = zbx_hashset_insert(&shard->items, &new_item, sizeof(zbx_vc_item_t));
 	}
 
 	/* perform request to cache values */
 	zbx_history_record_vector_create(&values);
-	RDLOCK_CACHE;
+	RDLOCK_SHARD(shard);
 	ret = vch_item_get_values(item, &values, seconds, count, ts);
-	UNLOCK_CACHE;
+	UNLOCK_SHARD(shard);
 	zbx_vc_flush_stats();
 	zbx_history_record_vector_destroy(&values, value_type);
 
 	/* reset cache statistics */
-	vc_cache->hits = 0;
-	vc_cache->misses = 0;
+	shard->hits = 0;
+	shard->misses = 0;
 
 	return ret;
 }
@@ -83,7 +87,7 @@ int	zbx_vc_get_item_state(zbx_uint64_t itemid, int *status, int *active_range, i
 	zbx_vc_item_t	*item;
 	int		ret = FAIL;
 
-	if (NULL != (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
+	if (NULL != (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_get_shard(itemid)->items, &itemid)))
 	{
 		*status = item->status;
 		*active_range = item->active_range;
@@ -101,9 +105,18 @@ int	zbx_vc_get_cache_state(int *mode, zbx_uint64_t *hits, zbx_uint64_t *misses)
 	if (NULL == vc_cache)
 		return FAIL;
 
-	*mode = vc_cache->mode;
-	*hits = vc_cache->hits;
-	*misses = vc_cache->misses;
+	*mode = ZBX_VC_MODE_NORMAL;
+	*hits = 0;
+	*misses = 0;
+
+	for (int i = 0; i < vc_cache->shards_num; i++)
+	{
+		if (ZBX_VC_MODE_LOWMEM == vc_cache->shards[i]->mode)
+			*mode = ZBX_VC_MODE_LOWMEM;
+
+		*hits += vc_cache->shards[i]->hits;
+		*misses += vc_cache->shards[i]->misses;
+	}
 
 	return SUCCEED;
 }
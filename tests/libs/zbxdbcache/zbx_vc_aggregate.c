@@ -0,0 +1,140 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxnum.h"
+#include "zbxcachevalue.h"
+#include "valuecache_test.h"
+#include "mocks/valuecache/valuecache_mock.h"
+
+#include "zbx_vc_common.h"
+
+static int	str_to_aggregate_op(const char *str)
+{
+	if (0 == strcmp(str, "ZBX_VC_AGGREGATE_SUM"))
+		return ZBX_VC_AGGREGATE_SUM;
+
+	if (0 == strcmp(str, "ZBX_VC_AGGREGATE_AVG"))
+		return ZBX_VC_AGGREGATE_AVG;
+
+	if (0 == strcmp(str, "ZBX_VC_AGGREGATE_MIN"))
+		return ZBX_VC_AGGREGATE_MIN;
+
+	if (0 == strcmp(str, "ZBX_VC_AGGREGATE_MAX"))
+		return ZBX_VC_AGGREGATE_MAX;
+
+	if (0 == strcmp(str, "ZBX_VC_AGGREGATE_COUNT"))
+		return ZBX_VC_AGGREGATE_COUNT;
+
+	if (0 == strcmp(str, "ZBX_VC_AGGREGATE_FIRST"))
+		return ZBX_VC_AGGREGATE_FIRST;
+
+	if (0 == strcmp(str, "ZBX_VC_AGGREGATE_LAST"))
+		return ZBX_VC_AGGREGATE_LAST;
+
+	if (0 == strcmp(str, "ZBX_VC_AGGREGATE_CHANGE"))
+		return ZBX_VC_AGGREGATE_CHANGE;
+
+	if (0 == strcmp(str, "ZBX_VC_AGGREGATE_PERCENTILE"))
+		return ZBX_VC_AGGREGATE_PERCENTILE;
+
+	fail_msg("Unknown aggregation operation \"%s\"", str);
+
+	return FAIL;
+}
+
+static void	zbx_vc_test_aggregate_setup(zbx_mock_handle_t *handle, zbx_uint64_t *itemid,
+		unsigned char *value_type, zbx_timespec_t *ts, int *err, zbx_vector_history_record_t *expected,
+		zbx_vector_history_record_t *returned, int *seconds, int *count)
+{
+	int			op, values_num;
+	double			param = 0;
+	zbx_history_record_t	result;
+	zbx_mock_handle_t	hparam;
+	const char		*str;
+
+	/* perform request */
+
+	*handle = zbx_mock_get_parameter_handle("in.test");
+	zbx_vcmock_set_time(*handle, "time");
+	zbx_vcmock_set_mode(*handle, "cache mode");
+
+	zbx_vcmock_get_request_params(*handle, itemid, value_type, seconds, count, ts);
+	op = str_to_aggregate_op(zbx_mock_get_object_member_string(*handle, "op"));
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(*handle, "param", &hparam) &&
+			ZBX_MOCK_SUCCESS == zbx_mock_string(hparam, &str))
+	{
+		param = atof(str);
+	}
+
+	*err = zbx_vc_aggregate(*itemid, *value_type, op, param, *seconds, *count, ts, &result, &values_num);
+	zbx_vc_flush_stats();
+	zbx_mock_assert_result_eq("zbx_vc_aggregate() return value", SUCCEED, *err);
+
+	/* validate results */
+
+	zbx_mock_assert_int_eq("number of aggregated values", atoi(zbx_mock_get_parameter_string("out.values_num")),
+			values_num);
+
+	switch (op)
+	{
+		case ZBX_VC_AGGREGATE_COUNT:
+			break;
+		case ZBX_VC_AGGREGATE_FIRST:
+		case ZBX_VC_AGGREGATE_LAST:
+			zbx_vector_history_record_append_ptr(returned, &result);
+			zbx_vcmock_read_values(zbx_mock_get_parameter_handle("out.values"), *value_type, expected);
+			zbx_vcmock_check_records("Returned values", *value_type,  expected, returned);
+			break;
+		case ZBX_VC_AGGREGATE_AVG:
+		case ZBX_VC_AGGREGATE_CHANGE:
+			zbx_mock_assert_double_eq("aggregation result", atof(zbx_mock_get_parameter_string("out.result")),
+					result.value.dbl);
+			break;
+		default:
+			if (ITEM_VALUE_TYPE_FLOAT == *value_type)
+			{
+				zbx_mock_assert_double_eq("aggregation result",
+						atof(zbx_mock_get_parameter_string("out.result")), result.value.dbl);
+			}
+			else
+			{
+				zbx_uint64_t	expected_ui64;
+
+				if (FAIL == zbx_is_uint64(zbx_mock_get_parameter_string("out.result"), &expected_ui64))
+					fail_msg("Invalid out.result value");
+
+				zbx_mock_assert_uint64_eq("aggregation result", expected_ui64, result.value.ui64);
+			}
+	}
+
+	zbx_history_record_vector_clean(returned, *value_type);
+	zbx_history_record_vector_clean(expected, *value_type);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_vc_common_test_func(state, NULL, NULL, zbx_vc_test_aggregate_setup, 1);
+}
@@ -0,0 +1,97 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxeval.h"
+#include "mock_eval.h"
+
+static int	mock_eval_execute(const char *expression, zbx_uint64_t rules, const unsigned char *data,
+		zbx_variant_t *value, char **error)
+{
+	zbx_eval_context_t	ctx;
+	int			ret;
+
+	zbx_eval_deserialize(&ctx, expression, rules, data);
+	mock_eval_read_values(&ctx, "in.replace");
+	ret = zbx_eval_execute(&ctx, NULL, value, error);
+	zbx_eval_clear(&ctx);
+
+	return ret;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_eval_context_t	ctx;
+	char			*error = NULL, *error_compiled = NULL;
+	zbx_uint64_t		rules;
+	int			expected_ret, returned_ret, compiled_ret;
+	zbx_variant_t		value, value_compiled;
+	unsigned char		*data = NULL, *data_compiled = NULL;
+	const char		*expression;
+	zbx_mock_handle_t	handle;
+
+	ZBX_UNUSED(state);
+
+	rules = mock_eval_read_rules("in.rules");
+	expected_ret = zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.result"));
+	expression = zbx_mock_get_parameter_string("in.expression");
+
+	if (SUCCEED != zbx_eval_parse_expression(&ctx, expression, rules, &error))
+		fail_msg("failed to parse expression: %s", error);
+
+	zbx_eval_serialize(&ctx, NULL, &data);
+	zbx_eval_compile(&ctx);
+	zbx_eval_serialize(&ctx, NULL, &data_compiled);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("out.stack", &handle))
+		mock_compare_stack(&ctx, "out.stack");
+
+	zbx_eval_clear(&ctx);
+
+	returned_ret = mock_eval_execute(expression, rules, data, &value, &error);
+	compiled_ret = mock_eval_execute(expression, rules, data_compiled, &value_compiled, &error_compiled);
+
+	zbx_mock_assert_result_eq("return value", expected_ret, compiled_ret);
+	zbx_mock_assert_result_eq("compiled and parsed expression return values", returned_ret, compiled_ret);
+
+	if (SUCCEED == expected_ret)
+	{
+		zbx_mock_assert_str_eq("output value", zbx_mock_get_parameter_string("out.value"),
+				zbx_variant_value_desc(&value_compiled));
+
+		if (0 != zbx_variant_compare(&value, &value_compiled))
+		{
+			fail_msg("compiled expression value '%s' does not match parsed expression value '%s'",
+					zbx_variant_value_desc(&value_compiled), zbx_variant_value_desc(&value));
+		}
+
+		zbx_variant_clear(&value);
+		zbx_variant_clear(&value_compiled);
+	}
+
+	zbx_free(data);
+	zbx_free(data_compiled);
+	zbx_free(error);
+	zbx_free(error_compiled);
+}
@@ -0,0 +1,235 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxexport.h"
+#include "zbxipcservice.h"
+#include "zbxstr.h"
+#include "zbxtime.h"
+#include "../../../src/libs/zbxexport/export.h"
+
+/* sending must not wait for export writer longer than connection timeout */
+#define EXPORT_WRITER_WAIT_MAX	5
+
+static zbx_export_file_t	*history_file;
+
+static zbx_export_file_t	*get_history_file(void)
+{
+	return history_file;
+}
+
+static void	export_writer_start(zbx_ipc_service_t *service)
+{
+	char	*service_name, *error = NULL;
+
+	service_name = export_writer_service_name((int)zbx_mock_get_parameter_uint64("out.writer"));
+
+	if (FAIL == zbx_ipc_service_start(service, service_name, &error))
+		fail_msg("cannot start export writer service: %s", error);
+
+	zbx_free(service_name);
+}
+
+static char	*export_writer_recv(zbx_ipc_service_t *service)
+{
+	zbx_ipc_client_t	*client;
+	zbx_ipc_message_t	*message = NULL;
+	zbx_timespec_t		timeout = {1, 0};
+	char			*data = NULL;
+	int			i;
+
+	/* service returns after processing any event, for example after accepting client connection */
+	for (i = 0; i < 10 && NULL == message; i++)
+	{
+		(void)zbx_ipc_service_recv(service, &timeout, &client, &message);
+
+		if (NULL != client)
+			zbx_ipc_client_release(client);
+	}
+
+	if (NULL == message)
+		fail_msg("export writer did not receive data");
+
+	zbx_mock_assert_int_eq("message code", ZBX_IPC_EXPORT_HISTORY, (int)message->code);
+	data = zbx_malloc(NULL, message->size + 1);
+	memcpy(data, message->data, message->size);
+	data[message->size] = '\0';
+	zbx_ipc_message_free(message);
+
+	return data;
+}
+
+static char	*export_file_read(const char *dir, const char *name)
+{
+	char	*path, *data = NULL;
+	size_t	data_alloc = 0, data_offset = 0, n;
+	char	buf[ZBX_KIBIBYTE];
+	FILE	*f;
+
+	path = zbx_dsprintf(NULL, "%s/%s", dir, name);
+
+	if (NULL == (f = fopen(path, "r")))
+		fail_msg("cannot open export file \"%s\": %s", path, zbx_strerror(errno));
+
+	zbx_strcpy_alloc(&data, &data_alloc, &data_offset, "");
+
+	while (0 != (n = fread(buf, 1, sizeof(buf), f)))
+		zbx_strncpy_alloc(&data, &data_alloc, &data_offset, buf, n);
+
+	fclose(f);
+	zbx_free(path);
+
+	return data;
+}
+
+static void	export_dir_remove(const char *dir)
+{
+	DIR		*d;
+	struct dirent	*entry;
+
+	if (NULL == (d = opendir(dir)))
+		return;
+
+	while (NULL != (entry = readdir(d)))
+	{
+		char	*path;
+
+		if (0 == strcmp(entry->d_name, ".") || 0 == strcmp(entry->d_name, ".."))
+			continue;
+
+		path = zbx_dsprintf(NULL, "%s/%s", dir, entry->d_name);
+		unlink(path);
+		zbx_free(path);
+	}
+
+	closedir(d);
+	rmdir(dir);
+}
+
+static void	export_write_records(zbx_mock_handle_t hrecords)
+{
+	zbx_mock_handle_t	hrecord;
+	zbx_mock_error_t	err;
+	const char		*record;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hrecords, &hrecord))))
+	{
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != zbx_mock_string(hrecord, &record))
+			fail_msg("cannot read export record");
+
+		zbx_history_export_write(record, strlen(record));
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	char			dir[] = "/tmp/zbx_export_XXXXXX", *error = NULL;
+	zbx_config_export_t	config = {0};
+	zbx_ipc_service_t	service;
+	zbx_mock_handle_t	hbatches, hbatch, hdata;
+	zbx_mock_error_t	err;
+	int			running = 0;
+
+	ZBX_UNUSED(state);
+
+	signal(SIGPIPE, SIG_IGN);
+
+	if (NULL == mkdtemp(dir))
+		fail_msg("cannot create temporary directory: %s", zbx_strerror(errno));
+
+	if (FAIL == zbx_ipc_service_init_env(dir, &error))
+		fail_msg("cannot initialize IPC service environment: %s", error);
+
+	config.dir = zbx_strdup(NULL, dir);
+	config.file_size = ZBX_GIBIBYTE;
+	config.writers_num = (int)zbx_mock_get_parameter_uint64("in.writers");
+
+	if (FAIL == zbx_init_library_export(&config, &error))
+		fail_msg("cannot initialize export: %s", error);
+
+	history_file = zbx_history_export_init(get_history_file, "history-syncer",
+			(int)zbx_mock_get_parameter_uint64("in.process_num"));
+
+	hbatches = zbx_mock_get_parameter_handle("in.batches");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hbatches, &hbatch))))
+	{
+		const char	*state_writer, *received;
+		double		sec;
+		char		*data;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read export batch");
+
+		state_writer = zbx_mock_get_object_member_string(hbatch, "writer");
+
+		if ((0 == strcmp(state_writer, "stopped") || 0 == strcmp(state_writer, "restarted")) && 0 != running)
+		{
+			zbx_ipc_service_close(&service);
+			running = 0;
+		}
+
+		if ((0 == strcmp(state_writer, "running") || 0 == strcmp(state_writer, "restarted")) && 0 == running)
+		{
+			export_writer_start(&service);
+			running = 1;
+		}
+
+		export_write_records(zbx_mock_get_object_member_handle(hbatch, "records"));
+
+		sec = zbx_time();
+		zbx_history_export_flush();
+
+		if (EXPORT_WRITER_WAIT_MAX < zbx_time() - sec)
+			fail_msg("export data flush was blocked for " ZBX_FS_DBL " seconds", zbx_time() - sec);
+
+		if (ZBX_MOCK_SUCCESS != zbx_mock_object_member(hbatch, "received", &hdata))
+			continue;
+
+		if (ZBX_MOCK_SUCCESS != zbx_mock_string(hdata, &received))
+			fail_msg("invalid received data");
+
+		data = export_writer_recv(&service);
+		zbx_mock_assert_str_eq("data received by export writer", received, data);
+		zbx_free(data);
+	}
+
+	if (0 != running)
+		zbx_ipc_service_close(&service);
+
+	zbx_export_deinit(history_file);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("out.file", &hdata))
+	{
+		char	*data;
+
+		data = export_file_read(dir, zbx_mock_get_parameter_string("out.file"));
+		zbx_mock_assert_str_eq("export file contents", zbx_mock_get_parameter_string("out.data"), data);
+		zbx_free(data);
+	}
+
+	zbx_deinit_library_export();
+	zbx_ipc_service_free_env();
+	export_dir_remove(dir);
+}
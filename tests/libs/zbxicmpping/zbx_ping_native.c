@@ -0,0 +1,123 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxicmpping.h"
+
+#include <netinet/in.h>
+
+static const char	*get_null(void)
+{
+	return NULL;
+}
+
+static const char	*get_progname(void)
+{
+	return "zbx_ping_native";
+}
+
+static int	get_native_ping(void)
+{
+	return 1;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if process is allowed to open ICMP socket, either          *
+ *          unprivileged datagram or raw                                      *
+ *                                                                            *
+ ******************************************************************************/
+static int	icmp_socket_available(void)
+{
+	int	fd;
+
+	if (-1 == (fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_ICMP)) &&
+			-1 == (fd = socket(AF_INET, SOCK_RAW, IPPROTO_ICMP)))
+	{
+		return FAIL;
+	}
+
+	close(fd);
+
+	return SUCCEED;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_config_icmpping_t	config = {get_null, get_null, get_null, get_null, get_progname, get_native_ping};
+	zbx_mock_handle_t	hhosts, hhost;
+	zbx_mock_error_t	err;
+	ZBX_FPING_HOST		*hosts = NULL;
+	int			hosts_num = 0, hosts_alloc = 0, count, i, ret;
+	char			error[MAX_STRING_LEN];
+	const char		*addr;
+
+	ZBX_UNUSED(state);
+
+	if (SUCCEED != icmp_socket_available())
+		skip();
+
+	zbx_init_library_icmpping(&config);
+
+	hhosts = zbx_mock_get_parameter_handle("in.hosts");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = zbx_mock_vector_element(hhosts, &hhost)))
+	{
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != (err = zbx_mock_string(hhost, &addr)))
+			fail_msg("Cannot read host address: %s", zbx_mock_error_string(err));
+
+		if (hosts_num == hosts_alloc)
+		{
+			hosts_alloc += 8;
+			hosts = (ZBX_FPING_HOST *)zbx_realloc(hosts, sizeof(ZBX_FPING_HOST) * (size_t)hosts_alloc);
+		}
+
+		memset(&hosts[hosts_num], 0, sizeof(ZBX_FPING_HOST));
+		hosts[hosts_num++].addr = zbx_strdup(NULL, addr);
+	}
+
+	count = (int)zbx_mock_get_parameter_uint64("in.count");
+
+	ret = zbx_ping(hosts, hosts_num, count, (int)zbx_mock_get_parameter_uint64("in.interval"),
+			(int)zbx_mock_get_parameter_uint64("in.size"), (int)zbx_mock_get_parameter_uint64("in.timeout"),
+			0, 0, error, sizeof(error));
+
+	zbx_mock_assert_result_eq("zbx_ping() return value", SUCCEED, ret);
+
+	for (i = 0; i < hosts_num; i++)
+	{
+		zbx_mock_assert_int_eq("sent requests", count, hosts[i].cnt);
+		zbx_mock_assert_int_eq("received replies", count, hosts[i].rcv);
+
+		if (0 > hosts[i].min || hosts[i].min > hosts[i].max || hosts[i].max > hosts[i].sum)
+		{
+			fail_msg("invalid response time statistics for %s: min " ZBX_FS_DBL " max " ZBX_FS_DBL
+					" sum " ZBX_FS_DBL, hosts[i].addr, hosts[i].min, hosts[i].max, hosts[i].sum);
+		}
+
+		zbx_free(hosts[i].addr);
+		zbx_free(hosts[i].dnsname);
+	}
+
+	zbx_free(hosts);
+}
@@ -0,0 +1,156 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxjson.h"
+#include "zbxstr.h"
+
+static void	json_walk(const struct zbx_json_parse *jp, char **out, size_t *out_alloc, size_t *out_offset);
+
+static void	json_walk_value(const char *p, char **out, size_t *out_alloc, size_t *out_offset)
+{
+	struct zbx_json_parse	jp;
+
+	if ('{' == *p || '[' == *p)
+	{
+		if (SUCCEED != zbx_json_brackets_open(p, &jp))
+			fail_msg("cannot open json value: %s", zbx_json_strerror());
+
+		json_walk(&jp, out, out_alloc, out_offset);
+	}
+	else
+	{
+		char		*value = NULL;
+		size_t		value_alloc = 0;
+		zbx_json_type_t	type;
+
+		if (NULL == zbx_json_decodevalue_dyn(p, &value, &value_alloc, &type))
+			fail_msg("cannot decode json value: %s", zbx_json_strerror());
+
+		if (ZBX_JSON_TYPE_NULL == type)
+			zbx_strcpy_alloc(out, out_alloc, out_offset, "null");
+		else
+			zbx_strcpy_alloc(out, out_alloc, out_offset, value);
+
+		zbx_free(value);
+	}
+}
+
+/* walk json data the same way as protocol parsers - iterating elements and looking up pairs by name */
+static void	json_walk(const struct zbx_json_parse *jp, char **out, size_t *out_alloc, size_t *out_offset)
+{
+	const char	*p = NULL;
+	char		delim = *jp->start;
+
+	if ('{' == *jp->start)
+	{
+		char	name[MAX_STRING_LEN];
+
+		while (NULL != (p = zbx_json_pair_next(jp, p, name, sizeof(name))))
+		{
+			const char	*value;
+
+			if (NULL == (value = zbx_json_pair_by_name(jp, name)))
+				fail_msg("cannot find pair \"%s\": %s", name, zbx_json_strerror());
+
+			zbx_chrcpy_alloc(out, out_alloc, out_offset, delim);
+			zbx_snprintf_alloc(out, out_alloc, out_offset, "\"%s\":", name);
+			json_walk_value(value, out, out_alloc, out_offset);
+			delim = ',';
+		}
+
+		if ('{' == delim)
+			zbx_chrcpy_alloc(out, out_alloc, out_offset, delim);
+
+		zbx_chrcpy_alloc(out, out_alloc, out_offset, '}');
+	}
+	else
+	{
+		while (NULL != (p = zbx_json_next(jp, p)))
+		{
+			zbx_chrcpy_alloc(out, out_alloc, out_offset, delim);
+			json_walk_value(p, out, out_alloc, out_offset);
+			delim = ',';
+		}
+
+		if ('[' == delim)
+			zbx_chrcpy_alloc(out, out_alloc, out_offset, delim);
+
+		zbx_chrcpy_alloc(out, out_alloc, out_offset, ']');
+	}
+}
+
+static char	*json_walk_data(const struct zbx_json_parse *jp, int indexed)
+{
+	zbx_json_index_t	*index = NULL;
+	char			*out = NULL;
+	size_t			out_alloc = 0, out_offset = 0;
+
+	if (0 != indexed && NULL == (index = zbx_json_index_create(jp)))
+		fail_msg("cannot create json index");
+
+	json_walk(jp, &out, &out_alloc, &out_offset);
+
+	zbx_json_index_free(index);
+
+	return out;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	struct zbx_json_parse	jp;
+	const char		*data;
+	char			*out, *out_indexed;
+	int			expected_ret;
+
+	ZBX_UNUSED(state);
+
+	data = zbx_mock_get_parameter_string("in.json");
+	expected_ret = zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.result"));
+
+	if (SUCCEED != zbx_json_open(data, &jp))
+	{
+		zbx_mock_assert_result_eq("zbx_json_open() return value", expected_ret, FAIL);
+
+		/* truncated data has unterminated strings or unmatched brackets and must not be indexed */
+		jp.start = data;
+		jp.end = data + strlen(data) - 1;
+
+		if (NULL != zbx_json_index_create(&jp))
+			fail_msg("created index of invalid json data");
+
+		return;
+	}
+
+	zbx_mock_assert_result_eq("zbx_json_open() return value", expected_ret, SUCCEED);
+
+	out = json_walk_data(&jp, 0);
+	out_indexed = json_walk_data(&jp, 1);
+
+	zbx_mock_assert_str_eq("indexed walk result", out, out_indexed);
+	zbx_mock_assert_str_eq("walk result", zbx_mock_get_parameter_string("out.walk"), out_indexed);
+
+	zbx_free(out_indexed);
+	zbx_free(out);
+}
@@ -51,13 +51,16 @@ static void	check_indefinite_path_result(zbx_mock_handle_t handle, const char *r
 	zbx_mock_assert_json_eq("Indefinite query result", expected_output, returned_output);
 }
 
-static void	test_query(zbx_jsonobj_t *obj, const char *path, int expected_ret)
+static void	test_query(zbx_jsonobj_t *obj, const struct zbx_json_parse *jp, const char *path, int expected_ret)
 {
 	char			*output = NULL;
 	int			returned_ret;
 	zbx_mock_handle_t	handle;
 
-	returned_ret = zbx_jsonobj_query(obj, path, &output);
+	if (NULL != obj)
+		returned_ret = zbx_jsonobj_query(obj, path, &output);
+	else
+		returned_ret = zbx_jsonpath_query(jp, path, &output);
 
 	if (FAIL == returned_ret)
 		printf("\tzbx_jsonpath_query() failed with: %s\n", zbx_json_strerror());
@@ -89,9 +92,11 @@ static void	test_query(zbx_jsonobj_t *obj, const char *path, int expected_ret)
 
 void	zbx_mock_test_entry(void **state)
 {
-	const char	*data, *path;
-	int		expected_ret;
-	zbx_jsonobj_t	obj;
+	const char		*data, *path;
+	char			*doc;
+	int			expected_ret;
+	zbx_jsonobj_t		obj;
+	struct zbx_json_parse	jp;
 
 	ZBX_UNUSED(state);
 
@@ -105,10 +110,23 @@ void	zbx_mock_test_entry(void **state)
 	path = zbx_mock_get_parameter_string("in.path");
 	expected_ret = zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.return"));
 
-	test_query(&obj, path, expected_ret);
+	test_query(&obj, NULL, path, expected_ret);
 
 	/* query second time to check index reuse */
-	test_query(&obj, path, expected_ret);
+	test_query(&obj, NULL, path, expected_ret);
 
 	zbx_jsonobj_clear(&obj);
+
+	/* query data embedded in larger document to check that only the specified value is parsed */
+	doc = zbx_dsprintf(NULL, "[%s,{\"data\":\"end\"}]", data);
+	jp.start = doc + 1;
+	jp.end = doc + strlen(data);
+	SKIP_WHITESPACE(jp.start);
+
+	while (' ' == *jp.end || '\t' == *jp.end || '\r' == *jp.end || '\n' == *jp.end)
+		jp.end--;
+
+	test_query(NULL, &jp, path, expected_ret);
+
+	zbx_free(doc);
 }
@@ -0,0 +1,540 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+
+#ifdef HAVE_NETSNMP
+
+#include "../../../src/libs/zbxpoller/checks_snmp.c"
+
+/* requests are not sent, the test responds to them by calling the response callback directly */
+typedef struct
+{
+	netsnmp_pdu	*pdu;
+	snmp_callback	callback;
+	void		*magic;
+	int		reqid;
+}
+zbx_mock_snmp_request_t;
+
+static zbx_mock_snmp_request_t	request;
+static netsnmp_session		session;
+static netsnmp_transport	transport = {.sock = 1};
+static zbx_vector_ptr_t		tasks;
+
+int	__wrap_snmp_sess_async_send(void *sessp, netsnmp_pdu *pdu, snmp_callback callback, void *cb_data);
+netsnmp_session	*__wrap_snmp_sess_session(void *sessp);
+int	__wrap_snmp_sess_select_info2(void *sessp, int *numfds, netsnmp_large_fd_set *fdset, struct timeval *timeout,
+		int *block);
+netsnmp_transport	*__wrap_snmp_sess_transport(void *sessp);
+
+int	__wrap_snmp_sess_async_send(void *sessp, netsnmp_pdu *pdu, snmp_callback callback, void *cb_data)
+{
+	ZBX_UNUSED(sessp);
+
+	if (NULL != request.pdu)
+		fail_msg("request was sent before response to the previous one was received");
+
+	request.pdu = pdu;
+	request.callback = callback;
+	request.magic = cb_data;
+
+	return ++request.reqid;
+}
+
+netsnmp_session	*__wrap_snmp_sess_session(void *sessp)
+{
+	ZBX_UNUSED(sessp);
+
+	return &session;
+}
+
+int	__wrap_snmp_sess_select_info2(void *sessp, int *numfds, netsnmp_large_fd_set *fdset, struct timeval *timeout,
+		int *block)
+{
+	ZBX_UNUSED(sessp);
+	ZBX_UNUSED(fdset);
+	ZBX_UNUSED(timeout);
+	ZBX_UNUSED(block);
+
+	*numfds = transport.sock + 1;
+
+	return 1;
+}
+
+netsnmp_transport	*__wrap_snmp_sess_transport(void *sessp)
+{
+	ZBX_UNUSED(sessp);
+
+	return &transport;
+}
+
+void	zbx_async_poller_add_task(struct event_base *ev, struct evdns_base *dnsbase, const char *addr, void *data,
+		int timeout, zbx_async_task_process_cb_t process_cb, zbx_async_task_clear_cb_t clear_cb)
+{
+	ZBX_UNUSED(ev);
+	ZBX_UNUSED(dnsbase);
+	ZBX_UNUSED(addr);
+	ZBX_UNUSED(timeout);
+	ZBX_UNUSED(process_cb);
+	ZBX_UNUSED(clear_cb);
+
+	zbx_vector_ptr_append(&tasks, data);
+}
+
+int	zbx_dc_config_get_suggested_snmp_vars(zbx_uint64_t interfaceid, int *bulk)
+{
+	ZBX_UNUSED(interfaceid);
+
+	*bulk = SNMP_BULK_ENABLED;
+
+	return (int)zbx_mock_get_parameter_uint64("in.max_vars");
+}
+
+void	zbx_dc_config_update_interface_snmp_stats(zbx_uint64_t interfaceid, int max_snmp_succeed,
+		int min_snmp_fail)
+{
+	ZBX_UNUSED(interfaceid);
+	ZBX_UNUSED(max_snmp_succeed);
+	ZBX_UNUSED(min_snmp_fail);
+}
+
+void	zbx_update_selfmon_counter(const zbx_thread_info_t *info, unsigned char state)
+{
+	ZBX_UNUSED(info);
+	ZBX_UNUSED(state);
+}
+
+static const char	*mock_get_object_member_string_default(zbx_mock_handle_t object, const char *name,
+		const char *value)
+{
+	zbx_mock_handle_t	hmember;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_object_member(object, name, &hmember))
+		return value;
+
+	return zbx_mock_get_object_member_string(object, name);
+}
+
+static void	mock_read_items(zbx_mock_handle_t hitems, zbx_dc_item_t **items, int *items_num)
+{
+	zbx_mock_handle_t	hitem;
+	zbx_mock_error_t	err;
+	int			items_alloc = 0;
+
+	*items = NULL;
+	*items_num = 0;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hitems, &hitem))))
+	{
+		zbx_dc_item_t	*item;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read item");
+
+		if (*items_num == items_alloc)
+		{
+			items_alloc += 8;
+			*items = (zbx_dc_item_t *)zbx_realloc(*items, sizeof(zbx_dc_item_t) * (size_t)items_alloc);
+		}
+
+		item = &(*items)[(*items_num)++];
+		memset(item, 0, sizeof(zbx_dc_item_t));
+
+		item->itemid = zbx_mock_get_object_member_uint64(hitem, "itemid");
+		item->type = ITEM_TYPE_SNMP;
+		item->value_type = ITEM_VALUE_TYPE_TEXT;
+		item->snmp_version = ZBX_IF_SNMP_VERSION_2;
+		item->timeout = 3;
+		item->snmp_max_repetitions = 10;
+
+		item->interface.interfaceid = zbx_mock_get_object_member_uint64(hitem, "interfaceid");
+		zbx_strlcpy(item->interface.ip_orig, "127.0.0.1", sizeof(item->interface.ip_orig));
+		item->interface.addr = item->interface.ip_orig;
+		item->interface.port = 161;
+
+		zbx_strlcpy(item->host.host, "Zabbix server", sizeof(item->host.host));
+		zbx_strlcpy(item->key_orig, "snmp", sizeof(item->key_orig));
+		item->key = zbx_strdup(NULL, item->key_orig);
+		item->snmp_community = zbx_strdup(NULL, mock_get_object_member_string_default(hitem, "community",
+				"public"));
+		zbx_strlcpy(item->snmp_oid_orig, zbx_mock_get_object_member_string(hitem, "oid"),
+				sizeof(item->snmp_oid_orig));
+		item->snmp_oid = item->snmp_oid_orig;
+	}
+}
+
+static void	mock_read_cache(zbx_mock_handle_t hcache)
+{
+	zbx_mock_handle_t	hentry;
+	zbx_mock_error_t	err;
+	zbx_snmpidx_agent_t	agent = {.addr = "127.0.0.1", .port = 161, .community_context = "public",
+					.security_name = ""};
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hcache, &hentry))))
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read dynamic index cache entry");
+
+		cache_put_snmp_index(&agent, zbx_mock_get_object_member_string(hentry, "oid"),
+				zbx_mock_get_object_member_string(hentry, "index"),
+				zbx_mock_get_object_member_string(hentry, "value"));
+	}
+}
+
+static void	check_tasks(zbx_mock_handle_t htasks)
+{
+	zbx_mock_handle_t	htask;
+	zbx_mock_error_t	err;
+	int			i;
+
+	for (i = 0; ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(htasks, &htask))); i++)
+	{
+		const char		*expected;
+		char			*itemids = NULL;
+		size_t			itemids_alloc = 0, itemids_offset = 0;
+		zbx_snmp_context_t	*snmp_context;
+
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != zbx_mock_string(htask, &expected))
+			fail_msg("cannot read task");
+
+		if (i >= tasks.values_num)
+			fail_msg("expected more than %d tasks", tasks.values_num);
+
+		snmp_context = (zbx_snmp_context_t *)tasks.values[i];
+
+		for (int j = 0; j < zbx_async_check_snmp_get_items_num(snmp_context); j++)
+		{
+			if (0 != j)
+				zbx_chrcpy_alloc(&itemids, &itemids_alloc, &itemids_offset, ',');
+
+			zbx_snprintf_alloc(&itemids, &itemids_alloc, &itemids_offset, ZBX_FS_UI64,
+					zbx_async_check_snmp_get_item_context(snmp_context, j)->itemid);
+		}
+
+		zbx_mock_assert_str_eq("items of task", expected, itemids);
+		zbx_free(itemids);
+	}
+
+	zbx_mock_assert_int_eq("number of tasks", i, tasks.values_num);
+}
+
+static void	check_request_oids(zbx_mock_handle_t hoids)
+{
+	zbx_mock_handle_t	hoid;
+	zbx_mock_error_t	err;
+	netsnmp_variable_list	*var = request.pdu->variables;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hoids, &hoid))))
+	{
+		const char	*expected;
+		char		name[ZBX_ITEM_SNMP_OID_LEN_MAX];
+
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != zbx_mock_string(hoid, &expected))
+			fail_msg("cannot read request OID");
+
+		if (NULL == var)
+			fail_msg("request does not contain OID \"%s\"", expected);
+
+		zbx_snmp_dump_oid(name, sizeof(name), var->name, var->name_length);
+		zbx_mock_assert_str_eq("request OID", expected, name);
+		var = var->next_variable;
+	}
+
+	if (NULL != var)
+		fail_msg("request contains unexpected variable bindings");
+}
+
+static int	mock_str_to_errstat(const char *str)
+{
+	if (0 == strcmp(str, "noError"))
+		return SNMP_ERR_NOERROR;
+
+	if (0 == strcmp(str, "tooBig"))
+		return SNMP_ERR_TOOBIG;
+
+	if (0 == strcmp(str, "noSuchName"))
+		return SNMP_ERR_NOSUCHNAME;
+
+	fail_msg("unknown error status \"%s\"", str);
+
+	return SNMP_ERR_NOERROR;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates response to the request in flight                         *
+ *                                                                            *
+ * Comments: Values are either strings bound to the request OIDs in order or  *
+ *           OID and value pairs, the latter are used to respond to walks.    *
+ *                                                                            *
+ ******************************************************************************/
+static netsnmp_pdu	*mock_response_create(zbx_mock_handle_t hresponse)
+{
+	zbx_mock_handle_t	hvalues, hvalue, hindex;
+	zbx_mock_error_t	err;
+	netsnmp_pdu		*pdu;
+	netsnmp_variable_list	*var = request.pdu->variables;
+
+	pdu = snmp_pdu_create(SNMP_MSG_RESPONSE);
+	pdu->reqid = request.reqid;
+	pdu->errstat = mock_str_to_errstat(mock_get_object_member_string_default(hresponse, "errstat",
+			"noError"));
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hresponse, "errindex", &hindex))
+		pdu->errindex = (long)zbx_mock_get_object_member_uint64(hresponse, "errindex");
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_object_member(hresponse, "values", &hvalues))
+		return pdu;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hvalues, &hvalue))))
+	{
+		const char	*value;
+		oid		name[MAX_OID_LEN];
+		size_t		name_length = MAX_OID_LEN;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read response value");
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_string(hvalue, &value))
+		{
+			if (NULL == var)
+				fail_msg("response contains more values than request");
+
+			memcpy(name, var->name, var->name_length * sizeof(oid));
+			name_length = var->name_length;
+			var = var->next_variable;
+		}
+		else
+		{
+			const char	*name_str = zbx_mock_get_object_member_string(hvalue, "oid");
+
+			if (NULL == snmp_parse_oid(name_str, name, &name_length))
+				fail_msg("cannot parse response OID \"%s\"", name_str);
+
+			value = zbx_mock_get_object_member_string(hvalue, "value");
+		}
+
+		snmp_pdu_add_variable(pdu, name, name_length, ASN_OCTET_STR, value, strlen(value));
+	}
+
+	return pdu;
+}
+
+static void	mock_get_context_check(zbx_mock_handle_t hrequest, const zbx_snmp_get_context_t *get_context)
+{
+	zbx_mock_handle_t	hcontext;
+
+	if (ZBX_MOCK_SUCCESS != zbx_mock_object_member(hrequest, "context", &hcontext))
+		return;
+
+	zbx_mock_assert_int_eq("max_vars", (int)zbx_mock_get_object_member_uint64(hcontext, "max_vars"),
+			get_context->max_vars);
+	zbx_mock_assert_int_eq("level", (int)zbx_mock_get_object_member_uint64(hcontext, "level"),
+			get_context->level);
+	zbx_mock_assert_int_eq("min_fail", (int)zbx_mock_get_object_member_uint64(hcontext, "min_fail"),
+			get_context->min_fail);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: drives request-response cycle of the coalesced context until all  *
+ *          its items are processed                                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	mock_process_requests(zbx_snmp_context_t *snmp_context, zbx_mock_handle_t hrequests)
+{
+	zbx_mock_handle_t	hrequest, hresponse;
+	zbx_mock_error_t	err;
+	char			error[MAX_STRING_LEN];
+	int			fd;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hrequests, &hrequest))))
+	{
+		netsnmp_pdu	*response = NULL;
+		const char	*command;
+		int		operation = NETSNMP_CALLBACK_OP_RECEIVED_MESSAGE;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read request");
+
+		if (SUCCEED != snmp_get_add(snmp_context, &fd, error, sizeof(error)))
+			fail_msg("cannot send request: %s", error);
+
+		command = zbx_mock_get_object_member_string(hrequest, "command");
+
+		if (0 == strcmp(command, "get"))
+			zbx_mock_assert_int_eq("request command", SNMP_MSG_GET, request.pdu->command);
+		else if (0 == strcmp(command, "getbulk"))
+			zbx_mock_assert_int_eq("request command", SNMP_MSG_GETBULK, request.pdu->command);
+		else
+			fail_msg("unknown request command \"%s\"", command);
+
+		check_request_oids(zbx_mock_get_object_member_handle(hrequest, "oids"));
+
+		hresponse = zbx_mock_get_object_member_handle(hrequest, "response");
+
+		if (0 == strcmp(mock_get_object_member_string_default(hresponse, "timeout", "no"), "yes"))
+			operation = NETSNMP_CALLBACK_OP_TIMED_OUT;
+		else
+			response = mock_response_create(hresponse);
+
+		request.callback(operation, &session, request.reqid, response, request.magic);
+
+		if (NULL != response)
+			snmp_free_pdu(response);
+
+		snmp_free_pdu(request.pdu);
+		request.pdu = NULL;
+
+		mock_get_context_check(hrequest, snmp_context->get_context);
+	}
+
+	if (FAIL != snmp_get_add(snmp_context, &fd, error, sizeof(error)))
+		fail_msg("unexpected request after all items were processed");
+}
+
+static void	check_items(zbx_snmp_context_t *snmp_context, zbx_mock_handle_t hitems)
+{
+	zbx_mock_handle_t	hitem, hmember;
+	zbx_mock_error_t	err;
+	zbx_snmp_get_context_t	*get_context = snmp_context->get_context;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hitems, &hitem))))
+	{
+		zbx_uint64_t		itemid;
+		zbx_snmp_get_item_t	*get_item = NULL;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read expected item");
+
+		itemid = zbx_mock_get_object_member_uint64(hitem, "itemid");
+
+		for (int i = 0; i < get_context->items.values_num; i++)
+		{
+			if (itemid == get_context->items.values[i]->item->itemid)
+			{
+				get_item = get_context->items.values[i];
+				break;
+			}
+		}
+
+		if (NULL == get_item)
+			fail_msg("item " ZBX_FS_UI64 " is not queried by the task", itemid);
+
+		zbx_mock_assert_int_eq("item state", ZBX_SNMP_ITEM_DONE, get_item->state);
+		zbx_mock_assert_result_eq("item return code",
+				zbx_mock_str_to_return_code(zbx_mock_get_object_member_string(hitem, "ret")),
+				get_item->item->ret);
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hitem, "value", &hmember))
+		{
+			if (NULL == ZBX_GET_TEXT_RESULT(&get_item->item->result))
+				fail_msg("item " ZBX_FS_UI64 " has no value", itemid);
+
+			zbx_mock_assert_str_eq("item value", zbx_mock_get_object_member_string(hitem, "value"),
+					get_item->item->result.text);
+		}
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hitem, "error", &hmember))
+		{
+			if (NULL == ZBX_GET_MSG_RESULT(&get_item->item->result))
+				fail_msg("item " ZBX_FS_UI64 " has no error", itemid);
+
+			zbx_mock_assert_str_eq("item error", zbx_mock_get_object_member_string(hitem, "error"),
+					get_item->item->result.msg);
+		}
+	}
+}
+
+#endif
+
+void	zbx_mock_test_entry(void **state)
+{
+#ifndef HAVE_NETSNMP
+	ZBX_UNUSED(state);
+
+	skip();
+#else
+	zbx_dc_item_t		*items;
+	AGENT_RESULT		*results;
+	int			*errcodes, items_num, started;
+	zbx_mock_handle_t	handle;
+
+	ZBX_UNUSED(state);
+
+	zbx_init_library_mt_snmp("zbx_snmp_get_async");
+	zbx_vector_ptr_create(&tasks);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("in.cache", &handle))
+		mock_read_cache(handle);
+
+	mock_read_items(zbx_mock_get_parameter_handle("in.items"), &items, &items_num);
+
+	results = (AGENT_RESULT *)zbx_malloc(NULL, sizeof(AGENT_RESULT) * (size_t)items_num);
+	errcodes = (int *)zbx_malloc(NULL, sizeof(int) * (size_t)items_num);
+
+	for (int i = 0; i < items_num; i++)
+	{
+		zbx_init_agent_result(&results[i]);
+		errcodes[i] = SUCCEED;
+	}
+
+	started = zbx_async_check_snmp_items(items, results, errcodes, items_num, NULL, NULL, NULL, NULL, NULL,
+			NULL);
+
+	zbx_mock_assert_int_eq("number of started items", items_num, started);
+	check_tasks(zbx_mock_get_parameter_handle("out.tasks"));
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("in.requests", &handle))
+	{
+		zbx_snmp_context_t	*snmp_context = (zbx_snmp_context_t *)tasks.values[0];
+
+		zbx_mock_assert_int_eq("task type", ZBX_SNMP_STANDARD, snmp_context->snmp_oid_type);
+
+		mock_process_requests(snmp_context, handle);
+		check_items(snmp_context, zbx_mock_get_parameter_handle("out.items"));
+	}
+
+	for (int i = 0; i < tasks.values_num; i++)
+		zbx_async_check_snmp_clean((zbx_snmp_context_t *)tasks.values[i]);
+
+	for (int i = 0; i < items_num; i++)
+	{
+		zbx_free(items[i].key);
+		zbx_free(items[i].snmp_community);
+		zbx_free_agent_result(&results[i]);
+	}
+
+	zbx_free(errcodes);
+	zbx_free(results);
+	zbx_free(items);
+
+	if (NULL != snmpidx.slots)
+		zbx_hashset_destroy(&snmpidx);
+
+	zbx_vector_ptr_destroy(&tasks);
+	zbx_shutdown_library_mt_snmp("zbx_snmp_get_async");
+#endif
+}
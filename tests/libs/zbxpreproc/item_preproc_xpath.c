@@ -50,6 +50,7 @@ void	zbx_mock_test_entry(void **state)
 	step.type = ZBX_PREPROC_XPATH;
 	step.params = (char *)zbx_mock_get_parameter_string("in.xpath");
 	step.error_handler = ZBX_PREPROC_FAIL_DEFAULT;
+	step.jsonpath = NULL;
 
 	zbx_variant_set_none(&history_value);
 	zbx_timespec(&ts);
@@ -177,6 +177,8 @@ static void	read_step(const char *path, zbx_pp_step_t *step)
 		step->error_handler_params = (char *)zbx_mock_get_object_member_string(hop, "error_handler_params");
 	else
 		step->error_handler_params = "";
+
+	step->jsonpath = NULL;
 }
 
 static void	duplicate_step(zbx_pp_step_t *step_src, zbx_pp_step_t *step_dst)
@@ -185,12 +187,19 @@ static void	duplicate_step(zbx_pp_step_t *step_src, zbx_pp_step_t *step_dst)
 	step_dst->params = zbx_strdup(NULL, step_src->params);
 	step_dst->error_handler = step_src->error_handler;
 	step_dst->error_handler_params = zbx_strdup(NULL, step_src->error_handler_params);
+	step_dst->jsonpath = NULL;
 }
 
 static void	release_step(zbx_pp_step_t *step)
 {
 	zbx_free(step->params);
 	zbx_free(step->error_handler_params);
+
+	if (NULL != step->jsonpath)
+	{
+		zbx_jsonpath_clear(step->jsonpath);
+		zbx_free(step->jsonpath);
+	}
 }
 
 /******************************************************************************
@@ -362,6 +371,10 @@ void	zbx_mock_test_entry(void **state)
 		else
 			step_cache = cache;
 
+		/* run the last two tests with compiled step parameters */
+		if (2 == i)
+			zbx_pp_step_compile(&step);
+
 		if (FAIL == (returned_ret = pp_execute_step(&ctx, step_cache, NULL, 0, value_type, &value, ts, &step,
 				&history_value, &history_ts, get_zbx_config_source_ip())))
 		{
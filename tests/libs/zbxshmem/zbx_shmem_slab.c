@@ -0,0 +1,238 @@
+/*
+** Zabbix
+** Copyright (C) 2001-2024 Zabbix SIA
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxshmem.h"
+#include "zbxalgo.h"
+#include "zbxstr.h"
+
+typedef struct
+{
+	char	*name;
+	char	*ptr;
+	size_t	size;
+}
+mock_alloc_t;
+
+static unsigned char	mock_alloc_pattern(const char *name)
+{
+	return (unsigned char)(zbx_default_string_hash_func(name) | 1);
+}
+
+static void	mock_alloc_fill(mock_alloc_t *alloc, size_t offset)
+{
+	if (offset < alloc->size)
+		memset(alloc->ptr + offset, mock_alloc_pattern(alloc->name), alloc->size - offset);
+}
+
+static void	mock_alloc_check(const mock_alloc_t *alloc)
+{
+	unsigned char	pattern = mock_alloc_pattern(alloc->name);
+
+	for (size_t i = 0; i < alloc->size; i++)
+	{
+		if (pattern != (unsigned char)alloc->ptr[i])
+			fail_msg("allocation \"%s\" data was overwritten at offset " ZBX_FS_SIZE_T, alloc->name,
+					(zbx_fs_size_t)i);
+	}
+}
+
+static int	mock_alloc_find(const zbx_vector_ptr_t *allocs, const char *name)
+{
+	for (int i = 0; i < allocs->values_num; i++)
+	{
+		if (0 == strcmp(((const mock_alloc_t *)allocs->values[i])->name, name))
+			return i;
+	}
+
+	fail_msg("unknown allocation \"%s\"", name);
+
+	return FAIL;
+}
+
+static void	mock_alloc_free(mock_alloc_t *alloc)
+{
+	zbx_free(alloc->name);
+	zbx_free(alloc);
+}
+
+static void	execute_op(zbx_shmem_info_t *info, zbx_vector_ptr_t *allocs, const char *op, const char *name,
+		size_t size)
+{
+	mock_alloc_t	*alloc;
+	int		index;
+	size_t		preserved;
+
+	if (0 == strcmp(op, "malloc"))
+	{
+		alloc = (mock_alloc_t *)zbx_malloc(NULL, sizeof(mock_alloc_t));
+		alloc->name = zbx_strdup(NULL, name);
+		alloc->size = size;
+		alloc->ptr = (char *)zbx_shmem_malloc(info, NULL, size);
+		mock_alloc_fill(alloc, 0);
+		zbx_vector_ptr_append(allocs, alloc);
+	}
+	else if (0 == strcmp(op, "realloc"))
+	{
+		alloc = (mock_alloc_t *)allocs->values[mock_alloc_find(allocs, name)];
+		alloc->ptr = (char *)zbx_shmem_realloc(info, alloc->ptr, size);
+
+		/* the allocated data must be preserved by reallocation */
+		preserved = MIN(alloc->size, size);
+		alloc->size = preserved;
+		mock_alloc_check(alloc);
+
+		alloc->size = size;
+		mock_alloc_fill(alloc, preserved);
+	}
+	else if (0 == strcmp(op, "free"))
+	{
+		index = mock_alloc_find(allocs, name);
+		alloc = (mock_alloc_t *)allocs->values[index];
+		zbx_shmem_free(info, alloc->ptr);
+		mock_alloc_free(alloc);
+		zbx_vector_ptr_remove_noorder(allocs, index);
+	}
+	else
+		fail_msg("unknown operation \"%s\"", op);
+}
+
+static void	check_stats(zbx_shmem_info_t *info, zbx_mock_handle_t hstats, zbx_uint64_t free_size)
+{
+	zbx_shmem_stats_t	stats;
+	zbx_mock_handle_t	hvalue;
+	zbx_uint64_t		value;
+
+	zbx_shmem_get_stats(info, &stats);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstats, "pages", &hvalue) &&
+			ZBX_MOCK_SUCCESS == zbx_mock_uint64(hvalue, &value))
+	{
+		zbx_mock_assert_uint64_eq("slab pages", value, stats.slab_pages);
+	}
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstats, "used", &hvalue) &&
+			ZBX_MOCK_SUCCESS == zbx_mock_uint64(hvalue, &value))
+	{
+		zbx_mock_assert_uint64_eq("used slab objects", value, stats.slab_used_objects);
+	}
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstats, "free", &hvalue) &&
+			ZBX_MOCK_SUCCESS == zbx_mock_uint64(hvalue, &value))
+	{
+		zbx_mock_assert_uint64_eq("free slab objects", value, stats.slab_free_objects);
+	}
+
+	/* the memory taken from shared memory free size since the test start */
+	if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstats, "allocated", &hvalue) &&
+			ZBX_MOCK_SUCCESS == zbx_mock_uint64(hvalue, &value))
+	{
+		zbx_mock_assert_uint64_eq("allocated size", value, free_size - stats.free_size);
+	}
+
+	zbx_mock_assert_uint64_eq("total size", info->total_size, stats.free_size + stats.used_size + stats.overhead);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_shmem_info_t	*info;
+	zbx_vector_ptr_t	allocs;
+	zbx_mock_handle_t	hsteps, hstep, hvalue;
+	zbx_mock_error_t	err;
+	zbx_uint64_t		free_size;
+	char			*error = NULL;
+
+	ZBX_UNUSED(state);
+
+	if (SUCCEED != zbx_shmem_create(&info, zbx_mock_get_parameter_uint64("in.size"), "test cache", "TestCacheSize",
+			0, &error))
+	{
+		fail_msg("cannot create shared memory: %s", error);
+	}
+
+	if (0 == strcmp(zbx_mock_get_parameter_string("in.slab"), "enabled"))
+		zbx_shmem_enable_slab(info);
+
+	free_size = info->free_size;
+	zbx_vector_ptr_create(&allocs);
+
+	hsteps = zbx_mock_get_parameter_handle("in.steps");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hsteps, &hstep))))
+	{
+		const char	*op, *name;
+		zbx_uint64_t	size = 0, count = 0;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read test step");
+
+		op = zbx_mock_get_object_member_string(hstep, "op");
+		name = zbx_mock_get_object_member_string(hstep, "name");
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "size", &hvalue) &&
+				ZBX_MOCK_SUCCESS != zbx_mock_uint64(hvalue, &size))
+		{
+			fail_msg("invalid allocation size");
+		}
+
+		/* allocate chunk leaving the specified free size in shared memory */
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "leave", &hvalue))
+		{
+			zbx_uint64_t	leave;
+
+			if (ZBX_MOCK_SUCCESS != zbx_mock_uint64(hvalue, &leave))
+				fail_msg("invalid free size to leave");
+
+			size = info->free_size - leave - 2 * sizeof(zbx_uint64_t);
+		}
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "count", &hvalue))
+		{
+			if (ZBX_MOCK_SUCCESS != zbx_mock_uint64(hvalue, &count))
+				fail_msg("invalid operation count");
+
+			for (zbx_uint64_t i = 0; i < count; i++)
+			{
+				char	*alloc_name;
+
+				alloc_name = zbx_dsprintf(NULL, "%s" ZBX_FS_UI64, name, i);
+				execute_op(info, &allocs, op, alloc_name, (size_t)size);
+				zbx_free(alloc_name);
+			}
+		}
+		else
+			execute_op(info, &allocs, op, name, (size_t)size);
+
+		for (int i = 0; i < allocs.values_num; i++)
+			mock_alloc_check((const mock_alloc_t *)allocs.values[i]);
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hstep, "stats", &hvalue))
+			check_stats(info, hvalue, free_size);
+	}
+
+	zbx_vector_ptr_clear_ext(&allocs, (zbx_clean_func_t)mock_alloc_free);
+	zbx_vector_ptr_destroy(&allocs);
+
+	zbx_shmem_destroy(info);
+}
@@ -383,6 +383,7 @@ final class CItemData {
 			'zabbix[proxy_history]',
 			'zabbix[queue,<from>,<to>]',
 			'zabbix[rcache,<cache>,<mode>]',
+			'zabbix[regexp_cache,<mode>]',
 			'zabbix[requiredperformance]',
 			'zabbix[stats,<ip>,<port>,queue,<from>,<to>]',
 			'zabbix[stats,<ip>,<port>]',
@@ -2897,6 +2898,13 @@ final class CItemData {
 					ITEM_TYPE_INTERNAL => 'config/items/itemtypes/internal#rcache'
 				]
 			],
+			'zabbix[regexp_cache,<mode>]' => [
+				'description' => _('Compiled regular expression cache statistics of preprocessing workers. Valid modes are: all, hits, phits, misses, pmisses and evictions.'),
+				'value_type' => null,
+				'documentation_link' => [
+					ITEM_TYPE_INTERNAL => 'config/items/itemtypes/internal#regexp.cache'
+				]
+			],
 			'zabbix[requiredperformance]' => [
 				'description' => _('Required performance of the Zabbix server, in new values per second expected.'),
 				'value_type' => ITEM_VALUE_TYPE_FLOAT,
@@ -2968,7 +2976,7 @@ final class CItemData {
 				]
 			],
 			'zabbix[wcache,<cache>,<mode>]' => [
-				'description' => _('Statistics and availability of Zabbix write cache. Cache - one of values (modes: all, float, uint, str, log, text, not supported), history (modes: pfree, free, total, used, pused), index (modes: pfree, free, total, used, pused), trend (modes: pfree, free, total, used, pused).'),
+				'description' => _('Statistics and availability of Zabbix write cache. Cache - one of values (modes: all, float, uint, str, log, text, not supported), history (modes: pfree, free, total, used, pused), index (modes: pfree, free, total, used, pused), trend (modes: pfree, free, total, used, pused), sync (modes: batch, values, time).'),
 				'value_type' => null,
 				'documentation_link' => [
 					ITEM_TYPE_INTERNAL => 'config/items/itemtypes/internal#wcache'